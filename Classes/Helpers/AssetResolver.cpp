@@ -0,0 +1,144 @@
+//
+//  AssetResolver.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-02.
+//
+//
+
+#include "AssetResolver.h"
+#include "Defines.h"
+#include "ImageDecoder.h"
+
+using namespace std;
+using namespace cocos2d;
+
+// The variants produced by Tools/make_asset_variants.sh, from smallest to largest.
+static const int VARIANT_COUNT = 3;
+static const float VARIANT_SCALES[VARIANT_COUNT] = { 0.25f, 0.5f, 1.0f };
+static const char* VARIANT_SUFFIXES[VARIANT_COUNT] = { "_quarter", "_half", "" };
+
+// The extension of the lossy codec produced by Tools/transcode_images.sh. Transcoded images are preferred over the original format.
+static const char* TRANSCODED_EXTENSION = ".webp";
+
+// Get the scale of the variant best suited to this device's screen (1, 0.5 or 0.25).
+
+float AssetResolver::getPreferredScale()
+{
+    // Use the smallest variant which still has at least as many pixels as the screen will display.
+    for (int i = 0; i < VARIANT_COUNT; i++)
+    {
+        if (VARIANT_SCALES[i] >= SCREEN_SCALE)
+        {
+            return VARIANT_SCALES[i];
+        }
+    }
+
+    return 1.0f;
+}
+
+// Find the file name of the best available variant of an image.
+
+string AssetResolver::resolve(const char* fileName, float* assetScale)
+{
+    string original = fileName;
+
+    // Split the file name so that the variant suffix can be inserted before the extension.
+    size_t extensionStart = original.rfind('.');
+    string baseName = (extensionStart != string::npos) ? original.substr(0, extensionStart) : original;
+    string extension = (extensionStart != string::npos) ? original.substr(extensionStart) : "";
+
+    // Starting with the preferred variant, look for the first one which was actually built. Within a variant, a transcoded copy wins over the original format.
+    float preferredScale = getPreferredScale();
+    CCFileUtils* fileUtils = CCFileUtils::sharedFileUtils();
+
+    for (int i = 0; i < VARIANT_COUNT; i++)
+    {
+        if (VARIANT_SCALES[i] < preferredScale)
+        {
+            continue;
+        }
+
+        string transcodedName = baseName + VARIANT_SUFFIXES[i] + TRANSCODED_EXTENSION;
+        if (fileUtils->isFileExist(fileUtils->fullPathForFilename(transcodedName.c_str())))
+        {
+            if (assetScale) *assetScale = VARIANT_SCALES[i];
+            return transcodedName;
+        }
+
+        string variantName = baseName + VARIANT_SUFFIXES[i] + extension;
+        if (VARIANT_SCALES[i] != 1.0f && fileUtils->isFileExist(fileUtils->fullPathForFilename(variantName.c_str())))
+        {
+            if (assetScale) *assetScale = VARIANT_SCALES[i];
+            return variantName;
+        }
+    }
+
+    // If no reduced or transcoded variant exists, the original is always the fallback.
+    if (assetScale) *assetScale = 1.0f;
+    return original;
+}
+
+// Load the best available variant of an image into the texture cache.
+
+CCTexture2D* AssetResolver::addImage(const char* fileName, float* assetScale)
+{
+    string resolvedName = resolve(fileName, assetScale);
+    CCTextureCache* cache = CCTextureCache::sharedTextureCache();
+
+    // Images in the original format go through the texture cache's usual loading path.
+    if (!isTranscoded(resolvedName))
+    {
+        return cache->addImage(resolvedName.c_str());
+    }
+
+    // Transcoded images are decoded explicitly so that the codec never depends on the texture cache recognizing the file extension.
+    CCTexture2D* texture = cache->textureForKey(resolvedName.c_str());
+    if (texture)
+    {
+        return texture;
+    }
+
+    CCImage* image = createImage(fileName);
+    if (image)
+    {
+        texture = cache->addUIImage(image, resolvedName.c_str());
+    }
+
+    return texture;
+}
+
+// Decode the best available variant of an image straight into a texture with ImageDecoder, bypassing the texture cache.
+
+CCTexture2D* AssetResolver::createTexture(const char* fileName, float* assetScale)
+{
+    return ImageDecoder::createTexture(resolve(fileName, assetScale).c_str());
+}
+
+// Decode the best available variant of an image into memory without creating a texture.
+
+CCImage* AssetResolver::createImage(const char* fileName, float* assetScale)
+{
+    string resolvedName = resolve(fileName, assetScale);
+    string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(resolvedName.c_str());
+
+    CCImage* image = new CCImage();
+    if (image && image->initWithImageFile(fullPath.c_str(), isTranscoded(resolvedName) ? CCImage::kFmtWebp : CCImage::kFmtPng))
+    {
+        image->autorelease();
+        return image;
+    }
+    CC_SAFE_RELEASE(image);
+
+    CCLOG("Failed to decode \"%s\".", resolvedName.c_str());
+    return NULL;
+}
+
+// Check whether or not a resolved file name refers to a transcoded image.
+
+bool AssetResolver::isTranscoded(const string& fileName)
+{
+    size_t extensionLength = strlen(TRANSCODED_EXTENSION);
+    return (fileName.size() >= extensionLength &&
+            fileName.compare(fileName.size() - extensionLength, extensionLength, TRANSCODED_EXTENSION) == 0);
+}
@@ -0,0 +1,79 @@
+//
+//  AssetResolver.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-02.
+//
+//
+
+#ifndef ASSET_RESOLVER_H
+#define ASSET_RESOLVER_H
+
+#include "cocos2d.h"
+#include <string>
+
+/**
+ @brief     A helper class which picks the resolution variant of an image that best suits the device.
+
+ Every image is authored for iPad Retina. The build produces reduced copies of those images (ie. "newYorkMap0x0_half.png" and "newYorkMap0x0_quarter.png") so that smaller screens don't have to decode full-size images only to scale them down afterwards. Because a variant is smaller than the original, whoever displays it must scale it up by the inverse of its asset scale to keep the original geometry.
+
+ Photographic images may also be transcoded to WebP (ie. "statueOfLiberty_half.webp"), in which case the transcoded copy is preferred over the PNG of the same variant. The build only ships the WebP copy once it has checked that it decodes (see Tools/transcode_images.sh), so there is no PNG to fall back to.
+ */
+class AssetResolver
+{
+public:
+
+    /**
+     @brief     Get the scale of the variant best suited to this device's screen (1, 0.5 or 0.25).
+     @return    The preferred variant scale.
+     */
+    static float getPreferredScale();
+
+    /**
+     @brief     Find the file name of the best available variant of an image. Falls back to larger variants (and finally the original) if the preferred one was not built.
+     @param     fileName    The file name of the original, full-resolution image (ie. "newYorkMap0x0.png").
+     @param     assetScale  If not NULL, receives the scale of the variant that was found relative to the original.
+     @return    The file name of the variant to load.
+     */
+    static std::string resolve(const char* fileName, float* assetScale = NULL);
+
+    /**
+     @brief     Load the best available variant of an image into the texture cache.
+     @param     fileName    The file name of the original, full-resolution image.
+     @param     assetScale  If not NULL, receives the scale of the variant that was loaded relative to the original.
+     @return    A pointer to the loaded texture, or NULL if no variant could be loaded.
+     */
+    static cocos2d::CCTexture2D* addImage(const char* fileName, float* assetScale = NULL);
+
+    /**
+     @brief     Decode the best available variant of an image straight into a texture with ImageDecoder, bypassing the texture cache. Intended for large images which are only displayed once.
+     @param     fileName    The file name of the original, full-resolution image.
+     @param     assetScale  If not NULL, receives the scale of the variant that was loaded relative to the original.
+     @return    A pointer to the autoreleased texture, or NULL if no variant could be loaded.
+     */
+    static cocos2d::CCTexture2D* createTexture(const char* fileName, float* assetScale = NULL);
+
+    /**
+     @brief     Decode the best available variant of an image into memory without creating a texture, so that its pixels can be copied into a texture of the caller's own (ie. an atlas).
+     @param     fileName    The file name of the original, full-resolution image.
+     @param     assetScale  If not NULL, receives the scale of the variant that was loaded relative to the original.
+     @return    A pointer to the autoreleased image, or NULL if no variant could be loaded.
+     */
+    static cocos2d::CCImage* createImage(const char* fileName, float* assetScale = NULL);
+
+private:
+
+    /**
+     @brief     Check whether or not a resolved file name refers to a transcoded image.
+     @param     fileName    The resolved file name.
+     @return    The result of the check.
+     */
+    static bool isTranscoded(const std::string& fileName);
+
+    /**
+     @brief     Default constructor. Declared as private because this class is not meant to be instantiated.
+     */
+    AssetResolver() { }
+};
+
+#endif // ASSET_RESOLVER_H
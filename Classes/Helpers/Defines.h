@@ -15,6 +15,18 @@
 // Whether or not messages related to touch input should be displayed in the console.
 #define DISPLAY_TOUCH_MESSAGES false
 
+// Whether or not per-frame performance counters should be displayed in the console.
+#define DISPLAY_PERFORMANCE_MESSAGES false
+
+// Whether or not the map should follow where the user's fingers are predicted to be when each frame is displayed, rather than where they were last reported.
+#define PREDICT_TOUCHES true
+
+// Whether or not touches on the map should be recorded to a file in the app's writable directory, to be replayed later with Tools/GestureReplayer.cpp.
+#define RECORD_GESTURES false
+
+// The speed the time a walk takes is worked out at, in metres per second.
+#define WALKING_SPEED 1.4f
+
 // The scale of the screen compared to iPad Retina (ie. iPad Retina would be "1" while non-retina would be "0.5")
 #define SCREEN_SCALE (WIN_SIZE.width / 1536)
 
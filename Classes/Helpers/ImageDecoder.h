@@ -0,0 +1,89 @@
+//
+//  ImageDecoder.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-16.
+//
+//
+
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include "cocos2d.h"
+
+/**
+ @brief     Counters used to check how often the upload buffer is allocated, and how many images need their pixels converted on their way to the GPU.
+ */
+struct ImageDecoderStats
+{
+    /** The number of images that have been decoded. */
+    unsigned int imagesDecoded;
+
+    /** The number of times the shared upload buffer had to be (re)allocated. */
+    unsigned int bufferAllocations;
+
+    /** The number of images whose pixels had to be converted into premultiplied RGBA8888 from another layout as they were written (ideally none, as for WebP images). */
+    unsigned int conversions;
+};
+
+/**
+ @brief     A helper class which decodes images straight into a caller-supplied buffer in the final texture format.
+
+ The usual loading path reads the file into a buffer, decodes it into CCImage's own buffer and may convert it into yet another buffer before uploading it. Here the file is memory-mapped and decoded into the destination as premultiplied RGBA8888, which CCTexture2D can upload as-is. WebP rows are written there directly by libwebp. Other formats are decoded by ImageIO and then drawn into the destination, which is one more pass over the pixels, but still avoids CCImage's buffer and CCTexture2D's conversion.
+ */
+class ImageDecoder
+{
+public:
+
+    /**
+     @brief     Read the dimensions of an image without decoding it.
+     @param     fileName    The image's file name.
+     @param     width       Receives the image's width in pixels.
+     @param     height      Receives the image's height in pixels.
+     @return    Whether or not the image could be read.
+     */
+    static bool getImageSize(const char* fileName, unsigned int* width, unsigned int* height);
+
+    /**
+     @brief     Decode an image directly into a caller-supplied buffer as premultiplied RGBA8888.
+     @param     fileName    The image's file name.
+     @param     buffer      The destination buffer (ie. memory-mapped or pinned upload memory).
+     @param     bytesPerRow The distance in bytes between the starts of two rows in the buffer.
+     @param     width       The image's width in pixels, as returned by getImageSize(...).
+     @param     height      The image's height in pixels, as returned by getImageSize(...).
+     @return    Whether or not decoding succeeded.
+     */
+    static bool decodeInto(const char* fileName, unsigned char* buffer, unsigned int bytesPerRow, unsigned int width, unsigned int height);
+
+    /**
+     @brief     Create a texture by decoding an image into a shared upload buffer and uploading it from there. The texture bypasses CCTextureCache and is freed along with whatever retains it.
+     @param     fileName    The image's file name.
+     @return    A pointer to the autoreleased texture, or NULL if the image could not be decoded.
+     */
+    static cocos2d::CCTexture2D* createTexture(const char* fileName);
+
+    /**
+     @brief     Free the shared upload buffer. Call this once a batch of images has finished loading.
+     */
+    static void releaseUploadBuffer();
+
+    /**
+     @brief     Get the counters accumulated since the last reset.
+     @return    The counters.
+     */
+    static const ImageDecoderStats& getStats();
+
+    /**
+     @brief     Reset the counters.
+     */
+    static void resetStats();
+
+private:
+
+    /**
+     @brief     Default constructor. Declared as private because this class is not meant to be instantiated.
+     */
+    ImageDecoder() { }
+};
+
+#endif // IMAGE_DECODER_H
@@ -0,0 +1,252 @@
+//
+//  ImageDecoder.mm
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-16.
+//
+//
+
+#include "ImageDecoder.h"
+#import <UIKit/UIKit.h>
+#import <ImageIO/ImageIO.h>
+#include "webp/decode.h"
+
+using namespace cocos2d;
+
+/**
+ @brief     A texture which can be told that its data already has premultiplied alpha (CCTexture2D::initWithData assumes it doesn't).
+ */
+class DecodedTexture : public CCTexture2D
+{
+public:
+    void setHasPremultipliedAlpha(bool premultiplied) { m_bHasPremultipliedAlpha = premultiplied; }
+};
+
+// The buffer that images are decoded into before being uploaded by ImageDecoder::createTexture(...).
+static unsigned char* s_UploadBuffer = NULL;
+static size_t s_UploadBufferSize = 0;
+
+// The counters of decoded images, buffer allocations and conversions.
+static ImageDecoderStats s_Stats = { 0, 0, 0 };
+
+// Memory-map an image file so that it can be decoded without first being read into a buffer.
+
+static NSData* mapImageFile(const char* fileName)
+{
+    std::string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(fileName);
+    return [NSData dataWithContentsOfFile:[NSString stringWithUTF8String:fullPath.c_str()]
+                                  options:NSDataReadingMappedIfSafe
+                                    error:nil];
+}
+
+// Check whether or not a CGImage's pixels are laid out as premultiplied RGBA8888 already, so that drawing them doesn't need to convert them.
+
+static bool isPremultipliedRGBA8888(CGImageRef image)
+{
+    CGBitmapInfo byteOrder = CGImageGetBitmapInfo(image) & kCGBitmapByteOrderMask;
+    return (CGImageGetBitsPerComponent(image) == 8 &&
+            CGImageGetBitsPerPixel(image) == 32 &&
+            CGImageGetAlphaInfo(image) == kCGImageAlphaPremultipliedLast &&
+            (byteOrder == kCGBitmapByteOrderDefault || byteOrder == kCGBitmapByteOrder32Big));
+}
+
+// Check whether or not mapped image data is in the WebP format.
+
+static bool isWebP(NSData* data)
+{
+    const unsigned char* bytes = (const unsigned char*)[data bytes];
+    return ([data length] >= 12 && memcmp(bytes, "RIFF", 4) == 0 && memcmp(bytes + 8, "WEBP", 4) == 0);
+}
+
+// Create a CGImage from mapped image data without letting ImageIO keep its own decoded copy.
+
+static CGImageRef createCGImage(NSData* data)
+{
+    CGImageSourceRef source = CGImageSourceCreateWithData((CFDataRef)data, NULL);
+    if (!source)
+    {
+        return NULL;
+    }
+
+    NSDictionary* options = [NSDictionary dictionaryWithObject:[NSNumber numberWithBool:NO]
+                                                        forKey:(NSString*)kCGImageSourceShouldCache];
+    CGImageRef image = CGImageSourceCreateImageAtIndex(source, 0, (CFDictionaryRef)options);
+    CFRelease(source);
+
+    return image;
+}
+
+// Read the dimensions of an image without decoding it.
+
+bool ImageDecoder::getImageSize(const char* fileName, unsigned int* width, unsigned int* height)
+{
+    NSData* data = mapImageFile(fileName);
+    if (!data)
+    {
+        return false;
+    }
+
+    if (isWebP(data))
+    {
+        int webpWidth, webpHeight;
+        if (!WebPGetInfo((const uint8_t*)[data bytes], [data length], &webpWidth, &webpHeight))
+        {
+            return false;
+        }
+
+        *width = webpWidth;
+        *height = webpHeight;
+        return true;
+    }
+
+    CGImageRef image = createCGImage(data);
+    if (!image)
+    {
+        return false;
+    }
+
+    *width = CGImageGetWidth(image);
+    *height = CGImageGetHeight(image);
+    CGImageRelease(image);
+
+    return true;
+}
+
+// Decode an image directly into a caller-supplied buffer as premultiplied RGBA8888.
+
+bool ImageDecoder::decodeInto(const char* fileName, unsigned char* buffer, unsigned int bytesPerRow, unsigned int width, unsigned int height)
+{
+    NSData* data = mapImageFile(fileName);
+    if (!data || !buffer || bytesPerRow < width * 4)
+    {
+        return false;
+    }
+
+    bool succeeded = false;
+
+    // WebP images are decoded by libwebp, which can write premultiplied rows straight into external memory.
+    if (isWebP(data))
+    {
+        WebPDecoderConfig config;
+        if (!WebPInitDecoderConfig(&config) ||
+            WebPGetFeatures((const uint8_t*)[data bytes], [data length], &config.input) != VP8_STATUS_OK ||
+            config.input.width != (int)width ||
+            config.input.height != (int)height)
+        {
+            return false;
+        }
+
+        config.output.colorspace = MODE_rgbA;
+        config.output.is_external_memory = 1;
+        config.output.u.RGBA.rgba = buffer;
+        config.output.u.RGBA.stride = bytesPerRow;
+        config.output.u.RGBA.size = bytesPerRow * height;
+
+        succeeded = (WebPDecode((const uint8_t*)[data bytes], [data length], &config) == VP8_STATUS_OK);
+        WebPFreeDecBuffer(&config.output);
+    }
+
+    // Every other format is decoded by ImageIO, then drawn into a bitmap context that wraps the destination buffer.
+    else
+    {
+        CGImageRef image = createCGImage(data);
+        if (!image || CGImageGetWidth(image) != width || CGImageGetHeight(image) != height)
+        {
+            if (image) CGImageRelease(image);
+            return false;
+        }
+
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+        CGContextRef context = CGBitmapContextCreate(buffer, width, height, 8, bytesPerRow, colorSpace,
+                                                     kCGImageAlphaPremultipliedLast | kCGBitmapByteOrder32Big);
+        CGColorSpaceRelease(colorSpace);
+
+        if (context)
+        {
+            // Copy rather than blend, since the buffer may still hold a previous image.
+            CGContextSetBlendMode(context, kCGBlendModeCopy);
+            CGContextDrawImage(context, CGRectMake(0, 0, width, height), image);
+            CGContextRelease(context);
+            succeeded = true;
+
+            // Pixels in any other layout (ie. a PNG without alpha, or with unpremultiplied alpha) are converted by Core Graphics on their way into the buffer.
+            if (!isPremultipliedRGBA8888(image))
+            {
+                s_Stats.conversions++;
+            }
+        }
+
+        CGImageRelease(image);
+    }
+
+    if (succeeded)
+    {
+        s_Stats.imagesDecoded++;
+    }
+
+    return succeeded;
+}
+
+// Create a texture by decoding an image into a shared upload buffer and uploading it from there.
+
+CCTexture2D* ImageDecoder::createTexture(const char* fileName)
+{
+    unsigned int width, height;
+    if (!getImageSize(fileName, &width, &height))
+    {
+        CCLOG("Failed to read \"%s\".", fileName);
+        return NULL;
+    }
+
+    // Grow the upload buffer if this image doesn't fit in it. Images of the same size (ie. map tiles) reuse it without reallocating.
+    size_t requiredSize = width * height * 4;
+    if (requiredSize > s_UploadBufferSize)
+    {
+        free(s_UploadBuffer);
+        s_UploadBuffer = (unsigned char*)malloc(requiredSize);
+        s_UploadBufferSize = s_UploadBuffer ? requiredSize : 0;
+        s_Stats.bufferAllocations++;
+    }
+
+    if (!decodeInto(fileName, s_UploadBuffer, width * 4, width, height))
+    {
+        CCLOG("Failed to decode \"%s\".", fileName);
+        return NULL;
+    }
+
+    // The decoded data is already in the final format, so CCTexture2D uploads it without converting it.
+    DecodedTexture* texture = new DecodedTexture();
+    if (texture && texture->initWithData(s_UploadBuffer, kCCTexture2DPixelFormat_RGBA8888, width, height, CCSizeMake(width, height)))
+    {
+        texture->setHasPremultipliedAlpha(true);
+        texture->autorelease();
+        return texture;
+    }
+    CC_SAFE_DELETE(texture);
+    return NULL;
+}
+
+// Free the shared upload buffer.
+
+void ImageDecoder::releaseUploadBuffer()
+{
+    free(s_UploadBuffer);
+    s_UploadBuffer = NULL;
+    s_UploadBufferSize = 0;
+}
+
+// Get the counters accumulated since the last reset.
+
+const ImageDecoderStats& ImageDecoder::getStats()
+{
+    return s_Stats;
+}
+
+// Reset the counters.
+
+void ImageDecoder::resetStats()
+{
+    s_Stats.imagesDecoded = 0;
+    s_Stats.bufferAllocations = 0;
+    s_Stats.conversions = 0;
+}
@@ -0,0 +1,59 @@
+//
+//  MapPoint.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#ifndef MAP_POINT_H
+#define MAP_POINT_H
+
+#include <math.h>
+
+/**
+ @brief     A position in map space (the map's untransformed content coordinates, with (0,0) at the bottom-left).
+
+ Code which has no need for cocos2d (ie. geometry processing and spatial queries) uses this rather than CCPoint so that it can be compiled and run on its own.
+ */
+struct MapPoint
+{
+    float x;
+    float y;
+
+    MapPoint() : x(0), y(0) { }
+    MapPoint(float x, float y) : x(x), y(y) { }
+
+    MapPoint operator+(const MapPoint& other) const { return MapPoint(x + other.x, y + other.y); }
+    MapPoint operator-(const MapPoint& other) const { return MapPoint(x - other.x, y - other.y); }
+    MapPoint operator*(float factor) const { return MapPoint(x * factor, y * factor); }
+    bool operator==(const MapPoint& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const MapPoint& other) const { return !(*this == other); }
+
+    /**
+     @brief     Get the dot product of this and another point treated as vectors.
+     */
+    float dot(const MapPoint& other) const { return x * other.x + y * other.y; }
+
+    /**
+     @brief     Get the z component of the cross product of this and another point treated as vectors.
+     */
+    float cross(const MapPoint& other) const { return x * other.y - y * other.x; }
+
+    /**
+     @brief     Get the length of this point treated as a vector.
+     */
+    float length() const { return sqrtf(x * x + y * y); }
+
+    /**
+     @brief     Get the squared distance to another point, which avoids a square root when only comparing distances.
+     */
+    float distanceSquared(const MapPoint& other) const { return (x - other.x) * (x - other.x) + (y - other.y) * (y - other.y); }
+
+    /**
+     @brief     Get the distance to another point.
+     */
+    float distance(const MapPoint& other) const { return sqrtf(distanceSquared(other)); }
+};
+
+#endif // MAP_POINT_H
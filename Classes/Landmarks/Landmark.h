@@ -9,6 +9,24 @@
 #ifndef LANDMARK_H
 #define LANDMARK_H
 
+#include <stddef.h>
+
+/**
+ @brief     The kinds of place a landmark can be, as bit flags so that a landmark can be more than one (ie. a park which is also a monument).
+ */
+enum LandmarkCategory
+{
+    kLandmarkCategoryMuseum         = 1 << 0,
+    kLandmarkCategoryPark           = 1 << 1,
+    kLandmarkCategoryVenue          = 1 << 2,
+    kLandmarkCategoryBuilding       = 1 << 3,
+    kLandmarkCategoryMonument       = 1 << 4,
+    kLandmarkCategoryNeighbourhood  = 1 << 5
+};
+
+/** The number of landmark categories. */
+static const unsigned int LANDMARK_CATEGORY_COUNT = 6;
+
 /**
  @brief     A structure containing all of the information to be presented to the user regarding a landmark.
  */
@@ -32,6 +50,9 @@ struct Landmark
     /** The URL for buying tickets to the landmark if applicable (also optional). */
     const char* ticketsURL;
     
+    /** The landmark's categories, as a combination of LandmarkCategory flags (0 for none). */
+    unsigned int categories;
+    
     /**
      @brief     Default consructor which sets no data.
      */
@@ -45,13 +66,15 @@ struct Landmark
      @param     address         An address to be used by the Google Maps SDK in order to show directions to this landmark.
      @param     websiteURL      The URL of the landmark's website (optional, set to "" for none).
      @param     ticketsURL      The URL for buying tickets to the landmark if applicable (also optional).
+     @param     categories      The landmark's categories, as a combination of LandmarkCategory flags (also optional).
      */
     Landmark(const char* name,
              const char* imageFileName,
              const char* description,
              const char* address = NULL,
              const char* websiteURL = NULL,
-             const char* ticketsURL = NULL)
+             const char* ticketsURL = NULL,
+             unsigned int categories = 0)
     {
         this->name = name;
         this->imageFileName = imageFileName;
@@ -59,6 +82,7 @@ struct Landmark
         this->address = address;
         this->websiteURL = websiteURL;
         this->ticketsURL = ticketsURL;
+        this->categories = categories;
     }
 };
 
@@ -0,0 +1,499 @@
+//
+//  LandmarkBitset.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkBitset.h"
+#include <algorithm>
+#include <iterator>
+
+// The most indices a chunk keeps as an array. Beyond this, the array would take more memory than a bitmap.
+static const unsigned int MAX_ARRAY_COUNT = 4096;
+
+// The number of 32-bit words in a chunk's bitmap, covering all 65536 of its indices.
+static const unsigned int BITMAP_WORDS = 2048;
+
+// Count the bits set in a word.
+
+static inline unsigned int countBits(unsigned int word)
+{
+    return __builtin_popcount(word);
+}
+
+// Get a mask of the bits in a word from one bit up to but not including another (up to 32).
+
+static inline unsigned int getBitMask(unsigned int begin, unsigned int end)
+{
+    unsigned int below = (end >= 32) ? 0xFFFFFFFF : ((1u << end) - 1);
+    return below & ~((1u << begin) - 1);
+}
+
+// Default constructor.
+
+LandmarkBitset::LandmarkBitset()
+: m_Count(0)
+{
+}
+
+// Remove every index.
+
+void LandmarkBitset::clear()
+{
+    m_Chunks.clear();
+    m_Count = 0;
+}
+
+// Add an index to the set.
+
+void LandmarkBitset::add(unsigned int index)
+{
+    unsigned int key = index >> 16;
+    unsigned int value = index & 0xFFFF;
+
+    // Indices added in order always land in the last chunk, or start a new one after it.
+    unsigned int position = (!m_Chunks.empty() && m_Chunks.back().key <= key) ? m_Chunks.size() - 1 : findChunk(key);
+    if (position == m_Chunks.size() || m_Chunks[position].key != key)
+    {
+        if (position < m_Chunks.size() && m_Chunks[position].key < key)
+        {
+            position++;
+        }
+
+        Chunk chunk;
+        chunk.key = key;
+        chunk.count = 0;
+        m_Chunks.insert(m_Chunks.begin() + position, chunk);
+    }
+
+    Chunk& chunk = m_Chunks[position];
+    if (chunk.isBitmap())
+    {
+        unsigned int& word = chunk.words[value >> 5];
+        unsigned int bit = 1u << (value & 31);
+        if (word & bit)
+        {
+            return;
+        }
+        word |= bit;
+    }
+    else if (chunk.values.empty() || chunk.values.back() < value)
+    {
+        chunk.values.push_back(value);
+    }
+    else
+    {
+        std::vector<unsigned short>::iterator found = std::lower_bound(chunk.values.begin(), chunk.values.end(), value);
+        if (*found == value)
+        {
+            return;
+        }
+        chunk.values.insert(found, value);
+    }
+
+    chunk.count++;
+    m_Count++;
+
+    if (!chunk.isBitmap() && chunk.count > MAX_ARRAY_COUNT)
+    {
+        convertToBitmap(&chunk);
+    }
+}
+
+// Check whether or not an index is in the set.
+
+bool LandmarkBitset::contains(unsigned int index) const
+{
+    unsigned int position = findChunk(index >> 16);
+    if (position == m_Chunks.size() || m_Chunks[position].key != (index >> 16))
+    {
+        return false;
+    }
+
+    const Chunk& chunk = m_Chunks[position];
+    unsigned int value = index & 0xFFFF;
+    if (chunk.isBitmap())
+    {
+        return (chunk.words[value >> 5] >> (value & 31)) & 1;
+    }
+    return std::binary_search(chunk.values.begin(), chunk.values.end(), (unsigned short)value);
+}
+
+// Count the indices in the set within a range.
+
+unsigned int LandmarkBitset::countRange(unsigned int begin, unsigned int end) const
+{
+    if (end <= begin)
+    {
+        return 0;
+    }
+
+    // Whole chunks inside the range are counted by their totals, so only the chunks at either end are looked into.
+    unsigned int firstKey = begin >> 16;
+    unsigned int lastKey = (end - 1) >> 16;
+    unsigned int count = 0;
+
+    for (unsigned int i = findChunk(firstKey); i < m_Chunks.size() && m_Chunks[i].key <= lastKey; i++)
+    {
+        const Chunk& chunk = m_Chunks[i];
+        unsigned int chunkBegin = (chunk.key == firstKey) ? (begin & 0xFFFF) : 0;
+        unsigned int chunkEnd = (chunk.key == lastKey) ? ((end - 1) & 0xFFFF) + 1 : 0x10000;
+        count += (chunkBegin == 0 && chunkEnd == 0x10000) ? chunk.count : countInChunk(chunk, chunkBegin, chunkEnd);
+    }
+
+    return count;
+}
+
+// Find the first index in the set at or after a given index.
+
+unsigned int LandmarkBitset::findNext(unsigned int index) const
+{
+    unsigned int key = index >> 16;
+
+    for (unsigned int i = findChunk(key); i < m_Chunks.size(); i++)
+    {
+        const Chunk& chunk = m_Chunks[i];
+        unsigned int value = findNextInChunk(chunk, (chunk.key == key) ? (index & 0xFFFF) : 0);
+        if (value != NOT_FOUND)
+        {
+            return (chunk.key << 16) | value;
+        }
+    }
+
+    return NOT_FOUND;
+}
+
+// Add every index in another set to this one.
+
+void LandmarkBitset::unite(const LandmarkBitset& other)
+{
+    // Merge the two lists of chunks by key. Room is set aside first so that growing the list never copies the chunks' contents.
+    std::vector<Chunk> merged;
+    merged.reserve(m_Chunks.size() + other.m_Chunks.size());
+
+    unsigned int i = 0;
+    unsigned int j = 0;
+    m_Count = 0;
+
+    while (i < m_Chunks.size() || j < other.m_Chunks.size())
+    {
+        if (j == other.m_Chunks.size() || (i < m_Chunks.size() && m_Chunks[i].key <= other.m_Chunks[j].key))
+        {
+            merged.push_back(Chunk());
+            Chunk& chunk = merged.back();
+            chunk.key = m_Chunks[i].key;
+            chunk.count = m_Chunks[i].count;
+            chunk.values.swap(m_Chunks[i].values);
+            chunk.words.swap(m_Chunks[i].words);
+
+            if (j < other.m_Chunks.size() && other.m_Chunks[j].key == chunk.key)
+            {
+                uniteChunk(&chunk, other.m_Chunks[j++]);
+            }
+            i++;
+        }
+        else
+        {
+            merged.push_back(other.m_Chunks[j++]);
+        }
+
+        m_Count += merged.back().count;
+    }
+
+    m_Chunks.swap(merged);
+}
+
+// Remove every index which isn't also in another set.
+
+void LandmarkBitset::intersect(const LandmarkBitset& other)
+{
+    // Chunks are kept in place and compacted towards the front as the empty ones are dropped.
+    unsigned int kept = 0;
+    unsigned int j = 0;
+    m_Count = 0;
+
+    for (unsigned int i = 0; i < m_Chunks.size(); i++)
+    {
+        Chunk& chunk = m_Chunks[i];
+        while (j < other.m_Chunks.size() && other.m_Chunks[j].key < chunk.key)
+        {
+            j++;
+        }
+        if (j == other.m_Chunks.size())
+        {
+            break;
+        }
+        if (other.m_Chunks[j].key != chunk.key)
+        {
+            continue;
+        }
+
+        intersectChunk(&chunk, other.m_Chunks[j]);
+        if (chunk.count == 0)
+        {
+            continue;
+        }
+
+        if (kept != i)
+        {
+            Chunk& destination = m_Chunks[kept];
+            destination.key = chunk.key;
+            destination.count = chunk.count;
+            destination.values.swap(chunk.values);
+            destination.words.swap(chunk.words);
+        }
+        m_Count += chunk.count;
+        kept++;
+    }
+
+    m_Chunks.resize(kept);
+}
+
+// Swap the contents of this set with another without copying them.
+
+void LandmarkBitset::swap(LandmarkBitset& other)
+{
+    m_Chunks.swap(other.m_Chunks);
+    std::swap(m_Count, other.m_Count);
+}
+
+// Get the memory used by the set's chunks in bytes.
+
+unsigned long LandmarkBitset::getMemorySize() const
+{
+    unsigned long size = m_Chunks.capacity() * sizeof(Chunk);
+    for (unsigned int i = 0; i < m_Chunks.size(); i++)
+    {
+        size += m_Chunks[i].values.capacity() * sizeof(unsigned short) + m_Chunks[i].words.capacity() * sizeof(unsigned int);
+    }
+    return size;
+}
+
+// Find the chunk for an index's upper 16 bits.
+
+unsigned int LandmarkBitset::findChunk(unsigned int key) const
+{
+    unsigned int low = 0;
+    unsigned int high = m_Chunks.size();
+    while (low < high)
+    {
+        unsigned int middle = (low + high) / 2;
+        if (m_Chunks[middle].key < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Switch a chunk from an array to a bitmap.
+
+void LandmarkBitset::convertToBitmap(Chunk* chunk)
+{
+    chunk->words.assign(BITMAP_WORDS, 0);
+    for (unsigned int i = 0; i < chunk->values.size(); i++)
+    {
+        unsigned int value = chunk->values[i];
+        chunk->words[value >> 5] |= 1u << (value & 31);
+    }
+    std::vector<unsigned short>().swap(chunk->values);
+}
+
+// Switch a chunk from a bitmap to an array.
+
+void LandmarkBitset::convertToArray(Chunk* chunk)
+{
+    chunk->values.clear();
+    chunk->values.reserve(chunk->count);
+    for (unsigned int i = 0; i < BITMAP_WORDS; i++)
+    {
+        for (unsigned int word = chunk->words[i]; word != 0; word &= word - 1)
+        {
+            chunk->values.push_back((i << 5) | __builtin_ctz(word));
+        }
+    }
+    std::vector<unsigned int>().swap(chunk->words);
+}
+
+// Count the indices in a chunk whose lower 16 bits are within a range.
+
+unsigned int LandmarkBitset::countInChunk(const Chunk& chunk, unsigned int begin, unsigned int end)
+{
+    if (end <= begin)
+    {
+        return 0;
+    }
+
+    if (!chunk.isBitmap())
+    {
+        std::vector<unsigned short>::const_iterator first = std::lower_bound(chunk.values.begin(), chunk.values.end(), begin);
+        std::vector<unsigned short>::const_iterator last = std::lower_bound(first, chunk.values.end(), end);
+        return last - first;
+    }
+
+    // Mask off the parts of the first and last words outside of the range, and count the words between them whole.
+    unsigned int firstWord = begin >> 5;
+    unsigned int lastWord = (end - 1) >> 5;
+    if (firstWord == lastWord)
+    {
+        return countBits(chunk.words[firstWord] & getBitMask(begin & 31, ((end - 1) & 31) + 1));
+    }
+
+    unsigned int count = countBits(chunk.words[firstWord] & getBitMask(begin & 31, 32));
+    for (unsigned int i = firstWord + 1; i < lastWord; i++)
+    {
+        count += countBits(chunk.words[i]);
+    }
+    return count + countBits(chunk.words[lastWord] & getBitMask(0, ((end - 1) & 31) + 1));
+}
+
+// Find the first index in a chunk whose lower 16 bits are at least a value.
+
+unsigned int LandmarkBitset::findNextInChunk(const Chunk& chunk, unsigned int value)
+{
+    if (!chunk.isBitmap())
+    {
+        std::vector<unsigned short>::const_iterator found = std::lower_bound(chunk.values.begin(), chunk.values.end(), value);
+        return (found != chunk.values.end()) ? *found : NOT_FOUND;
+    }
+
+    unsigned int word = chunk.words[value >> 5] & getBitMask(value & 31, 32);
+    for (unsigned int i = value >> 5; ; )
+    {
+        if (word != 0)
+        {
+            return (i << 5) | __builtin_ctz(word);
+        }
+        if (++i == BITMAP_WORDS)
+        {
+            return NOT_FOUND;
+        }
+        word = chunk.words[i];
+    }
+}
+
+// Add every index in one chunk to another with the same key.
+
+void LandmarkBitset::uniteChunk(Chunk* chunk, const Chunk& other)
+{
+    if (!chunk->isBitmap() && !other.isBitmap())
+    {
+        std::vector<unsigned short> values;
+        values.reserve(chunk->values.size() + other.values.size());
+        std::set_union(chunk->values.begin(), chunk->values.end(), other.values.begin(), other.values.end(), std::back_inserter(values));
+        chunk->values.swap(values);
+        chunk->count = chunk->values.size();
+
+        if (chunk->count > MAX_ARRAY_COUNT)
+        {
+            convertToBitmap(chunk);
+        }
+        return;
+    }
+
+    // Once either side is a bitmap, so is the union.
+    if (!chunk->isBitmap())
+    {
+        convertToBitmap(chunk);
+    }
+
+    if (other.isBitmap())
+    {
+        unsigned int count = 0;
+        for (unsigned int i = 0; i < BITMAP_WORDS; i++)
+        {
+            chunk->words[i] |= other.words[i];
+            count += countBits(chunk->words[i]);
+        }
+        chunk->count = count;
+    }
+    else
+    {
+        for (unsigned int i = 0; i < other.values.size(); i++)
+        {
+            unsigned int value = other.values[i];
+            unsigned int& word = chunk->words[value >> 5];
+            unsigned int bit = 1u << (value & 31);
+            chunk->count += (word & bit) ? 0 : 1;
+            word |= bit;
+        }
+    }
+}
+
+// Remove every index from a chunk which isn't also in another with the same key.
+
+void LandmarkBitset::intersectChunk(Chunk* chunk, const Chunk& other)
+{
+    if (!chunk->isBitmap() && !other.isBitmap())
+    {
+        // Walk both arrays together, keeping the values they share. The kept values never overtake the ones still to be read.
+        unsigned int kept = 0;
+        unsigned int j = 0;
+        for (unsigned int i = 0; i < chunk->values.size() && j < other.values.size(); i++)
+        {
+            while (j < other.values.size() && other.values[j] < chunk->values[i])
+            {
+                j++;
+            }
+            if (j < other.values.size() && other.values[j] == chunk->values[i])
+            {
+                chunk->values[kept++] = chunk->values[i];
+            }
+        }
+        chunk->values.resize(kept);
+        chunk->count = kept;
+    }
+    else if (!chunk->isBitmap())
+    {
+        // Keep the array's values which are set in the other's bitmap.
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < chunk->values.size(); i++)
+        {
+            unsigned int value = chunk->values[i];
+            if ((other.words[value >> 5] >> (value & 31)) & 1)
+            {
+                chunk->values[kept++] = value;
+            }
+        }
+        chunk->values.resize(kept);
+        chunk->count = kept;
+    }
+    else if (!other.isBitmap())
+    {
+        // The other's array is no bigger than the result, so the chunk becomes an array of its values which are set here.
+        std::vector<unsigned short> values;
+        values.reserve(other.values.size());
+        for (unsigned int i = 0; i < other.values.size(); i++)
+        {
+            unsigned int value = other.values[i];
+            if ((chunk->words[value >> 5] >> (value & 31)) & 1)
+            {
+                values.push_back(value);
+            }
+        }
+        std::vector<unsigned int>().swap(chunk->words);
+        chunk->values.swap(values);
+        chunk->count = chunk->values.size();
+    }
+    else
+    {
+        unsigned int count = 0;
+        for (unsigned int i = 0; i < BITMAP_WORDS; i++)
+        {
+            chunk->words[i] &= other.words[i];
+            count += countBits(chunk->words[i]);
+        }
+        chunk->count = count;
+
+        if (count <= MAX_ARRAY_COUNT)
+        {
+            convertToArray(chunk);
+        }
+    }
+}
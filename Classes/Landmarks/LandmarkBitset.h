@@ -0,0 +1,157 @@
+//
+//  LandmarkBitset.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_BITSET_H
+#define LANDMARK_BITSET_H
+
+#include <vector>
+
+/**
+ @brief     A compressed set of landmark indices, used to combine filters (ie. categories and areas of the map) without visiting the landmarks one by one.
+
+ The indices are split into chunks of 65536 by their upper 16 bits, in the manner of a roaring bitmap. A chunk with only a few indices keeps them as a sorted array of their lower 16 bits, while a chunk with more than 4096 keeps a bitmap of 2048 words instead, whichever is smaller. Sparse sets (a rare category in a large catalog) therefore take two bytes per landmark, dense sets one bit per landmark, and unions and intersections work a whole word at a time where the chunks are dense.
+
+ Indices are cheapest to add in increasing order, since they are then appended to the last chunk.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class LandmarkBitset
+{
+public:
+
+    /** The value returned by findNext(...) when there is no index at or after the one given. */
+    static const unsigned int NOT_FOUND = 0xFFFFFFFF;
+
+    /**
+     @brief     Default constructor. The set is empty.
+     */
+    LandmarkBitset();
+
+    /**
+     @brief     Remove every index.
+     */
+    void clear();
+
+    /**
+     @brief     Add an index to the set, if it isn't already in it.
+     @param     index   The index to add.
+     */
+    void add(unsigned int index);
+
+    /**
+     @brief     Check whether or not an index is in the set.
+     */
+    bool contains(unsigned int index) const;
+
+    /**
+     @brief     Get the number of indices in the set.
+     */
+    unsigned int getCount() const { return m_Count; }
+
+    /**
+     @brief     Count the indices in the set within a range.
+     @param     begin   The first index of the range.
+     @param     end     The index after the last one of the range.
+     @return    The number of indices in the set from begin up to but not including end.
+     */
+    unsigned int countRange(unsigned int begin, unsigned int end) const;
+
+    /**
+     @brief     Find the first index in the set at or after a given index.
+     @param     index   The index to start from.
+     @return    The index that was found, or NOT_FOUND if there are none.
+     */
+    unsigned int findNext(unsigned int index) const;
+
+    /**
+     @brief     Add every index in another set to this one.
+     @param     other   The other set.
+     */
+    void unite(const LandmarkBitset& other);
+
+    /**
+     @brief     Remove every index which isn't also in another set.
+     @param     other   The other set.
+     */
+    void intersect(const LandmarkBitset& other);
+
+    /**
+     @brief     Swap the contents of this set with another without copying them.
+     @param     other   The other set.
+     */
+    void swap(LandmarkBitset& other);
+
+    /**
+     @brief     Get the memory used by the set's chunks in bytes.
+     */
+    unsigned long getMemorySize() const;
+
+private:
+
+    /**
+     @brief     The indices which share their upper 16 bits, kept either as a sorted array or as a bitmap.
+     */
+    struct Chunk
+    {
+        unsigned int key;
+        unsigned int count;
+        std::vector<unsigned short> values;
+        std::vector<unsigned int> words;
+
+        bool isBitmap() const { return !words.empty(); }
+    };
+
+    /**
+     @brief     Find the chunk for an index's upper 16 bits.
+     @param     key     The upper 16 bits.
+     @return    The position of the first chunk whose key is at least the one given.
+     */
+    unsigned int findChunk(unsigned int key) const;
+
+    /**
+     @brief     Switch a chunk from an array to a bitmap.
+     */
+    static void convertToBitmap(Chunk* chunk);
+
+    /**
+     @brief     Switch a chunk from a bitmap to an array.
+     */
+    static void convertToArray(Chunk* chunk);
+
+    /**
+     @brief     Count the indices in a chunk whose lower 16 bits are within a range.
+     @param     chunk   The chunk.
+     @param     begin   The start of the range.
+     @param     end     The end of the range, up to 65536.
+     */
+    static unsigned int countInChunk(const Chunk& chunk, unsigned int begin, unsigned int end);
+
+    /**
+     @brief     Find the first index in a chunk whose lower 16 bits are at least a value.
+     @return    The lower 16 bits of the index that was found, or NOT_FOUND if there are none.
+     */
+    static unsigned int findNextInChunk(const Chunk& chunk, unsigned int value);
+
+    /**
+     @brief     Add every index in one chunk to another with the same key.
+     */
+    static void uniteChunk(Chunk* chunk, const Chunk& other);
+
+    /**
+     @brief     Remove every index from a chunk which isn't also in another with the same key.
+     */
+    static void intersectChunk(Chunk* chunk, const Chunk& other);
+
+    /** The chunks which have indices in them, in order of their keys. */
+    std::vector<Chunk> m_Chunks;
+
+    /** The number of indices in the set. */
+    unsigned int m_Count;
+};
+
+#endif // LANDMARK_BITSET_H
@@ -9,15 +9,14 @@
 #include "LandmarkButton.h"
 #include "Defines.h"
 #include "LandmarkPopup.h"
+#include "AssetResolver.h"
+#include "ThumbnailAtlas.h"
 
 using namespace cocos2d;
 
-// A tag used to identify the CCAction that LandmarkButton::maintainOriginalScale(...) uses.
-#define TAG_SCALE_ACTION    12345
-
 // Create a LandmarkButton instance.
 
-LandmarkButton* LandmarkButton::create(Landmark landmark)
+LandmarkButton* LandmarkButton::create(LandmarkID landmark)
 {
     LandmarkButton *button = new LandmarkButton();
     if (button && button->init(landmark))
@@ -29,84 +28,126 @@ LandmarkButton* LandmarkButton::create(Landmark landmark)
     return NULL;
 }
 
+// Destructor.
+
+LandmarkButton::~LandmarkButton()
+{
+    releaseThumbnail();
+}
+
 // Initialize a LandmarkButton instance.
 
-bool LandmarkButton::init(Landmark landmark)
+bool LandmarkButton::init(LandmarkID landmark)
 {
+    m_Landmark = INVALID_LANDMARK_ID;
+    m_Thumbnail = NULL;
+    m_ThumbnailFileName[0] = '\0';
+    m_ThumbnailInAtlas = false;
+    
     // Perform the base class initialization, or quit now if it fails.
     if (!Button::init("landmarkButtonNormal.png", "landmarkButtonPressed.png", NULL, NULL))
     {
         return false;
     }
     
-    // Record the landmark data so that the Button can use it to create a LandmarkPopup when it is touched.
-    m_Landmark = landmark;
-    
     // If the user's finger moves between touching and releasing the LandmarkButton, the touch should be rejected.
     allowTouchMovement(false);
     
-    // Create a thumbnail sprite using the image file indicated by the landmark data.
-    char fullFileName[64];
-    sprintf(fullFileName, "%s_mini.png", m_Landmark.imageFileName);
-    CCSprite* thumbnail = CCSprite::create(fullFileName);
-    
-    // If the thumbnail was created successfully, add it as a child and end initialization.
-    if (thumbnail)
-    {
-        addChild(thumbnail);
-        thumbnail->setPosition(ccp(getContentSize().width/2, getContentSize().height/2));
-        
-        return true;
-    }
-    
-    // Otherwise, initialization has failed and we will abort.
-    else
+    // Create the thumbnail sprite in the middle of the button. Its image is set along with the landmark.
+    m_Thumbnail = CCSprite::create();
+    if (!m_Thumbnail)
     {
         return false;
     }
+    addChild(m_Thumbnail);
+    m_Thumbnail->setPosition(ccp(getContentSize().width/2, getContentSize().height/2));
+    
+    return setLandmark(landmark);
+}
+
+// Get the width of an unpressed LandmarkButton on screen.
+
+float LandmarkButton::getDisplayedWidth()
+{
+    float assetScale;
+    CCTexture2D* texture = AssetResolver::addImage("landmarkButtonNormal.png", &assetScale);
+    return texture ? texture->getContentSize().width * SCREEN_SCALE * 0.75f / assetScale : 0;
 }
 
-// Counteract the parent's scaling.
+// Rebind the button to display a different landmark.
 
-void LandmarkButton::maintainOriginalScale(float duration, cocos2d::CCPoint futureParentScale)
+bool LandmarkButton::setLandmark(LandmarkID landmark)
 {
-    // Figure out whether to use the parent's current scale or a predicted future scale.
-    CCPoint parentScale;
-    if (futureParentScale.x == 0 && futureParentScale.y == 0)
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    if (!store->isValid(landmark))
     {
-        parentScale = ccp(getParent()->getScaleX(), getParent()->getScaleY());
+        return false;
     }
-    else
+    
+    // Record the landmark's ID so that the Button can use it to create a LandmarkPopup when it is touched.
+    m_Landmark = landmark;
+    
+    // Work out which variant of the image indicated by the landmark data is displayed as the thumbnail. Nothing needs to be loaded if it hasn't changed.
+    char fullFileName[64];
+    snprintf(fullFileName, sizeof(fullFileName), "%s_mini.png", store->getImageKey(m_Landmark));
+    if (strcmp(fullFileName, m_ThumbnailFileName) == 0)
     {
-        parentScale = futureParentScale;
+        return true;
     }
     
-    // Using that information, figure out what scale to scale this Button to.
-    CCPoint newButtonScale = ccpMult(ccp((parentScale.x != 0) ? SCREEN_SCALE / parentScale.x : 0,
-                                         (parentScale.y != 0) ? SCREEN_SCALE / parentScale.y : 0),
-                                     isPressed() ? 1 : 0.75f);
+    releaseThumbnail();
     
-    // Since we now have a new scaling goal, stop any existing scaling action.
-    CCAction* scalingAction = getActionByTag(TAG_SCALE_ACTION);
-    if (scalingAction)
+    // Take the thumbnail from the shared atlas where possible, since it stays loaded there for other buttons to use...
+    float thumbnailAssetScale;
+    CCSpriteFrame* frame = ThumbnailAtlas::sharedAtlas()->acquireThumbnail(fullFileName, &thumbnailAssetScale);
+    if (frame)
     {
-        stopActionByTag(TAG_SCALE_ACTION);
+        // The atlas holds premultiplied alpha, but doesn't say so itself, so the blending has to be set to match.
+        ccBlendFunc blendFunc = { CC_BLEND_SRC, CC_BLEND_DST };
+        m_Thumbnail->setDisplayFrame(frame);
+        m_Thumbnail->setBlendFunc(blendFunc);
+        m_ThumbnailInAtlas = true;
     }
     
-    // If the new scaling action is instant, just set the scale directly.
-    if (duration == 0.0f)
+    // ...and otherwise give it a texture of its own.
+    else
     {
-        setScaleX(newButtonScale.x);
-        setScaleY(newButtonScale.y);
+        CCTexture2D* thumbnailTexture = AssetResolver::addImage(fullFileName, &thumbnailAssetScale);
+        if (!thumbnailTexture)
+        {
+            m_Thumbnail->setVisible(false);
+            return false;
+        }
+        m_Thumbnail->setTexture(thumbnailTexture);
+        m_Thumbnail->setTextureRect(CCRectMake(0, 0, thumbnailTexture->getContentSize().width, thumbnailTexture->getContentSize().height));
+        m_ThumbnailInAtlas = false;
     }
     
-    // If the new scaling action is meant to be gradual, use a CCAction.
-    else
+    strcpy(m_ThumbnailFileName, fullFileName);
+    m_Thumbnail->setScale(getAssetScale() / thumbnailAssetScale);
+    m_Thumbnail->setVisible(true);
+    
+    return true;
+}
+
+// Stop displaying the current thumbnail.
+
+void LandmarkButton::releaseThumbnail()
+{
+    if (m_ThumbnailInAtlas)
     {
-        CCAction* scalingAction = CCEaseOut::create(CCScaleTo::create(duration, newButtonScale.x, newButtonScale.y), 3);
-        scalingAction->setTag(TAG_SCALE_ACTION);
-        runAction(scalingAction);
+        ThumbnailAtlas::sharedAtlas()->releaseThumbnail(m_ThumbnailFileName);
     }
+    
+    m_ThumbnailFileName[0] = '\0';
+    m_ThumbnailInAtlas = false;
+}
+
+// Set the button's scale for its current state.
+
+void LandmarkButton::updateScale()
+{
+    setScale(SCREEN_SCALE * (isPressed() ? 1 : 0.75f) / getAssetScale());
 }
 
 // An extendable method which is called when a new touch on the button begins.
@@ -117,7 +158,7 @@ void LandmarkButton::onTouchBegan()
     Button::onTouchBegan();
     
     // Update the Button's scale.
-    maintainOriginalScale();
+    updateScale();
     
     // Set the z order to be in front of other buttons.
     setZOrder(1);
@@ -131,7 +172,7 @@ void LandmarkButton::onTouchMovedOff()
     Button::onTouchMovedOff();
     
     // Update the Button's scale.
-    maintainOriginalScale();
+    updateScale();
     
     // Set the z order to be on same level as other buttons.
     setZOrder(0);
@@ -145,7 +186,7 @@ void LandmarkButton::onTouchMovedOn()
     Button::onTouchMovedOn();
     
     // Update the Button's scale.
-    maintainOriginalScale();
+    updateScale();
     
     // Set the z order to be in front of other buttons.
     setZOrder(1);
@@ -159,7 +200,7 @@ void LandmarkButton::onTouchEnded()
     Button::onTouchEnded();
     
     // Update the Button's scale.
-    maintainOriginalScale();
+    updateScale();
     
     // Set the z order to be on same level as other buttons.
     setZOrder(0);
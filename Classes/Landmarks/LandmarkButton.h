@@ -11,7 +11,7 @@
 
 #include "cocos2d.h"
 #include "Button.h"
-#include "Landmark.h"
+#include "LandmarkStore.h"
 
 /**
  @brief     A button designed specifically for displaying information on a specified landmark.
@@ -22,26 +22,42 @@ public:
     
     /**
      @brief     Create a LandmarkButton instance.
-     @param     landmark    The landmark data to display.
+     @param     landmark    The ID of the landmark to display, in the shared LandmarkStore.
      @return    A pointer to the newly created button.
      */
-    static LandmarkButton* create(Landmark landmark);
+    static LandmarkButton* create(LandmarkID landmark);
     
     /**
-     @brief     Counteract the parent's scaling.
-     @param     duration            How long it should take to go to the original scale.
-     @param     futureParentScale   The scale that the parent is expected to be at at the end of the duration (use 0,0 for current).
+     @brief     Destructor.
      */
-    void maintainOriginalScale(float duration = 0.0f, cocos2d::CCPoint futureParentScale = cocos2d::CCPointZero);
+    virtual ~LandmarkButton();
+    
+    /**
+     @brief     Get the width of an unpressed LandmarkButton on screen, without having to create one.
+     @return    The width in view units.
+     */
+    static float getDisplayedWidth();
+    
+    /**
+     @brief     Rebind the button to display a different landmark, so that buttons can be reused rather than created for every landmark.
+     @param     landmark    The ID of the landmark to display, in the shared LandmarkStore.
+     @return    Whether or not the landmark's thumbnail could be displayed.
+     */
+    bool setLandmark(LandmarkID landmark);
+    
+    /**
+     @brief     Set the button's scale for its current state. LandmarkButtons are displayed in screen space, so the scale only depends on the screen and on whether or not the button is pressed.
+     */
+    void updateScale();
     
 protected:
     
     /**
      @brief     Initialize a LandmarkButton instance.
-     @param     landmark    The landmark data to display.
+     @param     landmark    The ID of the landmark to display, in the shared LandmarkStore.
      @return    Whether or not the LandmarkButton was initialized successfully.
      */
-    bool init(Landmark landmark);
+    bool init(LandmarkID landmark);
     
     /**
      @brief     An extendable method which is called when a new touch on the button begins.
@@ -70,8 +86,20 @@ protected:
     
 private:
     
-    /** The landmark data to be displayed. */
-    Landmark m_Landmark;
+    /**
+     @brief     Stop displaying the current thumbnail, giving it back to the ThumbnailAtlas if it came from there.
+     */
+    void releaseThumbnail();
+    
+    /** The ID of the landmark being displayed. */
+    LandmarkID m_Landmark;
+    
+    /** The sprite displaying the landmark's thumbnail. */
+    cocos2d::CCSprite* m_Thumbnail;
+    
+    /** The file name of the displayed thumbnail, and whether or not it came from the ThumbnailAtlas. */
+    char m_ThumbnailFileName[64];
+    bool m_ThumbnailInAtlas;
 };
 
 #endif // LANDMARK_BUTTON_H
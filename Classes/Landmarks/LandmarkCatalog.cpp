@@ -0,0 +1,207 @@
+//
+//  LandmarkCatalog.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-03.
+//
+//
+
+#include "LandmarkCatalog.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The file's identifying bytes, and the current version along with the oldest this code still understands.
+static const char* FILE_MAGIC = "NYLC";
+static const unsigned short FILE_VERSION = 2;
+static const unsigned short OLDEST_FILE_VERSION = 1;
+
+// The size in bytes of the file header and a pair of coordinates.
+static const unsigned long HEADER_SIZE = 32;
+static const unsigned long COORDINATES_SIZE = 8;
+
+// The number of strings in a record, the number of fields in a whole record (version 1 records stop after the strings), and the offset stored for a string which is left out.
+static const unsigned int RECORD_STRING_COUNT = 6;
+static const unsigned int RECORD_FIELD_COUNT = 7;
+static const unsigned int NO_STRING = 0xFFFFFFFF;
+
+// Read little-endian values from the header regardless of the host's byte order.
+
+static unsigned short readUInt16(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int readUInt32(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+// Check whether or not a section of the file starts on a 4-byte boundary and fits inside the file.
+
+static bool isSectionValid(unsigned long offset, unsigned long count, unsigned long elementSize, unsigned long fileSize)
+{
+    return (offset % 4 == 0 && offset >= HEADER_SIZE && offset <= fileSize && count <= (fileSize - offset) / elementSize);
+}
+
+// Default constructor.
+
+LandmarkCatalog::LandmarkCatalog()
+: m_Mapping(NULL)
+, m_MappingSize(0)
+, m_Count(0)
+, m_Records(NULL)
+, m_RecordFieldCount(RECORD_FIELD_COUNT)
+, m_Coordinates(NULL)
+, m_Strings(NULL)
+, m_StringsSize(0)
+{
+}
+
+// Destructor.
+
+LandmarkCatalog::~LandmarkCatalog()
+{
+    close();
+}
+
+// Map a catalog file.
+
+bool LandmarkCatalog::open(const char* path)
+{
+    close();
+
+    // The records and coordinates are used in place, so the host has to share the file's byte order. Every iOS device is little-endian.
+    unsigned short byteOrderProbe = 1;
+    if (*(unsigned char*)&byteOrderProbe != 1)
+    {
+        return false;
+    }
+
+    int file = ::open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t)HEADER_SIZE)
+    {
+        mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    // The mapping stays valid once the file is closed.
+    ::close(file);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_Mapping = mapping;
+    m_MappingSize = status.st_size;
+
+    // Check the header, and that every section it describes lies within the file. Nothing else in the file needs to be read up front.
+    const unsigned char* bytes = (const unsigned char*)m_Mapping;
+    unsigned int count = readUInt32(bytes + 8);
+    unsigned int recordsOffset = readUInt32(bytes + 12);
+    unsigned int coordinatesOffset = readUInt32(bytes + 16);
+    unsigned int stringsOffset = readUInt32(bytes + 20);
+    unsigned int stringsSize = readUInt32(bytes + 24);
+    unsigned int fileSize = readUInt32(bytes + 28);
+    unsigned short version = readUInt16(bytes + 4);
+    unsigned int recordFieldCount = (version == OLDEST_FILE_VERSION) ? RECORD_STRING_COUNT : RECORD_FIELD_COUNT;
+
+    if (memcmp(bytes, FILE_MAGIC, 4) != 0 || version < OLDEST_FILE_VERSION || version > FILE_VERSION || fileSize != m_MappingSize ||
+        !isSectionValid(recordsOffset, count, recordFieldCount * 4, m_MappingSize) ||
+        !isSectionValid(coordinatesOffset, count, COORDINATES_SIZE, m_MappingSize) ||
+        !isSectionValid(stringsOffset, stringsSize, 1, m_MappingSize) ||
+        stringsSize == 0 || bytes[stringsOffset + stringsSize - 1] != '\0')
+    {
+        close();
+        return false;
+    }
+
+    // Since the string table ends with a zero byte, every string starting inside it is terminated.
+    m_Count = count;
+    m_Records = (const unsigned int*)(bytes + recordsOffset);
+    m_RecordFieldCount = recordFieldCount;
+    m_Coordinates = (const float*)(bytes + coordinatesOffset);
+    m_Strings = (const char*)(bytes + stringsOffset);
+    m_StringsSize = stringsSize;
+    return true;
+}
+
+// Unmap the catalog file.
+
+void LandmarkCatalog::close()
+{
+    if (m_Mapping)
+    {
+        munmap(m_Mapping, m_MappingSize);
+    }
+
+    m_Mapping = NULL;
+    m_MappingSize = 0;
+    m_Count = 0;
+    m_Records = NULL;
+    m_RecordFieldCount = RECORD_FIELD_COUNT;
+    m_Coordinates = NULL;
+    m_Strings = NULL;
+    m_StringsSize = 0;
+}
+
+// Get a landmark's data, with its strings pointing into the catalog.
+
+Landmark LandmarkCatalog::getLandmark(unsigned int index) const
+{
+    const unsigned int* record = m_Records + index * m_RecordFieldCount;
+    return Landmark(getString(record[kLandmarkCatalogStringName]),
+                    getString(record[kLandmarkCatalogStringImageFileName]),
+                    getString(record[kLandmarkCatalogStringDescription]),
+                    getString(record[kLandmarkCatalogStringAddress]),
+                    getString(record[kLandmarkCatalogStringWebsiteURL]),
+                    getString(record[kLandmarkCatalogStringTicketsURL]),
+                    getCategories(index));
+}
+
+// Get a landmark's categories.
+
+unsigned int LandmarkCatalog::getCategories(unsigned int index) const
+{
+    return (m_RecordFieldCount > RECORD_STRING_COUNT) ? m_Records[index * m_RecordFieldCount + RECORD_STRING_COUNT] : 0;
+}
+
+// Get a landmark's position on the map.
+
+MapPoint LandmarkCatalog::getCoordinates(unsigned int index) const
+{
+    return MapPoint(m_Coordinates[index * 2], m_Coordinates[index * 2 + 1]);
+}
+
+// Get a checksum of the whole catalog file.
+
+unsigned int LandmarkCatalog::getChecksum() const
+{
+    if (!m_Mapping)
+    {
+        return 0;
+    }
+
+    const unsigned char* bytes = (const unsigned char*)m_Mapping;
+    unsigned int hash = 2166136261u;
+    for (unsigned long i = 0; i < m_MappingSize; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Get a string from the string table.
+
+const char* LandmarkCatalog::getString(unsigned int offset) const
+{
+    return (offset != NO_STRING && offset < m_StringsSize) ? m_Strings + offset : NULL;
+}
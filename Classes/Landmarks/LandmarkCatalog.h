@@ -0,0 +1,159 @@
+//
+//  LandmarkCatalog.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-03.
+//
+//
+
+#ifndef LANDMARK_CATALOG_H
+#define LANDMARK_CATALOG_H
+
+#include "Landmark.h"
+#include "MapPoint.h"
+
+/**
+ @brief     The strings in a landmark's record, in the order they are stored.
+ */
+enum LandmarkCatalogString
+{
+    kLandmarkCatalogStringName = 0,
+    kLandmarkCatalogStringImageFileName,
+    kLandmarkCatalogStringDescription,
+    kLandmarkCatalogStringAddress,
+    kLandmarkCatalogStringWebsiteURL,
+    kLandmarkCatalogStringTicketsURL
+};
+
+/**
+ @brief     A landmark catalog as produced by Tools/LandmarkCatalogBuilder.cpp (ie. "landmarks.nylc"), memory-mapped and read in place.
+
+ All values are little-endian, and every section starts on a 4-byte boundary:
+
+     char[4]    "NYLC"
+     uint16     Format version (2)
+     uint16     Reserved
+     uint32     Landmark count
+     uint32     Offset of the records from the start of the file
+     uint32     Offset of the coordinates
+     uint32     Offset of the string table
+     uint32     Size of the string table in bytes
+     uint32     Size of the whole file in bytes
+
+ followed by the records, one per landmark:
+
+     uint32[6]  The offsets of the name, image file name, description, address, website URL and tickets URL in the string table, or 0xFFFFFFFF for none
+     uint32     The landmark's categories, as a combination of LandmarkCategory flags
+
+ then the coordinates, one pair per landmark:
+
+     float32[2] The landmark's position on the map (ranging from bottom-left (0,0) to top-right (1,1))
+
+ and finally the string table, which holds every string with a terminating zero byte.
+
+ Version 1 catalogs are still read. Their records have no categories, so their landmarks have none.
+
+ Opening a catalog only maps the file and checks its header, so it takes the same time however many landmarks there are. The records and coordinates are read straight out of the mapping, and the strings of the Landmarks it returns point into it, so they are only valid while the catalog is open. The LandmarkStore keeps the catalog it reads its landmarks from open for as long as it holds them.
+
+ This class has no dependencies on cocos2d so that the format can be read and tested on its own.
+ */
+class LandmarkCatalog
+{
+public:
+
+    /**
+     @brief     Default constructor. The catalog is empty until it is opened.
+     */
+    LandmarkCatalog();
+
+    /**
+     @brief     Destructor. Unmaps the file.
+     */
+    ~LandmarkCatalog();
+
+    /**
+     @brief     Map a catalog file, closing any catalog which was already open.
+     @param     path    The full path of the file.
+     @return    Whether or not the file was a valid catalog. If not, the catalog is left empty.
+     */
+    bool open(const char* path);
+
+    /**
+     @brief     Unmap the catalog file, leaving the catalog empty.
+     */
+    void close();
+
+    /**
+     @brief     Get the number of landmarks in the catalog.
+     */
+    unsigned int getCount() const { return m_Count; }
+
+    /**
+     @brief     Get the size of the string table in bytes, ie. to set aside memory for copies of the strings.
+     */
+    unsigned int getStringTableSize() const { return m_StringsSize; }
+
+    /**
+     @brief     Get a landmark's data, with its strings pointing into the catalog.
+     @param     index   The landmark's index in the catalog.
+     @return    The landmark's data.
+     */
+    Landmark getLandmark(unsigned int index) const;
+
+    /**
+     @brief     Get one of a landmark's strings, without reading the rest of its record.
+     @param     index   The landmark's index in the catalog.
+     @param     string  Which of the landmark's strings to get.
+     @return    A pointer to the string in the catalog, or NULL if the landmark doesn't have one.
+     */
+    const char* getString(unsigned int index, LandmarkCatalogString string) const { return getString(m_Records[index * m_RecordFieldCount + string]); }
+
+    /**
+     @brief     Get a landmark's categories.
+     @param     index   The landmark's index in the catalog.
+     @return    The landmark's categories, as a combination of LandmarkCategory flags.
+     */
+    unsigned int getCategories(unsigned int index) const;
+
+    /**
+     @brief     Get a landmark's position on the map.
+     @param     index   The landmark's index in the catalog.
+     @return    The landmark's position, ranging from bottom-left (0,0) to top-right (1,1).
+     */
+    MapPoint getCoordinates(unsigned int index) const;
+
+    /**
+     @brief     Get a checksum of the whole catalog file, ie. to check that a search index was built from it. It reads every byte of the file, so it is worked out each time it is asked for rather than when the catalog is opened.
+     @return    The 32-bit FNV-1a hash of the file's bytes, or 0 if no catalog is open.
+     */
+    unsigned int getChecksum() const;
+
+private:
+
+    /**
+     @brief     Declared as private because a catalog owns its mapping and can't be copied.
+     */
+    LandmarkCatalog(const LandmarkCatalog&);
+    LandmarkCatalog& operator=(const LandmarkCatalog&);
+
+    /**
+     @brief     Get a string from the string table.
+     @param     offset  The string's offset in the table, as stored in a record.
+     @return    A pointer to the string, or NULL for none or an offset outside of the table.
+     */
+    const char* getString(unsigned int offset) const;
+
+    /** The mapped file and its size in bytes. */
+    void* m_Mapping;
+    unsigned long m_MappingSize;
+
+    /** The number of landmarks, and where each section starts within the mapping. */
+    unsigned int m_Count;
+    const unsigned int* m_Records;
+    unsigned int m_RecordFieldCount;
+    const float* m_Coordinates;
+    const char* m_Strings;
+    unsigned int m_StringsSize;
+};
+
+#endif // LANDMARK_CATALOG_H
@@ -0,0 +1,80 @@
+//
+//  LandmarkCategoryIndex.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkCategoryIndex.h"
+
+using namespace std;
+
+// Default constructor.
+
+LandmarkCategoryIndex::LandmarkCategoryIndex()
+: m_Count(0)
+{
+}
+
+// Index a set of landmarks.
+
+void LandmarkCategoryIndex::build(const vector<unsigned int>& categories)
+{
+    for (unsigned int i = 0; i < LANDMARK_CATEGORY_COUNT; i++)
+    {
+        m_Categories[i].clear();
+    }
+    m_All.clear();
+    m_Count = categories.size();
+
+    // Landmarks are added in order, so each one is appended to the end of its sets.
+    for (unsigned int i = 0; i < m_Count; i++)
+    {
+        for (unsigned int category = 0; category < LANDMARK_CATEGORY_COUNT; category++)
+        {
+            if (categories[i] & (1 << category))
+            {
+                m_Categories[category].add(i);
+            }
+        }
+
+        m_All.add(i);
+    }
+}
+
+// Find the landmarks in a combination of categories.
+
+void LandmarkCategoryIndex::find(unsigned int categories, bool matchAll, LandmarkBitset* result) const
+{
+    if (!(categories & ((1 << LANDMARK_CATEGORY_COUNT) - 1)))
+    {
+        *result = m_All;
+        return;
+    }
+
+    // Start from the first category asked for, then combine the rest with it.
+    bool isFirst = true;
+
+    for (unsigned int category = 0; category < LANDMARK_CATEGORY_COUNT; category++)
+    {
+        if (!(categories & (1 << category)))
+        {
+            continue;
+        }
+
+        if (isFirst)
+        {
+            *result = m_Categories[category];
+            isFirst = false;
+        }
+        else if (matchAll)
+        {
+            result->intersect(m_Categories[category]);
+        }
+        else
+        {
+            result->unite(m_Categories[category]);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+//
+//  LandmarkCategoryIndex.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_CATEGORY_INDEX_H
+#define LANDMARK_CATEGORY_INDEX_H
+
+#include <vector>
+#include "Landmark.h"
+#include "LandmarkBitset.h"
+
+/**
+ @brief     A LandmarkBitset of the landmarks in each category, so that filtering the landmarks by category combines whole sets rather than testing every landmark.
+
+ Categories are combined either as a union (landmarks in any of them) or an intersection (landmarks in all of them). Asking for no categories matches every landmark.
+
+ Landmarks are numbered by their order in the lists the index is built from, which needn't be their IDs. LandmarkLayer builds it in the order of its clusters, so that the landmarks of each cluster are a range of the results which can be counted without visiting them.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class LandmarkCategoryIndex
+{
+public:
+
+    /**
+     @brief     Default constructor. The index is empty until it is built.
+     */
+    LandmarkCategoryIndex();
+
+    /**
+     @brief     Index a set of landmarks.
+     @param     categories  The categories of each landmark, as combinations of LandmarkCategory flags.
+     */
+    void build(const std::vector<unsigned int>& categories);
+
+    /**
+     @brief     Get the number of landmarks in the index.
+     */
+    unsigned int getCount() const { return m_Count; }
+
+    /**
+     @brief     Find the landmarks in a combination of categories.
+     @param     categories  A combination of LandmarkCategory flags, or 0 to match every landmark.
+     @param     matchAll    Whether to find the landmarks in all of the categories rather than in any of them.
+     @param     result      Receives the landmarks that were found, replacing its contents.
+     */
+    void find(unsigned int categories, bool matchAll, LandmarkBitset* result) const;
+
+private:
+
+    /** The landmarks in each category, indexed by the category's bit. */
+    LandmarkBitset m_Categories[LANDMARK_CATEGORY_COUNT];
+
+    /** Every landmark, which is what asking for no categories matches. */
+    LandmarkBitset m_All;
+
+    /** The number of landmarks in the index. */
+    unsigned int m_Count;
+};
+
+#endif // LANDMARK_CATEGORY_INDEX_H
@@ -0,0 +1,263 @@
+//
+//  LandmarkClusterIndex.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-02.
+//
+//
+
+#include "LandmarkClusterIndex.h"
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+// Each level's scale is this much smaller than the one before it.
+static const float LEVEL_FACTOR = 1.41421356f;
+
+// The most cells across and down each level's grid.
+static const unsigned int MAX_GRID_SIZE = 64;
+
+/**
+ @brief     Orders clusters so that the largest are merged first, keeping their original order otherwise.
+ */
+struct LargerClusterFirst
+{
+    const vector<LandmarkCluster>* clusters;
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return (*clusters)[a].count > (*clusters)[b].count;
+    }
+};
+
+// Default constructor.
+
+LandmarkClusterIndex::LandmarkClusterIndex()
+{
+}
+
+// Cluster a set of landmarks.
+
+void LandmarkClusterIndex::build(const vector<MapPoint>& positions, const MapPoint& mapSize, float radius, float minScale, float maxScale)
+{
+    m_Levels.clear();
+    m_Order.clear();
+    m_MapSize = mapSize;
+
+    if (positions.empty() || radius <= 0 || minScale <= 0 || maxScale < minScale)
+    {
+        return;
+    }
+
+    // Start with every landmark on its own...
+    m_Levels.push_back(Level());
+    Level& finest = m_Levels.back();
+    finest.scale = maxScale;
+    finest.clusters.resize(positions.size());
+
+    unsigned int gridSize = min(max((unsigned int)(mapSize.x * maxScale / radius), 1u), MAX_GRID_SIZE);
+    finest.grid.reset(mapSize.x, mapSize.y, gridSize, gridSize);
+
+    for (unsigned int i = 0; i < positions.size(); i++)
+    {
+        LandmarkCluster& cluster = finest.clusters[i];
+        cluster.position = positions[i];
+        cluster.count = 1;
+        cluster.landmark = i;
+        cluster.parent = i;
+        cluster.first = i;
+        finest.grid.insert(i, positions[i]);
+    }
+
+    // ...and merge those which still overlap at the largest scale. The landmarks on their own aren't kept as a level, since a dense enough catalog would have too many of them on screen at once.
+    addLevel(maxScale, radius);
+    vector<unsigned int> landmarkClusters(positions.size());
+    for (unsigned int i = 0; i < positions.size(); i++)
+    {
+        landmarkClusters[i] = m_Levels[0].clusters[i].parent;
+    }
+    m_Levels.erase(m_Levels.begin());
+
+    // Keep merging until the levels cover the smallest scale, or everything is in one cluster.
+    while (m_Levels.size() < MAX_LEVELS && m_Levels.back().scale > minScale && m_Levels.back().clusters.size() > 1)
+    {
+        addLevel(m_Levels.back().scale / LEVEL_FACTOR, radius);
+    }
+
+    orderLandmarks(landmarkClusters);
+}
+
+// Build the next coarser level by merging the clusters of the current coarsest level.
+
+void LandmarkClusterIndex::addLevel(float scale, float radius)
+{
+    m_Levels.push_back(Level());
+    Level& previous = m_Levels[m_Levels.size() - 2];
+    Level& level = m_Levels.back();
+    level.scale = scale;
+
+    // The radius in map units at this level's scale.
+    float mapRadius = radius / scale;
+
+    // Visit the largest clusters first so that they absorb their smaller neighbours rather than the other way round.
+    vector<unsigned int> order(previous.clusters.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    LargerClusterFirst comparison;
+    comparison.clusters = &previous.clusters;
+    stable_sort(order.begin(), order.end(), comparison);
+
+    vector<bool> merged(previous.clusters.size(), false);
+    vector<unsigned int> neighbours;
+
+    for (unsigned int orderIt = 0; orderIt < order.size(); orderIt++)
+    {
+        unsigned int index = order[orderIt];
+        if (merged[index])
+        {
+            continue;
+        }
+
+        // Start a new cluster from this one...
+        const LandmarkCluster& seed = previous.clusters[index];
+        unsigned int newIndex = level.clusters.size();
+        MapPoint weightedSum = seed.position * (float)seed.count;
+        unsigned int count = seed.count;
+
+        merged[index] = true;
+        previous.clusters[index].parent = newIndex;
+
+        // ...and merge in every cluster within the radius of it which hasn't been merged already.
+        neighbours.clear();
+        previous.grid.findInRect(seed.position - MapPoint(mapRadius, mapRadius), seed.position + MapPoint(mapRadius, mapRadius), &neighbours);
+        for (unsigned int i = 0; i < neighbours.size(); i++)
+        {
+            LandmarkCluster& neighbour = previous.clusters[neighbours[i]];
+            if (merged[neighbours[i]] || neighbour.position.distance(seed.position) > mapRadius)
+            {
+                continue;
+            }
+
+            weightedSum = weightedSum + neighbour.position * (float)neighbour.count;
+            count += neighbour.count;
+            merged[neighbours[i]] = true;
+            neighbour.parent = newIndex;
+        }
+
+        LandmarkCluster cluster;
+        cluster.position = weightedSum * (1.0f / count);
+        cluster.count = count;
+        cluster.landmark = seed.landmark;
+        cluster.parent = newIndex;
+        cluster.first = 0;
+        level.clusters.push_back(cluster);
+    }
+
+    // Index the new clusters by position.
+    unsigned int gridSize = min(max((unsigned int)(m_MapSize.x / mapRadius), 1u), MAX_GRID_SIZE);
+    level.grid.reset(m_MapSize.x, m_MapSize.y, gridSize, gridSize);
+    for (unsigned int i = 0; i < level.clusters.size(); i++)
+    {
+        level.grid.insert(i, level.clusters[i].position);
+    }
+}
+
+// Put the landmarks in cluster order, giving each cluster the range its landmarks take up.
+
+void LandmarkClusterIndex::orderLandmarks(const vector<unsigned int>& landmarkClusters)
+{
+    // Lay the coarsest clusters out one after another...
+    vector<unsigned int> next;
+    Level& coarsest = m_Levels.back();
+    unsigned int first = 0;
+    for (unsigned int i = 0; i < coarsest.clusters.size(); i++)
+    {
+        coarsest.clusters[i].first = first;
+        first += coarsest.clusters[i].count;
+    }
+
+    // ...then share each cluster's range out among its children at the next finer level, and so on down. A parent's count is the sum of its children's, so they fill its range exactly.
+    for (unsigned int level = m_Levels.size() - 1; level > 0; level--)
+    {
+        const vector<LandmarkCluster>& parents = m_Levels[level].clusters;
+        vector<LandmarkCluster>& children = m_Levels[level - 1].clusters;
+
+        next.resize(parents.size());
+        for (unsigned int i = 0; i < parents.size(); i++)
+        {
+            next[i] = parents[i].first;
+        }
+        for (unsigned int i = 0; i < children.size(); i++)
+        {
+            children[i].first = next[children[i].parent];
+            next[children[i].parent] += children[i].count;
+        }
+    }
+
+    // Finally, give each landmark a place in its finest cluster's range.
+    const vector<LandmarkCluster>& finest = m_Levels[0].clusters;
+    next.resize(finest.size());
+    for (unsigned int i = 0; i < finest.size(); i++)
+    {
+        next[i] = finest[i].first;
+    }
+
+    m_Order.resize(landmarkClusters.size());
+    for (unsigned int i = 0; i < landmarkClusters.size(); i++)
+    {
+        m_Order[next[landmarkClusters[i]]++] = i;
+    }
+}
+
+// Find which level to display at a scale, and how far its clusters have split from their parents.
+
+void LandmarkClusterIndex::findLevel(float scale, unsigned int* level, float* split) const
+{
+    *level = 0;
+    *split = 1;
+
+    if (m_Levels.empty() || scale >= m_Levels[0].scale)
+    {
+        return;
+    }
+
+    // Between two levels' scales, the finer level is displayed part of the way out from its parents, measured in log scale so that the split happens at an even pace while pinching.
+    for (unsigned int i = 1; i < m_Levels.size(); i++)
+    {
+        if (scale >= m_Levels[i].scale)
+        {
+            *level = i - 1;
+            *split = logf(scale / m_Levels[i].scale) / logf(m_Levels[i - 1].scale / m_Levels[i].scale);
+            return;
+        }
+    }
+
+    *level = m_Levels.size() - 1;
+}
+
+// Get where a cluster is displayed while it splits from its parent.
+
+MapPoint LandmarkClusterIndex::getSplitPosition(unsigned int level, unsigned int cluster, float split) const
+{
+    const LandmarkCluster& child = m_Levels[level].clusters[cluster];
+    if (split >= 1 || level + 1 >= m_Levels.size())
+    {
+        return child.position;
+    }
+
+    const MapPoint& parentPosition = m_Levels[level + 1].clusters[child.parent].position;
+    return parentPosition + (child.position - parentPosition) * split;
+}
+
+// Find every cluster in a level whose own position is inside a rectangle.
+
+void LandmarkClusterIndex::findInRect(unsigned int level, const MapPoint& minimum, const MapPoint& maximum, vector<unsigned int>* clusters) const
+{
+    if (level < m_Levels.size())
+    {
+        m_Levels[level].grid.findInRect(minimum, maximum, clusters);
+    }
+}
@@ -0,0 +1,151 @@
+//
+//  LandmarkClusterIndex.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-02.
+//
+//
+
+#ifndef LANDMARK_CLUSTER_INDEX_H
+#define LANDMARK_CLUSTER_INDEX_H
+
+#include <vector>
+#include "MapPoint.h"
+#include "LandmarkGrid.h"
+
+/**
+ @brief     A group of landmarks which are too close together to be displayed separately at some zoom level.
+ */
+struct LandmarkCluster
+{
+    /** The average position of the cluster's landmarks in map space. */
+    MapPoint position;
+
+    /** The number of landmarks in the cluster. */
+    unsigned int count;
+
+    /** The index of one of the cluster's landmarks. If the cluster has only one, it is that landmark. */
+    unsigned int landmark;
+
+    /** The index of the cluster containing this one at the next coarser level. At the coarsest level, the cluster's own index. */
+    unsigned int parent;
+
+    /** Where the cluster's landmarks start in the index's order (see LandmarkClusterIndex::getOrder()). They take up the next count places. */
+    unsigned int first;
+};
+
+/**
+ @brief     Landmarks grouped into clusters at a series of zoom levels, so that the number of markers on screen depends on the screen's area rather than on how many landmarks there are.
+
+ Level 0 is used at the largest scale, and only groups the landmarks which would still appear within a set radius of each other on screen there. Each following level is used at a smaller scale and merges the clusters of the level before it which would appear within the radius at its own scale. Every cluster knows its parent at the next level, so clusters can be split apart smoothly as the map zooms in: between two levels' scales, the finer level's clusters are displayed part of the way from their parent's position towards their own.
+
+ The levels are built once up front. Each level keeps its clusters in a LandmarkGrid so that only those near the screen need to be looked at.
+
+ The landmarks are also put in an order where those of each cluster, at every level, come one after another. Anything kept in that order (ie. a LandmarkBitset of the landmarks which pass a filter) can then be looked up for a whole cluster as a single range.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class LandmarkClusterIndex
+{
+public:
+
+    /** The most levels an index will build. */
+    static const unsigned int MAX_LEVELS = 16;
+
+    /**
+     @brief     Default constructor. The index is empty until it is built.
+     */
+    LandmarkClusterIndex();
+
+    /**
+     @brief     Cluster a set of landmarks.
+     @param     positions   The position of each landmark in map space, indexed by landmark.
+     @param     mapSize     The size of the map in map units.
+     @param     radius      How close together (in view units) landmarks have to appear for them to be clustered.
+     @param     minScale    The smallest scale the map will be displayed at. Levels are built until they cover it.
+     @param     maxScale    The largest scale the map will be displayed at.
+     */
+    void build(const std::vector<MapPoint>& positions, const MapPoint& mapSize, float radius, float minScale, float maxScale);
+
+    /**
+     @brief     Get the number of levels in the index.
+     */
+    unsigned int getLevelCount() const { return m_Levels.size(); }
+
+    /**
+     @brief     Get the scale at or above which a level's clusters are displayed fully apart.
+     */
+    float getLevelScale(unsigned int level) const { return m_Levels[level].scale; }
+
+    /**
+     @brief     Get every cluster in a level.
+     */
+    const std::vector<LandmarkCluster>& getClusters(unsigned int level) const { return m_Levels[level].clusters; }
+
+    /**
+     @brief     Find which level to display at a scale, and how far its clusters have split from their parents.
+     @param     scale       The map's scale.
+     @param     level       Receives the level to display.
+     @param     split       Receives how far each cluster is from its parent's position towards its own (0 to 1). It is always 1 at the coarsest level.
+     */
+    void findLevel(float scale, unsigned int* level, float* split) const;
+
+    /**
+     @brief     Get where a cluster is displayed while it splits from its parent.
+     @param     level       The cluster's level.
+     @param     cluster     The cluster's index within the level.
+     @param     split       How far the cluster has split from its parent (0 to 1), as given by findLevel(...).
+     @return    The cluster's displayed position in map space.
+     */
+    MapPoint getSplitPosition(unsigned int level, unsigned int cluster, float split) const;
+
+    /**
+     @brief     Find every cluster in a level whose own position is inside a rectangle.
+     @param     level       The level to search.
+     @param     minimum     The bottom-left corner of the rectangle in map space.
+     @param     maximum     The top-right corner of the rectangle in map space.
+     @param     clusters    Receives the index of each cluster that was found. Existing contents are kept.
+     */
+    void findInRect(unsigned int level, const MapPoint& minimum, const MapPoint& maximum, std::vector<unsigned int>* clusters) const;
+
+    /**
+     @brief     Get the landmarks in cluster order, where the landmarks of each cluster take up the places from its first onwards.
+     */
+    const std::vector<unsigned int>& getOrder() const { return m_Order; }
+
+private:
+
+    /**
+     @brief     The clusters used at one range of scales.
+     */
+    struct Level
+    {
+        float scale;
+        std::vector<LandmarkCluster> clusters;
+        LandmarkGrid grid;
+    };
+
+    /**
+     @brief     Build the next coarser level by merging the clusters of the current coarsest level.
+     @param     scale       The new level's scale.
+     @param     radius      How close together (in view units) clusters have to appear to be merged.
+     */
+    void addLevel(float scale, float radius);
+
+    /**
+     @brief     Put the landmarks in cluster order, giving each cluster the range its landmarks take up.
+     @param     landmarkClusters    The cluster at the finest level containing each landmark.
+     */
+    void orderLandmarks(const std::vector<unsigned int>& landmarkClusters);
+
+    /** The levels, from finest to coarsest. */
+    std::vector<Level> m_Levels;
+
+    /** The landmarks in cluster order. */
+    std::vector<unsigned int> m_Order;
+
+    /** The size of the map in map units. */
+    MapPoint m_MapSize;
+};
+
+#endif // LANDMARK_CLUSTER_INDEX_H
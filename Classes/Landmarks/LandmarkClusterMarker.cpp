@@ -0,0 +1,70 @@
+//
+//  LandmarkClusterMarker.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-02.
+//
+//
+
+#include "LandmarkClusterMarker.h"
+#include "Defines.h"
+#include "AssetResolver.h"
+
+using namespace cocos2d;
+
+// Create a LandmarkClusterMarker instance.
+
+LandmarkClusterMarker* LandmarkClusterMarker::create()
+{
+    LandmarkClusterMarker *marker = new LandmarkClusterMarker();
+    if (marker && marker->init())
+    {
+        marker->autorelease();
+        return marker;
+    }
+    CC_SAFE_DELETE(marker);
+    return NULL;
+}
+
+// Initialize a LandmarkClusterMarker instance.
+
+bool LandmarkClusterMarker::init()
+{
+    // Use the same backing as a LandmarkButton so that clusters and landmarks read as the same kind of thing.
+    float assetScale;
+    CCTexture2D* texture = AssetResolver::addImage("landmarkButtonNormal.png", &assetScale);
+    if (!texture || !initWithTexture(texture))
+    {
+        return false;
+    }
+    
+    // Keep the marker the same size on screen as an unpressed LandmarkButton.
+    setScale(SCREEN_SCALE * 0.75f / assetScale);
+    
+    // Add the count label in the middle of the marker.
+    m_Count = 0;
+    m_CountLabel = CCLabelTTF::create("", "Montserrat", getContentSize().height * 0.4f);
+    if (!m_CountLabel)
+    {
+        return false;
+    }
+    addChild(m_CountLabel);
+    m_CountLabel->setPosition(ccp(getContentSize().width/2, getContentSize().height/2));
+    
+    return true;
+}
+
+// Set the number of landmarks displayed on the marker.
+
+void LandmarkClusterMarker::setCount(unsigned int count)
+{
+    if (count == m_Count)
+    {
+        return;
+    }
+    
+    char countString[16];
+    sprintf(countString, "%u", count);
+    m_CountLabel->setString(countString);
+    m_Count = count;
+}
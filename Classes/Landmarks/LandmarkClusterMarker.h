@@ -0,0 +1,51 @@
+//
+//  LandmarkClusterMarker.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-02.
+//
+//
+
+#ifndef LANDMARK_CLUSTER_MARKER_H
+#define LANDMARK_CLUSTER_MARKER_H
+
+#include "cocos2d.h"
+#include "HidingSprite.h"
+
+/**
+ @brief     A marker which stands in for a cluster of landmarks that are too close together to be displayed separately, showing how many landmarks it contains. Markers are pooled and reused for different clusters as the map moves.
+ */
+class LandmarkClusterMarker : public HidingSprite
+{
+public:
+    
+    /**
+     @brief     Create a LandmarkClusterMarker instance.
+     @return    A pointer to the newly created marker.
+     */
+    static LandmarkClusterMarker* create();
+    
+    /**
+     @brief     Set the number of landmarks displayed on the marker. The label is only redrawn when the number changes.
+     @param     count       The number of landmarks in the cluster.
+     */
+    void setCount(unsigned int count);
+    
+protected:
+    
+    /**
+     @brief     Initialize a LandmarkClusterMarker instance.
+     @return    Whether or not the marker was initialized successfully.
+     */
+    bool init();
+    
+private:
+    
+    /** The label showing the number of landmarks. */
+    cocos2d::CCLabelTTF* m_CountLabel;
+    
+    /** The number currently shown by the label. */
+    unsigned int m_Count;
+};
+
+#endif // LANDMARK_CLUSTER_MARKER_H
@@ -0,0 +1,165 @@
+//
+//  LandmarkFilterPopup.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkFilterPopup.h"
+#include "Defines.h"
+
+#define COLOUR_BUTTON_ON        ccc3(0, 150, 141)
+#define COLOUR_BUTTON_OFF       ccc3(110, 110, 110)
+#define COLOUR_BUTTON_CLOSE     ccc3(0, 92, 115)
+
+using namespace cocos2d;
+
+// The label of each category's button, in the order of the LandmarkCategory flags.
+static const char* CATEGORY_LABELS[LANDMARK_CATEGORY_COUNT] = { "Museums", "Parks", "Venues", "Buildings", "Monuments", "Neighbourhoods" };
+
+// The scale of the category buttons compared to the popup's usual buttons, so that every category fits above the other buttons.
+static const float CATEGORY_BUTTON_SCALE = 0.75f;
+
+// Create a filter popup and add it to the current scene.
+
+LandmarkFilterPopup* LandmarkFilterPopup::showPopup(unsigned int categories, LandmarkFilterObserver* observer)
+{
+    LandmarkFilterPopup* popup = create(categories, observer);
+
+    if (popup)
+    {
+        CCDirector::sharedDirector()->getRunningScene()->addChild(popup);
+        return popup;
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+// Create a filter popup.
+
+LandmarkFilterPopup* LandmarkFilterPopup::create(unsigned int categories, LandmarkFilterObserver* observer)
+{
+    LandmarkFilterPopup *popup = new LandmarkFilterPopup();
+    if (popup && popup->init(categories, observer))
+    {
+        popup->autorelease();
+        return popup;
+    }
+    CC_SAFE_DELETE(popup);
+    return NULL;
+}
+
+// Initialize this LandmarkFilterPopup with a button for each category.
+
+bool LandmarkFilterPopup::init(unsigned int categories, LandmarkFilterObserver* observer)
+{
+    if (!Popup::init())
+    {
+        return false;
+    }
+
+    m_Observer = observer;
+    m_Categories = categories;
+
+    // Stack a button for each category down from the top of the screen.
+    float rowY = WIN_SIZE.height - 100 * SCREEN_SCALE;
+    for (unsigned int i = 0; i < LANDMARK_CATEGORY_COUNT; i++)
+    {
+        Button* button = Button::create("buttonNormal.png", "buttonPressed.png", NULL,
+                                        CCCallFuncO::create(this, callfuncO_selector(LandmarkFilterPopup::categoryPressed), CCInteger::create(i)));
+        button->setScale(SCREEN_SCALE * CATEGORY_BUTTON_SCALE / button->getAssetScale());
+
+        CCLabelTTF* label = CCLabelTTF::create(CATEGORY_LABELS[i], "Montserrat", 80);
+        label->setScale(button->getAssetScale());
+        label->setPosition(ccp(button->getContentSize().width/2, button->getContentSize().height/2));
+        button->addChild(label);
+
+        float rowHeight = button->getContentSize().height * button->getScaleY();
+        rowY -= rowHeight * 0.6f;
+        button->setPosition(ccp(WIN_SIZE.width/2, rowY));
+        rowY -= rowHeight * 0.6f;
+
+        addChild(button);
+        m_Buttons.push_back(button);
+        m_CategoryButtons[i] = button;
+    }
+    updateButtons();
+
+    // Add buttons to display every landmark again and to close the popup at the bottom of the screen.
+    Button* closeButton = Button::create("buttonNormal.png", "buttonPressed.png", NULL, CCCallFunc::create(this, callfunc_selector(LandmarkFilterPopup::closePopup)));
+    Button* showAllButton = Button::create("buttonNormal.png", "buttonPressed.png", NULL, CCCallFunc::create(this, callfunc_selector(LandmarkFilterPopup::showAllPressed)));
+    Button* bottomButtons[2] = { closeButton, showAllButton };
+    const char* bottomLabels[2] = { "Close", "Show All" };
+    float bottomY = 0;
+
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        Button* button = bottomButtons[i];
+        button->setColor(COLOUR_BUTTON_CLOSE);
+        button->setScale(SCREEN_SCALE / button->getAssetScale());
+
+        CCLabelTTF* label = CCLabelTTF::create(bottomLabels[i], "Montserrat", 100);
+        label->setScale(button->getAssetScale());
+        label->setPosition(ccp(button->getContentSize().width/2, button->getContentSize().height/2));
+        button->addChild(label);
+
+        float buttonHeight = button->getContentSize().height * button->getScaleY();
+        bottomY += buttonHeight * ((i == 0) ? 1 : 1.2f);
+        button->setPosition(ccp(WIN_SIZE.width/2, bottomY));
+
+        addChild(button);
+        m_Buttons.push_back(button);
+    }
+
+    // Fade in the same way as the other popups.
+    const float duration = 0.35f;
+    const float rate = 2.75f;
+
+    GLubyte backdropOpacity = m_Backdrop->getOpacity();
+    fadeInAllDecendants(duration, rate, this);
+    m_Backdrop->stopAllActions();
+    m_Backdrop->setOpacity(0);
+    m_Backdrop->runAction(CCEaseOut::create(CCFadeTo::create(duration, backdropOpacity), rate));
+
+    return true;
+}
+
+// Turn a category on or off when its button is pressed.
+
+void LandmarkFilterPopup::categoryPressed(CCObject* category)
+{
+    unsigned int bit = ((CCInteger*)category)->getValue();
+    m_Categories ^= (1 << bit);
+    updateButtons();
+
+    if (m_Observer)
+    {
+        m_Observer->landmarkFilterChanged(m_Categories);
+    }
+}
+
+// Turn every category off, displaying every landmark again.
+
+void LandmarkFilterPopup::showAllPressed()
+{
+    m_Categories = 0;
+    updateButtons();
+
+    if (m_Observer)
+    {
+        m_Observer->landmarkFilterChanged(m_Categories);
+    }
+}
+
+// Colour each category's button by whether or not it is on.
+
+void LandmarkFilterPopup::updateButtons()
+{
+    for (unsigned int i = 0; i < LANDMARK_CATEGORY_COUNT; i++)
+    {
+        m_CategoryButtons[i]->setColor((m_Categories & (1 << i)) ? COLOUR_BUTTON_ON : COLOUR_BUTTON_OFF);
+    }
+}
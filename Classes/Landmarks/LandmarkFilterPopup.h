@@ -0,0 +1,90 @@
+//
+//  LandmarkFilterPopup.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_FILTER_POPUP_H
+#define LANDMARK_FILTER_POPUP_H
+
+#include "Popup.h"
+#include "Landmark.h"
+
+/**
+ @brief     An interface for responding to the user changing which categories of landmark are displayed.
+ */
+class LandmarkFilterObserver
+{
+public:
+
+    /**
+     @brief     Called whenever the user turns a category on or off.
+     @param     categories  The categories to display, as a combination of LandmarkCategory flags, or 0 to display every landmark.
+     */
+    virtual void landmarkFilterChanged(unsigned int categories) = 0;
+};
+
+/**
+ @brief     A popup with a button for each category of landmark, which the user turns on to display only the landmarks in the categories that are on. The observer is told as soon as a category is turned on or off, so the map behind the popup changes straight away.
+ */
+class LandmarkFilterPopup : public Popup
+{
+public:
+
+    /**
+     @brief     Create a filter popup and add it to the current scene.
+     @param     categories  The categories which are displayed at the moment, as a combination of LandmarkCategory flags.
+     @param     observer    The observer to tell when the categories change.
+     @return    A pointer to the popup that is created.
+     */
+    static LandmarkFilterPopup* showPopup(unsigned int categories, LandmarkFilterObserver* observer);
+
+protected:
+
+    /**
+     @brief     Create a filter popup.
+     @param     categories  The categories which are displayed at the moment.
+     @param     observer    The observer to tell when the categories change.
+     @return    A pointer to the popup that is created.
+     */
+    static LandmarkFilterPopup* create(unsigned int categories, LandmarkFilterObserver* observer);
+
+    /**
+     @brief     Initialize this LandmarkFilterPopup with a button for each category.
+     @param     categories  The categories which are displayed at the moment.
+     @param     observer    The observer to tell when the categories change.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(unsigned int categories, LandmarkFilterObserver* observer);
+
+    /**
+     @brief     Turn a category on or off when its button is pressed.
+     @param     category    The category's bit, as a CCInteger.
+     */
+    void categoryPressed(cocos2d::CCObject* category);
+
+    /**
+     @brief     Turn every category off, displaying every landmark again.
+     */
+    void showAllPressed();
+
+    /**
+     @brief     Colour each category's button by whether or not it is on.
+     */
+    void updateButtons();
+
+private:
+
+    /** The observer to tell when the categories change. */
+    LandmarkFilterObserver* m_Observer;
+
+    /** The categories which are on, as a combination of LandmarkCategory flags. */
+    unsigned int m_Categories;
+
+    /** The button for each category, indexed by the category's bit. */
+    Button* m_CategoryButtons[LANDMARK_CATEGORY_COUNT];
+};
+
+#endif // LANDMARK_FILTER_POPUP_H
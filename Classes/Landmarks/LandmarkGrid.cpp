@@ -0,0 +1,146 @@
+//
+//  LandmarkGrid.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-25.
+//
+//
+
+#include "LandmarkGrid.h"
+
+using namespace std;
+
+// Default constructor.
+
+LandmarkGrid::LandmarkGrid()
+: m_Columns(0)
+, m_Rows(0)
+, m_CellWidth(0)
+, m_CellHeight(0)
+, m_Count(0)
+{
+}
+
+// Remove every landmark and set the area covered by the grid.
+
+void LandmarkGrid::reset(float width, float height, unsigned int columns, unsigned int rows)
+{
+    m_Columns = (columns > 0) ? columns : 1;
+    m_Rows = (rows > 0) ? rows : 1;
+    m_CellWidth = (width > 0) ? width / m_Columns : 1;
+    m_CellHeight = (height > 0) ? height / m_Rows : 1;
+    m_Count = 0;
+
+    m_Cells.clear();
+    m_Cells.resize(m_Columns * m_Rows);
+}
+
+// Add a landmark to the grid.
+
+void LandmarkGrid::insert(unsigned int index, const MapPoint& position)
+{
+    if (m_Cells.empty())
+    {
+        return;
+    }
+
+    Entry entry;
+    entry.position = position;
+    entry.index = index;
+    m_Cells[getRow(position.y) * m_Columns + getColumn(position.x)].push_back(entry);
+    m_Count++;
+}
+
+// Find the landmark closest to a point, out of those whose bounds contain it.
+
+bool LandmarkGrid::findNearest(const MapPoint& point, float halfWidth, float halfHeight, unsigned int* index) const
+{
+    if (m_Cells.empty())
+    {
+        return false;
+    }
+
+    // A landmark's bounds can only contain the point if the landmark lies within half a landmark of it, so only those cells are visited.
+    unsigned int firstColumn = getColumn(point.x - halfWidth);
+    unsigned int lastColumn = getColumn(point.x + halfWidth);
+    unsigned int firstRow = getRow(point.y - halfHeight);
+    unsigned int lastRow = getRow(point.y + halfHeight);
+
+    bool found = false;
+    float nearestDistance = 0;
+
+    for (unsigned int row = firstRow; row <= lastRow; row++)
+    {
+        for (unsigned int column = firstColumn; column <= lastColumn; column++)
+        {
+            const vector<Entry>& cell = m_Cells[row * m_Columns + column];
+            for (unsigned int i = 0; i < cell.size(); i++)
+            {
+                const Entry& entry = cell[i];
+                if (fabsf(entry.position.x - point.x) > halfWidth || fabsf(entry.position.y - point.y) > halfHeight)
+                {
+                    continue;
+                }
+
+                float distance = entry.position.distanceSquared(point);
+                if (!found || distance < nearestDistance)
+                {
+                    found = true;
+                    nearestDistance = distance;
+                    *index = entry.index;
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+// Find every landmark inside a rectangle.
+
+void LandmarkGrid::findInRect(const MapPoint& minimum, const MapPoint& maximum, vector<unsigned int>* indices) const
+{
+    if (m_Cells.empty() || minimum.x > maximum.x || minimum.y > maximum.y)
+    {
+        return;
+    }
+
+    unsigned int firstColumn = getColumn(minimum.x);
+    unsigned int lastColumn = getColumn(maximum.x);
+    unsigned int firstRow = getRow(minimum.y);
+    unsigned int lastRow = getRow(maximum.y);
+
+    for (unsigned int row = firstRow; row <= lastRow; row++)
+    {
+        for (unsigned int column = firstColumn; column <= lastColumn; column++)
+        {
+            const vector<Entry>& cell = m_Cells[row * m_Columns + column];
+            for (unsigned int i = 0; i < cell.size(); i++)
+            {
+                const MapPoint& position = cell[i].position;
+                if (position.x >= minimum.x && position.x <= maximum.x && position.y >= minimum.y && position.y <= maximum.y)
+                {
+                    indices->push_back(cell[i].index);
+                }
+            }
+        }
+    }
+}
+
+// Get the column containing an x coordinate, clamped to the grid.
+
+unsigned int LandmarkGrid::getColumn(float x) const
+{
+    float column = x / m_CellWidth;
+    if (!(column > 0)) return 0;
+    return (column >= m_Columns) ? m_Columns - 1 : (unsigned int)column;
+}
+
+// Get the row containing a y coordinate, clamped to the grid.
+
+unsigned int LandmarkGrid::getRow(float y) const
+{
+    float row = y / m_CellHeight;
+    if (!(row > 0)) return 0;
+    return (row >= m_Rows) ? m_Rows - 1 : (unsigned int)row;
+}
@@ -0,0 +1,104 @@
+//
+//  LandmarkGrid.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-25.
+//
+//
+
+#ifndef LANDMARK_GRID_H
+#define LANDMARK_GRID_H
+
+#include <vector>
+#include "MapPoint.h"
+
+/**
+ @brief     A uniform grid of landmark positions in map space, used to find the landmark under a touch without testing every landmark.
+
+ Each landmark is stored in the cell containing its position, so a lookup only visits the cells overlapped by the area that a landmark's button could cover around the touch. The cost of a lookup therefore depends on how crowded that area is rather than on how many landmarks there are in total.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class LandmarkGrid
+{
+public:
+
+    /**
+     @brief     Default constructor. The grid is empty and covers no area until it is reset.
+     */
+    LandmarkGrid();
+
+    /**
+     @brief     Remove every landmark and set the area covered by the grid.
+     @param     width       The width of the map in map units.
+     @param     height      The height of the map in map units.
+     @param     columns     The number of cells across.
+     @param     rows        The number of cells down.
+     */
+    void reset(float width, float height, unsigned int columns, unsigned int rows);
+
+    /**
+     @brief     Add a landmark to the grid. Positions outside of the map are stored in the nearest edge cell.
+     @param     index       The value returned by lookups which hit the landmark (ie. its index in a list of buttons).
+     @param     position    The landmark's position in map space.
+     */
+    void insert(unsigned int index, const MapPoint& position);
+
+    /**
+     @brief     Find the landmark closest to a point, out of those whose bounds contain it.
+     @param     point       The point to look up in map space (ie. a touch location).
+     @param     halfWidth   Half of the width of a landmark's bounds in map units.
+     @param     halfHeight  Half of the height of a landmark's bounds in map units.
+     @param     index       Receives the index of the landmark that was found.
+     @return    Whether or not a landmark was found.
+     */
+    bool findNearest(const MapPoint& point, float halfWidth, float halfHeight, unsigned int* index) const;
+
+    /**
+     @brief     Find every landmark inside a rectangle.
+     @param     minimum     The bottom-left corner of the rectangle in map space.
+     @param     maximum     The top-right corner of the rectangle in map space.
+     @param     indices     Receives the index of each landmark that was found, in no particular order. Existing contents are kept.
+     */
+    void findInRect(const MapPoint& minimum, const MapPoint& maximum, std::vector<unsigned int>* indices) const;
+
+    /**
+     @brief     Get the number of landmarks in the grid.
+     */
+    unsigned int getCount() const { return m_Count; }
+
+private:
+
+    /**
+     @brief     A landmark as stored in a cell.
+     */
+    struct Entry
+    {
+        MapPoint position;
+        unsigned int index;
+    };
+
+    /**
+     @brief     Get the column containing an x coordinate, clamped to the grid.
+     */
+    unsigned int getColumn(float x) const;
+
+    /**
+     @brief     Get the row containing a y coordinate, clamped to the grid.
+     */
+    unsigned int getRow(float y) const;
+
+    /** The landmarks in each cell, stored row by row. */
+    std::vector<std::vector<Entry> > m_Cells;
+
+    /** The grid's dimensions. */
+    unsigned int m_Columns;
+    unsigned int m_Rows;
+    float m_CellWidth;
+    float m_CellHeight;
+
+    /** The number of landmarks in the grid. */
+    unsigned int m_Count;
+};
+
+#endif // LANDMARK_GRID_H
@@ -0,0 +1,216 @@
+//
+//  LandmarkKDTree.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkKDTree.h"
+#include <algorithm>
+#include <float.h>
+
+using namespace std;
+
+// Orders nodes by one coordinate of their position, for finding a range's median.
+struct NodeAxisLess
+{
+    unsigned int axis;
+
+    NodeAxisLess(unsigned int axis) : axis(axis) { }
+
+    template <typename Node>
+    bool operator()(const Node& a, const Node& b) const
+    {
+        return axis ? a.position.y < b.position.y : a.position.x < b.position.x;
+    }
+};
+
+// Default constructor.
+
+LandmarkKDTree::LandmarkKDTree()
+{
+}
+
+// Build the tree over a set of landmarks.
+
+void LandmarkKDTree::build(const vector<MapPoint>& positions)
+{
+    m_Nodes.resize(positions.size());
+    for (unsigned int i = 0; i < positions.size(); i++)
+    {
+        m_Nodes[i].position = positions[i];
+        m_Nodes[i].landmark = i;
+        m_Nodes[i].axis = 0;
+    }
+
+    buildRange(0, m_Nodes.size());
+}
+
+// Sort a range of nodes into a subtree.
+
+void LandmarkKDTree::buildRange(unsigned int begin, unsigned int end)
+{
+    if (end - begin <= LEAF_SIZE)
+    {
+        return;
+    }
+
+    // Split along the axis the range is widest in, which keeps the halves compact even where landmarks crowd along a street.
+    MapPoint minimum = m_Nodes[begin].position;
+    MapPoint maximum = minimum;
+    for (unsigned int i = begin + 1; i < end; i++)
+    {
+        const MapPoint& position = m_Nodes[i].position;
+        minimum.x = min(minimum.x, position.x);
+        minimum.y = min(minimum.y, position.y);
+        maximum.x = max(maximum.x, position.x);
+        maximum.y = max(maximum.y, position.y);
+    }
+
+    unsigned int axis = (maximum.y - minimum.y > maximum.x - minimum.x) ? 1 : 0;
+    unsigned int middle = begin + (end - begin) / 2;
+    nth_element(m_Nodes.begin() + begin, m_Nodes.begin() + middle, m_Nodes.begin() + end, NodeAxisLess(axis));
+    m_Nodes[middle].axis = axis;
+
+    buildRange(begin, middle);
+    buildRange(middle + 1, end);
+}
+
+// Find the landmarks nearest to a point.
+
+void LandmarkKDTree::findNearest(const MapPoint& point, unsigned int count, float radius, vector<unsigned int>* landmarks) const
+{
+    landmarks->clear();
+    if (count == 0 || m_Nodes.empty())
+    {
+        return;
+    }
+
+    // Until count landmarks have been found, anything within the radius is a candidate.
+    float limitSquared = (radius < 0) ? FLT_MAX : radius * radius;
+    m_Candidates.clear();
+    findNearestInRange(0, m_Nodes.size(), point, count, &limitSquared, &m_Candidates);
+
+    sort_heap(m_Candidates.begin(), m_Candidates.end());
+    landmarks->resize(m_Candidates.size());
+    for (unsigned int i = 0; i < m_Candidates.size(); i++)
+    {
+        (*landmarks)[i] = m_Candidates[i].landmark;
+    }
+}
+
+// Search a subtree for landmarks nearer than the furthest candidate.
+
+void LandmarkKDTree::findNearestInRange(unsigned int begin, unsigned int end, const MapPoint& point, unsigned int count, float* limitSquared, vector<Candidate>* candidates) const
+{
+    if (end - begin <= LEAF_SIZE)
+    {
+        for (unsigned int i = begin; i < end; i++)
+        {
+            float distanceSquared = m_Nodes[i].position.distanceSquared(point);
+            if (distanceSquared > *limitSquared)
+            {
+                continue;
+            }
+
+            // Once the heap is full, each new candidate replaces the furthest, and the limit shrinks to the new furthest.
+            Candidate candidate;
+            candidate.distanceSquared = distanceSquared;
+            candidate.landmark = m_Nodes[i].landmark;
+            if (candidates->size() == count)
+            {
+                pop_heap(candidates->begin(), candidates->end());
+                candidates->back() = candidate;
+            }
+            else
+            {
+                candidates->push_back(candidate);
+            }
+            push_heap(candidates->begin(), candidates->end());
+
+            if (candidates->size() == count)
+            {
+                *limitSquared = candidates->front().distanceSquared;
+            }
+        }
+        return;
+    }
+
+    unsigned int middle = begin + (end - begin) / 2;
+    const Node& node = m_Nodes[middle];
+    float offset = node.axis ? point.y - node.position.y : point.x - node.position.x;
+
+    // Search the half containing the point first, so that the limit has shrunk by the time the other half is considered.
+    if (offset < 0)
+    {
+        findNearestInRange(begin, middle, point, count, limitSquared, candidates);
+    }
+    else
+    {
+        findNearestInRange(middle + 1, end, point, count, limitSquared, candidates);
+    }
+
+    if (offset * offset > *limitSquared)
+    {
+        return;
+    }
+
+    findNearestInRange(middle, middle + 1, point, count, limitSquared, candidates);
+
+    if (offset < 0)
+    {
+        findNearestInRange(middle + 1, end, point, count, limitSquared, candidates);
+    }
+    else
+    {
+        findNearestInRange(begin, middle, point, count, limitSquared, candidates);
+    }
+}
+
+// Find every landmark within a distance of a point.
+
+void LandmarkKDTree::findInRadius(const MapPoint& point, float radius, vector<unsigned int>* landmarks) const
+{
+    if (radius < 0 || m_Nodes.empty())
+    {
+        return;
+    }
+
+    findInRadiusInRange(0, m_Nodes.size(), point, radius * radius, landmarks);
+}
+
+// Search a subtree for landmarks within a distance.
+
+void LandmarkKDTree::findInRadiusInRange(unsigned int begin, unsigned int end, const MapPoint& point, float radiusSquared, vector<unsigned int>* landmarks) const
+{
+    if (end - begin <= LEAF_SIZE)
+    {
+        for (unsigned int i = begin; i < end; i++)
+        {
+            if (m_Nodes[i].position.distanceSquared(point) <= radiusSquared)
+            {
+                landmarks->push_back(m_Nodes[i].landmark);
+            }
+        }
+        return;
+    }
+
+    unsigned int middle = begin + (end - begin) / 2;
+    const Node& node = m_Nodes[middle];
+    float offset = node.axis ? point.y - node.position.y : point.x - node.position.x;
+
+    // Each half only needs searching if the circle reaches across the split into it.
+    if (offset < 0 || offset * offset <= radiusSquared)
+    {
+        findInRadiusInRange(begin, middle, point, radiusSquared, landmarks);
+    }
+    if (node.position.distanceSquared(point) <= radiusSquared)
+    {
+        landmarks->push_back(node.landmark);
+    }
+    if (offset >= 0 || offset * offset <= radiusSquared)
+    {
+        findInRadiusInRange(middle + 1, end, point, radiusSquared, landmarks);
+    }
+}
@@ -0,0 +1,107 @@
+//
+//  LandmarkKDTree.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_KD_TREE_H
+#define LANDMARK_KD_TREE_H
+
+#include <vector>
+#include "MapPoint.h"
+
+/**
+ @brief     A k-d tree over landmark positions in map space, used to find the landmarks nearest to a point (ie. the user's location) quickly enough to refresh a "nearby" list on every location update.
+
+ The tree is balanced and stored implicitly in one array: each range of landmarks is split at its median along the axis it is widest in, the median's position in the range standing in for the node. Ranges of a few landmarks are left as leaves and searched directly, which is faster than splitting them further. A query descends into the half nearest the point first and skips any half which is further away than the landmarks already found, so it only visits a handful of leaves no matter how many landmarks there are.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class LandmarkKDTree
+{
+public:
+
+    /** The most landmarks in a range which is searched directly rather than split. */
+    static const unsigned int LEAF_SIZE = 8;
+
+    /**
+     @brief     Default constructor. The tree is empty until it is built.
+     */
+    LandmarkKDTree();
+
+    /**
+     @brief     Build the tree over a set of landmarks, replacing what it held before.
+     @param     positions   The position of each landmark in map space. The landmarks are numbered by their order in this vector (ie. by LandmarkID).
+     */
+    void build(const std::vector<MapPoint>& positions);
+
+    /**
+     @brief     Find the landmarks nearest to a point.
+     @param     point       The point to search around in map space.
+     @param     count       The most landmarks to find.
+     @param     radius      How far from the point to search in map units, or a negative number to search the whole map.
+     @param     landmarks   Receives the numbers of the landmarks that were found, nearest first. Existing contents are replaced.
+     */
+    void findNearest(const MapPoint& point, unsigned int count, float radius, std::vector<unsigned int>* landmarks) const;
+
+    /**
+     @brief     Find every landmark within a distance of a point.
+     @param     point       The point to search around in map space.
+     @param     radius      How far from the point to search in map units.
+     @param     landmarks   Receives the numbers of the landmarks that were found, in no particular order. Existing contents are kept.
+     */
+    void findInRadius(const MapPoint& point, float radius, std::vector<unsigned int>* landmarks) const;
+
+    /**
+     @brief     Get the number of landmarks in the tree.
+     */
+    unsigned int getCount() const { return m_Nodes.size(); }
+
+private:
+
+    /**
+     @brief     A landmark as stored in the tree, along with the axis its range is split along if it is the median of one (0 for x, 1 for y).
+     */
+    struct Node
+    {
+        MapPoint position;
+        unsigned int landmark;
+        unsigned int axis;
+    };
+
+    /**
+     @brief     A landmark found by a nearest search, ordered by distance for keeping the furthest at the top of a heap.
+     */
+    struct Candidate
+    {
+        float distanceSquared;
+        unsigned int landmark;
+
+        bool operator<(const Candidate& other) const { return distanceSquared < other.distanceSquared; }
+    };
+
+    /**
+     @brief     Sort a range of nodes into a subtree.
+     */
+    void buildRange(unsigned int begin, unsigned int end);
+
+    /**
+     @brief     Search a subtree for landmarks nearer than the furthest candidate, keeping the nearest in a heap of at most count.
+     */
+    void findNearestInRange(unsigned int begin, unsigned int end, const MapPoint& point, unsigned int count, float* limitSquared, std::vector<Candidate>* candidates) const;
+
+    /**
+     @brief     Search a subtree for landmarks within a distance.
+     */
+    void findInRadiusInRange(unsigned int begin, unsigned int end, const MapPoint& point, float radiusSquared, std::vector<unsigned int>* landmarks) const;
+
+    /** The landmarks, arranged so that each range's median splits it into its two halves. */
+    std::vector<Node> m_Nodes;
+
+    /** The heap used by nearest searches, kept between them so that they don't allocate. */
+    mutable std::vector<Candidate> m_Candidates;
+};
+
+#endif // LANDMARK_KD_TREE_H
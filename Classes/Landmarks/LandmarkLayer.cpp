@@ -0,0 +1,498 @@
+//
+//  LandmarkLayer.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-26.
+//
+//
+
+#include "LandmarkLayer.h"
+#include "Defines.h"
+#include "TouchRouter.h"
+
+using namespace cocos2d;
+
+// How much of the map beyond each edge of the view has markers placed, as a fraction of the view's size. Panning within it doesn't need the markers to be placed again.
+#define REFRESH_MARGIN          0.5f
+
+// How far a touch on a cluster marker may move before it no longer counts as a tap.
+#define CLUSTER_TAP_DISTANCE    (30 * SCREEN_SCALE)
+
+// Create a LandmarkLayer instance for a map.
+
+LandmarkLayer* LandmarkLayer::create(const CCSize& mapSize, const CCSize& viewSize, float minScale, float maxScale)
+{
+    LandmarkLayer *layer = new LandmarkLayer();
+    if (layer && layer->init(mapSize, viewSize, minScale, maxScale))
+    {
+        layer->autorelease();
+        return layer;
+    }
+    CC_SAFE_DELETE(layer);
+    return NULL;
+}
+
+// Initialize a LandmarkLayer instance for a map.
+
+bool LandmarkLayer::init(const CCSize& mapSize, const CCSize& viewSize, float minScale, float maxScale)
+{
+    if (!CCNode::init())
+    {
+        return false;
+    }
+
+    m_MapSize = MapPoint(mapSize.width, mapSize.height);
+    m_ViewSize = MapPoint(viewSize.width, viewSize.height);
+    m_MinScale = minScale;
+    m_MaxScale = maxScale;
+    m_ClustersOutOfDate = false;
+    m_CategoryFilter = 0;
+    m_MatchAllCategories = false;
+    m_MapTransform.scale = 1;
+    m_NeedsRefresh = true;
+    m_Level = 0;
+    m_Split = 1;
+    m_MarkersInUse = 0;
+    m_PressedButton = NULL;
+    m_ClusterTouch = NULL;
+    m_PressedClusterScale = 1;
+    m_Observer = NULL;
+
+    // Become the landmark layer of the touch router. Touches on landmarks are also passed on to the map so that the map can be dragged from anywhere.
+    TouchRouter::sharedRouter()->setHandler(kTouchLayerLandmarks, this, false);
+
+    return true;
+}
+
+// Called when this is removed from the node tree.
+
+void LandmarkLayer::onExit()
+{
+    // Unregister this layer from the touch router.
+    TouchRouter::sharedRouter()->removeHandler(this);
+
+    // Pass the onExit() call along to the base class.
+    CCNode::onExit();
+}
+
+// Regroup the landmarks the next time they are displayed.
+
+void LandmarkLayer::landmarksChanged()
+{
+    // A button is only bound to a landmark once a refresh finds it on its own near the view.
+    m_ClustersOutOfDate = true;
+    m_NeedsRefresh = true;
+}
+
+// Only display the landmarks in some categories.
+
+void LandmarkLayer::setCategoryFilter(unsigned int categories, bool matchAll)
+{
+    m_CategoryFilter = categories;
+    m_MatchAllCategories = matchAll;
+    updateFilter();
+    m_NeedsRefresh = true;
+}
+
+// Work out which landmarks pass the category filter.
+
+void LandmarkLayer::updateFilter()
+{
+    // Only the sets are combined here. The clusters are counted against the result when the markers are next placed.
+    if (m_CategoryFilter != 0)
+    {
+        m_CategoryIndex.find(m_CategoryFilter, m_MatchAllCategories, &m_Filter);
+    }
+    else
+    {
+        m_Filter.clear();
+    }
+}
+
+// Move the landmarks to follow the map.
+
+void LandmarkLayer::setMapTransform(const MapTransform& transform)
+{
+    // A change of offset alone only moves the layer. The markers only need to be placed again if the scale changed, or if the view has moved beyond the area they were placed in.
+    setPosition(ccp(transform.offset.x, transform.offset.y));
+
+    bool scaleChanged = (transform.scale != m_MapTransform.scale);
+    m_MapTransform = transform;
+
+    if (!m_NeedsRefresh)
+    {
+        MapPoint minimum, maximum;
+        getVisibleArea(&minimum, &maximum);
+        m_NeedsRefresh = (scaleChanged ||
+                          minimum.x < m_RefreshedMinimum.x || minimum.y < m_RefreshedMinimum.y ||
+                          maximum.x > m_RefreshedMaximum.x || maximum.y > m_RefreshedMaximum.y);
+    }
+}
+
+// Bring the displayed markers up to date with the map's transform, then draw them.
+
+void LandmarkLayer::visit()
+{
+    // Refreshing here rather than whenever the transform changes means the markers are placed at most once per frame.
+    if (m_NeedsRefresh)
+    {
+        refresh();
+    }
+
+    CCNode::visit();
+}
+
+// Choose the markers to display around the view and place them.
+
+void LandmarkLayer::refresh()
+{
+    m_NeedsRefresh = false;
+
+    // Regroup the landmarks if they have changed. Landmarks are clustered when their buttons would overlap. If the store has been emptied, this leaves the clusters and the category index empty too, so that no stale markers are displayed.
+    const LandmarkStore* store = LandmarkStore::sharedStore();
+    if (m_ClustersOutOfDate)
+    {
+        m_Clusters.build(store->getPositions(), m_MapSize, LandmarkButton::getDisplayedWidth(), m_MinScale, m_MaxScale);
+        m_ClustersOutOfDate = false;
+
+        // Index the categories in cluster order, so that the landmarks of each cluster are a range of the filter.
+        const std::vector<unsigned int>& order = m_Clusters.getOrder();
+        std::vector<unsigned int> categories(order.size());
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            categories[i] = store->getCategories(order[i]);
+        }
+        m_CategoryIndex.build(categories);
+        updateFilter();
+    }
+
+    // Hide whatever was displayed before.
+    for (unsigned int i = 0; i < m_Displayed.size(); i++)
+    {
+        m_Displayed[i].node->setVisible(false);
+    }
+    m_Displayed.clear();
+    m_MarkersInUse = 0;
+
+    if (m_Clusters.getLevelCount() == 0)
+    {
+        return;
+    }
+
+    // Find the clusters in and around the view at the current scale.
+    MapPoint minimum, maximum;
+    getVisibleArea(&minimum, &maximum);
+    MapPoint margin = (maximum - minimum) * REFRESH_MARGIN;
+    m_RefreshedMinimum = minimum - margin;
+    m_RefreshedMaximum = maximum + margin;
+
+    m_Clusters.findLevel(m_MapTransform.scale, &m_Level, &m_Split);
+    m_Found.clear();
+    m_Clusters.findInRect(m_Level, m_RefreshedMinimum, m_RefreshedMaximum, &m_Found);
+
+    // Count the landmarks of each cluster which pass the filter, and drop the clusters with none. Since a cluster's landmarks are a range of the filter, this doesn't depend on how many landmarks the cluster has.
+    const std::vector<LandmarkCluster>& clusters = m_Clusters.getClusters(m_Level);
+    const std::vector<unsigned int>& order = m_Clusters.getOrder();
+    unsigned int count = 0;
+    m_FoundCounts.resize(m_Found.size());
+    m_FoundLandmarks.resize(m_Found.size());
+
+    for (unsigned int i = 0; i < m_Found.size(); i++)
+    {
+        const LandmarkCluster& cluster = clusters[m_Found[i]];
+        unsigned int matching = cluster.count;
+        LandmarkID landmark = cluster.landmark;
+
+        if (m_CategoryFilter != 0)
+        {
+            matching = m_Filter.countRange(cluster.first, cluster.first + cluster.count);
+            if (matching == 1)
+            {
+                landmark = order[m_Filter.findNext(cluster.first)];
+            }
+        }
+
+        if (matching > 0)
+        {
+            m_Found[count] = m_Found[i];
+            m_FoundCounts[count] = matching;
+            m_FoundLandmarks[count] = landmark;
+            count++;
+        }
+    }
+    m_Found.resize(count);
+
+    // Work out where each cluster sits as it splits from its parent, then scale all of the positions into the layer's space in one pass. A cluster with only one matching landmark is displayed where that landmark is.
+    m_LayerX.resize(count);
+    m_LayerY.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        bool isFiltered = (m_FoundCounts[i] == 1 && clusters[m_Found[i]].count != 1);
+        MapPoint position = isFiltered ? store->getPosition(m_FoundLandmarks[i]) : m_Clusters.getSplitPosition(m_Level, m_Found[i], m_Split);
+        m_LayerX[i] = position.x;
+        m_LayerY[i] = position.y;
+    }
+
+    float scale = m_MapTransform.scale;
+    float* layerX = count ? &m_LayerX[0] : NULL;
+    float* layerY = count ? &m_LayerY[0] : NULL;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        layerX[i] *= scale;
+        layerY[i] *= scale;
+    }
+
+    // Landmarks which were displayed before and still are keep their buttons, so that they aren't rebound...
+    m_PreviouslyBound.swap(m_BoundButtons);
+    m_BoundButtons.clear();
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (m_FoundCounts[i] != 1)
+        {
+            continue;
+        }
+
+        std::map<LandmarkID, LandmarkButton*>::iterator bound = m_PreviouslyBound.find(m_FoundLandmarks[i]);
+        if (bound != m_PreviouslyBound.end())
+        {
+            m_BoundButtons.insert(*bound);
+            m_PreviouslyBound.erase(bound);
+        }
+    }
+
+    // ...while the rest are free to be bound to other landmarks. A pressed button is kept until its touch ends, even if it has just joined a cluster.
+    for (std::map<LandmarkID, LandmarkButton*>::iterator it = m_PreviouslyBound.begin(); it != m_PreviouslyBound.end(); it++)
+    {
+        if (it->second == m_PressedButton)
+        {
+            m_BoundButtons.insert(*it);
+        }
+        else
+        {
+            m_FreeButtons.push_back(it->second);
+        }
+    }
+    m_PreviouslyBound.clear();
+
+    // Display a landmark on its own as its button, and a cluster as a marker with its count.
+    for (unsigned int i = 0; i < count; i++)
+    {
+        DisplayedCluster displayed;
+        displayed.cluster = m_Found[i];
+
+        if (m_FoundCounts[i] == 1)
+        {
+            std::map<LandmarkID, LandmarkButton*>::iterator bound = m_BoundButtons.find(m_FoundLandmarks[i]);
+            displayed.button = (bound != m_BoundButtons.end()) ? bound->second : takeButton(m_FoundLandmarks[i]);
+            if (!displayed.button)
+            {
+                continue;
+            }
+            displayed.node = displayed.button;
+        }
+        else
+        {
+            LandmarkClusterMarker* marker = takeMarker();
+            if (!marker)
+            {
+                continue;
+            }
+            marker->setCount(m_FoundCounts[i]);
+            displayed.button = NULL;
+            displayed.node = marker;
+        }
+
+        displayed.node->setPosition(ccp(layerX[i], layerY[i]));
+        displayed.node->setVisible(true);
+        m_Displayed.push_back(displayed);
+    }
+
+    // The pressed button was hidden along with everything else, so show it again.
+    if (m_PressedButton)
+    {
+        m_PressedButton->setVisible(true);
+    }
+}
+
+// Get the area of the map inside the view at the current transform.
+
+void LandmarkLayer::getVisibleArea(MapPoint* minimum, MapPoint* maximum) const
+{
+    float inverseScale = (m_MapTransform.scale != 0) ? 1 / m_MapTransform.scale : 0;
+    *minimum = (MapPoint() - m_MapTransform.offset) * inverseScale;
+    *maximum = (m_ViewSize - m_MapTransform.offset) * inverseScale;
+}
+
+// Bind an unused LandmarkButton from the pool to a landmark, creating one if needed.
+
+LandmarkButton* LandmarkLayer::takeButton(LandmarkID landmark)
+{
+    LandmarkButton* button = NULL;
+
+    if (!m_FreeButtons.empty())
+    {
+        button = m_FreeButtons.back();
+        m_FreeButtons.pop_back();
+        if (!button->setLandmark(landmark))
+        {
+            m_FreeButtons.push_back(button);
+            return NULL;
+        }
+    }
+    else
+    {
+        button = LandmarkButton::create(landmark);
+        if (!button)
+        {
+            return NULL;
+        }
+        addChild(button);
+        button->updateScale();
+    }
+
+    m_BoundButtons[landmark] = button;
+    return button;
+}
+
+// Get an unused cluster marker from the pool, creating one if needed.
+
+LandmarkClusterMarker* LandmarkLayer::takeMarker()
+{
+    if (m_MarkersInUse == m_Markers.size())
+    {
+        LandmarkClusterMarker* marker = LandmarkClusterMarker::create();
+        if (!marker)
+        {
+            return NULL;
+        }
+        addChild(marker);
+        m_Markers.push_back(marker);
+    }
+
+    return m_Markers[m_MarkersInUse++];
+}
+
+// Find the displayed cluster under an on-screen position.
+
+int LandmarkLayer::getDisplayedClusterAtLocation(const CCPoint& location)
+{
+    // Only the clusters on screen are tested, and there are only ever as many of those as fit on the screen.
+    CCPoint localLocation = ccpSub(location, getPosition());
+    int nearest = -1;
+    float nearestDistance = 0;
+
+    for (unsigned int i = 0; i < m_Displayed.size(); i++)
+    {
+        CCNode* node = m_Displayed[i].node;
+        if (!node->boundingBox().containsPoint(localLocation))
+        {
+            continue;
+        }
+
+        float distance = ccpLengthSQ(ccpSub(node->getPosition(), localLocation));
+        if (nearest < 0 || distance < nearestDistance)
+        {
+            nearest = i;
+            nearestDistance = distance;
+        }
+    }
+
+    return nearest;
+}
+
+// Pass a new touch on to the marker under it, if any.
+
+bool LandmarkLayer::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton || m_ClusterTouch)
+    {
+        return false;
+    }
+
+    int index = getDisplayedClusterAtLocation(pTouch->getLocation());
+    if (index < 0)
+    {
+        return false;
+    }
+
+    // A landmark on its own is pressed like any other button.
+    const DisplayedCluster& displayed = m_Displayed[index];
+    const std::vector<LandmarkCluster>& clusters = m_Clusters.getClusters(m_Level);
+    if (displayed.button)
+    {
+        if (displayed.button->ccTouchBegan(pTouch, pEvent))
+        {
+            m_PressedButton = displayed.button;
+            return true;
+        }
+        return false;
+    }
+
+    // Tapping a cluster zooms in on it until it splits apart.
+    const LandmarkCluster& cluster = clusters[displayed.cluster];
+    m_ClusterTouch = pTouch;
+    m_ClusterTouchStart = pTouch->getLocation();
+    m_PressedClusterPosition = cluster.position;
+    m_PressedClusterScale = (m_Level > 0) ? m_Clusters.getLevelScale(m_Level - 1) : m_MaxScale;
+    return true;
+}
+
+// Pass the user's continued touch input on to the pressed marker.
+
+void LandmarkLayer::ccTouchMoved(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton)
+    {
+        m_PressedButton->ccTouchMoved(pTouch, pEvent);
+    }
+
+    // Dragging away from a cluster marker pans the map instead of tapping the cluster.
+    if (m_ClusterTouch == pTouch && ccpDistance(pTouch->getLocation(), m_ClusterTouchStart) > CLUSTER_TAP_DISTANCE)
+    {
+        m_ClusterTouch = NULL;
+    }
+}
+
+// Pass the end of a touch on to the pressed marker.
+
+void LandmarkLayer::ccTouchEnded(CCTouch *pTouch, CCEvent *pEvent)
+{
+    // Clear the pressed button first, since releasing it opens a popup.
+    LandmarkButton* button = m_PressedButton;
+    m_PressedButton = NULL;
+
+    if (button)
+    {
+        button->ccTouchEnded(pTouch, pEvent);
+        m_NeedsRefresh = true;
+    }
+
+    if (m_ClusterTouch == pTouch)
+    {
+        m_ClusterTouch = NULL;
+        if (m_Observer)
+        {
+            m_Observer->landmarkClusterPressed(m_PressedClusterPosition, m_PressedClusterScale);
+        }
+    }
+}
+
+// Pass the loss of a touch on to the pressed marker.
+
+void LandmarkLayer::ccTouchCancelled(CCTouch *pTouch, CCEvent *pEvent)
+{
+    LandmarkButton* button = m_PressedButton;
+    m_PressedButton = NULL;
+
+    if (button)
+    {
+        button->ccTouchCancelled(pTouch, pEvent);
+        m_NeedsRefresh = true;
+    }
+
+    if (m_ClusterTouch == pTouch)
+    {
+        m_ClusterTouch = NULL;
+    }
+}
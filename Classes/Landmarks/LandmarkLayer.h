@@ -0,0 +1,249 @@
+//
+//  LandmarkLayer.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-26.
+//
+//
+
+#ifndef LANDMARK_LAYER_H
+#define LANDMARK_LAYER_H
+
+#include "cocos2d.h"
+#include <map>
+#include <vector>
+#include "LandmarkStore.h"
+#include "LandmarkButton.h"
+#include "LandmarkCategoryIndex.h"
+#include "LandmarkClusterIndex.h"
+#include "LandmarkClusterMarker.h"
+#include "MapController.h"
+
+/**
+ @brief     An interface for objects which respond to a cluster of landmarks being pressed.
+ */
+class LandmarkLayerObserver
+{
+public:
+
+    /**
+     @brief     Called when the user taps a cluster marker.
+     @param     position    The cluster's position in map space.
+     @param     scale       The scale at which the cluster is fully split into its parts.
+     */
+    virtual void landmarkClusterPressed(const MapPoint& position, float scale) = 0;
+};
+
+/**
+ @brief     A screen-space layer which displays a map's landmarks on top of it, and passes touches on to the landmark under them.
+
+ The layer is not a child of the map, so the markers are never scaled along with it. Instead, the layer follows the map's transform: panning only moves the layer itself, and the markers are only placed again when the scale changes or the view moves outside of the area that was last placed.
+
+ Landmarks which would overlap on screen are grouped into clusters (see LandmarkClusterIndex). A landmark on its own is displayed as its LandmarkButton, while a cluster is displayed as a LandmarkClusterMarker showing how many landmarks it contains. Only the clusters near the view are displayed, so the number of markers depends on the screen's area rather than on how many landmarks there are.
+
+The landmarks can be filtered by category. The layer keeps a LandmarkCategoryIndex in the order of its clusters, so changing the filter only combines a few bitsets, and each cluster's count of matching landmarks is looked up as a range of the result when the markers are placed. Clusters with no matching landmarks aren't displayed, and a cluster with one is displayed as that landmark's button.
+
+The landmarks themselves are kept in the shared LandmarkStore. Both LandmarkButtons and cluster markers are pooled: a button is only bound to a landmark while that landmark is displayed, and is rebound to another landmark once it isn't, so the number of nodes stays bounded by the screen too. Thumbnails come from the shared ThumbnailAtlas.
+ */
+class LandmarkLayer : public cocos2d::CCNode, public cocos2d::CCTouchDelegate
+{
+public:
+
+    /**
+     @brief     Create a LandmarkLayer instance for a map.
+     @param     mapSize     The size of the map in map units.
+     @param     viewSize    The size of the area the map is displayed in.
+     @param     minScale    The smallest scale the map is displayed at.
+     @param     maxScale    The largest scale the map is displayed at.
+     @return    A pointer to the newly created LandmarkLayer.
+     */
+    static LandmarkLayer* create(const cocos2d::CCSize& mapSize, const cocos2d::CCSize& viewSize, float minScale, float maxScale);
+
+    /**
+     @brief     Regroup the landmarks the next time they are displayed. Called after landmarks are added to the LandmarkStore. No button is created for a landmark until it is displayed.
+     */
+    void landmarksChanged();
+
+    /**
+     @brief     Only display the landmarks in some categories.
+     @param     categories  A combination of LandmarkCategory flags, or 0 to display every landmark.
+     @param     matchAll    Whether to display the landmarks in all of the categories rather than in any of them.
+     */
+    void setCategoryFilter(unsigned int categories, bool matchAll);
+
+    /**
+     @brief     Get the categories of landmark being displayed, as a combination of LandmarkCategory flags, or 0 if every landmark is.
+     */
+    unsigned int getCategoryFilter() const { return m_CategoryFilter; }
+
+    /**
+     @brief     Move the landmarks to follow the map.
+     @param     transform   The map's current transform.
+     */
+    void setMapTransform(const MapTransform& transform);
+
+    /**
+     @brief     Set the object which is told when a cluster is pressed.
+     @param     observer    The observer, or NULL for none.
+     */
+    void setObserver(LandmarkLayerObserver* observer) { m_Observer = observer; }
+
+    /**
+     @brief     Pass a new touch on to the marker under it, if any. Only one marker can be pressed at a time.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     @return    Whether or not a marker accepted the touch.
+     */
+    bool ccTouchBegan(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Pass the user's continued touch input on to the pressed marker.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchMoved(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Pass the end of a touch on to the pressed marker.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchEnded(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Pass the loss of a touch on to the pressed marker.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchCancelled(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+protected:
+
+    /**
+     @brief     Initialize a LandmarkLayer instance for a map.
+     @param     mapSize     The size of the map in map units.
+     @param     viewSize    The size of the area the map is displayed in.
+     @param     minScale    The smallest scale the map is displayed at.
+     @param     maxScale    The largest scale the map is displayed at.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(const cocos2d::CCSize& mapSize, const cocos2d::CCSize& viewSize, float minScale, float maxScale);
+
+    /**
+     @brief     Called when this is removed from the node tree.
+     */
+    void onExit();
+
+    /**
+     @brief     Bring the displayed markers up to date with the map's transform, then draw them.
+     */
+    void visit();
+
+private:
+
+    /**
+     @brief     A cluster that is currently on screen and the node displaying it.
+     */
+    struct DisplayedCluster
+    {
+        cocos2d::CCNode* node;
+        LandmarkButton* button;
+        unsigned int cluster;
+    };
+
+    /**
+     @brief     Choose the markers to display around the view and place them.
+     */
+    void refresh();
+
+    /**
+     @brief     Work out which landmarks pass the category filter.
+     */
+    void updateFilter();
+
+    /**
+     @brief     Get the area of the map inside the view at the current transform.
+     */
+    void getVisibleArea(MapPoint* minimum, MapPoint* maximum) const;
+
+    /**
+     @brief     Bind an unused LandmarkButton from the pool to a landmark, creating one if needed.
+     @param     landmark    The ID of the landmark to bind.
+     @return    The button, or NULL if one couldn't be bound.
+     */
+    LandmarkButton* takeButton(LandmarkID landmark);
+
+    /**
+     @brief     Get an unused cluster marker from the pool, creating one if needed.
+     @return    The marker, or NULL if one couldn't be created.
+     */
+    LandmarkClusterMarker* takeMarker();
+
+    /**
+     @brief     Find the displayed cluster under an on-screen position (for example, a touch location).
+     @param     location    The on-screen position to look up.
+     @return    The index of the displayed cluster closest to the position out of those it falls on, or -1 if there are none.
+     */
+    int getDisplayedClusterAtLocation(const cocos2d::CCPoint& location);
+
+    /** The sizes and scales of the map the layer follows. */
+    MapPoint m_MapSize;
+    MapPoint m_ViewSize;
+    float m_MinScale;
+    float m_MaxScale;
+
+    /** The landmarks grouped into clusters, and whether or not the LandmarkStore has changed since it was built. */
+    LandmarkClusterIndex m_Clusters;
+    bool m_ClustersOutOfDate;
+
+    /** The landmarks in each category, in cluster order, along with the categories being displayed and those of the landmarks which match. */
+    LandmarkCategoryIndex m_CategoryIndex;
+    unsigned int m_CategoryFilter;
+    bool m_MatchAllCategories;
+    LandmarkBitset m_Filter;
+
+    /** The map's transform as of the last time the landmarks were moved. */
+    MapTransform m_MapTransform;
+
+    /** Whether or not the displayed markers need to be placed again before they are next drawn. */
+    bool m_NeedsRefresh;
+
+    /** The level and split of the clusters being displayed, and the area of the map they were chosen from. */
+    unsigned int m_Level;
+    float m_Split;
+    MapPoint m_RefreshedMinimum;
+    MapPoint m_RefreshedMaximum;
+
+    /** The clusters currently on screen. */
+    std::vector<DisplayedCluster> m_Displayed;
+
+    /** The clusters found by the last refresh, how many of their landmarks pass the filter along with one of those landmarks, and their positions within the layer. Kept between refreshes to avoid reallocating them. */
+    std::vector<unsigned int> m_Found;
+    std::vector<unsigned int> m_FoundCounts;
+    std::vector<LandmarkID> m_FoundLandmarks;
+    std::vector<float> m_LayerX;
+    std::vector<float> m_LayerY;
+
+    /** The buttons bound to each displayed landmark and those bound by the previous refresh, along with the buttons which aren't bound to anything. */
+    std::map<LandmarkID, LandmarkButton*> m_BoundButtons;
+    std::map<LandmarkID, LandmarkButton*> m_PreviouslyBound;
+    std::vector<LandmarkButton*> m_FreeButtons;
+
+    /** Every cluster marker that has been created, and how many of them are in use. */
+    std::vector<LandmarkClusterMarker*> m_Markers;
+    unsigned int m_MarkersInUse;
+
+    /** The LandmarkButton currently being pressed. */
+    LandmarkButton* m_PressedButton;
+
+    /** The touch pressing a cluster marker and where it began, along with the pressed cluster's position and the scale it splits apart at. */
+    cocos2d::CCTouch* m_ClusterTouch;
+    cocos2d::CCPoint m_ClusterTouchStart;
+    MapPoint m_PressedClusterPosition;
+    float m_PressedClusterScale;
+
+    /** The object told when a cluster is pressed. */
+    LandmarkLayerObserver* m_Observer;
+};
+
+#endif // LANDMARK_LAYER_H
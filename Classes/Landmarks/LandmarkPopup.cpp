@@ -10,15 +10,19 @@
 #include "Defines.h"
 #include "GoogleMapsLauncher.h"
 #include "WebLauncher.h"
+#include "AssetResolver.h"
+#include "StreetGeocoder.h"
 
 #define COLOUR_BUTTON_NORMAL    ccc3(0, 150, 141)
 #define COLOUR_BUTTON_CLOSE     ccc3(0, 92, 115)
 
 using namespace cocos2d;
 
+LandmarkDirectionsObserver* LandmarkPopup::s_DirectionsObserver = NULL;
+
 // Create an popup that displays the information from a specified landmark and add it to the current scene.
 
-LandmarkPopup* LandmarkPopup::showPopup(Landmark landmark, cocos2d::CCPoint buttonPosition)
+LandmarkPopup* LandmarkPopup::showPopup(LandmarkID landmark, cocos2d::CCPoint buttonPosition)
 {
     LandmarkPopup* popup = create(landmark, buttonPosition);
     
@@ -35,7 +39,7 @@ LandmarkPopup* LandmarkPopup::showPopup(Landmark landmark, cocos2d::CCPoint butt
 
 // Create a new Popup instance.
  
-LandmarkPopup* LandmarkPopup::create(Landmark landmark, cocos2d::CCPoint buttonPosition)
+LandmarkPopup* LandmarkPopup::create(LandmarkID landmark, cocos2d::CCPoint buttonPosition)
 {
     LandmarkPopup *popup = new LandmarkPopup();
     if (popup && popup->init(landmark, buttonPosition))
@@ -49,9 +53,10 @@ LandmarkPopup* LandmarkPopup::create(Landmark landmark, cocos2d::CCPoint buttonP
 
 // Initialize this Popup instance.
 
-bool LandmarkPopup::init(Landmark landmark, cocos2d::CCPoint buttonPosition)
+bool LandmarkPopup::init(LandmarkID landmark, cocos2d::CCPoint buttonPosition)
 {
-    if (!Popup::init())
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    if (!store->isValid(landmark) || !Popup::init())
     {
         return false;
     }
@@ -59,33 +64,48 @@ bool LandmarkPopup::init(Landmark landmark, cocos2d::CCPoint buttonPosition)
     m_Landmark = landmark;
     
     // Add title to top of page.
-    addContent(CCLabelTTF::create(landmark.name, "Montserrat", 150 * SCREEN_SCALE));
+    addContent(CCLabelTTF::create(store->getName(landmark), "Montserrat", 150 * SCREEN_SCALE));
     
-    // Add the image illustrating the landmark.
+    // Add the image illustrating the landmark, using the variant best suited to this device. The image is decoded straight into the upload buffer and bypasses the texture cache, so it is freed along with the popup.
     char fullFileName[64];
-    sprintf(fullFileName, "%s.png", m_Landmark.imageFileName);
-    m_Texture = CCTextureCache::sharedTextureCache()->addImage(fullFileName);
-    CCSprite* image = CCSprite::createWithTexture(m_Texture);
-    image->setScale(SCREEN_SCALE);
-    addContent(image);
+    snprintf(fullFileName, sizeof(fullFileName), "%s.png", store->getImageKey(landmark));
+    float assetScale;
+    CCTexture2D* texture = AssetResolver::createTexture(fullFileName, &assetScale);
+    CCSprite* image = NULL;
+    if (texture)
+    {
+        image = CCSprite::createWithTexture(texture);
+        image->setScale(SCREEN_SCALE / assetScale);
+        addContent(image);
+    }
+    
+    // A missing or corrupt image shouldn't stop the rest of the landmark's details from being shown, so the popup goes without it.
+    else
+    {
+        CCLOG("Failed to load the image for \"%s\".", store->getName(landmark));
+    }
     
     // Add the description.
-    addContent(CCLabelTTF::create(landmark.description, "Montserrat", 75 * SCREEN_SCALE));
+    const char* description = store->getDescription(landmark);
+    addContent(CCLabelTTF::create(description ? description : "", "Montserrat", 75 * SCREEN_SCALE));
     
     // If an address was provided, add a button to get directions to this landmark.
-    if (landmark.address != NULL && landmark.address[0] != '\0')
+    const char* address = store->getAddress(landmark);
+    if (address != NULL && address[0] != '\0')
     {
         addButton("Get Directions", CCCallFunc::create(this, callfunc_selector(LandmarkPopup::getDirections)), COLOUR_BUTTON_NORMAL);
     }
     
     // If a website URL was provided, add a linking button.
-    if (landmark.websiteURL != NULL && landmark.websiteURL[0] != '\0')
+    const char* websiteURL = store->getWebsiteURL(landmark);
+    if (websiteURL != NULL && websiteURL[0] != '\0')
     {
         addButton("Visit Website", CCCallFunc::create(this, callfunc_selector(LandmarkPopup::launchWebsite)), COLOUR_BUTTON_NORMAL);
     }
     
     // If a ticketing URL was provided, add a linking button
-    if (landmark.ticketsURL != NULL && landmark.ticketsURL[0] != '\0')
+    const char* ticketsURL = store->getTicketsURL(landmark);
+    if (ticketsURL != NULL && ticketsURL[0] != '\0')
     {
         addButton("Get Tickets", CCCallFunc::create(this, callfunc_selector(LandmarkPopup::launchTicketWebsite)), COLOUR_BUTTON_NORMAL);
     }
@@ -104,43 +124,61 @@ bool LandmarkPopup::init(Landmark landmark, cocos2d::CCPoint buttonPosition)
     m_Backdrop->setOpacity(0);
     m_Backdrop->runAction(CCEaseOut::create(CCFadeTo::create(duration, backdropOpacity), rate));
     
-    image->stopAllActions();
-    CCPoint imagePosition = image->getPosition();
-    float imageScale = image->getScale();
-    image->setPosition(buttonPosition);
-    image->setOpacity(255);
-    image->setScale(imageScale*0.375f);
-    image->runAction(CCMoveTo::create(duration, imagePosition));
-    image->runAction(CCScaleTo::create(duration, imageScale));
+    if (image)
+    {
+        image->stopAllActions();
+        CCPoint imagePosition = image->getPosition();
+        float imageScale = image->getScale();
+        image->setPosition(buttonPosition);
+        image->setOpacity(255);
+        image->setScale(imageScale*0.375f);
+        image->runAction(CCMoveTo::create(duration, imagePosition));
+        image->runAction(CCScaleTo::create(duration, imageScale));
+    }
     
     return true;
 }
 
-// Called when the popup is removed from the node tree.
-
-void LandmarkPopup::onExit()
-{
-    // Remove the texture from the texture cache to free up memory.
-    CCTextureCache::sharedTextureCache()->removeTexture(m_Texture);
-    
-    // Pass control along to the base class.
-    Popup::onExit();
-}
-
-// Display directions to this landmark with Google Maps.
+// Display directions to this landmark, on the map if the directions observer can, or otherwise with Google Maps.
  
 void LandmarkPopup::getDirections()
 {
-    GoogleMapsLauncher::showDirections(m_Landmark.address);
+    // The route is drawn over the map, so the popup gets out of the way.
+    if (s_DirectionsObserver && s_DirectionsObserver->landmarkDirectionsRequested(m_Landmark))
+    {
+        closePopup();
+        return;
+    }
+    
+    // The strings are looked up again rather than kept, since the store may have moved them since the popup was created.
+    const char* address = LandmarkStore::sharedStore()->getAddress(m_Landmark);
+    if (address == NULL || address[0] == '\0')
+    {
+        return;
+    }
+    
+    // Resolve the address on the device if the street data knows it, so that Google Maps is given an exact location rather than a query it has to look up over the network.
+    StreetAddress location;
+    if (StreetGeocoder(StreetData::sharedData()).geocode(address, &location))
+    {
+        char coordinates[64];
+        snprintf(coordinates, sizeof(coordinates), "%.6f,%.6f", location.location.latitude, location.location.longitude);
+        GoogleMapsLauncher::showDirections(coordinates);
+    }
+    else
+    {
+        GoogleMapsLauncher::showDirections(address);
+    }
 }
 
 // Launch the landmark's official website.
 
 void LandmarkPopup::launchWebsite()
 {
-    if (m_Landmark.websiteURL != NULL && m_Landmark.websiteURL[0] != '\0')
+    const char* websiteURL = LandmarkStore::sharedStore()->getWebsiteURL(m_Landmark);
+    if (websiteURL != NULL && websiteURL[0] != '\0')
     {
-        WebLauncher::launchBrowserWithURL(m_Landmark.websiteURL);
+        WebLauncher::launchBrowserWithURL(websiteURL);
     }
 }
 
@@ -148,8 +186,9 @@ void LandmarkPopup::launchWebsite()
  
 void LandmarkPopup::launchTicketWebsite()
 {
-    if (m_Landmark.ticketsURL != NULL && m_Landmark.ticketsURL[0] != '\0')
+    const char* ticketsURL = LandmarkStore::sharedStore()->getTicketsURL(m_Landmark);
+    if (ticketsURL != NULL && ticketsURL[0] != '\0')
     {
-        WebLauncher::launchBrowserWithURL(m_Landmark.ticketsURL);
+        WebLauncher::launchBrowserWithURL(ticketsURL);
     }
 }
@@ -10,7 +10,22 @@
 #define LANDMARK_POPUP_H
 
 #include "Popup.h"
-#include "Landmark.h"
+#include "LandmarkStore.h"
+
+/**
+ @brief     An interface for showing directions to a landmark without leaving the app.
+ */
+class LandmarkDirectionsObserver
+{
+public:
+
+    /**
+     @brief     Called when the user asks for directions from a LandmarkPopup.
+     @param     landmark    The ID of the landmark to show directions to.
+     @return    Whether or not the directions could be shown. If not, the popup opens Google Maps instead.
+     */
+    virtual bool landmarkDirectionsRequested(LandmarkID landmark) = 0;
+};
 
 /**
  @brief     A popup designed to show the name, an image and a brief description of a landmark as well as providing options to get directions to the location or visit its website.
@@ -21,37 +36,38 @@ public:
     
     /**
      @brief     Create an popup that displays the information from a specified landmark and add it to the current scene.
-     @param     landmark        The landmark whose info should be displayed.
+     @param     landmark        The ID of the landmark whose info should be displayed, in the shared LandmarkStore.
      @param     buttonPosition  The position of the corresponding LandmarkButton (used for visual flare).
      @return    A pointer to the popup that is created.
      */
-    static LandmarkPopup* showPopup(Landmark landmark, cocos2d::CCPoint buttonPosition);
+    static LandmarkPopup* showPopup(LandmarkID landmark, cocos2d::CCPoint buttonPosition);
+    
+    /**
+     @brief     Set the observer which is asked to show directions before Google Maps is. Popups are opened from several places (ie. the landmarks' buttons and the search results), so one observer is shared by all of them.
+     @param     observer    The observer, or NULL to always use Google Maps.
+     */
+    static void setDirectionsObserver(LandmarkDirectionsObserver* observer) { s_DirectionsObserver = observer; }
     
 protected:
     
     /**
      @brief     Create an popup that displays the information from a specified landmark.
-     @param     landmark    The landmark whose info should be displayed.
+     @param     landmark    The ID of the landmark whose info should be displayed, in the shared LandmarkStore.
      @param     buttonPosition  The position of the corresponding LandmarkButton (used for visual flare).
      @return    A pointer to the popup that is created.
      */
-    static LandmarkPopup* create(Landmark landmark, cocos2d::CCPoint buttonPosition);
+    static LandmarkPopup* create(LandmarkID landmark, cocos2d::CCPoint buttonPosition);
     
     /**
      @brief     Initialize this LandmarkPopup with its Landmark info.
-     @param     landmark    The landmark whose info should be displayed.
+     @param     landmark    The ID of the landmark whose info should be displayed, in the shared LandmarkStore.
      @param     buttonPosition  The position of the corresponding LandmarkButton (used for visual flare).
      @return    Whether or not the initialization was successful.
      */
-    bool init(Landmark landmark, cocos2d::CCPoint buttonPosition);
-    
-    /**
-     @brief Called when the popup is removed from the node tree.
-     */
-    void onExit();
+    bool init(LandmarkID landmark, cocos2d::CCPoint buttonPosition);
     
     /**
-     @brief     Display directions to this landmark with Google Maps.
+     @brief     Display directions to this landmark, on the map if the directions observer can, or otherwise with Google Maps.
      */
     void getDirections();
     
@@ -67,11 +83,11 @@ protected:
     
 private:
     
-    /** The Landmark data being presented by the popup. */
-    Landmark m_Landmark;
+    /** The ID of the landmark being presented by the popup. */
+    LandmarkID m_Landmark;
     
-    /** The texture used for the image. */
-    cocos2d::CCTexture2D* m_Texture;
+    /** The observer asked to show directions on the map. */
+    static LandmarkDirectionsObserver* s_DirectionsObserver;
 };
 
 #endif // LANDMARK_POPUP_H
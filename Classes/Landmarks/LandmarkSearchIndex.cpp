@@ -0,0 +1,841 @@
+//
+//  LandmarkSearchIndex.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkSearchIndex.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The file's identifying bytes and the only version this code understands.
+static const char* FILE_MAGIC = "NYLS";
+static const unsigned short FILE_VERSION = 3;
+
+// The size in bytes of the file header, and the number of values in a node, a word and a skip.
+static const unsigned long HEADER_SIZE = 76;
+static const unsigned int NODE_FIELD_COUNT = 4;
+static const unsigned int WORD_FIELD_COUNT = 3;
+static const unsigned int SKIP_FIELD_COUNT = 2;
+
+// The most words of a query which are matched, the most words that its last, incomplete word is expanded to, and the most landmarks which are ranked after matching them.
+static const unsigned int MAX_QUERY_WORDS = 8;
+static const unsigned int MAX_PREFIX_WORDS = 32;
+static const unsigned int MAX_CANDIDATES = 64;
+
+// The most postings stepped through looking for landmarks with every word of a query. This bounds the time a query takes when its words are common but rarely appear together, at the cost of missing some of those landmarks.
+static const unsigned int MAX_SCANNED_POSTINGS = 4096;
+
+// The letters that Latin-1 Supplement letters (from U+00C0) are folded to. NULL marks the multiplication and division signs, which separate words.
+static const char* LATIN_1_FOLDS[64] =
+{
+    "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+    "d", "n", "o", "o", "o", "o", "o", NULL, "o", "u", "u", "u", "u", "y", "th", "ss",
+    "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+    "d", "n", "o", "o", "o", "o", "o", NULL, "o", "u", "u", "u", "u", "y", "th", "y"
+};
+
+// The letters that Latin Extended-A letters (U+0100 to U+017F) are folded to. '1' and '2' stand for the ligatures "ij" and "oe".
+static const char* LATIN_EXTENDED_A_FOLDS =
+    "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii11jjkkkllllllllllnnnnnnnnnoooooo22rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+
+// Read little-endian values from the header regardless of the host's byte order.
+
+static unsigned short readUInt16(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int readUInt32(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+// Check whether or not a section of the file starts on a 4-byte boundary and fits inside the file.
+
+static bool isSectionValid(unsigned long offset, unsigned long count, unsigned long elementSize, unsigned long fileSize)
+{
+    return (offset % 4 == 0 && offset >= HEADER_SIZE && offset <= fileSize && count <= (fileSize - offset) / elementSize);
+}
+
+// Decode one character from UTF-8, returning the number of bytes it takes up, or 0 if the bytes aren't valid UTF-8.
+
+static unsigned int decodeUTF8(const unsigned char* text, unsigned int* character)
+{
+    if (text[0] < 0x80)
+    {
+        *character = text[0];
+        return 1;
+    }
+
+    unsigned int length = (text[0] >= 0xF0) ? 4 : (text[0] >= 0xE0) ? 3 : (text[0] >= 0xC0) ? 2 : 0;
+    if (length == 0 || (length == 4 && text[0] >= 0xF8))
+    {
+        return 0;
+    }
+
+    *character = text[0] & (0x7F >> length);
+    for (unsigned int i = 1; i < length; i++)
+    {
+        // A zero terminator fails this check too, so a truncated character never reads past the end of the text.
+        if ((text[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        *character = (*character << 6) | (text[i] & 0x3F);
+    }
+
+    return length;
+}
+
+/**
+ @brief     Reads one word's postings in order of landmark ID, decoding them a block at a time.
+ */
+struct PostingCursor
+{
+    /** The word's skips, and how many postings they cover. */
+    const unsigned int* skips;
+    unsigned int count;
+
+    /** The postings section, which every block's deltas must lie inside. */
+    const unsigned char* postings;
+    const unsigned char* postingsEnd;
+
+    /** The block of the current posting, how many postings follow it in the block, and where the next one's delta starts. */
+    unsigned int block;
+    unsigned int remaining;
+    const unsigned char* next;
+
+    /** The current posting, unless every posting has been read. */
+    unsigned int value;
+    bool isDone;
+};
+
+// Move a cursor to the start of a block.
+
+static void startBlock(PostingCursor* cursor, unsigned int block)
+{
+    unsigned int first = block * LandmarkSearchIndex::POSTING_BLOCK_SIZE;
+    cursor->block = block;
+    cursor->isDone = (first >= cursor->count);
+    if (!cursor->isDone)
+    {
+        unsigned int offset = cursor->skips[block * SKIP_FIELD_COUNT + 1];
+        cursor->remaining = std::min(cursor->count - first, (unsigned int)LandmarkSearchIndex::POSTING_BLOCK_SIZE) - 1;
+        cursor->value = cursor->skips[block * SKIP_FIELD_COUNT];
+        cursor->next = cursor->postings + std::min(offset, (unsigned int)(cursor->postingsEnd - cursor->postings));
+    }
+}
+
+// Move a cursor on to the next posting, decoding its delta or starting the next block.
+
+static inline void advance(PostingCursor* cursor)
+{
+    if (cursor->isDone)
+    {
+        return;
+    }
+
+    if (cursor->remaining == 0)
+    {
+        startBlock(cursor, cursor->block + 1);
+        return;
+    }
+    cursor->remaining--;
+
+    // Most deltas fit in one byte. A delta which runs off the end of the postings ends them.
+    if (cursor->next != cursor->postingsEnd && *cursor->next < 0x80)
+    {
+        cursor->value += *cursor->next++;
+        return;
+    }
+
+    unsigned int delta = 0;
+    for (unsigned int shift = 0; ; shift += 7)
+    {
+        if (cursor->next == cursor->postingsEnd || shift > 28)
+        {
+            cursor->isDone = true;
+            return;
+        }
+
+        unsigned char byte = *cursor->next++;
+        delta |= (byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    cursor->value += delta;
+}
+
+// Find a landmark's posting, returning whether or not the word appears in the landmark. The landmarks are looked up in order of ID, so the cursor is moved up past the postings of landmarks before it: the search gallops forward through the skips to the block which could hold the landmark, then decodes that block up to it.
+
+static bool findPosting(PostingCursor* cursor, LandmarkID landmark)
+{
+    unsigned int target = landmark << 1;
+    if (cursor->isDone || cursor->value >= target)
+    {
+        return (!cursor->isDone && (cursor->value >> 1) == landmark);
+    }
+
+    unsigned int blockCount = (cursor->count + LandmarkSearchIndex::POSTING_BLOCK_SIZE - 1) / LandmarkSearchIndex::POSTING_BLOCK_SIZE;
+    unsigned int low = cursor->block;
+    unsigned int bound = 1;
+    while (low + bound < blockCount && cursor->skips[(low + bound) * SKIP_FIELD_COUNT] <= target)
+    {
+        low += bound;
+        bound *= 2;
+    }
+
+    // The last block whose first posting isn't past the target is between low and low + bound.
+    unsigned int high = std::min(low + bound, blockCount);
+    while (high - low > 1)
+    {
+        unsigned int middle = (low + high) / 2;
+        if (cursor->skips[middle * SKIP_FIELD_COUNT] <= target)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low != cursor->block)
+    {
+        startBlock(cursor, low);
+    }
+    while (!cursor->isDone && cursor->value < target)
+    {
+        advance(cursor);
+    }
+
+    return (!cursor->isDone && (cursor->value >> 1) == landmark);
+}
+
+// The shared index.
+static LandmarkSearchIndex* s_SharedIndex = NULL;
+
+// Get the index shared by the map and the search popup.
+
+LandmarkSearchIndex* LandmarkSearchIndex::sharedIndex()
+{
+    if (!s_SharedIndex)
+    {
+        s_SharedIndex = new LandmarkSearchIndex();
+    }
+
+    return s_SharedIndex;
+}
+
+// Default constructor.
+
+LandmarkSearchIndex::LandmarkSearchIndex()
+: m_Mapping(NULL)
+, m_MappingSize(0)
+, m_Count(0)
+, m_CatalogChecksum(0)
+, m_NodeCount(0)
+, m_Nodes(NULL)
+, m_HitCount(0)
+, m_Hits(NULL)
+, m_LabelsSize(0)
+, m_Labels(NULL)
+, m_WordCount(0)
+, m_Words(NULL)
+, m_SkipCount(0)
+, m_Skips(NULL)
+, m_PostingsSize(0)
+, m_Postings(NULL)
+, m_StringsSize(0)
+, m_Strings(NULL)
+{
+}
+
+// Destructor.
+
+LandmarkSearchIndex::~LandmarkSearchIndex()
+{
+    close();
+}
+
+// Map an index file.
+
+bool LandmarkSearchIndex::open(const char* path)
+{
+    close();
+
+    int file = ::open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t)HEADER_SIZE)
+    {
+        mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    // The mapping stays valid once the file is closed.
+    ::close(file);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_Mapping = mapping;
+    m_MappingSize = status.st_size;
+
+    if (!readHeader((const unsigned char*)m_Mapping, m_MappingSize))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+// Take over an index which was written in memory.
+
+bool LandmarkSearchIndex::load(std::vector<unsigned char>* data)
+{
+    close();
+    m_Data.swap(*data);
+
+    if (m_Data.size() < HEADER_SIZE || !readHeader(&m_Data[0], m_Data.size()))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+// Unmap the index file or free its data.
+
+void LandmarkSearchIndex::close()
+{
+    if (m_Mapping)
+    {
+        munmap(m_Mapping, m_MappingSize);
+    }
+
+    m_Mapping = NULL;
+    m_MappingSize = 0;
+    std::vector<unsigned char>().swap(m_Data);
+
+    m_Count = 0;
+    m_CatalogChecksum = 0;
+    m_NodeCount = 0;
+    m_Nodes = NULL;
+    m_HitCount = 0;
+    m_Hits = NULL;
+    m_LabelsSize = 0;
+    m_Labels = NULL;
+    m_WordCount = 0;
+    m_Words = NULL;
+    m_SkipCount = 0;
+    m_Skips = NULL;
+    m_PostingsSize = 0;
+    m_Postings = NULL;
+    m_StringsSize = 0;
+    m_Strings = NULL;
+}
+
+// Check the header of the mapped file or loaded data and find each of its sections.
+
+bool LandmarkSearchIndex::readHeader(const unsigned char* bytes, unsigned long size)
+{
+    // The sections are used in place, so the host has to share the file's byte order. Every iOS device is little-endian.
+    unsigned short byteOrderProbe = 1;
+    if (*(unsigned char*)&byteOrderProbe != 1)
+    {
+        return false;
+    }
+
+    unsigned int nodeCount = readUInt32(bytes + 12);
+    unsigned int nodesOffset = readUInt32(bytes + 16);
+    unsigned int hitCount = readUInt32(bytes + 20);
+    unsigned int hitsOffset = readUInt32(bytes + 24);
+    unsigned int labelsSize = readUInt32(bytes + 28);
+    unsigned int labelsOffset = readUInt32(bytes + 32);
+    unsigned int wordCount = readUInt32(bytes + 36);
+    unsigned int wordsOffset = readUInt32(bytes + 40);
+    unsigned int skipCount = readUInt32(bytes + 44);
+    unsigned int skipsOffset = readUInt32(bytes + 48);
+    unsigned int postingsSize = readUInt32(bytes + 52);
+    unsigned int postingsOffset = readUInt32(bytes + 56);
+    unsigned int stringsSize = readUInt32(bytes + 60);
+    unsigned int stringsOffset = readUInt32(bytes + 64);
+    unsigned int fileSize = readUInt32(bytes + 68);
+
+    if (memcmp(bytes, FILE_MAGIC, 4) != 0 || readUInt16(bytes + 4) != FILE_VERSION || fileSize != size ||
+        !isSectionValid(nodesOffset, nodeCount, NODE_FIELD_COUNT * 4, size) || nodeCount == 0 ||
+        !isSectionValid(hitsOffset, hitCount, 4, size) ||
+        !isSectionValid(labelsOffset, labelsSize, 1, size) ||
+        !isSectionValid(wordsOffset, wordCount, WORD_FIELD_COUNT * 4, size) ||
+        !isSectionValid(skipsOffset, skipCount, SKIP_FIELD_COUNT * 4, size) ||
+        !isSectionValid(postingsOffset, postingsSize, 1, size) ||
+        !isSectionValid(stringsOffset, stringsSize, 1, size) ||
+        stringsSize == 0 || bytes[stringsOffset + stringsSize - 1] != '\0')
+    {
+        return false;
+    }
+
+    // Since the string table ends with a zero byte, every word starting inside it is terminated.
+    m_Count = readUInt32(bytes + 8);
+    m_CatalogChecksum = readUInt32(bytes + 72);
+    m_NodeCount = nodeCount;
+    m_Nodes = (const unsigned int*)(bytes + nodesOffset);
+    m_HitCount = hitCount;
+    m_Hits = (const unsigned int*)(bytes + hitsOffset);
+    m_LabelsSize = labelsSize;
+    m_Labels = bytes + labelsOffset;
+    m_WordCount = wordCount;
+    m_Words = (const unsigned int*)(bytes + wordsOffset);
+    m_SkipCount = skipCount;
+    m_Skips = (const unsigned int*)(bytes + skipsOffset);
+    m_PostingsSize = postingsSize;
+    m_Postings = bytes + postingsOffset;
+    m_StringsSize = stringsSize;
+    m_Strings = (const char*)(bytes + stringsOffset);
+    return true;
+}
+
+// Find the landmarks best matching a query.
+
+unsigned int LandmarkSearchIndex::search(const char* query, LandmarkID* results, unsigned int maxResults) const
+{
+    std::string folded;
+    bool lastWordComplete;
+    fold(query, &folded, &lastWordComplete);
+    if (!m_Nodes || folded.empty() || maxResults == 0)
+    {
+        return 0;
+    }
+
+    // Names containing the query from the start of a word are already ranked in the trie, so they are read straight from the node the query leads to.
+    unsigned int resultCount = 0;
+    int node = findNode(folded.substr(0, MAX_KEY_LENGTH));
+    if (node >= 0)
+    {
+        const unsigned int* fields = m_Nodes + node * NODE_FIELD_COUNT;
+        unsigned int firstHit = fields[3];
+        unsigned int hitCount = (fields[1] >> 8) & 0xFF;
+        if (firstHit <= m_HitCount && hitCount <= m_HitCount - firstHit)
+        {
+            for (unsigned int i = 0; i < hitCount && resultCount < maxResults; i++)
+            {
+                results[resultCount++] = m_Hits[firstHit + i];
+            }
+        }
+    }
+
+    unsigned int nameResultCount = resultCount;
+    if (resultCount == maxResults)
+    {
+        return resultCount;
+    }
+
+    // Then look for landmarks with every word of the query somewhere in their names or descriptions. Split the folded query into its words in place.
+    char* words[MAX_QUERY_WORDS];
+    unsigned int wordCount = 0;
+    for (char* word = &folded[0]; word && wordCount < MAX_QUERY_WORDS; )
+    {
+        words[wordCount++] = word;
+        word = strchr(word, ' ');
+        if (word)
+        {
+            *word++ = '\0';
+
+            // Any words past the limit are dropped, which leaves the last one kept complete.
+            if (wordCount == MAX_QUERY_WORDS)
+            {
+                lastWordComplete = true;
+            }
+        }
+    }
+
+    // Every complete word has to appear in the landmark exactly.
+    PostingCursor completeCursors[MAX_QUERY_WORDS];
+    unsigned int completeCount = lastWordComplete ? wordCount : wordCount - 1;
+    for (unsigned int i = 0; i < completeCount; i++)
+    {
+        unsigned int word = findWord(words[i]);
+        const char* wordString = (word < m_WordCount) ? getWordString(word) : NULL;
+        if (!wordString || strcmp(wordString, words[i]) != 0 || !getPostings(word, &completeCursors[i]))
+        {
+            return resultCount;
+        }
+    }
+
+    // The last word, while it is still being typed, can be the start of any word in the landmark.
+    PostingCursor prefixCursors[MAX_PREFIX_WORDS];
+    unsigned int prefixCount = 0;
+    if (!lastWordComplete)
+    {
+        const char* prefix = words[wordCount - 1];
+        unsigned int prefixLength = strlen(prefix);
+        for (unsigned int word = findWord(prefix); word < m_WordCount && prefixCount < MAX_PREFIX_WORDS; word++)
+        {
+            const char* wordString = getWordString(word);
+            if (!wordString || strncmp(wordString, prefix, prefixLength) != 0)
+            {
+                break;
+            }
+
+            if (getPostings(word, &prefixCursors[prefixCount]))
+            {
+                prefixCount++;
+            }
+        }
+
+        if (prefixCount == 0)
+        {
+            return resultCount;
+        }
+    }
+
+    // Gather the matching landmarks along with how many of the query's words each has in its name. They are found by stepping through the postings of the rarest complete word, or of the words that the last one could be if there are fewer of those, and looking each landmark up in the other words' postings.
+    unsigned int rarest = 0;
+    for (unsigned int i = 1; i < completeCount; i++)
+    {
+        if (completeCursors[i].count < completeCursors[rarest].count)
+        {
+            rarest = i;
+        }
+    }
+
+    unsigned int prefixPostingCount = 0;
+    for (unsigned int i = 0; i < prefixCount; i++)
+    {
+        prefixPostingCount += prefixCursors[i].count;
+    }
+
+    bool drivenByPrefix = (completeCount == 0 || (prefixCount > 0 && prefixPostingCount < completeCursors[rarest].count));
+    unsigned int passCount = drivenByPrefix ? prefixCount : 1;
+
+    LandmarkID candidates[MAX_CANDIDATES];
+    unsigned int nameMatches[MAX_CANDIDATES];
+    unsigned int candidateCount = 0;
+    unsigned int scannedCount = 0;
+
+    for (unsigned int pass = 0; pass < passCount && candidateCount < MAX_CANDIDATES && scannedCount < MAX_SCANNED_POSTINGS; pass++)
+    {
+        // Each pass steps through one word's postings in order of ID, so the other words' postings are searched from where the last lookup left off.
+        PostingCursor driver = drivenByPrefix ? prefixCursors[pass] : completeCursors[rarest];
+        PostingCursor others[MAX_QUERY_WORDS];
+        PostingCursor prefixes[MAX_PREFIX_WORDS];
+        std::copy(completeCursors, completeCursors + completeCount, others);
+        std::copy(prefixCursors, prefixCursors + prefixCount, prefixes);
+
+        for (; !driver.isDone && candidateCount < MAX_CANDIDATES && scannedCount < MAX_SCANNED_POSTINGS;
+             advance(&driver), scannedCount++)
+        {
+            LandmarkID landmark = driver.value >> 1;
+            unsigned int matches = driver.value & 1;
+            bool matched = true;
+
+            for (unsigned int i = 0; i < completeCount && matched; i++)
+            {
+                if (drivenByPrefix || i != rarest)
+                {
+                    matched = findPosting(&others[i], landmark);
+                    if (matched) matches += others[i].value & 1;
+                }
+            }
+
+            if (matched && !drivenByPrefix && prefixCount > 0)
+            {
+                unsigned int prefixMatch = 0;
+                matched = false;
+                for (unsigned int i = 0; i < prefixCount; i++)
+                {
+                    if (findPosting(&prefixes[i], landmark))
+                    {
+                        matched = true;
+                        prefixMatch = std::max(prefixMatch, prefixes[i].value & 1);
+                    }
+                }
+                matches += prefixMatch;
+            }
+
+            if (!matched)
+            {
+                continue;
+            }
+
+            // A landmark can have more than one of the words that the last one could be.
+            unsigned int existing = std::find(candidates, candidates + candidateCount, landmark) - candidates;
+            if (existing < candidateCount)
+            {
+                nameMatches[existing] = std::max(nameMatches[existing], matches);
+            }
+            else
+            {
+                candidates[candidateCount] = landmark;
+                nameMatches[candidateCount] = matches;
+                candidateCount++;
+            }
+        }
+    }
+
+    // Rank the landmarks with more of the words in their names first, keeping them in order of ID otherwise.
+    for (unsigned int i = 1; i < candidateCount; i++)
+    {
+        LandmarkID landmark = candidates[i];
+        unsigned int matches = nameMatches[i];
+        unsigned int j = i;
+        for (; j > 0 && nameMatches[j - 1] < matches; j--)
+        {
+            candidates[j] = candidates[j - 1];
+            nameMatches[j] = nameMatches[j - 1];
+        }
+        candidates[j] = landmark;
+        nameMatches[j] = matches;
+    }
+
+    // Add them after the name matches, leaving out the landmarks which were already found.
+    for (unsigned int i = 0; i < candidateCount && resultCount < maxResults; i++)
+    {
+        if (std::find(results, results + nameResultCount, candidates[i]) == results + nameResultCount)
+        {
+            results[resultCount++] = candidates[i];
+        }
+    }
+
+    return resultCount;
+}
+
+// Fold text for indexing or searching.
+
+void LandmarkSearchIndex::fold(const char* text, std::string* folded, bool* endsWithSeparator)
+{
+    folded->clear();
+    bool separated = false;
+
+    const unsigned char* bytes = (const unsigned char*)text;
+    while (*bytes)
+    {
+        unsigned int character;
+        unsigned int length = decodeUTF8(bytes, &character);
+
+        // Bytes which aren't valid UTF-8 separate words, so that they can't run into the letters around them.
+        const char* letters = NULL;
+        char buffer[5] = { 0, 0, 0, 0, 0 };
+        bool isSeparator = false;
+
+        if (length == 0)
+        {
+            length = 1;
+            isSeparator = true;
+        }
+        else if (character < 0x80)
+        {
+            if (character == '\'')
+            {
+                // Apostrophes are dropped, so that "Macy's" matches "macys".
+            }
+            else if ((character >= 'a' && character <= 'z') || (character >= '0' && character <= '9'))
+            {
+                buffer[0] = character;
+                letters = buffer;
+            }
+            else if (character >= 'A' && character <= 'Z')
+            {
+                buffer[0] = character - 'A' + 'a';
+                letters = buffer;
+            }
+            else
+            {
+                isSeparator = true;
+            }
+        }
+        else if (character >= 0xC0 && character <= 0xFF)
+        {
+            letters = LATIN_1_FOLDS[character - 0xC0];
+            isSeparator = (letters == NULL);
+        }
+        else if (character >= 0x100 && character <= 0x17F)
+        {
+            char letter = LATIN_EXTENDED_A_FOLDS[character - 0x100];
+            buffer[0] = (letter == '1') ? 'i' : (letter == '2') ? 'o' : letter;
+            buffer[1] = (letter == '1') ? 'j' : (letter == '2') ? 'e' : '\0';
+            letters = buffer;
+        }
+        else if (character == 0x2018 || character == 0x2019)
+        {
+            // Typographic apostrophes are dropped as well.
+        }
+        else if (character < 0xC0 || (character >= 0x2000 && character <= 0x206F) || character == 0x3000)
+        {
+            // The rest of Latin-1 is punctuation and symbols, like General Punctuation.
+            isSeparator = true;
+        }
+        else
+        {
+            // Letters from other scripts are kept as they are.
+            memcpy(buffer, bytes, length);
+            letters = buffer;
+        }
+
+        if (letters)
+        {
+            if (separated && !folded->empty())
+            {
+                *folded += ' ';
+            }
+            *folded += letters;
+            separated = false;
+        }
+        else if (isSeparator)
+        {
+            separated = true;
+        }
+
+        bytes += length;
+    }
+
+    if (endsWithSeparator)
+    {
+        *endsWithSeparator = separated && !folded->empty();
+    }
+}
+
+// Walk down the trie along a folded prefix.
+
+int LandmarkSearchIndex::findNode(const std::string& prefix) const
+{
+    unsigned int node = 0;
+    unsigned int position = 0;
+
+    while (position < prefix.size())
+    {
+        const unsigned int* fields = m_Nodes + node * NODE_FIELD_COUNT;
+        unsigned int childCount = fields[1] >> 16;
+        unsigned int firstChild = fields[2];
+        if (firstChild > m_NodeCount || childCount > m_NodeCount - firstChild)
+        {
+            return -1;
+        }
+
+        // The children are ordered by the first byte of their labels, which are all different.
+        unsigned char next = prefix[position];
+        unsigned int low = firstChild;
+        unsigned int high = firstChild + childCount;
+        const unsigned char* label = NULL;
+        unsigned int labelLength = 0;
+
+        while (low < high)
+        {
+            unsigned int middle = (low + high) / 2;
+            label = getLabel(middle, &labelLength);
+            if (!label || labelLength == 0)
+            {
+                return -1;
+            }
+
+            if (label[0] < next)
+            {
+                low = middle + 1;
+            }
+            else if (label[0] > next)
+            {
+                high = middle;
+            }
+            else
+            {
+                low = middle;
+                break;
+            }
+        }
+
+        if (low >= high)
+        {
+            return -1;
+        }
+
+        // The prefix may end part of the way along the child's label.
+        unsigned int compareLength = std::min(labelLength, (unsigned int)prefix.size() - position);
+        if (memcmp(label, prefix.data() + position, compareLength) != 0)
+        {
+            return -1;
+        }
+
+        position += compareLength;
+        node = low;
+    }
+
+    return node;
+}
+
+// Find a word in the inverted index with a binary search.
+
+unsigned int LandmarkSearchIndex::findWord(const char* word) const
+{
+    unsigned int low = 0;
+    unsigned int high = m_WordCount;
+
+    while (low < high)
+    {
+        unsigned int middle = (low + high) / 2;
+        const char* wordString = getWordString(middle);
+        if (!wordString || strcmp(wordString, word) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// Get a word's string from the string table.
+
+const char* LandmarkSearchIndex::getWordString(unsigned int word) const
+{
+    unsigned int offset = m_Words[word * WORD_FIELD_COUNT];
+    return (offset < m_StringsSize) ? m_Strings + offset : NULL;
+}
+
+// Start reading the postings of a word.
+
+bool LandmarkSearchIndex::getPostings(unsigned int word, PostingCursor* cursor) const
+{
+    unsigned int firstSkip = m_Words[word * WORD_FIELD_COUNT + 1];
+    unsigned int postingCount = m_Words[word * WORD_FIELD_COUNT + 2];
+    unsigned int blockCount = postingCount / POSTING_BLOCK_SIZE + (postingCount % POSTING_BLOCK_SIZE != 0);
+    if (firstSkip > m_SkipCount || blockCount > m_SkipCount - firstSkip)
+    {
+        return false;
+    }
+
+    cursor->skips = m_Skips + firstSkip * SKIP_FIELD_COUNT;
+    cursor->count = postingCount;
+    cursor->postings = m_Postings;
+    cursor->postingsEnd = m_Postings + m_PostingsSize;
+    startBlock(cursor, 0);
+    return true;
+}
+
+// Get the label leading to a node of the trie.
+
+const unsigned char* LandmarkSearchIndex::getLabel(unsigned int node, unsigned int* length) const
+{
+    unsigned int offset = m_Nodes[node * NODE_FIELD_COUNT];
+    *length = m_Nodes[node * NODE_FIELD_COUNT + 1] & 0xFF;
+    return (offset <= m_LabelsSize && *length <= m_LabelsSize - offset) ? m_Labels + offset : NULL;
+}
@@ -0,0 +1,219 @@
+//
+//  LandmarkSearchIndex.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_SEARCH_INDEX_H
+#define LANDMARK_SEARCH_INDEX_H
+
+#include <string>
+#include <vector>
+#include "LandmarkStore.h"
+
+struct PostingCursor;
+
+/**
+ @brief     An index for searching the landmarks by name and description, as written by LandmarkSearchIndexWriter (ie. "landmarks.nyls" built by Tools/LandmarkSearchIndexBuilder.cpp), memory-mapped and read in place.
+
+ Text is folded before it is indexed or searched for: letters are lowercased, accents are dropped (so "Café" matches "cafe"), apostrophes are removed and any other punctuation separates words. The index holds two structures:
+
+ - A radix trie of every name, starting from each of its words (so "bri" finds "Brooklyn Bridge" as well as "Bridge Café"). Each node stores the best few landmarks found below it, ranked by whether the match starts the name and then by the length of the name, so a prefix is answered by walking down the trie without visiting the names beneath it.
+ - An inverted index mapping every word in the names and descriptions to the landmarks it appears in, used to find landmarks whose words match the query in any order.
+
+ All values are little-endian, and every section starts on a 4-byte boundary:
+
+     char[4]    "NYLS"
+     uint16     Format version (3)
+     uint16     Reserved
+     uint32     Landmark count
+     uint32     Node count, and the offset of the nodes from the start of the file
+     uint32     Hit count, and the offset of the hits
+     uint32     Size of the labels in bytes, and their offset
+     uint32     Word count, and the offset of the words
+     uint32     Skip count, and the offset of the skips
+     uint32     Size of the postings in bytes, and their offset
+     uint32     Size of the string table in bytes, and its offset
+     uint32     Size of the whole file in bytes
+     uint32     Checksum of the catalog the index was built from (see LandmarkCatalog::getChecksum), or 0 if it wasn't built from one
+
+ followed by the trie's nodes, the first being the root. The children of each node are stored next to each other, in order of the first byte of their labels:
+
+     uint32     The offset of the label leading to the node in the labels
+     uint32     The length of the label (low 8 bits), the number of hits (next 8 bits) and the number of children (high 16 bits)
+     uint32     The index of the first child
+     uint32     The index of the node's first hit
+
+ then the hits, which are the IDs of the best landmarks below each node in ranked order:
+
+     uint32     A landmark ID
+
+ then the labels, which hold the bytes of the folded names split up between the nodes, then the words in sorted order:
+
+     uint32     The offset of the word in the string table
+     uint32     The index of the word's first skip
+     uint32     The number of postings
+
+ Each word's postings list its landmarks in order of ID. A posting is the landmark's ID shifted up by one bit, with the low bit set if the word is in the landmark's name. They are split into blocks of POSTING_BLOCK_SIZE, and each block has a skip, so that a search can jump to the block holding a landmark without decoding the ones before it:
+
+     uint32     The block's first posting
+     uint32     The offset in the postings of the rest of the block
+
+ then the postings, which hold the rest of each block as the differences from the posting before, in 7-bit groups with the high bit set on every group but the last (so most take a single byte), and finally the string table, which holds every word with a terminating zero byte.
+
+ The landmark IDs are the order in which the landmarks were added to the LandmarkStore, which is the order of the catalog the index was built from. Opening an index only checks its header; anything read from the sections is checked as it is used.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class LandmarkSearchIndex
+{
+public:
+
+    /** The most landmarks stored for each node of the trie, and so the most name matches a search can return. */
+    static const unsigned int MAX_NODE_HITS = 8;
+
+    /** The longest key in the trie. Names are only matched by this many bytes from the start of each word, so a longer query is looked up by its first this many bytes. */
+    static const unsigned int MAX_KEY_LENGTH = 64;
+
+    /** The number of postings in each block of a word's postings. */
+    static const unsigned int POSTING_BLOCK_SIZE = 32;
+
+    /**
+     @brief     Get the index shared by the map and the search popup.
+     @return    A pointer to the shared index.
+     */
+    static LandmarkSearchIndex* sharedIndex();
+
+    /**
+     @brief     Default constructor. The index is empty until it is opened.
+     */
+    LandmarkSearchIndex();
+
+    /**
+     @brief     Destructor. Unmaps the file.
+     */
+    ~LandmarkSearchIndex();
+
+    /**
+     @brief     Map an index file, closing any index which was already open.
+     @param     path    The full path of the file.
+     @return    Whether or not the file was a valid index. If not, the index is left empty.
+     */
+    bool open(const char* path);
+
+    /**
+     @brief     Take over an index which was written in memory, closing any index which was already open.
+     @param     data    The index's bytes, which are swapped out of the vector so that they aren't copied.
+     @return    Whether or not the data was a valid index. If not, the index is left empty.
+     */
+    bool load(std::vector<unsigned char>* data);
+
+    /**
+     @brief     Unmap the index file or free its data, leaving the index empty.
+     */
+    void close();
+
+    /**
+     @brief     Get the number of landmarks the index was built for, ie. to check that it matches the LandmarkStore.
+     */
+    unsigned int getCount() const { return m_Count; }
+
+    /**
+     @brief     Get the checksum of the catalog the index was built from, ie. to check that it matches the catalog the LandmarkStore has open. A matching count alone doesn't show that the catalog hasn't changed.
+     @return    The checksum, or 0 if the index wasn't built from a catalog.
+     */
+    unsigned int getCatalogChecksum() const { return m_CatalogChecksum; }
+
+    /**
+     @brief     Find the landmarks best matching a query. Names containing the query from the start of one of their words come first, with the names which start with it ahead of the rest and shorter names ahead of longer ones (so a name typed in full comes before any other), followed by landmarks whose names or descriptions contain every word of the query. The last word may be incomplete unless the query ends with a space.
+     @param     query       The text to search for, in UTF-8.
+     @param     results     The array to fill with the IDs of the matching landmarks, best first.
+     @param     maxResults  The size of the array.
+     @return    The number of results.
+     */
+    unsigned int search(const char* query, LandmarkID* results, unsigned int maxResults) const;
+
+    /**
+     @brief     Fold text for indexing or searching: lowercase it, drop accents and apostrophes, and separate its words with single spaces.
+     @param     text                The text, in UTF-8.
+     @param     folded              The string to store the folded text in.
+     @param     endsWithSeparator   If not NULL, set to whether or not the text ended with a separator after its last word (ie. the last word is complete).
+     */
+    static void fold(const char* text, std::string* folded, bool* endsWithSeparator);
+
+private:
+
+    /**
+     @brief     Declared as private because an index owns its mapping and can't be copied.
+     */
+    LandmarkSearchIndex(const LandmarkSearchIndex&);
+    LandmarkSearchIndex& operator=(const LandmarkSearchIndex&);
+
+    /**
+     @brief     Check the header of the mapped file or loaded data and find each of its sections.
+     @return    Whether or not the header was valid.
+     */
+    bool readHeader(const unsigned char* bytes, unsigned long size);
+
+    /**
+     @brief     Walk down the trie along a folded prefix.
+     @param     prefix  The folded prefix.
+     @return    The index of the node which the prefix ends in (or on the way to), or -1 if no name starts with the prefix.
+     */
+    int findNode(const std::string& prefix) const;
+
+    /**
+     @brief     Find a word in the inverted index with a binary search.
+     @param     word    The folded word.
+     @return    The index of the first word which isn't ordered before it.
+     */
+    unsigned int findWord(const char* word) const;
+
+    /**
+     @brief     Get a word's string from the string table, or NULL for an offset outside of the table.
+     */
+    const char* getWordString(unsigned int word) const;
+
+    /**
+     @brief     Start reading the postings of a word.
+     @param     word    The word's index.
+     @param     cursor  Set to the word's first posting.
+     @return    Whether or not the word's skips lie inside the index.
+     */
+    bool getPostings(unsigned int word, PostingCursor* cursor) const;
+
+    /**
+     @brief     Get the label leading to a node of the trie.
+     @param     node    The node's index.
+     @param     length  Set to the length of the label.
+     @return    A pointer to the label's bytes, or NULL if they don't lie inside the index.
+     */
+    const unsigned char* getLabel(unsigned int node, unsigned int* length) const;
+
+    /** The mapped file and its size in bytes, or the data which was loaded. */
+    void* m_Mapping;
+    unsigned long m_MappingSize;
+    std::vector<unsigned char> m_Data;
+
+    /** The number of landmarks and the checksum of the catalog they came from, and the size and location of each section. */
+    unsigned int m_Count;
+    unsigned int m_CatalogChecksum;
+    unsigned int m_NodeCount;
+    const unsigned int* m_Nodes;
+    unsigned int m_HitCount;
+    const unsigned int* m_Hits;
+    unsigned int m_LabelsSize;
+    const unsigned char* m_Labels;
+    unsigned int m_WordCount;
+    const unsigned int* m_Words;
+    unsigned int m_SkipCount;
+    const unsigned int* m_Skips;
+    unsigned int m_PostingsSize;
+    const unsigned char* m_Postings;
+    unsigned int m_StringsSize;
+    const char* m_Strings;
+};
+
+#endif // LANDMARK_SEARCH_INDEX_H
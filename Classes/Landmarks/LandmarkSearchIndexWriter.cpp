@@ -0,0 +1,470 @@
+//
+//  LandmarkSearchIndexWriter.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkSearchIndexWriter.h"
+#include "LandmarkSearchIndex.h"
+#include <algorithm>
+
+// These values must match the format described in LandmarkSearchIndex.h.
+static const char* FILE_MAGIC = "NYLS";
+static const unsigned int FILE_VERSION = 3;
+static const unsigned int HEADER_SIZE = 76;
+
+// The number of slots the word table starts with.
+static const unsigned int INITIAL_WORD_SLOT_COUNT = 1024;
+
+// Append a little-endian value to the output.
+
+static void writeUInt32(std::vector<unsigned char>& output, unsigned int value)
+{
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        output.push_back((value >> (i * 8)) & 0xFF);
+    }
+}
+
+// Overwrite a little-endian value which was written earlier.
+
+static void patchUInt32(std::vector<unsigned char>& output, unsigned int offset, unsigned int value)
+{
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        output[offset + i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+// Pad the output with zeros up to a 4-byte boundary.
+
+static void align(std::vector<unsigned char>& output)
+{
+    while (output.size() % 4 != 0)
+    {
+        output.push_back(0);
+    }
+}
+
+// Split folded text into its words.
+
+static void splitWords(const std::string& folded, std::vector<std::string>* words)
+{
+    words->clear();
+    for (size_t start = 0; start < folded.size(); )
+    {
+        size_t end = folded.find(' ', start);
+        if (end == std::string::npos)
+        {
+            end = folded.size();
+        }
+        words->push_back(folded.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+// Append a value in 7-bit groups, lowest first, with the high bit set on every group but the last.
+
+static void writeVarUInt(std::vector<unsigned char>& output, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        output.push_back((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    output.push_back(value);
+}
+
+// Hash a word for the word table (FNV-1a).
+
+static unsigned int hashWord(const std::string& word)
+{
+    unsigned int hash = 2166136261u;
+    for (unsigned int i = 0; i < word.size(); i++)
+    {
+        hash = (hash ^ (unsigned char)word[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Get the length of the text shared by the start of two strings.
+
+static unsigned int getCommonPrefixLength(const std::string& a, const std::string& b)
+{
+    unsigned int length = 0;
+    while (length < a.size() && length < b.size() && a[length] == b[length])
+    {
+        length++;
+    }
+    return length;
+}
+
+// Default constructor.
+
+LandmarkSearchIndexWriter::LandmarkSearchIndexWriter()
+: m_Count(0)
+, m_CatalogChecksum(0)
+{
+}
+
+// Add the next landmark.
+
+void LandmarkSearchIndexWriter::add(const char* name, const char* description)
+{
+    unsigned int landmark = m_Count++;
+    std::vector<std::string> words;
+
+    // Add the name to the trie from the start of each of its words.
+    std::string folded;
+    LandmarkSearchIndex::fold(name ? name : "", &folded, NULL);
+
+    size_t start = 0;
+    while (start < folded.size())
+    {
+        NameKey key;
+        key.text = folded.substr(start, LandmarkSearchIndex::MAX_KEY_LENGTH);
+        key.landmark = landmark;
+        key.isWholeName = (start == 0);
+        key.nameLength = folded.size();
+        m_NameKeys.push_back(key);
+
+        size_t space = folded.find(' ', start);
+        start = (space != std::string::npos) ? space + 1 : folded.size();
+    }
+
+    // Add every word of the name and the description to the inverted index.
+    splitWords(folded, &words);
+    for (unsigned int i = 0; i < words.size(); i++)
+    {
+        addPosting(words[i], true);
+    }
+
+    LandmarkSearchIndex::fold(description ? description : "", &folded, NULL);
+    splitWords(folded, &words);
+    for (unsigned int i = 0; i < words.size(); i++)
+    {
+        addPosting(words[i], false);
+    }
+}
+
+// Add a word to the inverted index, for the most recently added landmark.
+
+void LandmarkSearchIndexWriter::addPosting(const std::string& word, bool inName)
+{
+    std::vector<unsigned int>& postings = m_Postings[findWord(word)];
+    unsigned int landmark = m_Count - 1;
+
+    // A word which appears more than once in a landmark only has one posting, marked if any of them is in the name.
+    if (!postings.empty() && (postings.back() >> 1) == landmark)
+    {
+        postings.back() |= (inName ? 1 : 0);
+    }
+    else
+    {
+        postings.push_back((landmark << 1) | (inName ? 1 : 0));
+    }
+}
+
+// Find a word's index in the inverted index, adding the word if it's new.
+
+unsigned int LandmarkSearchIndexWriter::findWord(const std::string& word)
+{
+    // Double the table once it is half full, putting every word back in.
+    if (m_WordSlots.size() < (m_Words.size() + 1) * 2)
+    {
+        m_WordSlots.assign(std::max(INITIAL_WORD_SLOT_COUNT, (unsigned int)m_WordSlots.size() * 2), 0);
+        for (unsigned int i = 0; i < m_Words.size(); i++)
+        {
+            unsigned int slot = hashWord(m_Words[i]) & (m_WordSlots.size() - 1);
+            while (m_WordSlots[slot] != 0)
+            {
+                slot = (slot + 1) & (m_WordSlots.size() - 1);
+            }
+            m_WordSlots[slot] = i + 1;
+        }
+    }
+
+    // Probe from the word's slot until it or an empty slot turns up.
+    unsigned int slot = hashWord(word) & (m_WordSlots.size() - 1);
+    while (m_WordSlots[slot] != 0)
+    {
+        if (m_Words[m_WordSlots[slot] - 1] == word)
+        {
+            return m_WordSlots[slot] - 1;
+        }
+        slot = (slot + 1) & (m_WordSlots.size() - 1);
+    }
+
+    m_WordSlots[slot] = m_Words.size() + 1;
+    m_Words.push_back(word);
+    m_Postings.push_back(std::vector<unsigned int>());
+    return m_Words.size() - 1;
+}
+
+/**
+ @brief     Orders the indices of words by their text.
+ */
+struct WordIndexOrder
+{
+    WordIndexOrder(const std::vector<std::string>& words) : words(words) { }
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return words[a] < words[b];
+    }
+
+    const std::vector<std::string>& words;
+};
+
+/**
+ @brief     Orders keys by rank: whole names first, then shorter names, then lower IDs.
+ */
+struct NameKeyRank
+{
+    template <typename Key>
+    bool operator()(const Key& a, const Key& b) const
+    {
+        if (a.isWholeName != b.isWholeName) return a.isWholeName;
+        if (a.nameLength != b.nameLength) return a.nameLength < b.nameLength;
+        return a.landmark < b.landmark;
+    }
+};
+
+/**
+ @brief     Orders keys by their text, and keys with the same text by rank.
+ */
+struct NameKeyOrder
+{
+    template <typename Key>
+    bool operator()(const Key& a, const Key& b) const
+    {
+        int comparison = a.text.compare(b.text);
+        return (comparison != 0) ? (comparison < 0) : NameKeyRank()(a, b);
+    }
+};
+
+/**
+ @brief     Orders the indices of keys by the rank of the keys.
+ */
+template <typename Key>
+struct NameKeyIndexRank
+{
+    NameKeyIndexRank(const std::vector<Key>& keys) : keys(keys) { }
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return NameKeyRank()(keys[a], keys[b]);
+    }
+
+    const std::vector<Key>& keys;
+};
+
+// Put together the node of the trie for a range of the sorted keys, and the nodes below it.
+
+unsigned int LandmarkSearchIndexWriter::buildNode(const std::vector<NameKey>& keys, unsigned int begin, unsigned int end,
+                                                  unsigned int labelStart, unsigned int labelEnd, std::vector<BuildNode>* nodes)
+{
+    BuildNode node;
+    node.key = begin;
+    node.labelStart = labelStart;
+    node.labelEnd = labelEnd;
+
+    // Keys which end at this node sort ahead of the longer keys sharing their text, and rank here directly.
+    std::vector<unsigned int> candidates;
+    unsigned int next = begin;
+    while (next < end && keys[next].text.size() == labelEnd)
+    {
+        candidates.push_back(next++);
+    }
+
+    // Group the rest of the keys by the byte after the label, giving each group a child whose label runs as far as the group's keys share their text.
+    while (next < end)
+    {
+        unsigned char byte = keys[next].text[labelEnd];
+        unsigned int groupEnd = next + 1;
+        while (groupEnd < end && (unsigned char)keys[groupEnd].text[labelEnd] == byte)
+        {
+            groupEnd++;
+        }
+
+        unsigned int childLabelEnd = getCommonPrefixLength(keys[next].text, keys[groupEnd - 1].text);
+        unsigned int child = buildNode(keys, next, groupEnd, labelEnd, childLabelEnd, nodes);
+        node.children.push_back(child);
+
+        const std::vector<unsigned int>& childHits = (*nodes)[child].hits;
+        candidates.insert(candidates.end(), childHits.begin(), childHits.end());
+        next = groupEnd;
+    }
+
+    // Keep the best keys below the node, one per landmark.
+    std::sort(candidates.begin(), candidates.end(), NameKeyIndexRank<NameKey>(keys));
+    for (unsigned int i = 0; i < candidates.size() && node.hits.size() < LandmarkSearchIndex::MAX_NODE_HITS; i++)
+    {
+        bool found = false;
+        for (unsigned int j = 0; j < node.hits.size() && !found; j++)
+        {
+            found = (keys[node.hits[j]].landmark == keys[candidates[i]].landmark);
+        }
+
+        if (!found)
+        {
+            node.hits.push_back(candidates[i]);
+        }
+    }
+
+    nodes->push_back(node);
+    return nodes->size() - 1;
+}
+
+// Write the index.
+
+void LandmarkSearchIndexWriter::write(std::vector<unsigned char>* output) const
+{
+    // Sort the keys so that each node of the trie covers a range of them, then put the trie together from an empty root.
+    std::vector<NameKey> keys(m_NameKeys);
+    std::sort(keys.begin(), keys.end(), NameKeyOrder());
+
+    std::vector<BuildNode> nodes;
+    unsigned int root = buildNode(keys, 0, keys.size(), 0, 0, &nodes);
+
+    // Lay the nodes out breadth first, so that the children of each node are next to each other.
+    std::vector<unsigned int> nodeFields;
+    std::vector<unsigned int> hits;
+    std::vector<unsigned char> labels;
+    std::vector<unsigned int> queue(1, root);
+
+    for (unsigned int i = 0; i < queue.size(); i++)
+    {
+        const BuildNode& node = nodes[queue[i]];
+
+        nodeFields.push_back(labels.size());
+        nodeFields.push_back((node.labelEnd - node.labelStart) | (node.hits.size() << 8) | (node.children.size() << 16));
+        nodeFields.push_back(queue.size());
+        nodeFields.push_back(hits.size());
+
+        if (node.labelEnd > node.labelStart)
+        {
+            const std::string& text = keys[node.key].text;
+            labels.insert(labels.end(), text.begin() + node.labelStart, text.begin() + node.labelEnd);
+        }
+        queue.insert(queue.end(), node.children.begin(), node.children.end());
+        for (unsigned int j = 0; j < node.hits.size(); j++)
+        {
+            hits.push_back(keys[node.hits[j]].landmark);
+        }
+    }
+
+    // Sort the words, and split each one's postings into blocks with a skip to the start of each.
+    std::vector<unsigned int> order(m_Words.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), WordIndexOrder(m_Words));
+
+    std::vector<unsigned int> wordFields;
+    std::vector<unsigned int> skips;
+    std::vector<unsigned char> postings;
+    std::vector<char> strings;
+
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        const std::string& word = m_Words[order[i]];
+        const std::vector<unsigned int>& wordPostings = m_Postings[order[i]];
+        wordFields.push_back(strings.size());
+        wordFields.push_back(skips.size() / 2);
+        wordFields.push_back(wordPostings.size());
+
+        strings.insert(strings.end(), word.begin(), word.end());
+        strings.push_back('\0');
+        for (unsigned int j = 0; j < wordPostings.size(); j++)
+        {
+            if (j % LandmarkSearchIndex::POSTING_BLOCK_SIZE == 0)
+            {
+                skips.push_back(wordPostings[j]);
+                skips.push_back(postings.size());
+            }
+            else
+            {
+                writeVarUInt(postings, wordPostings[j] - wordPostings[j - 1]);
+            }
+        }
+    }
+
+    // An empty table would have no terminating zero for LandmarkSearchIndex to check.
+    if (strings.empty())
+    {
+        strings.push_back('\0');
+    }
+
+    // Write the header, leaving the offsets to be filled in once the sections are in place.
+    output->clear();
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        output->push_back(FILE_MAGIC[i]);
+    }
+    output->push_back(FILE_VERSION);
+    output->push_back(0);
+    output->push_back(0);
+    output->push_back(0);
+    writeUInt32(*output, m_Count);
+    while (output->size() < HEADER_SIZE)
+    {
+        output->push_back(0);
+    }
+
+    unsigned int nodesOffset = output->size();
+    for (unsigned int i = 0; i < nodeFields.size(); i++)
+    {
+        writeUInt32(*output, nodeFields[i]);
+    }
+
+    unsigned int hitsOffset = output->size();
+    for (unsigned int i = 0; i < hits.size(); i++)
+    {
+        writeUInt32(*output, hits[i]);
+    }
+
+    unsigned int labelsOffset = output->size();
+    output->insert(output->end(), labels.begin(), labels.end());
+    align(*output);
+
+    unsigned int wordsOffset = output->size();
+    for (unsigned int i = 0; i < wordFields.size(); i++)
+    {
+        writeUInt32(*output, wordFields[i]);
+    }
+
+    unsigned int skipsOffset = output->size();
+    for (unsigned int i = 0; i < skips.size(); i++)
+    {
+        writeUInt32(*output, skips[i]);
+    }
+
+    unsigned int postingsOffset = output->size();
+    output->insert(output->end(), postings.begin(), postings.end());
+    align(*output);
+
+    unsigned int stringsOffset = output->size();
+    output->insert(output->end(), strings.begin(), strings.end());
+    align(*output);
+
+    patchUInt32(*output, 12, queue.size());
+    patchUInt32(*output, 16, nodesOffset);
+    patchUInt32(*output, 20, hits.size());
+    patchUInt32(*output, 24, hitsOffset);
+    patchUInt32(*output, 28, labels.size());
+    patchUInt32(*output, 32, labelsOffset);
+    patchUInt32(*output, 36, m_Words.size());
+    patchUInt32(*output, 40, wordsOffset);
+    patchUInt32(*output, 44, skips.size() / 2);
+    patchUInt32(*output, 48, skipsOffset);
+    patchUInt32(*output, 52, postings.size());
+    patchUInt32(*output, 56, postingsOffset);
+    patchUInt32(*output, 60, strings.size());
+    patchUInt32(*output, 64, stringsOffset);
+    patchUInt32(*output, 68, output->size());
+    patchUInt32(*output, 72, m_CatalogChecksum);
+}
@@ -0,0 +1,134 @@
+//
+//  LandmarkSearchIndexWriter.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_SEARCH_INDEX_WRITER_H
+#define LANDMARK_SEARCH_INDEX_WRITER_H
+
+#include <string>
+#include <vector>
+
+/**
+ @brief     Builds the search index read by LandmarkSearchIndex, either offline (see Tools/LandmarkSearchIndexBuilder.cpp) or on the device for landmarks which didn't come with one.
+
+ Landmarks are added in order of ID, and their names and descriptions are folded and indexed as they are added. The trie and its ranked hits are only put together when the index is written.
+
+ This class has no dependencies on cocos2d so that it can be built into the command-line tools.
+ */
+class LandmarkSearchIndexWriter
+{
+public:
+
+    /**
+     @brief     Default constructor. The index is empty.
+     */
+    LandmarkSearchIndexWriter();
+
+    /**
+     @brief     Add the next landmark, whose ID is the number of landmarks added before it.
+     @param     name            The landmark's name, in UTF-8.
+     @param     description     The landmark's description, in UTF-8, or NULL for none.
+     */
+    void add(const char* name, const char* description);
+
+    /**
+     @brief     Get the number of landmarks which have been added.
+     */
+    unsigned int getCount() const { return m_Count; }
+
+    /**
+     @brief     Set the checksum of the catalog the landmarks were added from, which is written into the index so that it can be checked against the catalog it is used with.
+     @param     checksum    The catalog's checksum (see LandmarkCatalog::getChecksum), or 0 if the landmarks didn't come from a catalog.
+     */
+    void setCatalogChecksum(unsigned int checksum) { m_CatalogChecksum = checksum; }
+
+    /**
+     @brief     Write the index in the format described in LandmarkSearchIndex.h.
+     @param     output  The vector to store the index's bytes in.
+     */
+    void write(std::vector<unsigned char>* output) const;
+
+private:
+
+    /**
+     @brief     A name, or the rest of a name from the start of one of its words, which leads to a landmark in the trie.
+     */
+    struct NameKey
+    {
+        /** The folded text of the key. */
+        std::string text;
+
+        /** The ID of the landmark whose name it's from. */
+        unsigned int landmark;
+
+        /** Whether or not the key is the whole name, which ranks it ahead of keys starting later in a name. */
+        bool isWholeName;
+
+        /** The length of the whole folded name, since shorter names are ranked first. */
+        unsigned int nameLength;
+    };
+
+    /**
+     @brief     A node of the trie while it is being put together.
+     */
+    struct BuildNode
+    {
+        /** The label leading to the node, as a range of one of the keys' text. */
+        unsigned int key;
+        unsigned int labelStart;
+        unsigned int labelEnd;
+
+        /** The nodes below this one, in order of their labels' first bytes. */
+        std::vector<unsigned int> children;
+
+        /** The best keys in or below the node, as indices into the keys, in ranked order with one per landmark. */
+        std::vector<unsigned int> hits;
+    };
+
+    /**
+     @brief     Put together the node of the trie for a range of the sorted keys, and the nodes below it.
+     @param     keys        The keys, sorted by their text and then by rank.
+     @param     begin       The first key in the range.
+     @param     end         Just past the last key in the range.
+     @param     labelStart  The length of the text on the path down to the node's parent.
+     @param     labelEnd    The length of the text on the path down to the node, which every key in the range shares.
+     @param     nodes       The nodes built so far, which the new nodes are added to.
+     @return    The index of the node.
+     */
+    static unsigned int buildNode(const std::vector<NameKey>& keys, unsigned int begin, unsigned int end,
+                                  unsigned int labelStart, unsigned int labelEnd, std::vector<BuildNode>* nodes);
+
+    /**
+     @brief     Add a word to the inverted index, for the most recently added landmark.
+     @param     word    The folded word.
+     @param     inName  Whether or not the word is in the landmark's name.
+     */
+    void addPosting(const std::string& word, bool inName);
+
+    /**
+     @brief     Find a word's index in the inverted index, adding the word if it's new.
+     @param     word    The folded word.
+     @return    The word's index into m_Words and m_Postings.
+     */
+    unsigned int findWord(const std::string& word);
+
+    /** The keys which lead to each landmark in the trie. */
+    std::vector<NameKey> m_NameKeys;
+
+    /** Every word in the order it was first added, and its postings in order of landmark ID (see LandmarkSearchIndex.h). */
+    std::vector<std::string> m_Words;
+    std::vector<std::vector<unsigned int> > m_Postings;
+
+    /** A hash table of the words' indices plus one, with zero for an empty slot. Its size is a power of two, kept at least twice the number of words. */
+    std::vector<unsigned int> m_WordSlots;
+
+    /** The number of landmarks which have been added, and the checksum of the catalog they came from. */
+    unsigned int m_Count;
+    unsigned int m_CatalogChecksum;
+};
+
+#endif // LANDMARK_SEARCH_INDEX_WRITER_H
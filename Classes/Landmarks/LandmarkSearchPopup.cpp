@@ -0,0 +1,278 @@
+//
+//  LandmarkSearchPopup.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkSearchPopup.h"
+#include "Defines.h"
+#include "LandmarkSearchIndex.h"
+#include <algorithm>
+#include <string>
+
+#define COLOUR_BUTTON_NORMAL    ccc3(0, 150, 141)
+#define COLOUR_BUTTON_CLOSE     ccc3(0, 92, 115)
+
+using namespace cocos2d;
+
+// The scale of the result buttons compared to the popup's usual buttons, so that a full list fits above the close button.
+static const float RESULT_BUTTON_SCALE = 0.75f;
+
+// Create a search popup and add it to the current scene.
+
+LandmarkSearchPopup* LandmarkSearchPopup::showPopup(LandmarkSearchObserver* observer)
+{
+    LandmarkSearchPopup* popup = create(observer);
+
+    if (popup)
+    {
+        CCDirector::sharedDirector()->getRunningScene()->addChild(popup);
+        return popup;
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+// Create a search popup.
+
+LandmarkSearchPopup* LandmarkSearchPopup::create(LandmarkSearchObserver* observer)
+{
+    LandmarkSearchPopup *popup = new LandmarkSearchPopup();
+    if (popup && popup->init(observer))
+    {
+        popup->autorelease();
+        return popup;
+    }
+    CC_SAFE_DELETE(popup);
+    return NULL;
+}
+
+// Initialize this LandmarkSearchPopup with its text field and result buttons.
+
+bool LandmarkSearchPopup::init(LandmarkSearchObserver* observer)
+{
+    if (!Popup::init())
+    {
+        return false;
+    }
+
+    m_Observer = observer;
+    m_ResultCount = 0;
+    m_HasAddressResult = false;
+    m_QueryChanged = false;
+
+    // Add the text field at the top of the screen.
+    m_TextField = CCTextFieldTTF::textFieldWithPlaceHolder("Search landmarks or addresses", "Montserrat", 100 * SCREEN_SCALE);
+    if (!m_TextField)
+    {
+        return false;
+    }
+    m_TextField->setDelegate(this);
+    m_TextField->setPosition(ccp(WIN_SIZE.width/2, WIN_SIZE.height - 200 * SCREEN_SCALE));
+    addChild(m_TextField);
+
+    // Add a button for each row of results below the field. They are made once and hidden until there are results to list.
+    float rowY = m_TextField->getPositionY() - 100 * SCREEN_SCALE;
+    for (unsigned int i = 0; i < MAX_RESULTS; i++)
+    {
+        Button* button = Button::create("buttonNormal.png", "buttonPressed.png", NULL,
+                                        CCCallFuncO::create(this, callfuncO_selector(LandmarkSearchPopup::resultPressed), CCInteger::create(i)));
+        button->setColor(COLOUR_BUTTON_NORMAL);
+        button->setScale(SCREEN_SCALE * RESULT_BUTTON_SCALE / button->getAssetScale());
+
+        CCLabelTTF* label = CCLabelTTF::create("", "Montserrat", 80);
+        label->setScale(button->getAssetScale());
+        label->setPosition(ccp(button->getContentSize().width/2, button->getContentSize().height/2));
+        button->addChild(label);
+
+        float rowHeight = button->getContentSize().height * button->getScaleY();
+        rowY -= rowHeight * 0.6f;
+        button->setPosition(ccp(WIN_SIZE.width/2, rowY));
+        rowY -= rowHeight * 0.6f;
+
+        button->setVisible(false);
+        addChild(button);
+        m_ResultButtons[i] = button;
+        m_ResultLabels[i] = label;
+    }
+
+    // Add a button to close the popup at the bottom of the screen.
+    m_CloseButton = Button::create("buttonNormal.png", "buttonPressed.png", NULL, CCCallFunc::create(this, callfunc_selector(LandmarkSearchPopup::closePopup)));
+    m_CloseButton->setColor(COLOUR_BUTTON_CLOSE);
+    m_CloseButton->setScale(SCREEN_SCALE / m_CloseButton->getAssetScale());
+
+    CCLabelTTF* closeLabel = CCLabelTTF::create("Close", "Montserrat", 100);
+    closeLabel->setScale(m_CloseButton->getAssetScale());
+    closeLabel->setPosition(ccp(m_CloseButton->getContentSize().width/2, m_CloseButton->getContentSize().height/2));
+    m_CloseButton->addChild(closeLabel);
+
+    m_CloseButton->setPosition(ccp(WIN_SIZE.width/2, m_CloseButton->getContentSize().height * m_CloseButton->getScaleY()));
+    addChild(m_CloseButton);
+    m_Buttons.push_back(m_CloseButton);
+
+    // Fade in, then bring up the keyboard so that the user can start typing straight away.
+    const float duration = 0.35f;
+    const float rate = 2.75f;
+
+    GLubyte backdropOpacity = m_Backdrop->getOpacity();
+    fadeInAllDecendants(duration, rate, this);
+    m_Backdrop->stopAllActions();
+    m_Backdrop->setOpacity(0);
+    m_Backdrop->runAction(CCEaseOut::create(CCFadeTo::create(duration, backdropOpacity), rate));
+
+    m_TextField->attachWithIME();
+    scheduleUpdate();
+
+    return true;
+}
+
+// Called when this is removed from the node tree.
+
+void LandmarkSearchPopup::onExit()
+{
+    m_TextField->detachWithIME();
+    Popup::onExit();
+}
+
+// Bring the keyboard back up if the user touches the text field, then pass the touch on to the buttons.
+
+bool LandmarkSearchPopup::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_TextField->boundingBox().containsPoint(convertTouchToNodeSpace(pTouch)))
+    {
+        m_TextField->attachWithIME();
+    }
+
+    return Popup::ccTouchBegan(pTouch, pEvent);
+}
+
+// Note that the query is about to change, or pick the first result when the return key is pressed.
+
+bool LandmarkSearchPopup::onTextFieldInsertText(CCTextFieldTTF* sender, const char* text, int nLen)
+{
+    if (nLen == 1 && text[0] == '\n')
+    {
+        // Letting the line break through puts the keyboard away.
+        if (m_ResultCount > 0 || m_HasAddressResult)
+        {
+            selectResult(0);
+        }
+        return false;
+    }
+
+    m_QueryChanged = true;
+    return false;
+}
+
+// Note that the query is about to change.
+
+bool LandmarkSearchPopup::onTextFieldDeleteBackward(CCTextFieldTTF* sender, const char* delText, int nLen)
+{
+    m_QueryChanged = true;
+    return false;
+}
+
+// Search again if the query has changed since the last frame.
+
+void LandmarkSearchPopup::update(float delta)
+{
+    if (m_QueryChanged)
+    {
+        m_QueryChanged = false;
+        refreshResults();
+    }
+}
+
+// Search for the text field's contents and list the results.
+
+void LandmarkSearchPopup::refreshResults()
+{
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    const char* query = m_TextField->getString();
+    LandmarkID results[MAX_RESULTS];
+    unsigned int resultCount = LandmarkSearchIndex::sharedIndex()->search(query, results, MAX_RESULTS);
+
+    // Only list landmarks which are in the store, in case the index was built for different ones.
+    m_ResultCount = 0;
+    for (unsigned int i = 0; i < resultCount; i++)
+    {
+        if (store->isValid(results[i]))
+        {
+            m_Results[m_ResultCount++] = results[i];
+        }
+    }
+
+    // Geocoding takes microseconds, so it can be done on every keystroke too. A place which is also a landmark (ie. "Times Square") is left to the landmark's own result, unless the landmarks had no results.
+    m_HasAddressResult = query[0] != '\0' && StreetGeocoder(StreetData::sharedData()).geocode(query, &m_AddressResult) &&
+                         (m_AddressResult.segment != StreetAddress::NO_SEGMENT || m_ResultCount == 0);
+    unsigned int firstLandmarkRow = m_HasAddressResult ? 1 : 0;
+    m_ResultCount = std::min(m_ResultCount, MAX_RESULTS - firstLandmarkRow);
+
+    // Show a row for each result, and only offer touches to the buttons which are shown.
+    m_Buttons.clear();
+    for (unsigned int i = 0; i < MAX_RESULTS; i++)
+    {
+        bool isListed = (i < firstLandmarkRow + m_ResultCount);
+        m_ResultButtons[i]->setVisible(isListed);
+        if (!isListed)
+        {
+            continue;
+        }
+
+        if (i < firstLandmarkRow)
+        {
+            std::string address;
+            StreetGeocoder::formatAddress(m_AddressResult, &address);
+            m_ResultLabels[i]->setString(address.c_str());
+        }
+        else
+        {
+            // Names are broken over lines for the landmark's popup, but each result only has room for one.
+            std::string name = store->getName(m_Results[i - firstLandmarkRow]);
+            std::replace(name.begin(), name.end(), '\n', ' ');
+            m_ResultLabels[i]->setString(name.c_str());
+        }
+        m_Buttons.push_back(m_ResultButtons[i]);
+    }
+    m_Buttons.push_back(m_CloseButton);
+}
+
+// Respond to one of the result buttons being pressed.
+
+void LandmarkSearchPopup::resultPressed(CCObject* row)
+{
+    unsigned int index = ((CCInteger*)row)->getValue();
+    if (index < m_ResultCount + (m_HasAddressResult ? 1 : 0))
+    {
+        selectResult(index);
+    }
+}
+
+// Close the popup and tell the observer which landmark or address was picked.
+
+void LandmarkSearchPopup::selectResult(unsigned int row)
+{
+    m_TextField->detachWithIME();
+    closePopup();
+
+    // Only tell the observer once, even if another result is pressed while the popup fades out.
+    LandmarkSearchObserver* observer = m_Observer;
+    m_Observer = NULL;
+    if (!observer)
+    {
+        return;
+    }
+
+    if (m_HasAddressResult && row == 0)
+    {
+        observer->addressSearchResultSelected(m_AddressResult);
+    }
+    else
+    {
+        observer->landmarkSearchResultSelected(m_Results[row - (m_HasAddressResult ? 1 : 0)]);
+    }
+}
@@ -0,0 +1,144 @@
+//
+//  LandmarkSearchPopup.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_SEARCH_POPUP_H
+#define LANDMARK_SEARCH_POPUP_H
+
+#include "Popup.h"
+#include "LandmarkStore.h"
+#include "StreetGeocoder.h"
+
+/**
+ @brief     An interface for responding to the user picking a landmark or an address from the search popup.
+ */
+class LandmarkSearchObserver
+{
+public:
+
+    /**
+     @brief     Called when the user picks one of the search results. The popup closes itself.
+     @param     landmark    The ID of the landmark which was picked.
+     */
+    virtual void landmarkSearchResultSelected(LandmarkID landmark) = 0;
+
+    /**
+     @brief     Called when the user picks the address their query was geocoded to. The popup closes itself.
+     @param     address     The address which was picked, including its location.
+     */
+    virtual void addressSearchResultSelected(const StreetAddress& address) = 0;
+};
+
+/**
+ @brief     A popup with a text field for searching the landmarks by name and description, and for finding addresses. The results are looked up in the shared LandmarkSearchIndex as the user types, and listed as buttons below the field. If the query is also an address, place or intersection in the shared StreetData, it is listed first.
+ */
+class LandmarkSearchPopup : public Popup, public cocos2d::CCTextFieldDelegate
+{
+public:
+
+    /** The most results listed at once. */
+    static const unsigned int MAX_RESULTS = 6;
+
+    /**
+     @brief     Create a search popup and add it to the current scene, bringing up the keyboard.
+     @param     observer    The observer to tell which landmark the user picks.
+     @return    A pointer to the popup that is created.
+     */
+    static LandmarkSearchPopup* showPopup(LandmarkSearchObserver* observer);
+
+    /**
+     @brief     Bring the keyboard back up if the user touches the text field, then pass the touch on to the buttons.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     @return    Always true, in order to block input to elements behind the popup.
+     */
+    bool ccTouchBegan(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Note that the query is about to change, or pick the first result when the return key is pressed.
+     @return    Whether or not to keep the text from being inserted.
+     */
+    bool onTextFieldInsertText(cocos2d::CCTextFieldTTF* sender, const char* text, int nLen);
+
+    /**
+     @brief     Note that the query is about to change.
+     @return    Whether or not to keep the text from being deleted.
+     */
+    bool onTextFieldDeleteBackward(cocos2d::CCTextFieldTTF* sender, const char* delText, int nLen);
+
+protected:
+
+    /**
+     @brief     Create a search popup.
+     @param     observer    The observer to tell which landmark the user picks.
+     @return    A pointer to the popup that is created.
+     */
+    static LandmarkSearchPopup* create(LandmarkSearchObserver* observer);
+
+    /**
+     @brief     Initialize this LandmarkSearchPopup with its text field and result buttons.
+     @param     observer    The observer to tell which landmark the user picks.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(LandmarkSearchObserver* observer);
+
+    /**
+     @brief     Called when this is removed from the node tree. Puts the keyboard away.
+     */
+    virtual void onExit();
+
+    /**
+     @brief     Search again if the query has changed since the last frame. Called once per frame.
+     @param     delta       The time in seconds since the last frame.
+     */
+    virtual void update(float delta);
+
+    /**
+     @brief     Search for the text field's contents and list the results.
+     */
+    void refreshResults();
+
+    /**
+     @brief     Respond to one of the result buttons being pressed.
+     @param     row     The row of the button, as a CCInteger.
+     */
+    void resultPressed(cocos2d::CCObject* row);
+
+    /**
+     @brief     Close the popup and tell the observer which landmark or address was picked.
+     @param     row     The row of the result.
+     */
+    void selectResult(unsigned int row);
+
+private:
+
+    /** The observer to tell which landmark the user picks. */
+    LandmarkSearchObserver* m_Observer;
+
+    /** The field the query is typed into. */
+    cocos2d::CCTextFieldTTF* m_TextField;
+
+    /** The button which closes the popup. */
+    Button* m_CloseButton;
+
+    /** A button and label for each row of results, which are hidden when there are fewer results. */
+    Button* m_ResultButtons[MAX_RESULTS];
+    cocos2d::CCLabelTTF* m_ResultLabels[MAX_RESULTS];
+
+    /** The IDs of the landmarks currently listed. */
+    LandmarkID m_Results[MAX_RESULTS];
+    unsigned int m_ResultCount;
+
+    /** The address the query was geocoded to, and whether it is listed in the first row above the landmarks. */
+    StreetAddress m_AddressResult;
+    bool m_HasAddressResult;
+
+    /** Whether or not the query has changed since the results were listed. The text field asks its delegate before changing, so the search waits for the next frame. */
+    bool m_QueryChanged;
+};
+
+#endif // LANDMARK_SEARCH_POPUP_H
@@ -0,0 +1,118 @@
+//
+//  LandmarkStore.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "LandmarkStore.h"
+#include <string.h>
+
+// The shared store.
+static LandmarkStore* s_SharedStore = NULL;
+
+// Get the store shared by the map and everything displaying its landmarks.
+
+LandmarkStore* LandmarkStore::sharedStore()
+{
+    if (!s_SharedStore)
+    {
+        s_SharedStore = new LandmarkStore();
+    }
+
+    return s_SharedStore;
+}
+
+// Default constructor.
+
+LandmarkStore::LandmarkStore()
+{
+}
+
+// Replace every landmark with those of a catalog file, which is kept mapped until the store is cleared.
+
+bool LandmarkStore::openCatalog(const char* path, const MapPoint& mapSize)
+{
+    clear();
+    if (!m_Catalog.open(path))
+    {
+        return false;
+    }
+
+    // Only the fields which are queried in bulk are copied; everything else is read from the catalog when it is asked for.
+    unsigned int count = m_Catalog.getCount();
+    m_Positions.resize(count);
+    m_Categories.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        MapPoint coordinates = m_Catalog.getCoordinates(i);
+        m_Positions[i] = MapPoint(mapSize.x * coordinates.x, mapSize.y * coordinates.y);
+        m_Categories[i] = m_Catalog.getCategories(i);
+    }
+
+    return true;
+}
+
+// Add a landmark after the others, copying its strings into the store.
+
+LandmarkID LandmarkStore::add(const Landmark& landmark, const MapPoint& position)
+{
+    LandmarkID id = m_Positions.size();
+
+    m_Positions.push_back(position);
+    m_Categories.push_back(landmark.categories);
+    m_Names.push_back(addString(landmark.name));
+    m_ImageKeys.push_back(addString(landmark.imageFileName));
+    m_Descriptions.push_back(addString(landmark.description));
+    m_Addresses.push_back(addString(landmark.address));
+    m_WebsiteURLs.push_back(addString(landmark.websiteURL));
+    m_TicketsURLs.push_back(addString(landmark.ticketsURL));
+
+    return id;
+}
+
+// Remove every landmark.
+
+void LandmarkStore::clear()
+{
+    m_Positions.clear();
+    m_Categories.clear();
+    m_Names.clear();
+    m_ImageKeys.clear();
+    m_Descriptions.clear();
+    m_Addresses.clear();
+    m_WebsiteURLs.clear();
+    m_TicketsURLs.clear();
+    m_Strings.clear();
+    m_Catalog.close();
+}
+
+// Set aside memory for a number of landmarks ahead of adding them.
+
+void LandmarkStore::reserve(unsigned int count, unsigned int stringBytes)
+{
+    m_Positions.reserve(count);
+    m_Categories.reserve(count);
+    m_Names.reserve(count);
+    m_ImageKeys.reserve(count);
+    m_Descriptions.reserve(count);
+    m_Addresses.reserve(count);
+    m_WebsiteURLs.reserve(count);
+    m_TicketsURLs.reserve(count);
+    m_Strings.reserve(stringBytes);
+}
+
+// Copy a string into the string pool.
+
+unsigned int LandmarkStore::addString(const char* value)
+{
+    if (!value)
+    {
+        return NO_STRING;
+    }
+
+    unsigned int offset = m_Strings.size();
+    m_Strings.insert(m_Strings.end(), value, value + strlen(value) + 1);
+    return offset;
+}
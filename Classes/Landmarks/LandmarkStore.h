@@ -0,0 +1,181 @@
+//
+//  LandmarkStore.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef LANDMARK_STORE_H
+#define LANDMARK_STORE_H
+
+#include <vector>
+#include "Landmark.h"
+#include "LandmarkCatalog.h"
+#include "MapPoint.h"
+
+/** A handle to a landmark in the LandmarkStore. IDs count up from 0 in the order the landmarks were added. */
+typedef unsigned int LandmarkID;
+
+/** An ID which refers to no landmark. */
+static const LandmarkID INVALID_LANDMARK_ID = 0xFFFFFFFF;
+
+/**
+ @brief     Every landmark on the map, stored as a structure of arrays and addressed by LandmarkID.
+
+ Each field is kept in an array of its own, so that bulk queries (ie. over every position) only touch the memory they need, and everything else (buttons, popups) refers to a landmark by its ID alone.
+
+ The landmarks can come from a LandmarkCatalog, which the store keeps mapped for as long as it holds them. Only their positions and categories are copied out of it, for the bulk queries; their strings are read from the catalog's records and string table in place, so opening a catalog of any size costs little more than a pass over its coordinates. Landmarks can also be added one at a time, in which case the store keeps its own copy of their strings so that their source doesn't need to live for as long as the map. Added landmarks come after the catalog's.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class LandmarkStore
+{
+public:
+
+    /**
+     @brief     Get the store shared by the map and everything displaying its landmarks.
+     @return    A pointer to the shared store.
+     */
+    static LandmarkStore* sharedStore();
+
+    /**
+     @brief     Default constructor. The store is empty.
+     */
+    LandmarkStore();
+
+    /**
+     @brief     Add a landmark after the others, copying its strings into the store.
+     @param     landmark    The landmark's data. Its strings only need to stay valid for the duration of the call.
+     @param     position    The landmark's position in map space.
+     @return    The new landmark's ID.
+     */
+    LandmarkID add(const Landmark& landmark, const MapPoint& position);
+
+    /**
+     @brief     Replace every landmark with those of a catalog file, which is kept mapped until the store is cleared. The landmarks' IDs are their indices in the catalog.
+     @param     path        The full path of the catalog file.
+     @param     mapSize     The size of the map in map space, which the catalog's coordinates (ranging from bottom-left (0,0) to top-right (1,1)) are scaled by.
+     @return    Whether or not the file was a valid catalog. If not, the store is left empty.
+     */
+    bool openCatalog(const char* path, const MapPoint& mapSize);
+
+    /**
+     @brief     Remove every landmark, closing the catalog if one is open. IDs are reused from 0 afterwards.
+     */
+    void clear();
+
+    /**
+     @brief     Set aside memory for a number of landmarks ahead of adding them.
+     @param     count           The number of landmarks.
+     @param     stringBytes     The total size of their strings, including terminators.
+     */
+    void reserve(unsigned int count, unsigned int stringBytes);
+
+    /**
+     @brief     Get the number of landmarks in the store.
+     */
+    unsigned int getCount() const { return m_Positions.size(); }
+
+    /**
+     @brief     Get a checksum of the catalog the store's landmarks came from (see LandmarkCatalog::getChecksum), ie. to check that a search index was built from it.
+     @return    The checksum, or 0 if no catalog is open.
+     */
+    unsigned int getCatalogChecksum() const { return m_Catalog.getChecksum(); }
+
+    /**
+     @brief     Check whether or not an ID refers to a landmark in the store.
+     */
+    bool isValid(LandmarkID landmark) const { return landmark < m_Positions.size(); }
+
+    /**
+     @brief     Get the position of every landmark in map space, indexed by ID.
+     */
+    const std::vector<MapPoint>& getPositions() const { return m_Positions; }
+
+    /**
+     @brief     Get a landmark's position in map space.
+     */
+    const MapPoint& getPosition(LandmarkID landmark) const { return m_Positions[landmark]; }
+
+    /**
+     @brief     Get the categories of every landmark, as combinations of LandmarkCategory flags indexed by ID.
+     */
+    const std::vector<unsigned int>& getCategories() const { return m_Categories; }
+
+    /**
+     @brief     Get a landmark's categories, as a combination of LandmarkCategory flags.
+     */
+    unsigned int getCategories(LandmarkID landmark) const { return m_Categories[landmark]; }
+
+    /**
+     @brief     Get a landmark's strings. The pointers remain valid until another landmark is added or the store is cleared.
+     @param     landmark    The landmark's ID.
+     @return    The string, or NULL if the landmark doesn't have one.
+     */
+    const char* getName(LandmarkID landmark) const { return getString(landmark, kLandmarkCatalogStringName, m_Names); }
+    const char* getImageKey(LandmarkID landmark) const { return getString(landmark, kLandmarkCatalogStringImageFileName, m_ImageKeys); }
+    const char* getDescription(LandmarkID landmark) const { return getString(landmark, kLandmarkCatalogStringDescription, m_Descriptions); }
+    const char* getAddress(LandmarkID landmark) const { return getString(landmark, kLandmarkCatalogStringAddress, m_Addresses); }
+    const char* getWebsiteURL(LandmarkID landmark) const { return getString(landmark, kLandmarkCatalogStringWebsiteURL, m_WebsiteURLs); }
+    const char* getTicketsURL(LandmarkID landmark) const { return getString(landmark, kLandmarkCatalogStringTicketsURL, m_TicketsURLs); }
+
+private:
+
+    /**
+     @brief     Declared as private because a store owns its catalog's mapping and can't be copied.
+     */
+    LandmarkStore(const LandmarkStore&);
+    LandmarkStore& operator=(const LandmarkStore&);
+
+    /**
+     @brief     Get one of a landmark's strings, from the catalog if it came from there or from the string pool if it was added.
+     @param     landmark    The landmark's ID.
+     @param     string      Which string to get.
+     @param     offsets     The offsets of that string in the pool, for the landmarks which were added.
+     @return    A pointer to the string, or NULL if the landmark doesn't have one.
+     */
+    const char* getString(LandmarkID landmark, LandmarkCatalogString string, const std::vector<unsigned int>& offsets) const
+    {
+        return (landmark < m_Catalog.getCount()) ? m_Catalog.getString(landmark, string) : getString(offsets[landmark - m_Catalog.getCount()]);
+    }
+
+    /**
+     @brief     Copy a string into the string pool.
+     @param     value   The string, which may be NULL.
+     @return    The string's offset in the pool, or NO_STRING for NULL.
+     */
+    unsigned int addString(const char* value);
+
+    /**
+     @brief     Get a string from the string pool.
+     @param     offset  The string's offset, or NO_STRING.
+     @return    A pointer to the string, or NULL for NO_STRING.
+     */
+    const char* getString(unsigned int offset) const { return (offset != NO_STRING) ? &m_Strings[offset] : NULL; }
+
+    /** The offset stored for a string which was left out. */
+    static const unsigned int NO_STRING = 0xFFFFFFFF;
+
+    /** Each landmark's position in map space. */
+    std::vector<MapPoint> m_Positions;
+
+    /** Each landmark's categories. */
+    std::vector<unsigned int> m_Categories;
+
+    /** The catalog the first landmarks came from, which their strings are read from. It is empty if there is none. */
+    LandmarkCatalog m_Catalog;
+
+    /** The offset of each added landmark's strings in the string pool, indexed from the first landmark after the catalog's. */
+    std::vector<unsigned int> m_Names;
+    std::vector<unsigned int> m_ImageKeys;
+    std::vector<unsigned int> m_Descriptions;
+    std::vector<unsigned int> m_Addresses;
+    std::vector<unsigned int> m_WebsiteURLs;
+    std::vector<unsigned int> m_TicketsURLs;
+
+    /** Every added landmark's strings, each followed by a terminating zero. */
+    std::vector<char> m_Strings;
+};
+
+#endif // LANDMARK_STORE_H
@@ -0,0 +1,228 @@
+//
+//  ThumbnailAtlas.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-03.
+//
+//
+
+#include "ThumbnailAtlas.h"
+#include "AssetResolver.h"
+
+using namespace std;
+using namespace cocos2d;
+
+// The atlas grows in powers of two from the smallest size until it holds this many thumbnails, or reaches the largest size.
+#define MIN_ATLAS_SIZE  256
+#define MAX_ATLAS_SIZE  2048
+#define MIN_SLOTS       64
+
+// The shared atlas.
+static ThumbnailAtlas* s_SharedAtlas = NULL;
+
+// Get the shared ThumbnailAtlas, creating it the first time.
+
+ThumbnailAtlas* ThumbnailAtlas::sharedAtlas()
+{
+    if (!s_SharedAtlas)
+    {
+        s_SharedAtlas = new ThumbnailAtlas();
+    }
+
+    return s_SharedAtlas;
+}
+
+// Default constructor.
+
+ThumbnailAtlas::ThumbnailAtlas()
+{
+    m_Texture = NULL;
+    m_CellWidth = 0;
+    m_CellHeight = 0;
+    m_ReleaseCount = 0;
+}
+
+// Get a frame displaying a thumbnail, loading it into the atlas if needed.
+
+CCSpriteFrame* ThumbnailAtlas::acquireThumbnail(const char* fileName, float* assetScale)
+{
+    // If the thumbnail is already in the atlas, just take another reference to it.
+    map<string, unsigned int>::iterator found = m_SlotsByName.find(fileName);
+    if (found != m_SlotsByName.end())
+    {
+        Slot& slot = m_Slots[found->second];
+        slot.references++;
+        *assetScale = slot.assetScale;
+        return slot.frame;
+    }
+
+    // Otherwise, decode it...
+    float imageAssetScale;
+    CCImage* image = AssetResolver::createImage(fileName, &imageAssetScale);
+    if (!image || image->getBitsPerComponent() != 8)
+    {
+        return NULL;
+    }
+
+    // ...making the atlas the first time to fit the size of the thumbnails...
+    if (!m_Texture && !createTexture(image->getWidth(), image->getHeight()))
+    {
+        return NULL;
+    }
+
+    if (image->getWidth() != m_CellWidth || image->getHeight() != m_CellHeight)
+    {
+        CCLOG("Thumbnail \"%s\" is %dx%d, but the atlas holds %ux%u thumbnails.", fileName, image->getWidth(), image->getHeight(), m_CellWidth, m_CellHeight);
+        return NULL;
+    }
+
+    // ...and find it a slot.
+    int slotIndex = findFreeSlot();
+    if (slotIndex < 0)
+    {
+        return NULL;
+    }
+
+    Slot& slot = m_Slots[slotIndex];
+    if (!slot.fileName.empty())
+    {
+        m_SlotsByName.erase(slot.fileName);
+    }
+
+    // The atlas always holds premultiplied RGBA, so convert images which are stored any other way.
+    unsigned int pixelCount = m_CellWidth * m_CellHeight;
+    const unsigned char* pixels = image->getData();
+
+    if (!image->hasAlpha())
+    {
+        m_ConversionBuffer.resize(pixelCount * 4);
+        for (unsigned int i = 0; i < pixelCount; i++)
+        {
+            m_ConversionBuffer[i*4 + 0] = pixels[i*3 + 0];
+            m_ConversionBuffer[i*4 + 1] = pixels[i*3 + 1];
+            m_ConversionBuffer[i*4 + 2] = pixels[i*3 + 2];
+            m_ConversionBuffer[i*4 + 3] = 255;
+        }
+        pixels = &m_ConversionBuffer[0];
+    }
+    else if (!image->isPremultipliedAlpha())
+    {
+        m_ConversionBuffer.resize(pixelCount * 4);
+        for (unsigned int i = 0; i < pixelCount; i++)
+        {
+            unsigned int alpha = pixels[i*4 + 3];
+            m_ConversionBuffer[i*4 + 0] = (unsigned char)(pixels[i*4 + 0] * alpha / 255);
+            m_ConversionBuffer[i*4 + 1] = (unsigned char)(pixels[i*4 + 1] * alpha / 255);
+            m_ConversionBuffer[i*4 + 2] = (unsigned char)(pixels[i*4 + 2] * alpha / 255);
+            m_ConversionBuffer[i*4 + 3] = (unsigned char)alpha;
+        }
+        pixels = &m_ConversionBuffer[0];
+    }
+
+    // Copy the thumbnail into its slot.
+    unsigned int columns = m_Texture->getPixelsWide() / m_CellWidth;
+    ccGLBindTexture2D(m_Texture->getName());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, (slotIndex % columns) * m_CellWidth, (slotIndex / columns) * m_CellHeight,
+                    m_CellWidth, m_CellHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    slot.fileName = fileName;
+    slot.assetScale = imageAssetScale;
+    slot.references = 1;
+    m_SlotsByName[slot.fileName] = slotIndex;
+
+    *assetScale = imageAssetScale;
+    return slot.frame;
+}
+
+// Give up a reference to a thumbnail.
+
+void ThumbnailAtlas::releaseThumbnail(const char* fileName)
+{
+    map<string, unsigned int>::iterator found = m_SlotsByName.find(fileName);
+    if (found == m_SlotsByName.end())
+    {
+        return;
+    }
+
+    // The thumbnail stays in its slot once it is unused, in case it is wanted again before the slot is reused.
+    Slot& slot = m_Slots[found->second];
+    if (slot.references > 0 && --slot.references == 0)
+    {
+        slot.lastReleased = ++m_ReleaseCount;
+    }
+}
+
+// Create the atlas texture, sized to hold thumbnails of one size.
+
+bool ThumbnailAtlas::createTexture(unsigned int cellWidth, unsigned int cellHeight)
+{
+    if (cellWidth == 0 || cellHeight == 0 || cellWidth > MAX_ATLAS_SIZE || cellHeight > MAX_ATLAS_SIZE)
+    {
+        return false;
+    }
+
+    unsigned int size = MIN_ATLAS_SIZE;
+    while (size < MAX_ATLAS_SIZE && (size / cellWidth) * (size / cellHeight) < MIN_SLOTS)
+    {
+        size *= 2;
+    }
+
+    // Start with a transparent texture, so that nothing shows through the edges of a slot.
+    vector<unsigned char> blank(size * size * 4, 0);
+    m_Texture = new CCTexture2D();
+    if (!m_Texture || !m_Texture->initWithData(&blank[0], kCCTexture2DPixelFormat_RGBA8888, size, size, CCSizeMake(size, size)))
+    {
+        CC_SAFE_RELEASE_NULL(m_Texture);
+        return false;
+    }
+
+    m_CellWidth = cellWidth;
+    m_CellHeight = cellHeight;
+
+    // Divide the texture into slots, each with its own frame.
+    unsigned int columns = size / cellWidth;
+    unsigned int rows = size / cellHeight;
+    m_Slots.resize(columns * rows);
+
+    for (unsigned int i = 0; i < m_Slots.size(); i++)
+    {
+        Slot& slot = m_Slots[i];
+        CCRect rect = CCRectMake((i % columns) * cellWidth, (i / columns) * cellHeight, cellWidth, cellHeight);
+        slot.frame = CCSpriteFrame::createWithTexture(m_Texture, CC_RECT_PIXELS_TO_POINTS(rect));
+        slot.frame->retain();
+        slot.assetScale = 1;
+        slot.references = 0;
+        slot.lastReleased = 0;
+    }
+
+    return true;
+}
+
+// Find a slot which isn't being displayed.
+
+int ThumbnailAtlas::findFreeSlot() const
+{
+    int best = -1;
+
+    for (unsigned int i = 0; i < m_Slots.size(); i++)
+    {
+        const Slot& slot = m_Slots[i];
+        if (slot.references > 0)
+        {
+            continue;
+        }
+
+        if (slot.fileName.empty())
+        {
+            return i;
+        }
+
+        if (best < 0 || slot.lastReleased < m_Slots[best].lastReleased)
+        {
+            best = i;
+        }
+    }
+
+    return best;
+}
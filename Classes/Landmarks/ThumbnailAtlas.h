@@ -0,0 +1,95 @@
+//
+//  ThumbnailAtlas.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-03.
+//
+//
+
+#ifndef THUMBNAIL_ATLAS_H
+#define THUMBNAIL_ATLAS_H
+
+#include "cocos2d.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ @brief     A single texture shared by every landmark thumbnail on screen.
+
+ Thumbnails are all the same size, so the atlas is divided into a grid of equal slots. A thumbnail is decoded into a free slot the first time it is needed and stays there while anything refers to it. Once nothing does, its slot is kept as a cache until the slot is needed for another thumbnail, least recently used first. This keeps the memory used by thumbnails bounded by the atlas rather than by how many landmarks there are, and lets LandmarkButtons be rebound to other landmarks without loading a texture each time.
+ */
+class ThumbnailAtlas
+{
+public:
+
+    /**
+     @brief     Get the shared ThumbnailAtlas, creating it the first time.
+     @return    A pointer to the shared ThumbnailAtlas.
+     */
+    static ThumbnailAtlas* sharedAtlas();
+
+    /**
+     @brief     Get a frame displaying a thumbnail, loading it into the atlas if needed. Every successful call must be matched by a call to releaseThumbnail(...).
+     @param     fileName    The file name of the original, full-resolution thumbnail image.
+     @param     assetScale  Receives the scale of the variant that was loaded relative to the original.
+     @return    A pointer to the frame, or NULL if the thumbnail couldn't be loaded or the atlas has no free slots.
+     */
+    cocos2d::CCSpriteFrame* acquireThumbnail(const char* fileName, float* assetScale);
+
+    /**
+     @brief     Give up a reference to a thumbnail obtained with acquireThumbnail(...).
+     @param     fileName    The file name the thumbnail was acquired with.
+     */
+    void releaseThumbnail(const char* fileName);
+
+private:
+
+    /**
+     @brief     A single thumbnail-sized area of the atlas.
+     */
+    struct Slot
+    {
+        std::string fileName;
+        float assetScale;
+        cocos2d::CCSpriteFrame* frame;
+        unsigned int references;
+        unsigned int lastReleased;
+    };
+
+    /**
+     @brief     Default constructor. Declared as private because the atlas is shared.
+     */
+    ThumbnailAtlas();
+
+    /**
+     @brief     Create the atlas texture, sized to hold thumbnails of one size.
+     @param     cellWidth   The width in pixels of a thumbnail.
+     @param     cellHeight  The height in pixels of a thumbnail.
+     @return    Whether or not the texture was created successfully.
+     */
+    bool createTexture(unsigned int cellWidth, unsigned int cellHeight);
+
+    /**
+     @brief     Find a slot which isn't being displayed, preferring those which have never been used, then the least recently released.
+     @return    The slot's index, or -1 if every slot is in use.
+     */
+    int findFreeSlot() const;
+
+    /** The atlas texture, and the size of its slots in pixels. */
+    cocos2d::CCTexture2D* m_Texture;
+    unsigned int m_CellWidth;
+    unsigned int m_CellHeight;
+
+    /** Every slot in the atlas, and the index of the slot holding each loaded thumbnail. */
+    std::vector<Slot> m_Slots;
+    std::map<std::string, unsigned int> m_SlotsByName;
+
+    /** Counts releases, so that the least recently released slot can be reused first. */
+    unsigned int m_ReleaseCount;
+
+    /** Scratch memory for converting images without an alpha channel. */
+    std::vector<unsigned char> m_ConversionBuffer;
+};
+
+#endif // THUMBNAIL_ATLAS_H
@@ -0,0 +1,156 @@
+//
+//  AddressController.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#include "AddressController.h"
+#include "Defines.h"
+#include "StreetData.h"
+
+using namespace cocos2d;
+
+// How long an address stays on screen in seconds.
+#define ADDRESS_DURATION    2.5f
+
+// Create an AddressController for a map.
+
+AddressController* AddressController::create(Map* map)
+{
+    AddressController *controller = new AddressController();
+    if (controller && controller->init(map))
+    {
+        controller->autorelease();
+        return controller;
+    }
+    CC_SAFE_DELETE(controller);
+    return NULL;
+}
+
+// Default constructor.
+
+AddressController::AddressController()
+: m_Map(NULL)
+, m_Label(NULL)
+, m_HasRouteOrigin(false)
+{
+}
+
+// Destructor.
+
+AddressController::~AddressController()
+{
+    CC_SAFE_RELEASE(m_Map);
+}
+
+// Initialize the controller for a map.
+
+bool AddressController::init(Map* map)
+{
+    if (!map || !CCNode::init())
+    {
+        return false;
+    }
+    
+    m_Map = map;
+    m_Map->retain();
+    
+    // Add a label along the bottom of the screen for the address of a tapped point, hidden until the user taps.
+    m_Label = CCLabelTTF::create("", "Montserrat", 40 * SCREEN_SCALE);
+    if (!m_Label)
+    {
+        return false;
+    }
+    m_Label->setPosition(ccp(WIN_SIZE.width/2, 60 * SCREEN_SCALE));
+    m_Label->setOpacity(0);
+    addChild(m_Label);
+    
+    return true;
+}
+
+// Called when this is added to the node tree.
+
+void AddressController::onEnter()
+{
+    CCNode::onEnter();
+    m_Map->setObserver(this);
+}
+
+// Called when this is removed from the node tree.
+
+void AddressController::onExit()
+{
+    if (m_Map->getObserver() == this)
+    {
+        m_Map->setObserver(NULL);
+    }
+    CCNode::onExit();
+}
+
+// Look up the street address of a point the user tapped, and display it over the map for a moment.
+
+void AddressController::mapTapped(const MapPoint& location)
+{
+    const MapProjection& projection = m_Map->getProjection();
+    if (!projection.isCalibrated())
+    {
+        return;
+    }
+    
+    // Find the tapped point on the map, then undo the projection to find where it is on the Earth.
+    GeoPoint geoPoint = projection.unproject(m_Map->getMapPosition(location));
+    
+    StreetAddress address;
+    if (!StreetGeocoder(StreetData::sharedData()).reverseGeocode(geoPoint, &address))
+    {
+        return;
+    }
+    
+    if (DISPLAY_TOUCH_MESSAGES)
+    {
+        CCLOG("Tapped %.5f, %.5f, which is %.0f metres from the street.", geoPoint.latitude, geoPoint.longitude, address.distance);
+    }
+    
+    // Keep the label clear of the tap, so that the user's finger doesn't cover it.
+    showAddress(address, location.y < WIN_SIZE.height * 0.25f);
+}
+
+// Make an address the one routes start from, and display it over the map for a moment.
+
+void AddressController::showAddress(const StreetAddress& address, bool isAtTop)
+{
+    m_RouteOrigin = address.location;
+    m_HasRouteOrigin = true;
+    
+    std::string text;
+    StreetGeocoder::formatAddress(address, &text);
+    if (DISPLAY_TOUCH_MESSAGES)
+    {
+        CCLOG("Address: %s", text.c_str());
+    }
+    displayText(text.c_str(), isAtTop);
+}
+
+// Display a line of text over the map for a moment, in the address label.
+
+void AddressController::displayText(const char* text, bool isAtTop)
+{
+    m_Label->setString(text);
+    m_Label->setPositionY(isAtTop ? WIN_SIZE.height - 60 * SCREEN_SCALE : 60 * SCREEN_SCALE);
+    m_Label->stopAllActions();
+    m_Label->setOpacity(255);
+    m_Label->runAction(CCSequence::create(CCDelayTime::create(ADDRESS_DURATION), CCFadeOut::create(0.35f), NULL));
+}
+
+// Get the last address the user tapped or searched for, which routes start from.
+
+bool AddressController::getRouteOrigin(GeoPoint* location) const
+{
+    if (m_HasRouteOrigin)
+    {
+        *location = m_RouteOrigin;
+    }
+    return m_HasRouteOrigin;
+}
@@ -0,0 +1,101 @@
+//
+//  AddressController.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#ifndef ADDRESS_CONTROLLER_H
+#define ADDRESS_CONTROLLER_H
+
+#include "cocos2d.h"
+#include "Map.h"
+#include "StreetGeocoder.h"
+
+/**
+ @brief     A controller which looks up the street address of a point the user taps on the map, and displays it over the map for a moment in a label of its own.
+
+ The last address the user tapped or searched for is where walking routes and tours start from (see DirectionsController and TourController), and the label also displays the other controllers' messages (ie. the length of a route).
+ */
+class AddressController : public cocos2d::CCNode, public MapObserver
+{
+public:
+    
+    /**
+     @brief     Create an AddressController for a map.
+     @param     map         The map whose taps are looked up. It is retained, and told to report its taps to this controller while this is in the node tree.
+     @return    A pointer to the newly created AddressController.
+     */
+    static AddressController* create(Map* map);
+    
+    /**
+     @brief     Default constructor.
+     */
+    AddressController();
+    
+    /**
+     @brief     Destructor. Releases the map.
+     */
+    virtual ~AddressController();
+    
+    /**
+     @brief     Look up the street address of a point the user tapped, and display it over the map for a moment.
+     @param     location    The tapped point on the screen.
+     */
+    void mapTapped(const MapPoint& location);
+    
+    /**
+     @brief     Make an address the one routes start from, and display it over the map for a moment.
+     @param     address     The address the user tapped or searched for.
+     @param     isAtTop     Whether to display it at the top of the screen rather than the bottom, to keep it clear of the user's finger.
+     */
+    void showAddress(const StreetAddress& address, bool isAtTop);
+    
+    /**
+     @brief     Display a line of text over the map for a moment, in the address label.
+     @param     text        The text to display.
+     @param     isAtTop     Whether to display it at the top of the screen rather than the bottom.
+     */
+    void displayText(const char* text, bool isAtTop);
+    
+    /**
+     @brief     Get the last address the user tapped or searched for, which routes start from.
+     @param     location    Set to the address's location, if there has been one.
+     @return    Whether or not there has been an address yet.
+     */
+    bool getRouteOrigin(GeoPoint* location) const;
+    
+protected:
+    
+    /**
+     @brief     Initialize the controller for a map.
+     @param     map         The map whose taps are looked up.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(Map* map);
+    
+    /**
+     @brief     Called when this is added to the node tree. Starts listening for taps on the map.
+     */
+    void onEnter();
+    
+    /**
+     @brief     Called when this is removed from the node tree. Stops listening for taps on the map.
+     */
+    void onExit();
+    
+private:
+    
+    /** The map whose taps are looked up. */
+    Map* m_Map;
+    
+    /** The label displaying the address of the last point the user tapped, or the length of the last route. */
+    cocos2d::CCLabelTTF* m_Label;
+    
+    /** The last address the user tapped or searched for, and whether there has been one yet. */
+    GeoPoint m_RouteOrigin;
+    bool m_HasRouteOrigin;
+};
+
+#endif // ADDRESS_CONTROLLER_H
@@ -0,0 +1,198 @@
+//
+//  DirectionsController.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#include "DirectionsController.h"
+#include "Defines.h"
+#include "LandmarkStore.h"
+#include "StreetGeocoder.h"
+#include <float.h>
+
+using namespace cocos2d;
+
+// The number of anchors the street graph is built with, which make routes quicker to find for 4 bytes per corner each (see StreetGraph), and the width and colour of a route drawn over the map.
+#define ROUTE_ANCHOR_COUNT  8
+#define ROUTE_WIDTH         (14 * SCREEN_SCALE)
+static const MapColor ROUTE_COLOR = { 0, 150, 141, 255 };
+
+// Create a DirectionsController for a map.
+
+DirectionsController* DirectionsController::create(Map* map, AddressController* addresses)
+{
+    DirectionsController *controller = new DirectionsController();
+    if (controller && controller->init(map, addresses))
+    {
+        controller->autorelease();
+        return controller;
+    }
+    CC_SAFE_DELETE(controller);
+    return NULL;
+}
+
+// Default constructor.
+
+DirectionsController::DirectionsController()
+: m_Map(NULL)
+, m_Addresses(NULL)
+, m_StreetRouter(&m_StreetGraph)
+, m_RouteNode(NULL)
+{
+}
+
+// Destructor.
+
+DirectionsController::~DirectionsController()
+{
+    CC_SAFE_RELEASE(m_Map);
+    CC_SAFE_RELEASE(m_Addresses);
+}
+
+// Initialize the controller for a map.
+
+bool DirectionsController::init(Map* map, AddressController* addresses)
+{
+    if (!map || !addresses || !CCNode::init())
+    {
+        return false;
+    }
+    
+    m_Map = map;
+    m_Map->retain();
+    m_Addresses = addresses;
+    m_Addresses->retain();
+    
+    // Routes are drawn over the map node in map space, so that they move and scale along with it.
+    m_RouteNode = RouteNode::create(ROUTE_WIDTH);
+    if (!m_RouteNode)
+    {
+        return false;
+    }
+    m_Map->addChild(m_RouteNode, 1);
+    
+    return true;
+}
+
+// Called when this is added to the node tree.
+
+void DirectionsController::onEnter()
+{
+    CCNode::onEnter();
+    LandmarkPopup::setDirectionsObserver(this);
+}
+
+// Called when this is removed from the node tree.
+
+void DirectionsController::onExit()
+{
+    LandmarkPopup::setDirectionsObserver(NULL);
+    CCNode::onExit();
+}
+
+// Draw the walking route to a landmark over the map, from the last address the user tapped or searched for.
+
+bool DirectionsController::landmarkDirectionsRequested(LandmarkID landmark)
+{
+    StreetData* data = StreetData::sharedData();
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    GeoPoint origin;
+    if (!m_Addresses->getRouteOrigin(&origin) || !store->isValid(landmark) || !buildStreetGraph())
+    {
+        return false;
+    }
+    
+    StreetRoute route;
+    double before = Map::getCurrentTime();
+    if (!m_StreetRouter.findRoute(data->flatten(origin), data->flatten(getLandmarkLocation(landmark)), &route))
+    {
+        return false;
+    }
+    if (DISPLAY_PERFORMANCE_MESSAGES)
+    {
+        CCLOG("Found a %.0f metre route in %.2f ms, searching %u corners.", route.length, (Map::getCurrentTime() - before) * 1000, route.searchedNodes);
+    }
+    
+    showRoutes(std::vector<std::vector<MapPoint> >(1, route.points));
+    
+    char text[256];
+    snprintf(text, sizeof(text), "%.0f min walk to %s (%.1f km)", ceilf(route.length / WALKING_SPEED / 60), store->getName(landmark), route.length / 1000);
+    m_Addresses->displayText(text, false);
+    return true;
+}
+
+// Build the street graph from the shared StreetData, the first time walking routes are needed.
+
+bool DirectionsController::buildStreetGraph()
+{
+    StreetData* data = StreetData::sharedData();
+    if (!m_Map->getProjection().isCalibrated() || data->getSegmentCount() == 0)
+    {
+        return false;
+    }
+    
+    // Building the graph takes a few milliseconds for the whole city, so it is only done once routes are first asked for. It is never built again, so that the distances a TourController measures through it stay valid.
+    if (m_StreetGraph.getNodeCount() == 0)
+    {
+        double before = Map::getCurrentTime();
+        m_StreetGraph.build(data, ROUTE_ANCHOR_COUNT);
+        if (DISPLAY_PERFORMANCE_MESSAGES)
+        {
+            CCLOG("Built a street graph of %u corners in %.1f ms.", m_StreetGraph.getNodeCount(), (Map::getCurrentTime() - before) * 1000);
+        }
+    }
+    
+    return m_StreetGraph.getNodeCount() > 0;
+}
+
+// Find the shortest walking route between two points through the street graph.
+
+bool DirectionsController::findRoute(const MapPoint& from, const MapPoint& to, StreetRoute* route)
+{
+    return m_StreetRouter.findRoute(from, to, route);
+}
+
+// Get where to walk to for a landmark.
+
+GeoPoint DirectionsController::getLandmarkLocation(LandmarkID landmark)
+{
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    StreetAddress address;
+    const char* addressText = store->getAddress(landmark);
+    if (addressText && StreetGeocoder(StreetData::sharedData()).geocode(addressText, &address))
+    {
+        return address.location;
+    }
+    return m_Map->getProjection().unproject(store->getPosition(landmark));
+}
+
+// Draw walking routes over the map in place of any already drawn, and fly out far enough to see all of them.
+
+void DirectionsController::showRoutes(const std::vector<std::vector<MapPoint> >& routes)
+{
+    // Project the routes onto the map, keeping track of the area they cover.
+    StreetData* data = StreetData::sharedData();
+    const MapProjection& projection = m_Map->getProjection();
+    MapPoint minimum(FLT_MAX, FLT_MAX);
+    MapPoint maximum(-FLT_MAX, -FLT_MAX);
+    std::vector<MapPoint> points;
+    m_RouteNode->clearPolylines();
+    for (unsigned int i = 0; i < routes.size(); i++)
+    {
+        points.resize(routes[i].size());
+        for (unsigned int j = 0; j < points.size(); j++)
+        {
+            points[j] = projection.project(data->unflatten(routes[i][j]));
+            minimum = MapPoint(MIN(minimum.x, points[j].x), MIN(minimum.y, points[j].y));
+            maximum = MapPoint(MAX(maximum.x, points[j].x), MAX(maximum.y, points[j].y));
+        }
+        m_RouteNode->addPolyline(points, ROUTE_COLOR);
+    }
+    
+    if (minimum.x <= maximum.x)
+    {
+        m_Map->flyToArea(minimum, maximum);
+    }
+}
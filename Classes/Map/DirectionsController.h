@@ -0,0 +1,121 @@
+//
+//  DirectionsController.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#ifndef DIRECTIONS_CONTROLLER_H
+#define DIRECTIONS_CONTROLLER_H
+
+#include "cocos2d.h"
+#include <vector>
+#include "Map.h"
+#include "AddressController.h"
+#include "LandmarkPopup.h"
+#include "RouteNode.h"
+#include "StreetRouter.h"
+
+/**
+ @brief     A controller which finds walking routes to the landmarks, draws them over the map and flies out to show them.
+
+ Routes start from the last address the user tapped or searched for (see AddressController). The street graph they are found through is built from the shared StreetData the first time one is asked for, and is shared with the TourController, which draws its tours through this controller too.
+ */
+class DirectionsController : public cocos2d::CCNode, public LandmarkDirectionsObserver
+{
+public:
+    
+    /**
+     @brief     Create a DirectionsController for a map.
+     @param     map         The map to draw the routes over. It is retained, and the routes are drawn in a node added to it.
+     @param     addresses   The controller whose last address routes start from, and whose label displays their lengths. It is retained.
+     @return    A pointer to the newly created DirectionsController.
+     */
+    static DirectionsController* create(Map* map, AddressController* addresses);
+    
+    /**
+     @brief     Default constructor.
+     */
+    DirectionsController();
+    
+    /**
+     @brief     Destructor. Releases the map and the address controller.
+     */
+    virtual ~DirectionsController();
+    
+    /**
+     @brief     Draw the walking route to a landmark over the map, from the last address the user tapped or searched for, and fly out to show all of it.
+     @param     landmark    The ID of the landmark to show directions to.
+     @return    Whether or not a route was found. There is none until the user has picked an address to start from.
+     */
+    bool landmarkDirectionsRequested(LandmarkID landmark);
+    
+    /**
+     @brief     Build the street graph from the shared StreetData, the first time walking routes are needed. It is only built once, so anything measured through it stays valid.
+     @return    Whether or not there is a graph to find routes through. There isn't until the map has been calibrated and the street data has been opened.
+     */
+    bool buildStreetGraph();
+    
+    /**
+     @brief     Get the street graph that walking routes are found through, which is empty until buildStreetGraph() succeeds.
+     */
+    const StreetGraph* getStreetGraph() const { return &m_StreetGraph; }
+    
+    /**
+     @brief     Find the shortest walking route between two points through the street graph.
+     @param     from        The start of the route, in metres east and north of the street data's origin.
+     @param     to          The end of the route, in the same units.
+     @param     route       Set to the route, if one is found.
+     @return    Whether or not a route was found.
+     */
+    bool findRoute(const MapPoint& from, const MapPoint& to, StreetRoute* route);
+    
+    /**
+     @brief     Get where to walk to for a landmark: its address if the street data knows it, since that is where its entrance is, or where it is drawn if not.
+     @param     landmark    The landmark's ID.
+     @return    The landmark's location.
+     */
+    GeoPoint getLandmarkLocation(LandmarkID landmark);
+    
+    /**
+     @brief     Draw walking routes over the map in place of any already drawn, and fly out far enough to see all of them.
+     @param     routes      The routes' points, in metres east and north of the street data's origin (as StreetRouter finds them).
+     */
+    void showRoutes(const std::vector<std::vector<MapPoint> >& routes);
+    
+protected:
+    
+    /**
+     @brief     Initialize the controller for a map.
+     @param     map         The map to draw the routes over.
+     @param     addresses   The controller whose last address routes start from.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(Map* map, AddressController* addresses);
+    
+    /**
+     @brief     Called when this is added to the node tree. Starts answering for directions asked for from any LandmarkPopup.
+     */
+    void onEnter();
+    
+    /**
+     @brief     Called when this is removed from the node tree. Leaves directions to Google Maps again.
+     */
+    void onExit();
+    
+private:
+    
+    /** The map the routes are drawn over, and the controller whose last address they start from. */
+    Map* m_Map;
+    AddressController* m_Addresses;
+    
+    /** The street graph that walking routes are found through, built from the shared StreetData the first time directions are asked for, and the router which searches it. */
+    StreetGraph m_StreetGraph;
+    StreetRouter m_StreetRouter;
+    
+    /** The node drawing the current route or tour over the map node, in map space. */
+    RouteNode* m_RouteNode;
+};
+
+#endif // DIRECTIONS_CONTROLLER_H
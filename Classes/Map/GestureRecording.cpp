@@ -0,0 +1,161 @@
+//
+//  GestureRecording.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-28.
+//
+//
+
+#include "GestureRecording.h"
+#include <string.h>
+
+using namespace std;
+
+// The names of each kind of event in a recording file, indexed by GestureEventKind.
+static const char* EVENT_NAMES[] = { "began", "moved", "ended" };
+static const int EVENT_KIND_COUNT = 3;
+
+// Default constructor.
+
+GestureRecording::GestureRecording()
+: m_Setup(GestureSetup())
+{
+}
+
+// Remove every event and set the setup the recording starts from.
+
+void GestureRecording::reset(const GestureSetup& setup)
+{
+    m_Setup = setup;
+    m_Events.clear();
+}
+
+// Add an event to the end of the recording.
+
+void GestureRecording::addEvent(GestureEventKind kind, double time, int touchID, const MapPoint& location)
+{
+    GestureEvent event;
+    event.kind = kind;
+    event.time = time;
+    event.touchID = touchID;
+    event.location = location;
+    m_Events.push_back(event);
+}
+
+// Remove every event but keep the setup.
+
+void GestureRecording::clearEvents()
+{
+    m_Events.clear();
+}
+
+// Write the setup and every event to a file, replacing its contents.
+
+bool GestureRecording::save(const char* path) const
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+
+    fprintf(file, "# NewYorkGuide gesture recording\n");
+    fprintf(file, "setup %g %g %g %g %.6f %.6f %.3f %.3f %.6f\n",
+            m_Setup.viewSize.x, m_Setup.viewSize.y, m_Setup.contentSize.x, m_Setup.contentSize.y,
+            m_Setup.minScale, m_Setup.maxScale,
+            m_Setup.transform.offset.x, m_Setup.transform.offset.y, m_Setup.transform.scale);
+    writeEvents(file);
+
+    return fclose(file) == 0;
+}
+
+// Add every event to the end of a file which was previously saved.
+
+bool GestureRecording::appendEvents(const char* path) const
+{
+    FILE* file = fopen(path, "a");
+    if (!file)
+    {
+        return false;
+    }
+
+    writeEvents(file);
+
+    return fclose(file) == 0;
+}
+
+// Write every event to an open file.
+
+void GestureRecording::writeEvents(FILE* file) const
+{
+    // Microsecond timestamps and hundredth-of-a-point locations are finer than any touch screen reports.
+    for (unsigned int i = 0; i < m_Events.size(); i++)
+    {
+        const GestureEvent& event = m_Events[i];
+        fprintf(file, "%s %.6f %d %.2f %.2f\n", EVENT_NAMES[event.kind], event.time, event.touchID, event.location.x, event.location.y);
+    }
+}
+
+// Replace this recording with one read from a file.
+
+bool GestureRecording::load(const char* path)
+{
+    reset(GestureSetup());
+
+    FILE* file = fopen(path, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    bool hasSetup = false;
+    bool valid = true;
+    char line[256];
+
+    while (valid && fgets(line, sizeof(line), file))
+    {
+        char name[16];
+        if (line[0] == '#' || sscanf(line, "%15s", name) != 1)
+        {
+            continue;
+        }
+
+        // The setup must come first.
+        if (strcmp(name, "setup") == 0)
+        {
+            valid = !hasSetup &&
+                sscanf(line, "setup %f %f %f %f %f %f %f %f %f",
+                       &m_Setup.viewSize.x, &m_Setup.viewSize.y, &m_Setup.contentSize.x, &m_Setup.contentSize.y,
+                       &m_Setup.minScale, &m_Setup.maxScale,
+                       &m_Setup.transform.offset.x, &m_Setup.transform.offset.y, &m_Setup.transform.scale) == 9;
+            hasSetup = true;
+            continue;
+        }
+
+        int kind = 0;
+        while (kind < EVENT_KIND_COUNT && strcmp(name, EVENT_NAMES[kind]) != 0)
+        {
+            kind++;
+        }
+
+        GestureEvent event;
+        valid = hasSetup && kind < EVENT_KIND_COUNT &&
+            sscanf(line, "%*s %lf %d %f %f", &event.time, &event.touchID, &event.location.x, &event.location.y) == 4;
+
+        if (valid)
+        {
+            event.kind = (GestureEventKind)kind;
+            m_Events.push_back(event);
+        }
+    }
+
+    fclose(file);
+
+    if (!valid || !hasSetup)
+    {
+        reset(GestureSetup());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,143 @@
+//
+//  GestureRecording.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-28.
+//
+//
+
+#ifndef GESTURE_RECORDING_H
+#define GESTURE_RECORDING_H
+
+#include <stdio.h>
+#include <vector>
+#include "MapController.h"
+
+/**
+ @brief     The kinds of touch event in a gesture recording.
+ */
+enum GestureEventKind
+{
+    kGestureEventBegan = 0,
+    kGestureEventMoved,
+    kGestureEventEnded
+};
+
+/**
+ @brief     A single timestamped touch event.
+ */
+struct GestureEvent
+{
+    GestureEventKind kind;
+
+    /** The time of the event in seconds. */
+    double time;
+
+    /** The touch's identifier, which is unique among the touches that are down at the time. */
+    int touchID;
+
+    /** The touch's position in view space. */
+    MapPoint location;
+};
+
+/**
+ @brief     Everything a MapController was reset with when the recording started, so that a replay starts from the same place.
+ */
+struct GestureSetup
+{
+    MapPoint viewSize;
+    MapPoint contentSize;
+    float minScale;
+    float maxScale;
+    MapTransform transform;
+};
+
+/**
+ @brief     A stream of timestamped touches on the map, which can be saved to a file and replayed later through a MapController.
+
+ Recordings are plain text so that they can be read and trimmed by hand. The file starts with the setup and is followed by one event per line:
+
+     setup <view width> <view height> <content width> <content height> <min scale> <max scale> <offset x> <offset y> <scale>
+     began <time> <touch id> <x> <y>
+     moved <time> <touch id> <x> <y>
+     ended <time> <touch id> <x> <y>
+
+ Lines starting with '#' are ignored. Events can be appended to an existing file, so a recording can be written a gesture at a time.
+
+ This class has no dependencies on cocos2d so that recordings can be replayed without a device (see Tools/GestureReplayer.cpp).
+ */
+class GestureRecording
+{
+public:
+
+    /**
+     @brief     Default constructor. The recording is empty.
+     */
+    GestureRecording();
+
+    /**
+     @brief     Remove every event and set the setup the recording starts from.
+     @param     setup       The MapController's setup.
+     */
+    void reset(const GestureSetup& setup);
+
+    /**
+     @brief     Add an event to the end of the recording.
+     @param     kind        The kind of event.
+     @param     time        The time of the event in seconds.
+     @param     touchID     The touch's identifier.
+     @param     location    The touch's position in view space.
+     */
+    void addEvent(GestureEventKind kind, double time, int touchID, const MapPoint& location);
+
+    /**
+     @brief     Remove every event but keep the setup (ie. after they have been appended to a file).
+     */
+    void clearEvents();
+
+    /**
+     @brief     Get the setup the recording starts from.
+     */
+    const GestureSetup& getSetup() const { return m_Setup; }
+
+    /**
+     @brief     Get every event in the recording, in the order they happened.
+     */
+    const std::vector<GestureEvent>& getEvents() const { return m_Events; }
+
+    /**
+     @brief     Write the setup and every event to a file, replacing its contents.
+     @param     path        The path of the file.
+     @return    Whether or not the file was written successfully.
+     */
+    bool save(const char* path) const;
+
+    /**
+     @brief     Add every event to the end of a file which was previously saved.
+     @param     path        The path of the file.
+     @return    Whether or not the file was written successfully.
+     */
+    bool appendEvents(const char* path) const;
+
+    /**
+     @brief     Replace this recording with one read from a file.
+     @param     path        The path of the file.
+     @return    Whether or not the file was read successfully. The recording is left empty if it wasn't.
+     */
+    bool load(const char* path);
+
+private:
+
+    /**
+     @brief     Write every event to an open file.
+     */
+    void writeEvents(FILE* file) const;
+
+    /** The MapController's setup when the recording started. */
+    GestureSetup m_Setup;
+
+    /** The recorded events. */
+    std::vector<GestureEvent> m_Events;
+};
+
+#endif // GESTURE_RECORDING_H
@@ -0,0 +1,76 @@
+//
+//  LandmarkFilterController.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#include "LandmarkFilterController.h"
+
+using namespace cocos2d;
+
+// Create a LandmarkFilterController for a map.
+
+LandmarkFilterController* LandmarkFilterController::create(Map* map)
+{
+    LandmarkFilterController *controller = new LandmarkFilterController();
+    if (controller && controller->init(map))
+    {
+        controller->autorelease();
+        return controller;
+    }
+    CC_SAFE_DELETE(controller);
+    return NULL;
+}
+
+// Default constructor.
+
+LandmarkFilterController::LandmarkFilterController()
+: m_Map(NULL)
+{
+}
+
+// Destructor.
+
+LandmarkFilterController::~LandmarkFilterController()
+{
+    CC_SAFE_RELEASE(m_Map);
+}
+
+// Initialize the controller for a map.
+
+bool LandmarkFilterController::init(Map* map)
+{
+    if (!map || !CCNode::init())
+    {
+        return false;
+    }
+    
+    m_Map = map;
+    m_Map->retain();
+    return true;
+}
+
+// Open the filter popup for picking which categories of landmark are displayed.
+
+void LandmarkFilterController::showFilter()
+{
+    LandmarkLayer* layer = m_Map->getLandmarkLayer();
+    if (layer)
+    {
+        LandmarkFilterPopup::showPopup(layer->getCategoryFilter(), this);
+    }
+}
+
+// Only display the landmarks in the categories the user picked from the filter popup.
+
+void LandmarkFilterController::landmarkFilterChanged(unsigned int categories)
+{
+    // The popup covers the map, but the landmarks behind it change as soon as a category is turned on or off.
+    LandmarkLayer* layer = m_Map->getLandmarkLayer();
+    if (layer)
+    {
+        layer->setCategoryFilter(categories, false);
+    }
+}
@@ -0,0 +1,66 @@
+//
+//  LandmarkFilterController.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#ifndef LANDMARK_FILTER_CONTROLLER_H
+#define LANDMARK_FILTER_CONTROLLER_H
+
+#include "cocos2d.h"
+#include "Map.h"
+#include "LandmarkFilterPopup.h"
+
+/**
+ @brief     A controller which opens the filter popup, and displays only the landmarks in the categories the user picks from it. The categories are kept by the map's LandmarkLayer.
+ */
+class LandmarkFilterController : public cocos2d::CCNode, public LandmarkFilterObserver
+{
+public:
+    
+    /**
+     @brief     Create a LandmarkFilterController for a map.
+     @param     map         The map whose landmarks are filtered. It is retained.
+     @return    A pointer to the newly created LandmarkFilterController.
+     */
+    static LandmarkFilterController* create(Map* map);
+    
+    /**
+     @brief     Default constructor.
+     */
+    LandmarkFilterController();
+    
+    /**
+     @brief     Destructor. Releases the map.
+     */
+    virtual ~LandmarkFilterController();
+    
+    /**
+     @brief     Open the filter popup for picking which categories of landmark are displayed. Does nothing until the map is displaying its landmarks.
+     */
+    void showFilter();
+    
+    /**
+     @brief     Only display the landmarks in the categories the user picked from the filter popup.
+     @param     categories  The categories to display, as a combination of LandmarkCategory flags, or 0 to display every landmark.
+     */
+    void landmarkFilterChanged(unsigned int categories);
+    
+protected:
+    
+    /**
+     @brief     Initialize the controller for a map.
+     @param     map         The map whose landmarks are filtered.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(Map* map);
+    
+private:
+    
+    /** The map whose landmarks are filtered. */
+    Map* m_Map;
+};
+
+#endif // LANDMARK_FILTER_CONTROLLER_H
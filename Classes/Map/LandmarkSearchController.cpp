@@ -0,0 +1,138 @@
+//
+//  LandmarkSearchController.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#include "LandmarkSearchController.h"
+#include "LandmarkPopup.h"
+#include "LandmarkSearchIndex.h"
+#include "LandmarkSearchIndexWriter.h"
+#include "LandmarkStore.h"
+
+using namespace cocos2d;
+
+// The tag of the action which opens a landmark's popup after flying to it from the search popup.
+#define SHOW_SELECTED_LANDMARK_ACTION_TAG   1
+
+// Create a LandmarkSearchController for a map.
+
+LandmarkSearchController* LandmarkSearchController::create(Map* map, AddressController* addresses)
+{
+    LandmarkSearchController *controller = new LandmarkSearchController();
+    if (controller && controller->init(map, addresses))
+    {
+        controller->autorelease();
+        return controller;
+    }
+    CC_SAFE_DELETE(controller);
+    return NULL;
+}
+
+// Default constructor.
+
+LandmarkSearchController::LandmarkSearchController()
+: m_Map(NULL)
+, m_Addresses(NULL)
+, m_SelectedLandmark(INVALID_LANDMARK_ID)
+{
+}
+
+// Destructor.
+
+LandmarkSearchController::~LandmarkSearchController()
+{
+    CC_SAFE_RELEASE(m_Map);
+    CC_SAFE_RELEASE(m_Addresses);
+}
+
+// Initialize the controller for a map.
+
+bool LandmarkSearchController::init(Map* map, AddressController* addresses)
+{
+    if (!map || !addresses || !CCNode::init())
+    {
+        return false;
+    }
+    
+    m_Map = map;
+    m_Map->retain();
+    m_Addresses = addresses;
+    m_Addresses->retain();
+    return true;
+}
+
+// Open the search popup, first building the search index if it doesn't match the landmarks on the map.
+
+void LandmarkSearchController::showSearch()
+{
+    // The map can open an index built along with its landmarks (ie. NewYorkMap). Otherwise, or if landmarks were added since, it is built here from the store, which takes a few milliseconds for a few thousand landmarks.
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    LandmarkSearchIndex* index = LandmarkSearchIndex::sharedIndex();
+    if (index->getCount() != store->getCount())
+    {
+        LandmarkSearchIndexWriter writer;
+        for (LandmarkID landmark = 0; landmark < store->getCount(); landmark++)
+        {
+            writer.add(store->getName(landmark), store->getDescription(landmark));
+        }
+        
+        std::vector<unsigned char> data;
+        writer.write(&data);
+        index->load(&data);
+    }
+    
+    LandmarkSearchPopup::showPopup(this);
+}
+
+// Fly to the landmark the user picked from the search popup, then open its LandmarkPopup.
+
+void LandmarkSearchController::landmarkSearchResultSelected(LandmarkID landmark)
+{
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    if (!store->isValid(landmark))
+    {
+        return;
+    }
+    
+    m_Map->flyToPosition(store->getPosition(landmark));
+    
+    // Wait for the flight to finish before opening the popup, so that its image grows out of the landmark.
+    m_SelectedLandmark = landmark;
+    stopActionByTag(SHOW_SELECTED_LANDMARK_ACTION_TAG);
+    CCAction* showAction = CCSequence::create(CCDelayTime::create(Map::getFlightDuration()),
+                                              CCCallFunc::create(this, callfunc_selector(LandmarkSearchController::showSelectedLandmark)),
+                                              NULL);
+    showAction->setTag(SHOW_SELECTED_LANDMARK_ACTION_TAG);
+    runAction(showAction);
+}
+
+// Fly to the address the user picked from the search popup, and display it over the map for a moment.
+
+void LandmarkSearchController::addressSearchResultSelected(const StreetAddress& address)
+{
+    const MapProjection& projection = m_Map->getProjection();
+    if (!projection.isCalibrated())
+    {
+        return;
+    }
+    
+    // The address lands in the middle of the screen, so the label can go at the bottom as usual.
+    m_Map->flyToPosition(projection.project(address.location));
+    m_Addresses->showAddress(address, false);
+}
+
+// Open the LandmarkPopup of the landmark picked from the search popup, once the map has flown to it.
+
+void LandmarkSearchController::showSelectedLandmark()
+{
+    // The flight may have been cut short by the user, so use wherever the landmark is now on screen.
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    if (store->isValid(m_SelectedLandmark))
+    {
+        const MapPoint& position = store->getPosition(m_SelectedLandmark);
+        LandmarkPopup::showPopup(m_SelectedLandmark, m_Map->convertToWorldSpace(ccp(position.x, position.y)));
+    }
+}
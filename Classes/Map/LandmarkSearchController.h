@@ -0,0 +1,84 @@
+//
+//  LandmarkSearchController.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#ifndef LANDMARK_SEARCH_CONTROLLER_H
+#define LANDMARK_SEARCH_CONTROLLER_H
+
+#include "cocos2d.h"
+#include "Map.h"
+#include "AddressController.h"
+#include "LandmarkSearchPopup.h"
+
+/**
+ @brief     A controller which opens the search popup, and flies the map to the landmark or address the user picks from it.
+ */
+class LandmarkSearchController : public cocos2d::CCNode, public LandmarkSearchObserver
+{
+public:
+    
+    /**
+     @brief     Create a LandmarkSearchController for a map.
+     @param     map         The map to fly to the results. It is retained.
+     @param     addresses   The controller which displays an address the user picks, and starts routes from it. It is retained.
+     @return    A pointer to the newly created LandmarkSearchController.
+     */
+    static LandmarkSearchController* create(Map* map, AddressController* addresses);
+    
+    /**
+     @brief     Default constructor.
+     */
+    LandmarkSearchController();
+    
+    /**
+     @brief     Destructor. Releases the map and the address controller.
+     */
+    virtual ~LandmarkSearchController();
+    
+    /**
+     @brief     Open the search popup, first building the search index from the LandmarkStore if it doesn't match the landmarks on the map.
+     */
+    void showSearch();
+    
+    /**
+     @brief     Fly to the landmark the user picked from the search popup, then open its LandmarkPopup.
+     @param     landmark    The ID of the landmark which was picked.
+     */
+    void landmarkSearchResultSelected(LandmarkID landmark);
+    
+    /**
+     @brief     Fly to the address the user picked from the search popup, and display it over the map for a moment.
+     @param     address     The address which was picked.
+     */
+    void addressSearchResultSelected(const StreetAddress& address);
+    
+protected:
+    
+    /**
+     @brief     Initialize the controller for a map.
+     @param     map         The map to fly to the results.
+     @param     addresses   The controller which displays an address the user picks.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(Map* map, AddressController* addresses);
+    
+    /**
+     @brief     Open the LandmarkPopup of the landmark picked from the search popup, once the map has flown to it.
+     */
+    void showSelectedLandmark();
+    
+private:
+    
+    /** The map to fly to the results, and the controller which displays an address the user picks. */
+    Map* m_Map;
+    AddressController* m_Addresses;
+    
+    /** The landmark most recently picked from the search popup, whose LandmarkPopup opens once the map has flown to it. */
+    LandmarkID m_SelectedLandmark;
+};
+
+#endif // LANDMARK_SEARCH_CONTROLLER_H
@@ -8,12 +8,42 @@
 
 #include "Map.h"
 #include "Defines.h"
+#include "TouchRouter.h"
 
 using namespace cocos2d;
 
 #define MIN_SCALE   (MAX(WIN_SIZE.width / getContentSize().width, WIN_SIZE.height / getContentSize().height)*2)
 #define MAX_SCALE   (SCREEN_SCALE * 2.5f)
 
+// The scale the map zooms to when flying to a point, and how long the flight takes in seconds.
+#define FLY_TO_SCALE    (SCREEN_SCALE * 1.5f)
+#define FLY_TO_DURATION 0.8f
+
+// The number of frames the map's performance counters are gathered over before being reported.
+#define FRAME_STATS_INTERVAL    120
+
+// How long after a frame is updated it is expected to be displayed, in seconds. Touches are predicted this far ahead when PREDICT_TOUCHES is enabled.
+#define TOUCH_PREDICTION_LEAD   (1.0 / 60)
+
+// The file in the app's writable directory that gestures are recorded to when RECORD_GESTURES is enabled.
+#define GESTURE_RECORDING_FILE  "gestures.txt"
+
+// The furthest a touch can move in points and the longest it can last in seconds while still counting as a tap.
+#define TAP_MAX_DISTANCE    (10 * SCREEN_SCALE)
+#define TAP_MAX_DURATION    0.3
+
+// Default constructor.
+
+Map::Map()
+: m_MapNode(NULL)
+, m_NearbyLandmarksDirty(true)
+, m_LandmarkLayer(NULL)
+, m_TapTouchID(-1)
+, m_TapStartTime(0)
+, m_Observer(NULL)
+{
+}
+
 // Create a Map instance with a target map node.
 
 Map* Map::create(CCNode* mapNode)
@@ -32,29 +62,94 @@ Map* Map::create(CCNode* mapNode)
 
 bool Map::init(CCNode *mapNode)
 {
-    // Listen for touch events.
-    CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(this, 0, false);
-    
     // Register and add the map node
     m_MapNode = mapNode;
     if (!m_MapNode->getParent()) addChild(m_MapNode);
     
     // Set the default spacial information for both the map and map node
     setContentSize(m_MapNode->getContentSize());
-    setAnchorPoint(m_MapNode->getAnchorPoint());
-    m_MapNode->setPosition(ccp(getContentSize().width * getAnchorPoint().x, getContentSize().height * getAnchorPoint().y));
+    m_MapNode->setPosition(ccp(getContentSize().width * m_MapNode->getAnchorPoint().x, getContentSize().height * m_MapNode->getAnchorPoint().y));
     m_MapNode->setVisible(true);
-    setScale((MIN_SCALE + MAX_SCALE) / 2);
+    
+    // Start with the map node's anchor point where the map has been positioned. From here on the map is positioned by its bottom-left corner, since the MapController zooms around the user's fingers itself.
+    MapTransform transform;
+    transform.scale = (MIN_SCALE + MAX_SCALE) / 2;
+    transform.offset = MapPoint(getPositionX() - getContentSize().width * m_MapNode->getAnchorPoint().x * transform.scale,
+                                getPositionY() - getContentSize().height * m_MapNode->getAnchorPoint().y * transform.scale);
+    setAnchorPoint(CCPointZero);
+    
+    GestureSetup setup;
+    setup.viewSize = MapPoint(WIN_SIZE.width, WIN_SIZE.height);
+    setup.contentSize = MapPoint(getContentSize().width, getContentSize().height);
+    setup.minScale = MIN_SCALE;
+    setup.maxScale = MAX_SCALE;
+    setup.transform = transform;
+    m_Controller.reset(setup.viewSize, setup.contentSize, setup.minScale, setup.maxScale, setup.transform, getCurrentTime());
+    m_Controller.setPrediction(PREDICT_TOUCHES, TOUCH_PREDICTION_LEAD);
+    
+    // Start a new recording, if recording is enabled. Each gesture is added to the file as it finishes.
+    if (RECORD_GESTURES)
+    {
+        m_Recording.reset(setup);
+        std::string path = CCFileUtils::sharedFileUtils()->getWritablePath() + GESTURE_RECORDING_FILE;
+        if (m_Recording.save(path.c_str()))
+        {
+            CCLOG("Recording gestures to \"%s\".", path.c_str());
+        }
+    }
+    
+    // Landmarks are only added once the map is set up, so start with none in the store.
+    LandmarkStore::sharedStore()->clear();
+    
+    // A subclass may only initialize the map once it is already in the node tree (ie. NewYorkMap, once its map node has loaded), in which case onEnter() has been and gone.
+    createLandmarkLayer();
+    
+    applyTransform();
+    m_FrameStats = MapFrameStats();
+    scheduleUpdate();
+    
+    // Listen for touch events.
+    TouchRouter::sharedRouter()->setHandler(kTouchLayerMap, this, false);
     
     return m_MapNode != NULL;
 }
 
+// Called when this is added to the node tree.
+
+void Map::onEnter()
+{
+    CCNode::onEnter();
+    createLandmarkLayer();
+}
+
+// Create the landmark layer in the map's parent, once the map is initialized and has one.
+
+void Map::createLandmarkLayer()
+{
+    if (!m_MapNode || !getParent() || m_LandmarkLayer)
+    {
+        return;
+    }
+    
+    // Display the landmarks in a layer beside the map rather than inside it, so that they aren't scaled along with it. Any landmarks added before it was created are picked up from the store. It goes above the map and below the buttons and labels that MapScene puts over both.
+    m_LandmarkLayer = LandmarkLayer::create(getContentSize(), WIN_SIZE, MIN_SCALE, MAX_SCALE);
+    if (!m_LandmarkLayer)
+    {
+        CCLOG("Failed to create the landmark layer.");
+        return;
+    }
+    m_LandmarkLayer->setObserver(this);
+    m_LandmarkLayer->landmarksChanged();
+    m_LandmarkLayer->setMapTransform(m_Controller.getTransform());
+    getParent()->addChild(m_LandmarkLayer, getZOrder() + 1);
+}
+
 // Called when this is removed from the node tree.
 
 void Map::onExit()
 {
-    // Unregister from the touch dispatcher.
-    CCDirector::sharedDirector()->getTouchDispatcher()->removeDelegate(this);
+    // Unregister from the touch router.
+    TouchRouter::sharedRouter()->removeHandler(this);
     
     // Call the base class's onExit()
     CCNode::onExit();
@@ -64,36 +159,37 @@ void Map::onExit()
 
 bool Map::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
 {
-    // If we aren't already tracking 2 touches, track this one. Otherwise ignore this touch.
-    if (!m_Touches[0])
+    // If we aren't already tracking 2 touches, track this one. Otherwise ignore this touch. Tracking a touch also stops the map where it is, giving the appearance that the user's finger is holding it still.
+    CCPoint location = pTouch->getLocation();
+    double time = getCurrentTime();
+    bool wasAnimating = m_Controller.isAnimating();
+    if (!m_Controller.touchBegan(pTouch->getID(), MapPoint(location.x, location.y), time))
     {
-        m_Touches[0] = pTouch;
+        return false;
     }
-    else if (!m_Touches[1])
+    
+    // A lone touch may be a tap for an address, unless it only caught the map while it was still moving. A second touch makes the gesture a pinch instead.
+    if (m_Controller.getTouchCount() == 1 && !wasAnimating)
     {
-        m_Touches[1] = pTouch;
+        m_TapTouchID = pTouch->getID();
+        m_TapStartLocation = MapPoint(location.x, location.y);
+        m_TapStartTime = time;
     }
     else
     {
-        return false;
+        m_TapTouchID = -1;
     }
     
-    // Cancel any CCActions currently being run to give the appearance that the user's finger is holding the map still.
-    stopAllActions();
+    if (RECORD_GESTURES) m_Recording.addEvent(kGestureEventBegan, time, pTouch->getID(), MapPoint(location.x, location.y));
+    m_FrameStats.touchSamples++;
     
-    // If we are only tracking one touch, set up for panning logic.
-    if (setUpForPanning())
+    if (DISPLAY_TOUCH_MESSAGES)
     {
-        if (DISPLAY_TOUCH_MESSAGES)
+        if (m_Controller.getTouchCount() == 1)
         {
             CCLOG("New touch detected and being used for panning.");
         }
-    }
-    
-    // If we are tracking two touches, set up for zooming logic.
-    else if (setUpForZooming())
-    {
-        if (DISPLAY_TOUCH_MESSAGES)
+        else
         {
             CCLOG("New touch detected and being used for zooming in combination with the previous touch.");
         }
@@ -106,67 +202,60 @@ bool Map::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
  
 void Map::ccTouchMoved(CCTouch *pTouch, CCEvent *pEvent)
 {
-    // If we are only tracking one touch then pan the map based on the touch position.
-    if ((m_Touches[0] && !m_Touches[1]) || (!m_Touches[0] && m_Touches[1]))
-    {
-        // Move the map to its new position.
-        unsigned char touchID = m_Touches[0] ? 0 : 1;
-        setPosition(ccpAdd(m_MapNodeStartPosition, ccpSub(m_Touches[touchID]->getLocation(), m_TouchStartPositions[touchID])));
-    }
+    // Pan the map with one touch, or zoom it with two. Several moves can arrive within one frame during a pinch, so the transform is only applied once the frame is drawn.
+    CCPoint location = pTouch->getLocation();
+    double time = getCurrentTime();
+    m_Controller.touchMoved(pTouch->getID(), MapPoint(location.x, location.y), time);
     
-    // If we are tracking two touches, zoom in or out based on their positions relative to each other.
-    else if (m_Touches[0] && m_Touches[1])
+    if (pTouch->getID() == m_TapTouchID && m_TapStartLocation.distance(MapPoint(location.x, location.y)) > TAP_MAX_DISTANCE)
     {
-        // Compare the original distance between the two touches and their original distance to find out how far zoomed in / out we should be.
-        float originalDistance = ccpDistance(m_TouchStartPositions[0], m_TouchStartPositions[1]);
-        float currentDistance = ccpDistance(m_Touches[0]->getLocation(), m_Touches[1]->getLocation());
-        float scaleFactor = currentDistance / originalDistance;
-        
-        // Scale the map based on the value we just calculated.
-        setScale(m_MapNodeStartScale * scaleFactor);
-        
-        // Set hard limits on the scale.
-        setScale(clampf(getScale(), MIN_SCALE/2, MAX_SCALE*2));
-        
-        // Also scale all of the landmarks.
-        maintainScaleOfLandmarks();
-        
-        // Also pan the view based on the midpoint of the two touches.
-        CCPoint originalMidpoint = ccpMidpoint(m_TouchStartPositions[0], m_TouchStartPositions[1]);
-        CCPoint currentMidpoint = ccpMidpoint(m_Touches[0]->getLocation(), m_Touches[1]->getLocation());
-        setPosition(ccpAdd(m_MapNodeStartPosition, ccpSub(currentMidpoint, originalMidpoint)));
+        m_TapTouchID = -1;
     }
+    
+    if (RECORD_GESTURES) m_Recording.addEvent(kGestureEventMoved, time, pTouch->getID(), MapPoint(location.x, location.y));
+    m_FrameStats.touchSamples++;
 }
 
 // Respond to the end of a user's touch.
 
 void Map::ccTouchEnded(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent)
 {
-    // Clear this touch from our tracked touches.
-    if (pTouch == m_Touches[0])
-    {
-        m_Touches[0] = NULL;
-    }
-    else if (pTouch == m_Touches[1])
+    // If another touch remains it carries on panning; otherwise the map keeps the gesture's momentum and springs back inside its limits.
+    CCPoint location = pTouch->getLocation();
+    double time = getCurrentTime();
+    m_Controller.touchEnded(pTouch->getID(), MapPoint(location.x, location.y), time);
+    m_FrameStats.touchSamples++;
+    
+    // A touch which barely moved and was quickly lifted is a tap, which the observer is told about (ie. to look up the address under it).
+    if (pTouch->getID() == m_TapTouchID)
     {
-        m_Touches[1] = NULL;
+        m_TapTouchID = -1;
+        MapPoint tapLocation(location.x, location.y);
+        if (m_Observer && time - m_TapStartTime <= TAP_MAX_DURATION && m_TapStartLocation.distance(tapLocation) <= TAP_MAX_DISTANCE)
+        {
+            m_Observer->mapTapped(tapLocation);
+        }
     }
     
-    // In the event that we are still tracking another touch, set up to use it for panning.
-    if (setUpForPanning())
+    // Once the whole gesture has finished, add it to the recording's file.
+    if (RECORD_GESTURES)
     {
-        if (DISPLAY_TOUCH_MESSAGES)
+        m_Recording.addEvent(kGestureEventEnded, time, pTouch->getID(), MapPoint(location.x, location.y));
+        if (m_Controller.getTouchCount() == 0)
         {
-            CCLOG("A touch ended, and the remaining touch is now being used for panning.");
+            std::string path = CCFileUtils::sharedFileUtils()->getWritablePath() + GESTURE_RECORDING_FILE;
+            m_Recording.appendEvents(path.c_str());
+            m_Recording.clearEvents();
         }
     }
     
-    // If all tracked touches have now ended, check the map's transform and snap it back into place if need be.
-    else
+    if (DISPLAY_TOUCH_MESSAGES)
     {
-        snapMapToTransformLimitations();
-        
-        if (DISPLAY_TOUCH_MESSAGES)
+        if (m_Controller.getTouchCount() == 1)
+        {
+            CCLOG("A touch ended, and the remaining touch is now being used for panning.");
+        }
+        else
         {
             CCLOG("All recorded touches have ended.");
         }
@@ -177,135 +266,174 @@ void Map::ccTouchEnded(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent)
 
 void Map::ccTouchCancelled(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent)
 {
-    // End the lost touch the same way we would normally end a touch.
+    // End the lost touch the same way we would normally end a touch, except that it can't be a tap.
+    if (pTouch->getID() == m_TapTouchID)
+    {
+        m_TapTouchID = -1;
+    }
     ccTouchEnded(pTouch, pEvent);
 }
 
+// Run the map's motion up to the current time and display the result.
 
-// Record any necessary information in anticipation of panning.
-
-bool Map::setUpForPanning()
+void Map::update(float delta)
 {
-    // We must be tracking one and only one touch for this method to succeed, so return immediately otherwise.
-    if ((m_Touches[0] && m_Touches[1]) || (!m_Touches[0] && !m_Touches[1]))
+    // Apply the latest state once per frame, however many touch samples arrived since the last one (see Tools/MapControllerCheck.cpp).
+    if (m_Controller.updateFrame(getCurrentTime()))
     {
-        return false;
+        applyTransform();
     }
     
-    // Record all information required for the panning logic.
-    unsigned char touchID = m_Touches[0] ? 0 : 1;
-    m_MapNodeStartPosition = getPosition();
-    m_TouchStartPositions[touchID] = m_Touches[touchID]->getLocation();
-    
-    return true;
+    // Report how much work the map did per displayed frame.
+    m_FrameStats.frames++;
+    if (m_FrameStats.frames >= FRAME_STATS_INTERVAL)
+    {
+        if (DISPLAY_PERFORMANCE_MESSAGES)
+        {
+            CCLOG("Map over %u frames: %u touch samples, %u transform updates, %u landmark projections.",
+                  m_FrameStats.frames, m_FrameStats.touchSamples, m_FrameStats.transformUpdates, m_FrameStats.landmarkProjections);
+        }
+        m_FrameStats = MapFrameStats();
+    }
 }
 
-// Record any necessary information in anticipation of zooming.
- 
-bool Map::setUpForZooming()
+// Move and scale the map to the MapController's current transform.
+
+void Map::applyTransform()
 {
-    // We must be tracking two touches for this method to succeed, so return immediately otherwise.
-    if (!m_Touches[0] || !m_Touches[1])
+    MapTransform transform = m_Controller.getTransform();
+    setPosition(ccp(transform.offset.x, transform.offset.y));
+    m_FrameStats.transformUpdates++;
+    
+    // The landmarks only need to be projected again when the scale actually changes.
+    if (transform.scale != getScale())
     {
-        return false;
+        setScale(transform.scale);
+        m_FrameStats.landmarkProjections++;
     }
     
-    // Move the anchor point of the map directly between the user's fingers so that zooming occurs in and out of that point.
-    CCPoint oldAnchorPoint = getAnchorPoint();
-    setAnchorPoint(getAnchorPointFromLocation(ccpMidpoint(m_Touches[0]->getLocation(), m_Touches[1]->getLocation())));
-    
-    // Adjust the position of the map to avoid an awkward jerk after changing the anchor point.
-    setPosition(ccpAdd(getPosition(),
-                                  ccpSub(ccp(getContentSize().width * getScale() * getAnchorPoint().x,
-                                             getContentSize().height * getScale() * getAnchorPoint().y),
-                                         ccp(getContentSize().width * getScale() * oldAnchorPoint.x,
-                                             getContentSize().height * getScale() * oldAnchorPoint.y))));
-    
-    // Record all information required for the zooming logic.
-    m_MapNodeStartPosition = getPosition();
-    m_MapNodeStartScale = getScale();
-    m_TouchStartPositions[0] = m_Touches[0]->getLocation();
-    m_TouchStartPositions[1] = m_Touches[1]->getLocation();
-    
+    if (m_LandmarkLayer) m_LandmarkLayer->setMapTransform(transform);
+}
+
+// Add a new landmark to the map.
+
+bool Map::addLandmark(const Landmark& landmark, CCPoint coords)
+{
+    // The landmark layer only creates a button for the landmark while it is displayed.
+    LandmarkStore::sharedStore()->add(landmark, MapPoint(getContentSize().width*coords.x, getContentSize().height*coords.y));
+    if (m_LandmarkLayer) m_LandmarkLayer->landmarksChanged();
+    m_NearbyLandmarksDirty = true;
     return true;
 }
 
-// Translate a point on-screen (for example, a touch location) into an anchor point for the map node.
+// Replace the map's landmarks with those of a catalog file, which the shared LandmarkStore keeps mapped.
 
-CCPoint Map::getAnchorPointFromLocation(CCPoint location)
+bool Map::loadLandmarkCatalog(const char* path)
 {
-    CCPoint anchorPoint = convertToNodeSpace(location);
-    anchorPoint = ccp(anchorPoint.x / getContentSize().width, anchorPoint.y / getContentSize().height);
-    return anchorPoint;
+    bool isLoaded = LandmarkStore::sharedStore()->openCatalog(path, MapPoint(getContentSize().width, getContentSize().height));
+    if (m_LandmarkLayer) m_LandmarkLayer->landmarksChanged();
+    m_NearbyLandmarksDirty = true;
+    return isLoaded;
 }
 
-// If the map is outside of its boundaries, snap it back smoothly.
- 
-void Map::snapMapToTransformLimitations()
+// Calibrate the projection from latitudes and longitudes to the map.
+
+bool Map::setCalibration(const MapCalibrationPoint* points, unsigned int count)
 {
-    // The length of time the snap should take.
-    const float snapTime = 0.2f;
-    
-    // Scale the up or down to be within its scaling bounds, keeping track of the final for use in the positioning logic.
-    float snappedScale = getScale();
-    if (getScale() < MIN_SCALE)
+    std::vector<MapCalibrationPoint> scaledPoints(points, points + count);
+    for (unsigned int i = 0; i < count; i++)
     {
-        snappedScale = MIN_SCALE;
+        scaledPoints[i].position = MapPoint(getContentSize().width*points[i].position.x, getContentSize().height*points[i].position.y);
     }
-    if (getScale() > MAX_SCALE)
+    
+    if (count < 3 || !m_Projection.calibrate(&scaledPoints[0], count))
     {
-        snappedScale = MAX_SCALE;
+        return false;
     }
-    runAction(CCEaseOut::create(CCScaleTo::create(snapTime, snappedScale), 3));
-    
-    // Also scale all of the landmarks.
-    maintainScaleOfLandmarks(snapTime, ccp(snappedScale, snappedScale));
-    
-    // Figure out distance to move by.
-    CCPoint distanceToMove;
-    
-    // Add the map's distance out-of-bounds on the top to the distanceToMove.
-    distanceToMove.y += MAX(WIN_SIZE.height - (getPositionY()+getContentSize().height*snappedScale*(1-getAnchorPoint().y)), 0);
-    
-    // Add the map's distance out-of-bounds on the bottom to the distanceToMove.
-    distanceToMove.y -= MAX(getPositionY()-getContentSize().height*snappedScale*getAnchorPoint().y, 0);
-    
-    // Add the map's distance out-of-bounds on the left side to the distanceToMove.
-    distanceToMove.x -= MAX(getPositionX()-getContentSize().width*snappedScale*getAnchorPoint().x, 0);
     
-    // Add the map's distance out-of-bounds on the right side to the distanceToMove.
-    distanceToMove.x += MAX(WIN_SIZE.width - (getPositionX()+getContentSize().width*snappedScale*(1-getAnchorPoint().x)), 0);
-    
-    // Move the map by the distance we calculated.
-    runAction(CCEaseOut::create(CCMoveBy::create(snapTime, distanceToMove), 3));
+    CCLOG("The map was calibrated to %u points, which are %.0f metres from where a uniform map would have them on average.", count, m_Projection.getError());
+    return true;
 }
 
-// Add a new landmark to the map.
+// Find the landmarks nearest to a location on the Earth.
 
-bool Map::addLandmark(Landmark landmark, CCPoint coords)
+void Map::findNearbyLandmarks(const GeoPoint& location, unsigned int count, float radius, std::vector<LandmarkID>* landmarks)
 {
-    LandmarkButton* button = LandmarkButton::create(landmark);
-    
-    if (button)
+    // The index is only built when it is first needed after landmarks are added, rather than once for every landmark.
+    if (m_NearbyLandmarksDirty)
     {
-        addChild(button);
-        button->setPosition(ccp(getContentSize().width*coords.x, getContentSize().height*coords.y));
-        button->maintainOriginalScale();
-        m_LandmarkButtons.push_back(button);
-        return true;
-    }
-    else
-    {
-        return false;
+        m_NearbyLandmarks.build(LandmarkStore::sharedStore()->getPositions());
+        m_NearbyLandmarksDirty = false;
     }
+    
+    // LandmarkIDs are the landmarks' indices in the store, which the index numbers them by.
+    float mapRadius = (radius < 0) ? radius : radius * m_Projection.getUnitsPerMetre();
+    m_NearbyLandmarks.findNearest(m_Projection.project(location), count, mapRadius, landmarks);
 }
 
-// Set all of the landmarks on the map to their original scale.
+// Fly the map to a point, zooming in on it.
 
-void Map::maintainScaleOfLandmarks(float duration, cocos2d::CCPoint futureScale)
+void Map::flyTo(CCPoint coords)
 {
-    for (int landmarkIt = 0; landmarkIt < m_LandmarkButtons.size(); landmarkIt++)
-    {
-        m_LandmarkButtons[landmarkIt]->maintainOriginalScale(duration, futureScale);
-    }
+    flyToPosition(MapPoint(getContentSize().width*coords.x, getContentSize().height*coords.y));
+}
+
+// Fly the map to a point in map space, zooming in on it.
+
+void Map::flyToPosition(const MapPoint& position)
+{
+    m_Controller.flyTo(position, FLY_TO_SCALE, FLY_TO_DURATION, getCurrentTime());
+}
+
+// Fly the map out far enough to see an area of it.
+
+void Map::flyToArea(const MapPoint& minimum, const MapPoint& maximum)
+{
+    // Leave a margin around the area.
+    MapPoint size = maximum - minimum;
+    float scale = MIN(WIN_SIZE.width * 0.8f / MAX(size.x, 1.0f), WIN_SIZE.height * 0.6f / MAX(size.y, 1.0f));
+    scale = MAX(MIN(scale, FLY_TO_SCALE), MIN_SCALE);
+    m_Controller.flyTo((minimum + maximum) * 0.5f, scale, FLY_TO_DURATION, getCurrentTime());
+}
+
+// Get how long the map's flights take in seconds.
+
+float Map::getFlightDuration()
+{
+    return FLY_TO_DURATION;
+}
+
+// Get the point of the map under a point on the screen.
+
+MapPoint Map::getMapPosition(const MapPoint& location) const
+{
+    // Undo the map's transform.
+    MapTransform transform = m_Controller.getTransform();
+    return (location - transform.offset) * (1 / transform.scale);
+}
+
+// Get the area of the map on screen.
+
+void Map::getVisibleArea(MapPoint* minimum, MapPoint* maximum) const
+{
+    *minimum = getMapPosition(MapPoint(0, 0));
+    *maximum = getMapPosition(MapPoint(WIN_SIZE.width, WIN_SIZE.height));
+}
+
+// Fly in on a cluster of landmarks until it splits apart.
+
+void Map::landmarkClusterPressed(const MapPoint& position, float scale)
+{
+    // Never zoom out when tapping a cluster, and keep the flight inside the scale limits.
+    scale = MIN(MAX(scale, m_Controller.getTransform().scale), MAX_SCALE);
+    m_Controller.flyTo(position, scale, FLY_TO_DURATION, getCurrentTime());
+}
+
+// Get the current time in seconds, used to timestamp touches and frames and to time work done for the map.
+
+double Map::getCurrentTime()
+{
+    struct cc_timeval now;
+    CCTime::gettimeofdayCocos2d(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
 }
@@ -12,15 +12,40 @@
 #include "cocos2d.h"
 #include <vector.h>
 #include "Landmark.h"
-#include "LandmarkButton.h"
+#include "LandmarkKDTree.h"
+#include "LandmarkLayer.h"
+#include "MapController.h"
+#include "MapProjection.h"
+#include "GestureRecording.h"
 
 /**
- @brief    A controller which manages the behaviour of and interaction with nodes that represent a map.
+ @brief     An interface for being told when the user taps the map.
  */
-class Map : public cocos2d::CCNode, public cocos2d::CCTouchDelegate
+class MapObserver
 {
 public:
     
+    /**
+     @brief     Called when the user taps the map, rather than panning or zooming it.
+     @param     location    The tapped point on the screen.
+     */
+    virtual void mapTapped(const MapPoint& location) = 0;
+};
+
+/**
+ @brief    A controller which pans and zooms the nodes that represent a map, and displays its landmarks beside it.
+
+ The features built on top of the map (searching and filtering the landmarks, addresses, directions and tours) are controller nodes of their own, which MapScene creates alongside the map and the buttons that open them. They move the map through its flights and read its transform and projection, and are told when it is tapped through its MapObserver.
+ */
+class Map : public cocos2d::CCNode, public cocos2d::CCTouchDelegate, public LandmarkLayerObserver
+{
+public:
+    
+    /**
+     @brief     Default constructor. The map is empty until it is initialized with its map node.
+     */
+    Map();
+    
     /**
      @brief     Create a Map instance with a target map node.
      @param     mapNode     The node which visually represents the map.
@@ -59,11 +84,107 @@ public:
     
     /**
      @brief     Add a new landmark to the map.
-     @param     landmark    The landmark data to be displayed.
+     @param     landmark    The landmark data to be displayed. It is copied into the shared LandmarkStore, so its strings only need to stay valid for the duration of the call.
      @param     coords      The landmark's position on the map (ranging from bottom-left (0,0) to top-right (1,1)).
      @return    Whether or not the landmark was added successfully.
      */
-    bool addLandmark(Landmark landmark, cocos2d::CCPoint coords);
+    bool addLandmark(const Landmark& landmark, cocos2d::CCPoint coords);
+    
+    /**
+     @brief     Replace the map's landmarks with those of a catalog file (see LandmarkCatalog), which the shared LandmarkStore keeps mapped and reads their strings from in place.
+     @param     path        The full path of the catalog file.
+     @return    Whether or not the file was a valid catalog. If not, the map is left without landmarks.
+     */
+    bool loadLandmarkCatalog(const char* path);
+    
+    /**
+     @brief     Calibrate the projection from latitudes and longitudes to the map against places whose positions on both are known.
+     @param     points      The calibration points, with positions on the map ranging from bottom-left (0,0) to top-right (1,1).
+     @param     count       The number of calibration points, which must be at least 3.
+     @return    Whether or not the projection could be calibrated.
+     */
+    bool setCalibration(const MapCalibrationPoint* points, unsigned int count);
+    
+    /**
+     @brief     Get the projection from latitudes and longitudes to map space.
+     */
+    const MapProjection& getProjection() const { return m_Projection; }
+    
+    /**
+     @brief     Find the landmarks nearest to a location on the Earth (ie. the user's), quickly enough to be called on every location update.
+     @param     location    The location to search around.
+     @param     count       The most landmarks to find.
+     @param     radius      How far from the location to search in metres, or a negative number to search the whole map.
+     @param     landmarks   Receives the IDs of the landmarks that were found, nearest first. Existing contents are replaced.
+     */
+    void findNearbyLandmarks(const GeoPoint& location, unsigned int count, float radius, std::vector<LandmarkID>* landmarks);
+    
+    /**
+     @brief     Fly the map to a point (ie. a landmark), zooming in on it. The map and the landmarks follow the flight together, and touching the map stops it.
+     @param     coords      The point's position on the map (ranging from bottom-left (0,0) to top-right (1,1)).
+     */
+    void flyTo(cocos2d::CCPoint coords);
+    
+    /**
+     @brief     Fly the map to a point in map space, zooming in on it.
+     @param     position    The point's position in map space.
+     */
+    void flyToPosition(const MapPoint& position);
+    
+    /**
+     @brief     Fly the map out far enough to see an area of it, but no further in than a flight to a point would zoom.
+     @param     minimum     The bottom-left corner of the area in map space.
+     @param     maximum     The top-right corner of the area in map space.
+     */
+    void flyToArea(const MapPoint& minimum, const MapPoint& maximum);
+    
+    /**
+     @brief     Get how long the map's flights take in seconds, ie. to wait until the map has arrived.
+     */
+    static float getFlightDuration();
+    
+    /**
+     @brief     Get the point of the map under a point on the screen, at the current transform.
+     @param     location    The point on the screen.
+     @return    The point in map space.
+     */
+    MapPoint getMapPosition(const MapPoint& location) const;
+    
+    /**
+     @brief     Get the area of the map on screen, at the current transform.
+     @param     minimum     Set to the bottom-left corner of the area in map space.
+     @param     maximum     Set to the top-right corner of the area in map space.
+     */
+    void getVisibleArea(MapPoint* minimum, MapPoint* maximum) const;
+    
+    /**
+     @brief     Get the layer displaying the landmarks beside the map, or NULL until the map is initialized and has a parent.
+     */
+    LandmarkLayer* getLandmarkLayer() const { return m_LandmarkLayer; }
+    
+    /**
+     @brief     Set the object which is told when the user taps the map.
+     @param     observer    The observer, or NULL for none.
+     */
+    void setObserver(MapObserver* observer) { m_Observer = observer; }
+    
+    /**
+     @brief     Get the object which is told when the user taps the map, or NULL if there is none.
+     */
+    MapObserver* getObserver() const { return m_Observer; }
+    
+    /**
+     @brief     Fly in on a cluster of landmarks until it splits apart.
+     @param     position    The cluster's position in map space.
+     @param     scale       The scale at which the cluster is fully split into its parts.
+     */
+    void landmarkClusterPressed(const MapPoint& position, float scale);
+    
+    /**
+     @brief     Get the current time in seconds, used to timestamp touches and frames for the MapController, and by the map's controllers to time their work.
+     @return    The current time.
+     */
+    static double getCurrentTime();
     
 protected:
     
@@ -75,56 +196,62 @@ protected:
     bool init(cocos2d::CCNode* mapNode);
     
     /**
-     @brief     Called when this is removed from the node tree.
+     @brief     Called when this is added to the node tree.
      */
-    void onExit();
+    void onEnter();
     
     /**
-     @brief     Record any necessary information in anticipation of panning.
-     @return    Whether or not the conditions for panning were met; this method will only succeed if we are tracking exactly one touch.
+     @brief     Create the landmark layer and add it to the map's parent, so that the landmarks are displayed beside the map rather than scaled along with it. Does nothing until the map is initialized and has a parent, or once the layer has been created.
      */
-    bool setUpForPanning();
+    void createLandmarkLayer();
     
     /**
-     @brief     Record any necessary information in anticipation of zooming.
-     @return    Whether or not the conditions for zooming were met; this method will only succeed if we are tracking two touches.
-     */
-    bool setUpForZooming();
-    
-    /**
-     @brief     Translate a point on-screen (for example, a touch location) into an anchor point for the map node.
-     @param     location    The on-screen position to be translated.
-     @return    The resulting anchor point.
+     @brief     Called when this is removed from the node tree.
      */
-    cocos2d::CCPoint getAnchorPointFromLocation(cocos2d::CCPoint location);
+    void onExit();
     
     /**
-     @brief     If the map is outside of its boundaries, snap it back smoothly.
+     @brief     Run the map's motion up to the current time and display the result. Called once per frame.
+     @param     delta       The time in seconds since the last frame.
      */
-    void snapMapToTransformLimitations();
+    virtual void update(float delta);
     
     /**
-     @brief     Set all of the landmarks on the map to their original scale.
-     @param     duration    How long in seconds it should take for the landmarks to scale.
-     @param     futureScale The scale that the Map is expected to be at at the end of the duration (use 0,0 for current).
+     @brief     Move and scale the map to the MapController's current transform.
      */
-    void maintainScaleOfLandmarks(float duration = 0.0f, cocos2d::CCPoint futureScale = cocos2d::CCPointZero);
+    void applyTransform();
     
 private:
     
     /** The node which visually represents the map. */
     cocos2d::CCNode* m_MapNode;
     
-    /** Pointers to the touch input data (we only care about 2 touches at once, so that's all we store). */
-    cocos2d::CCTouch* m_Touches[2];
+    /** The physics which turn touches into the map's motion. */
+    MapController m_Controller;
+    
+    /** The touches on the map which have not been written to the recording's file yet. Only used when RECORD_GESTURES is enabled. */
+    GestureRecording m_Recording;
+    
+    /** The work done by the map since the last report. */
+    MapFrameStats m_FrameStats;
+    
+    /** The projection from latitudes and longitudes to map space. */
+    MapProjection m_Projection;
+    
+    /** The landmarks' positions indexed for finding those nearest to a location, and whether landmarks have been added since it was built. */
+    LandmarkKDTree m_NearbyLandmarks;
+    bool m_NearbyLandmarksDirty;
+    
+    /** The screen-space layer displaying the landmarks on the map as buttons which can be pressed to get more information. It is a sibling of the map, created once the map has a parent and NULL until then. */
+    LandmarkLayer* m_LandmarkLayer;
     
-    /** Positional data used to calculate panning and zooming. */
-    cocos2d::CCPoint m_MapNodeStartPosition;
-    float m_MapNodeStartScale;
-    cocos2d::CCPoint m_TouchStartPositions[2];
+    /** The touch which may turn out to be a tap, or -1 if there is none, along with where and when it began. */
+    int m_TapTouchID;
+    MapPoint m_TapStartLocation;
+    double m_TapStartTime;
     
-    /** A collection of landmarks being displayed on the map as buttons which can be pressed to get more information. */
-    std::vector<LandmarkButton*> m_LandmarkButtons;
+    /** The object told when the user taps the map. */
+    MapObserver* m_Observer;
 };
 
 #endif // MAP_H
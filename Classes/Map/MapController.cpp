@@ -0,0 +1,681 @@
+//
+//  MapController.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-27.
+//
+//
+
+#include "MapController.h"
+
+const double MapController::TIME_STEP = 1.0 / 120;
+
+// The most simulation steps run by a single advance. Longer gaps (ie. returning from the background) are skipped rather than replayed.
+static const int MAX_STEPS_PER_ADVANCE = 30;
+
+// How quickly coasting slows down, as a fraction of velocity lost per second (exponentially).
+static const float PAN_FRICTION = 3.0f;
+static const float ZOOM_FRICTION = 6.0f;
+
+// The stiffness of the spring which pulls the map back inside its limits. It is critically damped so that it never overshoots.
+static const float SPRING_STIFFNESS = 150.0f;
+
+// Below these speeds the map is considered to be at rest.
+static const float MIN_PAN_SPEED = 5.0f;
+static const float MIN_ZOOM_SPEED = 0.01f;
+
+// The fastest the map can be flung, in view units per second and in log scale per second.
+static const float MAX_PAN_SPEED = 8000.0f;
+static const float MAX_ZOOM_SPEED = 8.0f;
+
+// Only samples this recent are used to measure the velocity of a released gesture.
+static const double VELOCITY_WINDOW = 0.1;
+
+// A pinch's momentum survives one finger lifting slightly before the other, as long as the second lifts within this time.
+static const double PINCH_RELEASE_WINDOW = 0.15;
+
+// How strongly dragging past the limits is resisted (smaller is stiffer).
+static const float RESISTANCE = 0.55f;
+
+// The scale can be pinched past its limits by up to this factor.
+static const float SCALE_OVERSHOOT = 2.0f;
+
+// How close to a limit the map must be for a spring-back to finish.
+static const float SETTLE_DISTANCE = 0.5f;
+
+// Reduce an overshoot past a limit so that it approaches [range] the further it is dragged.
+
+static float resist(float overshoot, float range)
+{
+    return (1 - 1 / (overshoot * RESISTANCE / range + 1)) * range;
+}
+
+// Recover an overshoot from its resisted value.
+
+static float unresist(float resisted, float range)
+{
+    // Resisted values approach the range but never reach it, so anything at or beyond it is as far as it can go.
+    float fraction = resisted / range;
+    if (fraction >= 0.999f) fraction = 0.999f;
+    return (range / RESISTANCE) * (1 / (1 - fraction) - 1);
+}
+
+// Apply (or undo) resistance to a value along one axis, given the range it is meant to stay within.
+
+static float resistAxis(float value, float minimum, float maximum, float range, bool undo)
+{
+    if (value > maximum)
+    {
+        return maximum + (undo ? unresist(value - maximum, range) : resist(value - maximum, range));
+    }
+    if (value < minimum)
+    {
+        return minimum - (undo ? unresist(minimum - value, range) : resist(minimum - value, range));
+    }
+    return value;
+}
+
+// Clamp a value to a symmetric range.
+
+static float clampMagnitude(float value, float limit)
+{
+    return (value > limit) ? limit : ((value < -limit) ? -limit : value);
+}
+
+// Advance a value by one step, either slowing it with friction or (if it is outside its limits) pulling it back with a spring.
+
+static void stepAxis(float* value, float* velocity, float minimum, float maximum, float friction, float minSpeed, float settleDistance, float dt)
+{
+    float target = (*value > maximum) ? maximum : ((*value < minimum) ? minimum : *value);
+
+    if (target != *value)
+    {
+        float acceleration = -SPRING_STIFFNESS * (*value - target) - 2 * sqrtf(SPRING_STIFFNESS) * *velocity;
+        *velocity += acceleration * dt;
+        *value += *velocity * dt;
+
+        if (fabsf(*value - target) < settleDistance && fabsf(*velocity) < minSpeed * 10)
+        {
+            *value = target;
+            *velocity = 0;
+        }
+    }
+    else if (*velocity != 0)
+    {
+        *velocity *= expf(-friction * dt);
+        *value += *velocity * dt;
+
+        if (fabsf(*velocity) < minSpeed)
+        {
+            *velocity = 0;
+        }
+    }
+}
+
+// Default constructor.
+
+MapController::MapController()
+: m_MinScale(1)
+, m_MaxScale(1)
+, m_Interpolation(0)
+, m_Time(0)
+, m_SampleCount(0)
+, m_NextSample(0)
+, m_ZoomVelocity(0)
+, m_PendingZoomVelocity(0)
+, m_PendingZoomTime(0)
+, m_TransformChanged(false)
+, m_PredictionEnabled(false)
+, m_PredictionLead(0)
+, m_HasPrediction(false)
+, m_Flying(false)
+, m_FlightStartTime(0)
+, m_FlightDuration(0)
+{
+    m_Current.scale = 1;
+    m_Previous = m_Current;
+    m_GestureStart = m_Current;
+
+    for (int i = 0; i < MAX_TOUCHES; i++)
+    {
+        m_Touches[i].active = false;
+    }
+}
+
+// Set the sizes and limits the map is constrained by, and place it at rest.
+
+void MapController::reset(const MapPoint& viewSize, const MapPoint& contentSize, float minScale, float maxScale, const MapTransform& transform, double time)
+{
+    m_ViewSize = viewSize;
+    m_ContentSize = contentSize;
+    m_MinScale = minScale;
+    m_MaxScale = maxScale;
+
+    m_Current = transform;
+    m_Previous = transform;
+    m_GestureStart = transform;
+    m_Interpolation = 0;
+    m_Time = time;
+
+    for (int i = 0; i < MAX_TOUCHES; i++)
+    {
+        m_Touches[i].active = false;
+    }
+
+    m_SampleCount = 0;
+    m_NextSample = 0;
+    m_PanVelocity = MapPoint();
+    m_ZoomVelocity = 0;
+    m_PendingZoomVelocity = 0;
+    m_TransformChanged = false;
+    m_HasPrediction = false;
+    m_Flying = false;
+}
+
+// Set whether or not the map follows where the touches are predicted to be.
+
+void MapController::setPrediction(bool enabled, double lead)
+{
+    m_PredictionEnabled = enabled;
+    m_PredictionLead = (lead > 0) ? lead : 0;
+    m_HasPrediction = false;
+}
+
+// Respond to the beginning of a touch.
+
+bool MapController::touchBegan(int touchID, const MapPoint& location, double time)
+{
+    int slot = findTouch(touchID);
+    for (int i = 0; slot < 0 && i < MAX_TOUCHES; i++)
+    {
+        if (!m_Touches[i].active)
+        {
+            slot = i;
+        }
+    }
+
+    if (slot < 0)
+    {
+        return false;
+    }
+
+    advance(time);
+
+    // A touch catches the map, stopping any coasting, spring-back or flight where it is.
+    m_PanVelocity = MapPoint();
+    m_ZoomVelocity = 0;
+    m_PendingZoomVelocity = 0;
+    m_Flying = false;
+
+    m_Touches[slot].active = true;
+    m_Touches[slot].touchID = touchID;
+    m_Touches[slot].start = location;
+    m_Touches[slot].current = location;
+    m_Touches[slot].predictor.reset(location, time);
+
+    restartGesture(time);
+    m_TransformChanged = true;
+    return true;
+}
+
+// Respond to a touch moving.
+
+void MapController::touchMoved(int touchID, const MapPoint& location, double time)
+{
+    int slot = findTouch(touchID);
+    if (slot < 0)
+    {
+        return;
+    }
+
+    advance(time);
+    m_Touches[slot].current = location;
+    m_Touches[slot].predictor.addSample(location, time);
+    applyGesture(time);
+    m_TransformChanged = true;
+}
+
+// Respond to the end (or loss) of a touch.
+
+void MapController::touchEnded(int touchID, const MapPoint& location, double time)
+{
+    int slot = findTouch(touchID);
+    if (slot < 0)
+    {
+        return;
+    }
+
+    advance(time);
+    m_Touches[slot].current = location;
+    applyGesture(time);
+    m_TransformChanged = true;
+
+    MapPoint panVelocity;
+    float zoomVelocity;
+    measureVelocity(&panVelocity, &zoomVelocity);
+
+    // If this ends a pinch, remember its zoom velocity in case the other finger lifts straight afterwards.
+    if (getTouchCount() == 2)
+    {
+        m_PendingZoomVelocity = zoomVelocity;
+        m_PendingZoomPivot = (m_Touches[0].current + m_Touches[1].current) * 0.5f;
+        m_PendingZoomTime = time;
+    }
+
+    m_Touches[slot].active = false;
+
+    // When the last touch lifts, the map keeps the gesture's momentum.
+    if (getTouchCount() == 0)
+    {
+        m_PanVelocity = MapPoint(clampMagnitude(panVelocity.x, MAX_PAN_SPEED), clampMagnitude(panVelocity.y, MAX_PAN_SPEED));
+
+        if (m_PendingZoomVelocity != 0 && time - m_PendingZoomTime <= PINCH_RELEASE_WINDOW)
+        {
+            m_ZoomVelocity = clampMagnitude(m_PendingZoomVelocity, MAX_ZOOM_SPEED);
+            m_ZoomPivot = m_PendingZoomPivot;
+        }
+        m_PendingZoomVelocity = 0;
+    }
+    else
+    {
+        restartGesture(time);
+    }
+}
+
+// Animate the map so that a point ends up in the middle of the view at a given scale.
+
+void MapController::flyTo(const MapPoint& center, float scale, double duration, double time)
+{
+    // Flights only happen while the map isn't being touched.
+    if (getTouchCount() > 0)
+    {
+        return;
+    }
+
+    advance(time);
+
+    // Work out where the flight will finish, keeping it inside the map's limits so that it never needs to spring back.
+    float endScale = (scale < m_MinScale) ? m_MinScale : ((scale > m_MaxScale) ? m_MaxScale : scale);
+    MapPoint endOffset = m_ViewSize * 0.5f - center * endScale;
+
+    float minX, maxX, minY, maxY;
+    getOffsetLimits(m_ViewSize.x, m_ContentSize.x, endScale, &minX, &maxX);
+    getOffsetLimits(m_ViewSize.y, m_ContentSize.y, endScale, &minY, &maxY);
+    endOffset.x = (endOffset.x < minX) ? minX : ((endOffset.x > maxX) ? maxX : endOffset.x);
+    endOffset.y = (endOffset.y < minY) ? minY : ((endOffset.y > maxY) ? maxY : endOffset.y);
+
+    // The flight replaces any other motion.
+    m_PanVelocity = MapPoint();
+    m_ZoomVelocity = 0;
+    m_PendingZoomVelocity = 0;
+
+    m_FlightStart = m_Current;
+    m_FlightEnd.offset = endOffset;
+    m_FlightEnd.scale = endScale;
+    m_FlightStartTime = m_Time;
+    m_FlightDuration = (duration > TIME_STEP) ? duration : TIME_STEP;
+    m_Flying = true;
+}
+
+// Run the simulation up to a point in time.
+
+void MapController::advance(double time)
+{
+    if (time < m_Time)
+    {
+        return;
+    }
+
+    int steps = 0;
+    while (m_Time + TIME_STEP <= time)
+    {
+        if (steps++ == MAX_STEPS_PER_ADVANCE)
+        {
+            m_Time = time;
+            break;
+        }
+
+        m_Previous = m_Current;
+        step();
+        m_Time += TIME_STEP;
+    }
+
+    m_Interpolation = (float)((time - m_Time) / TIME_STEP);
+
+    // While the user's fingers are down, show where they will be when this frame is displayed.
+    m_HasPrediction = false;
+    if (m_PredictionEnabled && getTouchCount() > 0)
+    {
+        MapPoint predicted[MAX_TOUCHES];
+        for (int i = 0; i < MAX_TOUCHES; i++)
+        {
+            predicted[i] = m_Touches[i].active ? m_Touches[i].predictor.predict(time + m_PredictionLead) : MapPoint();
+        }
+
+        m_Predicted = getGestureTransform(predicted);
+        m_HasPrediction = true;
+    }
+}
+
+// Run the simulation up to the time a frame is drawn if the map is moving, and report whether the frame needs the map's transform applied.
+
+bool MapController::updateFrame(double time)
+{
+    // Predicted touches keep moving between samples, so the transform changes every frame while they are down.
+    if (isAnimating() || (m_PredictionEnabled && getTouchCount() > 0))
+    {
+        advance(time);
+        m_TransformChanged = true;
+    }
+
+    bool changed = m_TransformChanged;
+    m_TransformChanged = false;
+    return changed;
+}
+
+// Get the map's transform as of the last call to advance(...) or the last touch.
+
+MapTransform MapController::getTransform() const
+{
+    if (m_HasPrediction)
+    {
+        return m_Predicted;
+    }
+
+    MapTransform transform;
+    transform.offset = m_Previous.offset + (m_Current.offset - m_Previous.offset) * m_Interpolation;
+    transform.scale = m_Previous.scale + (m_Current.scale - m_Previous.scale) * m_Interpolation;
+    return transform;
+}
+
+// Get the number of touches currently being tracked.
+
+int MapController::getTouchCount() const
+{
+    int count = 0;
+    for (int i = 0; i < MAX_TOUCHES; i++)
+    {
+        if (m_Touches[i].active) count++;
+    }
+    return count;
+}
+
+// Check whether or not the map is still moving on its own.
+
+bool MapController::isAnimating() const
+{
+    if (getTouchCount() > 0)
+    {
+        return false;
+    }
+
+    if (m_Flying || m_PanVelocity.x != 0 || m_PanVelocity.y != 0 || m_ZoomVelocity != 0 || m_Current.scale != m_Previous.scale ||
+        m_Current.offset != m_Previous.offset || m_Current.scale < m_MinScale || m_Current.scale > m_MaxScale)
+    {
+        return true;
+    }
+
+    float minX, maxX, minY, maxY;
+    getOffsetLimits(m_ViewSize.x, m_ContentSize.x, m_Current.scale, &minX, &maxX);
+    getOffsetLimits(m_ViewSize.y, m_ContentSize.y, m_Current.scale, &minY, &maxY);
+    return (m_Current.offset.x < minX || m_Current.offset.x > maxX || m_Current.offset.y < minY || m_Current.offset.y > maxY);
+}
+
+// Get the range of offsets which keep the map filling the view along one axis at a given scale.
+
+void MapController::getOffsetLimits(float viewLength, float contentLength, float scale, float* minimum, float* maximum)
+{
+    float scaledLength = contentLength * scale;
+
+    // A map smaller than the view is centred; otherwise its edges may not come inside the view's edges.
+    if (scaledLength < viewLength)
+    {
+        *minimum = *maximum = (viewLength - scaledLength) / 2;
+    }
+    else
+    {
+        *minimum = viewLength - scaledLength;
+        *maximum = 0;
+    }
+}
+
+// Find the slot of a tracked touch.
+
+int MapController::findTouch(int touchID) const
+{
+    for (int i = 0; i < MAX_TOUCHES; i++)
+    {
+        if (m_Touches[i].active && m_Touches[i].touchID == touchID)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Start a new gesture from the current touches and the map's current transform.
+
+void MapController::restartGesture(double time)
+{
+    for (int i = 0; i < MAX_TOUCHES; i++)
+    {
+        m_Touches[i].start = m_Touches[i].current;
+    }
+
+    m_GestureStart = removeResistance(m_Current);
+    m_GestureStartScale = expf(resistAxis(logf(m_Current.scale), logf(m_MinScale), logf(m_MaxScale), logf(SCALE_OVERSHOOT), true));
+    m_Previous = m_Current;
+    m_Interpolation = 0;
+    m_HasPrediction = false;
+
+    // The centroid jumps when the number of touches changes, so older samples no longer describe the same motion.
+    m_SampleCount = 0;
+    m_NextSample = 0;
+    addSample(time);
+}
+
+// Move the map to follow the current touches.
+
+void MapController::applyGesture(double time)
+{
+    MapPoint locations[MAX_TOUCHES];
+    for (int i = 0; i < MAX_TOUCHES; i++)
+    {
+        locations[i] = m_Touches[i].current;
+    }
+
+    m_Current = getGestureTransform(locations);
+    m_Previous = m_Current;
+    m_Interpolation = 0;
+    m_HasPrediction = false;
+
+    addSample(time);
+}
+
+// Get the transform which places the map under the touches as the current gesture requires.
+
+MapTransform MapController::getGestureTransform(const MapPoint* locations) const
+{
+    MapTransform raw = m_GestureStart;
+
+    if (getTouchCount() == 1)
+    {
+        // One touch drags the map.
+        int slot = m_Touches[0].active ? 0 : 1;
+        raw.offset = m_GestureStart.offset + (locations[slot] - m_Touches[slot].start);
+    }
+    else if (getTouchCount() == 2)
+    {
+        // Two touches scale the map by the change in distance between them, resisting past the scale limits (in log space, so that the scale never goes further than SCALE_OVERSHOOT past either limit).
+        float startDistance = m_Touches[0].start.distance(m_Touches[1].start);
+        float currentDistance = locations[0].distance(locations[1]);
+        if (startDistance > 0 && currentDistance > 0)
+        {
+            float unresistedScale = m_GestureStartScale * currentDistance / startDistance;
+            raw.scale = expf(resistAxis(logf(unresistedScale), logf(m_MinScale), logf(m_MaxScale), logf(SCALE_OVERSHOOT), false));
+        }
+
+        // The map point under the touches' midpoint stays beneath it.
+        MapPoint startMidpoint = (m_Touches[0].start + m_Touches[1].start) * 0.5f;
+        MapPoint currentMidpoint = (locations[0] + locations[1]) * 0.5f;
+        MapPoint pivot = (startMidpoint - m_GestureStart.offset) * (1 / m_GestureStart.scale);
+        raw.offset = currentMidpoint - pivot * raw.scale;
+    }
+
+    // Then resist dragging past the edges.
+    return applyResistance(raw);
+}
+
+// Record the gesture's current position for velocity measurement.
+
+void MapController::addSample(double time)
+{
+    GestureSample sample;
+    sample.time = time;
+    sample.centroid = MapPoint();
+    sample.logSpread = 0;
+
+    int count = getTouchCount();
+    for (int i = 0; i < MAX_TOUCHES; i++)
+    {
+        if (m_Touches[i].active)
+        {
+            sample.centroid = sample.centroid + m_Touches[i].current * (1.0f / count);
+        }
+    }
+
+    if (count == 2)
+    {
+        float spread = m_Touches[0].current.distance(m_Touches[1].current);
+        sample.logSpread = (spread > 0) ? logf(spread) : 0;
+    }
+
+    m_Samples[m_NextSample] = sample;
+    m_NextSample = (m_NextSample + 1) % SAMPLE_COUNT;
+    if (m_SampleCount < SAMPLE_COUNT) m_SampleCount++;
+}
+
+// Measure the gesture's velocity from its recent samples.
+
+void MapController::measureVelocity(MapPoint* panVelocity, float* zoomVelocity) const
+{
+    *panVelocity = MapPoint();
+    *zoomVelocity = 0;
+
+    if (m_SampleCount < 2)
+    {
+        return;
+    }
+
+    // Compare the newest sample with the oldest one inside the window.
+    const GestureSample& newest = m_Samples[(m_NextSample + SAMPLE_COUNT - 1) % SAMPLE_COUNT];
+    const GestureSample* oldest = &newest;
+    for (int i = 2; i <= m_SampleCount; i++)
+    {
+        const GestureSample& sample = m_Samples[(m_NextSample + SAMPLE_COUNT - i) % SAMPLE_COUNT];
+        if (newest.time - sample.time > VELOCITY_WINDOW)
+        {
+            break;
+        }
+        oldest = &sample;
+    }
+
+    double elapsed = newest.time - oldest->time;
+    if (elapsed <= 0)
+    {
+        return;
+    }
+
+    *panVelocity = (newest.centroid - oldest->centroid) * (float)(1 / elapsed);
+    *zoomVelocity = (float)((newest.logSpread - oldest->logSpread) / elapsed);
+}
+
+// Advance the coasting and springing motion by one time step.
+
+void MapController::step()
+{
+    // The user's fingers are in control while they are down.
+    if (getTouchCount() > 0)
+    {
+        return;
+    }
+
+    if (m_Flying)
+    {
+        stepFlight();
+        return;
+    }
+
+    float dt = (float)TIME_STEP;
+
+    // Zoom in log space so that momentum feels the same at every scale, keeping the pivot fixed on screen.
+    float logScale = logf(m_Current.scale);
+    stepAxis(&logScale, &m_ZoomVelocity, logf(m_MinScale), logf(m_MaxScale), ZOOM_FRICTION, MIN_ZOOM_SPEED, 0.001f, dt);
+
+    float newScale = expf(logScale);
+    if (newScale != m_Current.scale)
+    {
+        MapPoint pivot = (m_ZoomPivot - m_Current.offset) * (1 / m_Current.scale);
+        m_Current.offset = m_ZoomPivot - pivot * newScale;
+        m_Current.scale = newScale;
+    }
+
+    // Then coast or spring back along each axis within the limits for the new scale.
+    float minX, maxX, minY, maxY;
+    getOffsetLimits(m_ViewSize.x, m_ContentSize.x, m_Current.scale, &minX, &maxX);
+    getOffsetLimits(m_ViewSize.y, m_ContentSize.y, m_Current.scale, &minY, &maxY);
+    stepAxis(&m_Current.offset.x, &m_PanVelocity.x, minX, maxX, PAN_FRICTION, MIN_PAN_SPEED, SETTLE_DISTANCE, dt);
+    stepAxis(&m_Current.offset.y, &m_PanVelocity.y, minY, maxY, PAN_FRICTION, MIN_PAN_SPEED, SETTLE_DISTANCE, dt);
+}
+
+// Advance a flight by one time step.
+
+void MapController::stepFlight()
+{
+    // The step finishes one time step after the current time. Ease in and out of the flight.
+    float progress = (float)((m_Time + TIME_STEP - m_FlightStartTime) / m_FlightDuration);
+    if (progress >= 1)
+    {
+        m_Current = m_FlightEnd;
+        m_Flying = false;
+        return;
+    }
+    float eased = progress * progress * (3 - 2 * progress);
+
+    // Move the point in the middle of the view in a straight line across the map while zooming in log space, so that both appear to happen at an even pace.
+    MapPoint viewCenter = m_ViewSize * 0.5f;
+    MapPoint startCenter = (viewCenter - m_FlightStart.offset) * (1 / m_FlightStart.scale);
+    MapPoint endCenter = (viewCenter - m_FlightEnd.offset) * (1 / m_FlightEnd.scale);
+    MapPoint center = startCenter + (endCenter - startCenter) * eased;
+
+    m_Current.scale = expf(logf(m_FlightStart.scale) + (logf(m_FlightEnd.scale) - logf(m_FlightStart.scale)) * eased);
+    m_Current.offset = viewCenter - center * m_Current.scale;
+}
+
+// Apply rubber-band resistance to a transform whose offset has been dragged past the map's limits.
+
+MapTransform MapController::applyResistance(const MapTransform& raw) const
+{
+    float minX, maxX, minY, maxY;
+    getOffsetLimits(m_ViewSize.x, m_ContentSize.x, raw.scale, &minX, &maxX);
+    getOffsetLimits(m_ViewSize.y, m_ContentSize.y, raw.scale, &minY, &maxY);
+
+    MapTransform displayed = raw;
+    displayed.offset.x = resistAxis(raw.offset.x, minX, maxX, m_ViewSize.x, false);
+    displayed.offset.y = resistAxis(raw.offset.y, minY, maxY, m_ViewSize.y, false);
+    return displayed;
+}
+
+// Undo applyResistance(...).
+
+MapTransform MapController::removeResistance(const MapTransform& displayed) const
+{
+    float minX, maxX, minY, maxY;
+    getOffsetLimits(m_ViewSize.x, m_ContentSize.x, displayed.scale, &minX, &maxX);
+    getOffsetLimits(m_ViewSize.y, m_ContentSize.y, displayed.scale, &minY, &maxY);
+
+    MapTransform raw = displayed;
+    raw.offset.x = resistAxis(displayed.offset.x, minX, maxX, m_ViewSize.x, true);
+    raw.offset.y = resistAxis(displayed.offset.y, minY, maxY, m_ViewSize.y, true);
+    return raw;
+}
@@ -0,0 +1,298 @@
+//
+//  MapController.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-27.
+//
+//
+
+#ifndef MAP_CONTROLLER_H
+#define MAP_CONTROLLER_H
+
+#include "MapPoint.h"
+#include "TouchPredictor.h"
+
+/**
+ @brief     Counts of the work the map has done since its counters were last reported.
+ */
+struct MapFrameStats
+{
+    MapFrameStats() : frames(0), touchSamples(0), transformUpdates(0), landmarkProjections(0) { }
+
+    /** The number of frames which have been displayed. */
+    unsigned int frames;
+
+    /** The number of touch events received. */
+    unsigned int touchSamples;
+
+    /** The number of times the map's position and scale were applied. */
+    unsigned int transformUpdates;
+
+    /** The number of times every landmark had to be projected to a new scale. */
+    unsigned int landmarkProjections;
+};
+
+/**
+ @brief     Where the map is on screen: a point in map space appears at (offset + point * scale).
+ */
+struct MapTransform
+{
+    MapPoint offset;
+    float scale;
+};
+
+/**
+ @brief     The physics behind panning and zooming the map, including momentum after the user lets go and rubber-banding at the edges, and animated flights to a point on the map.
+
+ Touches move the map directly while they are down. Once they lift, the map coasts with the velocity it was released at, and springs back if it was dragged or flung past its limits. That motion is simulated in fixed time steps driven by the touch and frame timestamps alone, so the same sequence of timestamped touches always produces the same motion no matter how often frames are drawn (see Tools/MapControllerCheck.cpp). Frames which fall between steps are interpolated.
+
+ This class has no dependencies on cocos2d so that gestures can be replayed and checked without a device.
+ */
+class MapController
+{
+public:
+
+    /** The length of one simulation step in seconds. */
+    static const double TIME_STEP;
+
+    /** The maximum number of touches that are tracked at once (one pans, two zoom). */
+    static const int MAX_TOUCHES = 2;
+
+    /**
+     @brief     Default constructor. The controller does nothing useful until it is reset.
+     */
+    MapController();
+
+    /**
+     @brief     Set the sizes and limits the map is constrained by, and place it at rest.
+     @param     viewSize        The size of the area the map is displayed in (ie. the screen).
+     @param     contentSize     The size of the map in map units.
+     @param     minScale        The smallest scale the map comes to rest at.
+     @param     maxScale        The largest scale the map comes to rest at.
+     @param     transform       The map's starting transform.
+     @param     time            The current time in seconds.
+     */
+    void reset(const MapPoint& viewSize, const MapPoint& contentSize, float minScale, float maxScale, const MapTransform& transform, double time);
+
+    /**
+     @brief     Respond to the beginning of a touch.
+     @param     touchID     An identifier which is unique among the current touches.
+     @param     location    The touch's position in view space.
+     @param     time        The time at which the touch began.
+     @return    Whether or not the touch is being tracked (only two touches are tracked at once).
+     */
+    bool touchBegan(int touchID, const MapPoint& location, double time);
+
+    /**
+     @brief     Respond to a touch moving.
+     @param     touchID     The touch's identifier.
+     @param     location    The touch's position in view space.
+     @param     time        The time at which the touch moved.
+     */
+    void touchMoved(int touchID, const MapPoint& location, double time);
+
+    /**
+     @brief     Respond to the end (or loss) of a touch.
+     @param     touchID     The touch's identifier.
+     @param     location    The touch's final position in view space.
+     @param     time        The time at which the touch ended.
+     */
+    void touchEnded(int touchID, const MapPoint& location, double time);
+
+    /**
+     @brief     Set whether or not the map follows where the touches are predicted to be when the frame is displayed, rather than where they were last reported, while they are down. Only the displayed transform is affected; momentum is always measured from the reported touches.
+     @param     enabled     Whether or not to predict touches.
+     @param     lead        How far ahead of the time passed to advance(...) the frame is expected to be displayed, in seconds.
+     */
+    void setPrediction(bool enabled, double lead);
+
+    /**
+     @brief     Animate the map so that a point ends up in the middle of the view at a given scale. Both are adjusted as needed to keep the map inside its limits. The flight is part of the same simulation as everything else, so touching the map catches it mid-flight.
+     @param     center      The point in map space to fly to.
+     @param     scale       The scale to finish at.
+     @param     duration    How long the flight should take in seconds.
+     @param     time        The current time in seconds.
+     */
+    void flyTo(const MapPoint& center, float scale, double duration, double time);
+
+    /**
+     @brief     Run the simulation up to a point in time. Call this once per frame.
+     @param     time        The current time in seconds.
+     */
+    void advance(double time);
+
+    /**
+     @brief     Run the simulation up to the time a frame is drawn if the map is moving, and report whether the frame needs the map's transform applied. Several touch samples can arrive within one frame (ie. during a pinch), so they are only applied once, by the next frame. Call this once per frame instead of advance(...).
+     @param     time        The current time in seconds.
+     @return    Whether or not the transform has changed since the last frame (or the last reset).
+     */
+    bool updateFrame(double time);
+
+    /**
+     @brief     Get the map's transform as of the last call to advance(...) or the last touch. While touches are down and prediction is enabled, this is the transform predicted for the display time.
+     @return    The transform.
+     */
+    MapTransform getTransform() const;
+
+    /**
+     @brief     Get the number of touches currently being tracked.
+     */
+    int getTouchCount() const;
+
+    /**
+     @brief     Check whether or not the map is still moving on its own (coasting, springing back or flying).
+     */
+    bool isAnimating() const;
+
+    /**
+     @brief     Get the range of offsets which keep the map filling the view along one axis at a given scale.
+     @param     viewLength      The view's size along the axis.
+     @param     contentLength   The map's size along the axis in map units.
+     @param     scale           The map's scale.
+     @param     minimum         Receives the smallest allowed offset.
+     @param     maximum         Receives the largest allowed offset.
+     */
+    static void getOffsetLimits(float viewLength, float contentLength, float scale, float* minimum, float* maximum);
+
+private:
+
+    /**
+     @brief     A tracked touch.
+     */
+    struct TrackedTouch
+    {
+        bool active;
+        int touchID;
+        MapPoint start;
+        MapPoint current;
+        TouchPredictor predictor;
+    };
+
+    /**
+     @brief     A recent position of the gesture, used to measure its velocity when it is released.
+     */
+    struct GestureSample
+    {
+        double time;
+        MapPoint centroid;
+        float logSpread;
+    };
+
+    /** The number of recent samples kept for measuring release velocity. */
+    static const int SAMPLE_COUNT = 8;
+
+    /**
+     @brief     Find the slot of a tracked touch.
+     @return    The slot's index, or -1 if the touch isn't tracked.
+     */
+    int findTouch(int touchID) const;
+
+    /**
+     @brief     Start a new gesture from the current touches and the map's current transform. Called whenever a touch begins or ends.
+     */
+    void restartGesture(double time);
+
+    /**
+     @brief     Move the map to follow the current touches.
+     */
+    void applyGesture(double time);
+
+    /**
+     @brief     Get the transform which places the map under the touches as the current gesture requires.
+     @param     locations   The position of each tracked touch, indexed by slot. Inactive slots are ignored.
+     @return    The transform, with resistance applied.
+     */
+    MapTransform getGestureTransform(const MapPoint* locations) const;
+
+    /**
+     @brief     Record the gesture's current position for velocity measurement.
+     */
+    void addSample(double time);
+
+    /**
+     @brief     Measure the gesture's velocity from its recent samples.
+     @param     panVelocity     Receives the velocity of the touches' centroid in view units per second.
+     @param     zoomVelocity    Receives the rate of change of the logarithm of the distance between two touches, per second.
+     */
+    void measureVelocity(MapPoint* panVelocity, float* zoomVelocity) const;
+
+    /**
+     @brief     Advance the coasting and springing motion by one time step.
+     */
+    void step();
+
+    /**
+     @brief     Advance a flight by one time step.
+     */
+    void stepFlight();
+
+    /**
+     @brief     Apply rubber-band resistance to a transform whose offset has been dragged past the map's limits.
+     @param     raw     The transform that the touches alone would produce.
+     @return    The transform to display.
+     */
+    MapTransform applyResistance(const MapTransform& raw) const;
+
+    /**
+     @brief     Undo applyResistance(...), so that a gesture can continue from a transform which is already past the limits.
+     @param     displayed   A transform as displayed.
+     @return    The transform that would have produced it.
+     */
+    MapTransform removeResistance(const MapTransform& displayed) const;
+
+    /** The sizes and limits that the map is constrained by. */
+    MapPoint m_ViewSize;
+    MapPoint m_ContentSize;
+    float m_MinScale;
+    float m_MaxScale;
+
+    /** The transform after the most recent step, the one before it, and how far the last advance went between the two (0 to 1). */
+    MapTransform m_Current;
+    MapTransform m_Previous;
+    float m_Interpolation;
+
+    /** The time of the most recent step. */
+    double m_Time;
+
+    /** The touches being tracked. */
+    TrackedTouch m_Touches[MAX_TOUCHES];
+
+    /** The transform the current gesture started from, before resistance was applied to its offset or its scale. */
+    MapTransform m_GestureStart;
+    float m_GestureStartScale;
+
+    /** The gesture's recent positions, stored in a ring. */
+    GestureSample m_Samples[SAMPLE_COUNT];
+    int m_SampleCount;
+    int m_NextSample;
+
+    /** The velocity that the map is coasting with, in view units per second. */
+    MapPoint m_PanVelocity;
+
+    /** The rate that the logarithm of the map's scale is changing per second, and the view position it zooms around. */
+    float m_ZoomVelocity;
+    MapPoint m_ZoomPivot;
+
+    /** The zoom velocity of a pinch which has just become a pan (because one finger lifted first) and the time it was measured. */
+    float m_PendingZoomVelocity;
+    MapPoint m_PendingZoomPivot;
+    double m_PendingZoomTime;
+
+    /** Whether or not touches have moved the map since the last frame. */
+    bool m_TransformChanged;
+
+    /** Whether or not touches are predicted, how far ahead, and the transform predicted by the last advance (if there is one). */
+    bool m_PredictionEnabled;
+    double m_PredictionLead;
+    bool m_HasPrediction;
+    MapTransform m_Predicted;
+
+    /** Whether or not the map is flying, and the transforms, start time and duration of the flight. */
+    bool m_Flying;
+    MapTransform m_FlightStart;
+    MapTransform m_FlightEnd;
+    double m_FlightStartTime;
+    double m_FlightDuration;
+};
+
+#endif // MAP_CONTROLLER_H
@@ -0,0 +1,289 @@
+//
+//  MapProjection.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "MapProjection.h"
+#include <float.h>
+
+const double MapProjection::EARTH_RADIUS = 6371008.8;
+const double MapProjection::CORRECTION_SOFTENING = 1;
+const double MapProjection::CORRECTION_FADE = 2000;
+
+// The most times unprojecting refines its guess, and how close in map units its guess has to project to the position to stop early.
+static const unsigned int UNPROJECT_ITERATIONS = 10;
+static const float UNPROJECT_TOLERANCE = 0.01f;
+
+// The number of metres per degree of latitude, which is the same everywhere on a spherical Earth.
+static const double METRES_PER_DEGREE = MapProjection::EARTH_RADIUS * M_PI / 180;
+
+// Solve a 3x3 system of linear equations by Gaussian elimination, returning false if it has no single solution.
+
+static bool solve(double matrix[3][3], double values[3], double solution[3])
+{
+    // Anything this much smaller than the largest pivot is treated as zero, since the points must lie along a line.
+    double largest = 0;
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        if (fabs(matrix[i][i]) > largest)
+        {
+            largest = fabs(matrix[i][i]);
+        }
+    }
+
+    for (unsigned int column = 0; column < 3; column++)
+    {
+        unsigned int pivot = column;
+        for (unsigned int row = column + 1; row < 3; row++)
+        {
+            if (fabs(matrix[row][column]) > fabs(matrix[pivot][column]))
+            {
+                pivot = row;
+            }
+        }
+
+        if (!(fabs(matrix[pivot][column]) > largest * 1e-12))
+        {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            double swapped = matrix[column][i];
+            matrix[column][i] = matrix[pivot][i];
+            matrix[pivot][i] = swapped;
+        }
+        double swapped = values[column];
+        values[column] = values[pivot];
+        values[pivot] = swapped;
+
+        for (unsigned int row = column + 1; row < 3; row++)
+        {
+            double factor = matrix[row][column] / matrix[column][column];
+            for (unsigned int i = column; i < 3; i++)
+            {
+                matrix[row][i] -= factor * matrix[column][i];
+            }
+            values[row] -= factor * values[column];
+        }
+    }
+
+    for (int row = 2; row >= 0; row--)
+    {
+        double value = values[row];
+        for (unsigned int i = row + 1; i < 3; i++)
+        {
+            value -= matrix[row][i] * solution[i];
+        }
+        solution[row] = value / matrix[row][row];
+    }
+
+    return true;
+}
+
+// Default constructor.
+
+MapProjection::MapProjection()
+: m_MetresPerDegreeLongitude(METRES_PER_DEGREE)
+, m_UnitsPerMetre(0)
+, m_Error(0)
+, m_IsCalibrated(false)
+{
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        m_Forward[i] = 0;
+        m_Inverse[i] = 0;
+    }
+}
+
+// Fit the projection to a set of calibration points with least squares.
+
+bool MapProjection::calibrate(const MapCalibrationPoint* points, unsigned int count)
+{
+    if (count < 3)
+    {
+        return false;
+    }
+
+    // Flatten around the middle of the points, which keeps the numbers small and the flattening accurate.
+    MapProjection fitted;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        fitted.m_Origin.latitude += points[i].location.latitude / count;
+        fitted.m_Origin.longitude += points[i].location.longitude / count;
+    }
+    fitted.m_MetresPerDegreeLongitude = METRES_PER_DEGREE * cos(fitted.m_Origin.latitude * M_PI / 180);
+
+    // Build the normal equations for fitting (east, north, 1) to each map coordinate. Both coordinates share the same matrix.
+    double matrix[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+    double valuesX[3] = { 0, 0, 0 };
+    double valuesY[3] = { 0, 0, 0 };
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        double row[3] = { 0, 0, 1 };
+        fitted.flatten(points[i].location, &row[0], &row[1]);
+
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                matrix[j][k] += row[j] * row[k];
+            }
+            valuesX[j] += row[j] * points[i].position.x;
+            valuesY[j] += row[j] * points[i].position.y;
+        }
+    }
+
+    double matrixY[3][3];
+    for (unsigned int j = 0; j < 3; j++)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            matrixY[j][k] = matrix[j][k];
+        }
+    }
+
+    if (!solve(matrix, valuesX, &fitted.m_Forward[0]) || !solve(matrixY, valuesY, &fitted.m_Forward[3]))
+    {
+        return false;
+    }
+
+    // Invert the transform for unprojecting.
+    const double* forward = fitted.m_Forward;
+    double determinant = forward[0] * forward[4] - forward[1] * forward[3];
+    if (determinant == 0)
+    {
+        return false;
+    }
+
+    double* inverse = fitted.m_Inverse;
+    inverse[0] = forward[4] / determinant;
+    inverse[1] = -forward[1] / determinant;
+    inverse[3] = -forward[3] / determinant;
+    inverse[4] = forward[0] / determinant;
+    inverse[2] = -(inverse[0] * forward[2] + inverse[1] * forward[5]);
+    inverse[5] = -(inverse[3] * forward[2] + inverse[4] * forward[5]);
+
+    fitted.m_UnitsPerMetre = sqrt(fabs(determinant));
+
+    // Measure how well the transform fits the points, and keep what it misses by at each of them to correct for.
+    double squaredError = 0;
+    fitted.m_Corrections.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        Correction& correction = fitted.m_Corrections[i];
+        fitted.flatten(points[i].location, &correction.east, &correction.north);
+        correction.offset = points[i].position - fitted.project(points[i].location);
+        squaredError += correction.offset.dot(correction.offset);
+    }
+    fitted.m_Error = sqrt(squaredError / count) / fitted.m_UnitsPerMetre;
+
+    // The corrections were measured against the transform alone, so only use them once they have all been found.
+    fitted.m_IsCalibrated = true;
+
+    *this = fitted;
+    return true;
+}
+
+// Convert a latitude and longitude to map space.
+
+MapPoint MapProjection::project(const GeoPoint& location) const
+{
+    double east, north;
+    flatten(location, &east, &north);
+    return projectFlattened(east, north);
+}
+
+// Convert a position in map space to a latitude and longitude.
+
+GeoPoint MapProjection::unproject(const MapPoint& position) const
+{
+    // Guess the location without any correction, then refine it with Newton's method, since the correction can change quickly between calibration points which are close together.
+    double east = m_Inverse[0] * position.x + m_Inverse[1] * position.y + m_Inverse[2];
+    double north = m_Inverse[3] * position.x + m_Inverse[4] * position.y + m_Inverse[5];
+
+    // Where the map folds over itself, the guess may not settle, so the best guess so far is kept.
+    double bestEast = east, bestNorth = north;
+    float bestMissSquared = FLT_MAX;
+    for (unsigned int i = 0; i <= UNPROJECT_ITERATIONS && !m_Corrections.empty(); i++)
+    {
+        MapPoint miss = projectFlattened(east, north) - position;
+        float missSquared = miss.dot(miss);
+        if (missSquared < bestMissSquared)
+        {
+            bestEast = east;
+            bestNorth = north;
+            bestMissSquared = missSquared;
+        }
+        if (missSquared < UNPROJECT_TOLERANCE * UNPROJECT_TOLERANCE || i == UNPROJECT_ITERATIONS)
+        {
+            break;
+        }
+
+        // Measure how the projection changes with each flattened coordinate over a step of a metre, and solve for the step that removes the miss.
+        MapPoint alongEast = projectFlattened(east + 1, north) - position - miss;
+        MapPoint alongNorth = projectFlattened(east, north + 1) - position - miss;
+        double determinant = alongEast.cross(alongNorth);
+        if (determinant == 0)
+        {
+            break;
+        }
+
+        east -= (alongNorth.y * miss.x - alongNorth.x * miss.y) / determinant;
+        north -= (alongEast.x * miss.y - alongEast.y * miss.x) / determinant;
+    }
+
+    if (bestMissSquared < FLT_MAX)
+    {
+        east = bestEast;
+        north = bestNorth;
+    }
+
+    return GeoPoint(m_Origin.latitude + north / METRES_PER_DEGREE,
+                    m_Origin.longitude + east / m_MetresPerDegreeLongitude);
+}
+
+// Flatten a location into metres east and north of the origin.
+
+void MapProjection::flatten(const GeoPoint& location, double* east, double* north) const
+{
+    *east = (location.longitude - m_Origin.longitude) * m_MetresPerDegreeLongitude;
+    *north = (location.latitude - m_Origin.latitude) * METRES_PER_DEGREE;
+}
+
+// Convert a flattened location to map space.
+
+MapPoint MapProjection::projectFlattened(double east, double north) const
+{
+    return MapPoint(m_Forward[0] * east + m_Forward[1] * north + m_Forward[2],
+                    m_Forward[3] * east + m_Forward[4] * north + m_Forward[5]) + getCorrection(east, north);
+}
+
+// Get the correction for the distortion of the map at a flattened location.
+
+MapPoint MapProjection::getCorrection(double east, double north) const
+{
+    if (!m_IsCalibrated || m_Corrections.empty())
+    {
+        return MapPoint();
+    }
+
+    // Weigh each calibration point's correction by inverse squared distance. A correction of zero weighed as if it were CORRECTION_FADE away makes the corrections fade out beyond the calibration points.
+    double totalWeight = 1 / (CORRECTION_FADE * CORRECTION_FADE);
+    double x = 0, y = 0;
+    for (unsigned int i = 0; i < m_Corrections.size(); i++)
+    {
+        const Correction& correction = m_Corrections[i];
+        double distanceSquared = (correction.east - east) * (correction.east - east) + (correction.north - north) * (correction.north - north);
+        double weight = 1 / (distanceSquared + CORRECTION_SOFTENING * CORRECTION_SOFTENING);
+        x += correction.offset.x * weight;
+        y += correction.offset.y * weight;
+        totalWeight += weight;
+    }
+
+    return MapPoint(x / totalWeight, y / totalWeight);
+}
@@ -0,0 +1,147 @@
+//
+//  MapProjection.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef MAP_PROJECTION_H
+#define MAP_PROJECTION_H
+
+#include <vector>
+#include "MapPoint.h"
+
+/**
+ @brief     A position on the Earth in degrees (ie. from the device's location services).
+ */
+struct GeoPoint
+{
+    double latitude;
+    double longitude;
+
+    GeoPoint() : latitude(0), longitude(0) { }
+    GeoPoint(double latitude, double longitude) : latitude(latitude), longitude(longitude) { }
+};
+
+/**
+ @brief     A place whose position is known both on the Earth and on the map, used to calibrate a MapProjection.
+ */
+struct MapCalibrationPoint
+{
+    /** The place's latitude and longitude. */
+    GeoPoint location;
+
+    /** Where the place is drawn in map space. */
+    MapPoint position;
+};
+
+/**
+ @brief     Converts between latitudes and longitudes and map space, so that locations from the device can be placed on the map.
+
+ Locations are first flattened into metres east and north of the calibration points' centre, which is accurate to well under a metre across an area the size of Manhattan. The flattened locations are then fitted to the map with the affine transform (a combination of scaling, rotation, shearing and translation) that best matches the calibration points, so the map can be drawn at any angle or with its own proportions.
+
+ An illustrated map is rarely uniform, though: landmarks are moved apart to make room for their pictures and neighbourhoods are stretched to fit the page. Whatever the transform can't account for at each calibration point is spread over the map around it, weighted by inverse distance and fading out away from the points, so that the calibration points themselves land exactly where they are drawn and a location between them is nudged by its neighbours. Unprojecting undoes the nudge by refining a guess with Newton's method.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class MapProjection
+{
+public:
+
+    /** The mean radius of the Earth in metres. */
+    static const double EARTH_RADIUS;
+
+    /** The distance in metres within which a calibration point's correction is spread evenly rather than peaking at the point itself, and the distance at which it has faded to half. */
+    static const double CORRECTION_SOFTENING;
+    static const double CORRECTION_FADE;
+
+    /**
+     @brief     Default constructor. Every location is projected to the origin until the projection is calibrated.
+     */
+    MapProjection();
+
+    /**
+     @brief     Fit the projection to a set of calibration points with least squares. The points should be spread out over the map rather than along a line.
+     @param     points      The calibration points.
+     @param     count       The number of calibration points, which must be at least 3.
+     @return    Whether or not the projection could be fitted. If not, it is left as it was.
+     */
+    bool calibrate(const MapCalibrationPoint* points, unsigned int count);
+
+    /**
+     @brief     Get whether or not the projection has been calibrated.
+     */
+    bool isCalibrated() const { return m_IsCalibrated; }
+
+    /**
+     @brief     Convert a latitude and longitude to map space.
+     @param     location    The location to convert.
+     @return    The location's position in map space.
+     */
+    MapPoint project(const GeoPoint& location) const;
+
+    /**
+     @brief     Convert a position in map space to a latitude and longitude.
+     @param     position    The position to convert.
+     @return    The position's location on the Earth.
+     */
+    GeoPoint unproject(const MapPoint& position) const;
+
+    /**
+     @brief     Get the average number of map units that one metre on the ground covers, for turning distances in metres into map space.
+     */
+    float getUnitsPerMetre() const { return m_UnitsPerMetre; }
+
+    /**
+     @brief     Get how far, on average, the calibration points are from where the affine transform alone places them, in metres. This is how distorted the map is, which the projection corrects for around the calibration points.
+     */
+    float getError() const { return m_Error; }
+
+private:
+
+    /**
+     @brief     Flatten a location into metres east and north of the origin.
+     */
+    void flatten(const GeoPoint& location, double* east, double* north) const;
+
+    /**
+     @brief     Convert a flattened location to map space.
+     */
+    MapPoint projectFlattened(double east, double north) const;
+
+    /**
+     @brief     Get the correction for the distortion of the map at a flattened location.
+     */
+    MapPoint getCorrection(double east, double north) const;
+
+    /**
+     @brief     A calibration point's flattened location and how far the affine transform misses it by in map space.
+     */
+    struct Correction
+    {
+        double east;
+        double north;
+        MapPoint offset;
+    };
+
+    /** The location that is flattened to (0,0), and the number of metres per degree of longitude there. */
+    GeoPoint m_Origin;
+    double m_MetresPerDegreeLongitude;
+
+    /** The transform from flattened metres to map space, as x = a*east + b*north + c and y = d*east + e*north + f, and its inverse. */
+    double m_Forward[6];
+    double m_Inverse[6];
+
+    /** The correction at each calibration point. */
+    std::vector<Correction> m_Corrections;
+
+    /** The average map units per metre and the error of the fit in metres. */
+    float m_UnitsPerMetre;
+    float m_Error;
+
+    /** Whether or not the projection has been calibrated. */
+    bool m_IsCalibrated;
+};
+
+#endif // MAP_PROJECTION_H
@@ -9,9 +9,17 @@
 #include "MapScene.h"
 #include "Defines.h"
 #include "NewYorkMap.h"
+#include "AddressController.h"
+#include "DirectionsController.h"
+#include "LandmarkFilterController.h"
+#include "LandmarkSearchController.h"
+#include "TourController.h"
 
 using namespace cocos2d;
 
+// The colour of the buttons over the map.
+#define COLOUR_BUTTON_OVERLAY   ccc3(0, 150, 141)
+
 // Create a CCScene containing a MapScene layer.
 
 CCScene* MapScene::scene()
@@ -31,17 +39,76 @@ bool MapScene::init()
         return false;
     }
     
-    // Create a map for the user to navigate.
+    // Create a map for the user to navigate. It adds the layer displaying its landmarks above it once it has loaded.
     NewYorkMap* map = NewYorkMap::create();
-    if (map)
+    if (!map)
     {
-        addChild(map);
-        map->setPosition(ccp(WIN_SIZE.width/2, WIN_SIZE.height/2));
-        
-        return true;
+        return false;
     }
-    else
+    addChild(map);
+    map->setPosition(ccp(WIN_SIZE.width/2, WIN_SIZE.height/2));
+    
+    // Create the controllers which the map's features are built on. The address controller's label goes above the landmarks, along with the buttons.
+    AddressController* addresses = AddressController::create(map);
+    LandmarkSearchController* search = addresses ? LandmarkSearchController::create(map, addresses) : NULL;
+    LandmarkFilterController* filter = LandmarkFilterController::create(map);
+    DirectionsController* directions = addresses ? DirectionsController::create(map, addresses) : NULL;
+    TourController* tour = directions ? TourController::create(map, directions, addresses) : NULL;
+    if (!addresses || !search || !filter || !directions || !tour)
     {
         return false;
     }
+    addChild(addresses, map->getZOrder() + 2);
+    addChild(search);
+    addChild(filter);
+    addChild(directions);
+    addChild(tour);
+    
+    // Add buttons in the top-right corner for searching and filtering the landmarks and planning a tour of them, above the landmark layer.
+    ButtonBar* overlayButtons = ButtonBar::create();
+    if (overlayButtons)
+    {
+        addChild(overlayButtons, map->getZOrder() + 2);
+        
+        Button* searchButton = createOverlayButton(overlayButtons, "Search", search, callfunc_selector(LandmarkSearchController::showSearch));
+        Button* filterButton = createOverlayButton(overlayButtons, "Filter", filter, callfunc_selector(LandmarkFilterController::showFilter));
+        Button* tourButton = createOverlayButton(overlayButtons, "Tour", tour, callfunc_selector(TourController::showTour));
+        
+        if (searchButton && filterButton && tourButton)
+        {
+            CCSize overlayButtonSize = CCSizeMake(searchButton->getContentSize().width * searchButton->getScaleX(),
+                                                  searchButton->getContentSize().height * searchButton->getScaleY());
+            searchButton->setPosition(ccp(WIN_SIZE.width - overlayButtonSize.width*0.6f, WIN_SIZE.height - overlayButtonSize.height*0.8f));
+            filterButton->setPosition(ccp(WIN_SIZE.width - overlayButtonSize.width*0.6f, WIN_SIZE.height - overlayButtonSize.height*1.9f));
+            tourButton->setPosition(ccp(WIN_SIZE.width - overlayButtonSize.width*0.6f, WIN_SIZE.height - overlayButtonSize.height*3.0f));
+        }
+    }
+    
+    if (!overlayButtons || overlayButtons->getChildrenCount() < 3)
+    {
+        CCLOG("Failed to create the buttons over the map.");
+    }
+    
+    return true;
+}
+
+// Create one of the buttons displayed over the map and add it to a ButtonBar.
+
+Button* MapScene::createOverlayButton(ButtonBar* bar, const char* text, CCObject* target, SEL_CallFunc selector)
+{
+    Button* button = Button::create("buttonNormal.png", "buttonPressed.png", NULL, CCCallFunc::create(target, selector));
+    if (!button)
+    {
+        return NULL;
+    }
+    button->setColor(COLOUR_BUTTON_OVERLAY);
+    button->setScale(SCREEN_SCALE * 0.5f / button->getAssetScale());
+    
+    CCLabelTTF* label = CCLabelTTF::create(text, "Montserrat", 100);
+    label->setScale(button->getAssetScale());
+    label->setPosition(ccp(button->getContentSize().width/2, button->getContentSize().height/2));
+    button->addChild(label);
+    
+    bar->addButton(button);
+    return button;
 }
@@ -10,9 +10,12 @@
 #define MAP_SCENE_H
 
 #include "cocos2d.h"
+#include "ButtonBar.h"
 
 /**
  @brief    The layer in which the application displays itself to the user.
+
+ It holds the map, the controllers which search and filter its landmarks, look up the addresses tapped on it, find directions and plan tours over it, and the buttons over the map which open them.
  */
 class MapScene : public cocos2d::CCLayer
 {
@@ -39,6 +42,16 @@ protected:
      @return    false   The layer failed to initialize.
      */
     virtual bool init();
+    
+    /**
+     @brief     Create one of the buttons displayed over the map and add it to a ButtonBar.
+     @param     bar         The bar to add the button to.
+     @param     text        The button's label.
+     @param     target      The controller to call when the button is pressed.
+     @param     selector    The controller's method to call.
+     @return    A pointer to the button, or NULL if it couldn't be created.
+     */
+    Button* createOverlayButton(ButtonBar* bar, const char* text, cocos2d::CCObject* target, cocos2d::SEL_CallFunc selector);
 };
 
 #endif // MAP_SCENE_H
@@ -8,9 +8,63 @@
 
 #include "NewYorkMap.h"
 #include "CompositeSprite.h"
+#include "AssetResolver.h"
+#include "VectorMapNode.h"
+#include "LandmarkSearchIndex.h"
+#include "StreetData.h"
 
 using namespace cocos2d;
 
+// The vector map file which, if bundled, is displayed instead of the raster map.
+static const char* VECTOR_MAP_FILE = "newYorkMap.nyvm";
+
+// The landmark catalog, built from "landmarks.csv" by Tools/LandmarkCatalogBuilder.cpp. An updated catalog can be downloaded to the writable directory under the same name.
+static const char* LANDMARK_CATALOG_FILE = "landmarks.nylc";
+
+// The search index built from the catalog by Tools/LandmarkSearchIndexBuilder.cpp. An updated catalog is downloaded along with its own index.
+static const char* LANDMARK_SEARCH_INDEX_FILE = "landmarks.nyls";
+
+// The streets and places used to find the address of a tapped point and the location of a searched address, built from "streets.csv" and "places.csv" by Tools/StreetDataBuilder.cpp.
+static const char* STREET_DATA_FILE = "streets.nyst";
+
+/**
+ @brief     A place whose latitude and longitude are known along with where it is drawn on the map, from bottom-left (0,0) to top-right (1,1).
+ */
+struct NewYorkMapCalibration
+{
+    double latitude;
+    double longitude;
+    float x;
+    float y;
+};
+
+// The landmarks' real locations, which calibrate the map for placing the user's location on it. Landmarks which cover too much ground to have one location (ie. Broadway and Central Park) are left out.
+static const NewYorkMapCalibration MAP_CALIBRATION[] =
+{
+    { 40.7505, -73.9934, 0.425f, 0.64f },   // Madison Square Garden
+    { 40.6892, -74.0445, 0.07f, 0.05f },    // Statue of Liberty
+    { 40.6995, -74.0396, 0.07f, 0.2f },     // Ellis Island
+    { 40.7115, -74.0134, 0.28f, 0.24f },    // 9/11 Memorial
+    { 40.7060, -74.0088, 0.385f, 0.14f },   // Wall Street
+    { 40.7033, -74.0170, 0.245f, 0.14f },   // Battery Park
+    { 40.7127, -74.0152, 0.28f, 0.34f },    // Brookfield Place
+    { 40.7061, -73.9969, 0.55f, 0.1f },     // Brooklyn Bridge
+    { 40.7158, -73.9970, 0.44f, 0.31f },    // Chinatown
+    { 40.7168, -73.9747, 0.775f, 0.31f },   // East River Park
+    { 40.7236, -73.9951, 0.54f, 0.41f },    // Saint Patrick's Old Cathedral
+    { 40.7411, -73.9897, 0.475f, 0.54f },   // Flatiron Building
+    { 40.7484, -73.9857, 0.565f, 0.64f },   // Empire State Building
+    { 40.7516, -73.9755, 0.705f, 0.64f },   // Chrysler Building
+    { 40.7489, -73.9680, 0.845f, 0.59f },   // United Nations Headquarters
+    { 40.7580, -73.9855, 0.46f, 0.7f },     // Times Square
+    { 40.7587, -73.9787, 0.53f, 0.71f },    // Rockefeller Center
+    { 40.7651, -73.9799, 0.53f, 0.77f },    // Carnegie Hall
+    { 40.7725, -73.9835, 0.5f, 0.92f },     // The Metropolitan Opera House
+    { 40.7757, -73.9753, 0.62f, 0.91f },    // Strawberry Fields
+    { 40.7794, -73.9632, 0.77f, 0.96f },    // Metropolitan Museum of Art
+    { 40.7830, -73.9590, 0.91f, 0.94f }     // Guggenheim Museum
+};
+
 // Create a NewYorkMap instance.
 
 NewYorkMap* NewYorkMap::create()
@@ -40,15 +94,28 @@ bool NewYorkMap::init()
 
 void NewYorkMap::loadMap()
 {
-    // Create a loading popup to track the loading progress.
-    CCSprite* border = CCSprite::create("loadingBorder.png");
+    // If a vector map has been bundled, prefer it over the raster tiles. It is small enough to load without a loading popup.
+    if (CCFileUtils::sharedFileUtils()->isFileExist(CCFileUtils::sharedFileUtils()->fullPathForFilename(VECTOR_MAP_FILE)))
+    {
+        VectorMapNode* vectorMap = VectorMapNode::create(VECTOR_MAP_FILE);
+        if (vectorMap)
+        {
+            setUpMap(vectorMap);
+            return;
+        }
+    }
+    
+    // Create a loading popup to track the loading progress, using the image variants best suited to this device.
+    float borderAssetScale;
+    CCSprite* border = CCSprite::create(AssetResolver::resolve("loadingBorder.png", &borderAssetScale).c_str());
     border->setPosition(ccp(WIN_SIZE.width/2, WIN_SIZE.height/2));
-    border->setScale(SCREEN_SCALE);
+    border->setScale(SCREEN_SCALE / borderAssetScale);
     
-    ProgressBar* progressBar = ProgressBar::create("loadingProgress.png");
+    float progressAssetScale;
+    ProgressBar* progressBar = ProgressBar::create(AssetResolver::resolve("loadingProgress.png", &progressAssetScale).c_str());
     progressBar->setPosition(ccp(WIN_SIZE.width/2,
-                                 WIN_SIZE.height/2 - border->getContentSize().height*SCREEN_SCALE*0.389f));
-    progressBar->setScale(SCREEN_SCALE);
+                                 WIN_SIZE.height/2 - border->getContentSize().height*border->getScaleY()*0.389f));
+    progressBar->setScale(SCREEN_SCALE / progressAssetScale);
     
     LoadingPopup* popup = LoadingPopup::showPopup(border, progressBar);
     
@@ -67,177 +134,71 @@ void NewYorkMap::loadMap()
 
 void NewYorkMap::compositeSpriteFinishedLoading(CompositeSprite* sprite)
 {
-    if (!Map::init(sprite))
+    setUpMap(sprite);
+}
+
+// Initialize the Map with a map node which has finished loading and add the landmarks to it.
+
+void NewYorkMap::setUpMap(CCNode* mapNode)
+{
+    if (!Map::init(mapNode))
     {
         removeFromParentAndCleanup(true);
+        return;
     }
     
-    // Add the landmarks to the map.
-    
-    addLandmark(Landmark("Madison\nSquare Garden",
-                         "madisonSquareGarden",
-                         "An indoor, mutli-purpose arena\nas well as New York's oldest and\nbusiest sporting venue.",
-                         "Madison+Square+Garden+NYC",
-                         "http://www.thegarden.com/",
-                         "http://www.thegarden.com/calendar"),
-                ccp(0.425f, 0.64f));
-    
-    addLandmark(Landmark("Statue of Liberty",
-                         "statueOfLiberty",
-                         "A colossal monument in the image\nof Libertas, the Roman godess of\nfreedom. This statue was a gift from\nFrance and represents the idea\nof American liberty.",
-                         "Statue+of+Liberty+NYC",
-                         "http://www.statueofliberty.org/",
-                         "https://www.statueoflibertytickets.com/"),
-                ccp(0.07f, 0.05f));
-    
-    addLandmark(Landmark("Ellis Island",
-                         "ellisIsland",
-                         "Once America's busiest immigration\ninspection station, Ellis Island is now\npart of the Statue of Liberty momument\nand hosts an immigration museum.",
-                         "Ellis+Island+NYC",
-                         "https://www.ellisisland.org/",
-                         "http://www.statueoflibertytickets.com/Ellis-Island-Tour/"),
-                ccp(0.07f, 0.2f));
-    
-    addLandmark(Landmark("9/11 Memorial",
-                         "911memorial",
-                         "A national tribute to the men, women\nand children killed in the terrorist\nattacks of 2001 and 1993.",
-                         "9+11+Memorial+NYC",
-                         "http://www.911memorial.org/"),
-                ccp(0.28f, 0.24f));
-    
-    addLandmark(Landmark("Wall Street",
-                         "wallStreet",
-                         "Stretching from Broadway to\nSouth Street on the East River,\nWall Street is the financial district\nof New York City and home to the\nNew York Stock Exchange.",
-                         "NY+10004"),
-                ccp(0.385f, 0.14f));
-    
-    addLandmark(Landmark("Battery Park",
-                         "batteryPark",
-                         "Decades before Ellis Island or the\nStatue of Liberty were built, Battery\nPark welcomed new immigrants from\naround the world.",
-                         "Battery+Park+NYC",
-                         "http://www.nycgovparks.org/parks/batterypark"),
-                ccp(0.245f, 0.14f));
-    
-    addLandmark(Landmark("Brookfield Place",
-                         "worldFinancialCentre",
-                         "Formerly known as the \"World\nFinancial Center\", Brookfield Place is\na complex of towering office\nbuildings in Lower Manhattan.",
-                         "Brookfield+Place+NYC",
-                         "http://www.brookfieldplacenewsandevents.com/"),
-                ccp(0.28f, 0.34f));
-    
-    addLandmark(Landmark("Brooklyn Bridge",
-                         "brooklynBridge",
-                         "Spanning the East River and\nconnecting Brooklyn to the\nboroughs of Manhattan,the\nBrooklyn Bridge is one of the\noldest suspension bridges\nin the country.",
-                         "Brooklyn+Bridge+NYC"),
-                ccp(0.55f, 0.1f));
-    
-    addLandmark(Landmark("Chinatown",
-                         "chinaTown",
-                         "Chinatown is home to the largest\nenclave of Chinese people in the\nWestern Hemisphere as well as one\nof the largest Chinese populations.",
-                         "Chinatown+NYC",
-                         "http://www.explorechinatown.com/"),
-                ccp(0.44f, 0.31f));
-    
-    addLandmark(Landmark("East River Park",
-                         "eastRiverPark",
-                         "A 57.5-acre park stretching along the\nEast River which features an\namphitheater, numerous sports\ncourts and bike paths as well as\nother attractions.",
-                         "East+River+Park+NYC",
-                         "http://www.nycgovparks.org/parks/eastriverpark"),
-                ccp(0.775f, 0.31f));
-    
-    addLandmark(Landmark("Saint Patrick's\nOld Catherdral",
-                         "stPatricksOldCathedral",
-                         "The Basilica of St. Patrick's Old\nCathedral is an historic\nlandmark Catholic Church\nand cemetery.",
-                         "St+Patricks+Old+Cathedral+NYC"),
-                ccp(0.54f, 0.41f));
-    
-    addLandmark(Landmark("Flatiron\nBuilding",
-                         "flatironBuilding",
-                         "The Flatiron Building, originally\nthe Fuller Building, is\nconsidered to be a\ngroundbreaking skyscraper.",
-                         "Flatiron+Building+NYC"),
-                ccp(0.475f, 0.54f));
-    
-    addLandmark(Landmark("Empire State\nBuilding",
-                         "empireStateBuilding",
-                         "The Empire State Building is a\n103-story skyscraper located\nin Midtown Manhattan",
-                         "Empire+State+Building+NYC"),
-                ccp(0.565f, 0.64f));
-    
-    addLandmark(Landmark("Chrysler\nBuilding",
-                         "chryslerBuilding",
-                         "The Chrysler Building is an Art\nDeco style skyscraper in\nNew York City.",
-                         "Chrysler+Building+NYC"),
-                ccp(0.705f, 0.64f));
-    
-    addLandmark(Landmark("United Nations\nHeadquarters",
-                         "unitedNationsHeadquarters",
-                         "The headquarters of the United\nNations is a complex in\nNew York City.",
-                         "United+Nations+Headquarters+NYC",
-                         "http://www.un.org/cyberschoolbus/untour/subunh.htm"),
-                ccp(0.845f, 0.59f));
-    
-    addLandmark(Landmark("Times Square",
-                         "timesSquare",
-                         "Times Square is a major commercial\nintersection in Midtown Manhattan\nat the junction of Broadway and\nSeventh Avenue, stretching from\nWest 42nd to West 47th Street.",
-                         "Times+Square+NYC",
-                         "http://www.timessquarenyc.org/"),
-                ccp(0.46f, 0.7f));
-    
-    addLandmark(Landmark("Rockefeller\nCenter",
-                         "rockefellerCenter",
-                         "Rockefeller Center is a complex of 19\ncommercial buildings covering\n22 acres between 48th and 51st\nStreet in New York City",
-                         "Rockefeller+Center+NYC",
-                         "http://www.rockefellercenter.com/"),
-                ccp(0.53f, 0.71f));
-    
-    addLandmark(Landmark("Carnegie Hall",
-                         "carnegieHall",
-                         "A concert venue in Midtown\nManhattan, it is one of the\nmost prestigious venues in the\nworld for both classical music\nand popular music.",
-                         "Carnegie+Hall+NYC",
-                         "http://www.carnegiehall.org/",
-                         "http://www.carnegiehall.org/Calendar/"),
-                ccp(0.53f, 0.77f));
-    
-    addLandmark(Landmark("Broadway",
-                         "broadway",
-                         "A collection of high-calibur,\nworld-famous theatres.",
-                         "Broadway+NYC",
-                         "", "http://www.broadway.com/"),
-                ccp(0.485f, 0.85f));
+    // Calibrate the map against the landmarks' real locations, so that the user's location can be placed on it.
+    unsigned int calibrationCount = sizeof(MAP_CALIBRATION) / sizeof(MAP_CALIBRATION[0]);
+    std::vector<MapCalibrationPoint> calibration(calibrationCount);
+    for (unsigned int i = 0; i < calibrationCount; i++)
+    {
+        calibration[i].location = GeoPoint(MAP_CALIBRATION[i].latitude, MAP_CALIBRATION[i].longitude);
+        calibration[i].position = MapPoint(MAP_CALIBRATION[i].x, MAP_CALIBRATION[i].y);
+    }
+    if (!setCalibration(&calibration[0], calibrationCount))
+    {
+        CCLOG("Failed to calibrate the map.");
+    }
     
-    addLandmark(Landmark("The\nMetropolitan\nOpera House",
-                         "metropolitanOperaHouse",
-                         "Home to the Met, which is the\nlargest classical music\norganization in North America.",
-                         "Metropolitan+Opera+NYC",
-                         "https://www.metoperafamily.org/",
-                         "https://www.metoperafamily.org/metopera/season/index.aspx"),
-                ccp(0.5f, 0.92f));
+    // Map the street data, so that taps on the map can be turned into addresses, addresses can be searched for and walking routes can be found. Without it the map still works, but taps do nothing, only landmarks can be searched for and directions are left to Google Maps.
+    if (!StreetData::sharedData()->open(CCFileUtils::sharedFileUtils()->fullPathForFilename(STREET_DATA_FILE).c_str()))
+    {
+        CCLOG("Failed to open the street data \"%s\".", STREET_DATA_FILE);
+    }
     
-    addLandmark(Landmark("Strawberry\nFields",
-                         "strawberryFields",
-                         "A section of Central Park dedicated to\nthe memory of Beatles member John\nLennon. It is named after the\n Beatles song \"Strawberry\nFields Forever\".",
-                         "Central+Park+NYC",
-                         "http://www.centralpark.com/guide/attractions/strawberry-fields.html"),
-                ccp(0.62f, 0.91f));
+    // Add the landmarks to the map. The LandmarkStore keeps the catalog mapped and reads their strings from it in place, rather than copying them.
+    bool catalogIsUpdated;
+    if (!openLandmarkCatalog(&catalogIsUpdated))
+    {
+        CCLOG("Failed to open the landmark catalog \"%s\".", LANDMARK_CATALOG_FILE);
+        return;
+    }
     
-    addLandmark(Landmark("Central Park",
-                         "centralPark",
-                         "Central Park is an urban park in the\neastern portion of the central-\nupper West Side of Manhattan in\nNew York City.",
-                         "Central+Park+NYC",
-                         "http://www.centralpark.com/"),
-                ccp(0.7f, 0.975f));
+    // Map the search index which was built from the same catalog, so that it doesn't have to be built when the user first searches. If it is missing or was built from a different catalog (even one with as many landmarks), the LandmarkSearchController builds one from the LandmarkStore instead.
+    CCFileUtils* fileUtils = CCFileUtils::sharedFileUtils();
+    std::string indexPath = catalogIsUpdated ? fileUtils->getWritablePath() + LANDMARK_SEARCH_INDEX_FILE :
+                                               fileUtils->fullPathForFilename(LANDMARK_SEARCH_INDEX_FILE);
+    LandmarkSearchIndex* index = LandmarkSearchIndex::sharedIndex();
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    if (!index->open(indexPath.c_str()) || index->getCount() != store->getCount() || index->getCatalogChecksum() != store->getCatalogChecksum())
+    {
+        index->close();
+    }
+}
+
+// Load the landmarks from the landmark catalog.
+
+bool NewYorkMap::openLandmarkCatalog(bool* isUpdated)
+{
+    CCFileUtils* fileUtils = CCFileUtils::sharedFileUtils();
     
-    addLandmark(Landmark("Metropolitan\nMuseum of Art",
-                         "metropolitanMuseumOfArt",
-                         "The largest art museum in the\nUnited States, and one of the ten\nlargest in the world, with\nthe most significant\nart collections.",
-                         "Metropolitan+Museum+of+Art+NYC",
-                         "http://www.metmuseum.org/"),
-                ccp(0.77f, 0.96f));
+    // A downloaded catalog replaces the bundled one, so that landmarks can be updated without releasing the app again. If it is damaged, fall back on the bundled one.
+    std::string updatedPath = fileUtils->getWritablePath() + LANDMARK_CATALOG_FILE;
+    *isUpdated = fileUtils->isFileExist(updatedPath) && loadLandmarkCatalog(updatedPath.c_str());
+    if (*isUpdated)
+    {
+        return true;
+    }
     
-    addLandmark(Landmark("Guggenheim\nMuseum",
-                         "guggenheimMuseum",
-                         "The Guggenheim is a world-reknowned\nart museum located on the Upper East\nSide of Manhattan in New York City.",
-                         "Guggenheim+NYC",
-                         "http://www.guggenheim.org/"),
-                ccp(0.91f, 0.94f));
+    return loadLandmarkCatalog(fileUtils->fullPathForFilename(LANDMARK_CATALOG_FILE).c_str());
 }
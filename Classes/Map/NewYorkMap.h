@@ -43,6 +43,18 @@ protected:
      */
     void loadMap();
     
+    /**
+     @brief     Initialize the Map with a map node which has finished loading (raster or vector) and add the landmarks to it.
+     @param     mapNode     The node which visually represents the map.
+     */
+    void setUpMap(cocos2d::CCNode* mapNode);
+    
+    /**
+     @brief     Load the landmarks from the landmark catalog, preferring an updated copy in the writable directory over the one bundled with the app.
+     @param     isUpdated   Set to whether or not the updated copy was loaded.
+     @return    Whether or not a catalog was loaded.
+     */
+    bool openLandmarkCatalog(bool* isUpdated);
 };
 
 #endif // NEW_YORK_MAP_H
@@ -0,0 +1,98 @@
+//
+//  PolylineSimplifier.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "PolylineSimplifier.h"
+#include <algorithm>
+#include <float.h>
+
+using namespace std;
+
+/**
+ @brief     A stretch of a polyline still to be split, and the rank of the vertex it was split off at.
+ */
+struct PolylineSimplifierSpan
+{
+    unsigned int first;
+    unsigned int last;
+    float parentRank;
+};
+
+// Rank a polyline's vertices.
+
+void PolylineSimplifier::rankVertices(const vector<MapPoint>& line, vector<float>* ranks)
+{
+    if (line.size() < 2)
+    {
+        ranks->assign(line.size(), FLT_MAX);
+        return;
+    }
+
+    ranks->assign(line.size(), 0);
+    (*ranks)[0] = FLT_MAX;
+    (*ranks)[line.size() - 1] = FLT_MAX;
+
+    // Split the spans from a stack rather than by recursion, since a long line can be split very unevenly.
+    vector<PolylineSimplifierSpan> spans;
+    PolylineSimplifierSpan whole = { 0, (unsigned int)line.size() - 1, FLT_MAX };
+    spans.push_back(whole);
+
+    while (!spans.empty())
+    {
+        PolylineSimplifierSpan span = spans.back();
+        spans.pop_back();
+        if (span.last - span.first < 2)
+        {
+            continue;
+        }
+
+        unsigned int furthest = span.first + 1;
+        float furthestDistance = -1;
+        for (unsigned int i = span.first + 1; i < span.last; i++)
+        {
+            float distance = getDistanceToSegment(line[i], line[span.first], line[span.last]);
+            if (distance > furthestDistance)
+            {
+                furthest = i;
+                furthestDistance = distance;
+            }
+        }
+
+        float rank = min(furthestDistance, span.parentRank);
+        (*ranks)[furthest] = rank;
+
+        PolylineSimplifierSpan before = { span.first, furthest, rank };
+        PolylineSimplifierSpan after = { furthest, span.last, rank };
+        spans.push_back(before);
+        spans.push_back(after);
+    }
+}
+
+// Simplify a polyline whose vertices have been ranked.
+
+void PolylineSimplifier::selectVertices(const vector<MapPoint>& line, const vector<float>& ranks, float tolerance, vector<MapPoint>* simplified)
+{
+    simplified->clear();
+    for (unsigned int i = 0; i < line.size(); i++)
+    {
+        if (ranks[i] > tolerance)
+        {
+            simplified->push_back(line[i]);
+        }
+    }
+}
+
+// Get the distance from a point to the straight line between two others.
+
+float PolylineSimplifier::getDistanceToSegment(const MapPoint& point, const MapPoint& start, const MapPoint& end)
+{
+    // Measuring to the segment rather than to the infinite line through it keeps lines which double back on themselves (ie. loops, whose ends meet) from losing their far side.
+    MapPoint direction = end - start;
+    float lengthSquared = direction.dot(direction);
+    float fraction = (lengthSquared > 0) ? max(0.0f, min(1.0f, (point - start).dot(direction) / lengthSquared)) : 0;
+    return point.distance(start + direction * fraction);
+}
@@ -0,0 +1,55 @@
+//
+//  PolylineSimplifier.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef POLYLINE_SIMPLIFIER_H
+#define POLYLINE_SIMPLIFIER_H
+
+#include <vector>
+#include "MapPoint.h"
+
+/**
+ @brief     A helper class which simplifies polylines for drawing at smaller scales, by ranking their vertices once so that the vertices needed for any tolerance can be picked without simplifying the line again.
+
+ A vertex's rank is the tolerance up to which Douglas-Peucker simplification would keep it: the line is split at the vertex furthest from the straight line between its ends, which is ranked by that distance, and each half is split again in turn. A vertex is never ranked above the vertex its half was split at, so a line simplified to a larger tolerance only ever loses vertices, and picking the vertices ranked above a tolerance gives exactly the line that Douglas-Peucker would at that tolerance. The ends are always kept.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class PolylineSimplifier
+{
+public:
+
+    /**
+     @brief     Rank a polyline's vertices. This takes O(n log n) time for most lines, and O(n^2) at worst.
+     @param     line        The polyline's points.
+     @param     ranks       Receives the rank of each vertex, in map units. Existing contents are replaced.
+     */
+    static void rankVertices(const std::vector<MapPoint>& line, std::vector<float>* ranks);
+
+    /**
+     @brief     Simplify a polyline whose vertices have been ranked.
+     @param     line        The polyline's points.
+     @param     ranks       The rank of each vertex.
+     @param     tolerance   How far from the original line the simplified one may stray, in map units.
+     @param     simplified  Receives the vertices ranked above the tolerance, along with the ends. Existing contents are replaced.
+     */
+    static void selectVertices(const std::vector<MapPoint>& line, const std::vector<float>& ranks, float tolerance, std::vector<MapPoint>* simplified);
+
+private:
+
+    /**
+     @brief     Get the distance from a point to the straight line between two others.
+     */
+    static float getDistanceToSegment(const MapPoint& point, const MapPoint& start, const MapPoint& end);
+
+    /**
+     @brief     Default constructor. Declared as private because this class is not meant to be instantiated.
+     */
+    PolylineSimplifier() { }
+};
+
+#endif // POLYLINE_SIMPLIFIER_H
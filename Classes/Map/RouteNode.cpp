@@ -0,0 +1,264 @@
+//
+//  RouteNode.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "RouteNode.h"
+#include "PolylineSimplifier.h"
+#include <stddef.h>
+
+using namespace std;
+using namespace cocos2d;
+
+// The on-screen scale at which each zoom band begins, from the most zoomed out to the most zoomed in. The last band draws every vertex.
+static const unsigned int ZOOM_BAND_COUNT = 6;
+static const float ZOOM_BAND_SCALES[ZOOM_BAND_COUNT] = { 0.03125f, 0.0625f, 0.125f, 0.25f, 0.5f, 1.0f };
+
+// How far a simplified line may stray from the original on screen, as a fraction of its width.
+static const float SIMPLIFY_TOLERANCE = 0.125f;
+
+// The key the stroke shader is kept under in the shader cache, and its source. The extrusion is passed in as the texture coordinates, and the shader pushes each vertex out along it by half the width in map units.
+static const char* STROKE_PROGRAM_KEY = "RouteNode_Stroke";
+static const char* STROKE_VERTEX_SHADER =
+    "attribute vec4 a_position;                                                 \n"
+    "attribute vec2 a_texCoord;                                                 \n"
+    "attribute vec4 a_color;                                                    \n"
+    "uniform float u_halfWidth;                                                 \n"
+    "#ifdef GL_ES                                                               \n"
+    "varying lowp vec4 v_fragmentColor;                                         \n"
+    "#else                                                                      \n"
+    "varying vec4 v_fragmentColor;                                              \n"
+    "#endif                                                                     \n"
+    "void main()                                                                \n"
+    "{                                                                          \n"
+    "    vec4 position = vec4(a_position.xy + a_texCoord * u_halfWidth, 0.0, 1.0);\n"
+    "    gl_Position = CC_MVPMatrix * position;                                 \n"
+    "    v_fragmentColor = a_color;                                             \n"
+    "}                                                                          \n";
+static const char* STROKE_FRAGMENT_SHADER =
+    "#ifdef GL_ES                                                               \n"
+    "precision lowp float;                                                      \n"
+    "#endif                                                                     \n"
+    "varying vec4 v_fragmentColor;                                              \n"
+    "void main()                                                                \n"
+    "{                                                                          \n"
+    "    gl_FragColor = v_fragmentColor;                                        \n"
+    "}                                                                          \n";
+
+// Create a RouteNode instance with no lines.
+
+RouteNode* RouteNode::create(float width)
+{
+    RouteNode *node = new RouteNode();
+    if (node && node->init(width))
+    {
+        node->autorelease();
+        return node;
+    }
+    CC_SAFE_DELETE(node);
+    return NULL;
+}
+
+// Default constructor.
+
+RouteNode::RouteNode()
+: m_Width(1)
+, m_HalfWidthLocation(-1)
+{
+    VertexBuffer emptyBuffer = { 0, 0, false };
+    m_Buffers.assign(ZOOM_BAND_COUNT, emptyBuffer);
+}
+
+// Destructor. Frees the vertex buffers.
+
+RouteNode::~RouteNode()
+{
+    deleteBuffers();
+}
+
+// Initialize the node.
+
+bool RouteNode::init(float width)
+{
+    CCGLProgram* program = getStrokeProgram();
+    if (!CCNode::init() || !program)
+    {
+        return false;
+    }
+
+    m_Width = width;
+    setShaderProgram(program);
+    m_HalfWidthLocation = program->getUniformLocationForName("u_halfWidth");
+    return true;
+}
+
+// Add a line to draw.
+
+void RouteNode::addPolyline(const vector<MapPoint>& points, MapColor color)
+{
+    if (points.size() < 2)
+    {
+        return;
+    }
+
+    // Ranking the vertices now means that each zoom band only has to pick out the ones it needs.
+    m_Polylines.push_back(Polyline());
+    Polyline& polyline = m_Polylines.back();
+    polyline.points = points;
+    polyline.color = color;
+    PolylineSimplifier::rankVertices(polyline.points, &polyline.ranks);
+
+    deleteBuffers();
+}
+
+// Remove all of the lines.
+
+void RouteNode::clearPolylines()
+{
+    m_Polylines.clear();
+    deleteBuffers();
+}
+
+// Draw the buffer for the current zoom band.
+
+void RouteNode::draw(void)
+{
+    float scale = getScreenScale();
+    if (m_Polylines.empty() || scale <= 0)
+    {
+        return;
+    }
+
+    unsigned int zoomBand = getZoomBand(scale);
+    if (!m_Buffers[zoomBand].built)
+    {
+        buildBuffer(zoomBand);
+    }
+
+    const VertexBuffer& buffer = m_Buffers[zoomBand];
+    if (buffer.vertexCount == 0)
+    {
+        return;
+    }
+
+    // The width is given in map units, so that the map's scale brings it back to the same width on screen.
+    CC_NODE_DRAW_SETUP();
+    getShaderProgram()->setUniformLocationWith1f(m_HalfWidthLocation, m_Width / 2 / scale);
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position | kCCVertexAttribFlag_TexCoords | kCCVertexAttribFlag_Color);
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.name);
+    glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(MapStrokeVertex), (void*)offsetof(MapStrokeVertex, position));
+    glVertexAttribPointer(kCCVertexAttrib_TexCoords, 2, GL_FLOAT, GL_FALSE, sizeof(MapStrokeVertex), (void*)offsetof(MapStrokeVertex, extrusion));
+    glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(MapStrokeVertex), (void*)offsetof(MapStrokeVertex, color));
+    glDrawArrays(GL_TRIANGLES, 0, buffer.vertexCount);
+
+    // Sprites are drawn from client memory, so the buffer must not be left bound.
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWS(1);
+}
+
+// Get the scale the node is drawn at on screen.
+
+float RouteNode::getScreenScale()
+{
+    float scale = 1;
+    for (CCNode* node = this; node; node = node->getParent())
+    {
+        scale *= node->getScaleX();
+    }
+    return scale;
+}
+
+// Get the zoom band to draw at an on-screen scale.
+
+unsigned int RouteNode::getZoomBand(float scale)
+{
+    unsigned int zoomBand = 0;
+    while (zoomBand + 1 < ZOOM_BAND_COUNT && ZOOM_BAND_SCALES[zoomBand + 1] <= scale)
+    {
+        zoomBand++;
+    }
+    return zoomBand;
+}
+
+// Simplify and extrude every line for a zoom band, and upload them into its buffer.
+
+void RouteNode::buildBuffer(unsigned int zoomBand)
+{
+    // A band is used up to the start of the next one, which is where its lines appear largest and so where the tolerance must hold. The last band keeps every vertex.
+    float tolerance = (zoomBand + 1 == ZOOM_BAND_COUNT) ? 0 : m_Width * SIMPLIFY_TOLERANCE / ZOOM_BAND_SCALES[zoomBand + 1];
+
+    vector<MapStrokeVertex> vertices;
+    vector<MapPoint> simplified;
+    for (unsigned int i = 0; i < m_Polylines.size(); i++)
+    {
+        const Polyline& polyline = m_Polylines[i];
+        PolylineSimplifier::selectVertices(polyline.points, polyline.ranks, tolerance, &simplified);
+        Tessellator::extrudePolyline(simplified, polyline.color, vertices);
+    }
+
+    VertexBuffer& buffer = m_Buffers[zoomBand];
+    glGenBuffers(1, &buffer.name);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.name);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MapStrokeVertex), vertices.empty() ? NULL : &vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    buffer.vertexCount = vertices.size();
+    buffer.built = true;
+}
+
+// Free the buffers, so that they are built again the next time they are displayed.
+
+void RouteNode::deleteBuffers()
+{
+    for (unsigned int i = 0; i < m_Buffers.size(); i++)
+    {
+        if (m_Buffers[i].built)
+        {
+            glDeleteBuffers(1, &m_Buffers[i].name);
+        }
+        m_Buffers[i].name = 0;
+        m_Buffers[i].vertexCount = 0;
+        m_Buffers[i].built = false;
+    }
+}
+
+// Get the shader which extrudes the lines, creating it the first time it is needed.
+
+CCGLProgram* RouteNode::getStrokeProgram()
+{
+    CCShaderCache* cache = CCShaderCache::sharedShaderCache();
+    CCGLProgram* program = cache->programForKey(STROKE_PROGRAM_KEY);
+    if (program)
+    {
+        return program;
+    }
+
+    program = new CCGLProgram();
+    if (!program->initWithVertexShaderByteArray(STROKE_VERTEX_SHADER, STROKE_FRAGMENT_SHADER))
+    {
+        CCLOG("Failed to compile the route stroke shader.");
+        program->release();
+        return NULL;
+    }
+
+    program->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
+    program->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
+    program->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
+    if (!program->link())
+    {
+        CCLOG("Failed to link the route stroke shader.");
+        program->release();
+        return NULL;
+    }
+    program->updateUniforms();
+
+    // The cache keeps the program from here on.
+    cache->addProgram(program, STROKE_PROGRAM_KEY);
+    program->release();
+    return program;
+}
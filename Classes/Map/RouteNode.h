@@ -0,0 +1,135 @@
+//
+//  RouteNode.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef ROUTE_NODE_H
+#define ROUTE_NODE_H
+
+#include "cocos2d.h"
+#include <vector>
+#include "Tessellator.h"
+
+/**
+ @brief     A node which draws routes (or any other long polylines) over the map as lines of the same width on screen at any scale.
+
+ The node sits inside the Map along with the map node, so its points are in map space and it follows the map's transform for free. Its lines are extruded rather than stroked (see Tessellator::extrudePolyline(...)), and a shader of its own pushes each vertex out by the width that cancels out the map's scale, so they never need to be stroked again while the user pinches.
+
+ Drawing every vertex of a long line when zoomed out would waste vertices on detail smaller than a pixel, so each line's vertices are ranked by PolylineSimplifier when it is added. Each zoom band then gets its own vertex buffer holding every line simplified to a fraction of the line's width at that band's largest scale, built the first time that band is displayed, and the lines are all drawn with one call from it.
+ */
+class RouteNode : public cocos2d::CCNode
+{
+public:
+
+    /**
+     @brief     Create a RouteNode instance with no lines.
+     @param     width       The width of the lines on screen, in points.
+     @return    A pointer to the newly created RouteNode.
+     */
+    static RouteNode* create(float width);
+
+    /**
+     @brief     Destructor. Frees the vertex buffers.
+     */
+    virtual ~RouteNode();
+
+    /**
+     @brief     Add a line to draw.
+     @param     points      The line's points in map space.
+     @param     color       The colour of the line.
+     */
+    void addPolyline(const std::vector<MapPoint>& points, MapColor color);
+
+    /**
+     @brief     Remove all of the lines.
+     */
+    void clearPolylines();
+
+    /**
+     @brief     Get whether or not there are any lines to draw.
+     */
+    bool hasPolylines() const { return !m_Polylines.empty(); }
+
+    /**
+     @brief     Draw the buffer for the current zoom band, building it first if this is the first time the band has been displayed since the lines changed.
+     */
+    virtual void draw(void);
+
+protected:
+
+    /**
+     @brief     A line, and the rank of each of its vertices.
+     */
+    struct Polyline
+    {
+        std::vector<MapPoint> points;
+        std::vector<float> ranks;
+        MapColor color;
+    };
+
+    /**
+     @brief     A vertex buffer holding a triangle list.
+     */
+    struct VertexBuffer
+    {
+        GLuint name;
+        GLsizei vertexCount;
+        bool built;
+    };
+
+    /**
+     @brief     Default constructor.
+     */
+    RouteNode();
+
+    /**
+     @brief     Initialize the node.
+     @param     width       The width of the lines on screen, in points.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(float width);
+
+    /**
+     @brief     Get the scale the node is drawn at on screen, which is the product of its own and all of its ancestors' scales.
+     */
+    float getScreenScale();
+
+    /**
+     @brief     Get the zoom band to draw at an on-screen scale.
+     */
+    static unsigned int getZoomBand(float scale);
+
+    /**
+     @brief     Simplify and extrude every line for a zoom band, and upload them into its buffer.
+     */
+    void buildBuffer(unsigned int zoomBand);
+
+    /**
+     @brief     Free the buffers, so that they are built again the next time they are displayed.
+     */
+    void deleteBuffers();
+
+    /**
+     @brief     Get the shader which extrudes the lines, creating it the first time it is needed.
+     */
+    static cocos2d::CCGLProgram* getStrokeProgram();
+
+private:
+
+    /** The width of the lines on screen. */
+    float m_Width;
+
+    /** The lines. */
+    std::vector<Polyline> m_Polylines;
+
+    /** The simplified lines for each zoom band. */
+    std::vector<VertexBuffer> m_Buffers;
+
+    /** The location of the stroke shader's uniform for half the lines' width in map units. */
+    GLint m_HalfWidthLocation;
+};
+
+#endif // ROUTE_NODE_H
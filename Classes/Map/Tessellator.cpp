@@ -0,0 +1,256 @@
+//
+//  Tessellator.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#include "Tessellator.h"
+
+using namespace std;
+
+// Areas smaller than this are treated as zero, so that collinear points don't stall ear clipping.
+static const float AREA_EPSILON = 1e-6f;
+
+// Triangulate a simple polygon by ear clipping.
+
+bool Tessellator::fillPolygon(const vector<MapPoint>& ring, MapColor color, vector<MapVertex>& vertices)
+{
+    // Collect the ring's points without consecutive duplicates or a repeated closing point.
+    vector<MapPoint> points;
+    points.reserve(ring.size());
+    for (unsigned int i = 0; i < ring.size(); i++)
+    {
+        if (points.empty() || ring[i] != points.back())
+        {
+            points.push_back(ring[i]);
+        }
+    }
+    while (points.size() > 1 && points.front() == points.back())
+    {
+        points.pop_back();
+    }
+    if (points.size() < 3)
+    {
+        return false;
+    }
+
+    // Walk the points counter-clockwise regardless of how they were authored, so that a convex corner always has a positive cross product.
+    vector<unsigned int> remaining(points.size());
+    bool clockwise = getSignedArea(points) < 0;
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        remaining[i] = clockwise ? points.size() - 1 - i : i;
+    }
+
+    size_t firstVertex = vertices.size();
+    unsigned int current = 0;
+    unsigned int attempts = 0;
+
+    while (remaining.size() > 3)
+    {
+        // If every corner has been tried without finding an ear, the polygon isn't simple.
+        if (attempts > remaining.size())
+        {
+            vertices.resize(firstVertex);
+            return false;
+        }
+
+        unsigned int count = remaining.size();
+        unsigned int previous = (current + count - 1) % count;
+        unsigned int next = (current + 1) % count;
+        const MapPoint& a = points[remaining[previous]];
+        const MapPoint& b = points[remaining[current]];
+        const MapPoint& c = points[remaining[next]];
+        float corner = (b - a).cross(c - b);
+
+        // Collinear corners add nothing to the fill and can simply be dropped.
+        if (fabsf(corner) <= AREA_EPSILON)
+        {
+            remaining.erase(remaining.begin() + current);
+            current = current % remaining.size();
+            attempts = 0;
+            continue;
+        }
+
+        // A convex corner is an ear if no other corner lies inside the triangle it forms.
+        bool isEar = (corner > 0);
+        for (unsigned int i = 0; isEar && i < count; i++)
+        {
+            if (i != previous && i != current && i != next)
+            {
+                const MapPoint& point = points[remaining[i]];
+                if (point != a && point != b && point != c && triangleContainsPoint(a, b, c, point))
+                {
+                    isEar = false;
+                }
+            }
+        }
+
+        if (isEar)
+        {
+            addTriangle(a, b, c, color, vertices);
+            remaining.erase(remaining.begin() + current);
+            current = (current + remaining.size() - 1) % remaining.size();
+            attempts = 0;
+        }
+        else
+        {
+            current = next;
+            attempts++;
+        }
+    }
+
+    // Whatever is left is the final triangle.
+    const MapPoint& a = points[remaining[0]];
+    const MapPoint& b = points[remaining[1]];
+    const MapPoint& c = points[remaining[2]];
+    if (fabsf((b - a).cross(c - b)) > AREA_EPSILON)
+    {
+        addTriangle(a, b, c, color, vertices);
+    }
+
+    return true;
+}
+
+// Turn a polyline into a strip of quads of a given width.
+
+void Tessellator::strokePolyline(const vector<MapPoint>& line, float width, MapColor color, vector<MapVertex>& vertices)
+{
+    float halfWidth = width / 2;
+    bool hasPreviousSegment = false;
+    MapPoint previousOffset;
+    MapPoint previousDirection;
+
+    for (unsigned int i = 0; i + 1 < line.size(); i++)
+    {
+        MapPoint start = line[i];
+        MapPoint end = line[i + 1];
+        float length = end.distance(start);
+        if (length <= 0)
+        {
+            continue;
+        }
+
+        // Offset both ends of the segment by half the width on either side.
+        MapPoint direction = (end - start) * (1.0f / length);
+        MapPoint offset = MapPoint(-direction.y, direction.x) * halfWidth;
+
+        addTriangle(start + offset, start - offset, end - offset, color, vertices);
+        addTriangle(start + offset, end - offset, end + offset, color, vertices);
+
+        // Fill the wedge left open on the outside of the corner with the previous segment.
+        if (hasPreviousSegment)
+        {
+            float turn = previousDirection.cross(direction);
+            if (turn > 0)
+            {
+                addTriangle(start, start - previousOffset, start - offset, color, vertices);
+            }
+            else if (turn < 0)
+            {
+                addTriangle(start, start + offset, start + previousOffset, color, vertices);
+            }
+        }
+
+        hasPreviousSegment = true;
+        previousOffset = offset;
+        previousDirection = direction;
+    }
+}
+
+// Turn a polyline into a stroke of no width yet, which a shader gives its width.
+
+void Tessellator::extrudePolyline(const vector<MapPoint>& line, MapColor color, vector<MapStrokeVertex>& vertices)
+{
+    bool hasPreviousSegment = false;
+    MapPoint previousOffset;
+    MapPoint previousDirection;
+    MapPoint none;
+
+    for (unsigned int i = 0; i + 1 < line.size(); i++)
+    {
+        MapPoint start = line[i];
+        MapPoint end = line[i + 1];
+        float length = end.distance(start);
+        if (length <= 0)
+        {
+            continue;
+        }
+
+        // The same triangles as strokePolyline(...), with each offset kept apart from the point it offsets.
+        MapPoint direction = (end - start) * (1.0f / length);
+        MapPoint offset = MapPoint(-direction.y, direction.x);
+
+        addStrokeVertex(start, offset, color, vertices);
+        addStrokeVertex(start, offset * -1, color, vertices);
+        addStrokeVertex(end, offset * -1, color, vertices);
+        addStrokeVertex(start, offset, color, vertices);
+        addStrokeVertex(end, offset * -1, color, vertices);
+        addStrokeVertex(end, offset, color, vertices);
+
+        if (hasPreviousSegment)
+        {
+            float turn = previousDirection.cross(direction);
+            if (turn != 0)
+            {
+                float side = (turn > 0) ? -1 : 1;
+                addStrokeVertex(start, none, color, vertices);
+                addStrokeVertex(start, (turn > 0 ? previousOffset : offset) * side, color, vertices);
+                addStrokeVertex(start, (turn > 0 ? offset : previousOffset) * side, color, vertices);
+            }
+        }
+
+        hasPreviousSegment = true;
+        previousOffset = offset;
+        previousDirection = direction;
+    }
+}
+
+// Get the signed area of a polygon.
+
+float Tessellator::getSignedArea(const vector<MapPoint>& ring)
+{
+    float area = 0;
+    for (unsigned int i = 0; i < ring.size(); i++)
+    {
+        area += ring[i].cross(ring[(i + 1) % ring.size()]);
+    }
+    return area / 2;
+}
+
+// Append one triangle to a triangle list.
+
+void Tessellator::addTriangle(const MapPoint& a, const MapPoint& b, const MapPoint& c, MapColor color, vector<MapVertex>& vertices)
+{
+    MapVertex vertex;
+    vertex.color = color;
+
+    vertex.position = a;
+    vertices.push_back(vertex);
+    vertex.position = b;
+    vertices.push_back(vertex);
+    vertex.position = c;
+    vertices.push_back(vertex);
+}
+
+// Check whether or not a point lies inside (or on the edge of) a counter-clockwise triangle.
+
+bool Tessellator::triangleContainsPoint(const MapPoint& a, const MapPoint& b, const MapPoint& c, const MapPoint& point)
+{
+    return ((b - a).cross(point - a) >= 0 &&
+            (c - b).cross(point - b) >= 0 &&
+            (a - c).cross(point - c) >= 0);
+}
+
+// Append one vertex of an extruded stroke to a triangle list.
+
+void Tessellator::addStrokeVertex(const MapPoint& position, const MapPoint& extrusion, MapColor color, vector<MapStrokeVertex>& vertices)
+{
+    MapStrokeVertex vertex;
+    vertex.position = position;
+    vertex.extrusion = extrusion;
+    vertex.color = color;
+    vertices.push_back(vertex);
+}
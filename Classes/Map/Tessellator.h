@@ -0,0 +1,110 @@
+//
+//  Tessellator.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#ifndef TESSELLATOR_H
+#define TESSELLATOR_H
+
+#include <vector>
+#include "MapPoint.h"
+
+/**
+ @brief     An 8-bit RGBA colour which doesn't depend on cocos2d (laid out the same way as ccColor4B).
+ */
+struct MapColor
+{
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+};
+
+/**
+ @brief     A coloured vertex in map space, laid out so that it can be uploaded as-is for cocos2d's position/colour shader.
+ */
+struct MapVertex
+{
+    MapPoint position;
+    MapColor color;
+};
+
+/**
+ @brief     A coloured vertex of a stroke whose width is applied when it is drawn: the vertex lies on the line, and is pushed out along its extrusion by half the width (see Tessellator::extrudePolyline(...)).
+ */
+struct MapStrokeVertex
+{
+    MapPoint position;
+    MapPoint extrusion;
+    MapColor color;
+};
+
+/**
+ @brief     A helper class which turns vector map geometry into triangle lists that can be drawn without any further processing.
+
+ This class has no dependencies on cocos2d or OpenGL so that it can be built and tested on its own.
+ */
+class Tessellator
+{
+public:
+
+    /**
+     @brief     Triangulate a simple polygon (convex or concave, in either winding order) by ear clipping.
+     @param     ring        The polygon's outline. The first point may be repeated at the end.
+     @param     color       The colour given to every vertex.
+     @param     vertices    The triangle list that the polygon's triangles are appended to.
+     @return    Whether or not the polygon could be triangulated. If not (ie. it intersects itself), nothing is appended.
+     */
+    static bool fillPolygon(const std::vector<MapPoint>& ring, MapColor color, std::vector<MapVertex>& vertices);
+
+    /**
+     @brief     Turn a polyline into a strip of quads of a given width, with bevelled joins so that corners don't leave gaps.
+     @param     line        The polyline's points.
+     @param     width       The width of the stroke in map units.
+     @param     color       The colour given to every vertex.
+     @param     vertices    The triangle list that the stroke's triangles are appended to.
+     */
+    static void strokePolyline(const std::vector<MapPoint>& line, float width, MapColor color, std::vector<MapVertex>& vertices);
+
+    /**
+     @brief     Turn a polyline into the same strip of quads and bevelled joins as strokePolyline(...), but of no width yet, so that a shader can give it any width (ie. the same width on screen at every scale) without it being stroked again.
+     @param     line        The polyline's points.
+     @param     color       The colour given to every vertex.
+     @param     vertices    The triangle list that the stroke's triangles are appended to, with a unit-length extrusion on each vertex off the line.
+     */
+    static void extrudePolyline(const std::vector<MapPoint>& line, MapColor color, std::vector<MapStrokeVertex>& vertices);
+
+    /**
+     @brief     Get the signed area of a polygon, which is positive if its points wind counter-clockwise.
+     @param     ring        The polygon's outline.
+     @return    The signed area.
+     */
+    static float getSignedArea(const std::vector<MapPoint>& ring);
+
+private:
+
+    /**
+     @brief     Append one triangle to a triangle list.
+     */
+    static void addTriangle(const MapPoint& a, const MapPoint& b, const MapPoint& c, MapColor color, std::vector<MapVertex>& vertices);
+
+    /**
+     @brief     Append one vertex of an extruded stroke to a triangle list.
+     */
+    static void addStrokeVertex(const MapPoint& position, const MapPoint& extrusion, MapColor color, std::vector<MapStrokeVertex>& vertices);
+
+    /**
+     @brief     Check whether or not a point lies inside (or on the edge of) a counter-clockwise triangle.
+     */
+    static bool triangleContainsPoint(const MapPoint& a, const MapPoint& b, const MapPoint& c, const MapPoint& point);
+
+    /**
+     @brief     Default constructor. Declared as private because this class is not meant to be instantiated.
+     */
+    Tessellator() { }
+};
+
+#endif // TESSELLATOR_H
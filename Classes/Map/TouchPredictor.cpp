@@ -0,0 +1,130 @@
+//
+//  TouchPredictor.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-01.
+//
+//
+
+#include "TouchPredictor.h"
+
+const double TouchPredictor::MAX_LEAD = 0.05;
+const float TouchPredictor::MAX_DISTANCE = 64.0f;
+
+// Predictions are made at full strength up to this far ahead of the latest sample, then fade out until MAX_LEAD. A touch which hasn't been reported for longer than this has probably stopped.
+static const double FADE_START = 0.025;
+
+// Default constructor.
+
+TouchPredictor::TouchPredictor()
+: m_Count(0)
+{
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        m_Times[i] = 0;
+    }
+}
+
+// Forget every sample and start again from a touch's first position.
+
+void TouchPredictor::reset(const MapPoint& location, double time)
+{
+    m_Locations[0] = location;
+    m_Times[0] = time;
+    m_Count = 1;
+}
+
+// Add a new sample of the touch's position.
+
+void TouchPredictor::addSample(const MapPoint& location, double time)
+{
+    if (m_Count == 0)
+    {
+        reset(location, time);
+        return;
+    }
+
+    // Samples without any time between them can't give a velocity, so the newer one replaces the older.
+    if (time <= m_Times[m_Count - 1])
+    {
+        m_Locations[m_Count - 1] = location;
+        return;
+    }
+
+    if (m_Count == SAMPLE_COUNT)
+    {
+        for (int i = 1; i < SAMPLE_COUNT; i++)
+        {
+            m_Locations[i - 1] = m_Locations[i];
+            m_Times[i - 1] = m_Times[i];
+        }
+        m_Count--;
+    }
+
+    m_Locations[m_Count] = location;
+    m_Times[m_Count] = time;
+    m_Count++;
+}
+
+// Predict where the touch will be at a point in time.
+
+MapPoint TouchPredictor::predict(double time) const
+{
+    if (m_Count < 2)
+    {
+        return getLatest();
+    }
+
+    const MapPoint& latest = m_Locations[m_Count - 1];
+    double lead = time - m_Times[m_Count - 1];
+    if (lead <= 0 || lead >= MAX_LEAD)
+    {
+        return latest;
+    }
+
+    // Measure the velocity over the latest interval...
+    double interval = m_Times[m_Count - 1] - m_Times[m_Count - 2];
+    MapPoint velocity = (latest - m_Locations[m_Count - 2]) * (float)(1 / interval);
+    MapPoint acceleration;
+
+    // ...and, if there are enough samples, the acceleration between the two latest intervals.
+    if (m_Count == 3)
+    {
+        double previousInterval = m_Times[1] - m_Times[0];
+        MapPoint previousVelocity = (m_Locations[1] - m_Locations[0]) * (float)(1 / previousInterval);
+
+        // A touch which has just turned around is about to do something the samples can't tell us, so don't guess.
+        if (velocity.dot(previousVelocity) < 0)
+        {
+            return latest;
+        }
+
+        acceleration = (velocity - previousVelocity) * (float)(2 / (interval + previousInterval));
+    }
+
+    // Acceleration is the noisiest part of the estimate. It may slow the touch down to a stop, but never turn it around or more than double its speed.
+    float leadSeconds = (float)lead;
+    MapPoint velocityPart = velocity * leadSeconds;
+    MapPoint accelerationPart = acceleration * (0.5f * leadSeconds * leadSeconds);
+    float velocityLength = velocityPart.length();
+    float accelerationLength = accelerationPart.length();
+    if (accelerationLength > velocityLength && accelerationLength > 0)
+    {
+        accelerationPart = accelerationPart * (velocityLength / accelerationLength);
+    }
+    MapPoint displacement = velocityPart + accelerationPart;
+
+    // Fade the prediction out as the latest sample gets old, and never predict too far from it.
+    if (lead > FADE_START)
+    {
+        displacement = displacement * (float)((MAX_LEAD - lead) / (MAX_LEAD - FADE_START));
+    }
+
+    float distance = displacement.length();
+    if (distance > MAX_DISTANCE)
+    {
+        displacement = displacement * (MAX_DISTANCE / distance);
+    }
+
+    return latest + displacement;
+}
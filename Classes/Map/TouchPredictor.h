@@ -0,0 +1,73 @@
+//
+//  TouchPredictor.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-01.
+//
+//
+
+#ifndef TOUCH_PREDICTOR_H
+#define TOUCH_PREDICTOR_H
+
+#include "MapPoint.h"
+
+/**
+ @brief     Extrapolates a moving touch a short way into the future, so that whatever follows the finger can be drawn where the finger will be when the frame is displayed rather than where it was last reported.
+
+ The prediction uses the touch's velocity and acceleration over its three most recent samples. It is deliberately cautious: it is limited in how far ahead and how far away it will predict, it fades out as the latest sample gets old (ie. when the finger stops), and it gives up entirely when the touch changes direction.
+
+ This class has no dependencies on cocos2d so that its predictions can be checked against recorded gestures (see Tools/GestureReplayer.cpp).
+ */
+class TouchPredictor
+{
+public:
+
+    /** The furthest ahead of the latest sample a touch is ever predicted, in seconds. */
+    static const double MAX_LEAD;
+
+    /** The furthest from the latest sample a touch is ever predicted, in view units. */
+    static const float MAX_DISTANCE;
+
+    /**
+     @brief     Default constructor. The predictor has no samples until it is reset.
+     */
+    TouchPredictor();
+
+    /**
+     @brief     Forget every sample and start again from a touch's first position.
+     @param     location    The touch's position in view space.
+     @param     time        The time at which the touch was at that position.
+     */
+    void reset(const MapPoint& location, double time);
+
+    /**
+     @brief     Add a new sample of the touch's position.
+     @param     location    The touch's position in view space.
+     @param     time        The time at which the touch was at that position.
+     */
+    void addSample(const MapPoint& location, double time);
+
+    /**
+     @brief     Predict where the touch will be at a point in time.
+     @param     time        The time to predict for, normally when the next frame will be displayed.
+     @return    The predicted position, or the latest sample if no prediction can be made with confidence.
+     */
+    MapPoint predict(double time) const;
+
+    /**
+     @brief     Get the touch's most recent position.
+     */
+    const MapPoint& getLatest() const { return m_Locations[m_Count > 0 ? m_Count - 1 : 0]; }
+
+private:
+
+    /** The number of samples the prediction is made from. */
+    static const int SAMPLE_COUNT = 3;
+
+    /** The most recent samples, oldest first. */
+    MapPoint m_Locations[SAMPLE_COUNT];
+    double m_Times[SAMPLE_COUNT];
+    int m_Count;
+};
+
+#endif // TOUCH_PREDICTOR_H
@@ -0,0 +1,211 @@
+//
+//  TourController.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#include "TourController.h"
+#include "Defines.h"
+#include "LandmarkStore.h"
+#include "StreetData.h"
+#include <algorithm>
+
+using namespace cocos2d;
+
+// The most landmarks a tour visits, the most stops the tour planner's distances are kept for before they are cleared, and the number of threads they are worked out on.
+#define TOUR_MAX_LANDMARKS      50
+#define TOUR_MAX_CACHED_STOPS   500
+#define TOUR_THREAD_COUNT       2
+
+// How long planning a tour may take in seconds, from adding its stops to drawing it, and how much of that is kept back for finding the routes between the stops once their order is known.
+#define TOUR_TIME_LIMIT         0.1
+#define TOUR_ROUTING_TIME       0.02
+
+// Create a TourController for a map.
+
+TourController* TourController::create(Map* map, DirectionsController* directions, AddressController* addresses)
+{
+    TourController *controller = new TourController();
+    if (controller && controller->init(map, directions, addresses))
+    {
+        controller->autorelease();
+        return controller;
+    }
+    CC_SAFE_DELETE(controller);
+    return NULL;
+}
+
+// Default constructor.
+
+TourController::TourController()
+: m_Map(NULL)
+, m_Directions(NULL)
+, m_Addresses(NULL)
+, m_TourDistances(NULL)
+{
+}
+
+// Destructor.
+
+TourController::~TourController()
+{
+    CC_SAFE_DELETE(m_TourDistances);
+    CC_SAFE_RELEASE(m_Map);
+    CC_SAFE_RELEASE(m_Directions);
+    CC_SAFE_RELEASE(m_Addresses);
+}
+
+// Initialize the controller for a map.
+
+bool TourController::init(Map* map, DirectionsController* directions, AddressController* addresses)
+{
+    if (!map || !directions || !addresses || !CCNode::init())
+    {
+        return false;
+    }
+    
+    m_Map = map;
+    m_Map->retain();
+    m_Directions = directions;
+    m_Directions->retain();
+    m_Addresses = addresses;
+    m_Addresses->retain();
+    m_TourDistances = new StreetDistanceMatrix(m_Directions->getStreetGraph());
+    return true;
+}
+
+// Plan the shortest walk the tour planner can find through some landmarks and draw it over the map.
+
+bool TourController::planTour(const std::vector<LandmarkID>& landmarks)
+{
+    double startTime = Map::getCurrentTime();
+    StreetData* data = StreetData::sharedData();
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    if (!m_Directions->buildStreetGraph())
+    {
+        return false;
+    }
+    
+    // The distances already worked out for earlier tours are kept, unless there are so many that they take up too much memory.
+    if (m_TourDistances->getStopCount() + landmarks.size() + 1 > TOUR_MAX_CACHED_STOPS)
+    {
+        m_TourDistances->clear();
+    }
+    
+    // Start from the user's address if there is one. Landmarks at the same place as a stop already added (ie. two in the same building) are only visited once.
+    std::vector<unsigned int> stops;
+    bool startsAtOrigin = false;
+    GeoPoint origin;
+    if (m_Addresses->getRouteOrigin(&origin))
+    {
+        unsigned int stop = m_TourDistances->addStop(data->flatten(origin));
+        if (stop != StreetDistanceMatrix::NO_STOP)
+        {
+            stops.push_back(stop);
+            startsAtOrigin = true;
+        }
+    }
+    
+    for (unsigned int i = 0; i < landmarks.size(); i++)
+    {
+        if (store->isValid(landmarks[i]))
+        {
+            unsigned int stop = m_TourDistances->addStop(data->flatten(m_Directions->getLandmarkLocation(landmarks[i])));
+            if (stop != StreetDistanceMatrix::NO_STOP && std::find(stops.begin(), stops.end(), stop) == stops.end())
+            {
+                stops.push_back(stop);
+            }
+        }
+    }
+    
+    if (stops.size() < 2)
+    {
+        return false;
+    }
+    
+    unsigned int pendingCount = m_TourDistances->getPendingCount();
+    m_TourDistances->update(TOUR_THREAD_COUNT);
+    double matrixTime = Map::getCurrentTime() - startTime;
+    
+    // Leave out any stops which can't be walked to from the start, since the streets they are on aren't connected to it.
+    std::vector<unsigned int> reachableStops(1, stops[0]);
+    for (unsigned int i = 1; i < stops.size(); i++)
+    {
+        if (m_TourDistances->getDistance(stops[0], stops[i]) != StreetGraph::UNREACHABLE)
+        {
+            reachableStops.push_back(stops[i]);
+        }
+    }
+    stops.swap(reachableStops);
+    
+    // The planner can have whatever time is left, apart from the time kept back for routing.
+    TourPlan plan;
+    TourPlanner planner(m_TourDistances, 1);
+    double timeBudget = MAX(startTime + TOUR_TIME_LIMIT - TOUR_ROUTING_TIME - Map::getCurrentTime(), 0.0);
+    if (stops.size() < 2 || !planner.planTour(stops, false, timeBudget, &plan))
+    {
+        return false;
+    }
+    
+    // Draw the route of each leg of the tour.
+    std::vector<std::vector<MapPoint> > routes;
+    StreetRoute route;
+    for (unsigned int i = 1; i < plan.order.size(); i++)
+    {
+        if (m_Directions->findRoute(m_TourDistances->getPoint(stops[plan.order[i - 1]]), m_TourDistances->getPoint(stops[plan.order[i]]), &route))
+        {
+            routes.push_back(route.points);
+        }
+    }
+    m_Directions->showRoutes(routes);
+    
+    if (DISPLAY_PERFORMANCE_MESSAGES)
+    {
+        CCLOG("Planned a %.0f metre tour of %u stops in %.1f ms, %.1f ms of it working out the distances to %u new stops (%u moves, %u kicks).",
+              plan.length, (unsigned int)stops.size(), (Map::getCurrentTime() - startTime) * 1000, matrixTime * 1000, pendingCount, plan.improvements, plan.kicks);
+    }
+    
+    char text[256];
+    unsigned int landmarkCount = startsAtOrigin ? stops.size() - 1 : stops.size();
+    snprintf(text, sizeof(text), "%.0f min walk to see %u landmarks (%.1f km)", ceilf(plan.length / WALKING_SPEED / 60), landmarkCount, plan.length / 1000);
+    m_Addresses->displayText(text, false);
+    return true;
+}
+
+// Plan a tour of the landmarks on screen which are displayed through the category filter.
+
+void TourController::showTour()
+{
+    MapPoint minimum, maximum;
+    m_Map->getVisibleArea(&minimum, &maximum);
+    MapPoint centre = (minimum + maximum) * 0.5f;
+    
+    // Sort the landmarks by their distance from the middle of the screen, so that the nearest are kept if there are too many.
+    LandmarkStore* store = LandmarkStore::sharedStore();
+    LandmarkLayer* layer = m_Map->getLandmarkLayer();
+    unsigned int categoryFilter = layer ? layer->getCategoryFilter() : 0;
+    std::vector<std::pair<float, LandmarkID> > candidates;
+    for (LandmarkID landmark = 0; landmark < store->getCount(); landmark++)
+    {
+        const MapPoint& position = store->getPosition(landmark);
+        if (position.x >= minimum.x && position.x <= maximum.x && position.y >= minimum.y && position.y <= maximum.y &&
+            (categoryFilter == 0 || (store->getCategories(landmark) & categoryFilter) != 0))
+        {
+            candidates.push_back(std::make_pair(position.distance(centre), landmark));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    
+    std::vector<LandmarkID> landmarks;
+    for (unsigned int i = 0; i < candidates.size() && i < TOUR_MAX_LANDMARKS; i++)
+    {
+        landmarks.push_back(candidates[i].second);
+    }
+    
+    if (!planTour(landmarks))
+    {
+        m_Addresses->displayText("Zoom in on the landmarks you'd like to visit.", false);
+    }
+}
@@ -0,0 +1,81 @@
+//
+//  TourController.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-18.
+//
+//
+
+#ifndef TOUR_CONTROLLER_H
+#define TOUR_CONTROLLER_H
+
+#include "cocos2d.h"
+#include <vector>
+#include "Map.h"
+#include "AddressController.h"
+#include "DirectionsController.h"
+#include "TourPlanner.h"
+
+/**
+ @brief     A controller which plans walking tours of the landmarks on screen and draws them over the map.
+
+ Tours are found and drawn through a DirectionsController. The walking distances between the stops are kept between tours, so that each landmark's distances are only worked out once. They are measured through the DirectionsController's street graph, which is only built once, so they stay valid for as long as the controller does.
+ */
+class TourController : public cocos2d::CCNode
+{
+public:
+    
+    /**
+     @brief     Create a TourController for a map.
+     @param     map         The map to plan tours over. It is retained.
+     @param     directions  The controller whose street graph tours are found through, and which draws them. It is retained.
+     @param     addresses   The controller whose last address tours start from, and whose label displays their lengths. It is retained.
+     @return    A pointer to the newly created TourController.
+     */
+    static TourController* create(Map* map, DirectionsController* directions, AddressController* addresses);
+    
+    /**
+     @brief     Default constructor.
+     */
+    TourController();
+    
+    /**
+     @brief     Destructor. Releases the map and the other controllers.
+     */
+    virtual ~TourController();
+    
+    /**
+     @brief     Plan the shortest walk the tour planner can find through some landmarks and draw it over the map, starting from the last address the user tapped or searched for if there has been one, or from the first landmark if not.
+     @param     landmarks   The IDs of the landmarks to visit. Any which are too far from a street, or which can't be walked to from the start, are left out.
+     @return    Whether or not a tour was planned. There is none unless there are at least two stops to walk between.
+     */
+    bool planTour(const std::vector<LandmarkID>& landmarks);
+    
+    /**
+     @brief     Plan a tour of the landmarks on screen which are displayed through the category filter, nearest the middle of the screen first if there are too many to visit.
+     */
+    void showTour();
+    
+protected:
+    
+    /**
+     @brief     Initialize the controller for a map.
+     @param     map         The map to plan tours over.
+     @param     directions  The controller whose street graph tours are found through.
+     @param     addresses   The controller whose last address tours start from.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(Map* map, DirectionsController* directions, AddressController* addresses);
+    
+private:
+    
+    /** The map to plan tours over, the controller whose street graph they are found through, and the controller whose last address they start from. */
+    Map* m_Map;
+    DirectionsController* m_Directions;
+    AddressController* m_Addresses;
+    
+    /** The walking distances between the stops of the tours planned so far. */
+    StreetDistanceMatrix* m_TourDistances;
+};
+
+#endif // TOUR_CONTROLLER_H
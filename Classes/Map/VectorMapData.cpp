@@ -0,0 +1,112 @@
+//
+//  VectorMapData.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#include "VectorMapData.h"
+#include <string.h>
+
+using namespace std;
+
+// The file's identifying bytes and the only version this code understands.
+static const char* FILE_MAGIC = "NYVM";
+static const unsigned short FILE_VERSION = 1;
+
+// The size in bytes of the file header, a feature header and a point.
+static const unsigned long HEADER_SIZE = 20;
+static const unsigned long FEATURE_HEADER_SIZE = 8;
+static const unsigned long POINT_SIZE = 4;
+
+// Feature flags.
+static const unsigned char FLAG_MINOR = 1 << 0;
+
+// Read little-endian values regardless of the host's byte order or alignment.
+
+static unsigned short readUInt16(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int readUInt32(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static float readFloat32(const unsigned char* bytes)
+{
+    unsigned int bits = readUInt32(bytes);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Default constructor.
+
+VectorMapData::VectorMapData()
+: m_Width(0)
+, m_Height(0)
+{
+}
+
+// Parse a vector map file's contents.
+
+bool VectorMapData::load(const unsigned char* bytes, unsigned long size)
+{
+    m_Width = 0;
+    m_Height = 0;
+    m_Features.clear();
+
+    if (!bytes || size < HEADER_SIZE || memcmp(bytes, FILE_MAGIC, 4) != 0 || readUInt16(bytes + 4) != FILE_VERSION)
+    {
+        return false;
+    }
+
+    float width = readFloat32(bytes + 8);
+    float height = readFloat32(bytes + 12);
+    unsigned int featureCount = readUInt32(bytes + 16);
+    if (!(width > 0) || !(height > 0) || featureCount > (size - HEADER_SIZE) / FEATURE_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    vector<VectorFeature> features(featureCount);
+    unsigned long offset = HEADER_SIZE;
+
+    for (unsigned int i = 0; i < featureCount; i++)
+    {
+        if (size - offset < FEATURE_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        VectorFeature& feature = features[i];
+        unsigned char kind = bytes[offset];
+        unsigned int pointCount = readUInt32(bytes + offset + 4);
+        if (kind >= kVectorFeatureKindCount || pointCount > (size - offset - FEATURE_HEADER_SIZE) / POINT_SIZE)
+        {
+            return false;
+        }
+
+        feature.kind = (VectorFeatureKind)kind;
+        feature.minor = (bytes[offset + 1] & FLAG_MINOR) != 0;
+        feature.width = readUInt16(bytes + offset + 2) / 10.0f;
+        offset += FEATURE_HEADER_SIZE;
+
+        // Expand the quantized points back into map units.
+        feature.points.resize(pointCount);
+        for (unsigned int p = 0; p < pointCount; p++)
+        {
+            feature.points[p] = MapPoint(readUInt16(bytes + offset) * width / 65535.0f,
+                                         readUInt16(bytes + offset + 2) * height / 65535.0f);
+            offset += POINT_SIZE;
+        }
+    }
+
+    m_Width = width;
+    m_Height = height;
+    m_Features.swap(features);
+    return true;
+}
@@ -0,0 +1,109 @@
+//
+//  VectorMapData.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#ifndef VECTOR_MAP_DATA_H
+#define VECTOR_MAP_DATA_H
+
+#include <vector>
+#include "MapPoint.h"
+
+/**
+ @brief     The kinds of geometry in a vector map, in the order they are drawn.
+ */
+enum VectorFeatureKind
+{
+    kVectorFeatureWater = 0,
+    kVectorFeaturePark,
+    kVectorFeatureBlock,
+    kVectorFeatureStreet,
+    kVectorFeatureKindCount
+};
+
+/**
+ @brief     A single polygon (water, park or block) or polyline (street) in map space.
+ */
+struct VectorFeature
+{
+    /** What the feature represents. */
+    VectorFeatureKind kind;
+
+    /** Whether or not a street is minor, in which case it is left out when the map is zoomed far out. */
+    bool minor;
+
+    /** A street's width in map units. Unused for polygons. */
+    float width;
+
+    /** The polygon's outline or the street's centre line. */
+    std::vector<MapPoint> points;
+};
+
+/**
+ @brief     Vector map geometry as loaded from a compact binary file (ie. "newYorkMap.nyvm", built by Tools/VectorMapBuilder.cpp with VectorMapWriter).
+
+ All values are little-endian:
+
+     char[4]    "NYVM"
+     uint16     Format version (1)
+     uint16     Reserved
+     float32    Map width in map units (the same units as the raster map's pixels)
+     float32    Map height in map units
+     uint32     Feature count
+
+ followed by each feature:
+
+     uint8      Kind (a VectorFeatureKind)
+     uint8      Flags (bit 0: minor street)
+     uint16     Street width in tenths of a map unit
+     uint32     Point count
+     uint16[2]  Each point's x and y, quantized so that 0 to 65535 spans the map's width and height
+
+ This class has no dependencies on cocos2d so that the format can be read and tested on its own.
+ */
+class VectorMapData
+{
+public:
+
+    /**
+     @brief     Default constructor. The map is empty until it is loaded.
+     */
+    VectorMapData();
+
+    /**
+     @brief     Parse a vector map file's contents, replacing any previously loaded geometry.
+     @param     bytes   The file's contents.
+     @param     size    The size of the contents in bytes.
+     @return    Whether or not the contents were a valid vector map. If not, the map is left empty.
+     */
+    bool load(const unsigned char* bytes, unsigned long size);
+
+    /**
+     @brief     Get the map's width in map units.
+     */
+    float getWidth() const { return m_Width; }
+
+    /**
+     @brief     Get the map's height in map units.
+     */
+    float getHeight() const { return m_Height; }
+
+    /**
+     @brief     Get every feature in the map, in the order they appear in the file.
+     */
+    const std::vector<VectorFeature>& getFeatures() const { return m_Features; }
+
+private:
+
+    /** The map's size in map units. */
+    float m_Width;
+    float m_Height;
+
+    /** The map's polygons and polylines. */
+    std::vector<VectorFeature> m_Features;
+};
+
+#endif // VECTOR_MAP_DATA_H
@@ -0,0 +1,267 @@
+//
+//  VectorMapNode.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#include "VectorMapNode.h"
+#include "PolylineSimplifier.h"
+#include <stddef.h>
+
+using namespace std;
+using namespace cocos2d;
+
+// The on-screen scale at which each zoom band begins, from the most zoomed out to the most zoomed in.
+static const unsigned int ZOOM_BAND_COUNT = 6;
+static const float ZOOM_BAND_SCALES[ZOOM_BAND_COUNT] = { 0.125f, 0.25f, 0.5f, 1.0f, 2.0f, 4.0f };
+
+// The narrowest a street may appear on-screen, in points.
+static const float MIN_STREET_WIDTH = 1.5f;
+
+// How far a simplified street may stray from the original on-screen, in points.
+static const float STREET_SIMPLIFY_TOLERANCE = 0.5f;
+
+// Minor streets are only drawn from this on-screen scale and up.
+static const float MINOR_STREET_SCALE = 0.5f;
+
+// The colour of each kind of feature, plus the land underneath everything.
+static const MapColor LAND_COLOR = { 242, 239, 233, 255 };
+static const MapColor FEATURE_COLORS[kVectorFeatureKindCount] =
+{
+    { 170, 211, 223, 255 },     // Water
+    { 200, 226, 180, 255 },     // Park
+    { 228, 224, 216, 255 },     // Block
+    { 255, 255, 255, 255 }      // Street
+};
+static const MapColor MINOR_STREET_COLOR = { 250, 250, 248, 255 };
+
+// Create a VectorMapNode instance from a vector map file.
+
+VectorMapNode* VectorMapNode::create(const char* fileName)
+{
+    VectorMapNode *node = new VectorMapNode();
+    if (node && node->init(fileName))
+    {
+        node->autorelease();
+        return node;
+    }
+    CC_SAFE_DELETE(node);
+    return NULL;
+}
+
+// Default constructor.
+
+VectorMapNode::VectorMapNode()
+{
+    m_FillBuffer.name = 0;
+    m_FillBuffer.vertexCount = 0;
+    m_FillBuffer.built = false;
+}
+
+// Destructor. Frees the vertex buffers.
+
+VectorMapNode::~VectorMapNode()
+{
+    if (m_FillBuffer.built)
+    {
+        glDeleteBuffers(1, &m_FillBuffer.name);
+    }
+
+    for (unsigned int i = 0; i < m_StreetBuffers.size(); i++)
+    {
+        if (m_StreetBuffers[i].built)
+        {
+            glDeleteBuffers(1, &m_StreetBuffers[i].name);
+        }
+    }
+}
+
+// Initialize the node by loading and tessellating a vector map file.
+
+bool VectorMapNode::init(const char* fileName)
+{
+    // Load the geometry.
+    unsigned long size = 0;
+    string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(fileName);
+    unsigned char* bytes = CCFileUtils::sharedFileUtils()->getFileData(fullPath.c_str(), "rb", &size);
+    bool loaded = m_Data.load(bytes, size);
+    CC_SAFE_DELETE_ARRAY(bytes);
+
+    if (!loaded)
+    {
+        CCLOG("Failed to load vector map \"%s\".", fileName);
+        return false;
+    }
+
+    // Size the node like the raster map so that landmarks and the Map's scale limits work the same way with either.
+    setContentSize(CCSizeMake(m_Data.getWidth(), m_Data.getHeight()));
+    setAnchorPoint(ccp(0.5f, 0.5f));
+    setShaderProgram(CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionColor));
+
+    // Tessellate the land followed by each kind of polygon in drawing order.
+    vector<MapVertex> vertices;
+    vector<MapPoint> land;
+    land.push_back(MapPoint(0, 0));
+    land.push_back(MapPoint(m_Data.getWidth(), 0));
+    land.push_back(MapPoint(m_Data.getWidth(), m_Data.getHeight()));
+    land.push_back(MapPoint(0, m_Data.getHeight()));
+    Tessellator::fillPolygon(land, LAND_COLOR, vertices);
+
+    const vector<VectorFeature>& features = m_Data.getFeatures();
+    unsigned int failedPolygons = 0;
+    for (int kind = 0; kind < kVectorFeatureStreet; kind++)
+    {
+        for (unsigned int i = 0; i < features.size(); i++)
+        {
+            if (features[i].kind == kind && !Tessellator::fillPolygon(features[i].points, FEATURE_COLORS[kind], vertices))
+            {
+                failedPolygons++;
+            }
+        }
+    }
+
+    if (failedPolygons > 0)
+    {
+        CCLOG("%u polygons in \"%s\" could not be triangulated and were skipped.", failedPolygons, fileName);
+    }
+
+    uploadBuffer(m_FillBuffer, vertices);
+
+    // The street buffers are built on demand.
+    VertexBuffer emptyBuffer = { 0, 0, false };
+    m_StreetBuffers.assign(ZOOM_BAND_COUNT, emptyBuffer);
+
+    CCLOG("Loaded vector map \"%s\": %lu features, %lu bytes, %d fill vertices.",
+          fileName, (unsigned long)features.size(), size, m_FillBuffer.vertexCount);
+
+    return true;
+}
+
+// Draw the fill buffer followed by the street buffer for the current zoom band.
+
+void VectorMapNode::draw(void)
+{
+    // Build the current band's streets the first time it is shown.
+    unsigned int zoomBand = getCurrentZoomBand();
+    if (!m_StreetBuffers[zoomBand].built)
+    {
+        vector<MapVertex> vertices;
+        tessellateStreets(zoomBand, vertices);
+        uploadBuffer(m_StreetBuffers[zoomBand], vertices);
+    }
+
+    CC_NODE_DRAW_SETUP();
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color);
+
+    drawBuffer(m_FillBuffer);
+    drawBuffer(m_StreetBuffers[zoomBand]);
+
+    // Sprites are drawn from client memory, so the buffer must not be left bound.
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Get the zoom band which should be drawn at the map's current on-screen scale.
+
+unsigned int VectorMapNode::getCurrentZoomBand()
+{
+    float scale = 1;
+    for (CCNode* node = this; node; node = node->getParent())
+    {
+        scale *= node->getScaleX();
+    }
+
+    unsigned int zoomBand = 0;
+    while (zoomBand + 1 < ZOOM_BAND_COUNT && ZOOM_BAND_SCALES[zoomBand + 1] <= scale)
+    {
+        zoomBand++;
+    }
+    return zoomBand;
+}
+
+// Tessellate the streets for a zoom band.
+
+void VectorMapNode::tessellateStreets(unsigned int zoomBand, vector<MapVertex>& vertices)
+{
+    // Widths are chosen for the bottom of the band, which is the smallest the streets will appear while it is in use.
+    float bandScale = ZOOM_BAND_SCALES[zoomBand];
+    float minWidth = MIN_STREET_WIDTH / bandScale;
+    bool includeMinorStreets = (bandScale >= MINOR_STREET_SCALE);
+
+    // Streets are simplified for the top of the band instead, which is where they appear largest. The most zoomed in band keeps every vertex.
+    float tolerance = (zoomBand + 1 == ZOOM_BAND_COUNT) ? 0 : STREET_SIMPLIFY_TOLERANCE / ZOOM_BAND_SCALES[zoomBand + 1];
+
+    // Minor streets go first so that major streets are drawn over them at intersections.
+    const vector<VectorFeature>& features = m_Data.getFeatures();
+    if (m_StreetRanks.empty())
+    {
+        rankStreetVertices();
+    }
+
+    vector<MapPoint> simplified;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool minorPass = (pass == 0);
+        if (minorPass && !includeMinorStreets)
+        {
+            continue;
+        }
+
+        for (unsigned int i = 0; i < features.size(); i++)
+        {
+            const VectorFeature& feature = features[i];
+            if (feature.kind == kVectorFeatureStreet && feature.minor == minorPass)
+            {
+                PolylineSimplifier::selectVertices(feature.points, m_StreetRanks[i], tolerance, &simplified);
+                Tessellator::strokePolyline(simplified, MAX(feature.width, minWidth),
+                                            minorPass ? MINOR_STREET_COLOR : FEATURE_COLORS[kVectorFeatureStreet], vertices);
+            }
+        }
+    }
+}
+
+// Rank the vertices of every street, so that each zoom band can simplify them.
+
+void VectorMapNode::rankStreetVertices()
+{
+    const vector<VectorFeature>& features = m_Data.getFeatures();
+    m_StreetRanks.resize(features.size());
+    for (unsigned int i = 0; i < features.size(); i++)
+    {
+        if (features[i].kind == kVectorFeatureStreet)
+        {
+            PolylineSimplifier::rankVertices(features[i].points, &m_StreetRanks[i]);
+        }
+    }
+}
+
+// Upload a triangle list into a vertex buffer.
+
+void VectorMapNode::uploadBuffer(VertexBuffer& buffer, const vector<MapVertex>& vertices)
+{
+    glGenBuffers(1, &buffer.name);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.name);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MapVertex), vertices.empty() ? NULL : &vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    buffer.vertexCount = vertices.size();
+    buffer.built = true;
+}
+
+// Draw the contents of a vertex buffer.
+
+void VectorMapNode::drawBuffer(const VertexBuffer& buffer)
+{
+    if (buffer.vertexCount == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.name);
+    glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(MapVertex), (void*)offsetof(MapVertex, position));
+    glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(MapVertex), (void*)offsetof(MapVertex, color));
+    glDrawArrays(GL_TRIANGLES, 0, buffer.vertexCount);
+
+    CC_INCREMENT_GL_DRAWS(1);
+}
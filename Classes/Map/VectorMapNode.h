@@ -0,0 +1,112 @@
+//
+//  VectorMapNode.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#ifndef VECTOR_MAP_NODE_H
+#define VECTOR_MAP_NODE_H
+
+#include "cocos2d.h"
+#include "VectorMapData.h"
+#include "Tessellator.h"
+
+/**
+ @brief     A map node which draws tessellated vector geometry instead of raster tiles, so that it stays sharp at any scale.
+
+ Water, parks and blocks don't change with the zoom level, so they are tessellated into a single vertex buffer when the map is loaded. Streets are stroked wider (in map units) when zoomed out so that they never become thinner than a hairline on screen, and minor streets are left out altogether; each zoom band therefore gets its own street buffer, built the first time that band is displayed.
+ */
+class VectorMapNode : public cocos2d::CCNode
+{
+public:
+
+    /**
+     @brief     Create a VectorMapNode instance from a vector map file.
+     @param     fileName    The vector map's file name (ie. "newYorkMap.nyvm").
+     @return    A pointer to the newly created VectorMapNode, or NULL if the file could not be loaded.
+     */
+    static VectorMapNode* create(const char* fileName);
+
+    /**
+     @brief     Destructor. Frees the vertex buffers.
+     */
+    virtual ~VectorMapNode();
+
+    /**
+     @brief     Draw the fill buffer followed by the street buffer for the current zoom band.
+     */
+    virtual void draw(void);
+
+protected:
+
+    /**
+     @brief     A vertex buffer holding a triangle list.
+     */
+    struct VertexBuffer
+    {
+        GLuint name;
+        GLsizei vertexCount;
+        bool built;
+    };
+
+    /**
+     @brief     Default constructor.
+     */
+    VectorMapNode();
+
+    /**
+     @brief     Initialize the node by loading and tessellating a vector map file.
+     @param     fileName    The vector map's file name.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init(const char* fileName);
+
+    /**
+     @brief     Get the zoom band which should be drawn at the map's current on-screen scale.
+     @return    The index of the zoom band.
+     */
+    unsigned int getCurrentZoomBand();
+
+    /**
+     @brief     Tessellate the streets for a zoom band.
+     @param     zoomBand    The index of the zoom band.
+     @param     vertices    The triangle list that the streets are appended to.
+     */
+    void tessellateStreets(unsigned int zoomBand, std::vector<MapVertex>& vertices);
+
+    /**
+     @brief     Rank the vertices of every street, so that each zoom band can simplify them without simplifying them from scratch. This is done the first time a street buffer is built.
+     */
+    void rankStreetVertices();
+
+    /**
+     @brief     Upload a triangle list into a vertex buffer.
+     @param     buffer      The buffer to upload into.
+     @param     vertices    The triangle list.
+     */
+    void uploadBuffer(VertexBuffer& buffer, const std::vector<MapVertex>& vertices);
+
+    /**
+     @brief     Draw the contents of a vertex buffer.
+     @param     buffer      The buffer to draw.
+     */
+    void drawBuffer(const VertexBuffer& buffer);
+
+private:
+
+    /** The geometry that the buffers are built from. */
+    VectorMapData m_Data;
+
+    /** The land, water, parks and blocks. */
+    VertexBuffer m_FillBuffer;
+
+    /** The streets for each zoom band. */
+    std::vector<VertexBuffer> m_StreetBuffers;
+
+    /** The rank of each vertex of each street (see PolylineSimplifier), indexed like the features. Other kinds of feature have none. */
+    std::vector<std::vector<float> > m_StreetRanks;
+};
+
+#endif // VECTOR_MAP_NODE_H
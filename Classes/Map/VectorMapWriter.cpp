@@ -0,0 +1,96 @@
+//
+//  VectorMapWriter.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#include "VectorMapWriter.h"
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+
+// These values must match the format described in VectorMapData.h.
+static const char* FILE_MAGIC = "NYVM";
+static const unsigned int FILE_VERSION = 1;
+static const unsigned char FLAG_MINOR = 1 << 0;
+
+// Append little-endian values to the output.
+
+static void writeUInt16(vector<unsigned char>& output, unsigned int value)
+{
+    output.push_back(value & 0xFF);
+    output.push_back((value >> 8) & 0xFF);
+}
+
+static void writeUInt32(vector<unsigned char>& output, unsigned int value)
+{
+    writeUInt16(output, value & 0xFFFF);
+    writeUInt16(output, value >> 16);
+}
+
+static void writeFloat32(vector<unsigned char>& output, float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeUInt32(output, bits);
+}
+
+// Quantize a coordinate so that 0 to 65535 spans the map's size.
+
+static unsigned int quantize(float value, float size)
+{
+    float quantized = floorf(value / size * 65535.0f + 0.5f);
+    return (unsigned int)(quantized < 0 ? 0 : (quantized > 65535 ? 65535 : quantized));
+}
+
+// Create a writer for a map of a given size.
+
+VectorMapWriter::VectorMapWriter(float width, float height)
+: m_Width(width)
+, m_Height(height)
+, m_PointCount(0)
+{
+}
+
+// Add a polygon or a street.
+
+void VectorMapWriter::addFeature(const VectorFeature& feature)
+{
+    m_Features.push_back(feature);
+    m_PointCount += feature.points.size();
+}
+
+// Write the map in the format described in VectorMapData.h.
+
+void VectorMapWriter::write(vector<unsigned char>* output) const
+{
+    // Write the header followed by every feature.
+    output->clear();
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        output->push_back(FILE_MAGIC[i]);
+    }
+    writeUInt16(*output, FILE_VERSION);
+    writeUInt16(*output, 0);
+    writeFloat32(*output, m_Width);
+    writeFloat32(*output, m_Height);
+    writeUInt32(*output, m_Features.size());
+
+    for (unsigned int i = 0; i < m_Features.size(); i++)
+    {
+        const VectorFeature& feature = m_Features[i];
+        output->push_back(feature.kind);
+        output->push_back(feature.minor ? FLAG_MINOR : 0);
+        writeUInt16(*output, (unsigned int)floorf(feature.width * 10 + 0.5f));
+        writeUInt32(*output, feature.points.size());
+
+        for (unsigned int p = 0; p < feature.points.size(); p++)
+        {
+            writeUInt16(*output, quantize(feature.points[p].x, m_Width));
+            writeUInt16(*output, quantize(feature.points[p].y, m_Height));
+        }
+    }
+}
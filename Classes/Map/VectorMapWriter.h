@@ -0,0 +1,66 @@
+//
+//  VectorMapWriter.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//
+
+#ifndef VECTOR_MAP_WRITER_H
+#define VECTOR_MAP_WRITER_H
+
+#include <vector>
+#include "VectorMapData.h"
+
+/**
+ @brief     Builds the vector map read by VectorMapData (see Tools/VectorMapBuilder.cpp).
+
+ Features are written in the order they were added, which is the order VectorMapData gives them back in. Points are quantized to the map's size as they are written, so they come back within half a quantization step (1/131070 of the map's width or height) of where they were added.
+
+ This class has no dependencies on cocos2d so that it can be built into the command-line tools.
+ */
+class VectorMapWriter
+{
+public:
+
+    /**
+     @brief     Create a writer for a map of a given size.
+     @param     width       The map's width in map units.
+     @param     height      The map's height in map units.
+     */
+    VectorMapWriter(float width, float height);
+
+    /**
+     @brief     Add a polygon or a street.
+     @param     feature     The feature. A street's width must be under 6553.5 map units, since it is stored in tenths of a unit.
+     */
+    void addFeature(const VectorFeature& feature);
+
+    /**
+     @brief     Get the number of features which have been added.
+     */
+    unsigned int getFeatureCount() const { return m_Features.size(); }
+
+    /**
+     @brief     Get the number of points in every feature which has been added.
+     */
+    unsigned long getPointCount() const { return m_PointCount; }
+
+    /**
+     @brief     Write the map in the format described in VectorMapData.h.
+     @param     output  The vector to store the map's bytes in.
+     */
+    void write(std::vector<unsigned char>* output) const;
+
+private:
+
+    /** The map's size in map units. */
+    float m_Width;
+    float m_Height;
+
+    /** The features, in the order they were added. */
+    std::vector<VectorFeature> m_Features;
+    unsigned long m_PointCount;
+};
+
+#endif // VECTOR_MAP_WRITER_H
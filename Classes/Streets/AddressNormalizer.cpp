@@ -0,0 +1,202 @@
+//
+//  AddressNormalizer.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "AddressNormalizer.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+/**
+ @brief     A word and the word it is replaced with.
+ */
+struct AddressWordReplacement
+{
+    const char* word;
+    const char* replacement;
+};
+
+// Abbreviations and spelled-out ordinals, and what they become. An empty replacement drops the word. "st" is handled on its own, since it can be "street" or "saint".
+static const AddressWordReplacement WORD_REPLACEMENTS[] =
+{
+    { "ave", "avenue" }, { "av", "avenue" }, { "avn", "avenue" }, { "blvd", "boulevard" }, { "bway", "broadway" },
+    { "pl", "place" }, { "sq", "square" }, { "pk", "park" }, { "ctr", "center" }, { "centre", "center" },
+    { "hq", "headquarters" }, { "bldg", "building" }, { "mus", "museum" }, { "mt", "mount" }, { "ste", "saint" },
+    { "w", "west" }, { "e", "east" }, { "n", "north" }, { "s", "south" },
+    { "first", "1" }, { "second", "2" }, { "third", "3" }, { "fourth", "4" }, { "fifth", "5" }, { "sixth", "6" },
+    { "seventh", "7" }, { "eighth", "8" }, { "ninth", "9" }, { "tenth", "10" }, { "eleventh", "11" }, { "twelfth", "12" },
+    { "nyc", "" }, { "ny", "" }, { "manhattan", "" }, { "usa", "" }, { "us", "" }, { "the", "" }
+};
+
+// The tens of the spelled-out ordinals from "thirteenth" up (ie. "forty" in "forty-fifth"), starting from twenty.
+static const char* TENS_WORDS[] = { "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety" };
+static const char* TENS_ORDINALS[] = { "twentieth", "thirtieth", "fortieth", "fiftieth", "sixtieth", "seventieth", "eightieth", "ninetieth" };
+
+// The spelled-out ordinals from thirteenth to nineteenth.
+static const char* TEEN_ORDINALS[] = { "thirteenth", "fourteenth", "fifteenth", "sixteenth", "seventeenth", "eighteenth", "nineteenth" };
+
+// Check whether a word is made up only of digits.
+
+bool AddressNormalizer::isNumber(const char* word, unsigned int length, unsigned int* number)
+{
+    if (length == 0 || length > 9)
+    {
+        return false;
+    }
+
+    unsigned int value = 0;
+    for (unsigned int i = 0; i < length; i++)
+    {
+        if (word[i] < '0' || word[i] > '9')
+        {
+            return false;
+        }
+        value = value * 10 + (word[i] - '0');
+    }
+
+    if (number) *number = value;
+    return true;
+}
+
+// Find a word in a list, returning its index or -1.
+
+static int findWord(const string& word, const char* const* words, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (word == words[i])
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Normalize a street name, place name or address.
+
+void AddressNormalizer::normalize(const char* text, string* key)
+{
+    // Split the text into lowercase words.
+    vector<string> words;
+    string word;
+    for (const char* c = text; ; c++)
+    {
+        unsigned char character = *c;
+        bool isWordCharacter = (character >= 'a' && character <= 'z') || (character >= '0' && character <= '9') || character >= 0x80;
+        if (character >= 'A' && character <= 'Z')
+        {
+            word += (char)(character - 'A' + 'a');
+        }
+        else if (isWordCharacter)
+        {
+            word += (char)character;
+        }
+        else if (character == '\'')
+        {
+            // Apostrophes join the parts of a word rather than separating them.
+        }
+        else
+        {
+            if (!word.empty())
+            {
+                words.push_back(word);
+                word.clear();
+            }
+
+            if (character == '&') words.push_back("and");
+            if (character == '@') words.push_back("at");
+            if (character == '\0') break;
+        }
+    }
+
+    key->clear();
+    unsigned int replacementCount = sizeof(WORD_REPLACEMENTS) / sizeof(WORD_REPLACEMENTS[0]);
+    for (unsigned int i = 0; i < words.size(); i++)
+    {
+        string current = words[i];
+
+        // "New York" says nothing more about a place in Manhattan.
+        if (current == "new" && i + 1 < words.size() && words[i + 1] == "york")
+        {
+            i++;
+            continue;
+        }
+
+        // "St" is "saint" before a name and "street" after one.
+        if (current == "st")
+        {
+            current = key->empty() ? "saint" : "street";
+        }
+
+        // Ordinals written with digits lose their suffix.
+        unsigned int digits = 0;
+        while (digits < current.size() && current[digits] >= '0' && current[digits] <= '9')
+        {
+            digits++;
+        }
+        string suffix = current.substr(digits);
+        if (digits > 0 && (suffix == "st" || suffix == "nd" || suffix == "rd" || suffix == "th"))
+        {
+            current.resize(digits);
+        }
+
+        // Spelled-out ordinals become numbers, including ones written as two words (ie. "forty fifth") or with a hyphen.
+        int tens = findWord(current, TENS_WORDS, 8);
+        int tensOrdinal = findWord(current, TENS_ORDINALS, 8);
+        int teenOrdinal = findWord(current, TEEN_ORDINALS, 7);
+        char number[8];
+        if (tensOrdinal >= 0)
+        {
+            snprintf(number, sizeof(number), "%d", (tensOrdinal + 2) * 10);
+            current = number;
+        }
+        else if (teenOrdinal >= 0)
+        {
+            snprintf(number, sizeof(number), "%d", teenOrdinal + 13);
+            current = number;
+        }
+        else if (tens >= 0 && i + 1 < words.size())
+        {
+            for (unsigned int j = 0; j < replacementCount; j++)
+            {
+                unsigned int units;
+                if (words[i + 1] == WORD_REPLACEMENTS[j].word && isNumber(WORD_REPLACEMENTS[j].replacement, strlen(WORD_REPLACEMENTS[j].replacement), &units) && units < 10)
+                {
+                    snprintf(number, sizeof(number), "%d", (tens + 2) * 10 + units);
+                    current = number;
+                    i++;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for (unsigned int j = 0; j < replacementCount; j++)
+            {
+                if (current == WORD_REPLACEMENTS[j].word)
+                {
+                    current = WORD_REPLACEMENTS[j].replacement;
+                    break;
+                }
+            }
+        }
+
+        if (current.empty())
+        {
+            continue;
+        }
+
+        if (!key->empty())
+        {
+            *key += ' ';
+        }
+        *key += current;
+    }
+}
@@ -0,0 +1,49 @@
+//
+//  AddressNormalizer.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef ADDRESS_NORMALIZER_H
+#define ADDRESS_NORMALIZER_H
+
+#include <string>
+
+/**
+ @brief     Turns the many ways of writing a street or place name into one key, so that "W 45th St.", "west 45 street" and "West Forty-Fifth Street" are all looked up as "west 45 street".
+
+ Letters are lowercased and punctuation separates words, except for apostrophes, which are dropped ("Patrick's" becomes "patricks"). Abbreviations are spelled out, ordinals become plain numbers, and words which don't narrow anything down in Manhattan (ie. "NYC" or "the") are left out. "&" and "@" become "and" and "at", which the geocoder splits intersections on. Only ASCII is changed; other bytes are kept as they are.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class AddressNormalizer
+{
+public:
+
+    /**
+     @brief     Normalize a street name, place name or address.
+     @param     text        The text to normalize, in UTF-8. Either spaces or "+" can separate its words, as in the landmarks' Google Maps queries.
+     @param     key         Receives the normalized words, separated by single spaces. Existing contents are replaced.
+     */
+    static void normalize(const char* text, std::string* key);
+
+    /**
+     @brief     Check whether a normalized word is a number.
+     @param     word        The word, which doesn't need to be terminated.
+     @param     length      The length of the word in bytes.
+     @param     number      Receives the number if the word is one. Can be NULL.
+     @return    Whether or not the word is made up only of digits.
+     */
+    static bool isNumber(const char* word, unsigned int length, unsigned int* number);
+
+private:
+
+    /**
+     @brief     Default constructor. Declared as private because this class is not meant to be instantiated.
+     */
+    AddressNormalizer() { }
+};
+
+#endif // ADDRESS_NORMALIZER_H
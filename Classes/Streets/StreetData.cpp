@@ -0,0 +1,478 @@
+//
+//  StreetData.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "StreetData.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <float.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// The file's identifying bytes and the version this code understands.
+static const char* FILE_MAGIC = "NYST";
+static const unsigned short FILE_VERSION = 2;
+
+// The size in bytes of the file header, and the number of fields in a segment, a street, a place and a key.
+static const unsigned long HEADER_SIZE = 96;
+static const unsigned int SEGMENT_FIELD_COUNT = 9;
+static const unsigned int STREET_FIELD_COUNT = 3;
+static const unsigned int PLACE_FIELD_COUNT = 3;
+static const unsigned int KEY_FIELD_COUNT = 2;
+
+// The most columns or rows a grid can have.
+static const unsigned int MAX_GRID_SIZE = 32768;
+
+// The number of metres per degree of latitude, and the units the origin is stored in.
+static const double METRES_PER_DEGREE = MapProjection::EARTH_RADIUS * M_PI / 180;
+static const double ORIGIN_UNITS_PER_DEGREE = 10000000.0;
+
+// The shared data.
+static StreetData* s_SharedData = NULL;
+
+// Read little-endian values from the header regardless of the host's byte order.
+
+static unsigned short readUInt16(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static unsigned int readUInt32(const unsigned char* bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static float readFloat32(const unsigned char* bytes)
+{
+    unsigned int bits = readUInt32(bytes);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Check whether or not a section of the file starts on a 4-byte boundary and fits inside the file.
+
+static bool isSectionValid(unsigned long offset, unsigned long count, unsigned long elementSize, unsigned long fileSize)
+{
+    return (offset % 4 == 0 && offset >= HEADER_SIZE && offset <= fileSize && count <= (fileSize - offset) / elementSize);
+}
+
+// Get the street data shared by the map and its geocoder.
+
+StreetData* StreetData::sharedData()
+{
+    if (!s_SharedData)
+    {
+        s_SharedData = new StreetData();
+    }
+
+    return s_SharedData;
+}
+
+// Default constructor.
+
+StreetData::StreetData()
+: m_Mapping(NULL)
+, m_MappingSize(0)
+, m_SegmentCount(0)
+, m_Segments(NULL)
+, m_StreetCount(0)
+, m_Streets(NULL)
+, m_PlaceCount(0)
+, m_Places(NULL)
+, m_KeyCount(0)
+, m_Keys(NULL)
+, m_Columns(0)
+, m_Rows(0)
+, m_CellSize(1)
+, m_Cells(NULL)
+, m_EntryCount(0)
+, m_Entries(NULL)
+, m_StringsSize(0)
+, m_Strings(NULL)
+, m_MetresPerDegreeLongitude(METRES_PER_DEGREE)
+{
+}
+
+// Destructor.
+
+StreetData::~StreetData()
+{
+    close();
+}
+
+// Map a street data file.
+
+bool StreetData::open(const char* path)
+{
+    close();
+
+    int file = ::open(path, O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size >= (off_t)HEADER_SIZE)
+    {
+        mapping = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    // The mapping stays valid once the file is closed.
+    ::close(file);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_Mapping = mapping;
+    m_MappingSize = status.st_size;
+
+    if (!readHeader((const unsigned char*)m_Mapping, m_MappingSize))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+// Take over street data which was written in memory.
+
+bool StreetData::load(vector<unsigned char>* data)
+{
+    close();
+    m_Data.swap(*data);
+
+    if (m_Data.size() < HEADER_SIZE || !readHeader(&m_Data[0], m_Data.size()))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+// Unmap the file or free the data.
+
+void StreetData::close()
+{
+    if (m_Mapping)
+    {
+        munmap(m_Mapping, m_MappingSize);
+    }
+
+    m_Mapping = NULL;
+    m_MappingSize = 0;
+    vector<unsigned char>().swap(m_Data);
+
+    m_SegmentCount = 0;
+    m_Segments = NULL;
+    m_StreetCount = 0;
+    m_Streets = NULL;
+    m_PlaceCount = 0;
+    m_Places = NULL;
+    m_KeyCount = 0;
+    m_Keys = NULL;
+    m_Columns = 0;
+    m_Rows = 0;
+    m_GridMinimum = MapPoint();
+    m_CellSize = 1;
+    m_Cells = NULL;
+    m_EntryCount = 0;
+    m_Entries = NULL;
+    m_StringsSize = 0;
+    m_Strings = NULL;
+    m_Origin = GeoPoint();
+    m_MetresPerDegreeLongitude = METRES_PER_DEGREE;
+}
+
+// Check the header of the mapped file or loaded data and find each of its sections.
+
+bool StreetData::readHeader(const unsigned char* bytes, unsigned long size)
+{
+    // The sections are used in place, so the host has to share the file's byte order. Every iOS device is little-endian.
+    unsigned short byteOrderProbe = 1;
+    if (*(unsigned char*)&byteOrderProbe != 1)
+    {
+        return false;
+    }
+
+    unsigned int segmentCount = readUInt32(bytes + 8);
+    unsigned int segmentsOffset = readUInt32(bytes + 12);
+    unsigned int streetCount = readUInt32(bytes + 16);
+    unsigned int streetsOffset = readUInt32(bytes + 20);
+    unsigned int columns = readUInt32(bytes + 24);
+    unsigned int rows = readUInt32(bytes + 28);
+    float cellSize = readFloat32(bytes + 40);
+    unsigned int cellsOffset = readUInt32(bytes + 44);
+    unsigned int entryCount = readUInt32(bytes + 48);
+    unsigned int entriesOffset = readUInt32(bytes + 52);
+    unsigned int stringsSize = readUInt32(bytes + 56);
+    unsigned int stringsOffset = readUInt32(bytes + 60);
+    unsigned int fileSize = readUInt32(bytes + 64);
+    unsigned int placeCount = readUInt32(bytes + 76);
+    unsigned int placesOffset = readUInt32(bytes + 80);
+    unsigned int keyCount = readUInt32(bytes + 84);
+    unsigned int keysOffset = readUInt32(bytes + 88);
+
+    // The grid is limited so that its cell count can't overflow.
+    if (memcmp(bytes, FILE_MAGIC, 4) != 0 || readUInt16(bytes + 4) != FILE_VERSION || fileSize != size ||
+        columns == 0 || rows == 0 || columns > MAX_GRID_SIZE || rows > MAX_GRID_SIZE || !(cellSize > 0) ||
+        !isSectionValid(segmentsOffset, segmentCount, SEGMENT_FIELD_COUNT * 4, size) ||
+        !isSectionValid(streetsOffset, streetCount, STREET_FIELD_COUNT * 4, size) ||
+        !isSectionValid(placesOffset, placeCount, PLACE_FIELD_COUNT * 4, size) ||
+        !isSectionValid(keysOffset, keyCount, KEY_FIELD_COUNT * 4, size) ||
+        !isSectionValid(cellsOffset, columns * rows + 1, 4, size) ||
+        !isSectionValid(entriesOffset, entryCount, 4, size) ||
+        !isSectionValid(stringsOffset, stringsSize, 1, size) ||
+        stringsSize == 0 || bytes[stringsOffset + stringsSize - 1] != '\0')
+    {
+        return false;
+    }
+
+    m_SegmentCount = segmentCount;
+    m_Segments = (const unsigned int*)(bytes + segmentsOffset);
+    m_StreetCount = streetCount;
+    m_Streets = (const unsigned int*)(bytes + streetsOffset);
+    m_PlaceCount = placeCount;
+    m_Places = (const unsigned int*)(bytes + placesOffset);
+    m_KeyCount = keyCount;
+    m_Keys = (const unsigned int*)(bytes + keysOffset);
+    m_Columns = columns;
+    m_Rows = rows;
+    m_GridMinimum = MapPoint(readFloat32(bytes + 32), readFloat32(bytes + 36));
+    m_CellSize = cellSize;
+    m_Cells = (const unsigned int*)(bytes + cellsOffset);
+    m_EntryCount = entryCount;
+    m_Entries = (const unsigned int*)(bytes + entriesOffset);
+    m_StringsSize = stringsSize;
+    m_Strings = (const char*)(bytes + stringsOffset);
+
+    m_Origin.latitude = (int)readUInt32(bytes + 68) / ORIGIN_UNITS_PER_DEGREE;
+    m_Origin.longitude = (int)readUInt32(bytes + 72) / ORIGIN_UNITS_PER_DEGREE;
+    m_MetresPerDegreeLongitude = METRES_PER_DEGREE * cos(m_Origin.latitude * M_PI / 180);
+    return true;
+}
+
+// Get a segment.
+
+StreetSegment StreetData::getSegment(unsigned int index) const
+{
+    const unsigned int* fields = m_Segments + index * SEGMENT_FIELD_COUNT;
+    const float* positions = (const float*)fields;
+
+    StreetSegment segment;
+    segment.from = MapPoint(positions[0], positions[1]);
+    segment.to = MapPoint(positions[2], positions[3]);
+    segment.street = fields[4];
+    segment.leftFrom = fields[5];
+    segment.leftTo = fields[6];
+    segment.rightFrom = fields[7];
+    segment.rightTo = fields[8];
+    return segment;
+}
+
+// Get a string from the string table.
+
+const char* StreetData::getString(unsigned int offset) const
+{
+    if (offset >= m_StringsSize)
+    {
+        return "";
+    }
+
+    // Since the string table ends with a zero byte, every string starting inside it is terminated.
+    return m_Strings + offset;
+}
+
+// Get a street's name.
+
+const char* StreetData::getStreetName(unsigned int street) const
+{
+    return (street < m_StreetCount) ? getString(m_Streets[street * STREET_FIELD_COUNT]) : "";
+}
+
+// Get the segments along a street.
+
+unsigned int StreetData::getStreetSegments(unsigned int street, unsigned int* first) const
+{
+    if (street >= m_StreetCount)
+    {
+        return 0;
+    }
+
+    // Keep the range inside the segments, in case the data is damaged.
+    const unsigned int* fields = m_Streets + street * STREET_FIELD_COUNT;
+    *first = min(fields[1], m_SegmentCount);
+    return min(fields[2], m_SegmentCount - *first);
+}
+
+// Get a place.
+
+StreetPlace StreetData::getPlace(unsigned int place) const
+{
+    const unsigned int* fields = m_Places + place * PLACE_FIELD_COUNT;
+    const float* positions = (const float*)(fields + 1);
+
+    StreetPlace result;
+    result.name = getString(fields[0]);
+    result.position = MapPoint(positions[0], positions[1]);
+    return result;
+}
+
+// Find the streets and places with a name.
+
+unsigned int StreetData::findKey(const char* key, unsigned int* first) const
+{
+    // Find the first key which isn't before the name, then count the keys which match it.
+    unsigned int low = 0, high = m_KeyCount;
+    while (low < high)
+    {
+        unsigned int middle = (low + high) / 2;
+        if (strcmp(getString(m_Keys[middle * KEY_FIELD_COUNT]), key) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    *first = low;
+    unsigned int end = low;
+    while (end < m_KeyCount && strcmp(getString(m_Keys[end * KEY_FIELD_COUNT]), key) == 0)
+    {
+        end++;
+    }
+    return end - low;
+}
+
+// Flatten a latitude and longitude into metres east and north of the origin.
+
+MapPoint StreetData::flatten(const GeoPoint& location) const
+{
+    return MapPoint((location.longitude - m_Origin.longitude) * m_MetresPerDegreeLongitude,
+                    (location.latitude - m_Origin.latitude) * METRES_PER_DEGREE);
+}
+
+// Turn a position in metres east and north of the origin back into a latitude and longitude.
+
+GeoPoint StreetData::unflatten(const MapPoint& position) const
+{
+    return GeoPoint(m_Origin.latitude + position.y / METRES_PER_DEGREE,
+                    m_Origin.longitude + position.x / m_MetresPerDegreeLongitude);
+}
+
+// Find the segment nearest to a point.
+
+bool StreetData::findNearestSegment(const MapPoint& point, float maxDistance, unsigned int* segment, float* fraction, float* distance) const
+{
+    if (m_SegmentCount == 0 || maxDistance < 0)
+    {
+        return false;
+    }
+
+    // The point's cell, which may be outside of the grid.
+    int column = (int)floorf((point.x - m_GridMinimum.x) / m_CellSize);
+    int row = (int)floorf((point.y - m_GridMinimum.y) / m_CellSize);
+    float nearestSquared = maxDistance * maxDistance;
+    unsigned int nearest = m_SegmentCount;
+
+    // A cell in ring r is at least (r - 1) cells away, so once the nearest segment is closer than that no further ring can hold a nearer one. The rings stop growing once they are past the grid on every side.
+    int lastRing = (int)ceilf(maxDistance / m_CellSize) + 1;
+    int gridReach = max(max(column, (int)m_Columns - 1 - column), max(row, (int)m_Rows - 1 - row));
+    lastRing = min(lastRing, gridReach);
+
+    for (int ring = 0; ring <= lastRing; ring++)
+    {
+        float ringDistance = (ring - 1) * m_CellSize;
+        if (ring > 0 && ringDistance * ringDistance > nearestSquared)
+        {
+            break;
+        }
+
+        for (int r = row - ring; r <= row + ring; r++)
+        {
+            if (r < 0 || r >= (int)m_Rows)
+            {
+                continue;
+            }
+
+            // The top and bottom rows of the ring are visited in full, and the rows between only at the ring's sides.
+            int step = (r == row - ring || r == row + ring) ? 1 : max(ring * 2, 1);
+            for (int c = column - ring; c <= column + ring; c += step)
+            {
+                if (c >= 0 && c < (int)m_Columns)
+                {
+                    searchCell(c, r, point, &nearestSquared, &nearest);
+                }
+            }
+        }
+    }
+
+    if (nearest == m_SegmentCount)
+    {
+        return false;
+    }
+
+    *segment = nearest;
+    if (fraction) *fraction = getNearestFraction(getSegment(nearest), point);
+    if (distance) *distance = sqrtf(nearestSquared);
+    return true;
+}
+
+// Test the segments in a cell against the nearest found so far.
+
+void StreetData::searchCell(unsigned int column, unsigned int row, const MapPoint& point, float* nearestSquared, unsigned int* nearest) const
+{
+    unsigned int cell = row * m_Columns + column;
+    unsigned int begin = m_Cells[cell];
+    unsigned int end = min(m_Cells[cell + 1], m_EntryCount);
+
+    for (unsigned int i = begin; i < end; i++)
+    {
+        unsigned int index = m_Entries[i];
+        if (index >= m_SegmentCount)
+        {
+            continue;
+        }
+
+        StreetSegment segment = getSegment(index);
+        float fraction = getNearestFraction(segment, point);
+        float distanceSquared = (segment.from + (segment.to - segment.from) * fraction).distanceSquared(point);
+
+        // Ties go to the lower index, so that the result doesn't depend on the order the cells are visited in.
+        if (distanceSquared < *nearestSquared || (distanceSquared == *nearestSquared && index < *nearest))
+        {
+            *nearestSquared = distanceSquared;
+            *nearest = index;
+        }
+    }
+}
+
+// Get the nearest point on a segment to another point.
+
+float StreetData::getNearestFraction(const StreetSegment& segment, const MapPoint& point)
+{
+    MapPoint direction = segment.to - segment.from;
+    float lengthSquared = direction.dot(direction);
+    if (lengthSquared == 0)
+    {
+        return 0;
+    }
+
+    float fraction = (point - segment.from).dot(direction) / lengthSquared;
+    return (fraction < 0) ? 0 : (fraction > 1) ? 1 : fraction;
+}
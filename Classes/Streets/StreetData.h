@@ -0,0 +1,292 @@
+//
+//  StreetData.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef STREET_DATA_H
+#define STREET_DATA_H
+
+#include <vector>
+#include "MapPoint.h"
+#include "MapProjection.h"
+
+/**
+ @brief     A straight stretch of street (ie. one side of a block) and the house numbers along it.
+
+ Positions are in metres east and north of the StreetData's origin rather than in map space, so that distances along the streets are real ones however the map is drawn. Numbers run from the "from" end to the "to" end on each side, where left and right are as seen heading from "from" to "to". A side with no numbers has 0 for both.
+ */
+struct StreetSegment
+{
+    MapPoint from;
+    MapPoint to;
+    unsigned int street;
+    unsigned int leftFrom;
+    unsigned int leftTo;
+    unsigned int rightFrom;
+    unsigned int rightTo;
+};
+
+/**
+ @brief     A named place (ie. "Times Square" or "Grand Central") which addresses can be looked up by, as an alias for its location.
+ */
+struct StreetPlace
+{
+    const char* name;
+    MapPoint position;
+};
+
+/**
+ @brief     The streets of the city as written by StreetDataWriter (ie. "streets.nyst" built by Tools/StreetDataBuilder.cpp), memory-mapped and read in place, with a grid for finding the street nearest to a point and an index for looking up streets and places by name.
+
+ All values are little-endian, and every section starts on a 4-byte boundary:
+
+     char[4]    "NYST"
+     uint16     Format version (2)
+     uint16     Reserved
+     uint32     Segment count, and the offset of the segments from the start of the file
+     uint32     Street count, and the offset of the streets
+     uint32     The number of columns and rows in the grid
+     float32    The east and north position of the grid's bottom-left corner, and the width of its cells in metres
+     uint32     The offset of the cells
+     uint32     Entry count, and the offset of the entries
+     uint32     Size of the string table in bytes, and its offset
+     uint32     Size of the whole file in bytes
+     int32      The latitude and longitude of the origin in ten-millionths of a degree
+     uint32     Place count, and the offset of the places
+     uint32     Key count, and the offset of the keys
+     uint32     Reserved
+
+ followed by the segments, grouped by street:
+
+     float32[4] The east and north position of the segment's "from" end, then of its "to" end
+     uint32     The index of the segment's street
+     uint32[4]  The numbers on the left side from and to, then on the right side
+
+ then the streets:
+
+     uint32     The offset of the street's name in the string table
+     uint32     The index of the street's first segment, and its number of segments
+
+ then the places:
+
+     uint32     The offset of the place's name in the string table
+     float32    The east and north position of the place
+
+ then the keys, which are the names of the streets and places as normalized by AddressNormalizer, sorted by their bytes:
+
+     uint32     The offset of the key in the string table
+     uint32     The index of the street it names, or of the place with the top bit set
+
+ then the cells, row by row, with one more at the end:
+
+     uint32     The index of the cell's first entry, the next cell's being just past its last
+
+ then the entries, which list the segments passing through each cell:
+
+     uint32     A segment's index
+
+ and finally the string table, which holds every name and key with a terminating zero byte.
+
+ Positions are flattened from latitude and longitude the same way as MapProjection does, around the origin. Opening the data only checks its header; the street names are checked as they are read.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class StreetData
+{
+public:
+
+    /**
+     @brief     Get the street data shared by the map and its geocoder.
+     @return    A pointer to the shared data.
+     */
+    static StreetData* sharedData();
+
+    /**
+     @brief     Default constructor. The data is empty until it is opened.
+     */
+    StreetData();
+
+    /**
+     @brief     Destructor. Unmaps the file.
+     */
+    ~StreetData();
+
+    /**
+     @brief     Map a street data file, closing any data which was already open.
+     @param     path    The full path of the file.
+     @return    Whether or not the file was valid street data. If not, the data is left empty.
+     */
+    bool open(const char* path);
+
+    /**
+     @brief     Take over street data which was written in memory, closing any data which was already open.
+     @param     data    The data's bytes, which are swapped out of the vector so that they aren't copied.
+     @return    Whether or not the bytes were valid street data. If not, the data is left empty.
+     */
+    bool load(std::vector<unsigned char>* data);
+
+    /**
+     @brief     Unmap the file or free the data, leaving the data empty.
+     */
+    void close();
+
+    /**
+     @brief     Get the number of segments.
+     */
+    unsigned int getSegmentCount() const { return m_SegmentCount; }
+
+    /**
+     @brief     Get a segment.
+     @param     index   The segment's index.
+     @return    The segment.
+     */
+    StreetSegment getSegment(unsigned int index) const;
+
+    /**
+     @brief     Get the number of streets.
+     */
+    unsigned int getStreetCount() const { return m_StreetCount; }
+
+    /**
+     @brief     Get a street's name, which points into the data and so is only valid while it is open.
+     @param     street  The street's index.
+     @return    The name, or an empty string if it lies outside the data.
+     */
+    const char* getStreetName(unsigned int street) const;
+
+    /**
+     @brief     Get the segments along a street, which are stored next to each other.
+     @param     street  The street's index.
+     @param     first   Receives the index of the street's first segment.
+     @return    The number of segments along the street, or 0 if it lies outside the data.
+     */
+    unsigned int getStreetSegments(unsigned int street, unsigned int* first) const;
+
+    /**
+     @brief     Get the number of places.
+     */
+    unsigned int getPlaceCount() const { return m_PlaceCount; }
+
+    /**
+     @brief     Get a place, whose name points into the data and so is only valid while it is open.
+     @param     place   The place's index.
+     @return    The place.
+     */
+    StreetPlace getPlace(unsigned int place) const;
+
+    /**
+     @brief     Find the streets and places with a name, by binary search through the keys.
+     @param     key     The name, normalized by AddressNormalizer.
+     @param     first   Receives the index of the first key which matches.
+     @return    The number of keys which match, which follow each other.
+     */
+    unsigned int findKey(const char* key, unsigned int* first) const;
+
+    /**
+     @brief     Check whether a key names a place rather than a street.
+     @param     index   The key's index.
+     */
+    bool isPlaceKey(unsigned int index) const { return (m_Keys[index * 2 + 1] & PLACE_KEY_FLAG) != 0; }
+
+    /**
+     @brief     Get the index of the street or place a key names.
+     @param     index   The key's index.
+     */
+    unsigned int getKeyTarget(unsigned int index) const { return m_Keys[index * 2 + 1] & ~PLACE_KEY_FLAG; }
+
+    /**
+     @brief     Flatten a latitude and longitude into metres east and north of the origin.
+     */
+    MapPoint flatten(const GeoPoint& location) const;
+
+    /**
+     @brief     Turn a position in metres east and north of the origin back into a latitude and longitude.
+     */
+    GeoPoint unflatten(const MapPoint& position) const;
+
+    /**
+     @brief     Find the segment nearest to a point, searching outwards through the grid one ring of cells at a time until no nearer segment can be left.
+     @param     point       The point in metres east and north of the origin.
+     @param     maxDistance The furthest a segment may be from the point in metres.
+     @param     segment     Receives the index of the nearest segment.
+     @param     fraction    Receives how far along the segment, from 0 at its "from" end to 1 at its "to" end, its nearest point is. May be NULL.
+     @param     distance    Receives the distance to the segment in metres. May be NULL.
+     @return    Whether or not a segment was found.
+     */
+    bool findNearestSegment(const MapPoint& point, float maxDistance, unsigned int* segment, float* fraction, float* distance) const;
+
+    /**
+     @brief     Get the nearest point on a segment to another point.
+     @param     segment     The segment.
+     @param     point       The point in metres east and north of the origin.
+     @return    How far along the segment the nearest point is, from 0 to 1.
+     */
+    static float getNearestFraction(const StreetSegment& segment, const MapPoint& point);
+
+private:
+
+    /** The bit set in a key's target when it names a place. */
+    static const unsigned int PLACE_KEY_FLAG = 0x80000000;
+
+    /**
+     @brief     Get a string from the string table.
+     @return    The string, or an empty string if it lies outside the table.
+     */
+    const char* getString(unsigned int offset) const;
+
+    /**
+     @brief     Declared as private because the data owns its mapping and can't be copied.
+     */
+    StreetData(const StreetData&);
+    StreetData& operator=(const StreetData&);
+
+    /**
+     @brief     Check the header of the mapped file or loaded data and find each of its sections.
+     @return    Whether or not the header was valid.
+     */
+    bool readHeader(const unsigned char* bytes, unsigned long size);
+
+    /**
+     @brief     Test the segments in a cell against the nearest found so far.
+     */
+    void searchCell(unsigned int column, unsigned int row, const MapPoint& point, float* nearestSquared, unsigned int* nearest) const;
+
+    /** The mapped file and its size in bytes, or the data which was loaded. */
+    void* m_Mapping;
+    unsigned long m_MappingSize;
+    std::vector<unsigned char> m_Data;
+
+    /** The number and location of the segments and streets. */
+    unsigned int m_SegmentCount;
+    const unsigned int* m_Segments;
+    unsigned int m_StreetCount;
+    const unsigned int* m_Streets;
+
+    /** The number and location of the places and keys. */
+    unsigned int m_PlaceCount;
+    const unsigned int* m_Places;
+    unsigned int m_KeyCount;
+    const unsigned int* m_Keys;
+
+    /** The grid's dimensions, its cells and their entries. */
+    unsigned int m_Columns;
+    unsigned int m_Rows;
+    MapPoint m_GridMinimum;
+    float m_CellSize;
+    const unsigned int* m_Cells;
+    unsigned int m_EntryCount;
+    const unsigned int* m_Entries;
+
+    /** The string table. */
+    unsigned int m_StringsSize;
+    const char* m_Strings;
+
+    /** The location that is flattened to (0,0), and the number of metres per degree of longitude there. */
+    GeoPoint m_Origin;
+    double m_MetresPerDegreeLongitude;
+};
+
+#endif // STREET_DATA_H
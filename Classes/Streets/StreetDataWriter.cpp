@@ -0,0 +1,364 @@
+//
+//  StreetDataWriter.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "StreetDataWriter.h"
+#include "AddressNormalizer.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+
+// These values must match the format described in StreetData.h.
+static const unsigned int HEADER_SIZE = 96;
+static const unsigned int FILE_VERSION = 2;
+static const unsigned int PLACE_KEY_FLAG = 0x80000000;
+static const double ORIGIN_UNITS_PER_DEGREE = 10000000.0;
+static const double METRES_PER_DEGREE = MapProjection::EARTH_RADIUS * M_PI / 180;
+
+const float StreetDataWriter::CELL_SIZE = 100;
+
+// Append little-endian values to the output.
+
+static void writeUInt16(vector<unsigned char>& output, unsigned int value)
+{
+    output.push_back(value & 0xFF);
+    output.push_back((value >> 8) & 0xFF);
+}
+
+static void writeUInt32(vector<unsigned char>& output, unsigned int value)
+{
+    writeUInt16(output, value & 0xFFFF);
+    writeUInt16(output, value >> 16);
+}
+
+static void writeFloat32(vector<unsigned char>& output, float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeUInt32(output, bits);
+}
+
+// Overwrite a little-endian value which was written earlier.
+
+static void patchUInt32(vector<unsigned char>& output, unsigned int offset, unsigned int value)
+{
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        output[offset + i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+static void patchFloat32(vector<unsigned char>& output, unsigned int offset, float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    patchUInt32(output, offset, bits);
+}
+
+// Pad the output with zeros up to a 4-byte boundary.
+
+static void align(vector<unsigned char>& output)
+{
+    while (output.size() % 4 != 0)
+    {
+        output.push_back(0);
+    }
+}
+
+/**
+ @brief     A key being written, and the index of the street or place it names.
+ */
+struct StreetDataKey
+{
+    string key;
+    unsigned int target;
+};
+
+// Order keys by their bytes, as StreetData searches them with strcmp(...).
+
+static bool isKeyBefore(const StreetDataKey& a, const StreetDataKey& b)
+{
+    return strcmp(a.key.c_str(), b.key.c_str()) < 0;
+}
+
+// Order segments by their street, keeping segments of the same street in the order they were added.
+
+struct StreetDataSegmentOrder
+{
+    const vector<unsigned int>* streets;
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return (*streets)[a] < (*streets)[b] || ((*streets)[a] == (*streets)[b] && a < b);
+    }
+};
+
+/**
+ @brief     The names and keys of the streets and places, each stored once.
+ */
+struct StreetDataStrings
+{
+    vector<char> bytes;
+    map<string, unsigned int> offsets;
+
+    // Add a string to the table, or find it if it's already there.
+    unsigned int add(const string& value)
+    {
+        map<string, unsigned int>::iterator found = offsets.find(value);
+        if (found != offsets.end())
+        {
+            return found->second;
+        }
+
+        unsigned int offset = bytes.size();
+        bytes.insert(bytes.end(), value.begin(), value.end());
+        bytes.push_back('\0');
+        offsets[value] = offset;
+        return offset;
+    }
+};
+
+// Default constructor.
+
+StreetDataWriter::StreetDataWriter()
+{
+}
+
+// Add a straight stretch of street.
+
+void StreetDataWriter::addSegment(const char* street, const GeoPoint& from, const GeoPoint& to,
+                                  unsigned int leftFrom, unsigned int leftTo, unsigned int rightFrom, unsigned int rightTo)
+{
+    string name = street ? street : "";
+    map<string, unsigned int>::iterator found = m_StreetIndices.find(name);
+    if (found == m_StreetIndices.end())
+    {
+        found = m_StreetIndices.insert(make_pair(name, (unsigned int)m_StreetNames.size())).first;
+        m_StreetNames.push_back(name);
+    }
+
+    Segment segment;
+    segment.from = from;
+    segment.to = to;
+    segment.street = found->second;
+    segment.numbers[0] = leftFrom;
+    segment.numbers[1] = leftTo;
+    segment.numbers[2] = rightFrom;
+    segment.numbers[3] = rightTo;
+    m_Segments.push_back(segment);
+}
+
+// Add a named place.
+
+void StreetDataWriter::addPlace(const char* name, const GeoPoint& location)
+{
+    Place place;
+    place.name = name ? name : "";
+    place.location = location;
+    m_Places.push_back(place);
+}
+
+// Write the data in the format described in StreetData.h.
+
+void StreetDataWriter::write(vector<unsigned char>* output) const
+{
+    // Put the origin in the middle of the segments, rounded to the units it's stored in so that the app flattens around exactly the same point.
+    GeoPoint minimum(90, 180), maximum(-90, -180);
+    for (unsigned int i = 0; i < m_Segments.size(); i++)
+    {
+        const GeoPoint* ends[2] = { &m_Segments[i].from, &m_Segments[i].to };
+        for (unsigned int j = 0; j < 2; j++)
+        {
+            minimum.latitude = min(minimum.latitude, ends[j]->latitude);
+            minimum.longitude = min(minimum.longitude, ends[j]->longitude);
+            maximum.latitude = max(maximum.latitude, ends[j]->latitude);
+            maximum.longitude = max(maximum.longitude, ends[j]->longitude);
+        }
+    }
+
+    int originLatitude = 0, originLongitude = 0;
+    if (!m_Segments.empty())
+    {
+        originLatitude = (int)floor((minimum.latitude + maximum.latitude) / 2 * ORIGIN_UNITS_PER_DEGREE + 0.5);
+        originLongitude = (int)floor((minimum.longitude + maximum.longitude) / 2 * ORIGIN_UNITS_PER_DEGREE + 0.5);
+    }
+    double originLatitudeDegrees = originLatitude / ORIGIN_UNITS_PER_DEGREE;
+    double originLongitudeDegrees = originLongitude / ORIGIN_UNITS_PER_DEGREE;
+    double metresPerDegreeLongitude = METRES_PER_DEGREE * cos(originLatitudeDegrees * M_PI / 180);
+
+    // Group the segments by street, so that each street's segments can be found from the street. From here on segments are numbered in the order they are written.
+    vector<unsigned int> segmentStreets(m_Segments.size());
+    vector<unsigned int> order(m_Segments.size());
+    for (unsigned int i = 0; i < m_Segments.size(); i++)
+    {
+        segmentStreets[i] = m_Segments[i].street;
+        order[i] = i;
+    }
+    StreetDataSegmentOrder segmentOrder;
+    segmentOrder.streets = &segmentStreets;
+    sort(order.begin(), order.end(), segmentOrder);
+
+    // Flatten every end, as StreetData::flatten(...) will.
+    vector<float> positions(m_Segments.size() * 4);
+    float minimumEast = 0, minimumNorth = 0, maximumEast = 0, maximumNorth = 0;
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        const Segment& segment = m_Segments[order[i]];
+        const GeoPoint* ends[2] = { &segment.from, &segment.to };
+        for (unsigned int j = 0; j < 2; j++)
+        {
+            float east = (float)((ends[j]->longitude - originLongitudeDegrees) * metresPerDegreeLongitude);
+            float north = (float)((ends[j]->latitude - originLatitudeDegrees) * METRES_PER_DEGREE);
+            positions[i * 4 + j * 2] = east;
+            positions[i * 4 + j * 2 + 1] = north;
+
+            bool isFirst = (i == 0 && j == 0);
+            minimumEast = isFirst ? east : min(minimumEast, east);
+            minimumNorth = isFirst ? north : min(minimumNorth, north);
+            maximumEast = isFirst ? east : max(maximumEast, east);
+            maximumNorth = isFirst ? north : max(maximumNorth, north);
+        }
+    }
+
+    // Lay the grid over the segments, and list each segment in every cell its bounds overlap. Segments are short, so that is rarely more than a couple of cells.
+    unsigned int columns = (unsigned int)((maximumEast - minimumEast) / CELL_SIZE) + 1;
+    unsigned int rows = (unsigned int)((maximumNorth - minimumNorth) / CELL_SIZE) + 1;
+    vector<vector<unsigned int> > cells(columns * rows);
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        const float* ends = &positions[i * 4];
+        unsigned int firstColumn = (unsigned int)((min(ends[0], ends[2]) - minimumEast) / CELL_SIZE);
+        unsigned int lastColumn = min((unsigned int)((max(ends[0], ends[2]) - minimumEast) / CELL_SIZE), columns - 1);
+        unsigned int firstRow = (unsigned int)((min(ends[1], ends[3]) - minimumNorth) / CELL_SIZE);
+        unsigned int lastRow = min((unsigned int)((max(ends[1], ends[3]) - minimumNorth) / CELL_SIZE), rows - 1);
+
+        for (unsigned int row = firstRow; row <= lastRow; row++)
+        {
+            for (unsigned int column = firstColumn; column <= lastColumn; column++)
+            {
+                cells[row * columns + column].push_back(i);
+            }
+        }
+    }
+
+    // Normalize the name of every street and place into a key, leaving out names with nothing left to look up.
+    vector<StreetDataKey> keys;
+    for (unsigned int i = 0; i < m_StreetNames.size() + m_Places.size(); i++)
+    {
+        bool isPlace = (i >= m_StreetNames.size());
+        StreetDataKey key;
+        AddressNormalizer::normalize(isPlace ? m_Places[i - m_StreetNames.size()].name.c_str() : m_StreetNames[i].c_str(), &key.key);
+        key.target = isPlace ? ((i - m_StreetNames.size()) | PLACE_KEY_FLAG) : i;
+        if (!key.key.empty())
+        {
+            keys.push_back(key);
+        }
+    }
+    stable_sort(keys.begin(), keys.end(), isKeyBefore);
+
+    // Write the header, leaving the offsets to be filled in once the sections are in place.
+    output->clear();
+    output->insert(output->end(), "NYST", "NYST" + 4);
+    writeUInt16(*output, FILE_VERSION);
+    writeUInt16(*output, 0);
+    output->resize(HEADER_SIZE, 0);
+
+    patchUInt32(*output, 8, m_Segments.size());
+    patchUInt32(*output, 16, m_StreetNames.size());
+    patchUInt32(*output, 24, columns);
+    patchUInt32(*output, 28, rows);
+    patchFloat32(*output, 32, minimumEast);
+    patchFloat32(*output, 36, minimumNorth);
+    patchFloat32(*output, 40, CELL_SIZE);
+    patchUInt32(*output, 68, (unsigned int)originLatitude);
+    patchUInt32(*output, 72, (unsigned int)originLongitude);
+    patchUInt32(*output, 76, m_Places.size());
+    patchUInt32(*output, 84, keys.size());
+
+    patchUInt32(*output, 12, output->size());
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            writeFloat32(*output, positions[i * 4 + j]);
+        }
+
+        const Segment& segment = m_Segments[order[i]];
+        writeUInt32(*output, segment.street);
+        for (unsigned int j = 0; j < 4; j++)
+        {
+            writeUInt32(*output, segment.numbers[j]);
+        }
+    }
+
+    // Gather the names into the string table as the streets are written. The segments are grouped by street, so each street's run starts where the last one's ended.
+    StreetDataStrings strings;
+    patchUInt32(*output, 20, output->size());
+    unsigned int firstSegment = 0;
+    for (unsigned int i = 0; i < m_StreetNames.size(); i++)
+    {
+        unsigned int segmentCount = 0;
+        while (firstSegment + segmentCount < order.size() && segmentStreets[order[firstSegment + segmentCount]] == i)
+        {
+            segmentCount++;
+        }
+
+        writeUInt32(*output, strings.add(m_StreetNames[i]));
+        writeUInt32(*output, firstSegment);
+        writeUInt32(*output, segmentCount);
+        firstSegment += segmentCount;
+    }
+
+    patchUInt32(*output, 80, output->size());
+    for (unsigned int i = 0; i < m_Places.size(); i++)
+    {
+        writeUInt32(*output, strings.add(m_Places[i].name));
+        writeFloat32(*output, (float)((m_Places[i].location.longitude - originLongitudeDegrees) * metresPerDegreeLongitude));
+        writeFloat32(*output, (float)((m_Places[i].location.latitude - originLatitudeDegrees) * METRES_PER_DEGREE));
+    }
+
+    patchUInt32(*output, 88, output->size());
+    for (unsigned int i = 0; i < keys.size(); i++)
+    {
+        writeUInt32(*output, strings.add(keys[i].key));
+        writeUInt32(*output, keys[i].target);
+    }
+
+    // An empty table would have no terminating zero for StreetData to check.
+    if (strings.bytes.empty())
+    {
+        strings.bytes.push_back('\0');
+    }
+
+    patchUInt32(*output, 44, output->size());
+    unsigned int entryCount = 0;
+    for (unsigned int i = 0; i < cells.size(); i++)
+    {
+        writeUInt32(*output, entryCount);
+        entryCount += cells[i].size();
+    }
+    writeUInt32(*output, entryCount);
+
+    patchUInt32(*output, 48, entryCount);
+    patchUInt32(*output, 52, output->size());
+    for (unsigned int i = 0; i < cells.size(); i++)
+    {
+        for (unsigned int j = 0; j < cells[i].size(); j++)
+        {
+            writeUInt32(*output, cells[i][j]);
+        }
+    }
+
+    patchUInt32(*output, 56, strings.bytes.size());
+    patchUInt32(*output, 60, output->size());
+    output->insert(output->end(), strings.bytes.begin(), strings.bytes.end());
+    align(*output);
+
+    patchUInt32(*output, 64, output->size());
+}
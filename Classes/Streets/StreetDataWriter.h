@@ -0,0 +1,108 @@
+//
+//  StreetDataWriter.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef STREET_DATA_WRITER_H
+#define STREET_DATA_WRITER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "MapProjection.h"
+
+/**
+ @brief     Builds the street data read by StreetData (see Tools/StreetDataBuilder.cpp), including the grid used to find the street nearest to a point and the keys used to look streets and places up by name.
+
+ Segments can be added in any order. Streets are numbered in the order their names first appear, each name is only stored once, and each street's segments are written together in the order they were added. The origin is put in the middle of the segments, and the grid is only laid out when the data is written.
+
+ This class has no dependencies on cocos2d so that it can be built into the command-line tools.
+ */
+class StreetDataWriter
+{
+public:
+
+    /** The width of the grid's cells in metres, which is about the length of a short block so that a cell holds a handful of segments. */
+    static const float CELL_SIZE;
+
+    /**
+     @brief     Default constructor. There are no segments.
+     */
+    StreetDataWriter();
+
+    /**
+     @brief     Add a straight stretch of street.
+     @param     street      The street's name, in UTF-8.
+     @param     from        The location of one end of the segment.
+     @param     to          The location of the other end.
+     @param     leftFrom    The number on the left side at the "from" end (as seen heading towards the "to" end), or 0 if the side has no numbers.
+     @param     leftTo      The number on the left side at the "to" end.
+     @param     rightFrom   The number on the right side at the "from" end, or 0 if the side has no numbers.
+     @param     rightTo     The number on the right side at the "to" end.
+     */
+    void addSegment(const char* street, const GeoPoint& from, const GeoPoint& to,
+                    unsigned int leftFrom, unsigned int leftTo, unsigned int rightFrom, unsigned int rightTo);
+
+    /**
+     @brief     Add a named place, which addresses can be looked up by. A place can be added under several names.
+     @param     name        The place's name, in UTF-8.
+     @param     location    The place's location.
+     */
+    void addPlace(const char* name, const GeoPoint& location);
+
+    /**
+     @brief     Get the number of segments which have been added.
+     */
+    unsigned int getSegmentCount() const { return m_Segments.size(); }
+
+    /**
+     @brief     Get the number of different streets which have been added.
+     */
+    unsigned int getStreetCount() const { return m_StreetNames.size(); }
+
+    /**
+     @brief     Get the number of places which have been added.
+     */
+    unsigned int getPlaceCount() const { return m_Places.size(); }
+
+    /**
+     @brief     Write the data in the format described in StreetData.h.
+     @param     output  The vector to store the data's bytes in.
+     */
+    void write(std::vector<unsigned char>* output) const;
+
+private:
+
+    /**
+     @brief     A segment as it was added.
+     */
+    struct Segment
+    {
+        GeoPoint from;
+        GeoPoint to;
+        unsigned int street;
+        unsigned int numbers[4];
+    };
+
+    /**
+     @brief     A place as it was added.
+     */
+    struct Place
+    {
+        std::string name;
+        GeoPoint location;
+    };
+
+    /** The segments and places, in the order they were added. */
+    std::vector<Segment> m_Segments;
+    std::vector<Place> m_Places;
+
+    /** The name of each street, and the index of each name. */
+    std::vector<std::string> m_StreetNames;
+    std::map<std::string, unsigned int> m_StreetIndices;
+};
+
+#endif // STREET_DATA_WRITER_H
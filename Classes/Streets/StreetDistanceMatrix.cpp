@@ -0,0 +1,200 @@
+//
+//  StreetDistanceMatrix.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "StreetDistanceMatrix.h"
+#include "StreetRouter.h"
+#include <algorithm>
+#include <pthread.h>
+
+using namespace std;
+
+const unsigned int StreetDistanceMatrix::NO_STOP;
+
+/**
+ @brief     The state shared by the threads while the new stops are searched from.
+ */
+struct StreetDistanceMatrixJob
+{
+    const StreetDistanceMatrix* matrix;
+    const vector<unsigned int>* targets;
+    vector<vector<float> >* rows;
+    unsigned int firstStop;
+
+    pthread_mutex_t mutex;
+    unsigned int nextStop;
+};
+
+// Create an empty matrix for a street graph.
+
+StreetDistanceMatrix::StreetDistanceMatrix(const StreetGraph* graph)
+: m_Graph(graph)
+{
+}
+
+// Add a stop, unless there is one at the same point already.
+
+unsigned int StreetDistanceMatrix::addStop(const MapPoint& point)
+{
+    // A tour usually starts from the same place as the last one, and visits many of the same landmarks.
+    for (unsigned int i = 0; i < m_Points.size(); i++)
+    {
+        if (m_Points[i] == point)
+        {
+            return i;
+        }
+    }
+
+    StreetGraphLocation location;
+    if (!m_Graph->locate(point, StreetRouter::MAX_SNAP_DISTANCE, &location))
+    {
+        return NO_STOP;
+    }
+
+    m_Points.push_back(point);
+    m_Locations.push_back(location);
+    return m_Points.size() - 1;
+}
+
+// Work out the distances to and from the stops added since the last update.
+
+void StreetDistanceMatrix::update(unsigned int threadCount)
+{
+    unsigned int firstStop = m_Rows.size();
+    unsigned int stopCount = m_Points.size();
+    if (firstStop == stopCount)
+    {
+        return;
+    }
+
+    // Every search stops once it has reached both corners of every stop's segment.
+    vector<unsigned int> targets;
+    targets.reserve(stopCount * 2);
+    for (unsigned int i = 0; i < stopCount; i++)
+    {
+        targets.push_back(m_Locations[i].nodes[0]);
+        targets.push_back(m_Locations[i].nodes[1]);
+    }
+
+    // The calling thread claims stops along with the others, so only threadCount - 1 are started. A thread which can't be started just leaves more for the rest.
+    vector<vector<float> > newRows(stopCount - firstStop);
+    StreetDistanceMatrixJob job;
+    job.matrix = this;
+    job.targets = &targets;
+    job.rows = &newRows;
+    job.firstStop = firstStop;
+    job.nextStop = firstStop;
+    pthread_mutex_init(&job.mutex, NULL);
+
+    unsigned int extraThreads = min(max(threadCount, 1u), stopCount - firstStop) - 1;
+    vector<pthread_t> threads(extraThreads);
+    unsigned int startedCount = 0;
+    for (unsigned int i = 0; i < extraThreads; i++)
+    {
+        if (pthread_create(&threads[startedCount], NULL, workerMain, &job) == 0)
+        {
+            startedCount++;
+        }
+    }
+
+    workerMain(&job);
+    for (unsigned int i = 0; i < startedCount; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&job.mutex);
+
+    // The stops already in the matrix take their distances to the new ones from the new stops' searches. Two new stops found each other's distances separately, and the shorter is kept for both so that the matrix stays symmetric (they can only differ by rounding).
+    for (unsigned int i = 0; i < firstStop; i++)
+    {
+        m_Rows[i].resize(stopCount);
+        for (unsigned int j = firstStop; j < stopCount; j++)
+        {
+            m_Rows[i][j] = newRows[j - firstStop][i];
+        }
+    }
+
+    for (unsigned int i = firstStop; i < stopCount; i++)
+    {
+        vector<float>& row = newRows[i - firstStop];
+        for (unsigned int j = firstStop; j < i; j++)
+        {
+            float distance = min(row[j], newRows[j - firstStop][i]);
+            row[j] = distance;
+            newRows[j - firstStop][i] = distance;
+        }
+    }
+
+    m_Rows.resize(stopCount);
+    for (unsigned int i = firstStop; i < stopCount; i++)
+    {
+        m_Rows[i].swap(newRows[i - firstStop]);
+    }
+}
+
+// Remove every stop.
+
+void StreetDistanceMatrix::clear()
+{
+    m_Points.clear();
+    m_Locations.clear();
+    m_Rows.clear();
+}
+
+// Search the graph from a stop, and find its distances to every stop.
+
+void StreetDistanceMatrix::findRow(unsigned int stop, const vector<unsigned int>& targets, vector<float>* row) const
+{
+    const StreetGraphLocation& from = m_Locations[stop];
+    vector<float> distances;
+    m_Graph->findDistances(from.nodes, from.offsets, 2, targets.empty() ? NULL : &targets[0], targets.size(), &distances);
+
+    // Each stop is reached through whichever corner of its segment is nearer, or straight along the segment if both stops are on the same one.
+    row->assign(m_Locations.size(), StreetGraph::UNREACHABLE);
+    for (unsigned int i = 0; i < m_Locations.size(); i++)
+    {
+        const StreetGraphLocation& to = m_Locations[i];
+        float& distance = (*row)[i];
+        if (to.segment == from.segment)
+        {
+            distance = from.position.distance(to.position);
+        }
+
+        for (int corner = 0; corner < 2; corner++)
+        {
+            float cornerDistance = distances[to.nodes[corner]];
+            if (cornerDistance != StreetGraph::UNREACHABLE)
+            {
+                distance = min(distance, cornerDistance + to.offsets[corner]);
+            }
+        }
+    }
+}
+
+// A worker thread's main loop, which claims stops to search from until none are left.
+
+void* StreetDistanceMatrix::workerMain(void* argument)
+{
+    StreetDistanceMatrixJob& job = *(StreetDistanceMatrixJob*)argument;
+
+    while (true)
+    {
+        pthread_mutex_lock(&job.mutex);
+        unsigned int stop = job.nextStop++;
+        pthread_mutex_unlock(&job.mutex);
+
+        if (stop >= job.firstStop + job.rows->size())
+        {
+            break;
+        }
+
+        // Each stop's row is only ever written by the thread which claimed it.
+        job.matrix->findRow(stop, *job.targets, &(*job.rows)[stop - job.firstStop]);
+    }
+
+    return NULL;
+}
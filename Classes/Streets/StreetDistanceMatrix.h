@@ -0,0 +1,103 @@
+//
+//  StreetDistanceMatrix.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef STREET_DISTANCE_MATRIX_H
+#define STREET_DISTANCE_MATRIX_H
+
+#include <vector>
+#include "StreetGraph.h"
+
+/**
+ @brief     The walking distances between every pair of a set of stops (ie. the landmarks of a tour), kept between tours so that each stop's distances are only ever worked out once.
+
+ Stops are added one at a time and their distances are worked out together by update(). Each new stop takes one search of the graph from the street beside it, which stops once every other stop's street has been reached, and gives its distances to every stop at once; a stop already in the matrix only gains the distances to the new ones, which the new stops' searches have already found. The searches are independent of each other, so they are shared out between several threads.
+
+ Walking distances are the same in both directions, so the matrix is kept symmetric. Stops which can't be reached from each other (ie. on streets which aren't connected) are StreetGraph::UNREACHABLE apart.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class StreetDistanceMatrix
+{
+public:
+
+    /** The value of a stop which couldn't be added. */
+    static const unsigned int NO_STOP = 0xFFFFFFFF;
+
+    /**
+     @brief     Create an empty matrix for a street graph.
+     @param     graph   The graph to measure distances through, which must outlive the matrix. If it is built again, the matrix must be cleared.
+     */
+    explicit StreetDistanceMatrix(const StreetGraph* graph);
+
+    /**
+     @brief     Add a stop, unless there is one at the same point already. Its distances aren't known until update() is called.
+     @param     point   The stop, in metres east and north of the street data's origin.
+     @return    The stop's index, which stays the same until the matrix is cleared, or NO_STOP if it is further than StreetRouter::MAX_SNAP_DISTANCE from a street.
+     */
+    unsigned int addStop(const MapPoint& point);
+
+    /**
+     @brief     Work out the distances to and from the stops added since the last update.
+     @param     threadCount     The number of threads to share the searches between, including the calling thread.
+     */
+    void update(unsigned int threadCount);
+
+    /**
+     @brief     Remove every stop.
+     */
+    void clear();
+
+    /**
+     @brief     Get the number of stops, including any which haven't been updated yet.
+     */
+    unsigned int getStopCount() const { return m_Points.size(); }
+
+    /**
+     @brief     Get the number of stops which have been added since the last update.
+     */
+    unsigned int getPendingCount() const { return m_Points.size() - m_Rows.size(); }
+
+    /**
+     @brief     Get the point a stop was added at.
+     */
+    const MapPoint& getPoint(unsigned int stop) const { return m_Points[stop]; }
+
+    /**
+     @brief     Get the walking distance between two stops, both of which must have been updated.
+     @return    The distance in metres, or StreetGraph::UNREACHABLE if neither can be reached from the other.
+     */
+    float getDistance(unsigned int from, unsigned int to) const { return m_Rows[from][to]; }
+
+private:
+
+    /**
+     @brief     Search the graph from a stop, and find its distances to every stop.
+     @param     stop        The stop to search from.
+     @param     targets     The nodes at either end of every stop's segment.
+     @param     row         Receives the stop's distance to every stop.
+     */
+    void findRow(unsigned int stop, const std::vector<unsigned int>& targets, std::vector<float>* row) const;
+
+    /**
+     @brief     A worker thread's main loop, which claims stops to search from until none are left.
+     @param     argument    The shared StreetDistanceMatrixJob.
+     */
+    static void* workerMain(void* argument);
+
+    /** The graph the distances are measured through. */
+    const StreetGraph* m_Graph;
+
+    /** The point each stop was added at, and where that is on the street. */
+    std::vector<MapPoint> m_Points;
+    std::vector<StreetGraphLocation> m_Locations;
+
+    /** The distances from each updated stop to every updated stop. */
+    std::vector<std::vector<float> > m_Rows;
+};
+
+#endif // STREET_DISTANCE_MATRIX_H
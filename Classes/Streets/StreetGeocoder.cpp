@@ -0,0 +1,393 @@
+//
+//  StreetGeocoder.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "StreetGeocoder.h"
+#include "AddressNormalizer.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+const float StreetGeocoder::MAX_REVERSE_DISTANCE = 150;
+const float StreetGeocoder::INTERSECTION_TOLERANCE = 30;
+
+// The words a street's name can start with to say which side of the city it's on. A name without one is looked up with "west" and "east" in front.
+static const char* DIRECTION_PREFIXES[] = { "west ", "east ", "north ", "south " };
+static const unsigned int DIRECTION_PREFIX_COUNT = 4;
+
+/**
+ @brief     The end of a segment of a street, ordered from west to east, for finding where streets cross.
+ */
+struct StreetGeocoderEnd
+{
+    StreetGeocoderEnd(const MapPoint& position, unsigned int street) : position(position), street(street) { }
+
+    bool operator<(const StreetGeocoderEnd& other) const { return position.x < other.position.x || (position.x == other.position.x && position.y < other.position.y); }
+
+    MapPoint position;
+    unsigned int street;
+};
+
+// The words which join two streets into an intersection, with the spaces around them.
+static const char* INTERSECTION_WORDS[] = { " and ", " at " };
+static const unsigned int INTERSECTION_WORD_COUNT = 2;
+
+// Interpolate a house number along one side of a segment, keeping the parity of the side's first number.
+
+static unsigned int interpolateNumber(unsigned int from, unsigned int to, float fraction)
+{
+    if (from == 0 && to == 0)
+    {
+        return 0;
+    }
+
+    int number = (int)floorf(from + ((int)to - (int)from) * fraction + 0.5f);
+    if ((number - (int)from) % 2 != 0)
+    {
+        // Step back towards the "from" end, which always has the right parity.
+        number += (to >= from) ? -1 : 1;
+    }
+    return (number > 0) ? number : from;
+}
+
+// Create a geocoder for some street data.
+
+StreetGeocoder::StreetGeocoder(const StreetData* data)
+: m_Data(data)
+{
+}
+
+// Find the street address nearest to a location.
+
+bool StreetGeocoder::reverseGeocode(const GeoPoint& location, StreetAddress* address) const
+{
+    MapPoint point = m_Data->flatten(location);
+    unsigned int index;
+    float fraction, distance;
+    if (!m_Data->findNearestSegment(point, MAX_REVERSE_DISTANCE, &index, &fraction, &distance))
+    {
+        return false;
+    }
+
+    StreetSegment segment = m_Data->getSegment(index);
+    MapPoint direction = segment.to - segment.from;
+    MapPoint offset = point - segment.from;
+
+    // The location is on the left if it is anticlockwise of the segment's direction. A side without numbers falls back on the other side, so that a street with buildings on one side still gets an address from either.
+    bool isLeft = direction.cross(offset) > 0;
+    bool leftHasNumbers = segment.leftFrom != 0 || segment.leftTo != 0;
+    bool rightHasNumbers = segment.rightFrom != 0 || segment.rightTo != 0;
+    if (isLeft && !leftHasNumbers && rightHasNumbers)
+    {
+        isLeft = false;
+    }
+    else if (!isLeft && !rightHasNumbers && leftHasNumbers)
+    {
+        isLeft = true;
+    }
+
+    *address = StreetAddress();
+    address->street = m_Data->getStreetName(segment.street);
+    address->rangeFrom = isLeft ? segment.leftFrom : segment.rightFrom;
+    address->rangeTo = isLeft ? segment.leftTo : segment.rightTo;
+    address->number = interpolateNumber(address->rangeFrom, address->rangeTo, fraction);
+    address->location = m_Data->unflatten(segment.from + direction * fraction);
+    address->distance = distance;
+    address->segment = index;
+    return true;
+}
+
+// Find the location of an address which the user typed.
+
+bool StreetGeocoder::geocode(const char* query, StreetAddress* address) const
+{
+    string key;
+    AddressNormalizer::normalize(query, &key);
+
+    // Try the whole query, then without a zip code at the end (ie. "350 5th Ave, New York, NY 10118").
+    string keys[2] = { key, "" };
+    size_t lastSpace = key.rfind(' ');
+    if (lastSpace != string::npos && key.size() - lastSpace - 1 == 5 && AddressNormalizer::isNumber(key.c_str() + lastSpace + 1, 5, NULL))
+    {
+        keys[1] = key.substr(0, lastSpace);
+    }
+
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        if (keys[i].empty())
+        {
+            continue;
+        }
+
+        // A place or a street on its own.
+        if (findName(keys[i], 0, address))
+        {
+            return true;
+        }
+
+        // Two streets which cross.
+        for (unsigned int j = 0; j < INTERSECTION_WORD_COUNT; j++)
+        {
+            size_t split = keys[i].find(INTERSECTION_WORDS[j]);
+            if (split != string::npos && findIntersection(keys[i].substr(0, split), keys[i].substr(split + strlen(INTERSECTION_WORDS[j])), address))
+            {
+                return true;
+            }
+        }
+
+        // A house number followed by its street.
+        size_t firstSpace = keys[i].find(' ');
+        unsigned int number;
+        if (firstSpace != string::npos && AddressNormalizer::isNumber(keys[i].c_str(), firstSpace, &number) && number > 0 &&
+            findName(keys[i].substr(firstSpace + 1), number, address))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Format an address for display.
+
+void StreetGeocoder::formatAddress(const StreetAddress& address, string* text)
+{
+    text->clear();
+    if (address.number != 0)
+    {
+        char number[16];
+        snprintf(number, sizeof(number), "%u ", address.number);
+        *text = number;
+    }
+    *text += address.street;
+
+    if (address.crossStreet[0] != '\0')
+    {
+        *text += " & ";
+        *text += address.crossStreet;
+    }
+}
+
+// Collect the streets a normalized name can refer to.
+
+void StreetGeocoder::findStreets(const string& key, vector<unsigned int>* streets) const
+{
+    // People often leave out "Street" or "Avenue" (ie. "w 45th" or "Lexington").
+    vector<string> names(1, key);
+    size_t lastSpace = key.rfind(' ');
+    string lastWord = key.substr((lastSpace == string::npos) ? 0 : lastSpace + 1);
+    if (lastWord != "street" && lastWord != "avenue")
+    {
+        names.push_back(key + " street");
+        names.push_back(key + " avenue");
+    }
+
+    bool hasDirection = false;
+    for (unsigned int i = 0; i < DIRECTION_PREFIX_COUNT; i++)
+    {
+        hasDirection = hasDirection || key.compare(0, strlen(DIRECTION_PREFIXES[i]), DIRECTION_PREFIXES[i]) == 0;
+    }
+    for (unsigned int i = 0, count = names.size(); !hasDirection && i < count; i++)
+    {
+        names.push_back(DIRECTION_PREFIXES[0] + names[i]);
+        names.push_back(DIRECTION_PREFIXES[1] + names[i]);
+    }
+
+    for (unsigned int i = 0; i < names.size(); i++)
+    {
+        unsigned int first;
+        unsigned int count = m_Data->findKey(names[i].c_str(), &first);
+        for (unsigned int j = first; j < first + count; j++)
+        {
+            if (!m_Data->isPlaceKey(j))
+            {
+                streets->push_back(m_Data->getKeyTarget(j));
+            }
+        }
+    }
+}
+
+// Look up a normalized street or place name.
+
+bool StreetGeocoder::findName(const string& key, unsigned int number, StreetAddress* address) const
+{
+    // Without a house number, a place is a better match than a street of the same name.
+    unsigned int first;
+    unsigned int count = m_Data->findKey(key.c_str(), &first);
+    for (unsigned int i = first; number == 0 && i < first + count; i++)
+    {
+        if (m_Data->isPlaceKey(i))
+        {
+            StreetPlace place = m_Data->getPlace(m_Data->getKeyTarget(i));
+            *address = StreetAddress();
+            address->street = place.name;
+            address->location = m_Data->unflatten(place.position);
+            return true;
+        }
+    }
+
+    // Otherwise take the street which fits the number best, so that "20 45th St" finds whichever side of the city has a 20.
+    vector<unsigned int> streets;
+    findStreets(key, &streets);
+    bool isFound = false;
+    unsigned int bestMismatch = 0;
+    for (unsigned int i = 0; i < streets.size(); i++)
+    {
+        StreetAddress candidate;
+        unsigned int mismatch;
+        if (placeNumber(streets[i], number, &candidate, &mismatch) && (!isFound || mismatch < bestMismatch))
+        {
+            *address = candidate;
+            bestMismatch = mismatch;
+            isFound = true;
+        }
+    }
+
+    return isFound;
+}
+
+// Place a house number along a street.
+
+bool StreetGeocoder::placeNumber(unsigned int street, unsigned int number, StreetAddress* address, unsigned int* mismatch) const
+{
+    unsigned int first;
+    unsigned int count = m_Data->getStreetSegments(street, &first);
+    if (count == 0)
+    {
+        return false;
+    }
+
+    // Without a number, use the middle of the street.
+    unsigned int bestSegment = first + count / 2;
+    bool bestIsLeft = true;
+    float bestFraction = 0.5f;
+    *mismatch = 0;
+
+    if (number != 0)
+    {
+        bool isFound = false;
+        for (unsigned int i = first; i < first + count; i++)
+        {
+            StreetSegment segment = m_Data->getSegment(i);
+            for (unsigned int side = 0; side < 2; side++)
+            {
+                unsigned int from = (side == 0) ? segment.leftFrom : segment.rightFrom;
+                unsigned int to = (side == 0) ? segment.leftTo : segment.rightTo;
+                if (from == 0 && to == 0)
+                {
+                    continue;
+                }
+
+                // A range which holds the number fits best on the side with its parity. Otherwise, the nearer the range the better, and the number goes at its nearer end.
+                unsigned int low = min(from, to), high = max(from, to);
+                unsigned int sideMismatch;
+                float fraction;
+                if (number >= low && number <= high)
+                {
+                    sideMismatch = ((number - from) % 2 == 0) ? 0 : 1;
+                    fraction = (from == to) ? 0.5f : ((float)number - from) / ((float)to - from);
+                }
+                else
+                {
+                    sideMismatch = 2 + ((number < low) ? low - number : number - high);
+                    fraction = ((number < low) == (from <= to)) ? 0 : 1;
+                }
+
+                if (!isFound || sideMismatch < *mismatch)
+                {
+                    bestSegment = i;
+                    bestIsLeft = (side == 0);
+                    bestFraction = fraction;
+                    *mismatch = sideMismatch;
+                    isFound = true;
+                }
+            }
+        }
+
+        // A street with no numbers at all still has a middle.
+        if (!isFound)
+        {
+            *mismatch = 2 + number;
+        }
+    }
+
+    StreetSegment segment = m_Data->getSegment(bestSegment);
+    *address = StreetAddress();
+    address->street = m_Data->getStreetName(street);
+    address->number = number;
+    address->rangeFrom = bestIsLeft ? segment.leftFrom : segment.rightFrom;
+    address->rangeTo = bestIsLeft ? segment.leftTo : segment.rightTo;
+    address->location = m_Data->unflatten(segment.from + (segment.to - segment.from) * bestFraction);
+    address->segment = bestSegment;
+    return true;
+}
+
+// Find where two streets cross.
+
+bool StreetGeocoder::findIntersection(const string& firstKey, const string& secondKey, StreetAddress* address) const
+{
+    vector<unsigned int> firstStreets, secondStreets;
+    findStreets(firstKey, &firstStreets);
+    findStreets(secondKey, &secondStreets);
+    if (firstStreets.empty() || secondStreets.empty())
+    {
+        return false;
+    }
+
+    // Segments are split at every corner, so the streets cross where the ends of their segments meet. The second streets' ends are sorted from west to east, so that each of the first streets' ends only has to be compared with the ends in a narrow band around it rather than every one of them.
+    vector<StreetGeocoderEnd> secondEnds;
+    for (unsigned int i = 0; i < secondStreets.size(); i++)
+    {
+        unsigned int first;
+        unsigned int count = m_Data->getStreetSegments(secondStreets[i], &first);
+        for (unsigned int j = first; j < first + count; j++)
+        {
+            StreetSegment segment = m_Data->getSegment(j);
+            secondEnds.push_back(StreetGeocoderEnd(segment.from, secondStreets[i]));
+            secondEnds.push_back(StreetGeocoderEnd(segment.to, secondStreets[i]));
+        }
+    }
+    sort(secondEnds.begin(), secondEnds.end());
+
+    float bestSquared = INTERSECTION_TOLERANCE * INTERSECTION_TOLERANCE;
+    bool isFound = false;
+    for (unsigned int i = 0; i < firstStreets.size(); i++)
+    {
+        unsigned int first;
+        unsigned int count = m_Data->getStreetSegments(firstStreets[i], &first);
+        for (unsigned int j = first; j < first + count; j++)
+        {
+            StreetSegment segment = m_Data->getSegment(j);
+            MapPoint ends[2] = { segment.from, segment.to };
+            for (unsigned int k = 0; k < 2; k++)
+            {
+                vector<StreetGeocoderEnd>::const_iterator end = lower_bound(secondEnds.begin(), secondEnds.end(),
+                                                                            StreetGeocoderEnd(MapPoint(ends[k].x - INTERSECTION_TOLERANCE, -FLT_MAX), 0));
+                for (; end != secondEnds.end() && end->position.x <= ends[k].x + INTERSECTION_TOLERANCE; ++end)
+                {
+                    float distanceSquared = ends[k].distanceSquared(end->position);
+                    if (end->street != firstStreets[i] && distanceSquared <= bestSquared && (!isFound || distanceSquared < bestSquared))
+                    {
+                        bestSquared = distanceSquared;
+                        isFound = true;
+                        *address = StreetAddress();
+                        address->street = m_Data->getStreetName(firstStreets[i]);
+                        address->crossStreet = m_Data->getStreetName(end->street);
+                        address->location = m_Data->unflatten((ends[k] + end->position) * 0.5f);
+                        address->segment = j;
+                    }
+                }
+            }
+        }
+    }
+
+    return isFound;
+}
@@ -0,0 +1,138 @@
+//
+//  StreetGeocoder.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef STREET_GEOCODER_H
+#define STREET_GEOCODER_H
+
+#include <string>
+#include <vector>
+#include "StreetData.h"
+
+/**
+ @brief     A street address, as found by a StreetGeocoder.
+ */
+struct StreetAddress
+{
+    /** The segment of an address which is a place rather than a street. */
+    static const unsigned int NO_SEGMENT = 0xFFFFFFFF;
+
+    StreetAddress() : street(""), crossStreet(""), number(0), rangeFrom(0), rangeTo(0), distance(0), segment(NO_SEGMENT) { }
+
+    /** The street's name, or the place's, which stays valid for as long as the StreetData it came from is open. */
+    const char* street;
+
+    /** The name of the street which crosses the street at an intersection, or an empty string if the address isn't one. */
+    const char* crossStreet;
+
+    /** The house number, or 0 if that side of the street has no numbers. */
+    unsigned int number;
+
+    /** The numbers along that side of the segment, from its "from" end to its "to" end. */
+    unsigned int rangeFrom;
+    unsigned int rangeTo;
+
+    /** The location on the street that the address is for. */
+    GeoPoint location;
+
+    /** How far the location that was looked up is from the street in metres, or 0 if the address was looked up by name. */
+    float distance;
+
+    /** The index of the StreetData segment the address is on, or NO_SEGMENT for a place. */
+    unsigned int segment;
+};
+
+/**
+ @brief     Turns locations into street addresses and addresses back into locations using bundled StreetData, without needing a network connection.
+
+ To find the address of a location, the nearest segment is found through the data's grid, the side of the street is the side the location is on, and the number is interpolated along that side's range, keeping the range's odd or even parity.
+
+ To find the location of an address, it is normalized by AddressNormalizer and looked up in the data's keys as a place (ie. "Times Square"), a street with or without a house number (ie. "350 Fifth Ave"), or two streets which cross (ie. "5th Ave & 42nd St"). A street given without "East" or "West" is looked for on both sides. A house number is placed by interpolating along the segment whose range holds it, on the side with the same parity.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class StreetGeocoder
+{
+public:
+
+    /** How far from a street in metres a location can be and still get an address, so that taps in the rivers or the park don't get one. */
+    static const float MAX_REVERSE_DISTANCE;
+
+    /**
+     @brief     Create a geocoder for some street data.
+     @param     data    The street data to look addresses up in, which must outlive the geocoder.
+     */
+    explicit StreetGeocoder(const StreetData* data);
+
+    /**
+     @brief     Find the street address nearest to a location.
+     @param     location    The location to look up.
+     @param     address     Receives the address.
+     @return    Whether or not there is a street within MAX_REVERSE_DISTANCE of the location.
+     */
+    bool reverseGeocode(const GeoPoint& location, StreetAddress* address) const;
+
+    /** How far apart in metres the ends of two streets' segments can be while still counting as the streets crossing. */
+    static const float INTERSECTION_TOLERANCE;
+
+    /**
+     @brief     Find the location of an address which the user typed, or which was written for Google Maps (ie. "Madison+Square+Garden+NYC").
+     @param     query       The address, place or intersection to look up, in UTF-8.
+     @param     address     Receives the address that was found, including its location.
+     @return    Whether or not the query matched a place, a street or an intersection.
+     */
+    bool geocode(const char* query, StreetAddress* address) const;
+
+    /**
+     @brief     Format an address for display (ie. "350 5th Avenue" or "5th Avenue & East 42nd Street"), leaving the number out if it has none.
+     @param     address     The address to format.
+     @param     text        Receives the formatted address. Existing contents are replaced.
+     */
+    static void formatAddress(const StreetAddress& address, std::string* text);
+
+private:
+
+    /**
+     @brief     Look up a normalized street or place name, trying "west" and "east" in front of a street which has neither.
+     @param     key         The normalized name.
+     @param     number      The house number to place along the street, or 0 for none.
+     @param     address     Receives the best match.
+     @return    Whether or not anything matched.
+     */
+    bool findName(const std::string& key, unsigned int number, StreetAddress* address) const;
+
+    /**
+     @brief     Place a house number along a street.
+     @param     street      The street's index.
+     @param     number      The house number, or 0 to use the middle of the street.
+     @param     address     Receives the address.
+     @param     mismatch    Receives how badly the number fits the street: 0 if a range holds it with the right parity, 1 with the wrong parity, or more the further it is outside every range.
+     @return    Whether or not the street has any segments.
+     */
+    bool placeNumber(unsigned int street, unsigned int number, StreetAddress* address, unsigned int* mismatch) const;
+
+    /**
+     @brief     Find where two streets cross, each looked up the same way as findName(...).
+     @param     firstKey    The normalized name of one street.
+     @param     secondKey   The normalized name of the other.
+     @param     address     Receives the intersection.
+     @return    Whether or not the streets cross.
+     */
+    bool findIntersection(const std::string& firstKey, const std::string& secondKey, StreetAddress* address) const;
+
+    /**
+     @brief     Collect the streets a normalized name can refer to.
+     @param     key         The normalized name.
+     @param     streets     Receives the streets' indices. Existing contents are kept.
+     */
+    void findStreets(const std::string& key, std::vector<unsigned int>* streets) const;
+
+    /** The street data to look addresses up in. */
+    const StreetData* m_Data;
+};
+
+#endif // STREET_GEOCODER_H
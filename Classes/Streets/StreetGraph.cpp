@@ -0,0 +1,308 @@
+//
+//  StreetGraph.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "StreetGraph.h"
+#include <algorithm>
+#include <float.h>
+
+using namespace std;
+
+const unsigned int StreetGraph::NO_NODE;
+const float StreetGraph::UNREACHABLE = FLT_MAX;
+
+/**
+ @brief     One end of a segment, while the ends at the same position are being gathered into nodes.
+ */
+struct StreetGraphEnd
+{
+    MapPoint position;
+    unsigned int end;
+};
+
+/**
+ @brief     Orders segment ends by position, so that ends at the same position are next to each other.
+ */
+struct StreetGraphEndOrder
+{
+    bool operator()(const StreetGraphEnd& a, const StreetGraphEnd& b) const
+    {
+        return a.position.x < b.position.x || (a.position.x == b.position.x && a.position.y < b.position.y);
+    }
+};
+
+/**
+ @brief     A node waiting to be searched by Dijkstra's algorithm, and the distance it was queued with.
+ */
+struct StreetGraphQueueEntry
+{
+    float distance;
+    unsigned int node;
+};
+
+/**
+ @brief     Orders the queue so that the nearest node is at the top of the heap.
+ */
+struct StreetGraphQueueOrder
+{
+    bool operator()(const StreetGraphQueueEntry& a, const StreetGraphQueueEntry& b) const
+    {
+        return a.distance > b.distance;
+    }
+};
+
+// Default constructor.
+
+StreetGraph::StreetGraph()
+: m_Data(NULL)
+{
+}
+
+// Build the graph from some street data.
+
+void StreetGraph::build(const StreetData* data, unsigned int anchorCount)
+{
+    clear();
+    m_Data = data;
+
+    // Sort the ends of the segments by position, and give each distinct position a node.
+    unsigned int segmentCount = data->getSegmentCount();
+    vector<StreetGraphEnd> ends(segmentCount * 2);
+    for (unsigned int i = 0; i < segmentCount; i++)
+    {
+        StreetSegment segment = data->getSegment(i);
+        ends[i * 2].position = segment.from;
+        ends[i * 2].end = i * 2;
+        ends[i * 2 + 1].position = segment.to;
+        ends[i * 2 + 1].end = i * 2 + 1;
+    }
+    sort(ends.begin(), ends.end(), StreetGraphEndOrder());
+
+    m_SegmentNodes.resize(segmentCount * 2);
+    for (unsigned int i = 0; i < ends.size(); i++)
+    {
+        if (i == 0 || ends[i].position != ends[i - 1].position)
+        {
+            m_NodePositions.push_back(ends[i].position);
+        }
+        m_SegmentNodes[ends[i].end] = m_NodePositions.size() - 1;
+    }
+
+    // Count the edges leaving each node, then place each segment's two edges in their nodes' rows. Segments which start and end at the same node lead nowhere and are left out.
+    unsigned int nodeCount = m_NodePositions.size();
+    m_EdgeStarts.assign(nodeCount + 1, 0);
+    for (unsigned int i = 0; i < segmentCount; i++)
+    {
+        if (m_SegmentNodes[i * 2] != m_SegmentNodes[i * 2 + 1])
+        {
+            m_EdgeStarts[m_SegmentNodes[i * 2] + 1]++;
+            m_EdgeStarts[m_SegmentNodes[i * 2 + 1] + 1]++;
+        }
+    }
+    for (unsigned int i = 0; i < nodeCount; i++)
+    {
+        m_EdgeStarts[i + 1] += m_EdgeStarts[i];
+    }
+
+    m_Edges.resize(m_EdgeStarts[nodeCount]);
+    vector<unsigned int> nextEdges(m_EdgeStarts.begin(), m_EdgeStarts.end() - 1);
+    for (unsigned int i = 0; i < segmentCount; i++)
+    {
+        unsigned int from = m_SegmentNodes[i * 2];
+        unsigned int to = m_SegmentNodes[i * 2 + 1];
+        if (from == to)
+        {
+            continue;
+        }
+
+        float length = m_NodePositions[from].distance(m_NodePositions[to]);
+        StreetGraphEdge& forward = m_Edges[nextEdges[from]++];
+        forward.target = to;
+        forward.length = length;
+        forward.segment = i;
+        StreetGraphEdge& backward = m_Edges[nextEdges[to]++];
+        backward.target = from;
+        backward.length = length;
+        backward.segment = i;
+    }
+
+    placeAnchors(anchorCount);
+}
+
+// Empty the graph.
+
+void StreetGraph::clear()
+{
+    m_Data = NULL;
+    m_NodePositions.clear();
+    m_EdgeStarts.assign(1, 0);
+    m_Edges.clear();
+    m_SegmentNodes.clear();
+    m_Anchors.clear();
+    m_AnchorDistances.clear();
+}
+
+// Move a point onto the nearest street and find the corners at either end of its segment.
+
+bool StreetGraph::locate(const MapPoint& point, float maxDistance, StreetGraphLocation* location) const
+{
+    float fraction;
+    if (!m_Data || !m_Data->findNearestSegment(point, maxDistance, &location->segment, &fraction, NULL))
+    {
+        return false;
+    }
+
+    location->nodes[0] = getSegmentFromNode(location->segment);
+    location->nodes[1] = getSegmentToNode(location->segment);
+    const MapPoint& from = m_NodePositions[location->nodes[0]];
+    const MapPoint& to = m_NodePositions[location->nodes[1]];
+    location->position = from + (to - from) * fraction;
+    location->offsets[0] = from.distance(location->position);
+    location->offsets[1] = to.distance(location->position);
+    return true;
+}
+
+// Find the walking distance to every node from one or more starting nodes, by Dijkstra's algorithm.
+
+void StreetGraph::findDistances(const unsigned int* nodes, const float* offsets, unsigned int count, vector<float>* distances) const
+{
+    findDistances(nodes, offsets, count, NULL, 0, distances);
+}
+
+// Find the walking distances to some target nodes from one or more starting nodes, stopping once all of them have been reached.
+
+void StreetGraph::findDistances(const unsigned int* nodes, const float* offsets, unsigned int count, const unsigned int* targets, unsigned int targetCount, vector<float>* distances) const
+{
+    distances->assign(m_NodePositions.size(), UNREACHABLE);
+
+    // Each target is ticked off the first time it comes out of the queue, which is when its distance is final. The same node may be given as a target more than once.
+    vector<unsigned char> isTarget;
+    unsigned int remainingTargets = 0;
+    if (targetCount > 0)
+    {
+        isTarget.assign(m_NodePositions.size(), 0);
+        for (unsigned int i = 0; i < targetCount; i++)
+        {
+            if (!isTarget[targets[i]])
+            {
+                isTarget[targets[i]] = 1;
+                remainingTargets++;
+            }
+        }
+    }
+
+    // Nodes are queued again rather than having their place in the queue updated, and the stale entries are skipped when they come out.
+    vector<StreetGraphQueueEntry> queue;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (offsets[i] < (*distances)[nodes[i]])
+        {
+            (*distances)[nodes[i]] = offsets[i];
+            StreetGraphQueueEntry entry = { offsets[i], nodes[i] };
+            queue.push_back(entry);
+            push_heap(queue.begin(), queue.end(), StreetGraphQueueOrder());
+        }
+    }
+
+    while (!queue.empty())
+    {
+        StreetGraphQueueEntry entry = queue.front();
+        pop_heap(queue.begin(), queue.end(), StreetGraphQueueOrder());
+        queue.pop_back();
+        if (entry.distance > (*distances)[entry.node])
+        {
+            continue;
+        }
+
+        if (remainingTargets > 0 && isTarget[entry.node])
+        {
+            isTarget[entry.node] = 0;
+            if (--remainingTargets == 0)
+            {
+                break;
+            }
+        }
+
+        for (unsigned int i = m_EdgeStarts[entry.node]; i < m_EdgeStarts[entry.node + 1]; i++)
+        {
+            const StreetGraphEdge& edge = m_Edges[i];
+            float distance = entry.distance + edge.length;
+            if (distance < (*distances)[edge.target])
+            {
+                (*distances)[edge.target] = distance;
+                StreetGraphQueueEntry next = { distance, edge.target };
+                queue.push_back(next);
+                push_heap(queue.begin(), queue.end(), StreetGraphQueueOrder());
+            }
+        }
+    }
+}
+
+// Pick anchors spread as far from each other as possible, and keep their distances to every node.
+
+void StreetGraph::placeAnchors(unsigned int anchorCount)
+{
+    unsigned int nodeCount = m_NodePositions.size();
+    if (nodeCount == 0 || anchorCount == 0)
+    {
+        return;
+    }
+
+    // Start from whichever node is furthest from an arbitrary one, which puts the first anchor on the edge of the city. Each anchor after that is the node furthest from all of those before it, so the anchors end up around the edge where their bounds are tightest. Nodes which can't be reached from the first node are never picked, so the anchors all lie in the same part of the graph (which is all of it for a city whose streets are connected).
+    vector<float> distances;
+    unsigned int start = 0;
+    float offset = 0;
+    findDistances(&start, &offset, 1, &distances);
+
+    unsigned int anchor = start;
+    for (unsigned int i = 0; i < nodeCount; i++)
+    {
+        if (distances[i] != UNREACHABLE && distances[i] > distances[anchor])
+        {
+            anchor = i;
+        }
+    }
+
+    vector<float> nearestAnchors(distances.size(), UNREACHABLE);
+    vector<float> anchorDistances;
+    anchorDistances.reserve(anchorCount * nodeCount);
+    while (m_Anchors.size() < anchorCount)
+    {
+        findDistances(&anchor, &offset, 1, &distances);
+        m_Anchors.push_back(anchor);
+        anchorDistances.insert(anchorDistances.end(), distances.begin(), distances.end());
+
+        unsigned int next = anchor;
+        nearestAnchors[anchor] = 0;
+        for (unsigned int i = 0; i < nodeCount; i++)
+        {
+            nearestAnchors[i] = min(nearestAnchors[i], distances[i]);
+            if (distances[i] != UNREACHABLE && nearestAnchors[i] > nearestAnchors[next])
+            {
+                next = i;
+            }
+        }
+
+        // Once every node is an anchor there is nowhere left to put another.
+        if (next == anchor)
+        {
+            break;
+        }
+        anchor = next;
+    }
+
+    // Turn the distances from anchor by anchor to node by node.
+    unsigned int placedCount = m_Anchors.size();
+    m_AnchorDistances.resize(anchorDistances.size());
+    for (unsigned int i = 0; i < placedCount; i++)
+    {
+        for (unsigned int node = 0; node < nodeCount; node++)
+        {
+            m_AnchorDistances[node * placedCount + i] = anchorDistances[i * nodeCount + node];
+        }
+    }
+}
@@ -0,0 +1,191 @@
+//
+//  StreetGraph.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef STREET_GRAPH_H
+#define STREET_GRAPH_H
+
+#include <vector>
+#include "StreetData.h"
+
+/**
+ @brief     A road between two corners of a StreetGraph, which can be walked in either direction.
+ */
+struct StreetGraphEdge
+{
+    /** The corner at the far end of the edge. */
+    unsigned int target;
+
+    /** The length of the edge in metres. */
+    float length;
+
+    /** The index of the StreetData segment the edge runs along. */
+    unsigned int segment;
+};
+
+/**
+ @brief     A point moved onto the nearest street of a StreetGraph, and the corners at either end of the segment it landed on.
+ */
+struct StreetGraphLocation
+{
+    /** The point on the street, in metres east and north of the street data's origin. */
+    MapPoint position;
+
+    /** The segment the point is on. */
+    unsigned int segment;
+
+    /** The nodes at the segment's "from" and "to" ends, and how far each one is from the point along the segment in metres. */
+    unsigned int nodes[2];
+    float offsets[2];
+};
+
+/**
+ @brief     The streets of a StreetData as a graph for finding walking routes, with the corners where segments meet as its nodes and the segments as its edges.
+
+ The graph is laid out as compressed rows: the edges leaving each node are stored next to each other, node by node, so that finding a node's neighbours is a single range of one array. Each segment gives an edge in both directions, since every street can be walked both ways. Segments whose ends are at exactly the same position share a node, which is how StreetDataBuilder expects streets that cross to be written.
+
+ The graph can also be given anchors, which are nodes spread around the edge of the city whose walking distances to every other node are worked out when it is built (they are called landmarks in the literature on A* search, but that would be confused with the map's landmarks). Since walking distances obey the triangle inequality, the difference between two nodes' distances from any anchor is a lower bound on the distance between them, which is usually much closer to the real distance than a straight line and so lets StreetRouter search far fewer nodes. Each anchor adds 4 bytes per node.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class StreetGraph
+{
+public:
+
+    /** The value of an unknown node, edge or segment, and the distance to a node which can't be reached. */
+    static const unsigned int NO_NODE = 0xFFFFFFFF;
+    static const float UNREACHABLE;
+
+    /**
+     @brief     Default constructor. The graph is empty until it is built.
+     */
+    StreetGraph();
+
+    /**
+     @brief     Build the graph from some street data, replacing any graph which was already built.
+     @param     data            The street data, which must stay open for as long as the graph is used.
+     @param     anchorCount     The number of anchors to place, or 0 for none. Each one takes a search over the whole graph to place.
+     */
+    void build(const StreetData* data, unsigned int anchorCount);
+
+    /**
+     @brief     Empty the graph.
+     */
+    void clear();
+
+    /**
+     @brief     Get the street data the graph was built from, or NULL if it hasn't been built.
+     */
+    const StreetData* getData() const { return m_Data; }
+
+    /**
+     @brief     Get the number of nodes.
+     */
+    unsigned int getNodeCount() const { return m_NodePositions.size(); }
+
+    /**
+     @brief     Get the position of a node in metres east and north of the street data's origin.
+     */
+    const MapPoint& getNodePosition(unsigned int node) const { return m_NodePositions[node]; }
+
+    /**
+     @brief     Get the edges leaving a node.
+     @param     node    The node's index.
+     @param     first   Receives the index of the node's first edge.
+     @return    The number of edges leaving the node.
+     */
+    unsigned int getEdges(unsigned int node, unsigned int* first) const
+    {
+        *first = m_EdgeStarts[node];
+        return m_EdgeStarts[node + 1] - m_EdgeStarts[node];
+    }
+
+    /**
+     @brief     Get an edge.
+     */
+    const StreetGraphEdge& getEdge(unsigned int edge) const { return m_Edges[edge]; }
+
+    /**
+     @brief     Get the node at the "from" end of a segment.
+     */
+    unsigned int getSegmentFromNode(unsigned int segment) const { return m_SegmentNodes[segment * 2]; }
+
+    /**
+     @brief     Get the node at the "to" end of a segment.
+     */
+    unsigned int getSegmentToNode(unsigned int segment) const { return m_SegmentNodes[segment * 2 + 1]; }
+
+    /**
+     @brief     Get the number of anchors.
+     */
+    unsigned int getAnchorCount() const { return m_Anchors.size(); }
+
+    /**
+     @brief     Get an anchor's walking distance to a node.
+     @param     anchor  The anchor's index, from 0 to getAnchorCount().
+     @param     node    The node's index.
+     @return    The distance in metres, or UNREACHABLE if the node can't be reached from the anchor.
+     */
+    float getAnchorDistance(unsigned int anchor, unsigned int node) const { return m_AnchorDistances[node * m_Anchors.size() + anchor]; }
+
+    /**
+     @brief     Move a point onto the nearest street and find the corners at either end of its segment.
+     @param     point       The point, in metres east and north of the street data's origin.
+     @param     maxDistance How far from a street in metres the point can be.
+     @param     location    Receives the point on the street.
+     @return    Whether or not there is a street within the distance.
+     */
+    bool locate(const MapPoint& point, float maxDistance, StreetGraphLocation* location) const;
+
+    /**
+     @brief     Find the walking distance to every node from one or more starting nodes, by Dijkstra's algorithm.
+     @param     nodes       The starting nodes.
+     @param     offsets     How far each starting node is from the true start in metres (ie. from a point partway along a segment).
+     @param     count       The number of starting nodes.
+     @param     distances   Receives the distance to each node, or UNREACHABLE for those which can't be reached.
+     */
+    void findDistances(const unsigned int* nodes, const float* offsets, unsigned int count, std::vector<float>* distances) const;
+
+    /**
+     @brief     Find the walking distances to some target nodes from one or more starting nodes, stopping as soon as all of the targets have been reached by their shortest routes. This is much quicker than searching the whole graph when the targets are all near the start.
+     @param     nodes       The starting nodes.
+     @param     offsets     How far each starting node is from the true start in metres.
+     @param     count       The number of starting nodes.
+     @param     targets     The target nodes.
+     @param     targetCount The number of target nodes, or 0 to search the whole graph.
+     @param     distances   Receives the distance to each target, or UNREACHABLE for those which can't be reached. The distances to other nodes may be left longer than they really are.
+     */
+    void findDistances(const unsigned int* nodes, const float* offsets, unsigned int count, const unsigned int* targets, unsigned int targetCount, std::vector<float>* distances) const;
+
+private:
+
+    /**
+     @brief     Pick anchors spread as far from each other as possible, each one being the node furthest from those picked before it, and keep their distances to every node.
+     */
+    void placeAnchors(unsigned int anchorCount);
+
+    /** The street data the graph was built from. */
+    const StreetData* m_Data;
+
+    /** The position of each node. */
+    std::vector<MapPoint> m_NodePositions;
+
+    /** The index of each node's first edge, with one more at the end. */
+    std::vector<unsigned int> m_EdgeStarts;
+
+    /** The edges, grouped by the node they leave. */
+    std::vector<StreetGraphEdge> m_Edges;
+
+    /** The nodes at the "from" and "to" ends of each segment. */
+    std::vector<unsigned int> m_SegmentNodes;
+
+    /** The anchors' nodes, and their distances to every node. The distances are stored node by node, so that a search finds all of a node's distances together. */
+    std::vector<unsigned int> m_Anchors;
+    std::vector<float> m_AnchorDistances;
+};
+
+#endif // STREET_GRAPH_H
@@ -0,0 +1,270 @@
+//
+//  StreetRouter.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "StreetRouter.h"
+#include <algorithm>
+
+using namespace std;
+
+const float StreetRouter::MAX_SNAP_DISTANCE = 250;
+
+// Create a router for a street graph.
+
+StreetRouter::StreetRouter(const StreetGraph* graph)
+: m_Graph(graph)
+, m_Stamp(0)
+, m_BestLength(StreetGraph::UNREACHABLE)
+, m_MeetingNode(StreetGraph::NO_NODE)
+, m_VisitedCount(0)
+{
+}
+
+// Find the shortest walking route between two points.
+
+bool StreetRouter::findRoute(const MapPoint& from, const MapPoint& to, StreetRoute* route)
+{
+    *route = StreetRoute();
+
+    StreetGraphLocation ends[kDirectionCount];
+    if (!m_Graph->locate(from, MAX_SNAP_DISTANCE, &ends[kDirectionForward]) || !m_Graph->locate(to, MAX_SNAP_DISTANCE, &ends[kDirectionBackward]))
+    {
+        return false;
+    }
+
+    startSearch();
+
+    // The anchors' distances to each end are through whichever corner of its segment is nearer to them.
+    unsigned int anchorCount = m_Graph->getAnchorCount();
+    for (int direction = 0; direction < kDirectionCount; direction++)
+    {
+        const StreetGraphLocation& end = ends[direction];
+        m_Ends[direction] = end.position;
+        m_EndAnchors[direction].assign(anchorCount, StreetGraph::UNREACHABLE);
+        for (unsigned int i = 0; i < anchorCount; i++)
+        {
+            for (int corner = 0; corner < 2; corner++)
+            {
+                float distance = m_Graph->getAnchorDistance(i, end.nodes[corner]);
+                if (distance != StreetGraph::UNREACHABLE)
+                {
+                    m_EndAnchors[direction][i] = min(m_EndAnchors[direction][i], distance + end.offsets[corner]);
+                }
+            }
+        }
+    }
+
+    // If both ends are on the same segment, walking straight along it is the shortest route unless a detour around the block is shorter, which the search will find.
+    if (ends[kDirectionForward].segment == ends[kDirectionBackward].segment)
+    {
+        m_BestLength = ends[kDirectionForward].position.distance(ends[kDirectionBackward].position);
+    }
+
+    for (int direction = 0; direction < kDirectionCount; direction++)
+    {
+        for (int corner = 0; corner < 2; corner++)
+        {
+            reachNode((Direction)direction, ends[direction].nodes[corner], StreetGraph::NO_NODE, ends[direction].offsets[corner]);
+        }
+    }
+
+    // Take turns searching from each end. No route through a node which is still queued can be shorter than the sum of the smallest keys left in the two queues, so once the best route found is that short it is the shortest.
+    Direction direction = kDirectionForward;
+    while (true)
+    {
+        float forwardKey = getNextKey(kDirectionForward);
+        float backwardKey = getNextKey(kDirectionBackward);
+        if (forwardKey == StreetGraph::UNREACHABLE || backwardKey == StreetGraph::UNREACHABLE || forwardKey + backwardKey >= m_BestLength)
+        {
+            break;
+        }
+
+        visitNextNode(direction);
+        direction = (direction == kDirectionForward) ? kDirectionBackward : kDirectionForward;
+    }
+
+    if (m_BestLength == StreetGraph::UNREACHABLE)
+    {
+        return false;
+    }
+
+    buildRoute(ends[kDirectionForward], ends[kDirectionBackward], route);
+    route->length = m_BestLength;
+    route->searchedNodes = m_VisitedCount;
+    return true;
+}
+
+// Size the per-node state for the graph and move on to a new search stamp.
+
+void StreetRouter::startSearch()
+{
+    unsigned int nodeCount = m_Graph->getNodeCount();
+    m_Stamp++;
+
+    // If the graph has changed size, or the stamps have run all the way around, start the state afresh.
+    if (m_PotentialStamps.size() != nodeCount || m_Stamp == 0)
+    {
+        for (int direction = 0; direction < kDirectionCount; direction++)
+        {
+            NodeState state = { StreetGraph::UNREACHABLE, StreetGraph::NO_NODE, 0, 0 };
+            m_Searches[direction].nodes.assign(nodeCount, state);
+        }
+        m_Potentials.assign(nodeCount, 0);
+        m_PotentialStamps.assign(nodeCount, 0);
+        m_Stamp = 1;
+    }
+
+    for (int direction = 0; direction < kDirectionCount; direction++)
+    {
+        m_Searches[direction].queue.clear();
+    }
+    m_BestLength = StreetGraph::UNREACHABLE;
+    m_MeetingNode = StreetGraph::NO_NODE;
+    m_VisitedCount = 0;
+}
+
+// Get a lower bound on the walking distance from a node to one end of the route.
+
+float StreetRouter::getLowerBound(unsigned int node, const MapPoint& end, const float* endAnchors) const
+{
+    float bound = m_Graph->getNodePosition(node).distance(end);
+
+    // Walking from an anchor to the end can't be shorter than walking from the anchor to the node and on to the end, nor the other way around.
+    unsigned int anchorCount = m_Graph->getAnchorCount();
+    for (unsigned int i = 0; i < anchorCount; i++)
+    {
+        float nodeDistance = m_Graph->getAnchorDistance(i, node);
+        if (nodeDistance != StreetGraph::UNREACHABLE && endAnchors[i] != StreetGraph::UNREACHABLE)
+        {
+            bound = max(bound, fabsf(endAnchors[i] - nodeDistance));
+        }
+    }
+
+    return bound;
+}
+
+// Get how much closer a node is estimated to be to the end of the route than to its start, halved.
+
+float StreetRouter::getPotential(unsigned int node)
+{
+    if (m_PotentialStamps[node] != m_Stamp)
+    {
+        const float* noAnchors = NULL;
+        float toEnd = getLowerBound(node, m_Ends[kDirectionBackward], m_EndAnchors[kDirectionBackward].empty() ? noAnchors : &m_EndAnchors[kDirectionBackward][0]);
+        float toStart = getLowerBound(node, m_Ends[kDirectionForward], m_EndAnchors[kDirectionForward].empty() ? noAnchors : &m_EndAnchors[kDirectionForward][0]);
+        m_Potentials[node] = (toEnd - toStart) / 2;
+        m_PotentialStamps[node] = m_Stamp;
+    }
+
+    return m_Potentials[node];
+}
+
+// Reach a node from one direction, queueing it if this is the shortest way to it found so far.
+
+void StreetRouter::reachNode(Direction direction, unsigned int node, unsigned int previous, float distance)
+{
+    Search& search = m_Searches[direction];
+    NodeState& state = search.nodes[node];
+    if (state.reached == m_Stamp && distance >= state.distance)
+    {
+        return;
+    }
+
+    state.distance = distance;
+    state.previous = previous;
+    state.reached = m_Stamp;
+
+    QueueEntry entry;
+    entry.key = (direction == kDirectionForward) ? distance + getPotential(node) : distance - getPotential(node);
+    entry.node = node;
+    search.queue.push_back(entry);
+    push_heap(search.queue.begin(), search.queue.end(), QueueOrder());
+
+    // If the other search has reached the node too, there is a route through it.
+    const NodeState& other = m_Searches[1 - direction].nodes[node];
+    if (other.reached == m_Stamp && distance + other.distance < m_BestLength)
+    {
+        m_BestLength = distance + other.distance;
+        m_MeetingNode = node;
+    }
+}
+
+// Visit the node at the top of one direction's queue, reaching its neighbours.
+
+void StreetRouter::visitNextNode(Direction direction)
+{
+    Search& search = m_Searches[direction];
+    unsigned int node = search.queue.front().node;
+    pop_heap(search.queue.begin(), search.queue.end(), QueueOrder());
+    search.queue.pop_back();
+    search.nodes[node].visited = m_Stamp;
+    m_VisitedCount++;
+
+    // The graph is undirected, so both searches follow the same edges.
+    unsigned int first;
+    unsigned int count = m_Graph->getEdges(node, &first);
+    float distance = search.nodes[node].distance;
+    for (unsigned int i = first; i < first + count; i++)
+    {
+        const StreetGraphEdge& edge = m_Graph->getEdge(i);
+        if (search.nodes[edge.target].visited != m_Stamp)
+        {
+            reachNode(direction, edge.target, node, distance + edge.length);
+        }
+    }
+}
+
+// Get the key of the entry at the top of a queue, skipping any stale entries.
+
+float StreetRouter::getNextKey(Direction direction)
+{
+    Search& search = m_Searches[direction];
+    while (!search.queue.empty())
+    {
+        const QueueEntry& entry = search.queue.front();
+        if (search.nodes[entry.node].visited != m_Stamp)
+        {
+            return entry.key;
+        }
+
+        pop_heap(search.queue.begin(), search.queue.end(), QueueOrder());
+        search.queue.pop_back();
+    }
+
+    return StreetGraph::UNREACHABLE;
+}
+
+// Trace the route found back from the node where the two searches met.
+
+void StreetRouter::buildRoute(const StreetGraphLocation& from, const StreetGraphLocation& to, StreetRoute* route) const
+{
+    vector<MapPoint>& points = route->points;
+    points.push_back(from.position);
+
+    if (m_MeetingNode != StreetGraph::NO_NODE)
+    {
+        // The forward search's chain runs from the meeting node back to the start, so it is reversed into place.
+        const Search& forward = m_Searches[kDirectionForward];
+        unsigned int firstCorner = points.size();
+        for (unsigned int node = m_MeetingNode; node != StreetGraph::NO_NODE; node = forward.nodes[node].previous)
+        {
+            points.push_back(m_Graph->getNodePosition(node));
+        }
+        reverse(points.begin() + firstCorner, points.end());
+
+        const Search& backward = m_Searches[kDirectionBackward];
+        for (unsigned int node = backward.nodes[m_MeetingNode].previous; node != StreetGraph::NO_NODE; node = backward.nodes[node].previous)
+        {
+            points.push_back(m_Graph->getNodePosition(node));
+        }
+    }
+
+    points.push_back(to.position);
+
+    // An end which lies on a corner would otherwise appear twice.
+    points.erase(unique(points.begin(), points.end()), points.end());
+}
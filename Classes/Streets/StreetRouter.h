@@ -0,0 +1,180 @@
+//
+//  StreetRouter.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef STREET_ROUTER_H
+#define STREET_ROUTER_H
+
+#include <vector>
+#include "StreetGraph.h"
+
+/**
+ @brief     A walking route, as found by a StreetRouter.
+ */
+struct StreetRoute
+{
+    StreetRoute() : length(0), searchedNodes(0) { }
+
+    /** The corners the route turns at, in metres east and north of the street data's origin, from the point on the street nearest the start to the point nearest the end. */
+    std::vector<MapPoint> points;
+
+    /** The length of the route in metres, not counting the walk to and from the street at either end. */
+    float length;
+
+    /** The number of nodes the search had to visit to find the route, which shows how well its bounds worked. */
+    unsigned int searchedNodes;
+};
+
+/**
+ @brief     Finds the shortest walking routes through a StreetGraph, quickly enough to answer a query across the city in a millisecond or so.
+
+ Each end of a route is first moved to the nearest point on a street, and the search starts from the corners at either end of that segment with the walk along it already counted. The route is then found by A* search from both ends at once, which meet in the middle. Both searches are guided by the same estimate of how much closer each node is to the end than to the start, which is half the difference between lower bounds on its distance to each of them; this keeps the two searches consistent with each other, so they can stop as soon as the best route found through any node they have both reached is no longer than any route through the nodes still waiting in their queues. The lower bounds are the straight-line distance, or the bound given by the graph's anchors if that is larger.
+
+ The per-node state is kept between searches and stamped with the search it belongs to, so starting a search doesn't have to clear it. A router is therefore not safe to share between threads, but it makes no allocations once it has been used.
+
+ This class has no dependencies on cocos2d so that it can be built and tested on its own.
+ */
+class StreetRouter
+{
+public:
+
+    /** How far from a street in metres either end of a route can be. */
+    static const float MAX_SNAP_DISTANCE;
+
+    /**
+     @brief     Create a router for a street graph.
+     @param     graph   The graph to find routes through, which must outlive the router.
+     */
+    explicit StreetRouter(const StreetGraph* graph);
+
+    /**
+     @brief     Find the shortest walking route between two points.
+     @param     from    Where the route starts, in metres east and north of the street data's origin.
+     @param     to      Where the route ends.
+     @param     route   Receives the route.
+     @return    Whether or not there is a route. There isn't if either point is further than MAX_SNAP_DISTANCE from a street, or if the streets nearest them aren't connected.
+     */
+    bool findRoute(const MapPoint& from, const MapPoint& to, StreetRoute* route);
+
+private:
+
+    /**
+     @brief     Which of the two searches something belongs to.
+     */
+    enum Direction
+    {
+        kDirectionForward = 0,
+        kDirectionBackward,
+        kDirectionCount
+    };
+
+    /**
+     @brief     A node waiting to be visited, and the key it was queued with.
+     */
+    struct QueueEntry
+    {
+        float key;
+        unsigned int node;
+    };
+
+    /**
+     @brief     Orders a queue so that the entry with the smallest key is at the top of the heap.
+     */
+    struct QueueOrder
+    {
+        bool operator()(const QueueEntry& a, const QueueEntry& b) const { return a.key > b.key; }
+    };
+
+    /**
+     @brief     What one search knows about a node. Its distance and the node before it are only valid if it was reached in the current search.
+     */
+    struct NodeState
+    {
+        /** The node's distance from this search's end, and the node before it on the way there. */
+        float distance;
+        unsigned int previous;
+
+        /** The search in which the node was last reached and last visited. */
+        unsigned int reached;
+        unsigned int visited;
+    };
+
+    /**
+     @brief     The state of the search from one end of the route.
+     */
+    struct Search
+    {
+        /** What the search knows about each node, kept together so that reaching a node touches as little memory as possible. */
+        std::vector<NodeState> nodes;
+
+        /** The nodes waiting to be visited. Nodes are queued again when a shorter way to them is found, and the stale entries are skipped when they come out. */
+        std::vector<QueueEntry> queue;
+    };
+
+    /**
+     @brief     Size the per-node state for the graph and move on to a new search stamp.
+     */
+    void startSearch();
+
+    /**
+     @brief     Get a lower bound on the walking distance from a node to one end of the route.
+     @param     node            The node.
+     @param     end             The end's position.
+     @param     endAnchors      The anchors' distances to the end.
+     */
+    float getLowerBound(unsigned int node, const MapPoint& end, const float* endAnchors) const;
+
+    /**
+     @brief     Get how much closer a node is estimated to be to the end of the route than to its start, halved. The forward search adds this to its keys, and the backward search subtracts it.
+     */
+    float getPotential(unsigned int node);
+
+    /**
+     @brief     Reach a node from one direction, queueing it if this is the shortest way to it found so far, and check whether it gives a shorter route through the node.
+     */
+    void reachNode(Direction direction, unsigned int node, unsigned int previous, float distance);
+
+    /**
+     @brief     Visit the node at the top of one direction's queue, reaching its neighbours.
+     */
+    void visitNextNode(Direction direction);
+
+    /**
+     @brief     Get the key of the entry at the top of a queue, skipping any stale entries.
+     @return    The key, or StreetGraph::UNREACHABLE if the queue is empty.
+     */
+    float getNextKey(Direction direction);
+
+    /**
+     @brief     Trace the route found back from the node where the two searches met.
+     */
+    void buildRoute(const StreetGraphLocation& from, const StreetGraphLocation& to, StreetRoute* route) const;
+
+    /** The graph the routes are found through. */
+    const StreetGraph* m_Graph;
+
+    /** The two searches, and the stamp of the current one. */
+    Search m_Searches[kDirectionCount];
+    unsigned int m_Stamp;
+
+    /** The potential of each node, valid for nodes whose stamp is the current search's. */
+    std::vector<float> m_Potentials;
+    std::vector<unsigned int> m_PotentialStamps;
+
+    /** The positions of the route's ends on the street, and the anchors' distances to them. */
+    MapPoint m_Ends[kDirectionCount];
+    std::vector<float> m_EndAnchors[kDirectionCount];
+
+    /** The length of the shortest route found so far, and the node it passes through, or StreetGraph::NO_NODE if it runs straight along one segment. */
+    float m_BestLength;
+    unsigned int m_MeetingNode;
+
+    /** The number of nodes visited by the current search. */
+    unsigned int m_VisitedCount;
+};
+
+#endif // STREET_ROUTER_H
@@ -0,0 +1,280 @@
+//
+//  TourPlanner.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "TourPlanner.h"
+#include <algorithm>
+#include <sys/time.h>
+
+using namespace std;
+
+// How much shorter in metres a move has to make a tour to be applied. The changes are added up in double precision, so rounding can't make two moves undo each other forever.
+static const double MIN_IMPROVEMENT = 0.01;
+
+// The longest run of stops that Or-opt moves.
+static const unsigned int MAX_OR_OPT_LENGTH = 3;
+
+// How many times in a row shaking up the best tour can fail to find a shorter one, per stop, before the planner gives up even if it has time left.
+static const unsigned int MAX_FAILED_KICKS_PER_STOP = 2;
+
+// Create a planner for the stops in a distance matrix.
+
+TourPlanner::TourPlanner(const StreetDistanceMatrix* matrix, unsigned int seed)
+: m_Matrix(matrix)
+, m_RandomState(seed)
+, m_StopCount(0)
+{
+}
+
+// Plan a tour.
+
+bool TourPlanner::planTour(const vector<unsigned int>& stops, bool isLoop, double timeBudget, TourPlan* plan)
+{
+    *plan = TourPlan();
+    unsigned int count = stops.size();
+    if (count == 0)
+    {
+        return false;
+    }
+
+    // Copy out the distances between the stops. An open tour gets an extra stop at the end which is no distance from any other, so that it can finish anywhere.
+    m_StopCount = isLoop ? count : count + 1;
+    m_Distances.assign(m_StopCount * m_StopCount, 0);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        for (unsigned int j = 0; j < count; j++)
+        {
+            float distance = m_Matrix->getDistance(stops[i], stops[j]);
+            if (distance == StreetGraph::UNREACHABLE)
+            {
+                return false;
+            }
+            m_Distances[i * m_StopCount + j] = distance;
+        }
+    }
+
+    // The tour is kept with the stop it ends at on the end, which is the first stop again for a loop, so that every stop in between has a stop on either side of it. Only those in between are moved.
+    vector<unsigned int> tour;
+    buildNearestNeighbourTour(count, &tour);
+    tour.push_back(isLoop ? 0 : count);
+    plan->improvements = improveTour(&tour);
+    float length = getLength(tour);
+
+    // Shake up the best tour and improve it again for as long as there is time, keeping whatever is shorter. Tours of fewer than three stops in between are already as short as they can be.
+    double deadline = getCurrentTime() + timeBudget;
+    unsigned int failedKicks = 0;
+    vector<unsigned int> candidate;
+    while (count >= 4 && failedKicks < MAX_FAILED_KICKS_PER_STOP * count && getCurrentTime() < deadline)
+    {
+        candidate = tour;
+        applyDoubleBridge(&candidate);
+        unsigned int improvements = improveTour(&candidate);
+        float candidateLength = getLength(candidate);
+        plan->kicks++;
+
+        if (candidateLength < length - MIN_IMPROVEMENT)
+        {
+            tour.swap(candidate);
+            length = candidateLength;
+            plan->improvements += improvements;
+            failedKicks = 0;
+        }
+        else
+        {
+            failedKicks++;
+        }
+    }
+
+    tour.pop_back();
+    plan->order.swap(tour);
+    plan->length = length;
+    return true;
+}
+
+// Get the length of a tour.
+
+float TourPlanner::getLength(const vector<unsigned int>& tour) const
+{
+    double length = 0;
+    for (unsigned int i = 0; i + 1 < tour.size(); i++)
+    {
+        length += getDistance(tour[i], tour[i + 1]);
+    }
+    return length;
+}
+
+// Visit the nearest stop not yet visited each time, starting from the first stop.
+
+void TourPlanner::buildNearestNeighbourTour(unsigned int count, vector<unsigned int>* tour) const
+{
+    vector<unsigned char> visited(count, 0);
+    tour->assign(1, 0);
+    visited[0] = 1;
+
+    while (tour->size() < count)
+    {
+        unsigned int current = tour->back();
+        unsigned int nearest = 0;
+        float nearestDistance = StreetGraph::UNREACHABLE;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (!visited[i] && getDistance(current, i) < nearestDistance)
+            {
+                nearest = i;
+                nearestDistance = getDistance(current, i);
+            }
+        }
+
+        tour->push_back(nearest);
+        visited[nearest] = 1;
+    }
+}
+
+// Apply 2-opt and Or-opt moves until neither shortens the tour any further.
+
+unsigned int TourPlanner::improveTour(vector<unsigned int>* tour) const
+{
+    // 2-opt moves are cheaper to look for, so Or-opt is only tried once they have run out.
+    unsigned int moves = 0;
+    while (true)
+    {
+        if (applyTwoOptMove(tour) || applyOrOptMove(tour))
+        {
+            moves++;
+        }
+        else
+        {
+            return moves;
+        }
+    }
+}
+
+// Apply the first 2-opt move which shortens the tour.
+
+bool TourPlanner::applyTwoOptMove(vector<unsigned int>* tour) const
+{
+    // Reversing the stops from first to last swaps the legs either side of them for legs joining their outer ends to the opposite ends of the run.
+    vector<unsigned int>& stops = *tour;
+    unsigned int lastMovable = stops.size() - 2;
+    for (unsigned int first = 1; first < lastMovable; first++)
+    {
+        unsigned int before = stops[first - 1];
+        double removedFirst = getDistance(before, stops[first]);
+        for (unsigned int last = first + 1; last <= lastMovable; last++)
+        {
+            unsigned int after = stops[last + 1];
+            double change = (double)getDistance(before, stops[last]) + getDistance(stops[first], after) - removedFirst - getDistance(stops[last], after);
+            if (change < -MIN_IMPROVEMENT)
+            {
+                reverse(stops.begin() + first, stops.begin() + last + 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Apply the first Or-opt move which shortens the tour.
+
+bool TourPlanner::applyOrOptMove(vector<unsigned int>* tour) const
+{
+    vector<unsigned int>& stops = *tour;
+    unsigned int lastMovable = stops.size() - 2;
+    for (unsigned int length = 1; length <= MAX_OR_OPT_LENGTH; length++)
+    {
+        for (unsigned int first = 1; first + length - 1 <= lastMovable; first++)
+        {
+            // Taking the run out joins the stops either side of it.
+            unsigned int last = first + length - 1;
+            unsigned int before = stops[first - 1];
+            unsigned int after = stops[last + 1];
+            double saving = (double)getDistance(before, stops[first]) + getDistance(stops[last], after) - getDistance(before, after);
+            if (saving <= MIN_IMPROVEMENT)
+            {
+                continue;
+            }
+
+            // Put it back between any other pair of neighbouring stops, either way around.
+            for (unsigned int gap = 0; gap + 1 < stops.size(); gap++)
+            {
+                if (gap + 1 >= first && gap <= last)
+                {
+                    continue;
+                }
+
+                unsigned int left = stops[gap];
+                unsigned int right = stops[gap + 1];
+                double joined = getDistance(left, right);
+                double forward = (double)getDistance(left, stops[first]) + getDistance(stops[last], right) - joined;
+                double reversed = (double)getDistance(left, stops[last]) + getDistance(stops[first], right) - joined;
+                double cost = min(forward, reversed);
+                if (cost - saving < -MIN_IMPROVEMENT)
+                {
+                    vector<unsigned int> run(stops.begin() + first, stops.begin() + last + 1);
+                    if (reversed < forward)
+                    {
+                        reverse(run.begin(), run.end());
+                    }
+
+                    stops.erase(stops.begin() + first, stops.begin() + last + 1);
+                    unsigned int insertAt = (gap < first) ? gap + 1 : gap + 1 - length;
+                    stops.insert(stops.begin() + insertAt, run.begin(), run.end());
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+// Cut the tour into four parts at random and swap the middle two.
+
+void TourPlanner::applyDoubleBridge(vector<unsigned int>* tour)
+{
+    // Pick three different cuts among the stops in between, which split them into runs A, B, C and D (A and D may be empty), and walk them as A, C, B, D.
+    vector<unsigned int>& stops = *tour;
+    unsigned int endIndex = stops.size() - 1;
+    unsigned int cuts[3];
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        bool isRepeated = true;
+        while (isRepeated)
+        {
+            cuts[i] = 1 + getRandom(endIndex);
+            isRepeated = false;
+            for (unsigned int j = 0; j < i; j++)
+            {
+                isRepeated = isRepeated || cuts[j] == cuts[i];
+            }
+        }
+    }
+    sort(cuts, cuts + 3);
+
+    vector<unsigned int> runB(stops.begin() + cuts[0], stops.begin() + cuts[1]);
+    vector<unsigned int> runC(stops.begin() + cuts[1], stops.begin() + cuts[2]);
+    copy(runC.begin(), runC.end(), stops.begin() + cuts[0]);
+    copy(runB.begin(), runB.end(), stops.begin() + cuts[0] + runC.size());
+}
+
+// Get a random number from 0 to count - 1.
+
+unsigned int TourPlanner::getRandom(unsigned int count)
+{
+    m_RandomState = m_RandomState * 1664525u + 1013904223u;
+    return (unsigned int)(((unsigned long long)(m_RandomState >> 8) * count) >> 24);
+}
+
+// Get the current time in seconds.
+
+double TourPlanner::getCurrentTime()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
+}
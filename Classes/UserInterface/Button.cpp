@@ -7,6 +7,7 @@
 //
 
 #include "Button.h"
+#include "AssetResolver.h"
 
 using namespace cocos2d;
 
@@ -37,10 +38,18 @@ Button* Button::create(const char* imageFilename, cocos2d::CCCallFunc* callbackO
 bool Button::init(const char* imageFilename, const char* pressedImageFilename,
           cocos2d::CCCallFunc* callbackOnPress, cocos2d::CCCallFunc* callbackOnRelease)
 {
-    // Attempt to load the indicated textures.
-    CCTextureCache* cache = CCTextureCache::sharedTextureCache();
-    m_NormalTexture = cache->addImage(imageFilename);
-    m_PressedTexture = cache->addImage(pressedImageFilename);
+    // Attempt to load the variants of the indicated textures best suited to this device.
+    float pressedAssetScale;
+    m_NormalTexture = AssetResolver::addImage(imageFilename, &m_AssetScale);
+    m_PressedTexture = AssetResolver::addImage(pressedImageFilename, &pressedAssetScale);
+    
+    // Both states share the same geometry, so both textures must come from the same variant.
+    if (m_PressedTexture && pressedAssetScale != m_AssetScale)
+    {
+        m_PressedTexture = CCTextureCache::sharedTextureCache()->addImage(pressedImageFilename);
+        m_NormalTexture = CCTextureCache::sharedTextureCache()->addImage(imageFilename);
+        m_AssetScale = 1.0f;
+    }
     
     // If either of the texture failed to load, or if the normal texture can't be used, initialization has failed.
     if (!m_NormalTexture ||
@@ -50,10 +59,7 @@ bool Button::init(const char* imageFilename, const char* pressedImageFilename,
         return false;
     }
     
-    // As initialization has now succeeded, register this Button with the touch dispatcher.
-    CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(this, 0, false);
-    
-    // And finally, register the indicated callbacks.
+    // As initialization has now succeeded, register the indicated callbacks.
     m_CallbackOnPress = callbackOnPress;
     m_CallbackOnRelease = callbackOnRelease;
     
@@ -71,9 +77,6 @@ bool Button::init(const char* imageFilename, const char* pressedImageFilename,
 
 void Button::onExit()
 {
-    // Unregister this Button from the touch dispatcher.
-    CCDirector::sharedDirector()->getTouchDispatcher()->removeDelegate(this);
-    
     // Allow the callbacks to be taken by cocos2d's garbage collector.
     if (m_CallbackOnPress)   m_CallbackOnPress->autorelease();
     if (m_CallbackOnRelease) m_CallbackOnRelease->autorelease();
@@ -193,6 +196,13 @@ void Button::onTouchEnded()
     setTexture(m_NormalTexture);
 }
 
+// Get the scale of the loaded texture variant relative to the full-resolution image.
+
+float Button::getAssetScale()
+{
+    return m_AssetScale;
+}
+
 // Checks whether or not the button is currently pressed.
  
 bool Button::isPressed()
@@ -13,7 +13,7 @@
 #include "HidingSprite.h"
 
 /**
- @brief    A sprite node which will execute specified callbacks when touched and released.
+ @brief    A sprite node which will execute specified callbacks when touched and released. Buttons don't register for touches themselves; whatever holds them (ie. a Popup or the Map's LandmarkLayer) passes touches on to them through the TouchRouter.
  */
 class Button : public HidingSprite, public cocos2d::CCTouchDelegate
 {
@@ -68,6 +68,12 @@ public:
      */
     void ccTouchCancelled(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
     
+    /**
+     @brief     Get the scale of the loaded texture variant relative to the full-resolution image. Divide the Button's intended scale by this value to keep its original size on screen.
+     @return    The asset scale (1 for the full-resolution image).
+     */
+    float getAssetScale();
+    
     /**
      @brief     Checks whether or not the button is currently pressed.
      */
@@ -130,6 +136,9 @@ private:
     /** The texture to display in the button's normal state. */
     cocos2d::CCTexture2D* m_PressedTexture;
     
+    /** The scale of the loaded texture variant relative to the full-resolution image. */
+    float m_AssetScale;
+    
     /** The callbacks which should be executed when the button is pressed and released, respectively. */
     cocos2d::CCCallFunc* m_CallbackOnPress;
     cocos2d::CCCallFunc* m_CallbackOnRelease;
@@ -0,0 +1,122 @@
+//
+//  ButtonBar.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#include "ButtonBar.h"
+#include "TouchRouter.h"
+
+using namespace cocos2d;
+
+// Create a ButtonBar and make it the handler of the user interface layer.
+
+ButtonBar* ButtonBar::create()
+{
+    ButtonBar *bar = new ButtonBar();
+    if (bar && bar->init())
+    {
+        bar->autorelease();
+        return bar;
+    }
+    CC_SAFE_DELETE(bar);
+    return NULL;
+}
+
+// Initialize this ButtonBar and make it the handler of the user interface layer.
+
+bool ButtonBar::init()
+{
+    if (!CCNode::init())
+    {
+        return false;
+    }
+
+    m_PressedButton = NULL;
+    m_PressedTouch = NULL;
+
+    // Touches which land on a button are kept from the landmarks and the map below.
+    TouchRouter::sharedRouter()->setHandler(kTouchLayerUserInterface, this, true);
+
+    return true;
+}
+
+// Called when this is removed from the node tree.
+
+void ButtonBar::onExit()
+{
+    // Unregister this bar from the touch router.
+    TouchRouter::sharedRouter()->removeHandler(this);
+
+    // Pass the onExit() call along to the base class.
+    CCNode::onExit();
+}
+
+// Add a button to the bar.
+
+void ButtonBar::addButton(Button* button)
+{
+    addChild(button);
+    m_Buttons.push_back(button);
+}
+
+// Pass a new touch on to the button under it, if any.
+
+bool ButtonBar::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton)
+    {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_Buttons.size(); i++)
+    {
+        if (m_Buttons[i]->isVisible() && m_Buttons[i]->ccTouchBegan(pTouch, pEvent))
+        {
+            m_PressedButton = m_Buttons[i];
+            m_PressedTouch = pTouch;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Pass the user's continued touch input on to the pressed button.
+
+void ButtonBar::ccTouchMoved(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton && pTouch == m_PressedTouch)
+    {
+        m_PressedButton->ccTouchMoved(pTouch, pEvent);
+    }
+}
+
+// Pass the end of a touch on to the pressed button.
+
+void ButtonBar::ccTouchEnded(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton && pTouch == m_PressedTouch)
+    {
+        // Clear the pressed button first, since its callback may open a popup.
+        Button* button = m_PressedButton;
+        m_PressedButton = NULL;
+        m_PressedTouch = NULL;
+        button->ccTouchEnded(pTouch, pEvent);
+    }
+}
+
+// Pass the loss of a touch on to the pressed button.
+
+void ButtonBar::ccTouchCancelled(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton && pTouch == m_PressedTouch)
+    {
+        Button* button = m_PressedButton;
+        m_PressedButton = NULL;
+        m_PressedTouch = NULL;
+        button->ccTouchCancelled(pTouch, pEvent);
+    }
+}
@@ -0,0 +1,89 @@
+//
+//  ButtonBar.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//
+
+#ifndef BUTTON_BAR_H
+#define BUTTON_BAR_H
+
+#include "cocos2d.h"
+#include <vector>
+#include "Button.h"
+
+/**
+ @brief     A node holding the buttons displayed over the map, which handles the user interface layer of the TouchRouter on their behalf.
+
+ The TouchRouter only has one handler per layer, so the buttons can't each be a handler of their own. Instead, a new touch is offered to each button in turn, and the bar only claims the touch if a button accepts it, so touches between the buttons still reach the landmarks and the map.
+ */
+class ButtonBar : public cocos2d::CCNode, public cocos2d::CCTouchDelegate
+{
+public:
+
+    /**
+     @brief     Create a ButtonBar and make it the handler of the user interface layer.
+     @return    A pointer to the newly created ButtonBar.
+     */
+    static ButtonBar* create();
+
+    /**
+     @brief     Add a button to the bar. The button keeps its own position.
+     @param     button      The button to add.
+     */
+    void addButton(Button* button);
+
+    /**
+     @brief     Pass a new touch on to the button under it, if any. Only one button can be pressed at a time.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     @return    Whether or not a button accepted the touch.
+     */
+    bool ccTouchBegan(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Pass the user's continued touch input on to the pressed button.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchMoved(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Pass the end of a touch on to the pressed button.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchEnded(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Pass the loss of a touch on to the pressed button.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchCancelled(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+protected:
+
+    /**
+     @brief     Initialize this ButtonBar and make it the handler of the user interface layer.
+     @return    Whether or not the initialization was successful.
+     */
+    bool init();
+
+    /**
+     @brief     Called when this is removed from the node tree.
+     */
+    virtual void onExit();
+
+private:
+
+    /** The buttons in the bar. */
+    std::vector<Button*> m_Buttons;
+
+    /** The button currently being pressed and the touch pressing it. */
+    Button* m_PressedButton;
+    cocos2d::CCTouch* m_PressedTouch;
+};
+
+#endif // BUTTON_BAR_H
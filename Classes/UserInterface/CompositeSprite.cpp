@@ -7,6 +7,9 @@
 //
 
 #include "CompositeSprite.h"
+#include "AssetResolver.h"
+#include "Defines.h"
+#include "ImageDecoder.h"
 
 using namespace std;
 using namespace cocos2d;
@@ -32,6 +35,9 @@ bool CompositeSprite::init(const char *fileName, const char* fileExtension, unsi
     // Find a group of image files beginning in [fileName] and ending in [fileExtension] with grid position indicated between (ie. "imageName3x2.png") and load each of them in as HidingSprites, adding them as children in a grid.
     CCLOG("*** Creating a CompositeSprite using files beginning with \"%s\" and ending with \"%s\".", fileName, fileExtension);
     
+    // Start counting decodes and allocations so that the cost of loading the grid can be reported at the end.
+    ImageDecoder::resetStats();
+    
     // Set all of the data that will be needed to load.
     m_LoadingData.fileName = fileName;
     m_LoadingData.fileExtension = fileExtension;
@@ -88,8 +94,10 @@ void CompositeSprite::loadNextPiece()
     
     fullFileName += string(m_LoadingData.fileExtension);
     
-    // Attempt to load a file with the specified name.
-    HidingSprite* sprite = HidingSprite::create(fullFileName.c_str());
+    // Attempt to load the variant of the file best suited to this device, decoding it straight into the upload buffer.
+    float assetScale;
+    CCTexture2D* texture = AssetResolver::createTexture(fullFileName.c_str(), &assetScale);
+    HidingSprite* sprite = texture ? HidingSprite::createWithTexture(texture) : NULL;
     
     if (sprite)
     {
@@ -98,22 +106,26 @@ void CompositeSprite::loadNextPiece()
         addChild(sprite);
         m_LoadingData.spriteGrid[m_LoadingData.colomn].push_back(sprite);
         
+        // Scale reduced variants back up so that the CompositeSprite's geometry matches the full-resolution images.
+        sprite->setScale(1.0f / assetScale);
+        CCSize spriteSize = getScaledSize(sprite);
+        
         // Place the newly added sprite in its correct position.
-        sprite->setPosition(ccp(sprite->getContentSize().width/2, sprite->getContentSize().height/2));
+        sprite->setPosition(ccp(spriteSize.width/2, spriteSize.height/2));
         for (int i = 0; i < m_LoadingData.colomn; i++)
         {
             // Add to the image's X position
-            sprite->setPositionX(sprite->getPositionX() + m_LoadingData.spriteGrid[i][m_LoadingData.row]->getContentSize().width);
+            sprite->setPositionX(sprite->getPositionX() + getScaledSize(m_LoadingData.spriteGrid[i][m_LoadingData.row]).width);
         }
         for (int i = 0; i < m_LoadingData.row; i++)
         {
             // Add to the image's Y position
-            sprite->setPositionY(sprite->getPositionY() + m_LoadingData.spriteGrid[m_LoadingData.colomn][i]->getContentSize().height);
+            sprite->setPositionY(sprite->getPositionY() + getScaledSize(m_LoadingData.spriteGrid[m_LoadingData.colomn][i]).height);
         }
         
         // Update the CompositeSprite's content size.
-        setContentSize(CCSizeMake(MAX(getContentSize().width, sprite->getPositionX() + sprite->getContentSize().width/2),
-                                  MAX(getContentSize().height, sprite->getPositionY() + sprite->getContentSize().height/2)));
+        setContentSize(CCSizeMake(MAX(getContentSize().width, sprite->getPositionX() + spriteSize.width/2),
+                                  MAX(getContentSize().height, sprite->getPositionY() + spriteSize.height/2)));
     }
     else
     {
@@ -158,6 +170,22 @@ void CompositeSprite::loadNextPiece()
         
         unscheduleUpdate();
         
-        CCLOG("Finished loading CompositeSprite.");
+        // The upload buffer is no longer needed once every piece has been uploaded.
+        ImageDecoder::releaseUploadBuffer();
+        
+        if (DISPLAY_PERFORMANCE_MESSAGES)
+        {
+            const ImageDecoderStats& stats = ImageDecoder::getStats();
+            CCLOG("Finished loading CompositeSprite: %u images decoded, %u format conversions and %u buffer allocations.",
+                  stats.imagesDecoded, stats.conversions, stats.bufferAllocations);
+        }
     }
 }
+
+// Get the size of a child sprite after its scale has been applied.
+
+CCSize CompositeSprite::getScaledSize(CCNode* sprite)
+{
+    return CCSizeMake(sprite->getContentSize().width * sprite->getScaleX(),
+                      sprite->getContentSize().height * sprite->getScaleY());
+}
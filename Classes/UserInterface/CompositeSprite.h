@@ -87,6 +87,13 @@ protected:
      */
     void loadNextPiece();
     
+    /**
+     @brief     Get the size of a child sprite after its scale has been applied.
+     @param     sprite      The child sprite to be measured.
+     @return    The sprite's size in the CompositeSprite's coordinate space.
+     */
+    cocos2d::CCSize getScaledSize(cocos2d::CCNode* sprite);
+    
 private:
     
     /** Information regarding the sprite's loading progress. */
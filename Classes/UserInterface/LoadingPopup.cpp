@@ -100,9 +100,10 @@ void ProgressBar::visit(void)
     
     glEnable(GL_SCISSOR_TEST);
     CCPoint worldPos = convertToWorldSpace(CCPointZero);
+    CCPoint worldMax = convertToWorldSpace(ccp(getContentSize().width, getContentSize().height));
     CCEGLView::sharedOpenGLView()->setScissorInPoints(worldPos.x, worldPos.y,
-                                                      getContentSize().width * m_Progress,
-                                                      getContentSize().height);
+                                                      (worldMax.x - worldPos.x) * m_Progress,
+                                                      worldMax.y - worldPos.y);
     CCNode::visit();
     glDisable(GL_SCISSOR_TEST);
     kmGLPopMatrix();
@@ -8,6 +8,7 @@
 
 #include "Popup.h"
 #include "Defines.h"
+#include "TouchRouter.h"
 
 using namespace cocos2d;
 
@@ -64,8 +65,10 @@ bool Popup::init()
     m_Backdrop->setColor(ccBLACK);
     m_Backdrop->setOpacity(225);
     
-    // Register this popup with the touch dispatcher so that it can block input to elements behind it.
-    CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(this, 0, true);
+    // Become the popup layer of the touch router so that this popup can block input to elements behind it.
+    TouchRouter::sharedRouter()->setHandler(kTouchLayerPopup, this, true);
+    m_PressedButton = NULL;
+    m_PressedTouch = NULL;
     
     // If there is an existing popup already, remove it in favor of this one.
     if (m_CurrentPopup)
@@ -81,8 +84,8 @@ bool Popup::init()
 
 void Popup::onExit()
 {
-    // Unregister this Button from the touch dispatcher.
-    CCDirector::sharedDirector()->getTouchDispatcher()->removeDelegate(this);
+    // Unregister this popup from the touch router.
+    TouchRouter::sharedRouter()->removeHandler(this);
     
     // Clear the static handle to the current popup.
     if (m_CurrentPopup == this)
@@ -94,6 +97,60 @@ void Popup::onExit()
     CCNode::onExit();
 }
 
+// Respond to the beginning of a user's touch by passing it on to the button under it, if any.
+
+bool Popup::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
+{
+    // Only one button can be pressed at a time.
+    if (!m_PressedButton)
+    {
+        for (int i = 0; i < m_Buttons.size(); i++)
+        {
+            if (m_Buttons[i]->ccTouchBegan(pTouch, pEvent))
+            {
+                m_PressedButton = m_Buttons[i];
+                m_PressedTouch = pTouch;
+                break;
+            }
+        }
+    }
+    
+    // Always claim the touch so that elements behind the popup don't receive it.
+    return true;
+}
+
+// Pass the user's continued touch input on to the pressed button.
+
+void Popup::ccTouchMoved(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton && pTouch == m_PressedTouch)
+    {
+        m_PressedButton->ccTouchMoved(pTouch, pEvent);
+    }
+}
+
+// Pass the end of a touch on to the pressed button.
+
+void Popup::ccTouchEnded(CCTouch *pTouch, CCEvent *pEvent)
+{
+    if (m_PressedButton && pTouch == m_PressedTouch)
+    {
+        // Clear the pressed button first, since its callback may close or replace this popup.
+        Button* button = m_PressedButton;
+        m_PressedButton = NULL;
+        m_PressedTouch = NULL;
+        button->ccTouchEnded(pTouch, pEvent);
+    }
+}
+
+// Pass the loss of a touch on to the pressed button.
+
+void Popup::ccTouchCancelled(CCTouch *pTouch, CCEvent *pEvent)
+{
+    // Lost touches should be handled the same as other ended touches.
+    ccTouchEnded(pTouch, pEvent);
+}
+
 // Add a node to the popup. The node will be positioned automatically.
 
 void Popup::addContent(cocos2d::CCNode* content)
@@ -109,9 +166,10 @@ void Popup::addButton(const char* text, cocos2d::CCCallFunc* callback, cocos2d::
 {
     Button* button = Button::create("buttonNormal.png", "buttonPressed.png", NULL, callback);
     button->setColor(colour);
-    button->setScale(SCREEN_SCALE);
+    button->setScale(SCREEN_SCALE / button->getAssetScale());
     
     CCLabelTTF* label = CCLabelTTF::create(text, "Montserrat", 100);
+    label->setScale(button->getAssetScale());
     button->addChild(label);
     label->setPosition(ccp(button->getContentSize().width/2, button->getContentSize().height/2));
     
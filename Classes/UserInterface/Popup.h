@@ -36,12 +36,33 @@ public:
     void addButton(const char* text, cocos2d::CCCallFunc* callback, cocos2d::ccColor3B colour);
     
     /**
-     @brief     Respond to the beginning of a user's touch. Will always return true in order to claim the touch and block input to other elements behind it.
+     @brief     Respond to the beginning of a user's touch by passing it on to the button under it, if any. Will always return true in order to claim the touch and block input to other elements behind it.
      @param     pTouch      A pointer to the touch information.
      @param     pEvent      The event data.
      @return    Whether or not the map  accepted the touch input.
      */
-    bool ccTouchBegan(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent) { return true; }
+    bool ccTouchBegan(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+    
+    /**
+     @brief     Pass the user's continued touch input on to the pressed button.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchMoved(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+    
+    /**
+     @brief     Pass the end of a touch on to the pressed button.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchEnded(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+    
+    /**
+     @brief     Pass the loss of a touch on to the pressed button.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchCancelled(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
     
     /**
      @brief     Execute closing animations and remove the popup from the node tree.
@@ -88,6 +109,10 @@ protected:
     /** A list of all of the popup's butons. */
     std::vector<Button*> m_Buttons;
     
+    /** The button currently being pressed and the touch pressing it. */
+    Button* m_PressedButton;
+    cocos2d::CCTouch* m_PressedTouch;
+    
     /** The node used for the semi-transparent backdrop. */
     cocos2d::CCSprite* m_Backdrop;
     
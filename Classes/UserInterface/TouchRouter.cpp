@@ -0,0 +1,210 @@
+//
+//  TouchRouter.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-26.
+//
+//
+
+#include "TouchRouter.h"
+
+using namespace cocos2d;
+
+TouchRouter* TouchRouter::s_SharedRouter = NULL;
+
+// Get the shared TouchRouter, creating it and registering it with the touch dispatcher the first time.
+
+TouchRouter* TouchRouter::sharedRouter()
+{
+    if (!s_SharedRouter)
+    {
+        s_SharedRouter = new TouchRouter();
+        
+        // This is the only delegate the dispatcher knows about, so it may as well swallow every touch it claims.
+        CCDirector::sharedDirector()->getTouchDispatcher()->addTargetedDelegate(s_SharedRouter, 0, true);
+    }
+    
+    return s_SharedRouter;
+}
+
+// Default constructor.
+
+TouchRouter::TouchRouter()
+{
+    for (int i = 0; i < kTouchLayerCount; i++)
+    {
+        m_Handlers[i] = NULL;
+        m_SwallowsTouches[i] = false;
+    }
+}
+
+// Set the handler for a layer, replacing any previous handler.
+
+void TouchRouter::setHandler(TouchLayer layer, CCTouchDelegate* handler, bool swallowsTouches)
+{
+    if (m_Handlers[layer] && m_Handlers[layer] != handler)
+    {
+        removeHandler(m_Handlers[layer]);
+    }
+    
+    m_Handlers[layer] = handler;
+    m_SwallowsTouches[layer] = swallowsTouches;
+}
+
+// Remove a handler from whichever layer it handles.
+
+void TouchRouter::removeHandler(CCTouchDelegate* handler)
+{
+    if (!handler)
+    {
+        return;
+    }
+    
+    for (int layer = 0; layer < kTouchLayerCount; layer++)
+    {
+        if (m_Handlers[layer] == handler)
+        {
+            m_Handlers[layer] = NULL;
+        }
+        
+        // The handler may be about to be destroyed, so it mustn't receive the rest of any touch it claimed.
+        for (unsigned int i = 0; i < m_Claims.size(); i++)
+        {
+            if (m_Claims[i].handlers[layer] == handler)
+            {
+                m_Claims[i].handlers[layer] = NULL;
+            }
+        }
+    }
+}
+
+// Offer a new touch to each layer in order.
+
+bool TouchRouter::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
+{
+    // Record the claim before offering the touch, so that a handler removed while the touch is being offered is cleared from it.
+    TouchClaim newClaim;
+    newClaim.touch = pTouch;
+    for (int layer = 0; layer < kTouchLayerCount; layer++)
+    {
+        newClaim.handlers[layer] = NULL;
+    }
+    m_Claims.push_back(newClaim);
+    
+    bool claimed = false;
+    for (int layer = 0; layer < kTouchLayerCount; layer++)
+    {
+        CCTouchDelegate* handler = m_Handlers[layer];
+        if (!handler || !handler->ccTouchBegan(pTouch, pEvent))
+        {
+            continue;
+        }
+        
+        // The handler may have changed the claims (ie. by closing a popup), so look this touch's claim up again.
+        int claimIndex = findClaim(pTouch);
+        if (claimIndex >= 0)
+        {
+            m_Claims[claimIndex].handlers[layer] = handler;
+        }
+        claimed = true;
+        
+        if (m_SwallowsTouches[layer])
+        {
+            break;
+        }
+    }
+    
+    if (!claimed)
+    {
+        int claimIndex = findClaim(pTouch);
+        if (claimIndex >= 0)
+        {
+            m_Claims.erase(m_Claims.begin() + claimIndex);
+        }
+    }
+    
+    return claimed;
+}
+
+// Deliver a touch's movement to the handlers which claimed it.
+
+void TouchRouter::ccTouchMoved(CCTouch *pTouch, CCEvent *pEvent)
+{
+    for (int layer = 0; layer < kTouchLayerCount; layer++)
+    {
+        // Look the claim up for each layer, since a handler may remove another handler while it runs.
+        int claimIndex = findClaim(pTouch);
+        if (claimIndex < 0)
+        {
+            return;
+        }
+        
+        CCTouchDelegate* handler = m_Claims[claimIndex].handlers[layer];
+        if (handler)
+        {
+            handler->ccTouchMoved(pTouch, pEvent);
+        }
+    }
+}
+
+// Deliver the end of a touch to the handlers which claimed it.
+
+void TouchRouter::ccTouchEnded(CCTouch *pTouch, CCEvent *pEvent)
+{
+    finishTouch(pTouch, pEvent, kTouchEndingEnded);
+}
+
+// Deliver the loss of a touch to the handlers which claimed it.
+
+void TouchRouter::ccTouchCancelled(CCTouch *pTouch, CCEvent *pEvent)
+{
+    finishTouch(pTouch, pEvent, kTouchEndingCancelled);
+}
+
+// Find the claim for an active touch.
+
+int TouchRouter::findClaim(CCTouch* touch)
+{
+    for (unsigned int i = 0; i < m_Claims.size(); i++)
+    {
+        if (m_Claims[i].touch == touch)
+        {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+// Deliver the end or loss of a touch and forget its claim.
+
+void TouchRouter::finishTouch(CCTouch *pTouch, CCEvent *pEvent, TouchEnding ending)
+{
+    for (int layer = 0; layer < kTouchLayerCount; layer++)
+    {
+        // Look the claim up for each layer, since a handler may remove another handler while it runs (ie. a landmark opening a popup).
+        int claimIndex = findClaim(pTouch);
+        if (claimIndex < 0)
+        {
+            return;
+        }
+        
+        CCTouchDelegate* handler = m_Claims[claimIndex].handlers[layer];
+        m_Claims[claimIndex].handlers[layer] = NULL;
+        
+        if (handler && ending == kTouchEndingEnded)
+        {
+            handler->ccTouchEnded(pTouch, pEvent);
+        }
+        else if (handler)
+        {
+            handler->ccTouchCancelled(pTouch, pEvent);
+        }
+    }
+    
+    int claimIndex = findClaim(pTouch);
+    if (claimIndex >= 0)
+    {
+        m_Claims.erase(m_Claims.begin() + claimIndex);
+    }
+}
@@ -0,0 +1,136 @@
+//
+//  TouchRouter.h
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-26.
+//
+//
+
+#ifndef TOUCH_ROUTER_H
+#define TOUCH_ROUTER_H
+
+#include "cocos2d.h"
+#include <vector>
+
+/**
+ @brief     The layers that touches are offered to, from the first to the last.
+ */
+enum TouchLayer
+{
+    kTouchLayerPopup = 0,
+    kTouchLayerUserInterface,
+    kTouchLayerLandmarks,
+    kTouchLayerMap,
+    kTouchLayerCount
+};
+
+/**
+ @brief     The single delegate registered with cocos2d's touch dispatcher, which passes each touch on to a fixed stack of layers.
+
+ Each layer has at most one handler, which is responsible for finding whatever the touch landed on within that layer (ie. the Map's landmark grid, or a Popup's buttons). A new touch is offered to each layer in order until a handler that swallows touches claims it, and the rest of that touch is only delivered to the handlers which claimed it. The cost of routing a touch therefore depends on the number of layers rather than the number of buttons, and showing or hiding a popup only swaps one handler instead of adding and removing delegates from the dispatcher.
+ */
+class TouchRouter : public cocos2d::CCObject, public cocos2d::CCTouchDelegate
+{
+public:
+
+    /**
+     @brief     Get the shared TouchRouter, creating it and registering it with the touch dispatcher the first time.
+     @return    A pointer to the shared TouchRouter.
+     */
+    static TouchRouter* sharedRouter();
+
+    /**
+     @brief     Set the handler for a layer, replacing any previous handler.
+     @param     layer           The layer to handle.
+     @param     handler         The handler, which is not retained and must remove itself before it is destroyed.
+     @param     swallowsTouches Whether or not touches claimed by the handler are kept from the layers after it.
+     */
+    void setHandler(TouchLayer layer, cocos2d::CCTouchDelegate* handler, bool swallowsTouches);
+
+    /**
+     @brief     Remove a handler from whichever layer it handles. Touches it had already claimed are no longer delivered to it.
+     @param     handler         The handler to remove.
+     */
+    void removeHandler(cocos2d::CCTouchDelegate* handler);
+
+    /**
+     @brief     Offer a new touch to each layer in order.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     @return    Whether or not any layer claimed the touch.
+     */
+    bool ccTouchBegan(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Deliver a touch's movement to the handlers which claimed it.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchMoved(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Deliver the end of a touch to the handlers which claimed it.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchEnded(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+    /**
+     @brief     Deliver the loss of a touch to the handlers which claimed it.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     */
+    void ccTouchCancelled(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent);
+
+private:
+
+    /**
+     @brief     The handlers that claimed an active touch, by layer.
+     */
+    struct TouchClaim
+    {
+        cocos2d::CCTouch* touch;
+        cocos2d::CCTouchDelegate* handlers[kTouchLayerCount];
+    };
+
+    /**
+     @brief     The ways that a touch can finish.
+     */
+    enum TouchEnding
+    {
+        kTouchEndingEnded,
+        kTouchEndingCancelled
+    };
+
+    /**
+     @brief     Default constructor. Declared as private because the router is only accessed through sharedRouter().
+     */
+    TouchRouter();
+
+    /**
+     @brief     Find the claim for an active touch.
+     @param     touch       The touch.
+     @return    The index of the claim, or -1 if the touch wasn't claimed.
+     */
+    int findClaim(cocos2d::CCTouch* touch);
+
+    /**
+     @brief     Deliver the end or loss of a touch and forget its claim.
+     @param     pTouch      A pointer to the touch information.
+     @param     pEvent      The event data.
+     @param     ending      How the touch finished.
+     */
+    void finishTouch(cocos2d::CCTouch *pTouch, cocos2d::CCEvent *pEvent, TouchEnding ending);
+
+    /** The handler of each layer (NULL if none) and whether or not it swallows touches. */
+    cocos2d::CCTouchDelegate* m_Handlers[kTouchLayerCount];
+    bool m_SwallowsTouches[kTouchLayerCount];
+
+    /** The claims for every active touch. */
+    std::vector<TouchClaim> m_Claims;
+
+    /** The shared TouchRouter. */
+    static TouchRouter* s_SharedRouter;
+};
+
+#endif // TOUCH_ROUTER_H
@@ -0,0 +1,407 @@
+//
+//  GestureReplayer.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-28.
+//
+//  A command-line tool which replays gesture recordings (see Classes/Map/GestureRecording.h) through the same MapController
+//  that the Map uses, on a simulated clock, without a device or cocos2d. It reports how long each touch event and each
+//  frame took to process as percentiles, along with the transform the map finished at, so that recordings of reported jank
+//  can be reproduced and kept as regression benchmarks. It also measures how far touch prediction (see
+//  Classes/Map/TouchPredictor.h) puts each touch from where the recording shows it actually was at the display time,
+//  compared with drawing the last reported position.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -o gesture_replayer GestureReplayer.cpp
+//               ../Classes/Map/GestureRecording.cpp ../Classes/Map/MapController.cpp ../Classes/Map/TouchPredictor.cpp
+//
+//  Usage:   gesture_replayer [options] <recording.txt> ...
+//
+//      -f <rate>               The simulated frame rate in frames per second. Defaults to 60.
+//      -r <runs>               The number of times to replay each recording. Defaults to 10.
+//      -l <milliseconds>       How long after a frame is updated it is displayed. Defaults to one frame.
+//      -n                      Replay without touch prediction.
+//      -e <x>,<y>,<scale>      The transform each recording is expected to finish at. The tool fails if it doesn't.
+//
+//  The tool also fails if replaying a recording more than once doesn't finish at exactly the same transform every time, or
+//  if any frame applies the transform more than once (see Tools/MapControllerCheck.cpp, which checks the same with made-up
+//  gestures).
+//
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "GestureRecording.h"
+#include "MapController.h"
+#include "TouchPredictor.h"
+
+using namespace std;
+
+// How long the map is allowed to keep moving after the last event before the replay gives up on it coming to rest.
+static const double MAX_SETTLE_TIME = 10.0;
+
+// How far the finishing transform may be from the expected one before it counts as a failure.
+static const float EXPECTED_OFFSET_TOLERANCE = 0.5f;
+static const float EXPECTED_SCALE_TOLERANCE = 0.001f;
+
+/**
+ @brief     The command-line options.
+ */
+struct ReplayOptions
+{
+    double frameRate;
+    unsigned int runs;
+    double lead;
+    bool predict;
+    bool hasExpected;
+    MapTransform expected;
+};
+
+/**
+ @brief     What one replay of a recording measured.
+ */
+struct ReplayResult
+{
+    /** How long each touch event took to process, in microseconds. */
+    vector<double> eventTimes;
+
+    /** How long each frame took to process, in microseconds. */
+    vector<double> frameTimes;
+
+    /** The transform the map finished at. */
+    MapTransform finalTransform;
+
+    /** The same counts that Map reports, and the most times the transform was applied by one frame. */
+    MapFrameStats frameStats;
+    unsigned int maxUpdatesPerFrame;
+};
+
+/**
+ @brief     The samples of a single touch, from when it began until it ended.
+ */
+struct TouchStroke
+{
+    vector<double> times;
+    vector<MapPoint> locations;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Pass a recorded event on to the controller in the same way Map::ccTouchBegan/Moved/Ended(...) do.
+
+static void dispatchEvent(MapController& controller, const GestureEvent& event)
+{
+    switch (event.kind)
+    {
+        case kGestureEventBegan: controller.touchBegan(event.touchID, event.location, event.time); break;
+        case kGestureEventMoved: controller.touchMoved(event.touchID, event.location, event.time); break;
+        case kGestureEventEnded: controller.touchEnded(event.touchID, event.location, event.time); break;
+    }
+}
+
+// Replay a recording once, interleaving its events with frames at the simulated frame rate in the order the app would see them.
+
+static void replay(const GestureRecording& recording, const ReplayOptions& options, ReplayResult* result)
+{
+    const GestureSetup& setup = recording.getSetup();
+    const vector<GestureEvent>& events = recording.getEvents();
+    double startTime = events.empty() ? 0 : events.front().time;
+    double endTime = events.empty() ? 0 : events.back().time;
+
+    MapController controller;
+    controller.reset(setup.viewSize, setup.contentSize, setup.minScale, setup.maxScale, setup.transform, startTime);
+    controller.setPrediction(options.predict, options.lead);
+    result->finalTransform = setup.transform;
+    result->frameStats = MapFrameStats();
+    result->maxUpdatesPerFrame = 0;
+
+    double frameInterval = 1.0 / options.frameRate;
+    double frameTime = startTime + frameInterval;
+    unsigned int eventIt = 0;
+
+    // Keep drawing frames after the last event for as long as the map coasts or springs back.
+    while (eventIt < events.size() || (controller.isAnimating() && frameTime < endTime + MAX_SETTLE_TIME))
+    {
+        if (eventIt < events.size() && events[eventIt].time <= frameTime)
+        {
+            double before = getMicroseconds();
+            dispatchEvent(controller, events[eventIt]);
+            result->eventTimes.push_back(getMicroseconds() - before);
+            result->frameStats.touchSamples++;
+            eventIt++;
+        }
+        else
+        {
+            // Frames only apply the transform when it has changed, however many events arrived since the last one, as Map::update(...) does.
+            double before = getMicroseconds();
+            unsigned int updates = 0;
+            if (controller.updateFrame(frameTime))
+            {
+                result->finalTransform = controller.getTransform();
+                updates++;
+            }
+            result->frameTimes.push_back(getMicroseconds() - before);
+            result->frameStats.frames++;
+            result->frameStats.transformUpdates += updates;
+            result->maxUpdatesPerFrame = max(result->maxUpdatesPerFrame, updates);
+            frameTime += frameInterval;
+        }
+    }
+
+    if (controller.updateFrame(frameTime))
+    {
+        result->finalTransform = controller.getTransform();
+    }
+}
+
+// Split a recording into the strokes of each touch.
+
+static void getStrokes(const GestureRecording& recording, vector<TouchStroke>* strokes)
+{
+    const vector<GestureEvent>& events = recording.getEvents();
+    map<int, size_t> activeStrokes;
+
+    for (unsigned int i = 0; i < events.size(); i++)
+    {
+        const GestureEvent& event = events[i];
+        if (event.kind == kGestureEventBegan)
+        {
+            activeStrokes[event.touchID] = strokes->size();
+            strokes->push_back(TouchStroke());
+        }
+
+        map<int, size_t>::iterator stroke = activeStrokes.find(event.touchID);
+        if (stroke == activeStrokes.end())
+        {
+            continue;
+        }
+
+        (*strokes)[stroke->second].times.push_back(event.time);
+        (*strokes)[stroke->second].locations.push_back(event.location);
+
+        if (event.kind == kGestureEventEnded)
+        {
+            activeStrokes.erase(stroke);
+        }
+    }
+}
+
+// Find where a stroke was at a point in time by interpolating between its samples.
+
+static MapPoint getStrokeLocation(const TouchStroke& stroke, double time)
+{
+    size_t next = upper_bound(stroke.times.begin(), stroke.times.end(), time) - stroke.times.begin();
+    if (next == 0) return stroke.locations.front();
+    if (next == stroke.times.size()) return stroke.locations.back();
+
+    double interval = stroke.times[next] - stroke.times[next - 1];
+    float fraction = (interval > 0) ? (float)((time - stroke.times[next - 1]) / interval) : 1;
+    return stroke.locations[next - 1] + (stroke.locations[next] - stroke.locations[next - 1]) * fraction;
+}
+
+// Measure how far each touch is drawn from where it actually is when the frame is displayed, with and without prediction.
+
+static void measurePrediction(const GestureRecording& recording, double lead, vector<double>* predictedErrors, vector<double>* reportedErrors)
+{
+    vector<TouchStroke> strokes;
+    getStrokes(recording, &strokes);
+
+    for (unsigned int strokeIt = 0; strokeIt < strokes.size(); strokeIt++)
+    {
+        const TouchStroke& stroke = strokes[strokeIt];
+        TouchPredictor predictor;
+
+        for (unsigned int i = 0; i < stroke.times.size(); i++)
+        {
+            if (i == 0) predictor.reset(stroke.locations[i], stroke.times[i]);
+            else predictor.addSample(stroke.locations[i], stroke.times[i]);
+
+            // Only frames displayed while the touch was still down have a known position to compare with.
+            double displayTime = stroke.times[i] + lead;
+            if (displayTime > stroke.times.back())
+            {
+                break;
+            }
+
+            MapPoint actual = getStrokeLocation(stroke, displayTime);
+            predictedErrors->push_back(predictor.predict(displayTime).distance(actual));
+            reportedErrors->push_back(stroke.locations[i].distance(actual));
+        }
+    }
+}
+
+// Get a percentile of a sorted list of times using the nearest rank.
+
+static double getPercentile(const vector<double>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)ceil(percentile / 100.0 * sortedTimes.size());
+    return sortedTimes[min(max(rank, (size_t)1), sortedTimes.size()) - 1];
+}
+
+// Print the percentiles of a list of times.
+
+static void printPercentiles(const char* label, vector<double>& times)
+{
+    sort(times.begin(), times.end());
+    printf("  %-20s p50 %8.2f   p90 %8.2f   p99 %8.2f   max %8.2f\n", label,
+           getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 99), getPercentile(times, 100));
+}
+
+// Replay a recording as many times as requested and report on it.
+
+static bool reportRecording(const char* path, const ReplayOptions& options)
+{
+    GestureRecording recording;
+    if (!recording.load(path))
+    {
+        fprintf(stderr, "Failed to read a gesture recording from \"%s\".\n", path);
+        return false;
+    }
+
+    ReplayResult combined;
+    combined.maxUpdatesPerFrame = 0;
+    bool deterministic = true;
+    unsigned int framesPerRun = 0;
+
+    for (unsigned int run = 0; run < options.runs; run++)
+    {
+        ReplayResult result;
+        replay(recording, options, &result);
+
+        // The simulation only depends on the timestamps, so every run has to finish in exactly the same place.
+        if (run > 0 && (result.finalTransform.offset != combined.finalTransform.offset ||
+                        result.finalTransform.scale != combined.finalTransform.scale))
+        {
+            deterministic = false;
+        }
+
+        combined.finalTransform = result.finalTransform;
+        combined.eventTimes.insert(combined.eventTimes.end(), result.eventTimes.begin(), result.eventTimes.end());
+        combined.frameTimes.insert(combined.frameTimes.end(), result.frameTimes.begin(), result.frameTimes.end());
+        framesPerRun = result.frameTimes.size();
+        combined.frameStats = result.frameStats;
+        combined.maxUpdatesPerFrame = max(combined.maxUpdatesPerFrame, result.maxUpdatesPerFrame);
+    }
+
+    const MapTransform& finalTransform = combined.finalTransform;
+    printf("%s: %u events, %u frames at %g Hz, %u runs, prediction %s\n", path, (unsigned int)recording.getEvents().size(), framesPerRun,
+           options.frameRate, options.runs, options.predict ? "on" : "off");
+    printPercentiles("event time (us):", combined.eventTimes);
+    printPercentiles("frame time (us):", combined.frameTimes);
+    vector<double> predictedErrors;
+    vector<double> reportedErrors;
+    measurePrediction(recording, options.lead, &predictedErrors, &reportedErrors);
+    printPercentiles("predicted error:", predictedErrors);
+    printPercentiles("unpredicted error:", reportedErrors);
+
+    printf("  final transform:     offset %.3f,%.3f   scale %.6f\n", finalTransform.offset.x, finalTransform.offset.y, finalTransform.scale);
+    printf("  frame work:          %u touch samples applied by %u transform updates over %u frames\n",
+           combined.frameStats.touchSamples, combined.frameStats.transformUpdates, combined.frameStats.frames);
+
+    bool passed = true;
+
+    if (!deterministic)
+    {
+        printf("  FAILED: the runs did not all finish at the same transform.\n");
+        passed = false;
+    }
+
+    if (combined.maxUpdatesPerFrame > 1)
+    {
+        printf("  FAILED: a frame applied the transform %u times.\n", combined.maxUpdatesPerFrame);
+        passed = false;
+    }
+
+    if (options.hasExpected &&
+        (fabsf(finalTransform.offset.x - options.expected.offset.x) > EXPECTED_OFFSET_TOLERANCE ||
+         fabsf(finalTransform.offset.y - options.expected.offset.y) > EXPECTED_OFFSET_TOLERANCE ||
+         fabsf(finalTransform.scale - options.expected.scale) > EXPECTED_SCALE_TOLERANCE))
+    {
+        printf("  FAILED: expected offset %.3f,%.3f   scale %.6f\n", options.expected.offset.x, options.expected.offset.y, options.expected.scale);
+        passed = false;
+    }
+
+    return passed;
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-f frame rate] [-r runs] [-l lead ms] [-n] [-e x,y,scale] <recording.txt> ...\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    ReplayOptions options;
+    options.frameRate = 60;
+    options.runs = 10;
+    options.lead = -1;
+    options.predict = true;
+    options.hasExpected = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "f:r:l:ne:")) != -1)
+    {
+        switch (option)
+        {
+            case 'f':
+                options.frameRate = atof(optarg);
+                if (options.frameRate <= 0) printUsage(argv[0]);
+                break;
+            case 'r':
+                options.runs = (unsigned int)atoi(optarg);
+                if (options.runs == 0) printUsage(argv[0]);
+                break;
+            case 'l':
+                options.lead = atof(optarg) / 1000;
+                if (options.lead < 0) printUsage(argv[0]);
+                break;
+            case 'n':
+                options.predict = false;
+                break;
+            case 'e':
+                if (sscanf(optarg, "%f,%f,%f", &options.expected.offset.x, &options.expected.offset.y, &options.expected.scale) != 3) printUsage(argv[0]);
+                options.hasExpected = true;
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    if (optind >= argc)
+    {
+        printUsage(argv[0]);
+    }
+
+    // Frames are displayed one frame after they are updated unless told otherwise.
+    if (options.lead < 0)
+    {
+        options.lead = 1 / options.frameRate;
+    }
+
+    bool passed = true;
+    for (int i = optind; i < argc; i++)
+    {
+        passed = reportRecording(argv[i], options) && passed;
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,461 @@
+//
+//  LandmarkBenchmark.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-03.
+//
+//  A command-line tool which measures how the landmark display scales with the size of the catalog, without a device or
+//  cocos2d. It scatters a synthetic set of landmarks over the map, times building their clusters (the work done at
+//  startup), then flies a simulated camera over the map while zooming in and out, doing per frame what LandmarkLayer
+//  does: placing the markers again when needed and binding pooled buttons to the landmarks that come into view. It
+//  reports the frame times as percentiles, along with how many buttons and cluster markers the pools had to create,
+//  which is what bounds the number of nodes (and the memory they use) as the catalog grows.
+//
+//  Each landmark is also given categories, indexed in cluster order as LandmarkLayer does. The tool times changing the
+//  category filter to every combination of categories, then flies the camera again with a filter on, counting each
+//  cluster's matching landmarks when the markers are placed.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Landmarks -o landmark_benchmark LandmarkBenchmark.cpp
+//               ../Classes/Landmarks/LandmarkClusterIndex.cpp ../Classes/Landmarks/LandmarkGrid.cpp
+//               ../Classes/Landmarks/LandmarkBitset.cpp ../Classes/Landmarks/LandmarkCategoryIndex.cpp
+//
+//  Usage:   landmark_benchmark [options]
+//
+//      -n <count>              The number of landmarks. Defaults to 100000.
+//      -f <frames>             The number of frames to fly the camera for, at 60 frames per second. Defaults to 3600.
+//      -m <width>,<height>     The size of the map. Defaults to the size of the New York map.
+//      -v <width>,<height>     The size of the view. Defaults to an iPad Retina screen in portrait.
+//      -s <seed>               The seed for scattering the landmarks. Defaults to 1.
+//      -c <categories>         The LandmarkCategory flags to filter by on the second flight. Defaults to 3 (museums
+//                              and parks).
+//
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "LandmarkCategoryIndex.h"
+#include "LandmarkClusterIndex.h"
+
+using namespace std;
+
+// The same limits Map uses, given the width the app's screen scale is measured against.
+static const float REFERENCE_VIEW_WIDTH = 1536;
+static const float MAX_SCALE_FACTOR = 2.5f;
+static const float MIN_SCALE_FACTOR = 2;
+
+// The on-screen width of a LandmarkButton, at a screen scale of 1.
+static const float BUTTON_WIDTH = 225;
+
+// How much of the map beyond each edge of the view has markers placed, as in LandmarkLayer.
+static const float REFRESH_MARGIN = 0.5f;
+
+// How many landmarks are scattered around a few busy spots rather than evenly, and how many of those spots there are.
+static const float CLUSTERED_FRACTION = 0.7f;
+static const unsigned int HOT_SPOT_COUNT = 12;
+
+// How likely a landmark is to be in each category, in the order of the LandmarkCategory flags, and how likely it is to be in a second one too.
+static const float CATEGORY_WEIGHTS[LANDMARK_CATEGORY_COUNT] = { 0.05f, 0.1f, 0.15f, 0.3f, 0.1f, 0.3f };
+static const float SECOND_CATEGORY_CHANCE = 0.2f;
+
+/**
+ @brief     The command-line options.
+ */
+struct BenchmarkOptions
+{
+    unsigned int landmarkCount;
+    unsigned int frames;
+    MapPoint mapSize;
+    MapPoint viewSize;
+    unsigned int seed;
+    unsigned int categories;
+};
+
+/**
+ @brief     What flying the camera over the map measured.
+ */
+struct FlightResult
+{
+    /** How long each frame took, in microseconds. */
+    vector<double> frameTimes;
+
+    /** The number of frames which had to place the markers again. */
+    unsigned int refreshes;
+
+    /** The number of times a pooled button was bound to a different landmark. */
+    unsigned int rebinds;
+
+    /** The most buttons and cluster markers displayed at once, and how many of each the pools created. */
+    unsigned int maxDisplayedButtons;
+    unsigned int maxDisplayedMarkers;
+    unsigned int buttonsCreated;
+    unsigned int markersCreated;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the landmarks are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Scatter landmarks over the map, mostly around a few busy spots in the way real points of interest gather.
+
+static void scatterLandmarks(const BenchmarkOptions& options, vector<MapPoint>* positions)
+{
+    unsigned int state = options.seed;
+
+    vector<MapPoint> hotSpots(HOT_SPOT_COUNT);
+    for (unsigned int i = 0; i < HOT_SPOT_COUNT; i++)
+    {
+        hotSpots[i] = MapPoint(getRandom(&state) * options.mapSize.x, getRandom(&state) * options.mapSize.y);
+    }
+
+    positions->resize(options.landmarkCount);
+    for (unsigned int i = 0; i < options.landmarkCount; i++)
+    {
+        MapPoint position;
+        if (getRandom(&state) < CLUSTERED_FRACTION)
+        {
+            // A normal distribution around the spot, made with the Box-Muller transform.
+            float radius = sqrtf(-2 * logf(max(getRandom(&state), 1e-6f))) * options.mapSize.x * 0.03f;
+            float angle = getRandom(&state) * 6.2831853f;
+            position = hotSpots[i % HOT_SPOT_COUNT] + MapPoint(cosf(angle), sinf(angle)) * radius;
+        }
+        else
+        {
+            position = MapPoint(getRandom(&state) * options.mapSize.x, getRandom(&state) * options.mapSize.y);
+        }
+
+        (*positions)[i] = MapPoint(min(max(position.x, 0.0f), options.mapSize.x), min(max(position.y, 0.0f), options.mapSize.y));
+    }
+}
+
+// Pick a category at random, with the chances in CATEGORY_WEIGHTS.
+
+static unsigned int pickCategory(unsigned int* state)
+{
+    float pick = getRandom(state);
+    for (unsigned int i = 0; i < LANDMARK_CATEGORY_COUNT - 1; i++)
+    {
+        if (pick < CATEGORY_WEIGHTS[i])
+        {
+            return 1 << i;
+        }
+        pick -= CATEGORY_WEIGHTS[i];
+    }
+    return 1 << (LANDMARK_CATEGORY_COUNT - 1);
+}
+
+// Give each landmark a category, and some of them a second one.
+
+static void assignCategories(const BenchmarkOptions& options, vector<unsigned int>* categories)
+{
+    unsigned int state = options.seed * 7919u + 1;
+    categories->resize(options.landmarkCount);
+    for (unsigned int i = 0; i < options.landmarkCount; i++)
+    {
+        (*categories)[i] = pickCategory(&state);
+        if (getRandom(&state) < SECOND_CATEGORY_CHANCE)
+        {
+            (*categories)[i] |= pickCategory(&state);
+        }
+    }
+}
+
+// Fly the camera over the map, doing the same work per frame as LandmarkLayer, and measure it. Only the landmarks in the filter are displayed, if there is one.
+
+static void fly(const LandmarkClusterIndex& index, const BenchmarkOptions& options, float minScale, float maxScale, const LandmarkBitset* filter, FlightResult* result)
+{
+    result->refreshes = 0;
+    result->rebinds = 0;
+    result->maxDisplayedButtons = 0;
+    result->maxDisplayedMarkers = 0;
+    result->buttonsCreated = 0;
+    result->markersCreated = 0;
+
+    MapPoint refreshedMinimum, refreshedMaximum;
+    float refreshedScale = 0;
+    vector<unsigned int> found, foundCounts, foundLandmarks;
+    vector<float> layerX, layerY;
+    const vector<unsigned int>& order = index.getOrder();
+    map<unsigned int, unsigned int> boundButtons, previouslyBound;
+    vector<unsigned int> freeButtons;
+
+    for (unsigned int frame = 0; frame < options.frames; frame++)
+    {
+        // Zoom in and out over ten seconds while the centre of the view wanders around the map.
+        double time = frame / 60.0;
+        float zoom = 0.5f - 0.5f * cosf((float)time * 6.2831853f / 10);
+        float scale = minScale * powf(maxScale / minScale, zoom);
+        MapPoint center(options.mapSize.x * (0.5f + 0.35f * sinf((float)time * 0.37f)),
+                        options.mapSize.y * (0.5f + 0.35f * sinf((float)time * 0.23f + 1)));
+        MapPoint halfView = options.viewSize * (0.5f / scale);
+        MapPoint minimum = center - halfView;
+        MapPoint maximum = center + halfView;
+
+        double before = getMicroseconds();
+
+        // As in LandmarkLayer::setMapTransform(...), only place the markers again if the scale changed or the view left the placed area.
+        if (scale != refreshedScale ||
+            minimum.x < refreshedMinimum.x || minimum.y < refreshedMinimum.y ||
+            maximum.x > refreshedMaximum.x || maximum.y > refreshedMaximum.y)
+        {
+            result->refreshes++;
+            refreshedScale = scale;
+            MapPoint margin = (maximum - minimum) * REFRESH_MARGIN;
+            refreshedMinimum = minimum - margin;
+            refreshedMaximum = maximum + margin;
+
+            unsigned int level;
+            float split;
+            index.findLevel(scale, &level, &split);
+            found.clear();
+            index.findInRect(level, refreshedMinimum, refreshedMaximum, &found);
+
+            // As in LandmarkLayer, count each cluster's landmarks which pass the filter as a range of it, and drop the clusters with none.
+            const vector<LandmarkCluster>& clusters = index.getClusters(level);
+            unsigned int count = 0;
+            foundCounts.resize(found.size());
+            foundLandmarks.resize(found.size());
+            for (unsigned int i = 0; i < found.size(); i++)
+            {
+                const LandmarkCluster& cluster = clusters[found[i]];
+                unsigned int matching = filter ? filter->countRange(cluster.first, cluster.first + cluster.count) : cluster.count;
+                if (matching == 0)
+                {
+                    continue;
+                }
+
+                found[count] = found[i];
+                foundCounts[count] = matching;
+                foundLandmarks[count] = (filter && matching == 1) ? order[filter->findNext(cluster.first)] : cluster.landmark;
+                count++;
+            }
+            found.resize(count);
+
+            layerX.resize(found.size());
+            layerY.resize(found.size());
+            for (unsigned int i = 0; i < found.size(); i++)
+            {
+                MapPoint position = index.getSplitPosition(level, found[i], split);
+                layerX[i] = position.x * scale;
+                layerY[i] = position.y * scale;
+            }
+
+            // Keep the buttons of landmarks which are still displayed, free the rest, then bind buttons to the new landmarks.
+            previouslyBound.swap(boundButtons);
+            boundButtons.clear();
+            unsigned int displayedButtons = 0;
+            unsigned int displayedMarkers = 0;
+
+            for (unsigned int i = 0; i < found.size(); i++)
+            {
+                if (foundCounts[i] != 1)
+                {
+                    continue;
+                }
+
+                map<unsigned int, unsigned int>::iterator bound = previouslyBound.find(foundLandmarks[i]);
+                if (bound != previouslyBound.end())
+                {
+                    boundButtons.insert(*bound);
+                    previouslyBound.erase(bound);
+                }
+            }
+
+            for (map<unsigned int, unsigned int>::iterator it = previouslyBound.begin(); it != previouslyBound.end(); it++)
+            {
+                freeButtons.push_back(it->second);
+            }
+            previouslyBound.clear();
+
+            for (unsigned int i = 0; i < found.size(); i++)
+            {
+                if (foundCounts[i] != 1)
+                {
+                    displayedMarkers++;
+                    continue;
+                }
+
+                displayedButtons++;
+                if (boundButtons.find(foundLandmarks[i]) != boundButtons.end())
+                {
+                    continue;
+                }
+
+                if (!freeButtons.empty())
+                {
+                    boundButtons[foundLandmarks[i]] = freeButtons.back();
+                    freeButtons.pop_back();
+                    result->rebinds++;
+                }
+                else
+                {
+                    boundButtons[foundLandmarks[i]] = result->buttonsCreated++;
+                }
+            }
+
+            result->maxDisplayedButtons = max(result->maxDisplayedButtons, displayedButtons);
+            result->maxDisplayedMarkers = max(result->maxDisplayedMarkers, displayedMarkers);
+            result->markersCreated = max(result->markersCreated, displayedMarkers);
+        }
+
+        result->frameTimes.push_back(getMicroseconds() - before);
+    }
+}
+
+// Get a percentile of a sorted list of times using the nearest rank.
+
+static double getPercentile(const vector<double>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)ceil(percentile / 100.0 * sortedTimes.size());
+    return sortedTimes[min(max(rank, (size_t)1), sortedTimes.size()) - 1];
+}
+
+// Print the percentiles of a list of times.
+
+static void printPercentiles(const char* label, vector<double>& times)
+{
+    sort(times.begin(), times.end());
+    printf("  %-20s p50 %8.2f   p90 %8.2f   p99 %8.2f   max %8.2f\n", label,
+           getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 99), getPercentile(times, 100));
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-n landmarks] [-f frames] [-m width,height] [-v width,height] [-s seed] [-c categories]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    options.landmarkCount = 100000;
+    options.frames = 3600;
+    options.mapSize = MapPoint(3396, 4840);
+    options.viewSize = MapPoint(1536, 2048);
+    options.seed = 1;
+    options.categories = kLandmarkCategoryMuseum | kLandmarkCategoryPark;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:f:m:v:s:c:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                options.landmarkCount = (unsigned int)atoi(optarg);
+                if (options.landmarkCount == 0) printUsage(argv[0]);
+                break;
+            case 'f':
+                options.frames = (unsigned int)atoi(optarg);
+                if (options.frames == 0) printUsage(argv[0]);
+                break;
+            case 'm':
+                if (sscanf(optarg, "%f,%f", &options.mapSize.x, &options.mapSize.y) != 2) printUsage(argv[0]);
+                break;
+            case 'v':
+                if (sscanf(optarg, "%f,%f", &options.viewSize.x, &options.viewSize.y) != 2) printUsage(argv[0]);
+                break;
+            case 's':
+                options.seed = (unsigned int)atoi(optarg);
+                break;
+            case 'c':
+                options.categories = (unsigned int)atoi(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    if (options.mapSize.x <= 0 || options.mapSize.y <= 0 || options.viewSize.x <= 0 || options.viewSize.y <= 0)
+    {
+        printUsage(argv[0]);
+    }
+
+    float screenScale = options.viewSize.x / REFERENCE_VIEW_WIDTH;
+    float minScale = max(options.viewSize.x / options.mapSize.x, options.viewSize.y / options.mapSize.y) * MIN_SCALE_FACTOR;
+    float maxScale = screenScale * MAX_SCALE_FACTOR;
+
+    vector<MapPoint> positions;
+    vector<unsigned int> categories;
+    scatterLandmarks(options, &positions);
+    assignCategories(options, &categories);
+
+    // Startup: everything LandmarkLayer does before it can display its first frame.
+    double before = getMicroseconds();
+    LandmarkClusterIndex index;
+    index.build(positions, options.mapSize, BUTTON_WIDTH * screenScale, minScale, maxScale);
+    double buildTime = getMicroseconds() - before;
+
+    before = getMicroseconds();
+    const vector<unsigned int>& order = index.getOrder();
+    vector<unsigned int> orderedCategories(order.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        orderedCategories[i] = categories[order[i]];
+    }
+    LandmarkCategoryIndex categoryIndex;
+    categoryIndex.build(orderedCategories);
+    double categoryBuildTime = getMicroseconds() - before;
+
+    FlightResult result;
+    fly(index, options, minScale, maxScale, NULL, &result);
+
+    // Change the filter to every combination of categories, matching any and then all of them, as LandmarkLayer::setCategoryFilter(...) does.
+    vector<double> toggleTimes;
+    LandmarkBitset filter;
+    for (unsigned int matchAll = 0; matchAll < 2; matchAll++)
+    {
+        for (unsigned int combination = 1; combination < (1u << LANDMARK_CATEGORY_COUNT); combination++)
+        {
+            before = getMicroseconds();
+            categoryIndex.find(combination, matchAll != 0, &filter);
+            toggleTimes.push_back(getMicroseconds() - before);
+        }
+    }
+
+    // Then fly again, only displaying the landmarks in the chosen categories.
+    categoryIndex.find(options.categories, false, &filter);
+    FlightResult filteredResult;
+    fly(index, options, minScale, maxScale, &filter, &filteredResult);
+
+    printf("%u landmarks on a %gx%g map, %gx%g view, scale %.3f to %.3f\n", options.landmarkCount,
+           options.mapSize.x, options.mapSize.y, options.viewSize.x, options.viewSize.y, minScale, maxScale);
+    printf("  startup:             %.2f ms to build %u levels of clusters\n", buildTime / 1000, index.getLevelCount());
+    printf("  %u frames, %u refreshes, %u button rebinds\n", options.frames, result.refreshes, result.rebinds);
+    printPercentiles("frame time (us):", result.frameTimes);
+    printf("  displayed at most:   %u buttons, %u cluster markers\n", result.maxDisplayedButtons, result.maxDisplayedMarkers);
+    printf("  nodes created:       %u buttons, %u cluster markers (%u buttons without pooling)\n",
+           result.buttonsCreated, result.markersCreated, options.landmarkCount);
+
+    printf("categories\n");
+    printf("  startup:             %.2f ms to index the categories in cluster order\n", categoryBuildTime / 1000);
+    printPercentiles("filter change (us):", toggleTimes);
+    printf("  filter %u:            %u landmarks (%lu bytes)\n", options.categories, filter.getCount(), filter.getMemorySize());
+    printPercentiles("frame time (us):", filteredResult.frameTimes);
+    printf("  displayed at most:   %u buttons, %u cluster markers\n", filteredResult.maxDisplayedButtons, filteredResult.maxDisplayedMarkers);
+
+    return 0;
+}
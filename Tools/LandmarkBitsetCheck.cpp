@@ -0,0 +1,415 @@
+//
+//  LandmarkBitsetCheck.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which checks LandmarkBitset against a std::set holding the same indices, without a device or
+//  cocos2d. It adds indices in order, out of order and more than once, then grows chunks either side of the size at which
+//  they switch from arrays to bitmaps, by adding to them and uniting them, and shrinks them back by intersecting them,
+//  checking from the memory each takes that it switched along with its contents. It then builds random pairs of sets whose chunks range from
+//  a handful of indices to nearly full, and checks their unions and intersections. For every set it checks the count,
+//  membership, every index found by walking it with findNext, and countRange and findNext over random ranges and over
+//  ranges which start or end at the edges of the chunks. It prints each check and fails if any of them does.
+//
+//  Build:   c++ -O2 -I../Classes/Landmarks -o landmark_bitset_check LandmarkBitsetCheck.cpp
+//               ../Classes/Landmarks/LandmarkBitset.cpp
+//
+//  Usage:   landmark_bitset_check [-s <seed>]
+//
+//      -s <seed>       The seed for the random sets. Defaults to 1.
+//
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "LandmarkBitset.h"
+
+using namespace std;
+
+// The number of indices in a chunk, and the most a chunk keeps as an array rather than a bitmap.
+static const unsigned int CHUNK_SIZE = 65536;
+static const unsigned int MAX_ARRAY_COUNT = 4096;
+
+// The memory taken by a chunk's bitmap in bytes.
+static const unsigned long BITMAP_SIZE = CHUNK_SIZE / 8;
+
+// The number of chunks the random sets span, and the number of pairs of them checked.
+static const unsigned int RANDOM_CHUNK_COUNT = 4;
+static const unsigned int RANDOM_PAIR_COUNT = 100;
+
+// The number of random ranges each set's counts and searches are checked over.
+static const unsigned int RANDOM_RANGE_COUNT = 200;
+
+// The number of checks which failed, and whether or not checks which pass are left out of the output (ie. for the random sets).
+static unsigned int s_Failures = 0;
+static bool s_IsQuiet = false;
+
+// Print the outcome of a check, and count it if it failed.
+
+static void check(bool passed, const char* description)
+{
+    if (!passed || !s_IsQuiet)
+    {
+        printf("%-6s %s\n", passed ? "ok" : "FAILED", description);
+    }
+    if (!passed)
+    {
+        s_Failures++;
+    }
+}
+
+// Get a random number below a limit (of at most 2^24) using a generator of our own, so that the sets are the same on every platform.
+
+static unsigned int getRandom(unsigned int* state, unsigned int limit)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) % limit;
+}
+
+// Add an index to both a bitset and the set it is checked against.
+
+static void add(LandmarkBitset* bitset, set<unsigned int>* expected, unsigned int index)
+{
+    bitset->add(index);
+    expected->insert(index);
+}
+
+// Count the indices of a set within a range.
+
+static unsigned int countRange(const set<unsigned int>& expected, unsigned int begin, unsigned int end)
+{
+    if (end <= begin)
+    {
+        return 0;
+    }
+    return distance(expected.lower_bound(begin), expected.lower_bound(end));
+}
+
+// Find the first index of a set at or after a given index.
+
+static unsigned int findNext(const set<unsigned int>& expected, unsigned int index)
+{
+    set<unsigned int>::const_iterator found = expected.lower_bound(index);
+    return (found == expected.end()) ? LandmarkBitset::NOT_FOUND : *found;
+}
+
+// Check that a bitset holds the same indices as a set, and that counting and searching any range of it agree.
+
+static bool isSame(const LandmarkBitset& bitset, const set<unsigned int>& expected, unsigned int* state)
+{
+    if (bitset.getCount() != expected.size())
+    {
+        return false;
+    }
+
+    // Walking the bitset must find exactly the set's indices in order.
+    unsigned int index = bitset.findNext(0);
+    for (set<unsigned int>::const_iterator i = expected.begin(); i != expected.end(); ++i)
+    {
+        if (index != *i || !bitset.contains(*i))
+        {
+            return false;
+        }
+        index = bitset.findNext(*i + 1);
+    }
+    if (index != LandmarkBitset::NOT_FOUND)
+    {
+        return false;
+    }
+
+    // The edges of the chunks are where a range is split between them, so check ranges which start and end around every one.
+    unsigned int limit = (RANDOM_CHUNK_COUNT + 1) * CHUNK_SIZE;
+    for (unsigned int key = 0; key <= RANDOM_CHUNK_COUNT; key++)
+    {
+        unsigned int edges[] = { key * CHUNK_SIZE, key * CHUNK_SIZE + 1, (key + 1) * CHUNK_SIZE - 1 };
+        for (unsigned int i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+        {
+            if (bitset.countRange(0, edges[i]) != countRange(expected, 0, edges[i]) ||
+                bitset.countRange(edges[i], limit) != countRange(expected, edges[i], limit) ||
+                bitset.findNext(edges[i]) != findNext(expected, edges[i]) ||
+                bitset.contains(edges[i]) != (expected.count(edges[i]) != 0))
+            {
+                return false;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < RANDOM_RANGE_COUNT; i++)
+    {
+        unsigned int begin = getRandom(state, limit);
+        unsigned int end = (i % 2) ? begin + getRandom(state, 100) : getRandom(state, limit);
+        if (bitset.countRange(begin, end) != countRange(expected, begin, end) ||
+            bitset.findNext(begin) != findNext(expected, begin) ||
+            bitset.contains(begin) != (expected.count(begin) != 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check adding indices in and out of order, more than once, and clearing and swapping sets.
+
+static void checkAdding(unsigned int seed)
+{
+    unsigned int state = seed;
+
+    LandmarkBitset empty;
+    set<unsigned int> expectedEmpty;
+    check(isSame(empty, expectedEmpty, &state) && empty.findNext(0) == LandmarkBitset::NOT_FOUND && empty.countRange(0, 0xFFFFFFFF) == 0,
+          "an empty set has no indices");
+
+    LandmarkBitset ordered;
+    set<unsigned int> expectedOrdered;
+    for (unsigned int index = 3; index < 3 * CHUNK_SIZE; index += 7)
+    {
+        add(&ordered, &expectedOrdered, index);
+    }
+    check(isSame(ordered, expectedOrdered, &state), "indices added in order across three chunks");
+
+    LandmarkBitset shuffled;
+    set<unsigned int> expectedShuffled;
+    for (unsigned int i = 0; i < 20000; i++)
+    {
+        add(&shuffled, &expectedShuffled, getRandom(&state, RANDOM_CHUNK_COUNT * CHUNK_SIZE));
+    }
+    check(isSame(shuffled, expectedShuffled, &state), "indices added out of order, some more than once");
+
+    unsigned int count = shuffled.getCount();
+    for (set<unsigned int>::const_iterator i = expectedShuffled.begin(); i != expectedShuffled.end(); ++i)
+    {
+        shuffled.add(*i);
+    }
+    check(shuffled.getCount() == count && isSame(shuffled, expectedShuffled, &state), "adding every index again changes nothing");
+
+    LandmarkBitset highest;
+    set<unsigned int> expectedHighest;
+    add(&highest, &expectedHighest, 0);
+    add(&highest, &expectedHighest, LandmarkBitset::NOT_FOUND - 1);
+    check(highest.getCount() == 2 && highest.contains(LandmarkBitset::NOT_FOUND - 1) && highest.findNext(1) == LandmarkBitset::NOT_FOUND - 1,
+          "the highest index which can be added");
+
+    ordered.swap(shuffled);
+    check(isSame(ordered, expectedShuffled, &state) && isSame(shuffled, expectedOrdered, &state), "swapping two sets");
+
+    ordered.clear();
+    check(isSame(ordered, expectedEmpty, &state), "clearing a set");
+}
+
+// Get the memory taken by the indices of a set of one chunk, which is 2 bytes for each of them if the chunk is an array and 8192 if it is a bitmap.
+
+static unsigned long getChunkMemory(const LandmarkBitset& bitset)
+{
+    // A copy doesn't keep any spare capacity, so only what the chunk holds is left once the memory taken by a chunk of one index is taken away.
+    LandmarkBitset single;
+    single.add(0);
+    unsigned long overhead = LandmarkBitset(single).getMemorySize() - sizeof(unsigned short);
+    return LandmarkBitset(bitset).getMemorySize() - overhead;
+}
+
+// Fill a bitset and a set with the indices of a range within the first chunk which are a multiple of a step.
+
+static void addRange(LandmarkBitset* bitset, set<unsigned int>* expected, unsigned int begin, unsigned int end, unsigned int step)
+{
+    for (unsigned int index = begin; index < end; index += step)
+    {
+        add(bitset, expected, index);
+    }
+}
+
+// Check that chunks switch between arrays and bitmaps at the right sizes, by the memory they take, without losing any indices. A chunk of exactly 4096 indices takes the same memory either way, so the sizes either side of it are checked.
+
+static void checkConversions(unsigned int seed)
+{
+    unsigned int state = seed;
+
+    // Adding one index more than an array holds turns it into a bitmap.
+    LandmarkBitset full;
+    set<unsigned int> expectedFull;
+    addRange(&full, &expectedFull, 0, (MAX_ARRAY_COUNT - 1) * 16, 16);
+    check(isSame(full, expectedFull, &state) && getChunkMemory(full) == (MAX_ARRAY_COUNT - 1) * sizeof(unsigned short),
+          "a chunk of 4095 indices is kept as an array");
+
+    add(&full, &expectedFull, 1);
+    add(&full, &expectedFull, 2);
+    check(isSame(full, expectedFull, &state) && getChunkMemory(full) == BITMAP_SIZE, "a chunk of 4097 indices is kept as a bitmap");
+
+    // Uniting two arrays whose indices together are too many for one makes a bitmap.
+    LandmarkBitset evens, odds;
+    set<unsigned int> expectedEvens, expectedOdds;
+    addRange(&evens, &expectedEvens, 0, 6000, 2);
+    addRange(&odds, &expectedOdds, 1, 6000, 2);
+    evens.unite(odds);
+    expectedEvens.insert(expectedOdds.begin(), expectedOdds.end());
+    check(isSame(evens, expectedEvens, &state) && getChunkMemory(evens) == BITMAP_SIZE, "the union of two arrays too big for one is a bitmap");
+
+    // Intersecting two bitmaps makes an array again if few enough indices are left, and leaves a bitmap if not.
+    LandmarkBitset low, high, higher;
+    set<unsigned int> expectedLow, expectedHigh, expectedHigher;
+    addRange(&low, &expectedLow, 0, 4597, 1);
+    addRange(&high, &expectedHigh, 500, 20000, 1);
+    addRange(&higher, &expectedHigher, 502, 20000, 1);
+
+    LandmarkBitset overlap = low;
+    overlap.intersect(high);
+    set<unsigned int> expectedOverlap(expectedHigh.begin(), expectedHigh.lower_bound(4597));
+    check(isSame(overlap, expectedOverlap, &state) && getChunkMemory(overlap) == BITMAP_SIZE,
+          "the intersection of two bitmaps with 4097 indices is a bitmap");
+
+    overlap = low;
+    overlap.intersect(higher);
+    expectedOverlap.erase(500);
+    expectedOverlap.erase(501);
+    check(isSame(overlap, expectedOverlap, &state) && getChunkMemory(overlap) == (MAX_ARRAY_COUNT - 1) * sizeof(unsigned short),
+          "the intersection of two bitmaps with 4095 indices is an array");
+
+    // Combining an array with a bitmap makes an array of an intersection and a bitmap of a union, whichever side the array is on.
+    LandmarkBitset thirds, sevenths;
+    set<unsigned int> expectedThirds, expectedSevenths;
+    addRange(&thirds, &expectedThirds, 0, CHUNK_SIZE, 3);
+    addRange(&sevenths, &expectedSevenths, 0, CHUNK_SIZE, 7);
+    LandmarkBitset twentyFirsts = thirds;
+    twentyFirsts.intersect(sevenths);
+    set<unsigned int> expectedTwentyFirsts;
+    set_intersection(expectedThirds.begin(), expectedThirds.end(), expectedSevenths.begin(), expectedSevenths.end(), inserter(expectedTwentyFirsts, expectedTwentyFirsts.end()));
+    unsigned long arrayMemory = expectedTwentyFirsts.size() * sizeof(unsigned short);
+    check(isSame(twentyFirsts, expectedTwentyFirsts, &state) && getChunkMemory(twentyFirsts) == arrayMemory,
+          "the intersection of two bitmaps small enough for an array is an array");
+
+    LandmarkBitset result = twentyFirsts;
+    result.intersect(thirds);
+    check(isSame(result, expectedTwentyFirsts, &state) && getChunkMemory(result) == arrayMemory, "an array intersected with a bitmap stays an array");
+
+    result = thirds;
+    result.intersect(twentyFirsts);
+    check(isSame(result, expectedTwentyFirsts, &state) && getChunkMemory(result) == arrayMemory, "a bitmap intersected with an array becomes an array");
+
+    result = twentyFirsts;
+    result.unite(sevenths);
+    check(isSame(result, expectedSevenths, &state) && getChunkMemory(result) == BITMAP_SIZE, "an array united with a bitmap becomes a bitmap");
+
+    result = sevenths;
+    result.unite(twentyFirsts);
+    check(isSame(result, expectedSevenths, &state) && getChunkMemory(result) == BITMAP_SIZE, "a bitmap united with an array stays a bitmap");
+}
+
+// Fill a bitset and a set with random indices, giving each chunk a random density so that some are arrays and some bitmaps.
+
+static void makeRandomSet(unsigned int* state, LandmarkBitset* bitset, set<unsigned int>* expected)
+{
+    for (unsigned int key = 0; key < RANDOM_CHUNK_COUNT; key++)
+    {
+        // Leave some chunks out altogether, so that the sets don't always share the same chunks.
+        unsigned int density = getRandom(state, 6);
+        if (density == 0)
+        {
+            continue;
+        }
+
+        unsigned int count = (density < 3) ? getRandom(state, MAX_ARRAY_COUNT * density) + 1 : getRandom(state, CHUNK_SIZE / (6 - density)) + 1;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            add(bitset, expected, key * CHUNK_SIZE + getRandom(state, CHUNK_SIZE));
+        }
+    }
+}
+
+// Check the unions and intersections of random pairs of sets, in either order.
+
+static void checkRandom(unsigned int seed)
+{
+    unsigned int state = seed;
+    unsigned int failures = s_Failures;
+    s_IsQuiet = true;
+
+    for (unsigned int i = 0; i < RANDOM_PAIR_COUNT; i++)
+    {
+        LandmarkBitset first, second;
+        set<unsigned int> expectedFirst, expectedSecond;
+        makeRandomSet(&state, &first, &expectedFirst);
+        makeRandomSet(&state, &second, &expectedSecond);
+
+        set<unsigned int> expectedUnion, expectedIntersection;
+        set_union(expectedFirst.begin(), expectedFirst.end(), expectedSecond.begin(), expectedSecond.end(), inserter(expectedUnion, expectedUnion.end()));
+        set_intersection(expectedFirst.begin(), expectedFirst.end(), expectedSecond.begin(), expectedSecond.end(), inserter(expectedIntersection, expectedIntersection.end()));
+
+        char description[128];
+        snprintf(description, sizeof(description), "random set %u", i * 2);
+        check(isSame(first, expectedFirst, &state), description);
+        snprintf(description, sizeof(description), "random set %u", i * 2 + 1);
+        check(isSame(second, expectedSecond, &state), description);
+
+        LandmarkBitset result = first;
+        result.unite(second);
+        snprintf(description, sizeof(description), "union of random sets %u and %u", i * 2, i * 2 + 1);
+        check(isSame(result, expectedUnion, &state), description);
+
+        result = second;
+        result.unite(first);
+        snprintf(description, sizeof(description), "union of random sets %u and %u", i * 2 + 1, i * 2);
+        check(isSame(result, expectedUnion, &state), description);
+
+        result = first;
+        result.intersect(second);
+        snprintf(description, sizeof(description), "intersection of random sets %u and %u", i * 2, i * 2 + 1);
+        check(isSame(result, expectedIntersection, &state), description);
+
+        result = second;
+        result.intersect(first);
+        snprintf(description, sizeof(description), "intersection of random sets %u and %u", i * 2 + 1, i * 2);
+        check(isSame(result, expectedIntersection, &state), description);
+
+        // Combining with an empty set leaves the union alone and empties the intersection.
+        LandmarkBitset empty;
+        result = first;
+        result.unite(empty);
+        snprintf(description, sizeof(description), "union of random set %u and an empty set", i * 2);
+        check(isSame(result, expectedFirst, &state), description);
+
+        result.intersect(empty);
+        snprintf(description, sizeof(description), "intersection of random set %u and an empty set", i * 2);
+        check(isSame(result, set<unsigned int>(), &state), description);
+    }
+
+    s_IsQuiet = false;
+    char message[128];
+    snprintf(message, sizeof(message), "%u random pairs of sets, their unions and their intersections (%u failed)", RANDOM_PAIR_COUNT, s_Failures - failures);
+    check(s_Failures == failures, message);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int seed = 1;
+
+    int option;
+    while ((option = getopt(argc, argv, "s:")) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-s <seed>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    checkAdding(seed);
+    checkConversions(seed);
+    checkRandom(seed);
+
+    if (s_Failures > 0)
+    {
+        printf("%u checks failed.\n", s_Failures);
+        return 1;
+    }
+
+    printf("All checks passed.\n");
+    return 0;
+}
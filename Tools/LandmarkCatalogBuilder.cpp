@@ -0,0 +1,402 @@
+//
+//  LandmarkCatalogBuilder.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-03.
+//
+//  A command-line tool which converts a CSV file of landmarks into the binary catalog format memory-mapped by
+//  LandmarkCatalog (see Classes/Landmarks/LandmarkCatalog.h), ie. "landmarks.nylc". Identical strings (such as shared
+//  images or addresses) are only stored once.
+//
+//  Build:   c++ -O2 -o landmark_catalog_builder LandmarkCatalogBuilder.cpp
+//
+//  Usage:   landmark_catalog_builder <source.csv> <output.nylc>
+//
+//  The first row of the source names the columns, which may come in any order:
+//
+//      name            The landmark's title. Required.
+//      image           The file name of the landmark's image, without "_mini" or an extension. Required.
+//      description     A brief description of the landmark.
+//      address         An address to be used by the Google Maps SDK to show directions to the landmark.
+//      website         The URL of the landmark's website.
+//      tickets         The URL for buying tickets to the landmark.
+//      categories      The kinds of place the landmark is, separated by spaces, out of "museum", "park", "venue",
+//                      "building", "monument" and "neighbourhood".
+//      x, y            The landmark's position on the map, from bottom-left (0,0) to top-right (1,1). Required.
+//
+//  Fields follow RFC 4180: a field containing commas, quotes or line breaks is wrapped in double quotes, and a double quote
+//  inside one is written twice. Line breaks inside a field are kept, since they lay out the landmark's popup. Empty optional
+//  fields are left out of the catalog.
+//
+//  The catalog shipped with the app is built from Resources/landmarks/landmarks.csv:
+//
+//      landmark_catalog_builder ../Resources/landmarks/landmarks.csv ../Resources/landmarks/landmarks.nylc
+//
+
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// These values must match the format described in LandmarkCatalog.h.
+static const unsigned int HEADER_SIZE = 32;
+static const unsigned int FILE_VERSION = 2;
+static const unsigned int RECORD_STRING_COUNT = 6;
+static const unsigned int NO_STRING = 0xFFFFFFFF;
+
+// The name of each category in the source, in the order of the LandmarkCategory flags in Landmark.h.
+static const unsigned int CATEGORY_COUNT = 6;
+static const char* CATEGORY_NAMES[CATEGORY_COUNT] = { "museum", "park", "venue", "building", "monument", "neighbourhood" };
+
+// The columns stored in each record, in record order, and which of them every landmark must have.
+static const char* STRING_COLUMNS[RECORD_STRING_COUNT] = { "name", "image", "description", "address", "website", "tickets" };
+static const bool STRING_REQUIRED[RECORD_STRING_COUNT] = { true, true, false, false, false, false };
+
+// Required strings are always stored, even if empty, so that the app can rely on them.
+static const bool STRING_ALWAYS_STORED[RECORD_STRING_COUNT] = { true, true, true, false, false, false };
+
+/**
+ @brief     The strings of every landmark, each stored once.
+ */
+struct StringTable
+{
+    vector<char> bytes;
+    map<string, unsigned int> offsets;
+
+    // Add a string to the table, or find it if it's already there.
+    unsigned int add(const string& value)
+    {
+        map<string, unsigned int>::iterator found = offsets.find(value);
+        if (found != offsets.end())
+        {
+            return found->second;
+        }
+
+        unsigned int offset = bytes.size();
+        bytes.insert(bytes.end(), value.begin(), value.end());
+        bytes.push_back('\0');
+        offsets[value] = offset;
+        return offset;
+    }
+};
+
+// Append little-endian values to the output.
+
+static void writeUInt16(vector<unsigned char>& output, unsigned int value)
+{
+    output.push_back(value & 0xFF);
+    output.push_back((value >> 8) & 0xFF);
+}
+
+static void writeUInt32(vector<unsigned char>& output, unsigned int value)
+{
+    writeUInt16(output, value & 0xFFFF);
+    writeUInt16(output, value >> 16);
+}
+
+static void writeFloat32(vector<unsigned char>& output, float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    writeUInt32(output, bits);
+}
+
+// Overwrite a little-endian value which was written earlier.
+
+static void patchUInt32(vector<unsigned char>& output, unsigned int offset, unsigned int value)
+{
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        output[offset + i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+// Pad the output with zeros up to a 4-byte boundary.
+
+static void align(vector<unsigned char>& output)
+{
+    while (output.size() % 4 != 0)
+    {
+        output.push_back(0);
+    }
+}
+
+// Read one CSV row into its fields. Returns false at the end of the file, or if a quoted field is never closed.
+
+static bool readRow(FILE* source, vector<string>* fields, unsigned int* lineNumber)
+{
+    fields->clear();
+
+    int c = fgetc(source);
+    if (c == EOF)
+    {
+        return false;
+    }
+
+    string field;
+    bool quoted = false;
+
+    for (;; c = fgetc(source))
+    {
+        if (quoted)
+        {
+            if (c == EOF)
+            {
+                return false;
+            }
+            else if (c == '"')
+            {
+                // A doubled quote is a quote inside the field, while a single one closes it.
+                int next = fgetc(source);
+                if (next == '"')
+                {
+                    field += '"';
+                }
+                else
+                {
+                    quoted = false;
+                    ungetc(next, source);
+                }
+            }
+            else
+            {
+                if (c == '\n') (*lineNumber)++;
+                if (c != '\r') field += (char)c;
+            }
+        }
+        else if (c == '"' && field.empty())
+        {
+            quoted = true;
+        }
+        else if (c == ',')
+        {
+            fields->push_back(field);
+            field.clear();
+        }
+        else if (c == '\n' || c == EOF)
+        {
+            fields->push_back(field);
+            (*lineNumber)++;
+            return true;
+        }
+        else if (c != '\r')
+        {
+            field += (char)c;
+        }
+    }
+}
+
+// Turn a list of category names into LandmarkCategory flags. Returns false if a name isn't one of the categories.
+
+static bool parseCategories(const string& field, unsigned int* categories)
+{
+    *categories = 0;
+
+    for (size_t start = 0; start < field.size(); )
+    {
+        size_t end = field.find(' ', start);
+        if (end == string::npos)
+        {
+            end = field.size();
+        }
+
+        string name = field.substr(start, end - start);
+        start = end + 1;
+        if (name.empty())
+        {
+            continue;
+        }
+
+        unsigned int category = 0;
+        while (category < CATEGORY_COUNT && name != CATEGORY_NAMES[category])
+        {
+            category++;
+        }
+        if (category == CATEGORY_COUNT)
+        {
+            return false;
+        }
+        *categories |= 1 << category;
+    }
+
+    return true;
+}
+
+// Find a column by name in the header row.
+
+static int findColumn(const vector<string>& header, const char* name)
+{
+    for (unsigned int i = 0; i < header.size(); i++)
+    {
+        if (header[i] == name)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <source.csv> <output.nylc>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* source = fopen(argv[1], "rb");
+    if (!source)
+    {
+        fprintf(stderr, "error: could not open \"%s\"\n", argv[1]);
+        return 1;
+    }
+
+    // Find each column in the header.
+    unsigned int lineNumber = 1;
+    vector<string> header;
+    if (!readRow(source, &header, &lineNumber))
+    {
+        fprintf(stderr, "error: \"%s\" is empty\n", argv[1]);
+        return 1;
+    }
+
+    int stringColumns[RECORD_STRING_COUNT];
+    for (unsigned int i = 0; i < RECORD_STRING_COUNT; i++)
+    {
+        stringColumns[i] = findColumn(header, STRING_COLUMNS[i]);
+        if (stringColumns[i] < 0 && STRING_REQUIRED[i])
+        {
+            fprintf(stderr, "error: there is no \"%s\" column\n", STRING_COLUMNS[i]);
+            return 1;
+        }
+    }
+
+    int categoriesColumn = findColumn(header, "categories");
+    int xColumn = findColumn(header, "x");
+    int yColumn = findColumn(header, "y");
+    if (xColumn < 0 || yColumn < 0)
+    {
+        fprintf(stderr, "error: there are no \"x\" and \"y\" columns\n");
+        return 1;
+    }
+
+    // Read every landmark, collecting the strings into the table as we go.
+    StringTable strings;
+    vector<unsigned int> records;
+    vector<float> coordinates;
+    vector<string> fields;
+
+    for (unsigned int rowLine = lineNumber; readRow(source, &fields, &lineNumber); rowLine = lineNumber)
+    {
+        // Skip blank lines.
+        if (fields.size() == 1 && fields[0].empty())
+        {
+            continue;
+        }
+
+        if (fields.size() != header.size())
+        {
+            fprintf(stderr, "error: line %u: expected %u fields but found %u\n", rowLine, (unsigned int)header.size(), (unsigned int)fields.size());
+            return 1;
+        }
+
+        for (unsigned int i = 0; i < RECORD_STRING_COUNT; i++)
+        {
+            const string value = (stringColumns[i] >= 0) ? fields[stringColumns[i]] : "";
+            if (value.empty() && STRING_REQUIRED[i])
+            {
+                fprintf(stderr, "error: line %u: the landmark has no %s\n", rowLine, STRING_COLUMNS[i]);
+                return 1;
+            }
+
+            records.push_back((value.empty() && !STRING_ALWAYS_STORED[i]) ? NO_STRING : strings.add(value));
+        }
+
+        unsigned int categories = 0;
+        if (categoriesColumn >= 0 && !parseCategories(fields[categoriesColumn], &categories))
+        {
+            fprintf(stderr, "error: line %u: unknown category in \"%s\"\n", rowLine, fields[categoriesColumn].c_str());
+            return 1;
+        }
+        records.push_back(categories);
+
+        char* xEnd;
+        char* yEnd;
+        float x = strtof(fields[xColumn].c_str(), &xEnd);
+        float y = strtof(fields[yColumn].c_str(), &yEnd);
+        if (fields[xColumn].empty() || fields[yColumn].empty() || *xEnd != '\0' || *yEnd != '\0' || !(x >= 0 && x <= 1 && y >= 0 && y <= 1))
+        {
+            fprintf(stderr, "error: line %u: the position must be two numbers from 0 to 1\n", rowLine);
+            return 1;
+        }
+        coordinates.push_back(x);
+        coordinates.push_back(y);
+    }
+
+    if (!feof(source))
+    {
+        fprintf(stderr, "error: line %u: a quoted field is never closed\n", lineNumber);
+        return 1;
+    }
+
+    long sourceSize = ftell(source);
+    fclose(source);
+
+    // An empty table would have no terminating zero for LandmarkCatalog to check.
+    if (strings.bytes.empty())
+    {
+        strings.bytes.push_back('\0');
+    }
+
+    // Write the header, leaving the offsets to be filled in once the sections are in place.
+    unsigned int count = coordinates.size() / 2;
+    vector<unsigned char> output;
+    output.insert(output.end(), "NYLC", "NYLC" + 4);
+    writeUInt16(output, FILE_VERSION);
+    writeUInt16(output, 0);
+    writeUInt32(output, count);
+    while (output.size() < HEADER_SIZE)
+    {
+        output.push_back(0);
+    }
+
+    unsigned int recordsOffset = output.size();
+    for (unsigned int i = 0; i < records.size(); i++)
+    {
+        writeUInt32(output, records[i]);
+    }
+
+    unsigned int coordinatesOffset = output.size();
+    for (unsigned int i = 0; i < coordinates.size(); i++)
+    {
+        writeFloat32(output, coordinates[i]);
+    }
+
+    unsigned int stringsOffset = output.size();
+    output.insert(output.end(), strings.bytes.begin(), strings.bytes.end());
+    align(output);
+
+    patchUInt32(output, 12, recordsOffset);
+    patchUInt32(output, 16, coordinatesOffset);
+    patchUInt32(output, 20, stringsOffset);
+    patchUInt32(output, 24, strings.bytes.size());
+    patchUInt32(output, 28, output.size());
+
+    FILE* destination = fopen(argv[2], "wb");
+    if (!destination || fwrite(&output[0], 1, output.size(), destination) != output.size())
+    {
+        fprintf(stderr, "error: could not write \"%s\"\n", argv[2]);
+        return 1;
+    }
+    fclose(destination);
+
+    printf("Wrote %u landmarks (%lu unique strings) to \"%s\": %lu bytes from %ld bytes of source.\n",
+           count, (unsigned long)strings.offsets.size(), argv[2], (unsigned long)output.size(), sourceSize);
+
+    return 0;
+}
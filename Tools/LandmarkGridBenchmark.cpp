@@ -0,0 +1,434 @@
+//
+//  LandmarkGridBenchmark.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-25.
+//
+//  A command-line tool which measures how finding the landmark under a touch scales with the size of the catalog, without
+//  a device or cocos2d. For each catalog size it scatters landmarks over the map, then times random touches at random
+//  scales two ways: looking the touch up in a LandmarkGrid, and scanning every landmark's bounds the way the buttons did
+//  when each one had its own touch delegate. Every lookup's result is checked against the scan's.
+//
+//  Touches are looked up among the landmarks themselves, as the map did when the grid was added, and among the clusters
+//  displayed at the touch's scale (see LandmarkClusterIndex), as the landmark layer does now. The landmarks' buttons
+//  overlap more and more as the catalog grows, so a lookup among them has more buttons under the touch to choose between;
+//  the clusters never overlap much, so a lookup among them has about the same work to do however large the catalog is.
+//  The number of buttons under each touch is reported alongside the times so that the two can be told apart.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Landmarks -o landmark_grid_benchmark LandmarkGridBenchmark.cpp
+//               ../Classes/Landmarks/LandmarkGrid.cpp ../Classes/Landmarks/LandmarkClusterIndex.cpp
+//
+//  Usage:   landmark_grid_benchmark [options]
+//
+//      -n <count>,...          The catalog sizes to measure. Defaults to 1000,10000,100000.
+//      -t <touches>            The number of touches looked up for each catalog size. Defaults to 20000.
+//      -m <width>,<height>     The size of the map. Defaults to the size of the New York map.
+//      -v <width>,<height>     The size of the view. Defaults to an iPad Retina screen in portrait.
+//      -s <seed>               The seed for scattering the landmarks and the touches. Defaults to 1.
+//
+//  The tool fails if any lookup finds a different landmark from the scan.
+//
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "LandmarkClusterIndex.h"
+#include "LandmarkGrid.h"
+
+using namespace std;
+
+// The same limits Map uses, given the width the app's screen scale is measured against.
+static const float REFERENCE_VIEW_WIDTH = 1536;
+static const float MAX_SCALE_FACTOR = 2.5f;
+static const float MIN_SCALE_FACTOR = 2;
+
+// The on-screen size of a LandmarkButton, at a screen scale of 1.
+static const float BUTTON_WIDTH = 225;
+static const float BUTTON_HEIGHT = 225;
+
+// The most cells across and down a grid, as in LandmarkClusterIndex.
+static const unsigned int MAX_GRID_SIZE = 64;
+
+// How many landmarks are scattered around a few busy spots rather than evenly, and how many of those spots there are.
+static const float CLUSTERED_FRACTION = 0.7f;
+static const unsigned int HOT_SPOT_COUNT = 12;
+
+/**
+ @brief     The command-line options.
+ */
+struct BenchmarkOptions
+{
+    vector<unsigned int> landmarkCounts;
+    unsigned int touchCount;
+    MapPoint mapSize;
+    MapPoint viewSize;
+    unsigned int seed;
+};
+
+/**
+ @brief     A touch to look up, and the size of a button around it in map units at the scale it was made at.
+ */
+struct Touch
+{
+    MapPoint point;
+    float halfWidth;
+    float halfHeight;
+    float scale;
+};
+
+/**
+ @brief     What looking up the touches measured, for the landmarks or the displayed clusters.
+ */
+struct LookupResult
+{
+    /** The average time to look up a touch in microseconds, through the grid and by scanning. */
+    double gridTime;
+    double scanTime;
+
+    /** The average number of buttons whose bounds contained a touch, and the number of touches which hit one. */
+    double buttonsUnderTouch;
+    unsigned int hits;
+
+    /** The number of lookups which found a different landmark from the scan. */
+    unsigned int mismatches;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the landmarks are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Scatter landmarks over the map, mostly around a few busy spots in the way real points of interest gather, as in LandmarkBenchmark.cpp.
+
+static void scatterLandmarks(unsigned int count, const MapPoint& mapSize, unsigned int seed, vector<MapPoint>* positions)
+{
+    unsigned int state = seed;
+
+    vector<MapPoint> hotSpots(HOT_SPOT_COUNT);
+    for (unsigned int i = 0; i < HOT_SPOT_COUNT; i++)
+    {
+        hotSpots[i] = MapPoint(getRandom(&state) * mapSize.x, getRandom(&state) * mapSize.y);
+    }
+
+    positions->resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        MapPoint position;
+        if (getRandom(&state) < CLUSTERED_FRACTION)
+        {
+            // A normal distribution around the spot, made with the Box-Muller transform.
+            float radius = sqrtf(-2 * logf(max(getRandom(&state), 1e-6f))) * mapSize.x * 0.03f;
+            float angle = getRandom(&state) * 6.2831853f;
+            position = hotSpots[i % HOT_SPOT_COUNT] + MapPoint(cosf(angle), sinf(angle)) * radius;
+        }
+        else
+        {
+            position = MapPoint(getRandom(&state) * mapSize.x, getRandom(&state) * mapSize.y);
+        }
+
+        (*positions)[i] = MapPoint(min(max(position.x, 0.0f), mapSize.x), min(max(position.y, 0.0f), mapSize.y));
+    }
+}
+
+// Make touches at random scales, half of them on a landmark and the rest anywhere on the map.
+
+static void makeTouches(const vector<MapPoint>& positions, const BenchmarkOptions& options, float screenScale, float minScale, float maxScale, vector<Touch>* touches)
+{
+    unsigned int state = options.seed * 7919u + 1;
+    touches->resize(options.touchCount);
+    for (unsigned int i = 0; i < options.touchCount; i++)
+    {
+        Touch& touch = (*touches)[i];
+        touch.scale = minScale * powf(maxScale / minScale, getRandom(&state));
+        touch.halfWidth = BUTTON_WIDTH * screenScale / touch.scale / 2;
+        touch.halfHeight = BUTTON_HEIGHT * screenScale / touch.scale / 2;
+
+        if (i % 2 == 0)
+        {
+            MapPoint landmark = positions[min((unsigned int)(getRandom(&state) * positions.size()), (unsigned int)positions.size() - 1)];
+            touch.point = landmark + MapPoint((getRandom(&state) - 0.5f) * touch.halfWidth, (getRandom(&state) - 0.5f) * touch.halfHeight);
+        }
+        else
+        {
+            touch.point = MapPoint(getRandom(&state) * options.mapSize.x, getRandom(&state) * options.mapSize.y);
+        }
+    }
+}
+
+// Find the landmark nearest to a touch out of those whose bounds contain it, by testing every one, and count how many contain it.
+
+static bool scanForNearest(const vector<MapPoint>& positions, const Touch& touch, unsigned int* index, unsigned int* containing)
+{
+    bool found = false;
+    float nearestDistance = 0;
+    *containing = 0;
+
+    for (unsigned int i = 0; i < positions.size(); i++)
+    {
+        if (fabsf(positions[i].x - touch.point.x) > touch.halfWidth || fabsf(positions[i].y - touch.point.y) > touch.halfHeight)
+        {
+            continue;
+        }
+
+        (*containing)++;
+        float distance = positions[i].distanceSquared(touch.point);
+        if (!found || distance < nearestDistance)
+        {
+            found = true;
+            nearestDistance = distance;
+            *index = i;
+        }
+    }
+
+    return found;
+}
+
+// Index a set of positions in a grid whose cells are about the size of a button at the largest scale, as LandmarkClusterIndex sizes its grids.
+
+static void buildGrid(const vector<MapPoint>& positions, const MapPoint& mapSize, float cellSize, LandmarkGrid* grid)
+{
+    unsigned int gridSize = min(max((unsigned int)(mapSize.x / cellSize), 1u), MAX_GRID_SIZE);
+    grid->reset(mapSize.x, mapSize.y, gridSize, gridSize);
+    for (unsigned int i = 0; i < positions.size(); i++)
+    {
+        grid->insert(i, positions[i]);
+    }
+}
+
+// Check whether or not a lookup found the same landmark as the scan. Two landmarks the same distance away are as good as each other.
+
+static bool isSameResult(const vector<MapPoint>& positions, const Touch& touch, bool gridFound, unsigned int gridIndex, bool scanFound, unsigned int scanIndex)
+{
+    if (gridFound != scanFound)
+    {
+        return false;
+    }
+    return !gridFound || gridIndex == scanIndex || positions[gridIndex].distanceSquared(touch.point) == positions[scanIndex].distanceSquared(touch.point);
+}
+
+// Look the touches up among the landmarks themselves.
+
+static void lookUpLandmarks(const vector<MapPoint>& positions, const vector<Touch>& touches, const MapPoint& mapSize, float cellSize, LookupResult* result)
+{
+    LandmarkGrid grid;
+    buildGrid(positions, mapSize, cellSize, &grid);
+
+    vector<unsigned char> gridFound(touches.size());
+    vector<unsigned int> gridIndices(touches.size());
+    double before = getMicroseconds();
+    for (unsigned int i = 0; i < touches.size(); i++)
+    {
+        gridFound[i] = grid.findNearest(touches[i].point, touches[i].halfWidth, touches[i].halfHeight, &gridIndices[i]);
+    }
+    result->gridTime = (getMicroseconds() - before) / touches.size();
+
+    vector<unsigned char> scanFound(touches.size());
+    vector<unsigned int> scanIndices(touches.size());
+    vector<unsigned int> containing(touches.size());
+    before = getMicroseconds();
+    for (unsigned int i = 0; i < touches.size(); i++)
+    {
+        scanFound[i] = scanForNearest(positions, touches[i], &scanIndices[i], &containing[i]);
+    }
+    result->scanTime = (getMicroseconds() - before) / touches.size();
+
+    result->buttonsUnderTouch = 0;
+    result->hits = 0;
+    result->mismatches = 0;
+    for (unsigned int i = 0; i < touches.size(); i++)
+    {
+        result->buttonsUnderTouch += containing[i];
+        result->hits += scanFound[i];
+        if (!isSameResult(positions, touches[i], gridFound[i], gridIndices[i], scanFound[i], scanIndices[i]))
+        {
+            result->mismatches++;
+        }
+    }
+    result->buttonsUnderTouch /= touches.size();
+}
+
+// Look the touches up among the clusters displayed at their scales. The scan still tests every landmark, as each button did for itself.
+
+static void lookUpClusters(const vector<MapPoint>& positions, const vector<Touch>& touches, const MapPoint& mapSize, float cellSize, const LandmarkClusterIndex& index, LookupResult* result)
+{
+    // Index each level's clusters where they are displayed once fully split, in a grid as coarse as its clusters are far apart.
+    vector<vector<MapPoint> > levelPositions(index.getLevelCount());
+    vector<LandmarkGrid> grids(index.getLevelCount());
+    for (unsigned int level = 0; level < index.getLevelCount(); level++)
+    {
+        const vector<LandmarkCluster>& clusters = index.getClusters(level);
+        for (unsigned int i = 0; i < clusters.size(); i++)
+        {
+            levelPositions[level].push_back(clusters[i].position);
+        }
+        buildGrid(levelPositions[level], mapSize, cellSize * index.getLevelScale(0) / index.getLevelScale(level), &grids[level]);
+    }
+
+    vector<unsigned int> touchLevels(touches.size());
+    for (unsigned int i = 0; i < touches.size(); i++)
+    {
+        float split;
+        index.findLevel(touches[i].scale, &touchLevels[i], &split);
+    }
+
+    vector<unsigned char> gridFound(touches.size());
+    vector<unsigned int> gridIndices(touches.size());
+    double before = getMicroseconds();
+    for (unsigned int i = 0; i < touches.size(); i++)
+    {
+        gridFound[i] = grids[touchLevels[i]].findNearest(touches[i].point, touches[i].halfWidth, touches[i].halfHeight, &gridIndices[i]);
+    }
+    result->gridTime = (getMicroseconds() - before) / touches.size();
+
+    vector<unsigned int> scanIndices(touches.size());
+    vector<unsigned int> containing(touches.size());
+    before = getMicroseconds();
+    for (unsigned int i = 0; i < touches.size(); i++)
+    {
+        scanForNearest(positions, touches[i], &scanIndices[i], &containing[i]);
+    }
+    result->scanTime = (getMicroseconds() - before) / touches.size();
+
+    // The scan above is only for timing. The lookups are checked against a scan of the same level's clusters.
+    result->buttonsUnderTouch = 0;
+    result->hits = 0;
+    result->mismatches = 0;
+    for (unsigned int i = 0; i < touches.size(); i++)
+    {
+        const vector<MapPoint>& clusterPositions = levelPositions[touchLevels[i]];
+        unsigned int scanIndex, clusterContaining;
+        bool scanFound = scanForNearest(clusterPositions, touches[i], &scanIndex, &clusterContaining);
+        result->buttonsUnderTouch += clusterContaining;
+        result->hits += scanFound;
+        if (!isSameResult(clusterPositions, touches[i], gridFound[i], gridIndices[i], scanFound, scanIndex))
+        {
+            result->mismatches++;
+        }
+    }
+    result->buttonsUnderTouch /= touches.size();
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-n count,...] [-t touches] [-m width,height] [-v width,height] [-s seed]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    options.touchCount = 20000;
+    options.mapSize = MapPoint(3396, 4840);
+    options.viewSize = MapPoint(1536, 2048);
+    options.seed = 1;
+    const char* counts = "1000,10000,100000";
+
+    int option;
+    while ((option = getopt(argc, argv, "n:t:m:v:s:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                counts = optarg;
+                break;
+            case 't':
+                options.touchCount = (unsigned int)atoi(optarg);
+                if (options.touchCount == 0) printUsage(argv[0]);
+                break;
+            case 'm':
+                if (sscanf(optarg, "%f,%f", &options.mapSize.x, &options.mapSize.y) != 2) printUsage(argv[0]);
+                break;
+            case 'v':
+                if (sscanf(optarg, "%f,%f", &options.viewSize.x, &options.viewSize.y) != 2) printUsage(argv[0]);
+                break;
+            case 's':
+                options.seed = (unsigned int)atoi(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    for (const char* count = counts; count; count = strchr(count, ','), count = count ? count + 1 : NULL)
+    {
+        unsigned int landmarkCount = (unsigned int)atoi(count);
+        if (landmarkCount == 0) printUsage(argv[0]);
+        options.landmarkCounts.push_back(landmarkCount);
+    }
+
+    if (options.mapSize.x <= 0 || options.mapSize.y <= 0 || options.viewSize.x <= 0 || options.viewSize.y <= 0)
+    {
+        printUsage(argv[0]);
+    }
+
+    float screenScale = options.viewSize.x / REFERENCE_VIEW_WIDTH;
+    float minScale = max(options.viewSize.x / options.mapSize.x, options.viewSize.y / options.mapSize.y) * MIN_SCALE_FACTOR;
+    float maxScale = screenScale * MAX_SCALE_FACTOR;
+    float cellSize = BUTTON_WIDTH * screenScale / maxScale;
+
+    printf("%u touches on a %gx%g map, %gx%g view, scale %.3f to %.3f; times are per touch\n", options.touchCount,
+           options.mapSize.x, options.mapSize.y, options.viewSize.x, options.viewSize.y, minScale, maxScale);
+    printf("%10s  %-10s %12s %12s %10s %14s %8s\n", "landmarks", "among", "grid (us)", "scan (us)", "speed-up", "under touch", "hits");
+
+    unsigned int mismatches = 0;
+    double firstClusterTime = 0;
+    double lastClusterTime = 0;
+    for (unsigned int i = 0; i < options.landmarkCounts.size(); i++)
+    {
+        vector<MapPoint> positions;
+        scatterLandmarks(options.landmarkCounts[i], options.mapSize, options.seed, &positions);
+        vector<Touch> touches;
+        makeTouches(positions, options, screenScale, minScale, maxScale, &touches);
+
+        LookupResult landmarks;
+        lookUpLandmarks(positions, touches, options.mapSize, cellSize, &landmarks);
+
+        LandmarkClusterIndex index;
+        index.build(positions, options.mapSize, BUTTON_WIDTH * screenScale, minScale, maxScale);
+        LookupResult clusters;
+        lookUpClusters(positions, touches, options.mapSize, cellSize, index, &clusters);
+
+        printf("%10u  %-10s %12.3f %12.3f %9.0fx %14.2f %8u\n", options.landmarkCounts[i], "landmarks",
+               landmarks.gridTime, landmarks.scanTime, landmarks.scanTime / landmarks.gridTime, landmarks.buttonsUnderTouch, landmarks.hits);
+        printf("%10s  %-10s %12.3f %12.3f %9.0fx %14.2f %8u\n", "", "clusters",
+               clusters.gridTime, clusters.scanTime, clusters.scanTime / clusters.gridTime, clusters.buttonsUnderTouch, clusters.hits);
+
+        mismatches += landmarks.mismatches + clusters.mismatches;
+        if (i == 0) firstClusterTime = clusters.gridTime;
+        lastClusterTime = clusters.gridTime;
+    }
+
+    if (options.landmarkCounts.size() > 1)
+    {
+        printf("Looking a touch up among the displayed clusters took %.2fx as long with %u landmarks as with %u.\n",
+               lastClusterTime / firstClusterTime, options.landmarkCounts.back(), options.landmarkCounts.front());
+    }
+
+    if (mismatches > 0)
+    {
+        printf("%u lookups found a different landmark from the scan.\n", mismatches);
+        return 1;
+    }
+
+    printf("Every lookup found the same landmark as the scan.\n");
+    return 0;
+}
@@ -0,0 +1,307 @@
+//
+//  LandmarkNearbyBenchmark.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which measures finding the landmarks near the user as the catalog grows, without a device or
+//  cocos2d. It calibrates a MapProjection the way NewYorkMap does, against points on a map which is rotated and unevenly
+//  stretched like an illustrated one, scatters landmarks over the map in clumps, and builds a LandmarkKDTree over them.
+//  It then walks a user around the city, and on every location update projects the location onto the map and finds the
+//  nearest landmarks, as Map::findNearbyLandmarks(...) does, along with every landmark within the radius. It reports the
+//  times as percentiles, and checks the results of the first updates against testing every landmark.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Landmarks -I../Classes/Map -o landmark_nearby_benchmark
+//               LandmarkNearbyBenchmark.cpp ../Classes/Landmarks/LandmarkKDTree.cpp ../Classes/Map/MapProjection.cpp
+//
+//  Usage:   landmark_nearby_benchmark [options]
+//
+//      -n <count>      The number of landmarks. Defaults to 100000.
+//      -u <count>      The number of location updates. Defaults to 10000.
+//      -k <count>      The most landmarks to find on each update. Defaults to 10.
+//      -r <metres>     How far to search on each update. Defaults to 500.
+//      -s <seed>       The seed for the map, the landmarks and the walk. Defaults to 1.
+//
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "LandmarkKDTree.h"
+#include "MapProjection.h"
+
+using namespace std;
+
+// The size of the map in map units, and the area of the city it covers.
+static const MapPoint MAP_SIZE(3396, 4840);
+static const GeoPoint CITY_SOUTH_WEST(40.685, -74.050);
+static const GeoPoint CITY_NORTH_EAST(40.790, -73.950);
+
+// The number of calibration points, and how far in map units each is drawn away from where a uniform map would put it.
+static const unsigned int CALIBRATION_COUNT = 24;
+static const float CALIBRATION_DISTORTION = 150;
+
+// The number of clumps the landmarks gather in, and the fraction of them which do.
+static const unsigned int HOT_SPOT_COUNT = 12;
+static const float CLUSTERED_FRACTION = 0.6f;
+
+// How far the user walks between location updates in metres, and how many updates are checked against testing every landmark.
+static const double WALK_STEP = 5;
+static const unsigned int CHECKED_UPDATES = 1000;
+
+/**
+ @brief     The command-line options.
+ */
+struct BenchmarkOptions
+{
+    unsigned int landmarkCount;
+    unsigned int updateCount;
+    unsigned int count;
+    float radius;
+    unsigned int seed;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the landmarks are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Make up calibration points for a map of the city which is turned to line up with the streets and then distorted.
+
+static void makeCalibration(unsigned int* state, vector<MapCalibrationPoint>* points)
+{
+    // Manhattan's streets run about 29 degrees east of north, so its maps are usually turned that far.
+    const float angle = 29 * 3.14159265f / 180;
+    points->resize(CALIBRATION_COUNT);
+    for (unsigned int i = 0; i < CALIBRATION_COUNT; i++)
+    {
+        float u = getRandom(state);
+        float v = getRandom(state);
+        MapCalibrationPoint& point = (*points)[i];
+        point.location = GeoPoint(CITY_SOUTH_WEST.latitude + v * (CITY_NORTH_EAST.latitude - CITY_SOUTH_WEST.latitude),
+                                  CITY_SOUTH_WEST.longitude + u * (CITY_NORTH_EAST.longitude - CITY_SOUTH_WEST.longitude));
+
+        MapPoint centred((u - 0.5f) * MAP_SIZE.x, (v - 0.5f) * MAP_SIZE.y);
+        MapPoint turned(centred.x * cosf(angle) - centred.y * sinf(angle), centred.x * sinf(angle) + centred.y * cosf(angle));
+        MapPoint distortion((getRandom(state) * 2 - 1) * CALIBRATION_DISTORTION, (getRandom(state) * 2 - 1) * CALIBRATION_DISTORTION);
+        point.position = turned * 0.7f + MAP_SIZE * 0.5f + distortion;
+    }
+}
+
+// Scatter the landmarks over the map, some of them in clumps.
+
+static void scatterLandmarks(const BenchmarkOptions& options, unsigned int* state, vector<MapPoint>* positions)
+{
+    vector<MapPoint> hotSpots(HOT_SPOT_COUNT);
+    for (unsigned int i = 0; i < HOT_SPOT_COUNT; i++)
+    {
+        hotSpots[i] = MapPoint(getRandom(state) * MAP_SIZE.x, getRandom(state) * MAP_SIZE.y);
+    }
+
+    positions->resize(options.landmarkCount);
+    for (unsigned int i = 0; i < options.landmarkCount; i++)
+    {
+        MapPoint position;
+        if (getRandom(state) < CLUSTERED_FRACTION)
+        {
+            // A normal distribution around the spot, made with the Box-Muller transform.
+            float radius = sqrtf(-2 * logf(max(getRandom(state), 1e-6f))) * MAP_SIZE.x * 0.03f;
+            float angle = getRandom(state) * 6.2831853f;
+            position = hotSpots[i % HOT_SPOT_COUNT] + MapPoint(cosf(angle), sinf(angle)) * radius;
+        }
+        else
+        {
+            position = MapPoint(getRandom(state) * MAP_SIZE.x, getRandom(state) * MAP_SIZE.y);
+        }
+
+        (*positions)[i] = MapPoint(min(max(position.x, 0.0f), MAP_SIZE.x), min(max(position.y, 0.0f), MAP_SIZE.y));
+    }
+}
+
+// Find the nearest landmarks by testing every one of them, to check the tree's results against.
+
+static void findNearestDirectly(const vector<MapPoint>& positions, const MapPoint& point, unsigned int count, float radius, vector<float>* distances)
+{
+    distances->clear();
+    for (unsigned int i = 0; i < positions.size(); i++)
+    {
+        float distanceSquared = positions[i].distanceSquared(point);
+        if (distanceSquared <= radius * radius)
+        {
+            distances->push_back(distanceSquared);
+        }
+    }
+
+    sort(distances->begin(), distances->end());
+    distances->resize(min((unsigned int)distances->size(), count));
+}
+
+// Get a percentile of a sorted list of times using the nearest rank.
+
+static double getPercentile(const vector<double>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)ceil(percentile / 100.0 * sortedTimes.size());
+    return sortedTimes[min(max(rank, (size_t)1), sortedTimes.size()) - 1];
+}
+
+// Print the percentiles of a list of times.
+
+static void printPercentiles(const char* label, vector<double>& times)
+{
+    sort(times.begin(), times.end());
+    printf("  %-20s p50 %8.2f   p90 %8.2f   p99 %8.2f   max %8.2f\n", label,
+           getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 99), getPercentile(times, 100));
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-n landmarks] [-u updates] [-k count] [-r metres] [-s seed]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    options.landmarkCount = 100000;
+    options.updateCount = 10000;
+    options.count = 10;
+    options.radius = 500;
+    options.seed = 1;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:u:k:r:s:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                options.landmarkCount = (unsigned int)atoi(optarg);
+                if (options.landmarkCount == 0) printUsage(argv[0]);
+                break;
+            case 'u':
+                options.updateCount = (unsigned int)atoi(optarg);
+                if (options.updateCount == 0) printUsage(argv[0]);
+                break;
+            case 'k':
+                options.count = (unsigned int)atoi(optarg);
+                if (options.count == 0) printUsage(argv[0]);
+                break;
+            case 'r':
+                options.radius = (float)atof(optarg);
+                if (!(options.radius > 0)) printUsage(argv[0]);
+                break;
+            case 's':
+                options.seed = (unsigned int)atoi(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    unsigned int state = options.seed;
+    vector<MapCalibrationPoint> calibration;
+    makeCalibration(&state, &calibration);
+    vector<MapPoint> positions;
+    scatterLandmarks(options, &state, &positions);
+
+    // Startup: calibrating the map and indexing the landmarks, which the app does before the first location update.
+    double before = getMicroseconds();
+    MapProjection projection;
+    if (!projection.calibrate(&calibration[0], calibration.size()))
+    {
+        fprintf(stderr, "error: could not calibrate the map\n");
+        return 1;
+    }
+    double calibrateTime = getMicroseconds() - before;
+
+    before = getMicroseconds();
+    LandmarkKDTree tree;
+    tree.build(positions);
+    double buildTime = getMicroseconds() - before;
+
+    // Walk around the city, turning a little at each step and turning back at its edges.
+    GeoPoint location((CITY_SOUTH_WEST.latitude + CITY_NORTH_EAST.latitude) / 2, (CITY_SOUTH_WEST.longitude + CITY_NORTH_EAST.longitude) / 2);
+    double heading = 0;
+    double metresPerDegree = MapProjection::EARTH_RADIUS * 3.14159265358979 / 180;
+    float mapRadius = options.radius * projection.getUnitsPerMetre();
+
+    vector<double> projectTimes, nearestTimes, radiusTimes;
+    vector<unsigned int> nearest, inRadius;
+    vector<float> expected;
+    unsigned int mismatches = 0;
+    unsigned long foundTotal = 0, inRadiusTotal = 0;
+
+    for (unsigned int i = 0; i < options.updateCount; i++)
+    {
+        heading += (getRandom(&state) * 2 - 1) * 0.5;
+        location.latitude += cos(heading) * WALK_STEP / metresPerDegree;
+        location.longitude += sin(heading) * WALK_STEP / (metresPerDegree * cos(location.latitude * 3.14159265358979 / 180));
+        if (location.latitude < CITY_SOUTH_WEST.latitude || location.latitude > CITY_NORTH_EAST.latitude ||
+            location.longitude < CITY_SOUTH_WEST.longitude || location.longitude > CITY_NORTH_EAST.longitude)
+        {
+            heading += 3.14159265358979;
+        }
+
+        before = getMicroseconds();
+        MapPoint point = projection.project(location);
+        projectTimes.push_back(getMicroseconds() - before);
+
+        before = getMicroseconds();
+        tree.findNearest(point, options.count, mapRadius, &nearest);
+        nearestTimes.push_back(getMicroseconds() - before);
+
+        inRadius.clear();
+        before = getMicroseconds();
+        tree.findInRadius(point, mapRadius, &inRadius);
+        radiusTimes.push_back(getMicroseconds() - before);
+
+        foundTotal += nearest.size();
+        inRadiusTotal += inRadius.size();
+
+        // Compare distances rather than landmarks, since landmarks at the same distance can come in either order.
+        if (i < CHECKED_UPDATES)
+        {
+            findNearestDirectly(positions, point, options.count, mapRadius, &expected);
+            bool matches = (expected.size() == nearest.size()) && (inRadius.size() >= nearest.size());
+            for (unsigned int j = 0; matches && j < nearest.size(); j++)
+            {
+                matches = (positions[nearest[j]].distanceSquared(point) == expected[j]);
+            }
+            mismatches += matches ? 0 : 1;
+        }
+    }
+
+    printf("%u landmarks, %u location updates finding %u within %.0f m\n", options.landmarkCount, options.updateCount, options.count, options.radius);
+    printf("  startup:             %.3f ms to calibrate to %u points (%.0f m from uniform), %.2f ms to build the tree\n",
+           calibrateTime / 1000, (unsigned int)calibration.size(), projection.getError(), buildTime / 1000);
+    printPercentiles("project (us):", projectTimes);
+    printPercentiles("nearest (us):", nearestTimes);
+    printPercentiles("in radius (us):", radiusTimes);
+    printf("  found:               %.1f nearest and %.1f in the radius per update on average\n",
+           (double)foundTotal / options.updateCount, (double)inRadiusTotal / options.updateCount);
+    printf("  checked:             %u of the first %u updates differ from testing every landmark\n",
+           mismatches, min(options.updateCount, CHECKED_UPDATES));
+
+    return mismatches == 0 ? 0 : 1;
+}
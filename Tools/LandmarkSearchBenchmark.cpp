@@ -0,0 +1,394 @@
+//
+//  LandmarkSearchBenchmark.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which measures how landmark search scales with the size of the catalog, without a device or
+//  cocos2d. It makes up a synthetic set of landmark names and descriptions (with accented letters and punctuation, so
+//  that folding is exercised too), times writing their search index, writes it to a file and maps it back in as the app
+//  does, checking that the catalog checksum in its header survives the trip, then runs two kinds of query against it:
+//  typing landmark names one keystroke at a time, as the search popup does, and looking for a few words from a
+//  landmark's description in any order. It reports the query times as percentiles, along with how often the landmark
+//  being looked for was among the results, and fails if any name typed in full doesn't bring up its landmark first.
+//  Every name is different, since landmarks sharing a name can't be told apart by it.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Landmarks -o landmark_search_benchmark LandmarkSearchBenchmark.cpp
+//               ../Classes/Landmarks/LandmarkSearchIndex.cpp ../Classes/Landmarks/LandmarkSearchIndexWriter.cpp
+//
+//  Usage:   landmark_search_benchmark [options]
+//
+//      -n <count>      The number of landmarks. Defaults to 100000.
+//      -q <count>      The number of landmarks to search for with each kind of query. Defaults to 2000.
+//      -o <path>       Where to write the index. Defaults to "/tmp/landmark_search_benchmark.nyls".
+//      -s <seed>       The seed for making up the landmarks. Defaults to 1.
+//
+
+#include <algorithm>
+#include <math.h>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "LandmarkSearchIndex.h"
+#include "LandmarkSearchIndexWriter.h"
+
+using namespace std;
+
+// The number of results the search popup asks for.
+static const unsigned int MAX_RESULTS = 6;
+
+// The checksum written into the index in place of a real catalog's, which has to be read back unchanged.
+static const unsigned int CATALOG_CHECKSUM = 0x9E3779B9;
+
+// How many different words are made up for names and for descriptions, and how many words a description has.
+static const unsigned int NAME_WORD_COUNT = 4000;
+static const unsigned int DESCRIPTION_WORD_COUNT = 20000;
+static const unsigned int DESCRIPTION_LENGTH = 24;
+
+// How often a landmark has a long official name, and how many words it has, so that some names are longer than the trie's keys.
+static const float LONG_NAME_FRACTION = 0.01f;
+static const unsigned int LONG_NAME_WORD_COUNT = 10;
+
+// The syllables that words are made of, some of them accented.
+static const char* SYLLABLES[] =
+{
+    "ba", "be", "bro", "ca", "cha", "co", "da", "de", "di", "el", "en", "fa", "fé", "ga", "gu", "ha", "he", "is", "ja", "ka",
+    "la", "le", "li", "lo", "ma", "me", "mi", "mo", "na", "ne", "ni", "no", "or", "pa", "pe", "qu", "ra", "re", "ri", "ro",
+    "sa", "se", "si", "so", "ta", "te", "ti", "to", "un", "va", "ve", "wa", "we", "ya", "yo", "za", "zé", "ño", "ö", "ça"
+};
+
+// The kinds of place a name ends with.
+static const char* PLACE_TYPES[] =
+{
+    "Museum", "Park", "Church", "Café", "Theatre", "Gallery", "Square", "Tower", "Bridge", "Market", "Hall", "Garden",
+    "Library", "Pier", "Station", "Hotel", "Building", "Center", "Memorial", "Plaza"
+};
+
+/**
+ @brief     The command-line options.
+ */
+struct BenchmarkOptions
+{
+    unsigned int landmarkCount;
+    unsigned int queryCount;
+    const char* path;
+    unsigned int seed;
+};
+
+/**
+ @brief     A made-up landmark.
+ */
+struct SyntheticLandmark
+{
+    string name;
+    string description;
+
+    /** The indices of the words in the description, to build queries from. */
+    vector<unsigned int> descriptionWords;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the landmarks are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Get a random index below a count, favouring low indices the way common words are used more than rare ones.
+
+static unsigned int getSkewedIndex(unsigned int* state, unsigned int count)
+{
+    float random = getRandom(state);
+    return min((unsigned int)(random * random * random * count), count - 1);
+}
+
+// Make up a word from two to four syllables, capitalized or not.
+
+static string makeWord(unsigned int* state, bool capitalized)
+{
+    string word;
+    unsigned int syllables = 2 + (unsigned int)(getRandom(state) * 3);
+    for (unsigned int i = 0; i < syllables; i++)
+    {
+        word += SYLLABLES[(unsigned int)(getRandom(state) * (sizeof(SYLLABLES) / sizeof(SYLLABLES[0])))];
+    }
+
+    if (capitalized && word[0] >= 'a' && word[0] <= 'z')
+    {
+        word[0] += 'A' - 'a';
+    }
+    return word;
+}
+
+// Make up the landmarks.
+
+static void makeLandmarks(const BenchmarkOptions& options, vector<SyntheticLandmark>* landmarks)
+{
+    unsigned int state = options.seed;
+
+    vector<string> nameWords(NAME_WORD_COUNT);
+    for (unsigned int i = 0; i < NAME_WORD_COUNT; i++)
+    {
+        nameWords[i] = makeWord(&state, true);
+    }
+
+    vector<string> descriptionWords(DESCRIPTION_WORD_COUNT);
+    for (unsigned int i = 0; i < DESCRIPTION_WORD_COUNT; i++)
+    {
+        descriptionWords[i] = makeWord(&state, false);
+    }
+
+    set<string> foldedNames;
+    landmarks->resize(options.landmarkCount);
+    for (unsigned int i = 0; i < options.landmarkCount; i++)
+    {
+        // Names like "Bromela Café" or "St. Lirano's Hall", made up again until they differ from the names before once folded.
+        SyntheticLandmark& landmark = (*landmarks)[i];
+        string folded;
+        do
+        {
+            landmark.name.clear();
+            if (getRandom(&state) < 0.1f)
+            {
+                landmark.name = "St. ";
+            }
+
+            unsigned int nameLength = (getRandom(&state) < LONG_NAME_FRACTION) ? LONG_NAME_WORD_COUNT : 1 + (unsigned int)(getRandom(&state) * 2);
+            for (unsigned int j = 0; j < nameLength; j++)
+            {
+                landmark.name += nameWords[getSkewedIndex(&state, NAME_WORD_COUNT)];
+                landmark.name += (j + 1 < nameLength) ? " " : "";
+            }
+            if (getRandom(&state) < 0.2f)
+            {
+                landmark.name += "'s";
+            }
+            landmark.name += " ";
+            landmark.name += PLACE_TYPES[(unsigned int)(getRandom(&state) * (sizeof(PLACE_TYPES) / sizeof(PLACE_TYPES[0])))];
+            LandmarkSearchIndex::fold(landmark.name.c_str(), &folded, NULL);
+        }
+        while (!foldedNames.insert(folded).second);
+
+        landmark.description.clear();
+        landmark.descriptionWords.clear();
+        for (unsigned int j = 0; j < DESCRIPTION_LENGTH; j++)
+        {
+            unsigned int word = getSkewedIndex(&state, DESCRIPTION_WORD_COUNT);
+            landmark.descriptionWords.push_back(word);
+            landmark.description += descriptionWords[word];
+            landmark.description += (j % 8 == 7) ? ". " : " ";
+        }
+    }
+}
+
+// Get a percentile of a sorted list of times using the nearest rank.
+
+static double getPercentile(const vector<double>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)ceil(percentile / 100.0 * sortedTimes.size());
+    return sortedTimes[min(max(rank, (size_t)1), sortedTimes.size()) - 1];
+}
+
+// Print the percentiles of a list of times.
+
+static void printPercentiles(const char* label, vector<double>& times)
+{
+    sort(times.begin(), times.end());
+    printf("  %-20s p50 %8.2f   p90 %8.2f   p99 %8.2f   max %8.2f\n", label,
+           getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 99), getPercentile(times, 100));
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-n landmarks] [-q queries] [-o path] [-s seed]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    options.landmarkCount = 100000;
+    options.queryCount = 2000;
+    options.path = "/tmp/landmark_search_benchmark.nyls";
+    options.seed = 1;
+
+    int option;
+    while ((option = getopt(argc, argv, "n:q:o:s:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                options.landmarkCount = (unsigned int)atoi(optarg);
+                if (options.landmarkCount == 0) printUsage(argv[0]);
+                break;
+            case 'q':
+                options.queryCount = (unsigned int)atoi(optarg);
+                if (options.queryCount == 0) printUsage(argv[0]);
+                break;
+            case 'o':
+                options.path = optarg;
+                break;
+            case 's':
+                options.seed = (unsigned int)atoi(optarg);
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    vector<SyntheticLandmark> landmarks;
+    makeLandmarks(options, &landmarks);
+
+    // Offline: write the index and save it.
+    double before = getMicroseconds();
+    LandmarkSearchIndexWriter writer;
+    for (unsigned int i = 0; i < landmarks.size(); i++)
+    {
+        writer.add(landmarks[i].name.c_str(), landmarks[i].description.c_str());
+    }
+    vector<unsigned char> data;
+    writer.setCatalogChecksum(CATALOG_CHECKSUM);
+    writer.write(&data);
+    double writeTime = getMicroseconds() - before;
+
+    FILE* file = fopen(options.path, "wb");
+    if (!file || fwrite(&data[0], 1, data.size(), file) != data.size())
+    {
+        fprintf(stderr, "error: could not write \"%s\"\n", options.path);
+        return 1;
+    }
+    fclose(file);
+
+    // Startup: mapping the index, which is all the app does before its first search.
+    before = getMicroseconds();
+    LandmarkSearchIndex index;
+    if (!index.open(options.path))
+    {
+        fprintf(stderr, "error: could not read \"%s\" back\n", options.path);
+        return 1;
+    }
+    double openTime = getMicroseconds() - before;
+
+    // The app only uses a shipped index if it was built for the same catalog, which it tells from the header.
+    if (index.getCount() != landmarks.size() || index.getCatalogChecksum() != CATALOG_CHECKSUM)
+    {
+        fprintf(stderr, "error: the landmark count or catalog checksum read back from \"%s\" doesn't match the one written\n", options.path);
+        return 1;
+    }
+
+    // Type the names of random landmarks one keystroke at a time, and check that each comes first once it is typed in full.
+    unsigned int state = options.seed * 7919 + 1;
+    vector<double> keystrokeTimes;
+    unsigned int namesFound = 0;
+    unsigned int namesFirst = 0;
+    LandmarkID results[MAX_RESULTS];
+
+    for (unsigned int i = 0; i < options.queryCount; i++)
+    {
+        LandmarkID target = (LandmarkID)(getRandom(&state) * landmarks.size());
+        const string& name = landmarks[target].name;
+        unsigned int resultCount = 0;
+
+        for (unsigned int length = 1; length <= name.size(); length++)
+        {
+            // Skip the middle of multi-byte characters, which can't be typed on their own.
+            if (length < name.size() && (name[length] & 0xC0) == 0x80)
+            {
+                continue;
+            }
+
+            string query = name.substr(0, length);
+            before = getMicroseconds();
+            resultCount = index.search(query.c_str(), results, MAX_RESULTS);
+            keystrokeTimes.push_back(getMicroseconds() - before);
+        }
+
+        if (find(results, results + resultCount, target) != results + resultCount)
+        {
+            namesFound++;
+        }
+        if (resultCount > 0 && results[0] == target)
+        {
+            namesFirst++;
+        }
+        else
+        {
+            fprintf(stderr, "error: \"%s\" doesn't come first when typed in full\n", name.c_str());
+        }
+    }
+
+    // Look for three words from random landmarks' descriptions, in any order, with the last one half typed.
+    vector<double> wordTimes;
+    unsigned int descriptionsFound = 0;
+
+    for (unsigned int i = 0; i < options.queryCount; i++)
+    {
+        LandmarkID target = (LandmarkID)(getRandom(&state) * landmarks.size());
+        const SyntheticLandmark& landmark = landmarks[target];
+
+        string query;
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            unsigned int word = (unsigned int)(getRandom(&state) * landmark.descriptionWords.size());
+            string text = landmark.description;
+
+            // Find the word's text by splitting the description again, since its words were appended in order.
+            unsigned int start = 0;
+            for (unsigned int k = 0; k < word; k++)
+            {
+                start = text.find(' ', start) + 1;
+            }
+            string wordText = text.substr(start, text.find_first_of(". ", start) - start);
+            query += (j < 2) ? wordText + " " : wordText.substr(0, max((size_t)2, wordText.size() / 2));
+        }
+
+        before = getMicroseconds();
+        unsigned int resultCount = index.search(query.c_str(), results, MAX_RESULTS);
+        wordTimes.push_back(getMicroseconds() - before);
+
+        if (find(results, results + resultCount, target) != results + resultCount)
+        {
+            descriptionsFound++;
+        }
+    }
+
+    printf("%u landmarks\n", options.landmarkCount);
+    printf("  offline:             %.2f ms to write the index, %.2f MB\n", writeTime / 1000, data.size() / 1048576.0);
+    printf("  startup:             %.3f ms to map the index\n", openTime / 1000);
+    printPercentiles("keystroke (us):", keystrokeTimes);
+    printPercentiles("any words (us):", wordTimes);
+    printf("  found:               %u of %u names typed in full (%u first), %u of %u by description\n",
+           namesFound, options.queryCount, namesFirst, descriptionsFound, options.queryCount);
+    printf("  (a description can be missed when more than %u landmarks match it)\n", MAX_RESULTS);
+
+    unlink(options.path);
+    if (namesFirst != options.queryCount)
+    {
+        fprintf(stderr, "error: %u of %u names typed in full didn't come first\n", options.queryCount - namesFirst, options.queryCount);
+        return 1;
+    }
+
+    printf("All checks passed.\n");
+    return 0;
+}
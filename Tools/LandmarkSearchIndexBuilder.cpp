@@ -0,0 +1,95 @@
+//
+//  LandmarkSearchIndexBuilder.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which builds the search index memory-mapped by LandmarkSearchIndex (see
+//  Classes/Landmarks/LandmarkSearchIndex.h), ie. "landmarks.nyls", from a landmark catalog built by LandmarkCatalogBuilder.
+//  The index refers to landmarks by their order in the catalog, so it has to be rebuilt whenever the catalog is, and
+//  shipped (or downloaded) alongside it. It holds a checksum of the catalog it was built from, and the app builds the
+//  index itself if it is missing or its checksum doesn't match the catalog's, so shipping it only saves that work at
+//  startup.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Landmarks -o landmark_search_index_builder LandmarkSearchIndexBuilder.cpp
+//               ../Classes/Landmarks/LandmarkCatalog.cpp ../Classes/Landmarks/LandmarkSearchIndex.cpp
+//               ../Classes/Landmarks/LandmarkSearchIndexWriter.cpp
+//
+//  Usage:   landmark_search_index_builder <catalog.nylc> <output.nyls> [query...]
+//
+//  Any queries given after the output are run against the new index, listing the landmarks they find, as a quick check.
+//
+//  The index shipped with the app is built from Resources/landmarks/landmarks.nylc:
+//
+//      landmark_search_index_builder ../Resources/landmarks/landmarks.nylc ../Resources/landmarks/landmarks.nyls
+//
+
+#include <stdio.h>
+#include <vector>
+#include "LandmarkCatalog.h"
+#include "LandmarkSearchIndex.h"
+#include "LandmarkSearchIndexWriter.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <catalog.nylc> <output.nyls> [query...]\n", argv[0]);
+        return 1;
+    }
+
+    LandmarkCatalog catalog;
+    if (!catalog.open(argv[1]))
+    {
+        fprintf(stderr, "error: \"%s\" is not a valid landmark catalog\n", argv[1]);
+        return 1;
+    }
+
+    // Index every landmark in catalog order, which is the order of their IDs once they are in the app's LandmarkStore.
+    LandmarkSearchIndexWriter writer;
+    for (unsigned int i = 0; i < catalog.getCount(); i++)
+    {
+        Landmark landmark = catalog.getLandmark(i);
+        writer.add(landmark.name, landmark.description);
+    }
+
+    // The checksum lets the app tell whether the index still matches the catalog it is shipped with, even if the number of landmarks hasn't changed.
+    vector<unsigned char> output;
+    writer.setCatalogChecksum(catalog.getChecksum());
+    writer.write(&output);
+
+    FILE* destination = fopen(argv[2], "wb");
+    if (!destination || fwrite(&output[0], 1, output.size(), destination) != output.size())
+    {
+        fprintf(stderr, "error: could not write \"%s\"\n", argv[2]);
+        return 1;
+    }
+    fclose(destination);
+
+    printf("Wrote the search index for %u landmarks to \"%s\": %lu bytes.\n", writer.getCount(), argv[2], (unsigned long)output.size());
+
+    // Run any queries against the written file, the same way the app will read it.
+    LandmarkSearchIndex index;
+    if (argc > 3 && !index.open(argv[2]))
+    {
+        fprintf(stderr, "error: could not read \"%s\" back\n", argv[2]);
+        return 1;
+    }
+
+    for (int i = 3; i < argc; i++)
+    {
+        LandmarkID results[LandmarkSearchIndex::MAX_NODE_HITS];
+        unsigned int resultCount = index.search(argv[i], results, LandmarkSearchIndex::MAX_NODE_HITS);
+
+        printf("\"%s\":\n", argv[i]);
+        for (unsigned int j = 0; j < resultCount; j++)
+        {
+            const char* name = (results[j] < catalog.getCount()) ? catalog.getLandmark(results[j]).name : NULL;
+            printf("    %u  %s\n", results[j], name ? name : "(unknown)");
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,462 @@
+//
+//  MapControllerCheck.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-28.
+//
+//  A command-line tool which checks that MapController's fixed-step simulation is deterministic, without a device or
+//  cocos2d. It makes up gestures with irregular touch timing (a fling, a drag past the edge of the map, pinches past both
+//  scale limits, a pinch which becomes a pan when one finger lifts first and a flight caught by a touch), replays each of
+//  them twice and checks that every frame of the second replay has exactly the same transform as the first. It also
+//  replays each gesture at several frame rates, and with frames drawn at irregular intervals, and checks that the map
+//  comes to rest at exactly the same transform every time and inside its limits. Frames go through
+//  MapController::updateFrame(...) as Map::update(...) does, and it checks that each frame applies the transform at most
+//  once however many touch samples arrived before it, that no samples are left undisplayed and that frames where nothing
+//  moved don't apply it at all. It prints each check and fails if any of them does.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -o map_controller_check MapControllerCheck.cpp
+//               ../Classes/Map/MapController.cpp ../Classes/Map/TouchPredictor.cpp
+//
+//  Usage:   map_controller_check [-s <seed>]
+//
+//      -s <seed>       The seed for the touches' timing and the irregular frames. Defaults to 1.
+//
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "GestureRecording.h"
+#include "MapController.h"
+
+using namespace std;
+
+// The view and map the gestures are made for, sized like an iPad's screen and the map of Manhattan.
+static const MapPoint VIEW_SIZE(1024, 768);
+static const MapPoint CONTENT_SIZE(2048, 4096);
+static const float MIN_SCALE = 0.5f;
+static const float MAX_SCALE = 2.5f;
+
+// How long the map is allowed to keep moving after the last event before the replay gives up on it coming to rest.
+static const double MAX_SETTLE_TIME = 10.0;
+
+// The number of frames drawn once the map has come to rest, which have nothing to apply.
+static const unsigned int REST_FRAME_COUNT = 30;
+
+// The frame rates each gesture is replayed at, in frames per second, and the range of intervals between irregular frames in seconds.
+static const double FRAME_RATES[] = { 30, 60, 120 };
+static const double MIN_IRREGULAR_INTERVAL = 0.004;
+static const double MAX_IRREGULAR_INTERVAL = 0.050;
+
+// How far outside its limits the map may come to rest, to allow for rounding.
+static const float LIMIT_TOLERANCE = 0.01f;
+
+// The number of checks which failed, and the number of frames checked which more than one touch sample arrived before.
+static unsigned int s_Failures = 0;
+static unsigned int s_BusyFrames = 0;
+
+/**
+ @brief     A made-up gesture, along with a flight which starts before it if it is meant to catch one.
+ */
+struct CheckGesture
+{
+    string name;
+    MapTransform start;
+    vector<GestureEvent> events;
+    bool flies;
+    MapPoint flightCenter;
+    float flightScale;
+};
+
+/**
+ @brief     How often frames are drawn during a replay: at a steady rate, or at random intervals if the rate is 0.
+ */
+struct FrameTiming
+{
+    double rate;
+    unsigned int seed;
+};
+
+/**
+ @brief     The work done by the frames of a replay.
+ */
+struct FrameWork
+{
+    FrameWork() : maxUpdatesPerFrame(0), maxSamplesPerFrame(0), busyFrames(0), missedFrames(0), idleUpdates(0) { }
+
+    /** The same counts that Map reports. */
+    MapFrameStats stats;
+
+    /** The most times the transform was applied in one frame, and the most touch samples which arrived before one frame. */
+    unsigned int maxUpdatesPerFrame;
+    unsigned int maxSamplesPerFrame;
+
+    /** The number of frames which more than one touch sample arrived before. */
+    unsigned int busyFrames;
+
+    /** The number of frames which touch samples arrived before but which didn't apply the transform, leaving them undisplayed. */
+    unsigned int missedFrames;
+
+    /** The number of frames which applied the transform even though nothing had moved the map. */
+    unsigned int idleUpdates;
+};
+
+// Print the outcome of a check, and count it if it failed.
+
+static void check(bool passed, const char* description)
+{
+    printf("%-6s %s\n", passed ? "ok" : "FAILED", description);
+    if (!passed)
+    {
+        s_Failures++;
+    }
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the gestures are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Add an event to a gesture.
+
+static void addEvent(CheckGesture* gesture, GestureEventKind kind, double time, int touchID, const MapPoint& location)
+{
+    GestureEvent event;
+    event.kind = kind;
+    event.time = time;
+    event.touchID = touchID;
+    event.location = location;
+    gesture->events.push_back(event);
+}
+
+// Move one touch in a straight line, with samples arriving every 4 to 16 milliseconds as they do on a real device. The touch begins and ends at the ends of the line if asked to.
+
+static double addStroke(CheckGesture* gesture, int touchID, const MapPoint& from, const MapPoint& to, double startTime, double duration,
+                        bool begins, bool ends, unsigned int* state)
+{
+    if (begins)
+    {
+        addEvent(gesture, kGestureEventBegan, startTime, touchID, from);
+    }
+
+    double time = startTime;
+    while (true)
+    {
+        time += 0.004 + getRandom(state) * 0.012;
+        float progress = (float)min((time - startTime) / duration, 1.0);
+        MapPoint location = from + (to - from) * progress;
+        addEvent(gesture, (ends && progress >= 1) ? kGestureEventEnded : kGestureEventMoved, time, touchID, location);
+        if (progress >= 1)
+        {
+            return time;
+        }
+    }
+}
+
+// Move two touches at once, interleaving their samples, with both starting at the same time.
+
+static double addPinch(CheckGesture* gesture, const MapPoint& from0, const MapPoint& to0, const MapPoint& from1, const MapPoint& to1,
+                       double startTime, double duration, bool begins, bool ends, unsigned int* state)
+{
+    if (begins)
+    {
+        addEvent(gesture, kGestureEventBegan, startTime, 0, from0);
+        addEvent(gesture, kGestureEventBegan, startTime + 0.003, 1, from1);
+    }
+
+    double time = startTime + 0.003;
+    while (true)
+    {
+        time += 0.004 + getRandom(state) * 0.012;
+        float progress = (float)min((time - startTime) / duration, 1.0);
+        GestureEventKind kind = (ends && progress >= 1) ? kGestureEventEnded : kGestureEventMoved;
+        addEvent(gesture, kind, time, 0, from0 + (to0 - from0) * progress);
+        addEvent(gesture, kind, time + 0.001, 1, from1 + (to1 - from1) * progress);
+        if (progress >= 1)
+        {
+            return time + 0.001;
+        }
+    }
+}
+
+// Make the gestures to check.
+
+static void makeGestures(unsigned int seed, vector<CheckGesture>* gestures)
+{
+    unsigned int state = seed;
+    MapPoint middle = VIEW_SIZE * 0.5f;
+
+    CheckGesture gesture;
+    gesture.flies = false;
+    gesture.flightScale = 1;
+    gesture.start.scale = 1;
+    gesture.start.offset = MapPoint(-512, -1664);
+
+    // A quick flick, which lets go while the touch is still moving and leaves the map coasting.
+    gesture.name = "fling";
+    gesture.events.clear();
+    addStroke(&gesture, 0, middle, middle + MapPoint(-300, 200), 0, 0.12, true, true, &state);
+    gestures->push_back(gesture);
+
+    // A slow drag a long way past the left edge of the map, which has to spring back once it is let go.
+    gesture.name = "drag past the edge";
+    gesture.events.clear();
+    gesture.start.offset = MapPoint(-100, -1664);
+    addStroke(&gesture, 0, MapPoint(100, 400), MapPoint(900, 450), 0, 1.0, true, true, &state);
+    gestures->push_back(gesture);
+
+    // Pinches past the largest and smallest scales, which spring back to them.
+    gesture.name = "pinch past the largest scale";
+    gesture.events.clear();
+    gesture.start.scale = 2;
+    gesture.start.offset = middle - CONTENT_SIZE * 0.5f * gesture.start.scale;
+    addPinch(&gesture, middle - MapPoint(50, 0), middle - MapPoint(400, 0), middle + MapPoint(50, 0), middle + MapPoint(400, 0),
+             0, 0.4, true, true, &state);
+    gestures->push_back(gesture);
+
+    gesture.name = "pinch past the smallest scale";
+    gesture.events.clear();
+    gesture.start.scale = 0.6f;
+    gesture.start.offset = middle - CONTENT_SIZE * 0.5f * gesture.start.scale;
+    addPinch(&gesture, middle - MapPoint(400, 100), middle - MapPoint(40, 10), middle + MapPoint(400, 100), middle + MapPoint(40, 10),
+             0, 0.3, true, true, &state);
+    gestures->push_back(gesture);
+
+    // A pinch which becomes a pan when one finger lifts first, then a fling with the finger that is left.
+    gesture.name = "pinch then pan";
+    gesture.events.clear();
+    gesture.start.scale = 1;
+    gesture.start.offset = middle - CONTENT_SIZE * 0.5f;
+    double time = addPinch(&gesture, middle - MapPoint(100, 0), middle - MapPoint(250, 50), middle + MapPoint(100, 0), middle + MapPoint(250, 50),
+                           0, 0.25, true, false, &state);
+    addEvent(&gesture, kGestureEventEnded, time + 0.002, 1, middle + MapPoint(250, 50));
+    addStroke(&gesture, 0, middle - MapPoint(250, 50), middle + MapPoint(0, 150), time + 0.002, 0.1, false, true, &state);
+    gestures->push_back(gesture);
+
+    // A flight towards the top of the map, caught part way by a touch which drags it a little and lets go.
+    gesture.name = "flight caught by a touch";
+    gesture.events.clear();
+    gesture.flies = true;
+    gesture.flightCenter = MapPoint(1500, 3500);
+    gesture.flightScale = 2;
+    addStroke(&gesture, 0, middle, middle + MapPoint(60, -40), 0.35, 0.2, true, true, &state);
+    gestures->push_back(gesture);
+}
+
+// Replay a gesture, interleaving its events with frames in the order the app would see them, and keep the transform displayed by every frame. The transform is only applied when MapController::updateFrame(...) says it has changed, as Map::update(...) does, and the work each frame did is counted.
+
+static void replay(const CheckGesture& gesture, const FrameTiming& timing, bool predict, vector<MapTransform>* frames, FrameWork* work)
+{
+    const vector<GestureEvent>& events = gesture.events;
+    double endTime = events.back().time;
+
+    MapController controller;
+    controller.reset(VIEW_SIZE, CONTENT_SIZE, MIN_SCALE, MAX_SCALE, gesture.start, 0);
+    controller.setPrediction(predict, 1 / 60.0);
+    if (gesture.flies)
+    {
+        controller.flyTo(gesture.flightCenter, gesture.flightScale, 0.8, 0);
+    }
+
+    unsigned int state = timing.seed;
+    double frameTime = 0;
+    unsigned int eventIt = 0;
+    MapTransform displayed = gesture.start;
+    frames->clear();
+    *work = FrameWork();
+
+    // Keep drawing frames after the last event for as long as the map coasts or springs back, and for a while after it comes to rest.
+    unsigned int restFrames = 0;
+    while (restFrames < REST_FRAME_COUNT)
+    {
+        if (eventIt >= events.size() && (!controller.isAnimating() || frameTime >= endTime + MAX_SETTLE_TIME))
+        {
+            restFrames++;
+        }
+
+        double interval = (timing.rate > 0) ? 1 / timing.rate : MIN_IRREGULAR_INTERVAL + getRandom(&state) * (MAX_IRREGULAR_INTERVAL - MIN_IRREGULAR_INTERVAL);
+        frameTime += interval;
+
+        unsigned int samples = 0;
+        while (eventIt < events.size() && events[eventIt].time <= frameTime)
+        {
+            const GestureEvent& event = events[eventIt++];
+            switch (event.kind)
+            {
+                case kGestureEventBegan: controller.touchBegan(event.touchID, event.location, event.time); break;
+                case kGestureEventMoved: controller.touchMoved(event.touchID, event.location, event.time); break;
+                case kGestureEventEnded: controller.touchEnded(event.touchID, event.location, event.time); break;
+            }
+            samples++;
+        }
+
+        bool isMoving = controller.isAnimating() || (predict && controller.getTouchCount() > 0);
+        unsigned int updates = 0;
+        if (controller.updateFrame(frameTime))
+        {
+            displayed = controller.getTransform();
+            updates++;
+        }
+
+        work->stats.frames++;
+        work->stats.touchSamples += samples;
+        work->stats.transformUpdates += updates;
+        work->maxUpdatesPerFrame = max(work->maxUpdatesPerFrame, updates);
+        work->maxSamplesPerFrame = max(work->maxSamplesPerFrame, samples);
+        if (samples > 1) work->busyFrames++;
+        if (samples > 0 && updates == 0) work->missedFrames++;
+        if (samples == 0 && !isMoving && updates > 0) work->idleUpdates++;
+
+        frames->push_back(displayed);
+    }
+}
+
+// Check whether two transforms are exactly the same.
+
+static bool isSameTransform(const MapTransform& a, const MapTransform& b)
+{
+    return a.offset == b.offset && a.scale == b.scale;
+}
+
+// Check whether two replays displayed exactly the same frames.
+
+static bool isSameReplay(const vector<MapTransform>& a, const vector<MapTransform>& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (unsigned int i = 0; i < a.size(); i++)
+    {
+        if (!isSameTransform(a[i], b[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check whether a transform is one the map may come to rest at.
+
+static bool isInsideLimits(const MapTransform& transform)
+{
+    float minX, maxX, minY, maxY;
+    MapController::getOffsetLimits(VIEW_SIZE.x, CONTENT_SIZE.x, transform.scale, &minX, &maxX);
+    MapController::getOffsetLimits(VIEW_SIZE.y, CONTENT_SIZE.y, transform.scale, &minY, &maxY);
+    return transform.scale >= MIN_SCALE * (1 - LIMIT_TOLERANCE) && transform.scale <= MAX_SCALE * (1 + LIMIT_TOLERANCE) &&
+           transform.offset.x >= minX - LIMIT_TOLERANCE && transform.offset.x <= maxX + LIMIT_TOLERANCE &&
+           transform.offset.y >= minY - LIMIT_TOLERANCE && transform.offset.y <= maxY + LIMIT_TOLERANCE;
+}
+
+// Replay a gesture in every way and check the results.
+
+static void checkGesture(const CheckGesture& gesture, unsigned int seed)
+{
+    char description[256];
+    vector<MapTransform> first;
+    vector<MapTransform> second;
+    FrameWork work;
+
+    // Replaying the same touches with the same frames has to display exactly the same thing, frame for frame.
+    for (int predict = 0; predict < 2; predict++)
+    {
+        FrameTiming timing = { 60, seed };
+        replay(gesture, timing, predict != 0, &first, &work);
+        replay(gesture, timing, predict != 0, &second, &work);
+        snprintf(description, sizeof(description), "%s: replaying twice at 60 Hz with prediction %s displays the same %u frames",
+                 gesture.name.c_str(), predict ? "on" : "off", (unsigned int)first.size());
+        check(isSameReplay(first, second), description);
+
+        timing.rate = 0;
+        replay(gesture, timing, predict != 0, &first, &work);
+        replay(gesture, timing, predict != 0, &second, &work);
+        snprintf(description, sizeof(description), "%s: replaying twice at irregular intervals with prediction %s displays the same %u frames",
+                 gesture.name.c_str(), predict ? "on" : "off", (unsigned int)first.size());
+        check(isSameReplay(first, second), description);
+    }
+
+    // The motion only depends on the touches' timestamps, so however often frames are drawn the map has to come to rest in the same place.
+    FrameTiming timing = { 60, seed };
+    vector<MapTransform> reference;
+    replay(gesture, timing, false, &reference, &work);
+    const MapTransform& rest = reference.back();
+
+    bool sameRest = true;
+    for (unsigned int i = 0; i <= sizeof(FRAME_RATES) / sizeof(FRAME_RATES[0]); i++)
+    {
+        timing.rate = (i < sizeof(FRAME_RATES) / sizeof(FRAME_RATES[0])) ? FRAME_RATES[i] : 0;
+        for (int predict = 0; predict < 2; predict++)
+        {
+            replay(gesture, timing, predict != 0, &first, &work);
+            if (!isSameTransform(first.back(), rest))
+            {
+                printf("       came to rest at offset %.4f,%.4f scale %.6f at %g Hz with prediction %s, rather than offset %.4f,%.4f scale %.6f\n",
+                       first.back().offset.x, first.back().offset.y, first.back().scale, timing.rate, predict ? "on" : "off",
+                       rest.offset.x, rest.offset.y, rest.scale);
+                sameRest = false;
+            }
+        }
+    }
+    snprintf(description, sizeof(description), "%s: comes to rest at the same transform at 30, 60 and 120 Hz and irregular intervals", gesture.name.c_str());
+    check(sameRest, description);
+
+    snprintf(description, sizeof(description), "%s: comes to rest inside the limits (offset %.1f,%.1f scale %.3f)",
+             gesture.name.c_str(), rest.offset.x, rest.offset.y, rest.scale);
+    check(isInsideLimits(rest), description);
+
+    // However many touch samples arrive before a frame, the transform is applied at most once by it, and not at all if nothing moved the map.
+    for (int predict = 0; predict < 2; predict++)
+    {
+        timing.rate = 60;
+        replay(gesture, timing, predict != 0, &first, &work);
+        snprintf(description, sizeof(description), "%s: %u touch samples (up to %u, and more than one before %u frames) applied by %u of %u frames at 60 Hz with prediction %s",
+                 gesture.name.c_str(), work.stats.touchSamples, work.maxSamplesPerFrame, work.busyFrames, work.stats.transformUpdates, work.stats.frames, predict ? "on" : "off");
+        check(work.maxUpdatesPerFrame <= 1 && work.stats.transformUpdates <= work.stats.frames && work.missedFrames == 0 && work.idleUpdates == 0, description);
+        s_BusyFrames += work.busyFrames;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int seed = 1;
+
+    int option;
+    while ((option = getopt(argc, argv, "s:")) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-s <seed>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    vector<CheckGesture> gestures;
+    makeGestures(seed, &gestures);
+    for (unsigned int i = 0; i < gestures.size(); i++)
+    {
+        checkGesture(gestures[i], seed);
+    }
+
+    // The check of the updates per frame means nothing unless some frames had several touch samples to apply.
+    check(s_BusyFrames > 0, "several touch samples arrived before some of the frames");
+
+    if (s_Failures > 0)
+    {
+        printf("%u checks failed.\n", s_Failures);
+        return 1;
+    }
+
+    printf("All checks passed.\n");
+    return 0;
+}
@@ -0,0 +1,408 @@
+//
+//  StreetDataBuilder.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which converts a CSV file of street segments into the street data memory-mapped by StreetData
+//  (see Classes/Streets/StreetData.h), ie. "streets.nyst", which the map uses to find the address of any point the user
+//  taps, and the location of any address they search for, without a network connection.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -I../Classes/Streets -o street_data_builder StreetDataBuilder.cpp
+//               ../Classes/Map/MapProjection.cpp ../Classes/Streets/AddressNormalizer.cpp ../Classes/Streets/StreetData.cpp
+//               ../Classes/Streets/StreetDataWriter.cpp ../Classes/Streets/StreetGeocoder.cpp
+//
+//  Usage:   street_data_builder [-p places.csv] <source.csv> <output.nyst> [query...]
+//
+//  Any queries given after the output are looked up in the new data as a quick check. A query written as
+//  "latitude,longitude" prints the address there, and any other query prints the location of the address, place or
+//  intersection it names.
+//
+//  The first row of the source names the columns, which may come in any order:
+//
+//      street                          The street's name. Required.
+//      from_latitude, from_longitude   The location of one end of the segment. Required.
+//      to_latitude, to_longitude       The location of the other end. Required.
+//      left_from, left_to              The house numbers on the left side (as seen heading from "from" to "to") at each
+//                                      end, or empty if that side has no numbers.
+//      right_from, right_to            The house numbers on the right side at each end.
+//
+//  Fields follow RFC 4180, as for LandmarkCatalogBuilder. Each segment should be a straight stretch between two
+//  intersections, so that its numbers can be interpolated along it, and streets which cross should share the locations
+//  of their corners.
+//
+//  The places file names places which addresses can be looked up by, with "name", "latitude" and "longitude" columns. A
+//  place with several names (ie. "Grand Central" and "Grand Central Terminal") has a row for each.
+//
+//  The data shipped with the app is built from Resources/map/streets.csv and Resources/map/places.csv:
+//
+//      street_data_builder -p ../Resources/map/places.csv ../Resources/map/streets.csv ../Resources/map/streets.nyst
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "StreetData.h"
+#include "StreetDataWriter.h"
+#include "StreetGeocoder.h"
+
+using namespace std;
+
+// The number columns, in the order StreetDataWriter::addSegment(...) takes them.
+static const unsigned int NUMBER_COLUMN_COUNT = 4;
+static const char* NUMBER_COLUMNS[NUMBER_COLUMN_COUNT] = { "left_from", "left_to", "right_from", "right_to" };
+
+// The coordinate columns, in the order they are stored.
+static const unsigned int LOCATION_COLUMN_COUNT = 4;
+static const char* LOCATION_COLUMNS[LOCATION_COLUMN_COUNT] = { "from_latitude", "from_longitude", "to_latitude", "to_longitude" };
+
+// Read one CSV row into its fields. Returns false at the end of the file, or if a quoted field is never closed.
+
+static bool readRow(FILE* source, vector<string>* fields, unsigned int* lineNumber)
+{
+    fields->clear();
+
+    int c = fgetc(source);
+    if (c == EOF)
+    {
+        return false;
+    }
+
+    string field;
+    bool quoted = false;
+
+    for (;; c = fgetc(source))
+    {
+        if (quoted)
+        {
+            if (c == EOF)
+            {
+                return false;
+            }
+            else if (c == '"')
+            {
+                // A doubled quote is a quote inside the field, while a single one closes it.
+                int next = fgetc(source);
+                if (next == '"')
+                {
+                    field += '"';
+                }
+                else
+                {
+                    quoted = false;
+                    ungetc(next, source);
+                }
+            }
+            else
+            {
+                if (c == '\n') (*lineNumber)++;
+                if (c != '\r') field += (char)c;
+            }
+        }
+        else if (c == '"' && field.empty())
+        {
+            quoted = true;
+        }
+        else if (c == ',')
+        {
+            fields->push_back(field);
+            field.clear();
+        }
+        else if (c == '\n' || c == EOF)
+        {
+            fields->push_back(field);
+            (*lineNumber)++;
+            return true;
+        }
+        else if (c != '\r')
+        {
+            field += (char)c;
+        }
+    }
+}
+
+// Find a column by name in the header row.
+
+static int findColumn(const vector<string>& header, const char* name)
+{
+    for (unsigned int i = 0; i < header.size(); i++)
+    {
+        if (header[i] == name)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Read a number from a field. Returns false if the field holds anything else.
+
+static bool parseDouble(const string& field, double* value)
+{
+    char* end;
+    *value = strtod(field.c_str(), &end);
+    return !field.empty() && *end == '\0';
+}
+
+// Read the places file into the writer. Returns false, having printed why, if it can't be read.
+
+static bool readPlaces(const char* path, StreetDataWriter* writer)
+{
+    FILE* source = fopen(path, "rb");
+    if (!source)
+    {
+        fprintf(stderr, "error: could not open \"%s\"\n", path);
+        return false;
+    }
+
+    unsigned int lineNumber = 1;
+    vector<string> header;
+    if (!readRow(source, &header, &lineNumber))
+    {
+        fprintf(stderr, "error: \"%s\" is empty\n", path);
+        return false;
+    }
+
+    int nameColumn = findColumn(header, "name");
+    int latitudeColumn = findColumn(header, "latitude");
+    int longitudeColumn = findColumn(header, "longitude");
+    if (nameColumn < 0 || latitudeColumn < 0 || longitudeColumn < 0)
+    {
+        fprintf(stderr, "error: \"%s\" needs \"name\", \"latitude\" and \"longitude\" columns\n", path);
+        return false;
+    }
+
+    vector<string> fields;
+    for (unsigned int rowLine = lineNumber; readRow(source, &fields, &lineNumber); rowLine = lineNumber)
+    {
+        if (fields.size() == 1 && fields[0].empty())
+        {
+            continue;
+        }
+
+        double latitude, longitude;
+        if (fields.size() != header.size() || fields[nameColumn].empty() ||
+            !parseDouble(fields[latitudeColumn], &latitude) || !(latitude >= -90 && latitude <= 90) ||
+            !parseDouble(fields[longitudeColumn], &longitude) || !(longitude >= -180 && longitude <= 180))
+        {
+            fprintf(stderr, "error: %s: line %u: expected a name, a latitude and a longitude\n", path, rowLine);
+            return false;
+        }
+
+        writer->addPlace(fields[nameColumn].c_str(), GeoPoint(latitude, longitude));
+    }
+
+    bool isComplete = feof(source);
+    fclose(source);
+    if (!isComplete)
+    {
+        fprintf(stderr, "error: %s: line %u: a quoted field is never closed\n", path, lineNumber);
+    }
+    return isComplete;
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-p places.csv] <source.csv> <output.nyst> [query...]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    const char* placesPath = NULL;
+    int option;
+    while ((option = getopt(argc, argv, "p:")) != -1)
+    {
+        switch (option)
+        {
+            case 'p':
+                placesPath = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    if (argc - optind < 2)
+    {
+        printUsage(argv[0]);
+    }
+    const char* sourcePath = argv[optind];
+    const char* outputPath = argv[optind + 1];
+
+    FILE* source = fopen(sourcePath, "rb");
+    if (!source)
+    {
+        fprintf(stderr, "error: could not open \"%s\"\n", sourcePath);
+        return 1;
+    }
+
+    // Find each column in the header.
+    unsigned int lineNumber = 1;
+    vector<string> header;
+    if (!readRow(source, &header, &lineNumber))
+    {
+        fprintf(stderr, "error: \"%s\" is empty\n", sourcePath);
+        return 1;
+    }
+
+    int streetColumn = findColumn(header, "street");
+    if (streetColumn < 0)
+    {
+        fprintf(stderr, "error: there is no \"street\" column\n");
+        return 1;
+    }
+
+    int locationColumns[LOCATION_COLUMN_COUNT];
+    for (unsigned int i = 0; i < LOCATION_COLUMN_COUNT; i++)
+    {
+        locationColumns[i] = findColumn(header, LOCATION_COLUMNS[i]);
+        if (locationColumns[i] < 0)
+        {
+            fprintf(stderr, "error: there is no \"%s\" column\n", LOCATION_COLUMNS[i]);
+            return 1;
+        }
+    }
+
+    int numberColumns[NUMBER_COLUMN_COUNT];
+    for (unsigned int i = 0; i < NUMBER_COLUMN_COUNT; i++)
+    {
+        numberColumns[i] = findColumn(header, NUMBER_COLUMNS[i]);
+    }
+
+    // Read every segment.
+    StreetDataWriter writer;
+    vector<string> fields;
+
+    for (unsigned int rowLine = lineNumber; readRow(source, &fields, &lineNumber); rowLine = lineNumber)
+    {
+        // Skip blank lines.
+        if (fields.size() == 1 && fields[0].empty())
+        {
+            continue;
+        }
+
+        if (fields.size() != header.size())
+        {
+            fprintf(stderr, "error: line %u: expected %u fields but found %u\n", rowLine, (unsigned int)header.size(), (unsigned int)fields.size());
+            return 1;
+        }
+
+        if (fields[streetColumn].empty())
+        {
+            fprintf(stderr, "error: line %u: the segment has no street\n", rowLine);
+            return 1;
+        }
+
+        double location[LOCATION_COLUMN_COUNT];
+        for (unsigned int i = 0; i < LOCATION_COLUMN_COUNT; i++)
+        {
+            double limit = (i % 2 == 0) ? 90 : 180;
+            if (!parseDouble(fields[locationColumns[i]], &location[i]) || !(location[i] >= -limit && location[i] <= limit))
+            {
+                fprintf(stderr, "error: line %u: \"%s\" must be a number from %g to %g\n", rowLine, LOCATION_COLUMNS[i], -limit, limit);
+                return 1;
+            }
+        }
+
+        unsigned int numbers[NUMBER_COLUMN_COUNT];
+        for (unsigned int i = 0; i < NUMBER_COLUMN_COUNT; i++)
+        {
+            const string value = (numberColumns[i] >= 0) ? fields[numberColumns[i]] : "";
+            char* end;
+            long number = value.empty() ? 0 : strtol(value.c_str(), &end, 10);
+            if (!value.empty() && (*end != '\0' || number < 0))
+            {
+                fprintf(stderr, "error: line %u: \"%s\" must be a house number\n", rowLine, NUMBER_COLUMNS[i]);
+                return 1;
+            }
+            numbers[i] = number;
+        }
+
+        writer.addSegment(fields[streetColumn].c_str(),
+                          GeoPoint(location[0], location[1]), GeoPoint(location[2], location[3]),
+                          numbers[0], numbers[1], numbers[2], numbers[3]);
+    }
+
+    if (!feof(source))
+    {
+        fprintf(stderr, "error: line %u: a quoted field is never closed\n", lineNumber);
+        return 1;
+    }
+
+    long sourceSize = ftell(source);
+    fclose(source);
+
+    if (writer.getSegmentCount() == 0)
+    {
+        fprintf(stderr, "error: \"%s\" has no segments\n", sourcePath);
+        return 1;
+    }
+
+    if (placesPath && !readPlaces(placesPath, &writer))
+    {
+        return 1;
+    }
+
+    vector<unsigned char> output;
+    writer.write(&output);
+
+    FILE* destination = fopen(outputPath, "wb");
+    if (!destination || fwrite(&output[0], 1, output.size(), destination) != output.size())
+    {
+        fprintf(stderr, "error: could not write \"%s\"\n", outputPath);
+        return 1;
+    }
+    fclose(destination);
+
+    printf("Wrote %u segments of %u streets and %u places to \"%s\": %lu bytes from %ld bytes of source.\n",
+           writer.getSegmentCount(), writer.getStreetCount(), writer.getPlaceCount(), outputPath, (unsigned long)output.size(), sourceSize);
+
+    // Look up any queries in the file that was written, as the app will.
+    if (argc - optind > 2)
+    {
+        StreetData data;
+        if (!data.open(outputPath))
+        {
+            fprintf(stderr, "error: could not read back \"%s\"\n", outputPath);
+            return 1;
+        }
+
+        StreetGeocoder geocoder(&data);
+        for (int i = optind + 2; i < argc; i++)
+        {
+            GeoPoint location;
+            StreetAddress address;
+            string text;
+            int length = 0;
+            if (sscanf(argv[i], "%lf,%lf%n", &location.latitude, &location.longitude, &length) == 2 && argv[i][length] == '\0')
+            {
+                if (geocoder.reverseGeocode(location, &address))
+                {
+                    StreetGeocoder::formatAddress(address, &text);
+                    printf("%s: %s (%.0f m away)\n", argv[i], text.c_str(), address.distance);
+                }
+                else
+                {
+                    printf("%s: no street nearby\n", argv[i]);
+                }
+            }
+            else if (geocoder.geocode(argv[i], &address))
+            {
+                StreetGeocoder::formatAddress(address, &text);
+                printf("%s: %s at %.5f,%.5f\n", argv[i], text.c_str(), address.location.latitude, address.location.longitude);
+            }
+            else
+            {
+                printf("%s: not found\n", argv[i]);
+            }
+        }
+    }
+
+    return 0;
+}
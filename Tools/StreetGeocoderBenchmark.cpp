@@ -0,0 +1,351 @@
+//
+//  StreetGeocoderBenchmark.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which measures finding the address of a tapped point, and the location of a typed address, as the
+//  street data grows, without a device or cocos2d. It lays out a grid of streets turned to line up with Manhattan's,
+//  numbered the way Manhattan's are, writes it with StreetDataWriter and loads it with StreetData. It then looks up random
+//  locations over the grid, as the map does for each tap, checking the nearest streets of the first lookups against
+//  testing every segment. Each address that is found is typed back in, as a house number and as the nearest intersection,
+//  and must lead back to where it was found. The times are reported as percentiles. The bundled data can be measured
+//  instead of a made-up grid.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -I../Classes/Streets -o street_geocoder_benchmark
+//               StreetGeocoderBenchmark.cpp ../Classes/Map/MapProjection.cpp ../Classes/Streets/AddressNormalizer.cpp
+//               ../Classes/Streets/StreetData.cpp ../Classes/Streets/StreetDataWriter.cpp ../Classes/Streets/StreetGeocoder.cpp
+//
+//  Usage:   street_geocoder_benchmark [options]
+//
+//      -b <count>      The number of blocks along each side of the grid. Defaults to 200, which is about 80000 segments.
+//      -q <count>      The number of lookups. Defaults to 100000.
+//      -s <seed>       The seed for the lookups. Defaults to 1.
+//      -i <file>       Street data to measure (ie. ../Resources/map/streets.nyst) instead of a made-up grid.
+//
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "StreetData.h"
+#include "StreetDataWriter.h"
+#include "StreetGeocoder.h"
+
+using namespace std;
+
+// The south-west corner of the grid, and the lengths of its blocks in metres along the streets and the avenues.
+static const GeoPoint GRID_CORNER(40.700, -74.020);
+static const double STREET_BLOCK_LENGTH = 80;
+static const double AVENUE_BLOCK_LENGTH = 260;
+
+// How far past the edges of the streets lookups can land in metres, so that some of them find nothing.
+static const double LOOKUP_MARGIN = 200;
+
+// How many lookups are checked against testing every segment.
+static const unsigned int CHECKED_LOOKUPS = 1000;
+
+// How far in metres a typed address can lead from where it was found. Numbers are rounded to keep their parity, so they can move by a couple of numbers' worth of street.
+static const float ROUND_TRIP_TOLERANCE = 12;
+
+/**
+ @brief     The command-line options.
+ */
+struct BenchmarkOptions
+{
+    unsigned int blockCount;
+    unsigned int lookupCount;
+    unsigned int seed;
+    const char* inputPath;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the lookups are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Turn a position in metres along the grid's streets and avenues into a location, turning the grid as far as Manhattan's.
+
+static GeoPoint getGridLocation(double across, double along)
+{
+    // Manhattan's avenues run about 29 degrees east of north.
+    const double angle = 29 * M_PI / 180;
+    double metresPerDegree = MapProjection::EARTH_RADIUS * M_PI / 180;
+    double east = across * cos(angle) + along * sin(angle);
+    double north = -across * sin(angle) + along * cos(angle);
+    return GeoPoint(GRID_CORNER.latitude + north / metresPerDegree,
+                    GRID_CORNER.longitude + east / (metresPerDegree * cos(GRID_CORNER.latitude * M_PI / 180)));
+}
+
+// Lay out a grid of streets and avenues, with each block of each street numbered from the middle avenue outward as in Manhattan.
+
+static void makeGrid(unsigned int blockCount, StreetDataWriter* writer)
+{
+    char name[64];
+    unsigned int middle = blockCount / 2;
+
+    for (unsigned int street = 0; street <= blockCount; street++)
+    {
+        for (unsigned int block = 0; block < blockCount; block++)
+        {
+            // East of the middle avenue, numbers rise heading east and are odd on the north side, which is the left.
+            bool isEast = block >= middle;
+            snprintf(name, sizeof(name), "%s %u Street", isEast ? "East" : "West", street + 1);
+            unsigned int first = (isEast ? block - middle : middle - 1 - block) * 100 + 1;
+            GeoPoint west = getGridLocation(block * AVENUE_BLOCK_LENGTH, street * STREET_BLOCK_LENGTH);
+            GeoPoint east = getGridLocation((block + 1) * AVENUE_BLOCK_LENGTH, street * STREET_BLOCK_LENGTH);
+            if (isEast)
+            {
+                writer->addSegment(name, west, east, first, first + 98, first + 1, first + 99);
+            }
+            else
+            {
+                writer->addSegment(name, east, west, first + 1, first + 99, first, first + 98);
+            }
+        }
+    }
+
+    for (unsigned int avenue = 0; avenue <= blockCount; avenue++)
+    {
+        snprintf(name, sizeof(name), "Avenue %u", avenue + 1);
+        for (unsigned int block = 0; block < blockCount; block++)
+        {
+            unsigned int first = block * 20 + 1;
+            writer->addSegment(name,
+                               getGridLocation(avenue * AVENUE_BLOCK_LENGTH, block * STREET_BLOCK_LENGTH),
+                               getGridLocation(avenue * AVENUE_BLOCK_LENGTH, (block + 1) * STREET_BLOCK_LENGTH),
+                               first, first + 18, first + 1, first + 19);
+        }
+    }
+}
+
+// Find the distance to the nearest segment by testing every one of them, to check the grid's results against.
+
+static float findNearestDirectly(const StreetData& data, const MapPoint& point, float maxDistance)
+{
+    float nearestSquared = FLT_MAX;
+    for (unsigned int i = 0; i < data.getSegmentCount(); i++)
+    {
+        StreetSegment segment = data.getSegment(i);
+        float fraction = StreetData::getNearestFraction(segment, point);
+        nearestSquared = min(nearestSquared, (segment.from + (segment.to - segment.from) * fraction).distanceSquared(point));
+    }
+
+    return (nearestSquared <= maxDistance * maxDistance) ? sqrtf(nearestSquared) : -1;
+}
+
+// Get a percentile of a sorted list of times using the nearest rank.
+
+static double getPercentile(const vector<double>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)ceil(percentile / 100.0 * sortedTimes.size());
+    return sortedTimes[min(max(rank, (size_t)1), sortedTimes.size()) - 1];
+}
+
+// Print the percentiles of a list of times.
+
+static void printPercentiles(const char* label, vector<double>& times)
+{
+    sort(times.begin(), times.end());
+    printf("  %-20s p50 %8.2f   p90 %8.2f   p99 %8.2f   max %8.2f\n", label,
+           getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 99), getPercentile(times, 100));
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-b blocks] [-q lookups] [-s seed] [-i streets.nyst]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    options.blockCount = 200;
+    options.lookupCount = 100000;
+    options.seed = 1;
+    options.inputPath = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "b:q:s:i:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                options.blockCount = (unsigned int)atoi(optarg);
+                if (options.blockCount < 2) printUsage(argv[0]);
+                break;
+            case 'q':
+                options.lookupCount = (unsigned int)atoi(optarg);
+                if (options.lookupCount == 0) printUsage(argv[0]);
+                break;
+            case 's':
+                options.seed = (unsigned int)atoi(optarg);
+                break;
+            case 'i':
+                options.inputPath = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    // Startup: writing the grid stands in for building the bundled data, and opening or loading it is what the app does.
+    StreetData data;
+    double writeTime = 0, loadTime = 0;
+    double before;
+    if (options.inputPath)
+    {
+        before = getMicroseconds();
+        if (!data.open(options.inputPath))
+        {
+            fprintf(stderr, "error: could not open \"%s\"\n", options.inputPath);
+            return 1;
+        }
+        loadTime = getMicroseconds() - before;
+    }
+    else
+    {
+        StreetDataWriter writer;
+        makeGrid(options.blockCount, &writer);
+
+        before = getMicroseconds();
+        vector<unsigned char> bytes;
+        writer.write(&bytes);
+        writeTime = getMicroseconds() - before;
+
+        before = getMicroseconds();
+        if (!data.load(&bytes))
+        {
+            fprintf(stderr, "error: could not load the street data\n");
+            return 1;
+        }
+        loadTime = getMicroseconds() - before;
+    }
+
+    // Look up locations anywhere over the streets, and a little past them.
+    MapPoint minimum(FLT_MAX, FLT_MAX), maximum(-FLT_MAX, -FLT_MAX);
+    for (unsigned int i = 0; i < data.getSegmentCount(); i++)
+    {
+        StreetSegment segment = data.getSegment(i);
+        minimum = MapPoint(min(minimum.x, min(segment.from.x, segment.to.x)), min(minimum.y, min(segment.from.y, segment.to.y)));
+        maximum = MapPoint(max(maximum.x, max(segment.from.x, segment.to.x)), max(maximum.y, max(segment.from.y, segment.to.y)));
+    }
+    minimum = minimum - MapPoint(LOOKUP_MARGIN, LOOKUP_MARGIN);
+    maximum = maximum + MapPoint(LOOKUP_MARGIN, LOOKUP_MARGIN);
+
+    StreetGeocoder geocoder(&data);
+    unsigned int state = options.seed;
+    vector<double> nearestTimes, geocodeTimes, formatTimes, forwardTimes, intersectionTimes;
+    unsigned int found = 0, mismatches = 0, roundTripFailures = 0;
+    string text, intersection;
+
+    for (unsigned int i = 0; i < options.lookupCount; i++)
+    {
+        MapPoint point(minimum.x + getRandom(&state) * (maximum.x - minimum.x), minimum.y + getRandom(&state) * (maximum.y - minimum.y));
+        GeoPoint location = data.unflatten(point);
+
+        unsigned int segment;
+        float distance;
+        before = getMicroseconds();
+        bool isNearby = data.findNearestSegment(data.flatten(location), StreetGeocoder::MAX_REVERSE_DISTANCE, &segment, NULL, &distance);
+        nearestTimes.push_back(getMicroseconds() - before);
+
+        StreetAddress address;
+        before = getMicroseconds();
+        bool isFound = geocoder.reverseGeocode(location, &address);
+        geocodeTimes.push_back(getMicroseconds() - before);
+
+        if (isFound)
+        {
+            found++;
+            before = getMicroseconds();
+            StreetGeocoder::formatAddress(address, &text);
+            formatTimes.push_back(getMicroseconds() - before);
+
+            // Type the address back in, and it should lead back to the same street near the same place.
+            StreetAddress typed;
+            before = getMicroseconds();
+            bool isTypedFound = geocoder.geocode(text.c_str(), &typed);
+            forwardTimes.push_back(getMicroseconds() - before);
+            float error = data.flatten(typed.location).distance(data.flatten(address.location));
+            if (!isTypedFound || strcmp(typed.street, address.street) != 0 || (address.number != 0 && error > ROUND_TRIP_TOLERANCE))
+            {
+                roundTripFailures++;
+            }
+
+            // Type the corner at the nearer end of the segment as an intersection of this street and the street which meets it there.
+            StreetSegment segment = data.getSegment(address.segment);
+            MapPoint corner = (data.flatten(address.location).distanceSquared(segment.from) < data.flatten(address.location).distanceSquared(segment.to)) ? segment.from : segment.to;
+            unsigned int crossing;
+            MapPoint offset = (segment.to - segment.from) * (0.5f / max(segment.to.distance(segment.from), 1.0f));
+            MapPoint across(-offset.y, offset.x);
+            if (data.findNearestSegment(corner + across, 1, &crossing, NULL, NULL) && data.getSegment(crossing).street != segment.street)
+            {
+                intersection = string(address.street) + " & " + data.getStreetName(data.getSegment(crossing).street);
+                before = getMicroseconds();
+                bool isIntersectionFound = geocoder.geocode(intersection.c_str(), &typed);
+                intersectionTimes.push_back(getMicroseconds() - before);
+                if (!isIntersectionFound || data.flatten(typed.location).distance(corner) > 1)
+                {
+                    roundTripFailures++;
+                }
+            }
+        }
+
+        // Compare distances rather than segments, since the segments meeting at a corner are all as near to it.
+        if (i < CHECKED_LOOKUPS)
+        {
+            float expected = findNearestDirectly(data, data.flatten(location), StreetGeocoder::MAX_REVERSE_DISTANCE);
+            bool matches = (isNearby == (expected >= 0)) && (isFound == isNearby) && (!isNearby || fabsf(distance - expected) <= 0.001f);
+            mismatches += matches ? 0 : 1;
+        }
+    }
+
+    if (options.inputPath)
+    {
+        printf("%u segments of %u streets from \"%s\", %u lookups\n", data.getSegmentCount(), data.getStreetCount(), options.inputPath, options.lookupCount);
+        printf("  startup:             %.3f ms to open\n", loadTime / 1000);
+    }
+    else
+    {
+        printf("%u segments of %u streets in a %u by %u block grid, %u lookups\n", data.getSegmentCount(), data.getStreetCount(),
+               options.blockCount, options.blockCount, options.lookupCount);
+        printf("  startup:             %.2f ms to write, %.3f ms to load\n", writeTime / 1000, loadTime / 1000);
+    }
+    printPercentiles("nearest (us):", nearestTimes);
+    printPercentiles("reverse (us):", geocodeTimes);
+    printPercentiles("format (us):", formatTimes);
+    printPercentiles("forward (us):", forwardTimes);
+    printPercentiles("intersection (us):", intersectionTimes);
+    printf("  found:               %u of %u lookups within %.0f m of a street (last: \"%s\")\n",
+           found, options.lookupCount, StreetGeocoder::MAX_REVERSE_DISTANCE, text.c_str());
+    printf("  checked:             %u of the first %u lookups differ from testing every segment, %u typed addresses lead elsewhere (last: \"%s\")\n",
+           mismatches, min(options.lookupCount, CHECKED_LOOKUPS), roundTripFailures, intersection.c_str());
+
+    return (mismatches == 0 && roundTripFailures == 0) ? 0 : 1;
+}
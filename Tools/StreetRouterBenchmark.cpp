@@ -0,0 +1,381 @@
+//
+//  StreetRouterBenchmark.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which measures finding walking routes between random points, without a device or cocos2d. It
+//  lays out a grid of streets turned to line up with Manhattan's, with some of its blocks left out so that routes have
+//  to find their way around them, writes it with StreetDataWriter and builds a StreetGraph from it twice: once with
+//  anchors and once without, so that the anchors' bounds can be compared against straight lines. Routes are found
+//  between random pairs of points beside its streets with both graphs, and each route's length is checked against Dijkstra's
+//  algorithm run over the whole graph, which is timed as well. The times are reported as percentiles. The bundled data
+//  can be measured instead of a made-up grid.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -I../Classes/Streets -o street_router_benchmark
+//               StreetRouterBenchmark.cpp ../Classes/Map/MapProjection.cpp ../Classes/Streets/AddressNormalizer.cpp
+//               ../Classes/Streets/StreetData.cpp ../Classes/Streets/StreetDataWriter.cpp ../Classes/Streets/StreetGraph.cpp
+//               ../Classes/Streets/StreetRouter.cpp
+//
+//  Usage:   street_router_benchmark [options]
+//
+//      -b <count>      The number of blocks along each side of the grid. Defaults to 100, which is about 20000 segments
+//                      meeting at 10000 corners, a little more than Manhattan has.
+//      -g <percent>    The percentage of segments left out of the grid. Defaults to 10.
+//      -a <count>      The number of anchors. Defaults to 8, as the map uses.
+//      -q <count>      The number of routes. Defaults to 1000.
+//      -s <seed>       The seed for the grid and the routes. Defaults to 1.
+//      -i <file>       Street data to measure (ie. ../Resources/map/streets.nyst) instead of a made-up grid.
+//
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "StreetData.h"
+#include "StreetDataWriter.h"
+#include "StreetGraph.h"
+#include "StreetRouter.h"
+
+using namespace std;
+
+// The south-west corner of the grid, and the lengths of its blocks in metres along the streets and the avenues.
+static const GeoPoint GRID_CORNER(40.700, -74.020);
+static const double STREET_BLOCK_LENGTH = 80;
+static const double AVENUE_BLOCK_LENGTH = 260;
+
+// How far from a segment the ends of a route can be in metres.
+static const float STREET_WIDTH = 20;
+
+// How far a route's length can be from Dijkstra's in metres, since the searches add up their distances in different orders.
+static const float LENGTH_TOLERANCE = 0.05f;
+
+/**
+ @brief     The command-line options.
+ */
+struct BenchmarkOptions
+{
+    unsigned int blockCount;
+    unsigned int gapPercent;
+    unsigned int anchorCount;
+    unsigned int routeCount;
+    unsigned int seed;
+    const char* inputPath;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the routes are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Turn a position in metres along the grid's streets and avenues into a location, turning the grid as far as Manhattan's.
+
+static GeoPoint getGridLocation(double across, double along)
+{
+    // Manhattan's avenues run about 29 degrees east of north.
+    const double angle = 29 * M_PI / 180;
+    double metresPerDegree = MapProjection::EARTH_RADIUS * M_PI / 180;
+    double east = across * cos(angle) + along * sin(angle);
+    double north = -across * sin(angle) + along * cos(angle);
+    return GeoPoint(GRID_CORNER.latitude + north / metresPerDegree,
+                    GRID_CORNER.longitude + east / (metresPerDegree * cos(GRID_CORNER.latitude * M_PI / 180)));
+}
+
+// Lay out a grid of streets and avenues, leaving out some of its segments at random. Routes only need the streets' shapes, so none of them are numbered.
+
+static void makeGrid(unsigned int blockCount, unsigned int gapPercent, unsigned int* state, StreetDataWriter* writer)
+{
+    char name[64];
+    for (unsigned int street = 0; street <= blockCount; street++)
+    {
+        snprintf(name, sizeof(name), "%u Street", street + 1);
+        for (unsigned int block = 0; block < blockCount; block++)
+        {
+            if (getRandom(state) * 100 >= gapPercent)
+            {
+                writer->addSegment(name,
+                                   getGridLocation(block * AVENUE_BLOCK_LENGTH, street * STREET_BLOCK_LENGTH),
+                                   getGridLocation((block + 1) * AVENUE_BLOCK_LENGTH, street * STREET_BLOCK_LENGTH),
+                                   0, 0, 0, 0);
+            }
+        }
+    }
+
+    for (unsigned int avenue = 0; avenue <= blockCount; avenue++)
+    {
+        snprintf(name, sizeof(name), "Avenue %u", avenue + 1);
+        for (unsigned int block = 0; block < blockCount; block++)
+        {
+            if (getRandom(state) * 100 >= gapPercent)
+            {
+                writer->addSegment(name,
+                                   getGridLocation(avenue * AVENUE_BLOCK_LENGTH, block * STREET_BLOCK_LENGTH),
+                                   getGridLocation(avenue * AVENUE_BLOCK_LENGTH, (block + 1) * STREET_BLOCK_LENGTH),
+                                   0, 0, 0, 0);
+            }
+        }
+    }
+}
+
+// Get a random point near a random segment, up to a street's width from it.
+
+static MapPoint getRandomPoint(const StreetData& data, unsigned int* state)
+{
+    StreetSegment segment = data.getSegment(min((unsigned int)(getRandom(state) * data.getSegmentCount()), data.getSegmentCount() - 1));
+    MapPoint point = segment.from + (segment.to - segment.from) * getRandom(state);
+    return point + MapPoint((getRandom(state) - 0.5f) * 2 * STREET_WIDTH, (getRandom(state) - 0.5f) * 2 * STREET_WIDTH);
+}
+
+// Find the length of the shortest route between two points by running Dijkstra's algorithm from the start over the whole graph, to check the router's results against.
+
+static float findLengthDirectly(const StreetGraph& graph, const MapPoint& from, const MapPoint& to, vector<float>* distances)
+{
+    const StreetData* data = graph.getData();
+    unsigned int segments[2];
+    float fractions[2];
+    if (!data->findNearestSegment(from, StreetRouter::MAX_SNAP_DISTANCE, &segments[0], &fractions[0], NULL) ||
+        !data->findNearestSegment(to, StreetRouter::MAX_SNAP_DISTANCE, &segments[1], &fractions[1], NULL))
+    {
+        return -1;
+    }
+
+    // Each end is partway along its segment, so the search starts from both of the first segment's corners and the route can finish through either of the last one's.
+    unsigned int nodes[2][2];
+    float offsets[2][2];
+    MapPoint positions[2];
+    for (int end = 0; end < 2; end++)
+    {
+        nodes[end][0] = graph.getSegmentFromNode(segments[end]);
+        nodes[end][1] = graph.getSegmentToNode(segments[end]);
+        const MapPoint& a = graph.getNodePosition(nodes[end][0]);
+        const MapPoint& b = graph.getNodePosition(nodes[end][1]);
+        positions[end] = a + (b - a) * fractions[end];
+        offsets[end][0] = a.distance(positions[end]);
+        offsets[end][1] = b.distance(positions[end]);
+    }
+
+    graph.findDistances(nodes[0], offsets[0], 2, distances);
+
+    float length = FLT_MAX;
+    if (segments[0] == segments[1])
+    {
+        length = positions[0].distance(positions[1]);
+    }
+    for (int corner = 0; corner < 2; corner++)
+    {
+        if ((*distances)[nodes[1][corner]] != StreetGraph::UNREACHABLE)
+        {
+            length = min(length, (*distances)[nodes[1][corner]] + offsets[1][corner]);
+        }
+    }
+
+    return (length == FLT_MAX) ? -1 : length;
+}
+
+// Add up the lengths of the lines between a route's points.
+
+static float getPolylineLength(const vector<MapPoint>& points)
+{
+    float length = 0;
+    for (unsigned int i = 1; i < points.size(); i++)
+    {
+        length += points[i - 1].distance(points[i]);
+    }
+    return length;
+}
+
+// Check a route found by a router against the length found by Dijkstra's algorithm.
+
+static bool isRouteCorrect(bool isFound, const StreetRoute& route, float expected)
+{
+    if (!isFound)
+    {
+        return expected < 0;
+    }
+
+    return expected >= 0 && fabsf(route.length - expected) <= LENGTH_TOLERANCE + expected * 1e-5f &&
+           fabsf(getPolylineLength(route.points) - route.length) <= LENGTH_TOLERANCE + expected * 1e-5f;
+}
+
+// Get a percentile of a sorted list of times using the nearest rank.
+
+static double getPercentile(const vector<double>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)ceil(percentile / 100.0 * sortedTimes.size());
+    return sortedTimes[min(max(rank, (size_t)1), sortedTimes.size()) - 1];
+}
+
+// Print the percentiles of a list of times.
+
+static void printPercentiles(const char* label, vector<double>& times)
+{
+    sort(times.begin(), times.end());
+    printf("  %-20s p50 %8.2f   p90 %8.2f   p99 %8.2f   max %8.2f\n", label,
+           getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 99), getPercentile(times, 100));
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-b blocks] [-g percent] [-a anchors] [-q routes] [-s seed] [-i streets.nyst]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    options.blockCount = 100;
+    options.gapPercent = 10;
+    options.anchorCount = 8;
+    options.routeCount = 1000;
+    options.seed = 1;
+    options.inputPath = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "b:g:a:q:s:i:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                options.blockCount = (unsigned int)atoi(optarg);
+                if (options.blockCount < 2) printUsage(argv[0]);
+                break;
+            case 'g':
+                options.gapPercent = (unsigned int)atoi(optarg);
+                if (options.gapPercent >= 100) printUsage(argv[0]);
+                break;
+            case 'a':
+                options.anchorCount = (unsigned int)atoi(optarg);
+                break;
+            case 'q':
+                options.routeCount = (unsigned int)atoi(optarg);
+                if (options.routeCount == 0) printUsage(argv[0]);
+                break;
+            case 's':
+                options.seed = (unsigned int)atoi(optarg);
+                break;
+            case 'i':
+                options.inputPath = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    StreetData data;
+    unsigned int state = options.seed;
+    if (options.inputPath)
+    {
+        if (!data.open(options.inputPath))
+        {
+            fprintf(stderr, "error: could not open \"%s\"\n", options.inputPath);
+            return 1;
+        }
+    }
+    else
+    {
+        StreetDataWriter writer;
+        makeGrid(options.blockCount, options.gapPercent, &state, &writer);
+        vector<unsigned char> bytes;
+        writer.write(&bytes);
+        if (!data.load(&bytes))
+        {
+            fprintf(stderr, "error: could not load the street data\n");
+            return 1;
+        }
+    }
+
+    // Startup: the map builds its graph the first time directions are asked for.
+    double before = getMicroseconds();
+    StreetGraph plainGraph;
+    plainGraph.build(&data, 0);
+    double plainBuildTime = getMicroseconds() - before;
+
+    before = getMicroseconds();
+    StreetGraph anchoredGraph;
+    anchoredGraph.build(&data, options.anchorCount);
+    double anchoredBuildTime = getMicroseconds() - before;
+
+    // Route between points near random segments, as a walk between two places in the city would be.
+    StreetRouter plainRouter(&plainGraph);
+    StreetRouter anchoredRouter(&anchoredGraph);
+    vector<double> dijkstraTimes, plainTimes, anchoredTimes;
+    double plainSearched = 0, anchoredSearched = 0, totalLength = 0;
+    unsigned int found = 0, mismatches = 0;
+    vector<float> distances;
+    StreetRoute plainRoute, anchoredRoute;
+
+    for (unsigned int i = 0; i < options.routeCount; i++)
+    {
+        MapPoint from = getRandomPoint(data, &state);
+        MapPoint to = getRandomPoint(data, &state);
+
+        before = getMicroseconds();
+        float expected = findLengthDirectly(plainGraph, from, to, &distances);
+        dijkstraTimes.push_back(getMicroseconds() - before);
+
+        before = getMicroseconds();
+        bool isPlainFound = plainRouter.findRoute(from, to, &plainRoute);
+        plainTimes.push_back(getMicroseconds() - before);
+
+        before = getMicroseconds();
+        bool isAnchoredFound = anchoredRouter.findRoute(from, to, &anchoredRoute);
+        anchoredTimes.push_back(getMicroseconds() - before);
+
+        if (!isRouteCorrect(isPlainFound, plainRoute, expected) || !isRouteCorrect(isAnchoredFound, anchoredRoute, expected))
+        {
+            mismatches++;
+        }
+
+        if (isAnchoredFound)
+        {
+            found++;
+            totalLength += anchoredRoute.length;
+            plainSearched += plainRoute.searchedNodes;
+            anchoredSearched += anchoredRoute.searchedNodes;
+        }
+    }
+
+    if (options.inputPath)
+    {
+        printf("%u segments from \"%s\", %u corners, %u routes\n", data.getSegmentCount(), options.inputPath, plainGraph.getNodeCount(), options.routeCount);
+    }
+    else
+    {
+        printf("%u segments in a %u by %u block grid with %u%% left out, %u corners, %u routes\n", data.getSegmentCount(),
+               options.blockCount, options.blockCount, options.gapPercent, plainGraph.getNodeCount(), options.routeCount);
+    }
+    printf("  startup:             %.2f ms to build the graph, %.2f ms with %u anchors (%lu KB)\n", plainBuildTime / 1000,
+           anchoredBuildTime / 1000, anchoredGraph.getAnchorCount(), (unsigned long)anchoredGraph.getAnchorCount() * anchoredGraph.getNodeCount() * sizeof(float) / 1024);
+    printPercentiles("dijkstra (us):", dijkstraTimes);
+    printPercentiles("straight line (us):", plainTimes);
+    printPercentiles("anchors (us):", anchoredTimes);
+    printf("  searched:            %.0f corners per route with straight lines, %.0f with anchors\n",
+           found ? plainSearched / found : 0, found ? anchoredSearched / found : 0);
+    printf("  found:               %u of %u routes, %.0f m long on average\n", found, options.routeCount, found ? totalLength / found : 0);
+    printf("  checked:             %u of %u routes differ from Dijkstra's algorithm\n", mismatches, options.routeCount);
+
+    return (mismatches == 0) ? 0 : 1;
+}
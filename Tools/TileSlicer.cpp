@@ -0,0 +1,551 @@
+//
+//  TileSlicer.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-23.
+//
+//  A command-line tool which slices a large source image into the grid of tiles that CompositeSprite
+//  loads (ie. "newYorkMap0x0.png"), along with the "_half" and "_quarter" pyramid levels that
+//  AssetResolver picks from. The source is streamed in bands of scanlines, so peak memory depends on
+//  the band size and the image's width rather than on the size of the whole image.
+//
+//  Each tile of each pyramid level is an independent unit of work (resampling with a box filter and
+//  PNG encoding), and units are spread over all cores while the next band is decoded.
+//
+//  Build:   c++ -O3 -o tile_slicer TileSlicer.cpp -lpng -lpthread
+//
+//  Usage:   tile_slicer [options] <source.png> <output directory>
+//
+//      -g <columns>x<rows>     The size of the tile grid. Defaults to 4x5, like the bundled map.
+//      -s <width>x<height>     The maximum size of a tile instead of a fixed grid (ie. 2048x2048).
+//      -p <prefix>             The file name prefix of every tile. Defaults to "newYorkMap".
+//      -l <levels>             The number of pyramid levels to write (1 to 3). Defaults to 3.
+//      -b <rows>               The number of scanlines decoded per band. Defaults to 64.
+//      -j <threads>            The number of worker threads. Defaults to the number of cores.
+//      -z <level>              The zlib compression level of the tiles (0 to 9). Defaults to 6.
+//
+
+#include <png.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// The pyramid levels, named the same way as the variants that AssetResolver looks for.
+static const unsigned int MAX_LEVELS = 3;
+static const char* LEVEL_SUFFIXES[MAX_LEVELS] = { "", "_half", "_quarter" };
+
+/**
+ @brief     The settings chosen on the command line.
+ */
+struct SlicerOptions
+{
+    unsigned int columns;
+    unsigned int rows;
+    unsigned int maxTileWidth;
+    unsigned int maxTileHeight;
+    unsigned int levels;
+    unsigned int bandRows;
+    unsigned int threads;
+    int compression;
+    const char* prefix;
+    const char* sourcePath;
+    const char* outputDirectory;
+};
+
+/**
+ @brief     One tile of one pyramid level in the current row of tiles. Units are only ever touched by one worker at a time.
+ */
+struct TileUnit
+{
+    /** The tile's grid position and pyramid level. */
+    unsigned int column;
+    unsigned int level;
+
+    /** The range of source columns covered by the tile, and the tile's size at its pyramid level. */
+    unsigned int sourceX;
+    unsigned int sourceWidth;
+    unsigned int width;
+
+    /** The PNG file being written for the current row of tiles. */
+    FILE* file;
+    png_structp png;
+    png_infop info;
+
+    /** Per-channel sums of the source rows that have been accumulated towards the next output row. */
+    vector<unsigned short> sums;
+    unsigned int rowsSummed;
+
+    /** The output row produced from the sums. */
+    vector<unsigned char> outputRow;
+};
+
+/**
+ @brief     A band of decoded source scanlines, all belonging to the same row of tiles.
+ */
+struct Band
+{
+    unsigned char* pixels;
+    unsigned int rowCount;
+    unsigned int tileRow;
+    unsigned int tileHeight;
+    bool startsTileRow;
+    bool endsTileRow;
+};
+
+/**
+ @brief     The state shared by the worker threads while a band is being processed.
+ */
+struct BandJob
+{
+    const SlicerOptions* options;
+    const Band* band;
+    vector<TileUnit>* units;
+    unsigned int imageWidth;
+    unsigned int gridRows;
+
+    pthread_mutex_t mutex;
+    unsigned int nextUnit;
+};
+
+// Report a libpng error and give up, since a partially written pyramid is of no use.
+
+static void pngError(png_structp /*png*/, png_const_charp message)
+{
+    fprintf(stderr, "error: %s\n", message);
+    exit(1);
+}
+
+// Report a libpng warning.
+
+static void pngWarning(png_structp /*png*/, png_const_charp message)
+{
+    fprintf(stderr, "warning: %s\n", message);
+}
+
+// Get the current time in seconds.
+
+static double currentTime()
+{
+    struct timeval time;
+    gettimeofday(&time, NULL);
+    return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+// Split a length into a number of nearly equal parts, returning the start of each part followed by the end of the last one.
+
+static vector<unsigned int> splitEvenly(unsigned int length, unsigned int parts)
+{
+    vector<unsigned int> starts;
+    for (unsigned int i = 0; i <= parts; i++)
+    {
+        starts.push_back((unsigned int)((unsigned long long)length * i / parts));
+    }
+    return starts;
+}
+
+// Add a row of 8-bit channels to a row of 16-bit sums. This is where the filter spends its time, so it is vectorized.
+
+static void accumulateRow(unsigned short* sums, const unsigned char* row, unsigned int channelCount)
+{
+    unsigned int i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= channelCount; i += 16)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i low = _mm_loadu_si128((const __m128i*)(sums + i));
+        __m128i high = _mm_loadu_si128((const __m128i*)(sums + i + 8));
+        _mm_storeu_si128((__m128i*)(sums + i), _mm_add_epi16(low, _mm_unpacklo_epi8(pixels, zero)));
+        _mm_storeu_si128((__m128i*)(sums + i + 8), _mm_add_epi16(high, _mm_unpackhi_epi8(pixels, zero)));
+    }
+#endif
+
+    for (; i < channelCount; i++)
+    {
+        sums[i] += row[i];
+    }
+}
+
+// Collapse accumulated sums into an output row by averaging each block of [factor] source pixels. The last block may be narrower.
+
+static void resolveRow(const unsigned short* sums, unsigned int sourceWidth, unsigned int factor, unsigned int rowsSummed, unsigned char* output)
+{
+    for (unsigned int x = 0, outX = 0; x < sourceWidth; x += factor, outX++)
+    {
+        unsigned int blockWidth = (sourceWidth - x < factor) ? sourceWidth - x : factor;
+        unsigned int divisor = blockWidth * rowsSummed;
+        unsigned int total[4] = { 0, 0, 0, 0 };
+
+        for (unsigned int i = 0; i < blockWidth; i++)
+        {
+            const unsigned short* pixel = sums + (x + i) * 4;
+            total[0] += pixel[0];
+            total[1] += pixel[1];
+            total[2] += pixel[2];
+            total[3] += pixel[3];
+        }
+
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            output[outX * 4 + c] = (unsigned char)((total[c] + divisor / 2) / divisor);
+        }
+    }
+}
+
+// Begin writing a tile's PNG file.
+
+static void openTile(TileUnit& unit, const BandJob& job)
+{
+    const SlicerOptions& options = *job.options;
+    unsigned int factor = 1 << unit.level;
+    unsigned int height = (job.band->tileHeight + factor - 1) / factor;
+
+    // CompositeSprite counts rows from the bottom of the image, while the source is decoded from the top.
+    char fileName[512];
+    snprintf(fileName, sizeof(fileName), "%s/%s%ux%u%s.png", options.outputDirectory, options.prefix,
+             unit.column, job.gridRows - 1 - job.band->tileRow, LEVEL_SUFFIXES[unit.level]);
+
+    unit.file = fopen(fileName, "wb");
+    if (!unit.file)
+    {
+        fprintf(stderr, "error: could not create \"%s\"\n", fileName);
+        exit(1);
+    }
+
+    unit.png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, pngError, pngWarning);
+    unit.info = png_create_info_struct(unit.png);
+    png_init_io(unit.png, unit.file);
+    png_set_compression_level(unit.png, options.compression);
+    png_set_IHDR(unit.png, unit.info, unit.width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(unit.png, unit.info);
+
+    unit.rowsSummed = 0;
+    fill(unit.sums.begin(), unit.sums.end(), 0);
+}
+
+// Finish writing a tile's PNG file.
+
+static void closeTile(TileUnit& unit)
+{
+    png_write_end(unit.png, unit.info);
+    png_destroy_write_struct(&unit.png, &unit.info);
+    fclose(unit.file);
+    unit.file = NULL;
+}
+
+// Resample and write the part of a band which falls inside one tile of one pyramid level.
+
+static void processUnit(TileUnit& unit, const BandJob& job)
+{
+    const Band& band = *job.band;
+    unsigned int stride = job.imageWidth * 4;
+    unsigned int factor = 1 << unit.level;
+
+    if (band.startsTileRow)
+    {
+        openTile(unit, job);
+    }
+
+    for (unsigned int y = 0; y < band.rowCount; y++)
+    {
+        const unsigned char* sourceRow = band.pixels + y * stride + unit.sourceX * 4;
+
+        // The full-resolution level is written straight out of the band.
+        if (unit.level == 0)
+        {
+            png_write_row(unit.png, (png_bytep)sourceRow);
+            continue;
+        }
+
+        // Other levels emit a row once [factor] source rows have been summed (or the tile runs out of rows).
+        accumulateRow(&unit.sums[0], sourceRow, unit.sourceWidth * 4);
+        unit.rowsSummed++;
+
+        if (unit.rowsSummed == factor || (band.endsTileRow && y == band.rowCount - 1))
+        {
+            resolveRow(&unit.sums[0], unit.sourceWidth, factor, unit.rowsSummed, &unit.outputRow[0]);
+            png_write_row(unit.png, &unit.outputRow[0]);
+
+            unit.rowsSummed = 0;
+            fill(unit.sums.begin(), unit.sums.end(), 0);
+        }
+    }
+
+    if (band.endsTileRow)
+    {
+        closeTile(unit);
+    }
+}
+
+// A worker thread's main loop: claim units of the current band until none are left.
+
+static void* workerMain(void* argument)
+{
+    BandJob& job = *(BandJob*)argument;
+
+    while (true)
+    {
+        pthread_mutex_lock(&job.mutex);
+        unsigned int unitIndex = job.nextUnit++;
+        pthread_mutex_unlock(&job.mutex);
+
+        if (unitIndex >= job.units->size())
+        {
+            break;
+        }
+
+        processUnit((*job.units)[unitIndex], job);
+    }
+
+    return NULL;
+}
+
+// Start the worker threads on a band.
+
+static void startBand(BandJob& job, vector<pthread_t>& threads)
+{
+    job.nextUnit = 0;
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+        if (pthread_create(&threads[i], NULL, workerMain, &job) != 0)
+        {
+            fprintf(stderr, "error: could not start a worker thread\n");
+            exit(1);
+        }
+    }
+}
+
+// Wait for the worker threads to finish a band.
+
+static void finishBand(vector<pthread_t>& threads)
+{
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// Parse a "<a>x<b>" argument.
+
+static bool parsePair(const char* text, unsigned int* first, unsigned int* second)
+{
+    return sscanf(text, "%ux%u", first, second) == 2 && *first > 0 && *second > 0;
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-g columnsxrows | -s widthxheight] [-p prefix] [-l levels] [-b band rows] [-j threads] [-z level] <source.png> <output directory>\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    SlicerOptions options;
+    options.columns = 4;
+    options.rows = 5;
+    options.maxTileWidth = 0;
+    options.maxTileHeight = 0;
+    options.levels = MAX_LEVELS;
+    options.bandRows = 64;
+    options.threads = (unsigned int)max(sysconf(_SC_NPROCESSORS_ONLN), 1L);
+    options.compression = 6;
+    options.prefix = "newYorkMap";
+
+    int option;
+    while ((option = getopt(argc, argv, "g:s:p:l:b:j:z:")) != -1)
+    {
+        switch (option)
+        {
+            case 'g': if (!parsePair(optarg, &options.columns, &options.rows)) printUsage(argv[0]); break;
+            case 's': if (!parsePair(optarg, &options.maxTileWidth, &options.maxTileHeight)) printUsage(argv[0]); break;
+            case 'p': options.prefix = optarg; break;
+            case 'l': options.levels = atoi(optarg); break;
+            case 'b': options.bandRows = atoi(optarg); break;
+            case 'j': options.threads = atoi(optarg); break;
+            case 'z': options.compression = atoi(optarg); break;
+            default: printUsage(argv[0]);
+        }
+    }
+
+    if (argc - optind != 2 || options.levels < 1 || options.levels > MAX_LEVELS ||
+        options.bandRows < 1 || options.threads < 1 || options.compression < 0 || options.compression > 9)
+    {
+        printUsage(argv[0]);
+    }
+    options.sourcePath = argv[optind];
+    options.outputDirectory = argv[optind + 1];
+
+    // Open the source and have libpng convert every pixel format to 8-bit RGBA while decoding.
+    FILE* sourceFile = fopen(options.sourcePath, "rb");
+    if (!sourceFile)
+    {
+        fprintf(stderr, "error: could not open \"%s\"\n", options.sourcePath);
+        return 1;
+    }
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, pngError, pngWarning);
+    png_infop info = png_create_info_struct(png);
+    png_init_io(png, sourceFile);
+    png_read_info(png, info);
+
+    unsigned int imageWidth = png_get_image_width(png, info);
+    unsigned int imageHeight = png_get_image_height(png, info);
+
+    if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE)
+    {
+        fprintf(stderr, "error: interlaced images can't be streamed, so re-save the source without interlacing\n");
+        return 1;
+    }
+
+    png_set_expand(png);
+    png_set_strip_16(png);
+    png_set_gray_to_rgb(png);
+    png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
+    png_read_update_info(png, info);
+
+    // Lay out the grid, either as requested or from the maximum tile size.
+    if (options.maxTileWidth > 0)
+    {
+        options.columns = (imageWidth + options.maxTileWidth - 1) / options.maxTileWidth;
+        options.rows = (imageHeight + options.maxTileHeight - 1) / options.maxTileHeight;
+    }
+
+    vector<unsigned int> columnStarts = splitEvenly(imageWidth, options.columns);
+    vector<unsigned int> rowStarts = splitEvenly(imageHeight, options.rows);
+
+    // Create a unit for every tile of every level in a row of tiles. Larger units come first so that they don't end up last on a single thread.
+    vector<TileUnit> units;
+    for (unsigned int level = 0; level < options.levels; level++)
+    {
+        for (unsigned int column = 0; column < options.columns; column++)
+        {
+            TileUnit unit;
+            unit.column = column;
+            unit.level = level;
+            unit.sourceX = columnStarts[column];
+            unit.sourceWidth = columnStarts[column + 1] - columnStarts[column];
+            unit.width = (unit.sourceWidth + (1 << level) - 1) >> level;
+            unit.file = NULL;
+            unit.png = NULL;
+            unit.info = NULL;
+            unit.rowsSummed = 0;
+            if (level > 0)
+            {
+                unit.sums.resize(unit.sourceWidth * 4);
+                unit.outputRow.resize(unit.width * 4);
+            }
+            units.push_back(unit);
+        }
+    }
+
+    // Two bands are allocated so that one can be decoded while the other is being resampled and encoded.
+    size_t bandSize = (size_t)options.bandRows * imageWidth * 4;
+    unsigned char* bandPixels[2] = { (unsigned char*)malloc(bandSize), (unsigned char*)malloc(bandSize) };
+    if (!bandPixels[0] || !bandPixels[1])
+    {
+        fprintf(stderr, "error: could not allocate %lu bytes for the bands\n", (unsigned long)bandSize * 2);
+        return 1;
+    }
+
+    size_t unitMemory = 0;
+    for (unsigned int i = 0; i < units.size(); i++)
+    {
+        unitMemory += units[i].sums.size() * sizeof(unsigned short) + units[i].outputRow.size();
+    }
+
+    printf("Slicing %ux%u image into a %ux%u grid with %u level(s) using %u thread(s)...\n",
+           imageWidth, imageHeight, options.columns, options.rows, options.levels, options.threads);
+
+    Band bands[2];
+    BandJob jobs[2];
+    vector<pthread_t> threads(options.threads);
+    bool workersRunning = false;
+    unsigned int current = 0;
+    double decodeTime = 0;
+    double startTime = currentTime();
+
+    for (unsigned int tileRow = 0; tileRow < options.rows; tileRow++)
+    {
+        unsigned int tileTop = rowStarts[tileRow];
+        unsigned int tileBottom = rowStarts[tileRow + 1];
+
+        for (unsigned int y = tileTop; y < tileBottom; y += options.bandRows)
+        {
+            // Decode the next band while the workers are still busy with the previous one.
+            Band& band = bands[current];
+            band.pixels = bandPixels[current];
+            band.rowCount = min(options.bandRows, tileBottom - y);
+            band.tileRow = tileRow;
+            band.tileHeight = tileBottom - tileTop;
+            band.startsTileRow = (y == tileTop);
+            band.endsTileRow = (y + band.rowCount == tileBottom);
+
+            double decodeStart = currentTime();
+            for (unsigned int row = 0; row < band.rowCount; row++)
+            {
+                png_read_row(png, band.pixels + (size_t)row * imageWidth * 4, NULL);
+            }
+            decodeTime += currentTime() - decodeStart;
+
+            // Only one band can be in flight, since both would write to the same tiles.
+            if (workersRunning)
+            {
+                finishBand(threads);
+                pthread_mutex_destroy(&jobs[current ^ 1].mutex);
+            }
+
+            BandJob& job = jobs[current];
+            job.options = &options;
+            job.band = &band;
+            job.units = &units;
+            job.imageWidth = imageWidth;
+            job.gridRows = options.rows;
+            pthread_mutex_init(&job.mutex, NULL);
+            startBand(job, threads);
+            workersRunning = true;
+
+            current ^= 1;
+        }
+    }
+
+    if (workersRunning)
+    {
+        finishBand(threads);
+        pthread_mutex_destroy(&jobs[current ^ 1].mutex);
+    }
+
+    double totalTime = currentTime() - startTime;
+
+    png_read_end(png, NULL);
+    png_destroy_read_struct(&png, &info, NULL);
+    fclose(sourceFile);
+    free(bandPixels[0]);
+    free(bandPixels[1]);
+
+    // Report the throughput.
+    double megapixels = (double)imageWidth * imageHeight / 1000000.0;
+    printf("Wrote %u tiles in %.2f s (%.2f s decoding the source).\n",
+           options.columns * options.rows * options.levels, totalTime, decodeTime);
+    printf("Throughput: %.1f megapixels/s, %.1f MB/s of decoded source.\n",
+           megapixels / totalTime, megapixels * 4 / totalTime);
+    printf("Working memory: %.1f MB (%u-row bands).\n",
+           (bandSize * 2 + unitMemory) / (1024.0 * 1024.0), options.bandRows);
+
+    return 0;
+}
@@ -0,0 +1,470 @@
+//
+//  TourPlannerBenchmark.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-03-04.
+//
+//  A command-line tool which measures planning walking tours through random stops, without a device or cocos2d. It lays
+//  out the same grid of streets as StreetRouterBenchmark.cpp (or opens the bundled data), then for each tour picks random
+//  stops beside its streets and times the whole of what the map does when a tour is asked for: adding the stops to an
+//  empty StreetDistanceMatrix, updating it on several threads, and planning the tour with a TourPlanner. The matrix's
+//  update is also timed on one thread, and with a few more stops added to a matrix that already knows the rest. Some of
+//  the matrix's distances are checked against StreetRouter, and a tour through the first 8 stops is checked against the
+//  shortest one found by trying every order.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -I../Classes/Streets -o tour_planner_benchmark
+//               TourPlannerBenchmark.cpp ../Classes/Map/MapProjection.cpp ../Classes/Streets/AddressNormalizer.cpp
+//               ../Classes/Streets/StreetData.cpp ../Classes/Streets/StreetDataWriter.cpp ../Classes/Streets/StreetGraph.cpp
+//               ../Classes/Streets/StreetRouter.cpp ../Classes/Streets/StreetDistanceMatrix.cpp
+//               ../Classes/Streets/TourPlanner.cpp -lpthread
+//
+//  Usage:   tour_planner_benchmark [options]
+//
+//      -b <count>      The number of blocks along each side of the grid. Defaults to 100.
+//      -g <percent>    The percentage of segments left out of the grid. Defaults to 10.
+//      -n <count>      The number of stops in each tour, including the one it starts from. Defaults to 50.
+//      -q <count>      The number of tours. Defaults to 20.
+//      -t <count>      The number of threads the matrix is updated on. Defaults to 2, as the map uses.
+//      -m <ms>         The time the planner may spend looking for a shorter tour. Defaults to 50.
+//      -s <seed>       The seed for the grid and the stops. Defaults to 1.
+//      -i <file>       Street data to measure (ie. ../Resources/map/streets.nyst) instead of a made-up grid.
+//
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "StreetData.h"
+#include "StreetDataWriter.h"
+#include "StreetGraph.h"
+#include "StreetRouter.h"
+#include "StreetDistanceMatrix.h"
+#include "TourPlanner.h"
+
+using namespace std;
+
+// The south-west corner of the grid, and the lengths of its blocks in metres along the streets and the avenues.
+static const GeoPoint GRID_CORNER(40.700, -74.020);
+static const double STREET_BLOCK_LENGTH = 80;
+static const double AVENUE_BLOCK_LENGTH = 260;
+
+// How far from a segment the stops can be in metres.
+static const float STREET_WIDTH = 20;
+
+// How far a distance in the matrix can be from the router's in metres, since the searches add up their distances in different orders.
+static const float LENGTH_TOLERANCE = 0.05f;
+
+// The number of anchors the graph is built with, as the map uses.
+static const unsigned int ANCHOR_COUNT = 8;
+
+// The number of stops added to a matrix which already knows the rest, the number of the matrix's distances checked against the router per tour, and the number of stops in the tours checked against every order.
+static const unsigned int INCREMENTAL_STOP_COUNT = 5;
+static const unsigned int CHECKED_DISTANCE_COUNT = 20;
+static const unsigned int EXACT_STOP_COUNT = 8;
+
+/**
+ @brief     The command-line options.
+ */
+struct BenchmarkOptions
+{
+    unsigned int blockCount;
+    unsigned int gapPercent;
+    unsigned int stopCount;
+    unsigned int tourCount;
+    unsigned int threadCount;
+    double timeBudget;
+    unsigned int seed;
+    const char* inputPath;
+};
+
+// Get the current time from a monotonic clock in microseconds.
+
+static double getMicroseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000.0 + now.tv_nsec / 1000.0;
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the stops are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Turn a position in metres along the grid's streets and avenues into a location, turning the grid as far as Manhattan's.
+
+static GeoPoint getGridLocation(double across, double along)
+{
+    // Manhattan's avenues run about 29 degrees east of north.
+    const double angle = 29 * M_PI / 180;
+    double metresPerDegree = MapProjection::EARTH_RADIUS * M_PI / 180;
+    double east = across * cos(angle) + along * sin(angle);
+    double north = -across * sin(angle) + along * cos(angle);
+    return GeoPoint(GRID_CORNER.latitude + north / metresPerDegree,
+                    GRID_CORNER.longitude + east / (metresPerDegree * cos(GRID_CORNER.latitude * M_PI / 180)));
+}
+
+// Lay out a grid of streets and avenues, leaving out some of its segments at random.
+
+static void makeGrid(unsigned int blockCount, unsigned int gapPercent, unsigned int* state, StreetDataWriter* writer)
+{
+    char name[64];
+    for (unsigned int street = 0; street <= blockCount; street++)
+    {
+        snprintf(name, sizeof(name), "%u Street", street + 1);
+        for (unsigned int block = 0; block < blockCount; block++)
+        {
+            if (getRandom(state) * 100 >= gapPercent)
+            {
+                writer->addSegment(name,
+                                   getGridLocation(block * AVENUE_BLOCK_LENGTH, street * STREET_BLOCK_LENGTH),
+                                   getGridLocation((block + 1) * AVENUE_BLOCK_LENGTH, street * STREET_BLOCK_LENGTH),
+                                   0, 0, 0, 0);
+            }
+        }
+    }
+
+    for (unsigned int avenue = 0; avenue <= blockCount; avenue++)
+    {
+        snprintf(name, sizeof(name), "Avenue %u", avenue + 1);
+        for (unsigned int block = 0; block < blockCount; block++)
+        {
+            if (getRandom(state) * 100 >= gapPercent)
+            {
+                writer->addSegment(name,
+                                   getGridLocation(avenue * AVENUE_BLOCK_LENGTH, block * STREET_BLOCK_LENGTH),
+                                   getGridLocation(avenue * AVENUE_BLOCK_LENGTH, (block + 1) * STREET_BLOCK_LENGTH),
+                                   0, 0, 0, 0);
+            }
+        }
+    }
+}
+
+// Get a random point near a random segment, up to a street's width from it.
+
+static MapPoint getRandomPoint(const StreetData& data, unsigned int* state)
+{
+    StreetSegment segment = data.getSegment(min((unsigned int)(getRandom(state) * data.getSegmentCount()), data.getSegmentCount() - 1));
+    MapPoint point = segment.from + (segment.to - segment.from) * getRandom(state);
+    return point + MapPoint((getRandom(state) - 0.5f) * 2 * STREET_WIDTH, (getRandom(state) - 0.5f) * 2 * STREET_WIDTH);
+}
+
+// Pick random stops which can all be reached from each other, by keeping only those which can be reached from the first.
+
+static void pickStops(const StreetData& data, const StreetGraph& graph, unsigned int count, unsigned int* state, vector<MapPoint>* stops)
+{
+    StreetRouter router(&graph);
+    StreetRoute route;
+    stops->clear();
+    while (stops->size() < count)
+    {
+        StreetGraphLocation location;
+        MapPoint point = getRandomPoint(data, state);
+        if (graph.locate(point, StreetRouter::MAX_SNAP_DISTANCE, &location) && (stops->empty() || router.findRoute((*stops)[0], point, &route)))
+        {
+            stops->push_back(point);
+        }
+    }
+}
+
+// Add stops to a matrix, and get their indices.
+
+static void addStops(StreetDistanceMatrix* matrix, const vector<MapPoint>& points, vector<unsigned int>* stops)
+{
+    stops->clear();
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+        stops->push_back(matrix->addStop(points[i]));
+    }
+}
+
+// Add up the length of a tour through some stops in a given order.
+
+static float getTourLength(const StreetDistanceMatrix& matrix, const vector<unsigned int>& stops, const vector<unsigned int>& order)
+{
+    float length = 0;
+    for (unsigned int i = 1; i < order.size(); i++)
+    {
+        length += matrix.getDistance(stops[order[i - 1]], stops[order[i]]);
+    }
+    return length;
+}
+
+// Check that a plan visits every stop once, starting from the first, and that its length adds up.
+
+static bool isPlanCorrect(const StreetDistanceMatrix& matrix, const vector<unsigned int>& stops, const TourPlan& plan)
+{
+    vector<unsigned int> sorted(plan.order);
+    sort(sorted.begin(), sorted.end());
+    for (unsigned int i = 0; i < sorted.size(); i++)
+    {
+        if (sorted[i] != i)
+        {
+            return false;
+        }
+    }
+
+    float length = getTourLength(matrix, stops, plan.order);
+    return sorted.size() == stops.size() && !plan.order.empty() && plan.order[0] == 0 && fabsf(length - plan.length) <= LENGTH_TOLERANCE + length * 1e-5f;
+}
+
+// Find the length of a tour which visits the nearest stop not yet visited each time, which is where the planner starts from.
+
+static float getNearestNeighbourLength(const StreetDistanceMatrix& matrix, const vector<unsigned int>& stops)
+{
+    vector<bool> visited(stops.size(), false);
+    unsigned int current = 0;
+    visited[0] = true;
+    float length = 0;
+    for (unsigned int step = 1; step < stops.size(); step++)
+    {
+        unsigned int nearest = 0;
+        float nearestDistance = FLT_MAX;
+        for (unsigned int i = 0; i < stops.size(); i++)
+        {
+            float distance = matrix.getDistance(stops[current], stops[i]);
+            if (!visited[i] && distance < nearestDistance)
+            {
+                nearest = i;
+                nearestDistance = distance;
+            }
+        }
+        visited[nearest] = true;
+        length += nearestDistance;
+        current = nearest;
+    }
+    return length;
+}
+
+// Find the length of the shortest tour by trying every order of the stops after the first.
+
+static float getShortestLength(const StreetDistanceMatrix& matrix, const vector<unsigned int>& stops)
+{
+    vector<unsigned int> order(stops.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+
+    float shortest = FLT_MAX;
+    do
+    {
+        shortest = min(shortest, getTourLength(matrix, stops, order));
+    }
+    while (next_permutation(order.begin() + 1, order.end()));
+    return shortest;
+}
+
+// Get a percentile of a sorted list of times using the nearest rank.
+
+static double getPercentile(const vector<double>& sortedTimes, double percentile)
+{
+    if (sortedTimes.empty())
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)ceil(percentile / 100.0 * sortedTimes.size());
+    return sortedTimes[min(max(rank, (size_t)1), sortedTimes.size()) - 1];
+}
+
+// Print the percentiles of a list of times.
+
+static void printPercentiles(const char* label, vector<double>& times)
+{
+    sort(times.begin(), times.end());
+    printf("  %-22s p50 %8.2f   p90 %8.2f   max %8.2f\n", label, getPercentile(times, 50), getPercentile(times, 90), getPercentile(times, 100));
+}
+
+// Print the usage message and quit.
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-b blocks] [-g percent] [-n stops] [-q tours] [-t threads] [-m ms] [-s seed] [-i streets.nyst]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    options.blockCount = 100;
+    options.gapPercent = 10;
+    options.stopCount = 50;
+    options.tourCount = 20;
+    options.threadCount = 2;
+    options.timeBudget = 0.05;
+    options.seed = 1;
+    options.inputPath = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "b:g:n:q:t:m:s:i:")) != -1)
+    {
+        switch (option)
+        {
+            case 'b':
+                options.blockCount = (unsigned int)atoi(optarg);
+                if (options.blockCount < 2) printUsage(argv[0]);
+                break;
+            case 'g':
+                options.gapPercent = (unsigned int)atoi(optarg);
+                if (options.gapPercent >= 100) printUsage(argv[0]);
+                break;
+            case 'n':
+                options.stopCount = (unsigned int)atoi(optarg);
+                if (options.stopCount < EXACT_STOP_COUNT) printUsage(argv[0]);
+                break;
+            case 'q':
+                options.tourCount = (unsigned int)atoi(optarg);
+                if (options.tourCount == 0) printUsage(argv[0]);
+                break;
+            case 't':
+                options.threadCount = (unsigned int)atoi(optarg);
+                if (options.threadCount == 0) printUsage(argv[0]);
+                break;
+            case 'm':
+                options.timeBudget = atof(optarg) / 1000;
+                break;
+            case 's':
+                options.seed = (unsigned int)atoi(optarg);
+                break;
+            case 'i':
+                options.inputPath = optarg;
+                break;
+            default:
+                printUsage(argv[0]);
+        }
+    }
+
+    StreetData data;
+    unsigned int state = options.seed;
+    if (options.inputPath)
+    {
+        if (!data.open(options.inputPath))
+        {
+            fprintf(stderr, "error: could not open \"%s\"\n", options.inputPath);
+            return 1;
+        }
+    }
+    else
+    {
+        StreetDataWriter writer;
+        makeGrid(options.blockCount, options.gapPercent, &state, &writer);
+        vector<unsigned char> bytes;
+        writer.write(&bytes);
+        if (!data.load(&bytes))
+        {
+            fprintf(stderr, "error: could not load the street data\n");
+            return 1;
+        }
+    }
+
+    StreetGraph graph;
+    graph.build(&data, ANCHOR_COUNT);
+    StreetRouter router(&graph);
+
+    vector<double> matrixTimes, singleThreadTimes, incrementalTimes, planTimes, totalTimes;
+    double nearestNeighbourSaving = 0, exactGap = 0;
+    unsigned int mismatches = 0, exactCount = 0, overBudget = 0;
+    unsigned long kicks = 0;
+    vector<MapPoint> points, extraPoints;
+    vector<unsigned int> stops, extraStops;
+    StreetRoute route;
+
+    for (unsigned int tour = 0; tour < options.tourCount; tour++)
+    {
+        pickStops(data, graph, options.stopCount + INCREMENTAL_STOP_COUNT, &state, &points);
+        extraPoints.assign(points.begin() + options.stopCount, points.end());
+        points.resize(options.stopCount);
+
+        // What the map does for a tour through stops it hasn't seen before.
+        double before = getMicroseconds();
+        StreetDistanceMatrix matrix(&graph);
+        addStops(&matrix, points, &stops);
+        matrix.update(options.threadCount);
+        double matrixTime = getMicroseconds() - before;
+
+        before = getMicroseconds();
+        TourPlanner planner(&matrix, options.seed);
+        TourPlan plan;
+        bool isPlanned = planner.planTour(stops, false, options.timeBudget, &plan);
+        double planTime = getMicroseconds() - before;
+
+        matrixTimes.push_back(matrixTime / 1000);
+        planTimes.push_back(planTime / 1000);
+        totalTimes.push_back((matrixTime + planTime) / 1000);
+        overBudget += (matrixTime + planTime > 100000) ? 1 : 0;
+        kicks += plan.kicks;
+
+        if (!isPlanned || !isPlanCorrect(matrix, stops, plan))
+        {
+            mismatches++;
+            continue;
+        }
+        float nearestNeighbourLength = getNearestNeighbourLength(matrix, stops);
+        nearestNeighbourSaving += (nearestNeighbourLength - plan.length) / nearestNeighbourLength;
+
+        // The same matrix on one thread, and a few more stops added to the one which already knows the rest.
+        StreetDistanceMatrix singleThreadMatrix(&graph);
+        addStops(&singleThreadMatrix, points, &extraStops);
+        before = getMicroseconds();
+        singleThreadMatrix.update(1);
+        singleThreadTimes.push_back((getMicroseconds() - before) / 1000);
+
+        before = getMicroseconds();
+        addStops(&matrix, extraPoints, &extraStops);
+        matrix.update(options.threadCount);
+        incrementalTimes.push_back((getMicroseconds() - before) / 1000);
+
+        // Check some of the distances, old and new, against the router.
+        for (unsigned int i = 0; i < CHECKED_DISTANCE_COUNT; i++)
+        {
+            unsigned int from = min((unsigned int)(getRandom(&state) * matrix.getStopCount()), matrix.getStopCount() - 1);
+            unsigned int to = min((unsigned int)(getRandom(&state) * matrix.getStopCount()), matrix.getStopCount() - 1);
+            float distance = matrix.getDistance(from, to);
+            if (from != to && (!router.findRoute(matrix.getPoint(from), matrix.getPoint(to), &route) ||
+                               fabsf(route.length - distance) > LENGTH_TOLERANCE + distance * 1e-5f))
+            {
+                mismatches++;
+            }
+        }
+
+        // Check a smaller tour against the shortest one.
+        vector<unsigned int> exactStops(stops.begin(), stops.begin() + EXACT_STOP_COUNT);
+        TourPlan exactPlan;
+        planner.planTour(exactStops, false, options.timeBudget, &exactPlan);
+        float shortest = getShortestLength(matrix, exactStops);
+        exactCount += (exactPlan.length <= shortest + LENGTH_TOLERANCE) ? 1 : 0;
+        exactGap += (exactPlan.length - shortest) / shortest;
+    }
+
+    if (options.inputPath)
+    {
+        printf("%u segments from \"%s\", %u corners, %u tours of %u stops\n", data.getSegmentCount(), options.inputPath, graph.getNodeCount(), options.tourCount, options.stopCount);
+    }
+    else
+    {
+        printf("%u segments in a %u by %u block grid with %u%% left out, %u corners, %u tours of %u stops\n", data.getSegmentCount(),
+               options.blockCount, options.blockCount, options.gapPercent, graph.getNodeCount(), options.tourCount, options.stopCount);
+    }
+    printf("  matrix updated on %u threads, planner given %.0f ms\n", options.threadCount, options.timeBudget * 1000);
+    printPercentiles("matrix (ms):", matrixTimes);
+    printPercentiles("matrix, 1 thread (ms):", singleThreadTimes);
+    printPercentiles("add 5 stops (ms):", incrementalTimes);
+    printPercentiles("plan (ms):", planTimes);
+    printPercentiles("total (ms):", totalTimes);
+    printf("  over 100 ms:           %u of %u tours\n", overBudget, options.tourCount);
+    printf("  planned:               %.1f%% shorter than nearest neighbour on average, %lu kicks per tour\n",
+           nearestNeighbourSaving * 100 / options.tourCount, kicks / options.tourCount);
+    printf("  exact:                 %u of %u tours of %u stops are the shortest, %.2f%% longer on average\n",
+           exactCount, options.tourCount, EXACT_STOP_COUNT, exactGap * 100 / options.tourCount);
+    printf("  checked:               %u mismatches against the router and the plans' lengths\n", mismatches);
+
+    return (mismatches == 0) ? 0 : 1;
+}
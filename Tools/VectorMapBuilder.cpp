@@ -0,0 +1,156 @@
+//
+//  VectorMapBuilder.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//  A command-line tool which converts a plain-text description of the map's geometry into the compact binary format read
+//  by VectorMapData (see Classes/Map/VectorMapData.h), ie. "newYorkMap.nyvm". Coordinates are in map units, which are the
+//  same as the raster map's pixels with (0,0) at the bottom-left, so geometry can be traced over the existing tiles.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -o vector_map_builder VectorMapBuilder.cpp
+//               ../Classes/Map/VectorMapWriter.cpp
+//
+//  Usage:   vector_map_builder <source.txt> <output.nyvm>
+//
+//  Source format, one feature per line ('#' starts a comment):
+//
+//      size <width> <height>               The size of the map. Must come before any feature.
+//      water x,y x,y x,y ...               A polygon of water.
+//      park x,y x,y x,y ...                A polygon of park land.
+//      block x,y x,y x,y ...               A polygon for a city block.
+//      street <width> x,y x,y ...          A street's centre line and its width in map units.
+//      minor <width> x,y x,y ...           A minor street, which is hidden when zoomed far out.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "VectorMapWriter.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s <source.txt> <output.nyvm>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* source = fopen(argv[1], "r");
+    if (!source)
+    {
+        fprintf(stderr, "error: could not open \"%s\"\n", argv[1]);
+        return 1;
+    }
+
+    float width = 0;
+    float height = 0;
+    vector<VectorFeature> features;
+    char line[65536];
+
+    for (unsigned int lineNumber = 1; fgets(line, sizeof(line), source); lineNumber++)
+    {
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char* token = strtok(line, " \t\r\n");
+        if (!token)
+        {
+            continue;
+        }
+
+        if (strcmp(token, "size") == 0)
+        {
+            char* widthToken = strtok(NULL, " \t\r\n");
+            char* heightToken = strtok(NULL, " \t\r\n");
+            width = widthToken ? atof(widthToken) : 0;
+            height = heightToken ? atof(heightToken) : 0;
+            if (width <= 0 || height <= 0)
+            {
+                fprintf(stderr, "error: line %u: invalid size\n", lineNumber);
+                return 1;
+            }
+            continue;
+        }
+
+        VectorFeature feature;
+        feature.minor = false;
+        feature.width = 0;
+
+        if (strcmp(token, "water") == 0)        feature.kind = kVectorFeatureWater;
+        else if (strcmp(token, "park") == 0)    feature.kind = kVectorFeaturePark;
+        else if (strcmp(token, "block") == 0)   feature.kind = kVectorFeatureBlock;
+        else if (strcmp(token, "street") == 0)  feature.kind = kVectorFeatureStreet;
+        else if (strcmp(token, "minor") == 0) { feature.kind = kVectorFeatureStreet; feature.minor = true; }
+        else
+        {
+            fprintf(stderr, "error: line %u: unknown feature \"%s\"\n", lineNumber, token);
+            return 1;
+        }
+
+        if (width <= 0)
+        {
+            fprintf(stderr, "error: line %u: \"size\" must come before any feature\n", lineNumber);
+            return 1;
+        }
+
+        if (feature.kind == kVectorFeatureStreet)
+        {
+            char* widthToken = strtok(NULL, " \t\r\n");
+            feature.width = widthToken ? atof(widthToken) : 0;
+            if (feature.width <= 0 || feature.width * 10 > 65535)
+            {
+                fprintf(stderr, "error: line %u: invalid street width\n", lineNumber);
+                return 1;
+            }
+        }
+
+        while ((token = strtok(NULL, " \t\r\n")))
+        {
+            float x, y;
+            if (sscanf(token, "%f,%f", &x, &y) != 2)
+            {
+                fprintf(stderr, "error: line %u: invalid point \"%s\"\n", lineNumber, token);
+                return 1;
+            }
+            feature.points.push_back(MapPoint(x, y));
+        }
+
+        unsigned int minimumPoints = (feature.kind == kVectorFeatureStreet) ? 2 : 3;
+        if (feature.points.size() < minimumPoints)
+        {
+            fprintf(stderr, "error: line %u: too few points\n", lineNumber);
+            return 1;
+        }
+
+        features.push_back(feature);
+    }
+
+    long sourceSize = ftell(source);
+    fclose(source);
+
+    VectorMapWriter writer(width, height);
+    for (unsigned int i = 0; i < features.size(); i++)
+    {
+        writer.addFeature(features[i]);
+    }
+
+    vector<unsigned char> output;
+    writer.write(&output);
+
+    FILE* destination = fopen(argv[2], "wb");
+    if (!destination || fwrite(&output[0], 1, output.size(), destination) != output.size())
+    {
+        fprintf(stderr, "error: could not write \"%s\"\n", argv[2]);
+        return 1;
+    }
+    fclose(destination);
+
+    printf("Wrote %lu features (%lu points) to \"%s\": %lu bytes from %ld bytes of source.\n",
+           (unsigned long)writer.getFeatureCount(), writer.getPointCount(), argv[2], (unsigned long)output.size(), sourceSize);
+
+    return 0;
+}
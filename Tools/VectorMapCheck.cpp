@@ -0,0 +1,575 @@
+//
+//  VectorMapCheck.cpp
+//  NewYorkGuide
+//
+//  Created by Clement Todd on 2014-02-24.
+//
+//  A command-line tool which checks the vector map's geometry processing without a device, cocos2d or OpenGL. It fills
+//  convex and concave polygons in both winding orders with Tessellator, along with rings which have collinear points,
+//  repeated points and no area at all, and checks that every triangle winds counter-clockwise, lies inside its polygon
+//  and that together they cover exactly the polygon's area. It strokes polylines which are empty, a single point, made
+//  of repeated points or straight, checks the area of the strokes and that the extruded strokes the routes use match
+//  them once given a width. Finally it writes a map with VectorMapWriter, as Tools/VectorMapBuilder.cpp does, reads it
+//  back with VectorMapData and checks that every feature survives the trip, and that a truncated or corrupt file is
+//  rejected. It prints each check and fails if any of them does.
+//
+//  Build:   c++ -O2 -I../Classes/Helpers -I../Classes/Map -o vector_map_check VectorMapCheck.cpp
+//               ../Classes/Map/Tessellator.cpp ../Classes/Map/VectorMapData.cpp ../Classes/Map/VectorMapWriter.cpp
+//
+//  Usage:   vector_map_check [-s <seed>]
+//
+//      -s <seed>       The seed for the random polygons and polylines. Defaults to 1.
+//
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include "Tessellator.h"
+#include "VectorMapData.h"
+#include "VectorMapWriter.h"
+
+using namespace std;
+
+// How far a total area may be from the expected one, relative to it.
+static const float AREA_TOLERANCE = 1e-4f;
+
+// How far apart the vertices of a stroke and an extruded stroke given the same width may be.
+static const float VERTEX_TOLERANCE = 1e-3f;
+
+// The number of random polygons and polylines checked.
+static const unsigned int RANDOM_SHAPE_COUNT = 200;
+
+// The colour given to everything, which doesn't matter to any check.
+static const MapColor COLOR = { 255, 255, 255, 255 };
+
+// The number of checks which failed, and whether or not checks which pass are left out of the output (ie. for the random shapes).
+static unsigned int s_Failures = 0;
+static bool s_IsQuiet = false;
+
+// Print the outcome of a check, and count it if it failed.
+
+static void check(bool passed, const char* description)
+{
+    if (!passed || !s_IsQuiet)
+    {
+        printf("%-6s %s\n", passed ? "ok" : "FAILED", description);
+    }
+    if (!passed)
+    {
+        s_Failures++;
+    }
+}
+
+// Get a random number from 0 to 1 using a generator of our own, so that the shapes are the same on every platform.
+
+static float getRandom(unsigned int* state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (*state >> 8) / 16777216.0f;
+}
+
+// Make a list of points from pairs of coordinates.
+
+static vector<MapPoint> makeRing(const float* coordinates, unsigned int count)
+{
+    vector<MapPoint> points;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        points.push_back(MapPoint(coordinates[i * 2], coordinates[i * 2 + 1]));
+    }
+    return points;
+}
+
+// Get a ring's points in the opposite winding order.
+
+static vector<MapPoint> reverseRing(const vector<MapPoint>& ring)
+{
+    return vector<MapPoint>(ring.rbegin(), ring.rend());
+}
+
+// Check whether or not a point lies inside a ring, by counting the edges a ray to its right crosses.
+
+static bool ringContainsPoint(const vector<MapPoint>& ring, const MapPoint& point)
+{
+    bool inside = false;
+    for (unsigned int i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+    {
+        const MapPoint& a = ring[i];
+        const MapPoint& b = ring[j];
+        if ((a.y > point.y) != (b.y > point.y) && point.x < a.x + (point.y - a.y) * (b.x - a.x) / (b.y - a.y))
+        {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// Get the signed area of one triangle in a triangle list.
+
+template <typename Vertex>
+static float getTriangleArea(const vector<Vertex>& vertices, unsigned int first)
+{
+    const MapPoint& a = vertices[first].position;
+    const MapPoint& b = vertices[first + 1].position;
+    const MapPoint& c = vertices[first + 2].position;
+    return (b - a).cross(c - b) / 2;
+}
+
+// Fill a polygon and check its triangles: that they were appended after whatever was there, wind counter-clockwise with some area, lie inside the polygon and add up to its area. Returns the number of triangles, or -1 if the polygon couldn't be filled.
+
+static int checkFill(const char* description, const vector<MapPoint>& ring, unsigned int maxTriangles)
+{
+    // Start with a vertex in the list to check that it is left alone.
+    vector<MapVertex> vertices(1);
+    vertices[0].position = MapPoint(-1, -1);
+    if (!Tessellator::fillPolygon(ring, COLOR, vertices))
+    {
+        char message[256];
+        snprintf(message, sizeof(message), "%s: filled", description);
+        check(false, message);
+        return -1;
+    }
+
+    bool isValid = (vertices.size() - 1) % 3 == 0 && vertices[0].position == MapPoint(-1, -1);
+    unsigned int triangleCount = (vertices.size() - 1) / 3;
+    double area = 0;
+    for (unsigned int i = 0; isValid && i < triangleCount; i++)
+    {
+        unsigned int first = 1 + i * 3;
+        float triangleArea = getTriangleArea(vertices, first);
+        MapPoint centroid = (vertices[first].position + vertices[first + 1].position + vertices[first + 2].position) * (1.0f / 3);
+        isValid = triangleArea > 0 && ringContainsPoint(ring, centroid);
+        area += triangleArea;
+    }
+
+    float expectedArea = fabsf(Tessellator::getSignedArea(ring));
+    char message[256];
+    snprintf(message, sizeof(message), "%s: %u triangles covering %.4f of %.4f", description, triangleCount, area, expectedArea);
+    check(isValid && triangleCount <= maxTriangles && fabs(area - expectedArea) <= expectedArea * AREA_TOLERANCE, message);
+    return triangleCount;
+}
+
+// Check that a ring isn't filled, and that nothing is appended for it.
+
+static void checkNotFilled(const char* description, const vector<MapPoint>& ring)
+{
+    vector<MapVertex> vertices(1);
+    Tessellator::fillPolygon(ring, COLOR, vertices);
+    char message[256];
+    snprintf(message, sizeof(message), "%s: nothing filled", description);
+    check(vertices.size() == 1, message);
+}
+
+// Make a star-shaped polygon, with a random distance from its centre at each of a number of evenly spread angles.
+
+static vector<MapPoint> makeRandomStar(unsigned int pointCount, unsigned int* state)
+{
+    vector<MapPoint> ring;
+    for (unsigned int i = 0; i < pointCount; i++)
+    {
+        float angle = 2 * M_PI * i / pointCount;
+        float radius = 10 + 90 * getRandom(state);
+        ring.push_back(MapPoint(500 + radius * cosf(angle), 500 + radius * sinf(angle)));
+    }
+    return ring;
+}
+
+// Make a comb, a rectangle with narrow notches cut into its top, which has as many reflex corners as it has notches.
+
+static vector<MapPoint> makeComb(unsigned int toothCount)
+{
+    vector<MapPoint> ring;
+    ring.push_back(MapPoint(0, 0));
+    ring.push_back(MapPoint(toothCount * 2.0f, 0));
+    for (unsigned int i = toothCount; i > 0; i--)
+    {
+        float right = i * 2.0f;
+        ring.push_back(MapPoint(right, 10));
+        ring.push_back(MapPoint(right - 1, 10));
+        ring.push_back(MapPoint(right - 1, 2));
+        ring.push_back(MapPoint(right - 2, 2));
+    }
+    return ring;
+}
+
+// Check polygon filling.
+
+static void checkPolygons(unsigned int seed)
+{
+    printf("Polygons:\n");
+
+    const float square[] = { 0, 0, 10, 0, 10, 10, 0, 10 };
+    vector<MapPoint> squareRing = makeRing(square, 4);
+    checkFill("square", squareRing, 2);
+    checkFill("clockwise square", reverseRing(squareRing), 2);
+
+    const float lShape[] = { 0, 0, 20, 0, 20, 5, 5, 5, 5, 20, 0, 20 };
+    vector<MapPoint> lRing = makeRing(lShape, 6);
+    checkFill("L-shape", lRing, 4);
+    checkFill("clockwise L-shape", reverseRing(lRing), 4);
+
+    vector<MapPoint> comb = makeComb(20);
+    checkFill("comb with 20 notches", comb, comb.size() - 2);
+    checkFill("clockwise comb with 20 notches", reverseRing(comb), comb.size() - 2);
+
+    // A square with points half way along its edges, and an L-shape with points along the edges either side of its reflex corner, which add nothing to the fill.
+    const float squareWithMidpoints[] = { 0, 0, 5, 0, 10, 0, 10, 5, 10, 10, 5, 10, 0, 10, 0, 5 };
+    checkFill("square with collinear points", makeRing(squareWithMidpoints, 8), 6);
+    checkFill("clockwise square with collinear points", reverseRing(makeRing(squareWithMidpoints, 8)), 6);
+    const float lShapeWithMidpoints[] = { 0, 0, 20, 0, 20, 5, 12, 5, 5, 5, 5, 12, 5, 20, 0, 20, 0, 10 };
+    checkFill("L-shape with collinear points", makeRing(lShapeWithMidpoints, 9), 7);
+
+    // Repeated points, whether next to each other or closing the ring, are ignored.
+    const float squareWithDuplicates[] = { 0, 0, 0, 0, 10, 0, 10, 10, 10, 10, 10, 10, 0, 10, 0, 0 };
+    checkFill("square with repeated points", makeRing(squareWithDuplicates, 8), 2);
+    const float closedTriangle[] = { 0, 0, 10, 0, 0, 10, 0, 0 };
+    checkFill("triangle with its first point repeated at the end", makeRing(closedTriangle, 4), 1);
+
+    // Rings with no area.
+    const float twoPoints[] = { 0, 0, 10, 10, 10, 10, 0, 0 };
+    checkNotFilled("ring of two points", makeRing(twoPoints, 4));
+    const float line[] = { 0, 0, 5, 5, 10, 10, 20, 20 };
+    checkNotFilled("ring of collinear points", makeRing(line, 4));
+    checkNotFilled("empty ring", vector<MapPoint>());
+
+    // A ring which crosses itself can't be filled, and must be left out entirely rather than half filled.
+    const float figureOfEight[] = { 0, 0, 10, 0, 10, 10, 20, 10, 20, 20, 5, 20, 5, -5, 0, -5 };
+    vector<MapVertex> vertices(1);
+    bool isFilled = Tessellator::fillPolygon(makeRing(figureOfEight, 8), COLOR, vertices);
+    check(isFilled ? (vertices.size() - 1) % 3 == 0 : vertices.size() == 1, "self-intersecting ring: nothing appended unless filled");
+
+    // Random star-shaped polygons, which are simple however their points fall.
+    unsigned int state = seed;
+    unsigned int failures = s_Failures;
+    unsigned int triangleCount = 0;
+    s_IsQuiet = true;
+    for (unsigned int i = 0; i < RANDOM_SHAPE_COUNT; i++)
+    {
+        vector<MapPoint> star = makeRandomStar(5 + i % 100, &state);
+        char description[64];
+        snprintf(description, sizeof(description), "random star %u", i);
+        triangleCount += max(checkFill(description, (i % 2) ? reverseRing(star) : star, star.size() - 2), 0);
+    }
+    s_IsQuiet = false;
+
+    char message[256];
+    snprintf(message, sizeof(message), "%u random star-shaped polygons in either winding order: %u triangles (%u failed)", RANDOM_SHAPE_COUNT, triangleCount, s_Failures - failures);
+    check(s_Failures == failures, message);
+}
+
+// Get the total area of a triangle list's triangles, and check that none of them winds clockwise or has a point which isn't a number.
+
+template <typename Vertex>
+static bool getStrokeArea(const vector<Vertex>& vertices, double* area)
+{
+    *area = 0;
+    for (unsigned int i = 0; i + 2 < vertices.size(); i += 3)
+    {
+        float triangleArea = getTriangleArea(vertices, i);
+        if (!(triangleArea >= 0))
+        {
+            return false;
+        }
+        *area += triangleArea;
+    }
+    return vertices.size() % 3 == 0;
+}
+
+// Give an extruded stroke a width, the way the routes' shader does.
+
+static vector<MapVertex> applyWidth(const vector<MapStrokeVertex>& extruded, float width)
+{
+    vector<MapVertex> vertices(extruded.size());
+    for (unsigned int i = 0; i < extruded.size(); i++)
+    {
+        vertices[i].position = extruded[i].position + extruded[i].extrusion * (width / 2);
+        vertices[i].color = extruded[i].color;
+    }
+    return vertices;
+}
+
+// Check whether or not two triangle lists have the same vertices in the same order.
+
+static bool isSameStroke(const vector<MapVertex>& a, const vector<MapVertex>& b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (unsigned int i = 0; i < a.size(); i++)
+    {
+        if (!(a[i].position.distance(b[i].position) <= VERTEX_TOLERANCE))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Stroke a polyline, and check its stroke's area and that its extruded stroke matches it once given the same width.
+
+static void checkStroke(const char* description, const vector<MapPoint>& line, float width, double expectedArea)
+{
+    vector<MapVertex> stroke;
+    vector<MapStrokeVertex> extruded;
+    Tessellator::strokePolyline(line, width, COLOR, stroke);
+    Tessellator::extrudePolyline(line, COLOR, extruded);
+
+    double area;
+    bool isValid = getStrokeArea(stroke, &area);
+    char message[256];
+    snprintf(message, sizeof(message), "%s: %u triangles covering %.4f of %.4f", description, (unsigned int)stroke.size() / 3, area, expectedArea);
+    check(isValid && fabs(area - expectedArea) <= expectedArea * AREA_TOLERANCE + 1e-6, message);
+
+    snprintf(message, sizeof(message), "%s: extruded stroke matches", description);
+    check(isSameStroke(stroke, applyWidth(extruded, width)), message);
+}
+
+// Check polyline stroking.
+
+static void checkPolylines(unsigned int seed)
+{
+    printf("Polylines:\n");
+
+    // Polylines with no length draw nothing.
+    checkStroke("empty polyline", vector<MapPoint>(), 2, 0);
+    checkStroke("single point", vector<MapPoint>(1, MapPoint(5, 5)), 2, 0);
+    checkStroke("repeated point", vector<MapPoint>(4, MapPoint(5, 5)), 2, 0);
+
+    // A straight polyline, however many points it has, is a single rectangle with no joins.
+    const float straight[] = { 0, 0, 10, 0, 25, 0, 40, 0 };
+    checkStroke("straight polyline", makeRing(straight, 4), 4, 40 * 4);
+    const float diagonal[] = { 0, 0, 3, 4, 3, 4, 6, 8 };
+    checkStroke("diagonal polyline with a repeated point", makeRing(diagonal, 4), 2, 10 * 2);
+
+    // A right-angled corner is joined with a bevel, which covers half of the square at the corner beyond the two rectangles.
+    const float leftTurn[] = { 0, 0, 10, 0, 10, 10 };
+    checkStroke("left turn", makeRing(leftTurn, 3), 2, 10 * 2 * 2 + 0.5);
+    const float rightTurn[] = { 0, 0, 10, 0, 10, -10 };
+    checkStroke("right turn", makeRing(rightTurn, 3), 2, 10 * 2 * 2 + 0.5);
+
+    // Turning straight back overlaps the way it came, with no join.
+    const float uTurn[] = { 0, 0, 10, 0, 5, 0 };
+    checkStroke("U-turn", makeRing(uTurn, 3), 2, 15 * 2);
+
+    // Repeated points in a polyline don't change its stroke.
+    const float withDuplicates[] = { 0, 0, 10, 0, 10, 0, 10, 0, 10, 10, 20, 15, 20, 15 };
+    const float withoutDuplicates[] = { 0, 0, 10, 0, 10, 10, 20, 15 };
+    vector<MapVertex> duplicatesStroke;
+    vector<MapVertex> stroke;
+    Tessellator::strokePolyline(makeRing(withDuplicates, 7), 3, COLOR, duplicatesStroke);
+    Tessellator::strokePolyline(makeRing(withoutDuplicates, 4), 3, COLOR, stroke);
+    check(isSameStroke(duplicatesStroke, stroke), "repeated points: same stroke as without them");
+
+    // Random polylines, some of which turn sharply or repeat points.
+    unsigned int state = seed;
+    unsigned int failures = 0;
+    for (unsigned int i = 0; i < RANDOM_SHAPE_COUNT; i++)
+    {
+        vector<MapPoint> line(1, MapPoint(0, 0));
+        unsigned int pointCount = 2 + i % 30;
+        while (line.size() < pointCount)
+        {
+            line.push_back(getRandom(&state) < 0.1f ? line.back() : MapPoint(getRandom(&state) * 100, getRandom(&state) * 100));
+        }
+
+        float width = 0.5f + getRandom(&state) * 10;
+        vector<MapVertex> randomStroke;
+        vector<MapStrokeVertex> extruded;
+        Tessellator::strokePolyline(line, width, COLOR, randomStroke);
+        Tessellator::extrudePolyline(line, COLOR, extruded);
+        double area;
+        if (!getStrokeArea(randomStroke, &area) || !isSameStroke(randomStroke, applyWidth(extruded, width)))
+        {
+            failures++;
+        }
+    }
+
+    char message[256];
+    snprintf(message, sizeof(message), "%u random polylines: every triangle counter-clockwise, extruded strokes match (%u failed)", RANDOM_SHAPE_COUNT, failures);
+    check(failures == 0, message);
+}
+
+// Check that a feature read back from a file matches the one written, to within the precision of the file.
+
+static bool isSameFeature(const VectorFeature& written, const VectorFeature& read, float width, float height)
+{
+    if (read.kind != written.kind || read.minor != written.minor || read.points.size() != written.points.size() ||
+        fabsf(read.width - written.width) > 0.05f + 1e-4f)
+    {
+        return false;
+    }
+
+    // Points are quantized to 65535 steps across the map, so they come back within half a step.
+    float xTolerance = width / 65535 / 2 * 1.01f;
+    float yTolerance = height / 65535 / 2 * 1.01f;
+    for (unsigned int i = 0; i < read.points.size(); i++)
+    {
+        if (fabsf(read.points[i].x - written.points[i].x) > xTolerance || fabsf(read.points[i].y - written.points[i].y) > yTolerance)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Make a feature from pairs of coordinates.
+
+static VectorFeature makeFeature(VectorFeatureKind kind, bool minor, float width, const float* coordinates, unsigned int count)
+{
+    VectorFeature feature;
+    feature.kind = kind;
+    feature.minor = minor;
+    feature.width = width;
+    feature.points = makeRing(coordinates, count);
+    return feature;
+}
+
+// Write a map and read it back.
+
+static void checkRoundTrip(unsigned int seed)
+{
+    printf("Vector map files:\n");
+
+    const float mapWidth = 4096;
+    const float mapHeight = 6144;
+    vector<VectorFeature> features;
+    const float water[] = { 0, 0, 4096, 0, 4096, 800, 0, 1200 };
+    const float park[] = { 1000, 3000, 1400, 3000, 1400, 4500, 1000, 4500 };
+    const float block[] = { 2000, 2000, 2100, 2000, 2100, 2080, 2050, 2080, 2050, 2040, 2000, 2040 };
+    const float street[] = { 0, 1500, 2048.5f, 1500.25f, 4096, 1500 };
+    const float minorStreet[] = { 2000.1f, 1600.9f, 2000.1f, 2500.3f };
+    features.push_back(makeFeature(kVectorFeatureWater, false, 0, water, 4));
+    features.push_back(makeFeature(kVectorFeaturePark, false, 0, park, 4));
+    features.push_back(makeFeature(kVectorFeatureBlock, false, 0, block, 6));
+    features.push_back(makeFeature(kVectorFeatureStreet, false, 12.3f, street, 3));
+    features.push_back(makeFeature(kVectorFeatureStreet, true, 4.5f, minorStreet, 2));
+
+    unsigned int state = seed;
+    for (unsigned int i = 0; i < RANDOM_SHAPE_COUNT; i++)
+    {
+        VectorFeature feature;
+        feature.kind = (VectorFeatureKind)(i % kVectorFeatureKindCount);
+        feature.minor = feature.kind == kVectorFeatureStreet && getRandom(&state) < 0.5f;
+        feature.width = (feature.kind == kVectorFeatureStreet) ? floorf(getRandom(&state) * 300) / 10 : 0;
+        if (feature.kind == kVectorFeatureStreet)
+        {
+            for (unsigned int p = 0; p < 2 + i % 10; p++)
+            {
+                feature.points.push_back(MapPoint(getRandom(&state) * mapWidth, getRandom(&state) * mapHeight));
+            }
+        }
+        else
+        {
+            vector<MapPoint> star = makeRandomStar(3 + i % 20, &state);
+            for (unsigned int p = 0; p < star.size(); p++)
+            {
+                feature.points.push_back(MapPoint(star[p].x * 3, star[p].y * 5));
+            }
+        }
+        features.push_back(feature);
+    }
+
+    VectorMapWriter writer(mapWidth, mapHeight);
+    for (unsigned int i = 0; i < features.size(); i++)
+    {
+        writer.addFeature(features[i]);
+    }
+    vector<unsigned char> bytes;
+    writer.write(&bytes);
+
+    VectorMapData data;
+    bool isLoaded = data.load(&bytes[0], bytes.size());
+    char message[256];
+    snprintf(message, sizeof(message), "%u features (%lu points) written in %u bytes and read back", writer.getFeatureCount(), writer.getPointCount(), (unsigned int)bytes.size());
+    check(isLoaded && data.getWidth() == mapWidth && data.getHeight() == mapHeight && data.getFeatures().size() == features.size(), message);
+
+    unsigned int mismatches = 0;
+    for (unsigned int i = 0; isLoaded && i < features.size() && i < data.getFeatures().size(); i++)
+    {
+        if (!isSameFeature(features[i], data.getFeatures()[i], mapWidth, mapHeight))
+        {
+            mismatches++;
+        }
+    }
+    snprintf(message, sizeof(message), "every feature read back as written, to within the file's precision (%u differ)", mismatches);
+    check(isLoaded && mismatches == 0, message);
+
+    // The features read back can be drawn.
+    unsigned int unfilled = 0;
+    vector<MapVertex> vertices;
+    for (unsigned int i = 0; i < data.getFeatures().size(); i++)
+    {
+        const VectorFeature& feature = data.getFeatures()[i];
+        if (feature.kind == kVectorFeatureStreet)
+        {
+            Tessellator::strokePolyline(feature.points, feature.width, COLOR, vertices);
+        }
+        else if (!Tessellator::fillPolygon(feature.points, COLOR, vertices))
+        {
+            unfilled++;
+        }
+    }
+    snprintf(message, sizeof(message), "features read back tessellated into %u triangles (%u polygons not filled)", (unsigned int)vertices.size() / 3, unfilled);
+    check(unfilled == 0, message);
+
+    // Every file cut short is rejected, and leaves the map empty even though it was loaded before.
+    unsigned int accepted = 0;
+    for (unsigned long size = 0; size < bytes.size(); size++)
+    {
+        data.load(&bytes[0], bytes.size());
+        if (data.load(&bytes[0], size) || !data.getFeatures().empty() || data.getWidth() != 0)
+        {
+            accepted++;
+        }
+    }
+    snprintf(message, sizeof(message), "every truncated file rejected and the map left empty (%u accepted)", accepted);
+    check(accepted == 0, message);
+
+    vector<unsigned char> corrupt = bytes;
+    corrupt[0] = 'X';
+    check(!data.load(&corrupt[0], corrupt.size()), "file with the wrong identifying bytes rejected");
+    corrupt = bytes;
+    corrupt[4] = 2;
+    check(!data.load(&corrupt[0], corrupt.size()), "file of an unknown version rejected");
+    corrupt = bytes;
+    corrupt[20] = kVectorFeatureKindCount;
+    check(!data.load(&corrupt[0], corrupt.size()), "feature of an unknown kind rejected");
+    check(!data.load(NULL, 0), "no file rejected");
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int seed = 1;
+
+    int option;
+    while ((option = getopt(argc, argv, "s:")) != -1)
+    {
+        switch (option)
+        {
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+
+            default:
+                fprintf(stderr, "usage: %s [-s <seed>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    checkPolygons(seed);
+    checkPolylines(seed);
+    checkRoundTrip(seed);
+
+    if (s_Failures > 0)
+    {
+        printf("%u checks failed.\n", s_Failures);
+        return 1;
+    }
+
+    printf("All checks passed.\n");
+    return 0;
+}
@@ -0,0 +1,76 @@
+#!/bin/sh
+#
+#  make_asset_variants.sh
+#  NewYorkGuide
+#
+#  Created by Clement Todd on 2014-02-02.
+#
+#  Produces the reduced-resolution variants of the map tiles, landmark images and user interface
+#  sprites that AssetResolver picks from at load time. Every image is authored for iPad Retina; this
+#  script writes a "_half" (0.5x) and "_quarter" (0.25x) copy of each one next to it in the output
+#  directory (ie. "newYorkMap0x0.png" -> "newYorkMap0x0_half.png" and "newYorkMap0x0_quarter.png").
+#
+#  Usage:   make_asset_variants.sh [output directory]
+#
+#  When run from the Xcode "Generate Asset Variants" build phase, the output directory defaults to the
+#  app bundle's resource folder. Uses "sips" on OS X and ImageMagick's "convert" elsewhere. Variants
+#  which are already newer than their source image are skipped.
+#
+
+RESOURCES_DIR="$(cd "$(dirname "$0")/../Resources" && pwd)"
+OUTPUT_DIR="${1:-${TARGET_BUILD_DIR}/${UNLOCALIZED_RESOURCES_FOLDER_PATH}}"
+
+if [ -z "$1" ] && [ -z "${TARGET_BUILD_DIR}" ]; then
+    echo "usage: $0 <output directory>" >&2
+    exit 1
+fi
+
+mkdir -p "$OUTPUT_DIR"
+
+# Images smaller than this (in pixels) on either side are left alone, since reducing them saves nothing.
+MIN_SIZE=8
+
+# Print the width and height of an image.
+image_size()
+{
+    if command -v sips >/dev/null 2>&1; then
+        sips -g pixelWidth -g pixelHeight "$1" | awk '/pixelWidth/ { w = $2 } /pixelHeight/ { h = $2 } END { print w, h }'
+    else
+        identify -format "%w %h" "$1"
+    fi
+}
+
+# Resize an image to an exact width and height.
+resize_image()
+{
+    if command -v sips >/dev/null 2>&1; then
+        sips -z "$4" "$3" "$1" --out "$2" >/dev/null
+    else
+        convert "$1" -filter Box -resize "$3x$4!" "$2"
+    fi
+}
+
+for SOURCE in "$RESOURCES_DIR"/map/*.png "$RESOURCES_DIR"/landmarks/*.png "$RESOURCES_DIR"/userInterface/*.png; do
+    NAME="$(basename "$SOURCE" .png)"
+    set -- $(image_size "$SOURCE")
+    WIDTH=$1
+    HEIGHT=$2
+
+    if [ "$WIDTH" -lt "$MIN_SIZE" ] || [ "$HEIGHT" -lt "$MIN_SIZE" ]; then
+        continue
+    fi
+
+    for VARIANT in "half 2" "quarter 4"; do
+        set -- $VARIANT
+        TARGET="$OUTPUT_DIR/${NAME}_$1.png"
+
+        # Also skip variants which have already been transcoded (and had their PNG removed) by transcode_images.sh.
+        if [ "$TARGET" -nt "$SOURCE" ] || [ "$OUTPUT_DIR/${NAME}_$1.webp" -nt "$SOURCE" ]; then
+            continue
+        fi
+
+        # Round up so that the variant never has fewer pixels than the screen will display.
+        resize_image "$SOURCE" "$TARGET" $(( (WIDTH + $2 - 1) / $2 )) $(( (HEIGHT + $2 - 1) / $2 ))
+        echo "Generated ${NAME}_$1.png"
+    done
+done
@@ -0,0 +1,124 @@
+#!/bin/sh
+#
+#  transcode_images.sh
+#  NewYorkGuide
+#
+#  Created by Clement Todd on 2014-02-09.
+#
+#  Transcodes the landmark photos and map tiles (and their "_half" / "_quarter" variants) from PNG to
+#  lossy WebP, which AssetResolver prefers over the PNG of the same variant. Every WebP copy is decoded
+#  again with dwebp as soon as it is written, and the script fails if it can't be, so that a bad encode
+#  breaks the build rather than the app. Prints the size of every image before and after along with the
+#  PSNR of the result, followed by the totals. Images whose WebP copy is already newer than the source
+#  image in Resources are skipped, so that only changed images are encoded again.
+#
+#  Usage:   transcode_images.sh [-p photo quality] [-t tile quality] [-r] <image directory>
+#
+#      -p   WebP quality (0-100) for landmark photos. Defaults to 80.
+#      -t   WebP quality (0-100) for map tiles, which contain text and fine lines. Defaults to 90.
+#      -r   Remove each PNG once its WebP copy has been checked, so that only the WebP copy is shipped.
+#           The Xcode build phase passes this, since AssetResolver never falls back to the PNG.
+#
+#  The image directory is expected to be flat, like the app bundle (ie. the output directory of
+#  make_asset_variants.sh with the original images copied in). Requires "cwebp" and "dwebp" from
+#  libwebp, which are available on Linux as the "webp" package. When run from the Xcode "Transcode
+#  Images" build phase the directory defaults to the app bundle's resource folder, and the phase is
+#  skipped (shipping the PNGs) if either tool is missing.
+#
+
+RESOURCES_DIR="$(cd "$(dirname "$0")/../Resources" && pwd)"
+PHOTO_QUALITY=80
+TILE_QUALITY=90
+REPLACE=0
+
+while getopts "p:t:r" OPTION; do
+    case $OPTION in
+        p) PHOTO_QUALITY=$OPTARG ;;
+        t) TILE_QUALITY=$OPTARG ;;
+        r) REPLACE=1 ;;
+        *) echo "usage: $0 [-p photo quality] [-t tile quality] [-r] <image directory>" >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+IMAGE_DIR="${1:-${TARGET_BUILD_DIR}/${UNLOCALIZED_RESOURCES_FOLDER_PATH}}"
+
+if [ -z "$1" ] && [ -z "${TARGET_BUILD_DIR}" ]; then
+    echo "usage: $0 [-p photo quality] [-t tile quality] [-r] <image directory>" >&2
+    exit 1
+fi
+
+if ! command -v cwebp >/dev/null 2>&1 || ! command -v dwebp >/dev/null 2>&1; then
+    echo "warning: cwebp or dwebp was not found, so images will be shipped as PNG."
+    exit 0
+fi
+
+TOTAL_BEFORE=0
+TOTAL_AFTER=0
+COUNT=0
+SKIPPED=0
+
+# Transcode every variant of the images found in a resource directory at the given quality.
+transcode_group()
+{
+    for SOURCE in "$RESOURCES_DIR"/$1/*.png; do
+        NAME="$(basename "$SOURCE" .png)"
+
+        for VARIANT in "" "_half" "_quarter"; do
+            INPUT="$IMAGE_DIR/$NAME$VARIANT.png"
+            OUTPUT="$IMAGE_DIR/$NAME$VARIANT.webp"
+
+            if [ ! -f "$INPUT" ]; then
+                continue
+            fi
+
+            # "-m 6" is cwebp's slowest method, so an image is only encoded again if its source has changed since. The
+            # source is compared rather than the PNG here, which is removed once transcoded and copied in by every build.
+            if [ -f "$OUTPUT" ] && [ "$OUTPUT" -nt "$SOURCE" ]; then
+                SKIPPED=$((SKIPPED + 1))
+                if [ "$REPLACE" -eq 1 ]; then
+                    rm "$INPUT"
+                fi
+                continue
+            fi
+
+            PSNR="$(cwebp -quiet -print_psnr -metadata none -m 6 -q "$2" "$INPUT" -o "$OUTPUT" 2>&1 | tail -n 1)"
+            if [ ! -f "$OUTPUT" ]; then
+                echo "error: failed to transcode $NAME$VARIANT.png" >&2
+                exit 1
+            fi
+
+            # Decode the new copy as the app will, removing it if that fails so that the next build encodes it again.
+            if ! dwebp "$OUTPUT" -o /dev/null >/dev/null 2>&1; then
+                echo "error: the WebP copy of $NAME$VARIANT.png does not decode" >&2
+                rm -f "$OUTPUT"
+                exit 1
+            fi
+
+            BEFORE=$(wc -c < "$INPUT")
+            AFTER=$(wc -c < "$OUTPUT")
+            TOTAL_BEFORE=$((TOTAL_BEFORE + BEFORE))
+            TOTAL_AFTER=$((TOTAL_AFTER + AFTER))
+            COUNT=$((COUNT + 1))
+
+            printf "%-44s %8d KB -> %6d KB  (%5.1fx)  %s\n" "$NAME$VARIANT" $((BEFORE / 1024)) $((AFTER / 1024)) \
+                "$(echo "$BEFORE $AFTER" | awk '{ print $1 / $2 }')" "$PSNR"
+
+            if [ "$REPLACE" -eq 1 ]; then
+                rm "$INPUT"
+            fi
+        done
+    done
+}
+
+transcode_group landmarks "$PHOTO_QUALITY"
+transcode_group map "$TILE_QUALITY"
+
+if [ "$COUNT" -gt 0 ]; then
+    printf "Transcoded %d images: %d KB -> %d KB (%.1fx smaller)\n" "$COUNT" $((TOTAL_BEFORE / 1024)) $((TOTAL_AFTER / 1024)) \
+        "$(echo "$TOTAL_BEFORE $TOTAL_AFTER" | awk '{ print $1 / $2 }')"
+fi
+
+if [ "$SKIPPED" -gt 0 ]; then
+    printf "Skipped %d images which were already up to date.\n" "$SKIPPED"
+fi